@@ -135,6 +135,8 @@ static const char *help[]={
 "     -halfc       half-cycle ambiguity correction [off]",
 "     -ltspan      lock indicator correction using lock time spans [off]",
 "     -sortsats    sort observations by the RTKLib satellite index [off]",
+"     -crx         output RINEX OBS as compact RINEX (hatanaka) [off]",
+"     -gz          gzip compress output files [off]",
 "     -mask   [sig[,...]] signal mask(s) (sig={G|R|E|J|S|C|I}L{1C|1P|1W|...})",
 "     -nomask [sig[,...]] signal no mask (same as above)",
 "     -x sat       exclude satellite",
@@ -218,12 +220,12 @@ static int convbin(int format, rnxopt_t *opt, const char *ifile, char **file,
     
     if (file[0]) strcpy(ofile[0],file[0]);
     else if (*opt->staid) {
-        strcpy(ofile[0],"%r%n0.%yO");
+        strcpy(ofile[0],opt->crx?"%r%n0.%yD":"%r%n0.%yO");
     }
     else if (def) {
         strcpy(ofile[0],ifile_);
-        if ((p=strrchr(ofile[0],'.'))) strcpy(p,".obs");
-        else strcat(ofile[0],".obs");
+        if ((p=strrchr(ofile[0],'.'))) strcpy(p,opt->crx?".crx":".obs");
+        else strcat(ofile[0],opt->crx?".crx":".obs");
     }
     if (file[1]) strcpy(ofile[1],file[1]);
     else if (*opt->staid) {
@@ -307,17 +309,18 @@ static int convbin(int format, rnxopt_t *opt, const char *ifile, char **file,
         else strcpy(work,ofile[i]);
         sprintf(ofile[i],"%s%c%s",dir,RTKLIB_FILEPATHSEP,work);
     }
+    const char *gz=opt->gzip?".gz":"";
     fprintf(stderr,"input file  : %s (%s)\n",ifile,formatstrs[format]);
     
-    if (*ofile[0]) fprintf(stderr,"->rinex obs : %s\n",ofile[0]);
-    if (*ofile[1]) fprintf(stderr,"->rinex nav : %s\n",ofile[1]);
-    if (*ofile[2]) fprintf(stderr,"->rinex gnav: %s\n",ofile[2]);
-    if (*ofile[3]) fprintf(stderr,"->rinex hnav: %s\n",ofile[3]);
-    if (*ofile[4]) fprintf(stderr,"->rinex qnav: %s\n",ofile[4]);
-    if (*ofile[5]) fprintf(stderr,"->rinex lnav: %s\n",ofile[5]);
-    if (*ofile[6]) fprintf(stderr,"->rinex cnav: %s\n",ofile[6]);
-    if (*ofile[7]) fprintf(stderr,"->rinex inav: %s\n",ofile[7]);
-    if (*ofile[8]) fprintf(stderr,"->sbas log  : %s\n",ofile[8]);
+    if (*ofile[0]) fprintf(stderr,"->rinex obs : %s%s\n",ofile[0],gz);
+    if (*ofile[1]) fprintf(stderr,"->rinex nav : %s%s\n",ofile[1],gz);
+    if (*ofile[2]) fprintf(stderr,"->rinex gnav: %s%s\n",ofile[2],gz);
+    if (*ofile[3]) fprintf(stderr,"->rinex hnav: %s%s\n",ofile[3],gz);
+    if (*ofile[4]) fprintf(stderr,"->rinex qnav: %s%s\n",ofile[4],gz);
+    if (*ofile[5]) fprintf(stderr,"->rinex lnav: %s%s\n",ofile[5],gz);
+    if (*ofile[6]) fprintf(stderr,"->rinex cnav: %s%s\n",ofile[6],gz);
+    if (*ofile[7]) fprintf(stderr,"->rinex inav: %s%s\n",ofile[7],gz);
+    if (*ofile[8]) fprintf(stderr,"->sbas log  : %s%s\n",ofile[8],gz);
     
     int r = convrnx(format,opt,ifile,ofile);
     for (int i = 0; i < NOUTFILE; i++) free(ofile[i]);
@@ -561,6 +564,12 @@ static int cmdopts(int argc, char **argv, rnxopt_t *opt, char **ifile,
         else if (!strcmp(argv[i],"-sortsats")) {
             opt->sortsats=1;
         }
+        else if (!strcmp(argv[i],"-crx")) {
+            opt->crx=1;
+        }
+        else if (!strcmp(argv[i],"-gz")) {
+            opt->gzip=1;
+        }
         else if (!strcmp(argv[i],"-mask")&&i+1<argc) {
             for (j=0;j<RNX_NUMSYS;j++) {
               for (k=0;k<MAXCODE;k++) opt->mask[j][k]='0';
@@ -18,10 +18,16 @@
 *           2016/09/07  1.10 add option -sys
 *-----------------------------------------------------------------------------*/
 #include <stdarg.h>
+#include <sys/stat.h>
+#ifndef WIN32
+#include <unistd.h>
+#endif
 #include "rtklib.h"
 
 #define PROGNAME    "rnx2rtkp"          /* program name */
 #define MAXFILE     16                  /* max number of input files */
+#define MAXJOBTHR   64                  /* max number of job threads */
+#define MAXPRODC    4                   /* max number of unused cached products */
 
 /* help text -----------------------------------------------------------------*/
 static const char *help[]={
@@ -57,6 +63,7 @@ static const char *help[]={
 " -v thres  validation threshold for integer ambiguity (0.0:no AR) [3.0]",
 " -b        backward solutions [off]",
 " -c        forward/backward combined solutions [off]",
+" --serial  run forward/backward passes of combined solutions serially [off]",
 " -i        instantaneous integer ambiguity resolution [off]",
 " -h        fix and hold for integer ambiguity resolution [off]",
 " -bl bl,std     baseline distance and stdev",
@@ -76,19 +83,380 @@ static const char *help[]={
 " -x level  debug trace level (0:off) [0]",
 " --rover list rover names for processing, separated by a space",
 " --base list  base names for processing, separated by a space",
+" --verbose print messages except progress on separate lines [off]",
+" --jobs file  process the jobs in the job list file. each line of the file",
+"           is a job: output file followed by the input files. the paths can",
+"           include the keywords of reppath() expanded to a job per day",
+"           within -ts and -te. precise ephemeris/clock files (.sp3,.eph,",
+"           .clk) and the antenna files are read once and shared by jobs",
+"           with the same files and modification times [off]",
+" --threads n  number of job threads for --jobs [1]. RINEX 3/4 obs files are",
+"           decoded in threads up to the processors shared by the jobs",
+" --cache dir  cache the decoded obs/nav data in the directory. the runs with",
+"           the same input files and options read the cache [off]",
 " --version display release version"
 };
+static int verbose=0;            /* verbose messages */
+static int serial=0;             /* serial combined passes */
+static int jobmode=0;            /* processing a job list */
+
+typedef struct {        /* job type */
+    gtime_t ts,te;      /* processing start/end time (0: no limit) */
+    char outfile[1024]; /* output file */
+    char *infile[MAXFILE]; /* input files */
+    char *pfile[MAXFILE]; /* precise ephemeris/clock files */
+    int n,np;           /* number of input/product files */
+    int stat;           /* status (0:ok,0>:error,1:aborted) */
+    int nep;            /* number of processed epochs */
+    double tt;          /* processing time (s) */
+} job_t;
+
+typedef struct prodc_tag { /* cached shared products type */
+    char *key;          /* product files and modification times */
+    int stat;           /* status (0:reading,1:ok,-1:error) */
+    int nref;           /* number of jobs using the products */
+    ppprod_t prod;      /* shared products */
+    struct prodc_tag *next; /* next cache entry */
+} prodc_t;
+
+typedef struct {        /* job list processing type */
+    job_t *jobs;        /* jobs */
+    int njob,ijob;      /* number of jobs and next job index */
+    const prcopt_t *popt; /* processing options */
+    const solopt_t *sopt; /* solution options */
+    const filopt_t *fopt; /* file options */
+    double ti;          /* processing interval (s) */
+    const char *rov,*base; /* rover/base lists */
+    prodc_t *prodc;     /* cached shared products */
+    rtklib_lock_t lock; /* lock flag */
+    rtklib_cond_t cond; /* products read (with lock) */
+} joblist_t;
+
 /* show message --------------------------------------------------------------*/
 int showmsg(const char *format, ...)
 {
     va_list arg;
+    /* no progress of concurrent jobs */
+    if (jobmode&&(!*format||!strncmp(format,"processing",10)||
+                  !strncmp(format,"reading",7))) {
+        return 0;
+    }
     va_start(arg,format); vfprintf(stderr,format,arg); va_end(arg);
-    fprintf(stderr,"\r");
+    fprintf(stderr,(verbose||jobmode)&&*format&&strncmp(format,"processing",10)?"\n":"\r");
     return 0;
 }
 void settspan(gtime_t ts, gtime_t te) {}
 void settime(gtime_t time) {}
 
+/* precise ephemeris/clock file ---------------------------------------------*/
+static int isprodfile(const char *file)
+{
+    const char *ext=strrchr(file,'.');
+    char buff[8]="";
+    int i;
+
+    if (!ext||strlen(ext)>sizeof(buff)) return 0;
+    for (i=0;ext[i+1];i++) buff[i]=(char)tolower((int)ext[i+1]);
+    buff[i]='\0';
+    return !strcmp(buff,"sp3")||!strcmp(buff,"eph")||!strncmp(buff,"clk",3);
+}
+/* add job -------------------------------------------------------------------*/
+static int addjob(joblist_t *jl, gtime_t ts, gtime_t te, char **path, int n)
+{
+    job_t *job,*jobs;
+    char *files[MAXFILE];
+    int i,j,np;
+
+    if (!(jobs=(job_t *)realloc(jl->jobs,sizeof(job_t)*(jl->njob+1)))) return 0;
+    jl->jobs=jobs;
+    job=jobs+jl->njob++;
+    memset(job,0,sizeof(job_t));
+    job->ts=ts; job->te=te;
+    reppath(path[0],job->outfile,ts,"","");
+
+    for (i=1;i<n;i++) {
+        if ((job->infile[job->n]=(char *)malloc(strlen(path[i])+1))) {
+            strcpy(job->infile[job->n++],path[i]);
+        }
+        if (!isprodfile(path[i])) continue;
+
+        /* expand precise ephemeris/clock including next day as postpos() */
+        if (ts.time!=0) {
+            for (j=0;j<MAXFILE;j++) files[j]=(char *)malloc(1024);
+            np=reppaths(path[i],files,MAXFILE-job->np,ts,timeadd(te,3600.0),"","");
+            if (np<=0) {reppath(path[i],files[0],ts,"",""); np=1;}
+            for (j=0;j<np;j++) job->pfile[job->np++]=files[j];
+            for (;j<MAXFILE;j++) free(files[j]);
+        }
+        else if ((job->pfile[job->np]=(char *)malloc(1024))) {
+            strcpy(job->pfile[job->np++],path[i]);
+        }
+    }
+    return 1;
+}
+/* read job list file ----------------------------------------------------------
+* each line: output file and input files. a line with keywords is expanded to
+* a job per day within ts and te.
+*-----------------------------------------------------------------------------*/
+static int readjobs(joblist_t *jl, const char *file, gtime_t ts, gtime_t te)
+{
+    FILE *fp;
+    gtime_t t,tts,tte;
+    char buff[4096],*p,*q,*path[MAXFILE+1];
+    double tow;
+    int i,n,week,keyword;
+
+    if (!(fp=fopen(file,"r"))) {
+        showmsg("error : job list open %s",file);
+        return 0;
+    }
+    while (fgets(buff,sizeof(buff),fp)) {
+        for (p=buff,n=0;n<MAXFILE+1;p=NULL) {
+            if (!(q=strtok(p," \t\r\n"))) break;
+            if (n==0&&*q=='#') break;
+            path[n++]=q;
+        }
+        if (n<2) continue;
+        for (i=keyword=0;i<n;i++) if (strchr(path[i],'%')) keyword=1;
+
+        if (!keyword||ts.time==0||te.time==0) {
+            if (!addjob(jl,ts,te,path,n)) break;
+            continue;
+        }
+        /* job per day */
+        tow=time2gpst(ts,&week);
+        t=gpst2time(week,86400.0*floor(tow/86400.0));
+        for (;timediff(t,te)<0.0;t=timeadd(t,86400.0)) {
+            tts=timediff(t,ts)<0.0?ts:t;
+            tte=timeadd(t,86400.0-DTTOL);
+            if (timediff(tte,te)>0.0) tte=te;
+            if (!addjob(jl,tts,tte,path,n)) break;
+        }
+    }
+    fclose(fp);
+    return jl->njob;
+}
+/* free job list -------------------------------------------------------------*/
+static void freejobs(joblist_t *jl)
+{
+    prodc_t *pc,*next;
+    int i,j;
+
+    for (i=0;i<jl->njob;i++) {
+        for (j=0;j<jl->jobs[i].n ;j++) free(jl->jobs[i].infile[j]);
+        for (j=0;j<jl->jobs[i].np;j++) free(jl->jobs[i].pfile[j]);
+    }
+    free(jl->jobs);
+    for (pc=jl->prodc;pc;pc=next) {
+        next=pc->next;
+        ppprodfree(&pc->prod);
+        free(pc->key);
+        free(pc);
+    }
+}
+/* number of processors ------------------------------------------------------*/
+static int nproc(void)
+{
+#ifdef WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    return (int)sysconf(_SC_NPROCESSORS_ONLN);
+#else
+    return 1;
+#endif
+}
+/* product cache key: files and modification times ---------------------------*/
+static char *prodkey(const job_t *job, const filopt_t *fopt)
+{
+    const char *files[MAXFILE+3];
+    struct stat st;
+    char *key;
+    size_t len=1;
+    int i,n=0;
+
+    files[n++]=fopt->satantp;
+    files[n++]=fopt->rcvantp;
+    files[n++]=fopt->satmeta;
+    for (i=0;i<job->np;i++) files[n++]=job->pfile[i];
+
+    for (i=0;i<n;i++) len+=strlen(files[i])+24;
+    if (!(key=(char *)malloc(len))) return NULL;
+    *key='\0';
+    for (i=0;i<n;i++) {
+        long mtime=*files[i]&&!stat(files[i],&st)?(long)st.st_mtime:0;
+        sprintf(key+strlen(key),"%s:%ld;",files[i],mtime);
+    }
+    return key;
+}
+/* get shared products from cache or read ------------------------------------*/
+static prodc_t *getprod(joblist_t *jl, const job_t *job)
+{
+    prodc_t *pc,*prev,*next;
+    char *key;
+    int nfree=0,stat;
+
+    if (!(key=prodkey(job,jl->fopt))) return NULL;
+
+    rtklib_lock(&jl->lock);
+    for (pc=jl->prodc;pc;pc=pc->next) {
+        if (!strcmp(pc->key,key)) break;
+    }
+    if (pc) {
+        pc->nref++;
+        free(key);
+
+        /* wait for the products read by another job */
+        while (pc->stat==0) rtklib_wait(&jl->cond,&jl->lock);
+        stat=pc->stat;
+        rtklib_unlock(&jl->lock);
+        return stat>0?pc:NULL;
+    }
+    /* free least recently added unused products */
+    for (prev=NULL,pc=jl->prodc;pc;pc=next) {
+        next=pc->next;
+        if (pc->nref>0||pc->stat==0||++nfree<MAXPRODC) {prev=pc; continue;}
+        ppprodfree(&pc->prod);
+        free(pc->key);
+        free(pc);
+        if (prev) prev->next=next; else jl->prodc=next;
+    }
+    if (!(pc=(prodc_t *)calloc(1,sizeof(prodc_t)))) {
+        free(key);
+        rtklib_unlock(&jl->lock);
+        return NULL;
+    }
+    pc->key=key;
+    pc->nref=1;
+    pc->next=jl->prodc;
+    jl->prodc=pc;
+    rtklib_unlock(&jl->lock);
+
+    stat=ppprodread(&pc->prod,jl->popt,jl->fopt,(const char **)job->pfile,
+                    job->np)?1:-1;
+    rtklib_lock(&jl->lock);
+    pc->stat=stat;
+    rtklib_broadcast(&jl->cond);
+    rtklib_unlock(&jl->lock);
+    return stat>0?pc:NULL;
+}
+/* job thread ----------------------------------------------------------------*/
+#ifdef WIN32
+static DWORD WINAPI jobthread(void *arg)
+#else
+static void *jobthread(void *arg)
+#endif
+{
+    joblist_t *jl=(joblist_t *)arg;
+    postpos_t *pp;
+    prodc_t *pc;
+    job_t *job;
+    uint32_t tick;
+
+    if (!(pp=postposnew(NULL))) return 0;
+    pp->passthread=!serial;
+
+    for (;;) {
+        rtklib_lock(&jl->lock);
+        job=jl->ijob<jl->njob?jl->jobs+jl->ijob++:NULL;
+        rtklib_unlock(&jl->lock);
+        if (!job) break;
+
+        tick=tickget();
+        if (!(pc=getprod(jl,job))) {
+            showmsg("error : products read %s",job->outfile);
+            job->stat=-1;
+        }
+        else {
+            pp->prod=&pc->prod;
+            job->stat=postposc(pp,job->ts,job->te,jl->ti,0.0,jl->popt,jl->sopt,
+                               jl->fopt,(const char **)job->infile,job->n,
+                               job->outfile,jl->rov,jl->base);
+            job->nep=pp->nep;
+        }
+        if (pc) {
+            rtklib_lock(&jl->lock);
+            pc->nref--;
+            rtklib_unlock(&jl->lock);
+        }
+        job->tt=(tickget()-tick)*1E-3;
+
+        rtklib_lock(&jl->lock);
+        fprintf(stderr,"job %4d: %-40s stat=%2d epochs=%7d %8.2f s %9.1f epochs/s\n",
+                (int)(job-jl->jobs)+1,job->outfile,job->stat,job->nep,job->tt,
+                job->tt>0.0?job->nep/job->tt:0.0);
+        rtklib_unlock(&jl->lock);
+    }
+    postposfree(pp);
+    return 0;
+}
+/* process job list ----------------------------------------------------------*/
+static int procjobs(const char *file, int nthread, gtime_t ts, gtime_t te,
+                    double ti, const prcopt_t *popt, const solopt_t *sopt,
+                    const filopt_t *fopt, const char *rov, const char *base)
+{
+    rtklib_thread_t thread[MAXJOBTHR];
+    joblist_t jl={0};
+    uint32_t tick=tickget();
+    double tt;
+    int i,n=0,nep=0,nerr=0;
+
+    if (!readjobs(&jl,file,ts,te)) {
+        showmsg("error : no job in %s",file);
+        return 0;
+    }
+    jl.popt=popt; jl.sopt=sopt; jl.fopt=fopt;
+    jl.ti=ti; jl.rov=rov; jl.base=base;
+    rtklib_initlock(&jl.lock);
+    rtklib_initcond(&jl.cond);
+
+    /* trace, solution statistics and geoid file are process wide */
+    if (nthread>1&&(sopt->trace>0||sopt->sstat>0||
+        (sopt->geoid>GEOID_EMBEDDED&&*fopt->geoid))) {
+        showmsg("warning : trace, solution status or geoid file in single thread");
+        nthread=1;
+    }
+    /* signal code priorities set before threads (not changed by sessions) */
+    init_code2idx(popt->sigdef);
+    if (nthread<1) nthread=1;
+    if (nthread>MAXJOBTHR) nthread=MAXJOBTHR;
+    if (nthread>jl.njob) nthread=jl.njob;
+
+    /* RINEX obs decoding threads of the jobs within processors */
+    setrnxthread(nproc()/nthread>1?nproc()/nthread:1,0);
+
+    if (sopt->geoid>0&&*fopt->geoid&&!opengeoid(sopt->geoid,fopt->geoid)) {
+        showmsg("error : no geoid data %s",fopt->geoid);
+    }
+    for (i=0;i<nthread;i++) {
+#ifdef WIN32
+        if (!(thread[i]=CreateThread(NULL,0,jobthread,&jl,0,NULL))) break;
+#else
+        if (pthread_create(thread+i,NULL,jobthread,&jl)) break;
+#endif
+    }
+    if (i==0) jobthread(&jl);
+    for (n=i,i=0;i<n;i++) {
+#ifdef WIN32
+        WaitForSingleObject(thread[i],INFINITE);
+        CloseHandle(thread[i]);
+#else
+        pthread_join(thread[i],NULL);
+#endif
+    }
+    closegeoid();
+    tt=(tickget()-tick)*1E-3;
+
+    for (i=0;i<jl.njob;i++) {
+        nep+=jl.jobs[i].nep;
+        if (jl.jobs[i].stat) nerr++;
+    }
+    fprintf(stderr,"jobs=%d errors=%d threads=%d epochs=%d %.2f s %.1f epochs/s\n",
+            jl.njob,nerr,n>0?n:1,nep,tt,tt>0.0?nep/tt:0.0);
+    freejobs(&jl);
+    return nerr==0;
+}
 /* print help ----------------------------------------------------------------*/
 static void printhelp(void)
 {
@@ -106,7 +474,9 @@ int main(int argc, char **argv)
     double tint=0.0,es[]={2000,1,1,0,0,0},ee[]={2000,12,31,23,59,59},pos[3];
     int i,j,n,ret;
     const char *infile[MAXFILE],*outfile="",*p;
-    const char *rover = "", *base = "";
+    const char *rover = "", *base = "", *jobfile = NULL;
+    postpos_t *pp;
+    int nthread=1;
 
     prcopt.mode  =PMODE_KINEMA;
     prcopt.navsys=0;
@@ -189,6 +559,13 @@ int main(int argc, char **argv)
         else if (!strcmp(argv[i],"--base")&&i+1<argc) base=argv[++i];
         else if (!strcmp(argv[i],"-y")&&i+1<argc) solopt.sstat=atoi(argv[++i]);
         else if (!strcmp(argv[i],"-x")&&i+1<argc) solopt.trace=atoi(argv[++i]);
+        else if (!strcmp(argv[i],"--verbose")) verbose=1;
+        else if (!strcmp(argv[i],"--serial")) serial=1;
+        else if (!strcmp(argv[i],"--jobs")&&i+1<argc) jobfile=argv[++i];
+        else if (!strcmp(argv[i],"--threads")&&i+1<argc) nthread=atoi(argv[++i]);
+        else if (!strcmp(argv[i],"--cache")&&i+1<argc) {
+            snprintf(filopt.cache,sizeof(filopt.cache),"%s",argv[++i]);
+        }
         else if (!strcmp(argv[i], "--version")) {
             fprintf(stderr, "rnx2rtkp RTKLIB %s %s\n", VER_RTKLIB, PATCH_LEVEL);
             exit(0);
@@ -199,6 +576,11 @@ int main(int argc, char **argv)
     if (!prcopt.navsys) {
         prcopt.navsys=SYS_GPS|SYS_GLO|SYS_GAL|SYS_BDS;
     }
+    if (jobfile) {
+        jobmode=1;
+        ret=procjobs(jobfile,nthread,ts,te,tint,&prcopt,&solopt,&filopt,rover,base);
+        return ret?0:EXIT_FAILURE;
+    }
     if (n<=0) {
         showmsg("error : no input file");
         return EXIT_FAILURE;
@@ -209,7 +591,14 @@ int main(int argc, char **argv)
         traceopen(filopt.trace);
         tracelevel(solopt.trace);
     }
-    ret=postpos(ts,te,tint,0.0,&prcopt,&solopt,&filopt,infile,n,outfile,rover,base);
+    if (!(pp=postposnew(NULL))) {
+        showmsg("error : memory allocation");
+        return EXIT_FAILURE;
+    }
+    pp->passthread=!serial;
+    setrnxthread(0,0); /* RINEX obs decoding threads by processors */
+    ret=postposc(pp,ts,te,tint,0.0,&prcopt,&solopt,&filopt,infile,n,outfile,rover,base);
+    postposfree(pp);
 
     if (!ret) fprintf(stderr,"%40s\r","");
     return ret?EXIT_FAILURE:0;
@@ -812,9 +812,12 @@ static void prstatus(vt_t *vt)
     pthread_t thread;
     int j,cycle,state,rtkstat,nsat0,nsat1,prcout,rcvcount,tmcount,timevalid,nave;
     int cputime,nb[RTKSVRNIN]={0},nmsg[RTKSVRNIN][10]={{0}};
+    int nq[RTKSVRNIN+1],npeak[RTKSVRNIN+1];
+    uint32_t nfull[RTKSVRNIN+1];
     char tstr[40],tmstr[40],s[1024],*p;
-    double runtime,rt[3]={0},dop[4]={0},rr[3],bl1=0.0,bl2=0.0;
+    double runtime,rt[3]={0},dop[4]={0},rr[3],bl1=0.0,bl2=0.0,lat[2];
     double azel[MAXSAT*2],pos[3],vel[3],*del;
+    double xf[3]={0},Pf[3]={0},xa[3]={0},Pa[3]={0};
     
     trace(4,"prstatus:\n");
     
@@ -830,14 +833,19 @@ static void prstatus(vt_t *vt)
 
     rtksvrlock(&svr);
     *rtk=svr.rtk;
+    /* the state arrays may be reallocated once unlocked */
+    for (int i=0;i<3&&i<rtk->nx;i++) {
+        xf[i]=rtk->x[i]; Pf[i]=rtk->P[i+i*rtk->nx];
+    }
+    for (int i=0;i<3&&i<rtk->na;i++) {
+        xa[i]=rtk->xa[i]; Pa[i]=rtk->Pa[i+i*rtk->na];
+    }
     thread=svr.thread;
     cycle=svr.cycle;
     state=svr.state;
     rtkstat=svr.rtk.sol.stat;
-    nsat0=svr.obs[0][0].n;
-    nsat1=svr.obs[1][0].n;
-    rcvcount = svr.raw[0].obs.rcvcount;
-    tmcount = svr.raw[0].obs.tmcount;
+    nsat0=svr.obs[0].n;
+    nsat1=svr.obs[1].n;
     cputime=svr.cputime;
     prcout=svr.prcout;
     nave=svr.nave;
@@ -850,13 +858,23 @@ static void prstatus(vt_t *vt)
         rt[0]=floor(runtime/3600.0); runtime-=rt[0]*3600.0;
         rt[1]=floor(runtime/60.0); rt[2]=runtime-rt[1]*60.0;
     }
-    for (int i=0;i<RTKSVRNIN;i++) *rtcm[i]=svr.rtcm[i];
+    for (int i=0;i<RTKSVRNIN;i++) {
+        rtksvrlockin(&svr,i);
+        *rtcm[i]=svr.rtcm[i];
+        rtksvrunlockin(&svr,i);
+    }
+    rtksvrlockin(&svr,0);
+    rcvcount = svr.raw[0].obs.rcvcount;
+    tmcount = svr.raw[0].obs.tmcount;
     if (svr.raw[0].obs.data != NULL) {
         timevalid = svr.raw[0].obs.data[0].timevalid;
         eventime = svr.raw[0].obs.data[0].eventime;
     }
+    rtksvrunlockin(&svr,0);
     time2str(eventime,tmstr,9);
     rtksvrunlock(&svr);
+    rtksvrlatency(&svr,lat,lat+1);
+    rtksvrqstat(&svr,nq,npeak,nfull);
 
     int n = 0;
     for (int i=0;i<MAXSAT;i++) {
@@ -885,6 +903,12 @@ static void prstatus(vt_t *vt)
     vt_printf(vt,"%-28s: %02.0f:%02.0f:%04.1f\n","accumulated time to run",rt[0],rt[1],rt[2]);
     vt_printf(vt,"%-28s: %d\n","cpu time for a cycle (ms)",cputime);
     vt_printf(vt,"%-28s: %d\n","missing obs data count",prcout);
+    vt_printf(vt,"%-28s: %.2f,%.2f\n","latency p50,p99 (ms)",lat[0],lat[1]);
+    p=s;
+    for (int i=0;i<=RTKSVRNIN;i++) {
+        p+=sprintf(p,"%s%d/%d/%u",i?",":"",nq[i],npeak[i],nfull[i]);
+    }
+    vt_printf(vt,"%-28s: %s\n","stage queue (n/peak/full)",s);
     vt_printf(vt,"%-28s: %d,%d\n","bytes in input buffer",nb[0],nb[1]);
     for (int i=0;i<RTKSVRNIN;i++) {
         sprintf(s,"# of input data %s", i < 2 ? type[i] : "corr");
@@ -937,13 +961,13 @@ static void prstatus(vt_t *vt)
     ecef2enu(pos,rtk->sol.rr+3,vel);
     vt_printf(vt,"%-28s: %.3f,%.3f,%.3f\n","vel enu (m/s) rover",vel[0],vel[1],vel[2]);
     vt_printf(vt,"%-28s: %.4f,%.4f,%.4f\n","pos xyz float (m) rover",
-            rtk->x?rtk->x[0]:0,rtk->x?rtk->x[1]:0,rtk->x?rtk->x[2]:0);
+            xf[0],xf[1],xf[2]);
     vt_printf(vt,"%-28s: %.4f,%.4f,%.4f\n","pos xyz float std (m) rover",
-            rtk->P?SQRT(rtk->P[0]):0,rtk->P?SQRT(rtk->P[1+1*rtk->nx]):0,rtk->P?SQRT(rtk->P[2+2*rtk->nx]):0);
+            SQRT(Pf[0]),SQRT(Pf[1]),SQRT(Pf[2]));
     vt_printf(vt,"%-28s: %.4f,%.4f,%.4f\n","pos xyz fixed (m) rover",
-            rtk->xa?rtk->xa[0]:0,rtk->xa?rtk->xa[1]:0,rtk->xa?rtk->xa[2]:0);
+            xa[0],xa[1],xa[2]);
     vt_printf(vt,"%-28s: %.4f,%.4f,%.4f\n","pos xyz fixed std (m) rover",
-            rtk->Pa?SQRT(rtk->Pa[0]):0,rtk->Pa?SQRT(rtk->Pa[1+1*rtk->na]):0,rtk->Pa?SQRT(rtk->Pa[2+2*rtk->na]):0);
+            SQRT(Pa[0]),SQRT(Pa[1]),SQRT(Pa[2]));
     vt_printf(vt,"%-28s: %s\n","base name", svr.name[1]);
     vt_printf(vt,"%-28s: %.4f,%.4f,%.4f\n","pos xyz (m) base",
             rtk->rb[0],rtk->rb[1],rtk->rb[2]);
@@ -960,12 +984,12 @@ static void prstatus(vt_t *vt)
     ecef2enu(pos,rtk->rb+3,vel);
     vt_printf(vt,"%-28s: %.3f,%.3f,%.3f\n","vel enu (m/s) base",
             vel[0],vel[1],vel[2]);
-    if (rtk->opt.mode>0&&rtk->x&&norm(rtk->x,3)>0.0) {
-        for (int i=0;i<3;i++) rr[i]=rtk->x[i]-rtk->rb[i];
+    if (rtk->opt.mode>0&&norm(xf,3)>0.0) {
+        for (int i=0;i<3;i++) rr[i]=xf[i]-rtk->rb[i];
         bl1=norm(rr,3);
     }
-    if (rtk->opt.mode>0&&rtk->xa&&norm(rtk->xa,3)>0.0) {
-        for (int i=0;i<3;i++) rr[i]=rtk->xa[i]-rtk->rb[i];
+    if (rtk->opt.mode>0&&norm(xa,3)>0.0) {
+        for (int i=0;i<3;i++) rr[i]=xa[i]-rtk->rb[i];
         bl2=norm(rr,3);
     }
     vt_printf(vt,"%-28s: %.4f\n","baseline length float (m)",bl1);
@@ -1058,11 +1082,11 @@ static void probserv(vt_t *vt, int nf)
     }
 
     rtksvrlock(&svr);
-    for (i=0;i<svr.obs[0][0].n&&n<MAXOBS*2;i++) {
-        obs[n++]=svr.obs[0][0].data[i];
+    for (i=0;i<svr.obs[0].n&&n<MAXOBS*2;i++) {
+        obs[n++]=svr.obs[0].data[i];
     }
-    for (i=0;i<svr.obs[1][0].n&&n<MAXOBS*2;i++) {
-        obs[n++]=svr.obs[1][0].data[i];
+    for (i=0;i<svr.obs[1].n&&n<MAXOBS*2;i++) {
+        obs[n++]=svr.obs[1].data[i];
     }
     rtksvrunlock(&svr);
     
@@ -1358,11 +1382,14 @@ static void prssr(vt_t *vt, int ri, int cbias, int pbias, int prev)
     
     rtksvrlock(&svr);
     time=svr.rtk.sol.time;
-    for (i=0;i<MAXSAT;i++) {
-      if (ri <= 0 || ri > RTKSVRNIN)
+    if (ri <= 0 || ri > RTKSVRNIN) {
+      for (i=0;i<MAXSAT;i++)
         ssr[i] = prev ? svr.nav.ssr[i][1] : svr.nav.ssr[i][0];
-      else
-        ssr[i] = svr.rtcm[ri - 1].ssr[i];
+    }
+    else {
+      rtksvrlockin(&svr,ri-1);
+      for (i=0;i<MAXSAT;i++) ssr[i] = svr.rtcm[ri - 1].ssr[i];
+      rtksvrunlockin(&svr,ri-1);
     }
     rtksvrunlock(&svr);
     
@@ -2305,6 +2332,7 @@ int main(int argc, char **argv)
     if (!readnav(NAVIFILE,&svr.nav)) {
         fprintf(stderr,"no navigation data: %s\n",NAVIFILE);
     }
+    evalnav(&svr.nav,prcopt.gloorb);
     if (!outstatp) outstat = solopt->sstat;
     if (outstat > 0) {
         rtkopenstat(filopt.solstat[0] != '\0' ? filopt.solstat : STATFILE, outstat);
@@ -115,6 +115,8 @@ static const char *help[]={
 " -l  local_dir     ftp/http local directory []",
 " -x  proxy_addr    http/ntrip proxy address [no]",
 " -b  str_no        relay back messages from output str to input str [no]",
+" -q  nmsg          output queue length per tcpsvr/ntripc client (messages) [256]",
+" -qp policy        output queue full policy (0:drop oldest,1:disconnect) [0]",
 " -t  level         trace level [0]",
 " -fl file          log file [str2str.trace]",
 " --daemon          detach from the console",
@@ -295,6 +297,7 @@ int main(int argc, char **argv)
     char strmsg[MAXSTRMSG]="",*antinfo="",*rcvinfo="";
     char *ant[]={"","",""},*rcv[]={"","",""},*logfile="";
     int i,j,n=0,dispint=5000,trlevel=0,opts[]={10000,10000,2000,32768,10,0,30,0};
+    int qlen=0,qpol=0;
     int types[MAXSTR]={STR_FILE,STR_FILE},stat[MAXSTR]={0},log_stat[MAXSTR]={0};
     int byte[MAXSTR]={0},bps[MAXSTR]={0},fmts[MAXSTR]={0},sta=0;
     int daemon=0;
@@ -364,6 +367,8 @@ int main(int argc, char **argv)
         else if (!strcmp(argv[i],"-l"  )&&i+1<argc) local=argv[++i];
         else if (!strcmp(argv[i],"-x"  )&&i+1<argc) proxy=argv[++i];
         else if (!strcmp(argv[i],"-b"  )&&i+1<argc) opts[7]=atoi(argv[++i]);
+        else if (!strcmp(argv[i],"-q"  )&&i+1<argc) qlen=atoi(argv[++i]);
+        else if (!strcmp(argv[i],"-qp" )&&i+1<argc) qpol=atoi(argv[++i]);
         else if (!strcmp(argv[i],"-fl" )&&i+1<argc) logfile=argv[++i];
         else if (!strcmp(argv[i],"-t"  )&&i+1<argc) trlevel=atoi(argv[++i]);
         else if (!strcmp(argv[i], "--daemon")) daemon=1;
@@ -416,6 +421,7 @@ int main(int argc, char **argv)
     signal(SIGPIPE,SIG_IGN);
     
     strsvrinit(&strsvr,n+1);
+    strsvrsetcliq(&strsvr,qlen,qpol);
     
     if (trlevel>0) {
         traceopen(*logfile?logfile:TRACEFILE);
@@ -89,9 +89,9 @@ void MonitorDialog::displayTypeChanged()
         // Clear the peek buffers.
         rtksvrlock(rtksvr);
         if (index == 16) {
-          for (int i = 0; i < RTKSVRNIN; i++) rtksvr->npb[i] = 0;
+          for (int i = 0; i < RTKSVRNIN; i++) rtksvrpeek(rtksvr, i, NULL, rtksvr->buffsize);
         } else if (index == 17) {
-          for (int i = 0; i < RTKSVRNSOL; i++) rtksvr->nsb[i] = 0;
+          for (int i = 0; i < RTKSVRNSOL; i++) rtksvrpeek(rtksvr, RTKSVRNIN * 2 + i, NULL, rtksvr->buffsize);
         } else rtksvr->rtk.neb = 0;
         rtksvrunlock(rtksvr);
     }
@@ -249,29 +249,24 @@ void MonitorDialog::showBuffers()
             // Combined
             len = 0;
             for (int i = 0; i < RTKSVRNIN; i++)
-                len += rtksvr->npb[i];
+                len += ringcount(&rtksvr->pbuf[i]);
             if (len > 0 && (msg = (uint8_t *)malloc(size_t(len)))) {
-                for (int i = 0, j = 0; i < RTKSVRNIN; i++) {
-                    int ilen = rtksvr->npb[i];
-                    if (ilen > 0) {
-                        memcpy(msg + j, rtksvr->pbuf[i], size_t(ilen));
-                        rtksvr->npb[i] = 0;
-                        j += ilen;
-                    }
+                int j = 0;
+                for (int i = 0; i < RTKSVRNIN; i++) {
+                    j += rtksvrpeek(rtksvr, i, msg + j, len - j);
                 }
+                len = j;
             }
         } else {
-            len = rtksvr->npb[inputStream];
+            len = ringcount(&rtksvr->pbuf[inputStream]);
             if (len > 0 && (msg = (uint8_t *)malloc(size_t(len)))) {
-                memcpy(msg, rtksvr->pbuf[inputStream], size_t(len));
-                rtksvr->npb[inputStream] = 0;
+                len = rtksvrpeek(rtksvr, inputStream, msg, len);
             }
         }
     } else if (displayType == 17) { // solution buffer
-        len = rtksvr->nsb[solutionStream];
+        len = ringcount(&rtksvr->sbuf[solutionStream]);
         if (len > 0 && (msg = (uint8_t*)malloc(size_t(len)))) {
-            memcpy(msg, rtksvr->sbuf[solutionStream], size_t(len));
-            rtksvr->nsb[solutionStream] = 0;
+            len = rtksvrpeek(rtksvr, RTKSVRNIN * 2 + solutionStream, msg, len);
 		}
     } else { // error message buffer
         len = rtksvr->rtk.neb;
@@ -422,6 +417,7 @@ void MonitorDialog::showRtk()
     int cputime, nb[RTKSVRNIN] = {0};
     unsigned int nmsg[RTKSVRNIN][10] = {{0}};
     char tstr[40], id[8];
+    double xf[3] = {0}, Pf[3] = {0}, xa[3] = {0}, Pa[3] = {0};
     char file[1024] = "";
     const QString ionoopt[] = {tr("OFF"), tr("Broadcast"), tr("SBAS"), tr("Dual-Frequency"), tr("Estimate STEC"), tr("IONEX TEC"), tr("QZSS LEX"), tr("SSR VTEC")};
     const QString tropopt[] = {tr("OFF"), tr("Saastamoinen"), tr("SBAS"), tr("Estimate ZTD"), tr("Estimate ZTD+Grad")};
@@ -434,11 +430,18 @@ void MonitorDialog::showRtk()
     rtksvrlock(rtksvr); // lock
 
     *rtk = rtksvr->rtk;
+    // The state arrays may be reallocated once unlocked.
+    for (int i = 0; i < 3 && i < rtk->nx; i++) {
+        xf[i] = rtk->x[i]; Pf[i] = rtk->P[i + i * rtk->nx];
+    }
+    for (int i = 0; i < 3 && i < rtk->na; i++) {
+        xa[i] = rtk->xa[i]; Pa[i] = rtk->Pa[i + i * rtk->na];
+    }
     cycle = rtksvr->cycle;
     state = rtksvr->state < 0 || rtksvr->state > 1 ? 0 : rtksvr->state;
     rtkstat = rtksvr->rtk.sol.stat > MAXSOLQ ? 0 : rtksvr->rtk.sol.stat;
-    nsat0 = rtksvr->obs[0][0].n;
-    nsat1 = rtksvr->obs[1][0].n;
+    nsat0 = rtksvr->obs[0].n;
+    nsat1 = rtksvr->obs[1].n;
     cputime = rtksvr->cputime;
     prcout = rtksvr->prcout;
     nave = rtksvr->nave;
@@ -680,19 +683,19 @@ void MonitorDialog::showRtk()
 
     ui->tWConsole->item(row,   0)->setText(tr("Pos X/Y/Z Float Rover"));
     ui->tWConsole->item(row++, 1)->setText(QStringLiteral("%1 m, %2 m, %3 m")
-                              .arg(rtk->x ? rtk->x[0] : 0, 0, 'f', 3).arg(rtk->x ? rtk->x[1] : 0, 0, 'f', 3).arg(rtk->x ? rtk->x[2] : 0, 0, 'f', 3));
+                              .arg(xf[0], 0, 'f', 3).arg(xf[1], 0, 'f', 3).arg(xf[2], 0, 'f', 3));
 
     ui->tWConsole->item(row,   0)->setText(tr("Pos X/Y/Z Float Std Rover"));
     ui->tWConsole->item(row++, 1)->setText(QString("%1 m, %2 m, %3 m")
-                              .arg(rtk->P ? SQRT(rtk->P[0]) : 0, 0, 'f', 3).arg(rtk->P ? SQRT(rtk->P[1 + 1 * rtk->nx]) : 0, 0, 'f', 3).arg(rtk->P ? SQRT(rtk->P[2 + 2 * rtk->nx]) : 0, 0, 'f', 3));
+                              .arg(SQRT(Pf[0]), 0, 'f', 3).arg(SQRT(Pf[1]), 0, 'f', 3).arg(SQRT(Pf[2]), 0, 'f', 3));
 
     ui->tWConsole->item(row,   0)->setText(tr("Pos X/Y/Z Fixed Rover"));
     ui->tWConsole->item(row++, 1)->setText(QStringLiteral("%1 m, %2 m, %3 m")
-                              .arg(rtk->xa ? rtk->xa[0] : 0, 0, 'f', 3).arg(rtk->xa ? rtk->xa[1] : 0, 0, 'f', 3).arg(rtk->xa ? rtk->xa[2] : 0, 0, 'f', 3));
+                              .arg(xa[0], 0, 'f', 3).arg(xa[1], 0, 'f', 3).arg(xa[2], 0, 'f', 3));
 
     ui->tWConsole->item(row,   0)->setText(tr("Pos X/Y/Z Fixed Std Rover"));
     ui->tWConsole->item(row++, 1)->setText(QStringLiteral("%1 m, %2 m, %3 m")
-                              .arg(rtk->Pa ? SQRT(rtk->Pa[0]) : 0, 0, 'f', 3).arg(rtk->Pa ? SQRT(rtk->Pa[1 + 1 * rtk->na]) : 0, 0, 'f', 3).arg(rtk->Pa ? SQRT(rtk->Pa[2 + 2 * rtk->na]) : 0, 0, 'f', 3));
+                              .arg(SQRT(Pa[0]), 0, 'f', 3).arg(SQRT(Pa[1]), 0, 'f', 3).arg(SQRT(Pa[2]), 0, 'f', 3));
 
     ui->tWConsole->item(row,   0)->setText(tr("Base Name"));
     ui->tWConsole->item(row++, 1)->setText(name[1]);
@@ -995,6 +998,7 @@ void MonitorDialog::showEstimates()
 	gtime_t time;
     unsigned int i, nx, na, n;
     double *x, *P = NULL, *xa = NULL, *Pa = NULL;
+    int *xk = NULL;
     QString s0 = "-";
 	char tstr[40];
 
@@ -1006,14 +1010,16 @@ void MonitorDialog::showEstimates()
     if ((x = (double *)malloc(sizeof(double) * nx)) &&
         (P = (double *)malloc(sizeof(double) * nx * nx)) &&
         (xa = (double *)malloc(sizeof(double) * na)) &&
-        (Pa = (double *)malloc(sizeof(double) * na * na))) {
+        (Pa = (double *)malloc(sizeof(double) * na * na)) &&
+        (xk = (int *)malloc(sizeof(int) * nx))) {
         memcpy(x, rtksvr->rtk.x, sizeof(double) * nx);
         memcpy(P, rtksvr->rtk.P, sizeof(double) * nx * nx);
         memcpy(xa, rtksvr->rtk.xa, sizeof(double) * na);
         memcpy(Pa, rtksvr->rtk.Pa, sizeof(double) * na * na);
+        memcpy(xk, rtksvr->rtk.xk, sizeof(int) * nx);
     } else {
         rtksvrunlock(rtksvr);
-        free(x); free(P); free(xa); free(Pa);
+        free(x); free(P); free(xa); free(Pa); free(xk);
         return;
     }
     rtksvrunlock(rtksvr);
@@ -1027,7 +1033,7 @@ void MonitorDialog::showEstimates()
 	}
     if (n < 1) {
         ui->tWConsole->setRowCount(0);
-        free(x); free(P); free(xa); free(Pa);
+        free(x); free(P); free(xa); free(Pa); free(xk);
 		return;
 	}
 
@@ -1041,14 +1047,14 @@ void MonitorDialog::showEstimates()
     for (i = 0, n = 0; i < nx; i++) {
         int j = 0;
         if (ui->cBSelectSatellites->currentIndex() == 1 && x[i] == 0.0) continue;
-        ui->tWConsole->item(n, j++)->setText(tr("X_%1").arg(i + 1));
+        ui->tWConsole->item(n, j++)->setText(tr("X_%1").arg(xk[i] + 1));
         ui->tWConsole->item(n, j++)->setText(x[i] == 0.0 ? s0 : QString::number(x[i], 'f', 3));
         ui->tWConsole->item(n, j++)->setText(P[i + i * nx] == 0.0 ? s0 : QString::number(SQRT(P[i + i * nx]), 'f', 3));
         ui->tWConsole->item(n, j++)->setText((i >= na || qFuzzyCompare(xa[i], 0)) ? s0 : QString::number(xa[i], 'f', 3));
         ui->tWConsole->item(n, j++)->setText((i >= na || Pa[i + i * na] == 0.0) ? s0 : QString::number(SQRT(Pa[i + i * na]), 'f', 3));
 		n++;
 	}
-	free(x); free(P); free(xa); free(Pa);
+	free(x); free(P); free(xa); free(Pa); free(xk);
 }
 //---------------------------------------------------------------------------
 void MonitorDialog::setCovariance()
@@ -1066,6 +1072,7 @@ void MonitorDialog::showCovariance()
 	gtime_t time;
     int i, j, nx, n, m;
     double *x, *P = NULL;
+    int *xk = NULL;
     static QString s0 = "-";
 	char tstr[40];
 
@@ -1074,11 +1081,13 @@ void MonitorDialog::showCovariance()
     time = rtksvr->rtk.sol.time;
     nx = rtksvr->rtk.nx;
     if ((x = (double *)malloc(sizeof(double) * nx)) &&
-        (P = (double *)malloc(sizeof(double) * nx * nx))) {
+        (P = (double *)malloc(sizeof(double) * nx * nx)) &&
+        (xk = (int *)malloc(sizeof(int) * nx))) {
         memcpy(x, rtksvr->rtk.x, sizeof(double) * nx);
         memcpy(P, rtksvr->rtk.P, sizeof(double) * nx * nx);
+        memcpy(xk, rtksvr->rtk.xk, sizeof(int) * nx);
     } else {
-        free(x); free(P);
+        free(x); free(P); free(xk);
         rtksvrunlock(rtksvr);
         return;
     }
@@ -1094,7 +1103,7 @@ void MonitorDialog::showCovariance()
     if (n < 1) {
         ui->tWConsole->setColumnCount(0);
         ui->tWConsole->setRowCount(0);
-        free(x); free(P);
+        free(x); free(P); free(xk);
         return;
 	}
 
@@ -1113,8 +1122,8 @@ void MonitorDialog::showCovariance()
         if (ui->cBSelectSatellites->currentIndex() == 1 && (x[i] == 0.0 || P[i + i * nx] == 0.0)) continue;
 
         ui->tWConsole->setColumnWidth(n, 45 * fontScale / 96);
-        ui->tWConsole->horizontalHeaderItem(n)->setText(tr("X_%1").arg(i + 1));
-        ui->tWConsole->verticalHeaderItem(n)->setText(tr("X_%1").arg(i + 1));
+        ui->tWConsole->horizontalHeaderItem(n)->setText(tr("X_%1").arg(xk[i] + 1));
+        ui->tWConsole->verticalHeaderItem(n)->setText(tr("X_%1").arg(xk[i] + 1));
 
         for (j = 0, m = 0; j < nx; j++) {
             if (ui->cBSelectSatellites->currentIndex() == 1 && (x[j] == 0.0 || P[j + j * nx] == 0.0)) continue;
@@ -1124,7 +1133,7 @@ void MonitorDialog::showCovariance()
 		}
 		n++;
 	}
-	free(x); free(P);
+	free(x); free(P); free(xk);
 }
 //---------------------------------------------------------------------------
 void MonitorDialog::setObservations()
@@ -1195,13 +1204,13 @@ void MonitorDialog::showObservations()
     }
 
     rtksvrlock(rtksvr);
-    for (i = 0; i < rtksvr->obs[0][0].n && n < MAXOBS * 2; i++) {
-        if (!(satsyst(rtksvr->obs[0][0].data[i].sat, rtksvr->obs[0][0].data[i].time, NULL) & sys)) continue;
-        obs[n++] = rtksvr->obs[0][0].data[i];
+    for (i = 0; i < rtksvr->obs[0].n && n < MAXOBS * 2; i++) {
+        if (!(satsyst(rtksvr->obs[0].data[i].sat, rtksvr->obs[0].data[i].time, NULL) & sys)) continue;
+        obs[n++] = rtksvr->obs[0].data[i];
     }
-    for (i = 0; i < rtksvr->obs[1][0].n && n < MAXOBS * 2; i++) {
-        if (!(satsyst(rtksvr->obs[1][0].data[i].sat, rtksvr->obs[1][0].data[i].time, NULL) & sys)) continue;
-        obs[n++] = rtksvr->obs[1][0].data[i];
+    for (i = 0; i < rtksvr->obs[1].n && n < MAXOBS * 2; i++) {
+        if (!(satsyst(rtksvr->obs[1].data[i].sat, rtksvr->obs[1].data[i].time, NULL) & sys)) continue;
+        obs[n++] = rtksvr->obs[1].data[i];
     }
     rtksvrunlock(rtksvr);
 
@@ -2063,7 +2072,9 @@ void MonitorDialog::showRtcm()
 
     rtksvrlock(rtksvr);
     format = rtksvr->format[effectiveStream];
+    rtksvrlockin(rtksvr, effectiveStream);
     *rtcm = rtksvr->rtcm[effectiveStream];
+    rtksvrunlockin(rtksvr, effectiveStream);
     rtksvrunlock(rtksvr);
 
     if (rtcm->time.time) time2str(rtcm->time, tstr, 3);
@@ -2211,6 +2222,7 @@ void MonitorDialog::showRtcmSsr()
     int effectiveStream = (inputStream < 0 || inputStream >= RTKSVRNIN) ? 0 : inputStream;
 
     rtksvrlock(rtksvr);
+    rtksvrlockin(rtksvr, effectiveStream);
     time = rtksvr->rtk.sol.time;
     for (i = n = 0; i < MAXSAT; i++) {
         if (!(satsyst(i + 1, time, NULL) & sys)) continue;
@@ -2222,6 +2234,7 @@ void MonitorDialog::showRtcmSsr()
         if (ui->cBSelectSatellites->currentIndex() && !valid) continue;
         sat[n++] = i + 1;
     }
+    rtksvrunlockin(rtksvr, effectiveStream);
     rtksvrunlock(rtksvr);
 
     if (ui->tWConsole->rowCount() != n) {
@@ -2304,6 +2317,7 @@ void MonitorDialog::showReferenceStation()
 
     rtksvrlock(rtksvr);
     format = rtksvr->format[effectiveStream];
+    rtksvrlockin(rtksvr, effectiveStream);
     if (format == STRFMT_RTCM2 || format == STRFMT_RTCM3) {
         time = rtksvr->rtcm[effectiveStream].time;
         sta = rtksvr->rtcm[effectiveStream].sta;
@@ -2312,6 +2326,7 @@ void MonitorDialog::showReferenceStation()
         time = rtksvr->raw[effectiveStream].time;
         sta = rtksvr->raw[effectiveStream].sta;
     }
+    rtksvrunlockin(rtksvr, effectiveStream);
     rtksvrunlock(rtksvr);
 
     ui->tWConsole->item(i,   0)->setText(tr("Format"));
@@ -75,9 +75,9 @@ void __fastcall TMonitorDialog::TypeChange(TObject *Sender)
 		// Clear the peek buffers.
 		rtksvrlock(&rtksvr);
                 if (TypeF == 16) {
-                  for (int i = 0; i < RTKSVRNIN; i++) rtksvr.npb[i] = 0;
+                  for (int i = 0; i < RTKSVRNIN; i++) rtksvrpeek(&rtksvr, i, NULL, rtksvr.buffsize);
                 } else if (TypeF == 17) {
-                  for (int i = 0; i < RTKSVRNSOL; i++) rtksvr.nsb[i] = 0;
+                  for (int i = 0; i < RTKSVRNSOL; i++) rtksvrpeek(&rtksvr, RTKSVRNIN * 2 + i, NULL, rtksvr.buffsize);
                 } else rtksvr.rtk.neb = 0;
 		rtksvrunlock(&rtksvr);
 	}
@@ -192,17 +192,15 @@ void __fastcall TMonitorDialog::Timer2Timer(TObject *Sender)
 	rtksvrlock(&rtksvr);
 	
 	if (TypeF==16) { // input buffer
-		len=rtksvr.npb[Str1];
+		len=ringcount(&rtksvr.pbuf[Str1]);
 		if (len>0&&(msg=(uint8_t *)malloc(len))) {
-			memcpy(msg,rtksvr.pbuf[Str1],len);
-			rtksvr.npb[Str1]=0;
+			len=rtksvrpeek(&rtksvr,Str1,msg,len);
 		}
 	}
 	else if (TypeF==17) { // solution buffer
-		len=rtksvr.nsb[Str2];
+		len=ringcount(&rtksvr.sbuf[Str2]);
 		if (len>0&&(msg=(uint8_t *)malloc(len))) {
-			memcpy(msg,rtksvr.sbuf[Str2],len);
-			rtksvr.nsb[Str2]=0;
+			len=rtksvrpeek(&rtksvr,RTKSVRNIN*2+Str2,msg,len);
 		}
 	}
 	else { // error message buffer
@@ -371,6 +369,7 @@ void __fastcall TMonitorDialog::ShowRtk(void)
 	int i,j,k,thread,cycle,state,rtkstat,nsat0,nsat1,prcout,nave;
 	int cputime,nb[RTKSVRNIN]={0},nmsg[RTKSVRNIN][10]={{0}};
 	char tstr[40],*ant,id[8];
+	double xf[3]={0},Pf[3]={0},xa[3]={0},Pa[3]={0};
 	char file[1024]="";
 	const char *ionoopt[]={"OFF","Broadcast","SBAS","Dual-Frequency","Estimate STEC","IONEX TEC","QZSS LEX","SSR VTEC",""};
 	const char *tropopt[]={"OFF","Saastamoinen","SBAS","Estimate ZTD","Estimate ZTD+Grad",""};
@@ -383,12 +382,19 @@ void __fastcall TMonitorDialog::ShowRtk(void)
 	rtksvrlock(&rtksvr); // lock
 	
 	*rtk=rtksvr.rtk;
+	// The state arrays may be reallocated once unlocked.
+	for (i=0;i<3&&i<rtk->nx;i++) {
+		xf[i]=rtk->x[i]; Pf[i]=rtk->P[i+i*rtk->nx];
+	}
+	for (i=0;i<3&&i<rtk->na;i++) {
+		xa[i]=rtk->xa[i]; Pa[i]=rtk->Pa[i+i*rtk->na];
+	}
 	thread=(int)rtksvr.thread;
 	cycle=rtksvr.cycle;
 	state=rtksvr.state;
 	rtkstat=rtksvr.rtk.sol.stat;
-	nsat0=rtksvr.obs[0][0].n;
-	nsat1=rtksvr.obs[1][0].n;
+	nsat0=rtksvr.obs[0].n;
+	nsat1=rtksvr.obs[1].n;
 	cputime=rtksvr.cputime;
 	prcout =rtksvr.prcout;
 	nave=rtksvr.nave;
@@ -611,20 +617,18 @@ void __fastcall TMonitorDialog::ShowRtk(void)
 	Tbl->Cells[1][i++]=s.sprintf("%.3f, %.3f, %.3f",vel[0],vel[1],vel[2]);
 	
 	Tbl->Cells[0][i  ]="Pos X/Y/Z Float (m) Rover";
-	Tbl->Cells[1][i++]=s.sprintf("%.3f, %.3f, %.3f",
-		rtk->x?rtk->x[0]:0,rtk->x?rtk->x[1]:0,rtk->x?rtk->x[2]:0);
+	Tbl->Cells[1][i++]=s.sprintf("%.3f, %.3f, %.3f",xf[0],xf[1],xf[2]);
 	
 	Tbl->Cells[0][i  ]="Pos X/Y/Z Float Std (m) Rover";
 	Tbl->Cells[1][i++]=s.sprintf("%.3f, %.3f, %.3f",
-		rtk->P?SQRT(rtk->P[0]):0,rtk->P?SQRT(rtk->P[1+1*rtk->nx]):0,rtk->P?SQRT(rtk->P[2+2*rtk->nx]):0);
+		SQRT(Pf[0]),SQRT(Pf[1]),SQRT(Pf[2]));
 	
 	Tbl->Cells[0][i  ]="Pos X/Y/Z Fixed (m) Rover";
-	Tbl->Cells[1][i++]=s.sprintf("%.3f, %.3f, %.3f",
-		rtk->xa?rtk->xa[0]:0,rtk->xa?rtk->xa[1]:0,rtk->xa?rtk->xa[2]:0);
+	Tbl->Cells[1][i++]=s.sprintf("%.3f, %.3f, %.3f",xa[0],xa[1],xa[2]);
 	
 	Tbl->Cells[0][i  ]="Pos X/Y/Z Fixed Std (m) Rover";
 	Tbl->Cells[1][i++]=s.sprintf("%.3f, %.3f, %.3f",
-		rtk->Pa?SQRT(rtk->Pa[0]):0,rtk->Pa?SQRT(rtk->Pa[1+1*rtk->na]):0,rtk->Pa?SQRT(rtk->Pa[2+2*rtk->na]):0);
+		SQRT(Pa[0]),SQRT(Pa[1]),SQRT(Pa[2]));
 	
 	Tbl->Cells[0][i  ]="Base Name";
 	Tbl->Cells[1][i++]=name[1];
@@ -929,6 +933,7 @@ void __fastcall TMonitorDialog::ShowEst(void)
 	gtime_t time;
 	int i,nx,na,n;
 	double *x,*P=NULL,*xa=NULL,*Pa=NULL;
+	int *xk=NULL;
 	AnsiString s,s0="-";
 	char tstr[40];
 
@@ -940,15 +945,17 @@ void __fastcall TMonitorDialog::ShowEst(void)
 	if ((x =(double *)malloc(sizeof(double)*nx))&&
 	    (P =(double *)malloc(sizeof(double)*nx*nx))&&
 		(xa=(double *)malloc(sizeof(double)*na))&&
-	    (Pa=(double *)malloc(sizeof(double)*na*na))) {
+	    (Pa=(double *)malloc(sizeof(double)*na*na))&&
+	    (xk=(int *)malloc(sizeof(int)*nx))) {
 		memcpy(x ,rtksvr.rtk.x ,sizeof(double)*nx);
 		memcpy(P ,rtksvr.rtk.P ,sizeof(double)*nx*nx);
 		memcpy(xa,rtksvr.rtk.xa,sizeof(double)*na);
 		memcpy(Pa,rtksvr.rtk.Pa,sizeof(double)*na*na);
+		memcpy(xk,rtksvr.rtk.xk,sizeof(int)*nx);
 	}
 	else {
 		rtksvrunlock(&rtksvr);
-		free(x); free(P); free(xa); free(Pa);
+		free(x); free(P); free(xa); free(Pa); free(xk);
 		return;
 	}
 	rtksvrunlock(&rtksvr);
@@ -960,6 +967,7 @@ void __fastcall TMonitorDialog::ShowEst(void)
 	if (n<2) {
 		Tbl->RowCount=2;
 		for (i=0;i<Tbl->ColCount;i++) Tbl->Cells[i][1]="";
+		free(x); free(P); free(xa); free(Pa); free(xk);
 		return;
 	}
 	Tbl->RowCount=n;
@@ -969,14 +977,14 @@ void __fastcall TMonitorDialog::ShowEst(void)
 	for (i=0,n=1;i<nx;i++) {
 		int j=0;
 		if (SelSat->ItemIndex==1&&x[i]==0.0) continue;
-		Tbl->Cells[j++][n]=s.sprintf("X_%d",i+1);
+		Tbl->Cells[j++][n]=s.sprintf("X_%d",xk[i]+1);
 		Tbl->Cells[j++][n]=x[i]==0.0?s0:s.sprintf("%.3f",x[i]);
 		Tbl->Cells[j++][n]=P[i+i*nx]==0.0?s0:s.sprintf("%.3f",SQRT(P[i+i*nx]));
 		Tbl->Cells[j++][n]=i>=na||xa[i]==0?s0:s.sprintf("%.3f",xa[i]);
 		Tbl->Cells[j++][n]=i>=na||Pa[i+i*na]==0.0?s0:s.sprintf("%.3f",SQRT(Pa[i+i*na]));
 		n++;
 	}
-	free(x); free(P); free(xa); free(Pa);
+	free(x); free(P); free(xa); free(Pa); free(xk);
 }
 //---------------------------------------------------------------------------
 void __fastcall TMonitorDialog::SetCov(void)
@@ -997,6 +1005,7 @@ void __fastcall TMonitorDialog::ShowCov(void)
 	gtime_t time;
 	int i,j,nx,n,m;
 	double *x,*P=NULL;
+	int *xk=NULL;
 	AnsiString s,s0="-";
 	char tstr[40];
 
@@ -1005,13 +1014,15 @@ void __fastcall TMonitorDialog::ShowCov(void)
 	time=rtksvr.rtk.sol.time;
 	nx=rtksvr.rtk.nx;
 	if ((x =(double *)malloc(sizeof(double)*nx))&&
-	    (P =(double *)malloc(sizeof(double)*nx*nx))) {
+	    (P =(double *)malloc(sizeof(double)*nx*nx))&&
+	    (xk=(int *)malloc(sizeof(int)*nx))) {
 		memcpy(x ,rtksvr.rtk.x ,sizeof(double)*nx);
 		memcpy(P ,rtksvr.rtk.P ,sizeof(double)*nx*nx);
+		memcpy(xk,rtksvr.rtk.xk,sizeof(int)*nx);
 	}
 	else {
 		rtksvrunlock(&rtksvr);
-		free(x); free(P);
+		free(x); free(P); free(xk);
 		return;
 	}
 	rtksvrunlock(&rtksvr);
@@ -1024,6 +1035,7 @@ void __fastcall TMonitorDialog::ShowCov(void)
 		Tbl->ColCount=2;
 		Tbl->RowCount=2;
 		Tbl->Cells[1][1]="";
+		free(x); free(P); free(xk);
 		return;
 	}
 	Tbl->ColCount=n;
@@ -1034,8 +1046,8 @@ void __fastcall TMonitorDialog::ShowCov(void)
 	for (i=0,n=1;i<nx;i++) {
 		if (SelSat->ItemIndex==1&&(x[i]==0.0||P[i+i*nx]==0.0)) continue;
 		Tbl->ColWidths[n]=45*FontScale/96;
-		Tbl->Cells[0][n]=s.sprintf("X_%d",i+1);
-		Tbl->Cells[n][0]=s.sprintf("X_%d",i+1);
+		Tbl->Cells[0][n]=s.sprintf("X_%d",xk[i]+1);
+		Tbl->Cells[n][0]=s.sprintf("X_%d",xk[i]+1);
 		for (j=0,m=1;j<nx;j++) {
 			if (SelSat->ItemIndex==1&&(x[j]==0.0||P[j+j*nx]==0.0)) continue;
 			Tbl->Cells[m][n]=
@@ -1044,7 +1056,7 @@ void __fastcall TMonitorDialog::ShowCov(void)
 		}
 		n++;
 	}
-	free(x); free(P);
+	free(x); free(P); free(xk);
 }
 //---------------------------------------------------------------------------
 void __fastcall TMonitorDialog::SetObs(void)
@@ -1105,13 +1117,13 @@ void __fastcall TMonitorDialog::ShowObs(void)
         }
 
 	rtksvrlock(&rtksvr);
-	for (i=0;i<rtksvr.obs[0][0].n&&n<MAXOBS*2;i++) {
-        if (!(satsyst(rtksvr.obs[0][0].data[i].sat,rtksvr.obs[0][0].data[i].time,NULL)&sys)) continue;
-		obs[n++]=rtksvr.obs[0][0].data[i];
+	for (i=0;i<rtksvr.obs[0].n&&n<MAXOBS*2;i++) {
+        if (!(satsyst(rtksvr.obs[0].data[i].sat,rtksvr.obs[0].data[i].time,NULL)&sys)) continue;
+		obs[n++]=rtksvr.obs[0].data[i];
 	}
-	for (i=0;i<rtksvr.obs[1][0].n&&n<MAXOBS*2;i++) {
-        if (!(satsyst(rtksvr.obs[1][0].data[i].sat,rtksvr.obs[1][0].data[i].time,NULL)&sys)) continue;
-		obs[n++]=rtksvr.obs[1][0].data[i];
+	for (i=0;i<rtksvr.obs[1].n&&n<MAXOBS*2;i++) {
+        if (!(satsyst(rtksvr.obs[1].data[i].sat,rtksvr.obs[1].data[i].time,NULL)&sys)) continue;
+		obs[n++]=rtksvr.obs[1].data[i];
 	}
 	rtksvrunlock(&rtksvr);
 	
@@ -1896,7 +1908,9 @@ void __fastcall TMonitorDialog::ShowRtcm(void)
 
 	rtksvrlock(&rtksvr);
 	format=rtksvr.format[Str1];
+	rtksvrlockin(&rtksvr,Str1);
 	*rtcm=rtksvr.rtcm[Str1];
+	rtksvrunlockin(&rtksvr,Str1);
 	rtksvrunlock(&rtksvr);
 	
 	if (rtcm->time.time) time2str(rtcm->time,tstr,3);
@@ -2049,6 +2063,7 @@ void __fastcall TMonitorDialog::ShowRtcmSsr(void)
 	char tstr[40],id[8],buff[256]="",*p;
 
 	rtksvrlock(&rtksvr);
+	rtksvrlockin(&rtksvr,Str1);
 	time=rtksvr.rtk.sol.time;
 	for (i=n=0;i<MAXSAT;i++) {
 		if (!(satsyst(i+1,time,NULL)&sys)) continue;
@@ -2057,6 +2072,7 @@ void __fastcall TMonitorDialog::ShowRtcmSsr(void)
 		if (SelSat->ItemIndex == 1 && !valid) continue;
 		sat[n++]=i+1;
 	}
+	rtksvrunlockin(&rtksvr,Str1);
 	rtksvrunlock(&rtksvr);
 
 	Label->Caption="";
@@ -2125,6 +2141,7 @@ void __fastcall TMonitorDialog::ShowRefSta(void)
 	
 	rtksvrlock(&rtksvr);
 	format=rtksvr.format[Str1];
+	rtksvrlockin(&rtksvr,Str1);
 	if (format==STRFMT_RTCM2||format==STRFMT_RTCM3) {
 		time=rtksvr.rtcm[Str1].time;
 		sta=rtksvr.rtcm[Str1].sta;
@@ -2133,6 +2150,7 @@ void __fastcall TMonitorDialog::ShowRefSta(void)
 		time=rtksvr.raw[Str1].time;
 		sta=rtksvr.raw[Str1].sta;
 	}
+	rtksvrunlockin(&rtksvr,Str1);
 	rtksvrunlock(&rtksvr);
 	
 	Label->Caption="";
@@ -1109,7 +1109,7 @@ static void write_header(FILE **ofp, int idx, const rnxopt_t *opt,
 }
 /* open output files ---------------------------------------------------------*/
 static int openfile(FILE **ofp, char *files[], const char *file,
-                    const rnxopt_t *opt, const nav_t *nav)
+                    const rnxopt_t *opt, const nav_t *nav, crxenc_t *crx)
 {
     char path[1024];
     int i;
@@ -1130,18 +1130,48 @@ static int openfile(FILE **ofp, char *files[], const char *file,
         
         if (!(ofp[i]=fopen(path,"w"))) {
             showmsg("file open error: %s",path);
-            for (i--;i>=0;i--) if (ofp[i]) fclose(ofp[i]);
+            for (i--;i>=0;i--) {
+                if (!ofp[i]) continue;
+                if (i==0&&crx->tmp) {
+                    fclose(crx->fp);
+                    free_crxenc(crx);
+                }
+                else fclose(ofp[i]);
+            }
             return 0;
         }
+        /* RINEX OBS text encoded to compact RINEX */
+        if (i==0&&opt->crx) {
+            if (!init_crxenc(crx,ofp[0],opt->rnxver)) {
+                showmsg("compact rinex not supported: ver=%.2f",opt->rnxver/100.0);
+                fclose(ofp[0]);
+                free_crxenc(crx);
+                return 0;
+            }
+            ofp[0]=crx->tmp;
+        }
         /* write RINEX header */
         write_header(ofp,i,opt,nav);
+        if (i==0&&crx->tmp&&!outcrxh(crx)) {
+            showmsg("compact rinex output error");
+            for (;i>=0;i--) {
+                if (!ofp[i]) continue;
+                if (i==0) {
+                    fclose(crx->fp);
+                    free_crxenc(crx);
+                }
+                else fclose(ofp[i]);
+            }
+            return 0;
+        }
     }
     return 1;
 }
 /* close output files --------------------------------------------------------*/
-static void closefile(FILE **ofp, const rnxopt_t *opt, nav_t *nav)
+static int closefile(FILE **ofp, const rnxopt_t *opt, nav_t *nav,
+                      crxenc_t *crx)
 {
-    int i;
+    int i,stat=1;
     
     trace(3,"closefile:\n");
     
@@ -1153,8 +1183,19 @@ static void closefile(FILE **ofp, const rnxopt_t *opt, nav_t *nav)
         rewind(ofp[i]);
         write_header(ofp,i,opt,nav);
         
+        if (i==0&&crx->tmp) {
+            rewind(crx->fp);
+            if (!outcrxh(crx)) {
+                showmsg("compact rinex output error");
+                stat=0;
+            }
+            fclose(crx->fp);
+            free_crxenc(crx); /* closes ofp[0] */
+            continue;
+        }
         fclose(ofp[i]);
     }
+    return stat;
 }
 /* output RINEX event --------------------------------------------------------*/
 static void outrnxevent(FILE *fp, const rnxopt_t *opt, gtime_t time, int event,
@@ -1271,17 +1312,17 @@ static int cmpobs(const void *p1, const void *p2)
     return obs1->sat - obs2->sat;
 }
 /* convert observation data --------------------------------------------------*/
-static void convobs(FILE **ofp, rnxopt_t *opt, strfile_t *str, int *n,
-                    gtime_t *tend, int *staid)
+static int convobs(FILE **ofp, rnxopt_t *opt, strfile_t *str, int *n,
+                   gtime_t *tend, int *staid, crxenc_t *crx)
 {
     trace(3,"convobs :\n");
     
-    if (!ofp[0]||str->obs->n<=0) return;
+    if (!ofp[0]||str->obs->n<=0) return 1;
     
     gtime_t time = str->obs->data[0].time;
     
     /* Avoid duplicated data by multiple files handover */
-    if (tend->time&&timediff(time,*tend)<-opt->ttol) return;
+    if (tend->time&&timediff(time,*tend)<-opt->ttol) return 1;
     *tend=time;
 
     if (opt->ltspan) {
@@ -1307,7 +1348,7 @@ static void convobs(FILE **ofp, rnxopt_t *opt, strfile_t *str, int *n,
         *staid=str->staid;
       }
       str->obs->flag = 0;
-      return;
+      return 1;
     }
     
     if (str->staid!=*staid) { /* Station ID changed */
@@ -1337,6 +1378,10 @@ static void convobs(FILE **ofp, rnxopt_t *opt, strfile_t *str, int *n,
     }
     /* output RINEX observation data */
     outrnxobsb(ofp[0],opt,str->obs->data,str->obs->n,str->obs->flag);
+    if (crx->tmp&&!outcrxb(crx)) {
+        showmsg("compact rinex output error");
+        return 0;
+    }
     /* n[NOUTFILE+1] - count of events converted to rinex */
     if (str->obs->flag == 5)
        n[NOUTFILE+1]++;
@@ -1347,6 +1392,7 @@ static void convobs(FILE **ofp, rnxopt_t *opt, strfile_t *str, int *n,
     opt->tend=time;
     
     n[0]++;
+    return 1;
 }
 /* convert navigation data --------------------------------------------------*/
 static void convnav(FILE **ofp, rnxopt_t *opt, strfile_t *str, int *n)
@@ -1541,9 +1587,10 @@ static int convrnx_s(int sess, int format, rnxopt_t *opt, const char *file,
                      char **ofile)
 {
     FILE *ofp[NOUTFILE]={NULL};
+    crxenc_t crx={0};
     strfile_t *str;
     gtime_t tend[3]={{0}};
-    int j,nf,type,n[NOUTFILE+2]={0},mask[MAXEXFILE]={0},staid=-1,abort=0;
+    int j,nf,type,n[NOUTFILE+2]={0},mask[MAXEXFILE]={0},staid=-1,abort=0,stat=1;
     char path[1024],*paths[NOUTFILE],s[NOUTFILE][1024];
     char *epath[MAXEXFILE]={0},*staname=*opt->staid?opt->staid:"0000";
     
@@ -1602,7 +1649,7 @@ static int convrnx_s(int sess, int format, rnxopt_t *opt, const char *file,
         }
     }
     /* open output files */
-    if (!openfile(ofp,paths,path,opt,str->nav)) {
+    if (!openfile(ofp,paths,path,opt,str->nav,&crx)) {
         for (int i=0;i<MAXEXFILE;i++) free(epath[i]);
         free_strfile(str);
         return 0;
@@ -1650,21 +1697,21 @@ static int convrnx_s(int sess, int format, rnxopt_t *opt, const char *file,
        }
     }
 
-    for (int i=0;i<nf&&!abort;i++) {
+    for (int i=0;i<nf&&!abort&&stat;i++) {
         if (!mask[i]) continue;
         
         /* open stream file */
         if (!open_strfile(str,epath[i])) continue;
 
         /* input message */
-        for (j=0;(type=input_strfile(str))>=-1;j++) {
+        for (j=0;stat&&(type=input_strfile(str))>=-1;j++) {
             
             if (!(j%11)&&(abort=showstat(sess,str->time,str->time,n))) break;
             if (opt->te.time&&timediff(str->time,opt->te)>-opt->ttol) break;
             
             /* convert message */
             switch (type) {
-                case  1: convobs(ofp,opt,str,n,tend,&staid); break;
+                case  1: stat=convobs(ofp,opt,str,n,tend,&staid,&crx); break;
                 case  2: convnav(ofp,opt,str,n); break;
                 case  3: convsbs(ofp,opt,str,n,tend+1); break;
                 case -1: n[NOUTFILE]++; break; /* error */
@@ -1678,12 +1725,20 @@ static int convrnx_s(int sess, int format, rnxopt_t *opt, const char *file,
         close_strfile(str);
     }
     /* close output files */
-    closefile(ofp,opt,str->nav);
+    if (!closefile(ofp,opt,str->nav,&crx)) stat=0;
     
     /* remove empty output files */
     for (int i=0;i<NOUTFILE;i++) {
         if (ofp[i]&&n[i]<=0) remove(ofile[i]);
     }
+    /* gzip compress output files */
+    for (int i=0;i<NOUTFILE&&opt->gzip;i++) {
+        char gzpath[1040];
+        if (!ofp[i]||n[i]<=0) continue;
+        sprintf(gzpath,"%s.gz",paths[i]);
+        if (rtk_gzip(paths[i],gzpath)) remove(paths[i]);
+        else showmsg("gzip compress error: %s",paths[i]);
+    }
     showstat(sess,opt->tstart,opt->tend,n);
     
     /* unset RINEX options comments */
@@ -1692,7 +1747,7 @@ static int convrnx_s(int sess, int format, rnxopt_t *opt, const char *file,
     free_strfile(str);
     for (int i=0;i<MAXEXFILE;i++) free(epath[i]);
     
-    return abort?-1:1;
+    return abort?-1:stat;
 }
 /* RINEX converter -------------------------------------------------------------
 * convert receiver log file to RINEX obs/nav, SBAS log files
@@ -1716,6 +1771,8 @@ static int convrnx_s(int sess, int format, rnxopt_t *opt, const char *file,
 *          keywords in ofile[] are replaced by first observation date/time and
 *          station ID (%r)
 *          the order of wild-card expanded files must be in-order by time
+*          if opt->crx is set, RINEX OBS is output as compact RINEX. if
+*          opt->gzip is set, the output files are gzip-compressed to <ofile>.gz
 *-----------------------------------------------------------------------------*/
 int convrnx(int format, rnxopt_t *opt, const char *file, char **ofile)
 {
@@ -205,6 +205,146 @@ double eph2clk(gtime_t time, const eph_t *eph)
 
     return eph->f0+eph->f1*t+eph->f2*t*t;
 }
+/* broadcast ephemeris to evaluated ephemeris ---------------------------------
+* precompute the constants of broadcast ephemeris used by ephc2pos()
+* args   : eph_t  *eph      I   broadcast ephemeris
+*          ephc_t *ephc     O   evaluated broadcast ephemeris
+* return : none
+*-----------------------------------------------------------------------------*/
+void eph2ephc(const eph_t *eph, ephc_t *ephc)
+{
+    double mu,omge;
+    int prn,sys=satsyst(eph->sat,eph->toe,&prn);
+
+    switch (sys) {
+        case SYS_GAL: mu=MU_GAL; omge=OMGE_GAL; break;
+        case SYS_BDS2:
+        case SYS_BDS3: mu=MU_CMP; omge=OMGE_CMP; break;
+        default:      mu=MU_GPS; omge=OMGE;     break;
+    }
+    ephc->sat=eph->sat;
+    ephc->geo=(sys&SYS_BDS)&&(prn<=5||prn>=59); /* ref [9] table 4-1 */
+    ephc->toe=eph->toe; ephc->toc=eph->toc;
+    ephc->A=eph->A; ephc->e=eph->e; ephc->i0=eph->i0; ephc->M0=eph->M0;
+    ephc->omg=eph->omg; ephc->idot=eph->idot;
+    ephc->crc=eph->crc; ephc->crs=eph->crs; ephc->cuc=eph->cuc;
+    ephc->cus=eph->cus; ephc->cic=eph->cic; ephc->cis=eph->cis;
+    ephc->f0=eph->f0; ephc->f1=eph->f1; ephc->f2=eph->f2;
+    ephc->n=eph->A>0.0?sqrt(mu/(eph->A*eph->A*eph->A))+eph->deln:0.0;
+    ephc->sqe=sqrt(1.0-eph->e*eph->e);
+    ephc->OMG0=eph->OMG0;
+    ephc->OMGd=ephc->geo?eph->OMGd:eph->OMGd-omge;
+    ephc->OMGt=omge*eph->toes;
+    ephc->omge=omge;
+    ephc->rel=eph->A>0.0?2.0*sqrt(mu*eph->A)*eph->e:0.0;
+    ephc->var=var_uraeph(sys,eph->sva);
+}
+/* evaluated ephemerides to satellite positions and clock biases ---------------
+* compute satellite positions and clock biases with evaluated broadcast
+* ephemerides in a batch
+* args   : gtime_t *time    I   times (gpst) {t1,t2,...}
+*          ephc_t **ephc    I   evaluated broadcast ephemerides {eph1,eph2,...}
+*          int    n         I   number of times and ephemerides
+*          double *rs       O   satellite positions (ecef) {x1,y1,z1,x2,...} (m)
+*          double *dts      O   satellite clock biases {dts1,dts2,...} (s)
+*          double *var      O   satellite position and clock variances (m^2)
+* return : none
+* notes  : same results as eph2pos(). the satellites are processed in blocks
+*          with the intermediate values in arrays (structure of arrays) and the
+*          Kepler equations of a block solved in lockstep.
+*-----------------------------------------------------------------------------*/
+#define NEPHB       32              /* block size of batch evaluation */
+
+void ephc2poss(const gtime_t *time, const ephc_t **ephc, int n, double *rs,
+               double *dts, double *var)
+{
+    double tk[NEPHB],M[NEPHB],E[NEPHB],Ek[NEPHB],e[NEPHB],En;
+    double sinE,cosE,u,r,i,O,sin2u,cos2u,x,y,sinO,cosO,cosi,xg,yg,zg,sino,coso;
+    int act[NEPHB],k,m,it,nact;
+
+    for (;n>0;time+=m,ephc+=m,rs+=3*m,dts+=m,var+=m,n-=m) {
+        m=n<NEPHB?n:NEPHB;
+
+        for (k=0;k<m;k++) {
+            tk[k]=timediff(time[k],ephc[k]->toe);
+            e [k]=ephc[k]->e;
+            M [k]=ephc[k]->M0+ephc[k]->n*tk[k];
+            E [k]=M[k]; Ek[k]=0.0;
+            act[k]=fabs(E[k]-Ek[k])>RTOL_KEPLER;
+        }
+        /* solve Kepler equations in lockstep */
+        for (it=0,nact=1;nact&&it<MAX_ITER_KEPLER;it++) {
+            for (k=nact=0;k<m;k++) {
+                En=E[k]-(E[k]-e[k]*sin(E[k])-M[k])/(1.0-e[k]*cos(E[k]));
+                Ek[k]=act[k]?E[k]:Ek[k];
+                E [k]=act[k]?En  :E [k];
+                act[k]=act[k]&&fabs(E[k]-Ek[k])>RTOL_KEPLER;
+                nact+=act[k];
+            }
+        }
+        for (k=0;k<m;k++) {
+            const ephc_t *c=ephc[k];
+
+            if (c->A<=0.0) {
+                rs[k*3]=rs[1+k*3]=rs[2+k*3]=dts[k]=var[k]=0.0;
+                continue;
+            }
+            if (act[k]) {
+                trace(2,"eph2pos: kepler iteration overflow sat=%2d\n",c->sat);
+            }
+            sinE=sin(E[k]); cosE=cos(E[k]);
+
+            u=atan2(c->sqe*sinE,cosE-c->e)+c->omg;
+            r=c->A*(1.0-c->e*cosE);
+            i=c->i0+c->idot*tk[k];
+            sin2u=sin(2.0*u); cos2u=cos(2.0*u);
+            u+=c->cus*sin2u+c->cuc*cos2u;
+            r+=c->crs*sin2u+c->crc*cos2u;
+            i+=c->cis*sin2u+c->cic*cos2u;
+            x=r*cos(u); y=r*sin(u); cosi=cos(i);
+            O=c->OMG0+c->OMGd*tk[k]-c->OMGt;
+            sinO=sin(O); cosO=cos(O);
+
+            /* beidou geo satellite */
+            if (c->geo) {
+                xg=x*cosO-y*cosi*sinO;
+                yg=x*sinO+y*cosi*cosO;
+                zg=y*sin(i);
+                sino=sin(c->omge*tk[k]); coso=cos(c->omge*tk[k]);
+                rs[  k*3]= xg*coso+yg*sino*COS_5+zg*sino*SIN_5;
+                rs[1+k*3]=-xg*sino+yg*coso*COS_5+zg*coso*SIN_5;
+                rs[2+k*3]=-yg*SIN_5+zg*COS_5;
+            }
+            else {
+                rs[  k*3]=x*cosO-y*cosi*sinO;
+                rs[1+k*3]=x*sinO+y*cosi*cosO;
+                rs[2+k*3]=y*sin(i);
+            }
+            tk[k]=timediff(time[k],c->toc);
+            dts[k]=c->f0+c->f1*tk[k]+c->f2*tk[k]*tk[k];
+
+            /* relativity correction */
+            dts[k]-=c->rel*sinE/SQR(CLIGHT);
+
+            /* position and clock error variance */
+            var[k]=c->var;
+        }
+    }
+}
+/* evaluated ephemeris to satellite position and clock bias --------------------
+* compute satellite position and clock bias with evaluated broadcast ephemeris
+* args   : gtime_t time     I   time (gpst)
+*          ephc_t *ephc     I   evaluated broadcast ephemeris
+*          double *rs       O   satellite position (ecef) {x,y,z} (m)
+*          double *dts      O   satellite clock bias (s)
+*          double *var      O   satellite position and clock variance (m^2)
+* return : none
+*-----------------------------------------------------------------------------*/
+void ephc2pos(gtime_t time, const ephc_t *ephc, double *rs, double *dts,
+              double *var)
+{
+    ephc2poss(&time,&ephc,1,rs,dts,var);
+}
 /* broadcast ephemeris to satellite position and clock bias --------------------
 * compute satellite position and clock bias with broadcast ephemeris (gps,
 * galileo, qzss)
@@ -221,76 +361,72 @@ double eph2clk(gtime_t time, const eph_t *eph)
 void eph2pos(gtime_t time, const eph_t *eph, double *rs, double *dts,
                     double *var)
 {
-    double tk,M,E,Ek,sinE,cosE,u,r,i,O,sin2u,cos2u,x,y,sinO,cosO,cosi,mu,omge;
-    double xg,yg,zg,sino,coso;
-    int n;
+    ephc_t ephc;
 
     char tstr[40];
     trace(4,"eph2pos : time=%s sat=%2d\n",time2str(time,tstr,3),eph->sat);
 
-    if (eph->A<=0.0) {
-        rs[0]=rs[1]=rs[2]=*dts=*var=0.0;
-        return;
-    }
-    tk=timediff(time,eph->toe);
+    eph2ephc(eph,&ephc);
+    ephc2pos(time,&ephc,rs,dts,var);
 
-    int prn, sys = satsyst(eph->sat, time, &prn);
-    switch (sys) {
-        case SYS_GAL: mu=MU_GAL; omge=OMGE_GAL; break;
-        case SYS_BDS2:
-        case SYS_BDS3: mu=MU_CMP; omge=OMGE_CMP; break;
-        default:      mu=MU_GPS; omge=OMGE;     break;
-    }
-    M=eph->M0+(sqrt(mu/(eph->A*eph->A*eph->A))+eph->deln)*tk;
+    trace(4,"eph2pos: sat=%d, dts=%.10f rs=%.4f %.4f %.4f var=%.3f\n",eph->sat,
+        *dts,rs[0],rs[1],rs[2],*var);
+}
+/* evaluate ephemerides --------------------------------------------------------
+* precompute the evaluated ephemerides of all broadcast ephemerides and
+* glonass ephemerides in the navigation data, used by satposs() and satpos()
+* while the ephemeris indices built by indexnav() are unchanged
+* args   : nav_t  *nav      IO  navigation data
+*          int    gloorb    I   glonass orbit (0:RK4 integration,
+*                               1:Hermite interpolation) (prcopt_t.gloorb)
+* return : none
+* notes  : call it after indexnav() or uniqnav()
+*-----------------------------------------------------------------------------*/
+void evalnav(nav_t *nav, int gloorb)
+{
+    ephc_t *nav_ephc;
+    gephc_t *nav_gephc;
+    int i;
 
-    for (n=0,E=M,Ek=0.0;fabs(E-Ek)>RTOL_KEPLER&&n<MAX_ITER_KEPLER;n++) {
-        Ek=E; E-=(E-eph->e*sin(E)-M)/(1.0-eph->e*cos(E));
+    trace(3,"evalnav: n=%d ng=%d gloorb=%d\n",nav->n,nav->ng,gloorb);
+
+    if (nav->ieph.idx&&nav->ieph.n==nav->n&&
+        (!nav->ephc||nav->ephcgen!=nav->ieph.gen)) {
+        if (!(nav_ephc=(ephc_t *)realloc(nav->ephc,sizeof(ephc_t)*(nav->n>0?nav->n:1)))) {
+            free(nav->ephc); nav->ephc=NULL;
+        }
+        else {
+            nav->ephc=nav_ephc;
+            for (i=0;i<nav->n;i++) eph2ephc(nav->eph+i,nav->ephc+i);
+            nav->ephcgen=nav->ieph.gen;
+        }
     }
-    if (n>=MAX_ITER_KEPLER) {
-        trace(2,"eph2pos: kepler iteration overflow sat=%2d\n",eph->sat);
+    if (nav->igeph.idx&&nav->igeph.n==nav->ng&&
+        (!nav->gephc||nav->gephcgen!=nav->igeph.gen||
+         (nav->ng>0&&nav->gephc[0].herm!=gloorb))) {
+        if (!(nav_gephc=(gephc_t *)realloc(nav->gephc,sizeof(gephc_t)*(nav->ng>0?nav->ng:1)))) {
+            free(nav->gephc); nav->gephc=NULL;
+        }
+        else {
+            nav->gephc=nav_gephc;
+            for (i=0;i<nav->ng;i++) geph2gephc(nav->geph+i,gloorb,nav->gephc+i);
+            nav->gephcgen=nav->igeph.gen;
+        }
     }
-    sinE=sin(E); cosE=cos(E);
-
-    trace(4,"kepler: sat=%2d e=%8.5f n=%2d del=%10.3e\n",eph->sat,eph->e,n,E-Ek);
-
-    u=atan2(sqrt(1.0-eph->e*eph->e)*sinE,cosE-eph->e)+eph->omg;
-    r=eph->A*(1.0-eph->e*cosE);
-    i=eph->i0+eph->idot*tk;
-    sin2u=sin(2.0*u); cos2u=cos(2.0*u);
-    u+=eph->cus*sin2u+eph->cuc*cos2u;
-    r+=eph->crs*sin2u+eph->crc*cos2u;
-    i+=eph->cis*sin2u+eph->cic*cos2u;
-    x=r*cos(u); y=r*sin(u); cosi=cos(i);
-
-    /* beidou geo satellite */
-    if ((sys&SYS_BDS)&&(prn<=5||prn>=59)) { /* ref [9] table 4-1 */
-        O=eph->OMG0+eph->OMGd*tk-omge*eph->toes;
-        sinO=sin(O); cosO=cos(O);
-        xg=x*cosO-y*cosi*sinO;
-        yg=x*sinO+y*cosi*cosO;
-        zg=y*sin(i);
-        sino=sin(omge*tk); coso=cos(omge*tk);
-        rs[0]= xg*coso+yg*sino*COS_5+zg*sino*SIN_5;
-        rs[1]=-xg*sino+yg*coso*COS_5+zg*coso*SIN_5;
-        rs[2]=-yg*SIN_5+zg*COS_5;
-    }
-    else {
-        O=eph->OMG0+(eph->OMGd-omge)*tk-omge*eph->toes;
-        sinO=sin(O); cosO=cos(O);
-        rs[0]=x*cosO-y*cosi*sinO;
-        rs[1]=x*sinO+y*cosi*cosO;
-        rs[2]=y*sin(i);
-    }
-    tk=timediff(time,eph->toc);
-    *dts=eph->f0+eph->f1*tk+eph->f2*tk*tk;
-
-    /* relativity correction */
-    *dts-=2.0*sqrt(mu*eph->A)*eph->e*sinE/SQR(CLIGHT);
-
-    /* position and clock error variance */
-    *var=var_uraeph(sys,eph->sva);
-    trace(4,"eph2pos: sat=%d, dts=%.10f rs=%.4f %.4f %.4f var=%.3f\n",eph->sat,
-        *dts,rs[0],rs[1],rs[2],*var);
+}
+/* get evaluated ephemeris of selected ephemeris -----------------------------*/
+static const ephc_t *selephc(const eph_t *eph, const nav_t *nav)
+{
+    if (!nav->ephc||!nav->ieph.idx||nav->ieph.n!=nav->n||
+        nav->ephcgen!=nav->ieph.gen) return NULL;
+    return nav->ephc+(eph-nav->eph);
+}
+/* get evaluated glonass ephemeris of selected ephemeris ---------------------*/
+static const gephc_t *selgephc(const geph_t *geph, const nav_t *nav)
+{
+    if (!nav->gephc||!nav->igeph.idx||nav->igeph.n!=nav->ng||
+        nav->gephcgen!=nav->igeph.gen) return NULL;
+    return nav->gephc+(geph-nav->geph);
 }
 /* glonass orbit differential equations --------------------------------------*/
 static void deq(const double *x, double *xdot, const double *acc)
@@ -382,6 +518,89 @@ void geph2pos(gtime_t time, const geph_t *geph, double *rs, double *dts,
 
     *var=SQR(ERREPH_GLO);
 }
+/* glonass ephemeris to evaluated ephemeris -----------------------------------
+* integrate the orbit of glonass ephemeris to the nodes Toe+k*TSTEP
+* (k=-NGLONODE..NGLONODE) used by gephc2pos()
+* args   : geph_t  *geph    I   glonass ephemeris
+*          int     herm     I   orbit between nodes (0:RK4 integration,
+*                               1:Hermite interpolation)
+*          gephc_t *gephc   O   evaluated glonass ephemeris
+* return : none
+*-----------------------------------------------------------------------------*/
+void geph2gephc(const geph_t *geph, int herm, gephc_t *gephc)
+{
+    double *x0=gephc->x+NGLONODE*6;
+    int i,j;
+
+    gephc->sat=geph->sat;
+    gephc->herm=herm;
+    gephc->toe=geph->toe;
+    gephc->taun=geph->taun;
+    gephc->gamn=geph->gamn;
+    for (i=0;i<3;i++) {
+        gephc->acc[i]=geph->acc[i];
+        x0[i  ]=geph->pos[i];
+        x0[i+3]=geph->vel[i];
+    }
+    /* same full steps as geph2pos() forward and backward */
+    for (j=1;j<=NGLONODE;j++) {
+        matcpy(x0+j*6,x0+(j-1)*6,6,1);
+        glorbit(TSTEP,x0+j*6,geph->acc);
+        matcpy(x0-j*6,x0-(j-1)*6,6,1);
+        glorbit(-TSTEP,x0-j*6,geph->acc);
+    }
+}
+/* evaluated glonass ephemeris to satellite position and clock bias ------------
+* compute satellite position and clock bias with evaluated glonass ephemeris
+* args   : gtime_t time     I   time (gpst)
+*          gephc_t *gephc   I   evaluated glonass ephemeris
+*          double *rs       O   satellite position {x,y,z} (ecef) (m)
+*          double *dts      O   satellite clock bias (s)
+*          double *var      O   satellite position and clock variance (m^2)
+* return : none
+* notes  : with RK4 integration, same results as geph2pos() by starting from
+*          the last node geph2pos() steps over. with Hermite interpolation, the
+*          cubic Hermite polynomial of the positions and velocities of the
+*          adjacent nodes (error < 1 mm).
+*-----------------------------------------------------------------------------*/
+void gephc2pos(gtime_t time, const gephc_t *gephc, double *rs, double *dts,
+               double *var)
+{
+    const double *x0=gephc->x+NGLONODE*6,*p0,*p1;
+    double t,tt,x[6],s,h00,h10,h01,h11;
+    int i,j=0,k;
+
+    t=timediff(time,gephc->toe);
+
+    *dts=-gephc->taun+gephc->gamn*t;
+    *var=SQR(ERREPH_GLO);
+
+    if (gephc->herm&&fabs(t)<NGLONODE*TSTEP) {
+        k=(int)floor(t/TSTEP);
+        p0=x0+k*6; p1=p0+6;
+        s=t/TSTEP-k;
+        h00=(1.0+2.0*s)*(1.0-s)*(1.0-s); h10=s*(1.0-s)*(1.0-s);
+        h01=s*s*(3.0-2.0*s);             h11=s*s*(s-1.0);
+        for (i=0;i<3;i++) {
+            rs[i]=h00*p0[i]+h10*TSTEP*p0[i+3]+h01*p1[i]+h11*TSTEP*p1[i+3];
+        }
+        return;
+    }
+    for (tt=t<0.0?-TSTEP:TSTEP;fabs(t)>1E-9;t-=tt) {
+        if (fabs(t)<TSTEP) tt=t;
+        else if (j>-NGLONODE&&j<NGLONODE) { /* full step to node */
+            j+=tt<0.0?-1:1;
+            continue;
+        }
+        if (j!=NGLONODE+1) {
+            matcpy(x,x0+j*6,6,1);
+            j=NGLONODE+1; /* integrating from x */
+        }
+        glorbit(tt,x,gephc->acc);
+    }
+    if (j!=NGLONODE+1) matcpy(x,x0+j*6,6,1);
+    for (i=0;i<3;i++) rs[i]=x[i];
+}
 /* sbas ephemeris to satellite clock bias --------------------------------------
 * compute satellite clock bias with sbas ephemeris
 * args   : gtime_t time     I   time by satellite clock (gpst)
@@ -429,11 +648,48 @@ void seph2pos(gtime_t time, const seph_t *seph, double *rs, double *dts,
 
     *var=var_uraeph(SYS_SBS,seph->sva);
 }
-/* select ephemeris --------------------------------------------------------*/
+/* search ephemeris index ----------------------------------------------------
+* get the range of sorted entries of a satellite with toe>=time-tmax. return
+* NULL if the index is not valid for the n ephemerides, then the caller scans
+* all entries 0..n-1 in array order. hit is the last searched entry of each
+* satellite, only a hint checked before use. the hints are kept per thread as
+* the nav data are shared by threads.
+*-----------------------------------------------------------------------------*/
+static const int *srchidx(const ephidx_t *x, int *hit, int n, int sat,
+                          gtime_t time, double tmax, int *k0, int *k1)
+{
+    int lo,hi,k;
+
+    if (!x->idx||x->n!=n||sat<=0||sat>MAXSAT) {
+        *k0=0; *k1=n;
+        return NULL;
+    }
+    lo=x->off[sat-1]; hi=*k1=x->off[sat];
+
+    /* last hit still at the lower bound */
+    k=hit[sat-1];
+    if (k>=lo&&k<=hi&&(k==hi||timediff(x->toe[k],time)>=-tmax)&&
+        (k==lo||timediff(x->toe[k-1],time)<-tmax)) {
+        *k0=k;
+        return x->idx;
+    }
+    while (lo<hi) {
+        k=(lo+hi)/2;
+        if (timediff(x->toe[k],time)<-tmax) lo=k+1; else hi=k;
+    }
+    hit[sat-1]=*k0=lo;
+    return x->idx;
+}
+/* select ephemeris ------------------------------------------------------------
+* select the ephemeris with toe closest to time (the last one in array order
+* for ties) or the first one in array order with matching iode
+*-----------------------------------------------------------------------------*/
 static eph_t *seleph(gtime_t time, int sat, int iode, const nav_t *nav)
 {
+    static THREADLOCAL int hit[MAXSAT];
+    const int *idx;
     double t,tmax,tmin;
-    int i,j=-1,sel=0;
+    int i,j=-1,k,k0,k1,sel=0;
 
     char tstr[40];
     trace(4,"seleph  : time=%s sat=%2d iode=%d\n",time2str(time,tstr,3),sat,iode);
@@ -449,65 +705,91 @@ static eph_t *seleph(gtime_t time, int sat, int iode, const nav_t *nav)
         default: tmax=MAXDTOE+1.0; break;
     }
     tmin=tmax+1.0;
+    if (sys==SYS_GAL) sel=getseleph(SYS_GAL);
 
-    for (i=0;i<nav->n;i++) {
+    idx=srchidx(&nav->ieph,hit,nav->n,sat,time,tmax,&k0,&k1);
+
+    for (k=k0;k<k1;k++) {
+        i=idx?idx[k]:k;
+        if (idx&&timediff(nav->ieph.toe[k],time)>tmax) break;
         if (nav->eph[i].sat!=sat) continue;
         if (iode>=0&&nav->eph[i].iode!=iode) continue;
         if (sys==SYS_GAL) {
-            sel=getseleph(SYS_GAL);
             if (sel==1&&!(nav->eph[i].code&(1<<9))) continue; /* I/NAV */
             if (sel==2&&!(nav->eph[i].code&(1<<8))) continue; /* F/NAV */
             if (timediff(nav->eph[i].toe,time)>=0.0) continue; /* AOD<=0 */
         }
         if ((t=fabs(timediff(nav->eph[i].toe,time)))>tmax) continue;
-        if (iode>=0) return nav->eph+i;
-        if (t<=tmin) {j=i; tmin=t;} /* toe closest to time */
+        if (iode>=0) {
+            if (!idx) return nav->eph+i;
+            if (j<0||i<j) j=i; /* first in array order */
+            continue;
+        }
+        if (t<tmin||(t==tmin&&i>j)) {j=i; tmin=t;} /* toe closest to time */
     }
-    if (iode>=0||j<0) {
+    if (j<0) {
         trace(2,"no broadcast ephemeris: %s sat=%2d iode=%3d\n",time2str(time,tstr,0),
               sat,iode);
         return NULL;
     }
+    if (iode>=0) return nav->eph+j;
     trace(4,"seleph: sat=%d dt=%.0f j=%d iode=%d, sel=%d\n",sat,tmin,j,nav->eph[j].iode, sel);
     return nav->eph+j;
 }
 /* select glonass ephemeris --------------------------------------------------*/
 static geph_t *selgeph(gtime_t time, int sat, int iode, const nav_t *nav)
 {
+    static THREADLOCAL int hit[MAXSAT];
+    const int *idx;
     double t,tmax=MAXDTOE_GLO,tmin=tmax+1.0;
-    int i,j=-1;
+    int i,j=-1,k,k0,k1;
 
     char tstr[40];
     trace(4,"selgeph : time=%s sat=%2d iode=%2d\n",time2str(time,tstr,3),sat,iode);
 
-    for (i=0;i<nav->ng;i++) {
+    idx=srchidx(&nav->igeph,hit,nav->ng,sat,time,tmax,&k0,&k1);
+
+    for (k=k0;k<k1;k++) {
+        i=idx?idx[k]:k;
+        if (idx&&timediff(nav->igeph.toe[k],time)>tmax) break;
         if (nav->geph[i].sat!=sat) continue;
         if (iode>=0&&nav->geph[i].iode!=iode) continue;
         if ((t=fabs(timediff(nav->geph[i].toe,time)))>tmax) continue;
-        if (iode>=0) return nav->geph+i;
-        if (t<=tmin) {j=i; tmin=t;} /* toe closest to time */
+        if (iode>=0) {
+            if (!idx) return nav->geph+i;
+            if (j<0||i<j) j=i; /* first in array order */
+            continue;
+        }
+        if (t<tmin||(t==tmin&&i>j)) {j=i; tmin=t;} /* toe closest to time */
     }
-    if (iode>=0||j<0) {
+    if (j<0) {
         trace(3,"no glonass ephemeris  : %s sat=%2d iode=%2d\n",time2str(time,tstr,0),
               sat,iode);
         return NULL;
     }
+    if (iode>=0) return nav->geph+j;
     trace(4,"selgeph: sat=%d dt=%.0f\n",sat,tmin);
     return nav->geph+j;
 }
 /* select sbas ephemeris -----------------------------------------------------*/
 static seph_t *selseph(gtime_t time, int sat, const nav_t *nav)
 {
+    static THREADLOCAL int hit[MAXSAT];
+    const int *idx;
     double t,tmax=MAXDTOE_SBS,tmin=tmax+1.0;
-    int i,j=-1;
+    int i,j=-1,k,k0,k1;
 
     char tstr[40];
     trace(4,"selseph : time=%s sat=%2d\n",time2str(time,tstr,3),sat);
 
-    for (i=0;i<nav->ns;i++) {
+    idx=srchidx(&nav->iseph,hit,nav->ns,sat,time,tmax,&k0,&k1);
+
+    for (k=k0;k<k1;k++) {
+        i=idx?idx[k]:k;
+        if (idx&&timediff(nav->iseph.toe[k],time)>tmax) break;
         if (nav->seph[i].sat!=sat) continue;
         if ((t=fabs(timediff(nav->seph[i].t0,time)))>tmax) continue;
-        if (t<=tmin) {j=i; tmin=t;} /* toe closest to time */
+        if (t<tmin||(t==tmin&&i>j)) {j=i; tmin=t;} /* toe closest to time */
     }
     if (j<0) {
         trace(3,"no sbas ephemeris     : %s sat=%2d\n",time2str(time,tstr,0),sat);
@@ -552,6 +834,8 @@ static int ephpos(gtime_t time, gtime_t teph, int sat, const nav_t *nav,
     eph_t  *eph;
     geph_t *geph;
     seph_t *seph;
+    const ephc_t *ephc;
+    const gephc_t *gephc;
     double rst[3],dtst[1],tt=1E-3;
     int i;
 
@@ -564,16 +848,30 @@ static int ephpos(gtime_t time, gtime_t teph, int sat, const nav_t *nav,
 
     if (sys==SYS_GPS||sys==SYS_GAL||sys==SYS_QZS||sys==SYS_BDS2||sys==SYS_BDS3||sys==SYS_IRN) {
         if (!(eph=seleph(teph,sat,iode,nav))) return 0;
-        eph2pos(time,eph,rs,dts,var);
-        time=timeadd(time,tt);
-        eph2pos(time,eph,rst,dtst,var);
+        if ((ephc=selephc(eph,nav))) {
+            ephc2pos(time,ephc,rs,dts,var);
+            time=timeadd(time,tt);
+            ephc2pos(time,ephc,rst,dtst,var);
+        }
+        else {
+            eph2pos(time,eph,rs,dts,var);
+            time=timeadd(time,tt);
+            eph2pos(time,eph,rst,dtst,var);
+        }
         *svh=eph->svh;
     }
     else if (sys==SYS_GLO) {
         if (!(geph=selgeph(teph,sat,iode,nav))) return 0;
-        geph2pos(time,geph,rs,dts,var);
-        time=timeadd(time,tt);
-        geph2pos(time,geph,rst,dtst,var);
+        if ((gephc=selgephc(geph,nav))) {
+            gephc2pos(time,gephc,rs,dts,var);
+            time=timeadd(time,tt);
+            gephc2pos(time,gephc,rst,dtst,var);
+        }
+        else {
+            geph2pos(time,geph,rs,dts,var);
+            time=timeadd(time,tt);
+            geph2pos(time,geph,rst,dtst,var);
+        }
         *svh=geph->svh;
     }
     else if (sys==SYS_SBS) {
@@ -807,9 +1105,12 @@ int satpos(gtime_t time, gtime_t teph, int sat, const prcopt_t *opt,
 void satposs(gtime_t teph, const obsd_t *obs, int n, const nav_t *nav,
                     const prcopt_t *opt, double *rs, double *dts, double *var, int *svh)
 {
-    gtime_t time[2*MAXOBS]={{0}};
-    double dt,pr;
-    int i,j;
+    gtime_t time[2*MAXOBS]={{0}},tb[4*MAXOBS];
+    const ephc_t *eb[4*MAXOBS];
+    const eph_t *eph;
+    double dt[2*MAXOBS],pr[2*MAXOBS],rb[12*MAXOBS],db[4*MAXOBS],vb[4*MAXOBS];
+    double tt=1E-3;
+    int i,j,k,nb=0,ib[2*MAXOBS],stat[2*MAXOBS]={0};
 
     int ephopt = opt->sateph;
     char tstr[40];
@@ -821,14 +1122,14 @@ void satposs(gtime_t teph, const obsd_t *obs, int n, const nav_t *nav,
         var[i]=0.0; svh[i]=0;
 
         /* search any pseudorange */
-        for (j=0,pr=0.0;j<NFREQ;j++) if ((pr=obs[i].P[j])!=0.0) break;
+        for (j=0,pr[i]=0.0;j<NFREQ;j++) if ((pr[i]=obs[i].P[j])!=0.0) break;
 
         if (j>=NFREQ) {
             trace(2,"no pseudorange %s sat=%2d\n",time2str(obs[i].time,tstr,3),obs[i].sat);
             continue;
         }
         /* transmission time by satellite clock */
-        time[i]=timeadd(obs[i].time,-pr/CLIGHT);
+        time[i]=timeadd(obs[i].time,-pr[i]/CLIGHT);
 
         /* satellite clock offset from precise products or broadcast ephemeris */
 
@@ -837,23 +1138,54 @@ void satposs(gtime_t teph, const obsd_t *obs, int n, const nav_t *nav,
         // satellite clock drift over this small period is considered
         // negligible to the clock offset lookup here.
         if (ephopt == EPHOPT_PREC) {
-          if (!pephclk(time[i], obs[i].sat, nav, &dt, NULL)) {
+          if (!pephclk(time[i], obs[i].sat, nav, &dt[i], NULL)) {
             trace(3,"no precise clock %s sat=%2d\n",time2str(time[i],tstr,3),obs[i].sat);
             continue;
           }
         }
-        else if (!ephclk(time[i],teph,obs[i].sat,nav,&dt)) {
+        else if (!ephclk(time[i],teph,obs[i].sat,nav,&dt[i])) {
           trace(3,"no broadcast clock %s sat=%2d\n",time2str(time[i],tstr,3),obs[i].sat);
           continue;
         }
-        time[i]=timeadd(time[i],-dt);
-
+        time[i]=timeadd(time[i],-dt[i]);
+
+        /* broadcast ephemeris with evaluated ephemeris deferred to batch */
+        if (ephopt==EPHOPT_BRDC&&
+            (satsyst(obs[i].sat,time[i],NULL)&(SYS_GPS|SYS_GAL|SYS_QZS|SYS_BDS|SYS_IRN))&&
+            (eph=seleph(teph,obs[i].sat,-1,nav))&&(eb[nb]=selephc(eph,nav))) {
+            eb[nb+1]=eb[nb];
+            tb[nb]=time[i];
+            tb[nb+1]=timeadd(time[i],tt);
+            ib[nb/2]=i;
+            svh[i]=eph->svh;
+            stat[i]=1;
+            nb+=2;
+            continue;
+        }
         /* satellite position and clock at transmission time */
         if (!satpos(time[i],teph,obs[i].sat,opt,nav,rs+i*6,dts+i*2,var+i,
                     svh+i)) {
             trace(3,"no ephemeris %s sat=%2d\n",time2str(time[i],tstr,3),obs[i].sat);
             continue;
         }
+        stat[i]=1;
+    }
+    /* satellite positions and clocks by evaluated ephemerides */
+    if (nb>0) ephc2poss(tb,eb,nb,rb,db,vb);
+
+    for (k=0;k<nb/2;k++) {
+        i=ib[k];
+        for (j=0;j<3;j++) {
+            rs[j+i*6]=rb[j+k*6];
+            rs[j+3+i*6]=(rb[j+3+k*6]-rb[j+k*6])/tt;
+        }
+        dts[  i*2]=db[k*2];
+        dts[1+i*2]=(db[1+k*2]-db[k*2])/tt;
+        var[i]=vb[1+k*2];
+    }
+    for (i=0;i<n&&i<2*MAXOBS;i++) {
+        if (!stat[i]) continue;
+
         /* if no precise clock available, use broadcast clock instead */
         /* NOTE: broadcast clock from ephclk() does NOT include relativistic
          *       correction for GPS, GAL and BDS! */
@@ -864,9 +1196,8 @@ void satposs(gtime_t teph, const obsd_t *obs, int n, const nav_t *nav,
             trace(3,"no precise clock, use broadcast %s sat=%2d\n",time2str(time[i],tstr,3),obs[i].sat);
         }
         trace(4,"satposs: %d,time=%.9f dt=%.9f pr=%.3f rs=%13.3f %13.3f %13.3f dts=%12.3f var=%7.3f\n",
-            obs[i].sat,time[i].sec,dt,pr,rs[i*6],rs[1+i*6],rs[2+i*6],dts[i*2]*1E9,
+            obs[i].sat,time[i].sec,dt[i],pr[i],rs[i*6],rs[1+i*6],rs[2+i*6],dts[i*2]*1E9,
             var[i]);
-
     }
     for (i=0;i<n&&i<2*MAXOBS;i++) {
         trace(4,"%s sat=%2d rs=%13.3f %13.3f %13.3f dts=%12.3f var=%7.3f svh=%02X\n",
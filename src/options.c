@@ -48,6 +48,7 @@ static char snrmask_[MAXFREQ][1024];
 #define IONOPT  "0:off,1:brdc,2:sbas,3:dual-freq,4:est-stec,5:ionex-tec,6:qzs-brdc,7:ssr-vtec"
 #define TRPOPT  "0:off,1:saas,2:sbas,3:est-ztd,4:est-ztdgrad"
 #define EPHOPT  "0:brdc,1:precise,2:brdc+sbas,3:brdc+ssrapc,4:brdc+ssrcom"
+#define GORBOPT "0:integ,1:hermite"
 #define NAVOPT  "1:gps+2:sbas+4:glo+8:gal+16:qzs+32:bds2+64:bds3+128:irn"
 #define GAROPT  "0:off,1:on,2:autocal,3:fix-and-hold"
 #define WEIGHTOPT "0:elevation,1:snr"
@@ -83,6 +84,8 @@ EXPORT opt_t sysopts[]={
     {"pos1-ionoopt",    3,  (void *)&prcopt_.ionoopt,    IONOPT },
     {"pos1-tropopt",    3,  (void *)&prcopt_.tropopt,    TRPOPT },
     {"pos1-sateph",     3,  (void *)&prcopt_.sateph,     EPHOPT },
+    {"pos1-gloorb",     3,  (void *)&prcopt_.gloorb,     GORBOPT},
+    {"pos1-pephfit",    3,  (void *)&prcopt_.pephfit,    SWTOPT },
     {"pos1-posopt1",    3,  (void *)&prcopt_.posopt[0],  SWTOPT },
     {"pos1-posopt2",    3,  (void *)&prcopt_.posopt[1],  SWTOPT },
     {"pos1-posopt3",    3,  (void *)&prcopt_.posopt[2],  PHWOPT },
@@ -209,6 +212,7 @@ EXPORT opt_t sysopts[]={
     {"file-geexefile",  2,  (void *)&filopt_.geexe,      ""     },
     {"file-solstatfile",2,  (void *)&filopt_.solstat,    ""     },
     {"file-tracefile",  2,  (void *)&filopt_.trace,      ""     },
+    {"file-cachedir",   2,  (void *)&filopt_.cache,      ""     },
     
     {"",0,NULL,""} /* terminator */
 };
@@ -44,47 +44,26 @@
 *                            delete function to use L2 instead of L5 PCV
 *                            writing solution file in binary mode
 *-----------------------------------------------------------------------------*/
+#define _POSIX_C_SOURCE 200809L
+#include <sys/stat.h>
 #include "rtklib.h"
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 #define MIN(x,y)    ((x)<(y)?(x):(y))
 #define SQRT(x)     ((x)<=0.0||(x)!=(x)?0.0:sqrt(x))
 
 #define MAXPRCDAYS  100          /* max days of continuous processing */
 #define MAXINFILE   1000         /* max number of input files */
-#define MAXINVALIDTM 100         /* max number of invalid time marks */
-
-/* constants/global variables ------------------------------------------------*/
-
-static satsvns_t satsvns = {0}; // Satellite SINEX meta data SVN to PRN mapping
-static pcvs_t pcvss={0};        /* satellite antenna parameters */
-static pcvs_t pcvsr={0};        /* receiver antenna parameters */
-static obs_t obss={0};          /* observation data */
-static nav_t navs={0};          /* navigation data */
-static sbs_t sbss={0};          /* sbas messages */
-static int nepoch=0;            /* number of observation epochs */
-static int nitm  =0;            /* number of invalid time marks */
-static int iobsu =0;            /* current rover observation data index */
-static int iobsr =0;            /* current reference observation data index */
-static int isbs  =0;            /* current sbas message index */
-static int iitm  =0;            /* current invalid time mark index */
-static int reverse=0;           /* analysis direction (0:forward,1:backward) */
-static int aborts=0;            /* abort status */
-static sol_t *solf;             /* forward solutions */
-static sol_t *solb;             /* backward solutions */
-static double *rbf;             /* forward base positions */
-static double *rbb;             /* backward base positions */
-static int isolf=0;             /* current forward solutions index */
-static int isolb=0;             /* current backward solutions index */
-static char proc_rov [64]="";   /* rover for current processing */
-static char proc_base[64]="";   /* base station for current processing */
-static char rtcm_file[1024]=""; /* rtcm data file */
-static char rtcm_path[1024]=""; /* rtcm data path */
-static gtime_t invalidtm[MAXINVALIDTM]={{0}};/* invalid time marks */
-static rtcm_t rtcm;             /* rtcm control struct */
-static FILE *fp_rtcm=NULL;      /* rtcm data file pointer */
+#define OBSCMAGIC   "RTKOBSC"    /* magic number of obs/nav cache file */
+#define OBSCVER     1            /* layout version of obs/nav cache file */
+#define OBSCALIGN   64           /* alignment of obs/nav cache sections (bytes) */
 
 /* show message and check break ----------------------------------------------*/
-static int checkbrk(const char *format, ...)
+static int checkbrk(const postpos_t *pp, const char *format, ...)
 {
     va_list arg;
     char buff[1024],*p=buff;
@@ -92,9 +71,9 @@ static int checkbrk(const char *format, ...)
     va_start(arg,format);
     p+=vsprintf(p,format,arg);
     va_end(arg);
-    if (*proc_rov&&*proc_base) sprintf(p," (%s-%s)",proc_rov,proc_base);
-    else if (*proc_rov ) sprintf(p," (%s)",proc_rov );
-    else if (*proc_base) sprintf(p," (%s)",proc_base);
+    if (*pp->proc_rov&&*pp->proc_base) sprintf(p," (%s-%s)",pp->proc_rov,pp->proc_base);
+    else if (*pp->proc_rov ) sprintf(p," (%s)",pp->proc_rov );
+    else if (*pp->proc_base) sprintf(p," (%s)",pp->proc_base);
     return showmsg(buff);
 }
 /* Solution option to field separator ----------------------------------------*/
@@ -132,8 +111,8 @@ static void outrpos(FILE *fp, const double *r, const solopt_t *opt)
     }
 }
 /* output header -------------------------------------------------------------*/
-static void outheader(FILE *fp, const char **file, int n, const prcopt_t *popt,
-                      const solopt_t *sopt)
+static void outheader(const postpos_t *pp, FILE *fp, const char **file, int n,
+                      const prcopt_t *popt, const solopt_t *sopt)
 {
     const char *s1[]={"GPST","UTC","JST"};
     gtime_t ts,te;
@@ -156,11 +135,11 @@ static void outheader(FILE *fp, const char **file, int n, const prcopt_t *popt,
         for (i=0;i<n;i++) {
             fprintf(fp,"%s inp file  : %s\n",COMMENTH,file[i]);
         }
-        for (i=0;i<obss.n;i++)    if (obss.data[i].rcv==1) break;
-        for (j=obss.n-1;j>=0;j--) if (obss.data[j].rcv==1) break;
+        for (i=0;i<pp->obss.n;i++)    if (pp->obss.data[i].rcv==1) break;
+        for (j=pp->obss.n-1;j>=0;j--) if (pp->obss.data[j].rcv==1) break;
         if (j<i) {fprintf(fp,"\n%s no rover obs data\n",COMMENTH); return;}
-        ts=obss.data[i].time;
-        te=obss.data[j].time;
+        ts=pp->obss.data[i].time;
+        te=pp->obss.data[j].time;
         t1=time2gpst(ts,&w1);
         t2=time2gpst(te,&w2);
         if (sopt->times>=1) {
@@ -216,153 +195,164 @@ static int nextobsb(const obs_t *obs, int *i, int rcv)
     return n;
 }
 /* update rtcm ssr correction ------------------------------------------------*/
-static void update_rtcm_ssr(gtime_t time)
+static void update_rtcm_ssr(postpos_t *pp, nav_t *nav, gtime_t time)
 {
     char path[1024];
     int i;
 
     /* open or swap rtcm file */
-    reppath(rtcm_file,path,time,"","");
+    reppath(pp->rtcm_file,path,time,"","");
 
-    if (strcmp(path,rtcm_path)) {
-        strcpy(rtcm_path,path);
+    if (strcmp(path,pp->rtcm_path)) {
+        strcpy(pp->rtcm_path,path);
 
-        if (fp_rtcm) fclose(fp_rtcm);
-        fp_rtcm=fopen(path,"rb");
-        if (fp_rtcm) {
-            rtcm.time=time;
-            input_rtcm3f(&rtcm,fp_rtcm);
+        if (pp->fp_rtcm) fclose(pp->fp_rtcm);
+        pp->fp_rtcm=fopen(path,"rb");
+        if (pp->fp_rtcm) {
+            pp->rtcm.time=time;
+            input_rtcm3f(&pp->rtcm,pp->fp_rtcm);
             trace(2,"rtcm file open: %s\n",path);
         }
     }
-    if (!fp_rtcm) return;
+    if (!pp->fp_rtcm) return;
 
     /* read rtcm file until current time */
-    while (timediff(rtcm.time,time)<1E-3) {
-        if (input_rtcm3f(&rtcm,fp_rtcm)<-1) break;
+    while (timediff(pp->rtcm.time,time)<1E-3) {
+        if (input_rtcm3f(&pp->rtcm,pp->fp_rtcm)<-1) break;
 
         /* update ssr corrections */
         for (i=0;i<MAXSAT;i++) {
-          if (!rtcm.ssr[i].update) continue;
-          if (rtcm.ssr[i].iod[0] != rtcm.ssr[i].iod[1]) continue;
-          if (timediff(time, rtcm.ssr[i].t0[0]) < -1E-3) continue;
-          int ssr_iode = rtcm.ssr[i].iode;
-          if (navs.ssr[i][0].iode != ssr_iode) {
-            trace(4, "update_rtcm_ssr new sat=%d iode %d to %d\n", i + 1, navs.ssr[i][0].iode, ssr_iode);
+          if (!pp->rtcm.ssr[i].update) continue;
+          if (pp->rtcm.ssr[i].iod[0] != pp->rtcm.ssr[i].iod[1]) continue;
+          if (timediff(time, pp->rtcm.ssr[i].t0[0]) < -1E-3) continue;
+          int ssr_iode = pp->rtcm.ssr[i].iode;
+          if (nav->ssr[i][0].iode != ssr_iode) {
+            trace(4, "update_rtcm_ssr new sat=%d iode %d to %d\n", i + 1, nav->ssr[i][0].iode, ssr_iode);
             // New SSR IODE, save old SSR.
-            navs.ssr[i][1] = navs.ssr[i][0];
+            nav->ssr[i][1] = nav->ssr[i][0];
           }
-          navs.ssr[i][0] = rtcm.ssr[i];
-          rtcm.ssr[i].update = 0;
+          nav->ssr[i][0] = pp->rtcm.ssr[i];
+          pp->rtcm.ssr[i].update = 0;
         }
         // Update vtec.
-        navs.vtec = rtcm.nav.vtec;
+        nav->vtec = pp->rtcm.nav.vtec;
     }
 }
 /* Input obs data, navigation messages and sbas correction -------------------*/
-static int inputobs(obsd_t *obs, int solq, const prcopt_t *popt)
+static int inputobs(postpos_t *pp, pppass_t *ps, obsd_t *obs, int solq,
+                    const prcopt_t *popt)
 {
-    trace(3,"\ninfunc  : dir=%d iobsu=%d iobsr=%d isbs=%d\n",reverse,iobsu,iobsr,isbs);
+    trace(3,"\ninfunc  : dir=%d iobsu=%d iobsr=%d isbs=%d\n",ps->reverse,ps->iobsu,ps->iobsr,ps->isbs);
 
-    if (0<=iobsu&&iobsu<obss.n) {
-        gtime_t time = obss.data[iobsu].time;
-        settime(time);
+    if (0<=ps->iobsu&&ps->iobsu<pp->obss.n) {
+        gtime_t time = pp->obss.data[ps->iobsu].time;
         char tstr[40];
-        if (checkbrk("processing : %s Q=%d",time2str(time,tstr,0),solq)) {
-            aborts=1;
+        int stat;
+
+        /* passes in threads share the abort status and the callbacks */
+        rtklib_lock(&pp->lock);
+        if (ps->prog) {
+            settime(time);
+            stat=checkbrk(pp,"processing : %s Q=%d",time2str(time,tstr,0),solq);
+        }
+        else stat=checkbrk(pp,"");
+        if (stat&&!pp->aborts) {
+            pp->aborts=1;
             showmsg("aborted");
-            return -1;
         }
+        stat=pp->aborts;
+        rtklib_unlock(&pp->lock);
+        if (stat) return -1;
     }
     int n=0;
-    if (!reverse) {
+    if (!ps->reverse) {
         /* Input forward data */
-        int nu=nextobsf(&obss,&iobsu,1);
+        int nu=nextobsf(&pp->obss,&ps->iobsu,1);
         if (nu<=0) return -1;
-        for (int i=0;i<nu&&n<MAXOBS*2;i++) obs[n++]=obss.data[iobsu+i];
-        if (iobsr<obss.n) {
+        for (int i=0;i<nu&&n<MAXOBS*2;i++) obs[n++]=pp->obss.data[ps->iobsu+i];
+        if (ps->iobsr<pp->obss.n) {
             if (popt->intpref) {
                 /* For interpolation, find first base timestamp after rover timestamp */
-                int nr=nextobsf(&obss,&iobsr,2);
+                int nr=nextobsf(&pp->obss,&ps->iobsr,2);
                 while (nr>0) {
-                    if (timediff(obss.data[iobsr].time,obss.data[iobsu].time)>-DTTOL) break;
-                    iobsr+=nr;
-                    nr=nextobsf(&obss,&iobsr,2);
+                    if (timediff(pp->obss.data[ps->iobsr].time,pp->obss.data[ps->iobsu].time)>-DTTOL) break;
+                    ps->iobsr+=nr;
+                    nr=nextobsf(&pp->obss,&ps->iobsr,2);
                 }
             } else {
                 /* If not interpolating, find the closest iobsr timestamp before or after iobsu. */
-                double dt=fabs(timediff(obss.data[iobsr].time,obss.data[iobsu].time));
-                int i=iobsr,nr=nextobsf(&obss,&i,2);
+                double dt=fabs(timediff(pp->obss.data[ps->iobsr].time,pp->obss.data[ps->iobsu].time));
+                int i=ps->iobsr,nr=nextobsf(&pp->obss,&i,2);
                 while (nr>0) {
-                    double dt_next=fabs(timediff(obss.data[i].time,obss.data[iobsu].time));
+                    double dt_next=fabs(timediff(pp->obss.data[i].time,pp->obss.data[ps->iobsu].time));
                     if (dt_next>dt) break;
                     dt=dt_next;
-                    iobsr=i;
+                    ps->iobsr=i;
                     i+=nr;
-                    nr=nextobsf(&obss,&i,2);
+                    nr=nextobsf(&pp->obss,&i,2);
                 }
             }
             /* Recalculate nr for the determined iobsr. This does not change iobsr. */
-            int nr=nextobsf(&obss,&iobsr,2);
-            for (int i=0;i<nr&&n<MAXOBS*2;i++) obs[n++]=obss.data[iobsr+i];
+            int nr=nextobsf(&pp->obss,&ps->iobsr,2);
+            for (int i=0;i<nr&&n<MAXOBS*2;i++) obs[n++]=pp->obss.data[ps->iobsr+i];
         }
-        iobsu+=nu;
+        ps->iobsu+=nu;
 
         /* Update sbas corrections */
-        while (isbs<sbss.n) {
-            gtime_t time=gpst2time(sbss.msgs[isbs].week,sbss.msgs[isbs].tow);
+        while (ps->isbs<pp->sbss.n) {
+            gtime_t time=gpst2time(pp->sbss.msgs[ps->isbs].week,pp->sbss.msgs[ps->isbs].tow);
 
-            if (getbitu(sbss.msgs[isbs].msg,8,6)!=9) { /* Except for geo nav */
-                sbsupdatecorr(sbss.msgs+isbs,&navs);
+            if (getbitu(pp->sbss.msgs[ps->isbs].msg,8,6)!=9) { /* Except for geo nav */
+                sbsupdatecorr(pp->sbss.msgs+ps->isbs,ps->nav);
             }
             if (timediff(time,obs[0].time)>-1.0-DTTOL) break;
-            isbs++;
+            ps->isbs++;
         }
         /* Update rtcm ssr corrections */
-        if (*rtcm_file) {
-            update_rtcm_ssr(obs[0].time);
+        if (*pp->rtcm_file) {
+            update_rtcm_ssr(pp,ps->nav,obs[0].time);
         }
     } else {
         /* Input backward data */
-        int nu=nextobsb(&obss,&iobsu,1);
+        int nu=nextobsb(&pp->obss,&ps->iobsu,1);
         if (nu<=0) return -1;
-        for (int i=0;i<nu&&n<MAXOBS*2;i++) obs[n++]=obss.data[iobsu-nu+1+i];
-        if (iobsr>=0) {
+        for (int i=0;i<nu&&n<MAXOBS*2;i++) obs[n++]=pp->obss.data[ps->iobsu-nu+1+i];
+        if (ps->iobsr>=0) {
             if (popt->intpref) {
                 /* For interpolation, find first base timestamp before rover timestamp */
-                int nr=nextobsb(&obss,&iobsr,2);
+                int nr=nextobsb(&pp->obss,&ps->iobsr,2);
                 while (nr>0) {
-                  if (timediff(obss.data[iobsr].time,obss.data[iobsu].time)<DTTOL) break;
-                  iobsr-=nr;
-                  nr=nextobsb(&obss,&iobsr,2);
+                  if (timediff(pp->obss.data[ps->iobsr].time,pp->obss.data[ps->iobsu].time)<DTTOL) break;
+                  ps->iobsr-=nr;
+                  nr=nextobsb(&pp->obss,&ps->iobsr,2);
                 }
             } else {
                 /* If not interpolating, find the closest iobsr timestamp before or after iobsu. */
-                double dt=fabs(timediff(obss.data[iobsr].time,obss.data[iobsu].time));
-                int i=iobsr,nr=nextobsb(&obss,&i,2);
+                double dt=fabs(timediff(pp->obss.data[ps->iobsr].time,pp->obss.data[ps->iobsu].time));
+                int i=ps->iobsr,nr=nextobsb(&pp->obss,&i,2);
                 while (nr>0) {
-                    double dt_next=fabs(timediff(obss.data[i].time,obss.data[iobsu].time));
+                    double dt_next=fabs(timediff(pp->obss.data[i].time,pp->obss.data[ps->iobsu].time));
                     if (dt_next>dt) break;
                     dt=dt_next;
-                    iobsr=i;
+                    ps->iobsr=i;
                     i-=nr;
-                    nr=nextobsb(&obss,&i,2);
+                    nr=nextobsb(&pp->obss,&i,2);
                 }
             }
-            int nr=nextobsb(&obss,&iobsr,2);
-            for (int i=0;i<nr&&n<MAXOBS*2;i++) obs[n++]=obss.data[iobsr-nr+1+i];
+            int nr=nextobsb(&pp->obss,&ps->iobsr,2);
+            for (int i=0;i<nr&&n<MAXOBS*2;i++) obs[n++]=pp->obss.data[ps->iobsr-nr+1+i];
         }
-        iobsu-=nu;
+        ps->iobsu-=nu;
 
         /* Update sbas corrections */
-        while (isbs>=0) {
-            gtime_t time=gpst2time(sbss.msgs[isbs].week,sbss.msgs[isbs].tow);
+        while (ps->isbs>=0) {
+            gtime_t time=gpst2time(pp->sbss.msgs[ps->isbs].week,pp->sbss.msgs[ps->isbs].tow);
 
-            if (getbitu(sbss.msgs[isbs].msg,8,6)!=9) { /* Except for geo nav */
-                sbsupdatecorr(sbss.msgs+isbs,&navs);
+            if (getbitu(pp->sbss.msgs[ps->isbs].msg,8,6)!=9) { /* Except for geo nav */
+                sbsupdatecorr(pp->sbss.msgs+ps->isbs,ps->nav);
             }
             if (timediff(time,obs[0].time)<1.0+DTTOL) break;
-            isbs--;
+            ps->isbs--;
         }
     }
     return n;
@@ -439,8 +429,8 @@ static void corr_phase_bias_ssr(obsd_t *obs, int n, const nav_t *nav)
     }
 }
 /* process positioning -------------------------------------------------------*/
-static void procpos(FILE *fp, FILE *fptm, const prcopt_t *popt, const solopt_t *sopt,
-                    rtk_t *rtk, int mode)
+static void procpos(postpos_t *pp, pppass_t *ps, FILE *fp, FILE *fptm,
+                    const prcopt_t *popt, const solopt_t *sopt, rtk_t *rtk, int mode)
 {
     gtime_t time={0};
     sol_t sol={{0}},oldsol={{0}},newsol={{0}};
@@ -457,9 +447,10 @@ static void procpos(FILE *fp, FILE *fptm, const prcopt_t *popt, const solopt_t *
     solstatic=sopt->solstatic&&
               (popt->mode==PMODE_STATIC||popt->mode==PMODE_STATIC_START||popt->mode==PMODE_PPP_STATIC);
     
-    rtcm_path[0]='\0';
+    if (!ps->reverse) pp->rtcm_path[0]='\0';
 
-    while ((nobs=inputobs(obs_ptr,rtk->sol.stat,popt))>=0) {
+    while ((nobs=inputobs(pp,ps,obs_ptr,rtk->sol.stat,popt))>=0) {
+        if (mode==SOLMODE_SINGLE_DIR||!ps->reverse) pp->nep++;
 
         /* exclude satellites */
         for (i=n=0;i<nobs;i++) {
@@ -470,14 +461,14 @@ static void procpos(FILE *fp, FILE *fptm, const prcopt_t *popt, const solopt_t *
 
         /* carrier-phase bias correction */
         if (!strstr(popt->pppopt,"-ENA_FCB")) {
-            corr_phase_bias_ssr(obs_ptr,n,&navs);
+            corr_phase_bias_ssr(obs_ptr,n,ps->nav);
         }
-        if (!rtkpos(rtk, obs_ptr,n,&navs)) {
+        if (!rtkpos(rtk, obs_ptr,n,ps->nav)) {
             if (rtk->sol.eventime.time != 0) {
                 if (mode == SOLMODE_SINGLE_DIR) {
                     if (fptm) outinvalidtm(fptm, sopt, rtk->sol.eventime);
-                } else if (!reverse&&nitm<MAXINVALIDTM) {
-                    invalidtm[nitm++] = rtk->sol.eventime;
+                } else if (!ps->reverse&&pp->nitm<MAXINVALIDTM) {
+                    pp->invalidtm[pp->nitm++] = rtk->sol.eventime;
                 }
             }
             continue;
@@ -505,23 +496,14 @@ static void procpos(FILE *fp, FILE *fptm, const prcopt_t *popt, const solopt_t *
             }
             oldsol = rtk->sol;
         }
-        else if (!reverse) { /* combined-forward */
-            if (isolf >= nepoch) {
-                free(obs_ptr);
-                return;
-            }
-            solf[isolf]=rtk->sol;
-            for (i=0;i<3;i++) rbf[i+isolf*3]=rtk->rb[i];
-            isolf++;
-        }
-        else { /* combined-backward */
-            if (isolb>=nepoch) {
+        else { /* combined-forward or combined-backward */
+            if (ps->nsol>=pp->nepoch) {
                 free(obs_ptr);
                 return;
             }
-            solb[isolb]=rtk->sol;
-            for (i=0;i<3;i++) rbb[i+isolb*3]=rtk->rb[i];
-            isolb++;
+            ps->sol[ps->nsol]=rtk->sol;
+            for (i=0;i<3;i++) ps->rb[i+ps->nsol*3]=rtk->rb[i];
+            ps->nsol++;
         }
     }
     if (mode==SOLMODE_SINGLE_DIR && solstatic&&time.time!=0.0) {
@@ -532,8 +514,8 @@ static void procpos(FILE *fp, FILE *fptm, const prcopt_t *popt, const solopt_t *
     free(obs_ptr); /* moved from stack to heap to kill a stack overflow warning */
 }
 /* validation of combined solutions ------------------------------------------*/
-static int valcomb(const sol_t *solf, const sol_t *solb, double *rbf,
-        double *rbb, const prcopt_t *popt)
+static int valcomb(const sol_t *solf, const sol_t *solb, const double *rbf,
+        const double *rbb, const prcopt_t *popt)
 {
     double dr[3],var[3];
     int i;
@@ -558,19 +540,22 @@ static int valcomb(const sol_t *solf, const sol_t *solb, double *rbf,
     return 1;
 }
 /* combine forward/backward solutions and save results ---------------------*/
-static void combres(FILE *fp, FILE *fptm, const prcopt_t *popt, const solopt_t *sopt)
+static void combres(postpos_t *pp, FILE *fp, FILE *fptm, const prcopt_t *popt,
+                    const solopt_t *sopt)
 {
     gtime_t time={0};
     sol_t sols={{0}},sol={{0}},oldsol={{0}},newsol={{0}};
     double tt,Qf[9],Qb[9],Qs[9],rbs[3]={0},rb[3]={0},rr_f[3],rr_b[3],rr_s[3];
+    const sol_t *solf=pp->pass[0].sol,*solb=pp->pass[1].sol;
+    const double *rbf=pp->pass[0].rb,*rbb=pp->pass[1].rb;
     int i,j,k,solstatic,num=0,pri[]={7,1,2,3,4,5,1,6};
 
-    trace(3,"combres : isolf=%d isolb=%d\n",isolf,isolb);
+    trace(3,"combres : isolf=%d isolb=%d\n",pp->pass[0].nsol,pp->pass[1].nsol);
 
     solstatic=sopt->solstatic&&
               (popt->mode==PMODE_STATIC||popt->mode==PMODE_STATIC_START||popt->mode==PMODE_PPP_STATIC);
 
-    for (i=0,j=isolb-1;i<isolf&&j>=0;i++,j--) {
+    for (i=0,j=pp->pass[1].nsol-1;i<pp->pass[0].nsol&&j>=0;i++,j--) {
         if ((tt=timediff(solf[i].time,solb[j].time))<-DTTOL) {
             sols=solf[i];
             for (k=0;k<3;k++) rbs[k]=rbf[k+i*3];
@@ -657,10 +642,10 @@ static void combres(FILE *fp, FILE *fptm, const prcopt_t *popt, const solopt_t *
                 time=sols.time;
             }
         }
-        if (iitm < nitm && timediff(invalidtm[iitm],sols.time)<0.0)
+        if (pp->iitm < pp->nitm && timediff(pp->invalidtm[pp->iitm],sols.time)<0.0)
         {
-            outinvalidtm(fptm,sopt,invalidtm[iitm]);
-            iitm++;
+            outinvalidtm(fptm,sopt,pp->invalidtm[pp->iitm]);
+            pp->iitm++;
         }
         if (sols.eventime.time != 0)
         {
@@ -677,9 +662,42 @@ static void combres(FILE *fp, FILE *fptm, const prcopt_t *popt, const solopt_t *
         outsol(fp,&sol,rb,sopt);
     }
 }
+/* read precise ephemeris and clock files -----------------------------------*/
+static void readpeph(const char **infile, int n, const prcopt_t *prcopt,
+                     nav_t *nav)
+{
+    size_t mem,mrec=0;
+    int i;
+
+    /* read precise ephemeris files and keep only packed ephemeris */
+    for (i=0;i<n;i++) {
+        if (strstr(infile[i],"%r")||strstr(infile[i],"%b")) continue;
+        readsp3(infile[i],nav,0);
+        mem=sizeof(peph_t)*nav->nemax; if (mem>mrec) mrec=mem;
+        packpeph(nav,0x04);
+    }
+    /* read precise clock files and keep only packed clock */
+    for (i=0;i<n;i++) {
+        if (strstr(infile[i],"%r")||strstr(infile[i],"%b")) continue;
+        readrnxc(infile[i],nav);
+        mem=sizeof(pclk_t)*nav->ncmax; if (mem>mrec) mrec=mem;
+        packpeph(nav,0x08);
+    }
+    if (nav->pephp.n>0||nav->pclkp.n>0) {
+        mem=pephmem(nav,NULL);
+        trace(2,"readpeph: ne=%d nc=%d mem=%.0f KB (max records %.0f KB)\n",
+              nav->pephp.n,nav->pclkp.n,mem/1024.0,mrec/1024.0);
+        showmsg("precise ephemeris/clock: %d/%d epochs %.1f MB (max records %.1f MB)",
+                nav->pephp.n,nav->pclkp.n,mem/1048576.0,mrec/1048576.0);
+    }
+    /* fit precise orbits by Chebyshev polynomials */
+    if (prcopt->pephfit&&nav->pephp.n>0) {
+        fitpeph(nav);
+    }
+}
 /* read prec ephemeris, sbas data, tec grid and open rtcm --------------------*/
-static void readpreceph(const char **infile, int n, const prcopt_t *prcopt,
-                        nav_t *nav, sbs_t *sbs)
+static void readpreceph(postpos_t *pp, const char **infile, int n,
+                        const prcopt_t *prcopt, nav_t *nav, sbs_t *sbs)
 {
     int i;
     const char *ext;
@@ -691,15 +709,14 @@ static void readpreceph(const char **infile, int n, const prcopt_t *prcopt,
     nav->natt=nav->nattmax=0;
     sbs->n =sbs->nmax =0;
 
-    /* read precise ephemeris files */
-    for (i=0;i<n;i++) {
-        if (strstr(infile[i],"%r")||strstr(infile[i],"%b")) continue;
-        readsp3(infile[i],nav,0);
+    /* shared precise ephemeris/clock are referenced, not copied */
+    if (pp->prod) {
+        nav->pephp=pp->prod->nav.pephp;
+        nav->pclkp=pp->prod->nav.pclkp;
+        nav->pephc=pp->prod->nav.pephc;
     }
-    /* read precise clock files */
-    for (i=0;i<n;i++) {
-        if (strstr(infile[i],"%r")||strstr(infile[i],"%b")) continue;
-        readrnxc(infile[i],nav);
+    else {
+        readpeph(infile,n,prcopt,nav);
     }
     // Read precise attitude files */
     for (i=0;i<n;i++) {
@@ -713,19 +730,19 @@ static void readpreceph(const char **infile, int n, const prcopt_t *prcopt,
     }
 
     /* set rtcm file and initialize rtcm struct */
-    rtcm_file[0]=rtcm_path[0]='\0'; fp_rtcm=NULL;
+    pp->rtcm_file[0]=pp->rtcm_path[0]='\0'; pp->fp_rtcm=NULL;
 
     for (i=0;i<n;i++) {
         if ((ext=strrchr(infile[i],'.'))&&
             (!strcmp(ext,".rtcm3")||!strcmp(ext,".RTCM3"))) {
-            strcpy(rtcm_file,infile[i]);
-            init_rtcm(&rtcm);
+            strcpy(pp->rtcm_file,infile[i]);
+            init_rtcm(&pp->rtcm);
             break;
         }
     }
 }
 /* free prec ephemeris and sbas data -----------------------------------------*/
-static void freepreceph(nav_t *nav, sbs_t *sbs)
+static void freepreceph(postpos_t *pp, nav_t *nav, sbs_t *sbs)
 {
     int i;
 
@@ -733,6 +750,13 @@ static void freepreceph(nav_t *nav, sbs_t *sbs)
 
     free(nav->peph); nav->peph=NULL; nav->ne=nav->nemax=0;
     free(nav->pclk); nav->pclk=NULL; nav->nc=nav->ncmax=0;
+    if (pp->prod) { /* shared products are freed by ppprodfree() */
+        memset(&nav->pephp,0,sizeof(pephp_t));
+        memset(&nav->pclkp,0,sizeof(pephp_t));
+        memset(&nav->pephc,0,sizeof(pephc_t));
+    }
+    freepephp(nav,0x03);
+    freepephc(nav);
     free(nav->patt); nav->patt=NULL; nav->natt=nav->nattmax=0;
     free(sbs->msgs); sbs->msgs=NULL; sbs->n =sbs->nmax =0;
     for (i=0;i<nav->nt;i++) {
@@ -741,15 +765,319 @@ static void freepreceph(nav_t *nav, sbs_t *sbs)
     }
     free(nav->tec ); nav->tec =NULL; nav->nt=nav->ntmax=0;
 
-    if (fp_rtcm) fclose(fp_rtcm);
-    free_rtcm(&rtcm);
+    if (pp->fp_rtcm) fclose(pp->fp_rtcm);
+    free_rtcm(&pp->rtcm);
+}
+/* obs/nav cache ---------------------------------------------------------------
+* the decoded obs and nav data are cached in a binary file of the sections
+* aligned by OBSCALIGN bytes:
+*
+*   obscache_t header, obsd_t obs[n], eph_t eph[n], geph_t geph[ng],
+*   seph_t seph[ns], sta_t sta[nsta], obscnav_t navigation parameters
+*
+* the layout is the in-memory layout of the structs, so the file is valid only
+* for the same version, struct sizes and build options checked by the header.
+*-----------------------------------------------------------------------------*/
+typedef struct {        /* navigation parameters of obs/nav cache */
+    double utc_gps[8],utc_glo[8],utc_gal[8],utc_qzs[8],utc_cmp[8];
+    double utc_irn[9],utc_sbs[4];
+    double ion_gps[8],ion_gal[4],ion_qzs[8],ion_cmp[8],ion_irn[8];
+    int glo_fcn[32];
+} obscnav_t;
+
+typedef struct {        /* obs/nav cache file header type */
+    char magic[8];      /* magic number (OBSCMAGIC) */
+    uint32_t ver;       /* layout version (OBSCVER) */
+    uint32_t size[8];   /* struct sizes and build options */
+    uint32_t pad;       /* padding */
+    uint64_t key;       /* key of input files and options */
+    int32_t n[6];       /* number of obs,eph,geph,seph,sta data and epochs */
+    uint64_t off[6];    /* offsets of obs,eph,geph,seph,sta,nav sections */
+} obscache_t;
+
+/* set struct sizes and build options of obs/nav cache -----------------------*/
+static void obscsize(uint32_t *size)
+{
+    size[0]=sizeof(obscache_t);
+    size[1]=sizeof(obsd_t);
+    size[2]=sizeof(eph_t);
+    size[3]=sizeof(geph_t);
+    size[4]=sizeof(seph_t);
+    size[5]=sizeof(sta_t);
+    size[6]=sizeof(obscnav_t);
+    size[7]=MAXSAT<<16|NFREQ<<8|NEXOBS;
+}
+/* offset aligned for obs/nav cache ------------------------------------------*/
+static uint64_t obscalign(uint64_t off)
+{
+    return (off+OBSCALIGN-1)/OBSCALIGN*OBSCALIGN;
+}
+/* read obs/nav cache ----------------------------------------------------------
+* read decoded obs and nav data from obs/nav cache file
+* args   : char   *file     I   obs/nav cache file
+*          uint64_t key     I   key of input files and options
+*          obs_t  *obs      O   observation data
+*          nav_t  *nav      O   navigation data (eph,geph,seph and parameters)
+*          sta_t  *sta      O   station parameters (NULL: no output)
+*          int    nsta      I   number of station parameters
+*          int    *nepoch   O   number of epochs
+* return : status (1:ok,0:no cache or invalid cache)
+* notes  : the file is mapped to memory and the data are copied to the
+*          allocated arrays of obs and nav. obs->data, nav->eph, nav->geph
+*          and nav->seph are overwritten without free.
+*-----------------------------------------------------------------------------*/
+int readobscache(const char *file, uint64_t key, obs_t *obs, nav_t *nav,
+                 sta_t *sta, int nsta, int *nepoch)
+{
+    const obscache_t *h;
+    const obscnav_t *c;
+    const uint8_t *p=NULL;
+    uint32_t size[8];
+    uint64_t len=0;
+    int i,stat=0;
+
+    trace(3,"readobscache: file=%s\n",file);
+
+#ifndef WIN32
+    struct stat st;
+    int fd;
+    if ((fd=open(file,O_RDONLY))<0) return 0;
+    if (!fstat(fd,&st)&&st.st_size>=(off_t)sizeof(obscache_t)) {
+        len=(uint64_t)st.st_size;
+        p=(const uint8_t *)mmap(NULL,(size_t)len,PROT_READ,MAP_PRIVATE,fd,0);
+        if (p==(const uint8_t *)MAP_FAILED) p=NULL;
+    }
+    close(fd);
+#else
+    FILE *fp;
+    long n;
+    uint8_t *buff=NULL;
+    if (!(fp=fopen(file,"rb"))) return 0;
+    if (!fseek(fp,0,SEEK_END)&&(n=ftell(fp))>=(long)sizeof(obscache_t)&&
+        !fseek(fp,0,SEEK_SET)&&(buff=(uint8_t *)malloc(n))&&
+        fread(buff,1,n,fp)==(size_t)n) {
+        p=buff;
+        len=(uint64_t)n;
+    }
+    fclose(fp);
+    if (!p) free(buff);
+#endif
+    if (!p) return 0;
+
+    /* validate header and sections */
+    h=(const obscache_t *)p;
+    obscsize(size);
+    if (!memcmp(h->magic,OBSCMAGIC,8)&&h->ver==OBSCVER&&
+        !memcmp(h->size,size,sizeof(size))&&h->key==key&&
+        (sta||nsta<=0)&&h->n[4]==nsta) {
+        for (i=0,stat=1;i<6;i++) {
+            uint64_t n=i<5?(uint64_t)h->n[i]:1,s=size[i<5?i+1:6];
+            if (h->n[i]<0||h->off[i]>len||n*s>len-h->off[i]) stat=0;
+        }
+    }
+    obs->data=NULL; obs->n=obs->nmax=0;
+    nav->eph =NULL; nav->n =nav->nmax =0;
+    nav->geph=NULL; nav->ng=nav->ngmax=0;
+    nav->seph=NULL; nav->ns=nav->nsmax=0;
+
+    if (stat&&((h->n[0]>0&&!(obs->data=(obsd_t *)malloc(sizeof(obsd_t)*h->n[0])))||
+               (h->n[1]>0&&!(nav->eph =(eph_t  *)malloc(sizeof(eph_t )*h->n[1])))||
+               (h->n[2]>0&&!(nav->geph=(geph_t *)malloc(sizeof(geph_t)*h->n[2])))||
+               (h->n[3]>0&&!(nav->seph=(seph_t *)malloc(sizeof(seph_t)*h->n[3]))))) {
+        free(obs->data); obs->data=NULL;
+        free(nav->eph ); nav->eph =NULL;
+        free(nav->geph); nav->geph=NULL;
+        free(nav->seph); nav->seph=NULL;
+        stat=0;
+    }
+    if (stat) {
+        obs->n=obs->nmax=h->n[0];
+        nav->n=nav->nmax=h->n[1];
+        nav->ng=nav->ngmax=h->n[2];
+        nav->ns=nav->nsmax=h->n[3];
+        if (obs->n>0) memcpy(obs->data,p+h->off[0],sizeof(obsd_t)*obs->n);
+        if (nav->n>0) memcpy(nav->eph,p+h->off[1],sizeof(eph_t)*nav->n);
+        if (nav->ng>0) memcpy(nav->geph,p+h->off[2],sizeof(geph_t)*nav->ng);
+        if (nav->ns>0) memcpy(nav->seph,p+h->off[3],sizeof(seph_t)*nav->ns);
+        if (nsta>0) memcpy(sta,p+h->off[4],sizeof(sta_t)*nsta);
+        c=(const obscnav_t *)(p+h->off[5]);
+        memcpy(nav->utc_gps,c->utc_gps,sizeof(c->utc_gps));
+        memcpy(nav->utc_glo,c->utc_glo,sizeof(c->utc_glo));
+        memcpy(nav->utc_gal,c->utc_gal,sizeof(c->utc_gal));
+        memcpy(nav->utc_qzs,c->utc_qzs,sizeof(c->utc_qzs));
+        memcpy(nav->utc_cmp,c->utc_cmp,sizeof(c->utc_cmp));
+        memcpy(nav->utc_irn,c->utc_irn,sizeof(c->utc_irn));
+        memcpy(nav->utc_sbs,c->utc_sbs,sizeof(c->utc_sbs));
+        memcpy(nav->ion_gps,c->ion_gps,sizeof(c->ion_gps));
+        memcpy(nav->ion_gal,c->ion_gal,sizeof(c->ion_gal));
+        memcpy(nav->ion_qzs,c->ion_qzs,sizeof(c->ion_qzs));
+        memcpy(nav->ion_cmp,c->ion_cmp,sizeof(c->ion_cmp));
+        memcpy(nav->ion_irn,c->ion_irn,sizeof(c->ion_irn));
+        memcpy(nav->glo_fcn,c->glo_fcn,sizeof(c->glo_fcn));
+        *nepoch=h->n[5];
+    }
+#ifndef WIN32
+    munmap((void *)p,(size_t)len);
+#else
+    free(buff);
+#endif
+    if (!stat) trace(2,"obs/nav cache invalid: %s\n",file);
+    return stat;
+}
+/* write section of obs/nav cache --------------------------------------------*/
+static int writeobscsec(FILE *fp, const void *data, size_t size, uint64_t *off)
+{
+    static const uint8_t zero[OBSCALIGN]={0};
+    size_t pad=(size_t)(obscalign(*off)-*off);
+
+    if (pad>0&&fwrite(zero,1,pad,fp)!=pad) return 0;
+    if (size>0&&fwrite(data,1,size,fp)!=size) return 0;
+    *off+=pad+size;
+    return 1;
+}
+/* write obs/nav cache ---------------------------------------------------------
+* write decoded obs and nav data to obs/nav cache file
+* args   : char   *file     I   obs/nav cache file
+*          uint64_t key     I   key of input files and options
+*          obs_t  *obs      I   observation data
+*          nav_t  *nav      I   navigation data (eph,geph,seph and parameters)
+*          sta_t  *sta      I   station parameters (NULL: no output)
+*          int    nsta      I   number of station parameters
+*          int    nepoch    I   number of epochs
+* return : status (1:ok,0:error)
+* notes  : the file is written to a temporary file and renamed to replace the
+*          cache file atomically
+*-----------------------------------------------------------------------------*/
+int writeobscache(const char *file, uint64_t key, const obs_t *obs,
+                  const nav_t *nav, const sta_t *sta, int nsta, int nepoch)
+{
+    FILE *fp;
+    obscache_t h={0};
+    obscnav_t c;
+    char tmpfile[1100];
+    uint64_t off;
+    int stat;
+
+    trace(3,"writeobscache: file=%s\n",file);
+
+    memcpy(h.magic,OBSCMAGIC,8);
+    h.ver=OBSCVER;
+    obscsize(h.size);
+    h.key=key;
+    h.n[0]=obs->n;
+    h.n[1]=nav->n;
+    h.n[2]=nav->ng;
+    h.n[3]=nav->ns;
+    h.n[4]=sta?nsta:0;
+    h.n[5]=nepoch;
+    off=obscalign(sizeof(h));
+    h.off[0]=off; off=obscalign(off+sizeof(obsd_t)*obs->n);
+    h.off[1]=off; off=obscalign(off+sizeof(eph_t )*nav->n);
+    h.off[2]=off; off=obscalign(off+sizeof(geph_t)*nav->ng);
+    h.off[3]=off; off=obscalign(off+sizeof(seph_t)*nav->ns);
+    h.off[4]=off; off=obscalign(off+sizeof(sta_t )*h.n[4]);
+    h.off[5]=off;
+
+    memset(&c,0,sizeof(c));
+    memcpy(c.utc_gps,nav->utc_gps,sizeof(c.utc_gps));
+    memcpy(c.utc_glo,nav->utc_glo,sizeof(c.utc_glo));
+    memcpy(c.utc_gal,nav->utc_gal,sizeof(c.utc_gal));
+    memcpy(c.utc_qzs,nav->utc_qzs,sizeof(c.utc_qzs));
+    memcpy(c.utc_cmp,nav->utc_cmp,sizeof(c.utc_cmp));
+    memcpy(c.utc_irn,nav->utc_irn,sizeof(c.utc_irn));
+    memcpy(c.utc_sbs,nav->utc_sbs,sizeof(c.utc_sbs));
+    memcpy(c.ion_gps,nav->ion_gps,sizeof(c.ion_gps));
+    memcpy(c.ion_gal,nav->ion_gal,sizeof(c.ion_gal));
+    memcpy(c.ion_qzs,nav->ion_qzs,sizeof(c.ion_qzs));
+    memcpy(c.ion_cmp,nav->ion_cmp,sizeof(c.ion_cmp));
+    memcpy(c.ion_irn,nav->ion_irn,sizeof(c.ion_irn));
+    memcpy(c.glo_fcn,nav->glo_fcn,sizeof(c.glo_fcn));
+
+    /* temporary file unique by process and caller */
+    sprintf(tmpfile,"%.1023s.%lu.tmp",file,(unsigned long)tickget()^
+            (unsigned long)(size_t)obs);
+    if (!(fp=fopen(tmpfile,"wb"))) {
+        trace(2,"obs/nav cache open error: %s\n",tmpfile);
+        return 0;
+    }
+    off=0;
+    stat=writeobscsec(fp,&h,sizeof(h),&off)&&
+         writeobscsec(fp,obs->data,sizeof(obsd_t)*obs->n,&off)&&
+         writeobscsec(fp,nav->eph ,sizeof(eph_t )*nav->n ,&off)&&
+         writeobscsec(fp,nav->geph,sizeof(geph_t)*nav->ng,&off)&&
+         writeobscsec(fp,nav->seph,sizeof(seph_t)*nav->ns,&off)&&
+         writeobscsec(fp,sta,sizeof(sta_t)*h.n[4],&off)&&
+         writeobscsec(fp,&c,sizeof(c),&off);
+    if (fclose(fp)) stat=0;
+    if (stat) {
+        remove(file); /* rename() does not replace file on windows */
+        stat=!rename(tmpfile,file);
+    }
+    if (!stat) {
+        trace(2,"obs/nav cache write error: %s\n",file);
+        remove(tmpfile);
+    }
+    return stat;
+}
+/* add data to key of obs/nav cache (FNV-1a) ---------------------------------*/
+static uint64_t obsckey(uint64_t key, const void *data, size_t size)
+{
+    const uint8_t *p=(const uint8_t *)data;
+    size_t i;
+
+    for (i=0;i<size;i++) key=(key^p[i])*0x100000001B3ull;
+    return key;
+}
+/* obs/nav cache file by input files and options (0:no cache) ----------------*/
+static int obscachefile(const char *dir, gtime_t ts, gtime_t te, double ti,
+                        const char **infile, const int *index, int n,
+                        const prcopt_t *prcopt, uint64_t *key, char *file)
+{
+    struct stat st;
+    char *paths[MAXEXFILE]={0};
+    int64_t val[3];
+    int i,j,m,ok=1;
+
+    *key=0xCBF29CE484222325ull;
+    *key=obsckey(*key,&ts.time,sizeof(ts.time));
+    *key=obsckey(*key,&ts.sec ,sizeof(ts.sec ));
+    *key=obsckey(*key,&te.time,sizeof(te.time));
+    *key=obsckey(*key,&te.sec ,sizeof(te.sec ));
+    *key=obsckey(*key,&ti,sizeof(ti));
+    for (i=0;i<2;i++) {
+        *key=obsckey(*key,prcopt->rnxopt[i],strlen(prcopt->rnxopt[i])+1);
+    }
+    for (i=0;i<MAXEXFILE;i++) {
+        if (!(paths[i]=(char *)malloc(1024))) ok=0;
+    }
+    for (i=0;i<n&&ok;i++) {
+        *key=obsckey(*key,index+i,sizeof(int));
+        m=expath(infile[i],paths,MAXEXFILE);
+        for (j=0;j<m&&ok;j++) {
+            if (stat(paths[j],&st)) {
+                ok=0;
+                break;
+            }
+            val[0]=(int64_t)st.st_size;
+            val[1]=(int64_t)st.st_mtime;
+            val[2]=j;
+            *key=obsckey(*key,paths[j],strlen(paths[j])+1);
+            *key=obsckey(*key,val,sizeof(val));
+        }
+    }
+    for (i=0;i<MAXEXFILE;i++) free(paths[i]);
+    if (!ok) return 0;
+    sprintf(file,"%.1000s%c%016llx.obsc",dir,RTKLIB_FILEPATHSEP,(unsigned long long)*key);
+    return 1;
 }
 /* read obs and nav data -----------------------------------------------------*/
-static int readobsnav(gtime_t ts, gtime_t te, double ti, const char **infile,
+static int readobsnav(postpos_t *pp, gtime_t ts, gtime_t te, double ti, const char **infile,
                       const int *index, int n, const prcopt_t *prcopt,
-                      obs_t *obs, nav_t *nav, sta_t *sta)
+                      const char *cachedir, obs_t *obs, nav_t *nav, sta_t *sta)
 {
-    int i,j,ind=0,nobs=0,rcv=1;
+    uint64_t key=0;
+    char cfile[1100];
+    int i,j,ind=0,nobs=0,rcv=1,cache;
 
     char tstr[40];
     trace(3,"readobsnav: ts=%s n=%d\n",time2str(ts,tstr,0),n);
@@ -759,10 +1087,18 @@ static int readobsnav(gtime_t ts, gtime_t te, double ti, const char **infile,
     nav->geph=NULL; nav->ng=nav->ngmax=0;
     /* free(nav->seph); */ /* is this needed to avoid memory leak??? */
     nav->seph=NULL; nav->ns=nav->nsmax=0;
-    nepoch=0;
+    pp->nepoch=0;
 
+    /* decoded obs and nav data in cache */
+    cache=*cachedir&&obscachefile(cachedir,ts,te,ti,infile,index,n,prcopt,&key,
+                                  cfile);
+    if (cache&&readobscache(cfile,key,obs,nav,sta,2,&pp->nepoch)) {
+        trace(2,"obs/nav cache read: %s\n",cfile);
+        uniqnav(nav);
+        n=0;
+    }
     for (i=0;i<n;i++) {
-        if (checkbrk("")) return 0;
+        if (checkbrk(pp,"")) return 0;
 
         if (index[i]!=ind) {
             if (obs->n>nobs) rcv++;
@@ -778,26 +1114,32 @@ static int readobsnav(gtime_t ts, gtime_t te, double ti, const char **infile,
         /* read rinex obs and nav file */
         if (readrnxt(infile[i],rcv,tsw,tew,ti,prcopt->rnxopt[rcv<=1?0:1],obs,nav,
                      rcv<=2?sta+rcv-1:NULL)<0) {
-            checkbrk("error : insufficient memory");
+            checkbrk(pp,"error : insufficient memory");
             trace(1,"insufficient memory\n");
             return 0;
         }
     }
     if (obs->n<=0) {
-        checkbrk("error : no obs data");
+        checkbrk(pp,"error : no obs data");
         trace(1,"\n");
         return 0;
     }
     if (nav->n<=0&&nav->ng<=0&&nav->ns<=0&&prcopt->sateph!=EPHOPT_PREC) {
-        checkbrk("error : no nav data");
+        checkbrk(pp,"error : no nav data");
         trace(1,"\n");
         return 0;
     }
-    /* sort observation data */
-    nepoch=sortobs(obs);
+    if (n>0) {
+        /* sort observation data */
+        pp->nepoch=sortobs(obs);
 
-    /* delete duplicated ephemeris */
-    uniqnav(nav);
+        /* delete duplicated ephemeris */
+        uniqnav(nav);
+
+        /* precise clocks not cached */
+        if (cache&&nav->nc<=0) writeobscache(cfile,key,obs,nav,sta,2,pp->nepoch);
+    }
+    evalnav(nav,prcopt->gloorb);
 
     /* set time span for progress display */
     if (ts.time==0||te.time==0) {
@@ -896,13 +1238,10 @@ static int antpos(prcopt_t *opt, int base, const obs_t *obs, const nav_t *nav,
     }
     return 1;
 }
-/* open processing session ----------------------------------------------------*/
-static int openses(const prcopt_t *popt, const solopt_t *sopt,
-                   const filopt_t *fopt, nav_t *nav, satsvns_t *satsvns, pcvs_t *pcvs, pcvs_t *pcvr)
+/* read satellite meta data and antenna parameters --------------------------*/
+static int readant(const filopt_t *fopt, satsvns_t *satsvns, pcvs_t *pcvs,
+                   pcvs_t *pcvr)
 {
-    (void)popt; (void)nav;
-    trace(3,"openses :\n");
-
     // Read satellite meta data, svn to prn mapping.
     if (*fopt->satmeta && !readsinex(fopt->satmeta, satsvns)) {
       showmsg("error : reading sat meta sinex %s", fopt->satmeta);
@@ -922,9 +1261,19 @@ static int openses(const prcopt_t *popt, const solopt_t *sopt,
         trace(1,"rec antenna pcv read error: %s\n",fopt->rcvantp);
         return 0;
     }
+    return 1;
+}
+/* open processing session ----------------------------------------------------*/
+static int openses(postpos_t *pp, const solopt_t *sopt, const filopt_t *fopt)
+{
+    trace(3,"openses :\n");
 
-    /* open geoid data */
-    if (sopt->geoid>0&&*fopt->geoid) {
+    /* shared antenna parameters are read by ppprodread() */
+    if (!pp->prod&&!readant(fopt,&pp->satsvns,&pp->pcvss,&pp->pcvsr)) {
+        return 0;
+    }
+    /* open geoid data (opened by the caller with shared products) */
+    if (!pp->prod&&sopt->geoid>0&&*fopt->geoid) {
         if (!opengeoid(sopt->geoid,fopt->geoid)) {
             showmsg("error : no geoid data %s",fopt->geoid);
             trace(2,"no geoid data %s\n",fopt->geoid);
@@ -933,21 +1282,24 @@ static int openses(const prcopt_t *popt, const solopt_t *sopt,
     return 1;
 }
 /* Close processing session ---------------------------------------------------*/
-static void closeses(nav_t *nav, satsvns_t *satsvns, pcvs_t *pcvs, pcvs_t *pcvr)
+static void closeses(postpos_t *pp)
 {
+    nav_t *nav=&pp->navs;
+    satsvns_t *satsvns=&pp->satsvns;
+
     trace(3,"closeses:\n");
 
     // Free SINEX SVN to PRN mappings.
-    free(satsvns->satsvn);
+    free(satsvns->satsvn); satsvns->satsvn=NULL; satsvns->n=satsvns->nmax=0;
 
     // Free antenna parameters.
     // Clear copies in nav.
     for (int i = 0; i < MAXSAT; i++) free_pcv(&nav->pcvs[i]);
-    free_pcvs(pcvs);
-    free_pcvs(pcvr);
+    free_pcvs(&pp->pcvss);
+    free_pcvs(&pp->pcvsr);
 
     /* close geoid data */
-    closegeoid();
+    if (!pp->prod) closegeoid();
 
     /* free erp data */
     free(nav->erp.data); nav->erp.data=NULL; nav->erp.n=nav->erp.nmax=0;
@@ -1018,7 +1370,7 @@ static void readotl(prcopt_t *popt, const char *file, const sta_t *stas)
     }
 }
 /* write header to output file -----------------------------------------------*/
-static int outhead(const char *outfile, const char **infile, int n,
+static int outhead(const postpos_t *pp, const char *outfile, const char **infile, int n,
                    const prcopt_t *popt, const solopt_t *sopt)
 {
     FILE *fp=stdout;
@@ -1034,7 +1386,7 @@ static int outhead(const char *outfile, const char **infile, int n,
         }
     }
     /* output header */
-    outheader(fp,infile,n,popt,sopt);
+    outheader(pp,fp,infile,n,popt,sopt);
 
     if (*outfile) fclose(fp);
 
@@ -1064,8 +1416,89 @@ static void namefiletm(char *outfiletm, const char *outfile)
     strncpy(outfiletm, outfile, i);
     strcat(outfiletm, "_events.pos");
 }
+/* initialize processing pass -----------------------------------------------*/
+static void initpass(const postpos_t *pp, pppass_t *ps, int reverse, nav_t *nav)
+{
+    ps->reverse=reverse;
+    ps->iobsu=ps->iobsr=reverse?pp->obss.n-1:0;
+    ps->isbs=reverse?pp->sbss.n-1:0;
+    ps->prog=1;
+    ps->nav=nav;
+    ps->nsol=0;
+}
+/* backward pass thread ------------------------------------------------------*/
+typedef struct {        /* backward pass thread argument type */
+    postpos_t *pp;      /* post-processing context */
+    const prcopt_t *popt; /* processing options */
+    const solopt_t *sopt; /* solution options */
+    rtk_t *rtk;         /* rtk control/result struct of the pass */
+} passarg_t;
+
+#ifdef WIN32
+static DWORD WINAPI passthread(void *arg)
+#else
+static void *passthread(void *arg)
+#endif
+{
+    passarg_t *parg=(passarg_t *)arg;
+
+    rtkinit(parg->rtk,parg->popt);
+    procpos(parg->pp,parg->pp->pass+1,NULL,NULL,parg->popt,parg->sopt,parg->rtk,
+            SOLMODE_COMBINED);
+    rtkfree(parg->rtk);
+    return 0;
+}
+/* process combined forward/backward passes in threads -------------------------
+* the forward pass runs in the calling thread and the backward pass in a new
+* thread with its own rtk_t. return 0 without processing if the passes are not
+* independent (no phase reset, sbas or ssr corrections updating the navigation
+* data) or they share process wide outputs (trace, solution statistics) so
+* that the caller runs them serially.
+*-----------------------------------------------------------------------------*/
+static int procpass(postpos_t *pp, const prcopt_t *popt, const solopt_t *sopt,
+                    rtk_t *rtk)
+{
+    rtklib_thread_t thread;
+    passarg_t parg;
+    rtk_t *rtkb;
+
+    if (!pp->passthread||popt->soltype!=SOLTYPE_COMBINED||pp->sbss.n>0||
+        *pp->rtcm_file||sopt->trace>0||sopt->sstat>0) {
+        return 0;
+    }
+    trace(3,"procpass: nepoch=%d\n",pp->nepoch);
+
+    if (!(rtkb=(rtk_t *)malloc(sizeof(rtk_t)))) return 0;
+    parg.pp=pp;
+    parg.popt=popt;
+    parg.sopt=sopt;
+    parg.rtk=rtkb;
+    pp->pass[1].prog=0; /* progress by forward pass */
+
+#ifdef WIN32
+    if (!(thread=CreateThread(NULL,0,passthread,&parg,0,NULL))) {
+#else
+    if (pthread_create(&thread,NULL,passthread,&parg)) {
+#endif
+        pp->pass[1].prog=1;
+        free(rtkb);
+        return 0;
+    }
+    rtkinit(rtk,popt);
+    procpos(pp,pp->pass,NULL,NULL,popt,sopt,rtk,SOLMODE_COMBINED); /* forward */
+    rtkfree(rtk);
+
+#ifdef WIN32
+    WaitForSingleObject(thread,INFINITE);
+    CloseHandle(thread);
+#else
+    pthread_join(thread,NULL);
+#endif
+    free(rtkb);
+    return 1;
+}
 /* execute processing session ------------------------------------------------*/
-static int execses(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
+static int execses(postpos_t *pp, gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
                    const solopt_t *sopt, const filopt_t *fopt, int flag,
                    const char **infile, const int *index, int n, const char *outfile)
 {
@@ -1095,14 +1528,14 @@ static int execses(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
         if (strlen(ext)==4&&(ext[3]=='i'||ext[3]=='I'||
                              strcmp(ext,".INX")==0||strcmp(ext,".inx")==0)) {
             reppath(fopt->iono,path,ts,"","");
-            readtec(path,&navs,1);
+            readtec(path,&pp->navs,1);
         }
     }
     /* read erp data */
     if (*fopt->eop) {
-        free(navs.erp.data); navs.erp.data=NULL; navs.erp.n=navs.erp.nmax=0;
+        free(pp->navs.erp.data); pp->navs.erp.data=NULL; pp->navs.erp.n=pp->navs.erp.nmax=0;
         reppath(fopt->eop,path,ts,"","");
-        if (readerp(path,&navs.erp) == 0) {
+        if (readerp(path,&pp->navs.erp) == 0) {
             showmsg("error : no erp data %s",path);
             trace(2,"no erp data %s\n",path);
         }
@@ -1112,7 +1545,9 @@ static int execses(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
 
     /* Read obs and nav data */
     sta_t stas[MAXRCV]; // Station information.
-    if (!readobsnav(ts,te,ti,infile,index,n,&popt_,&obss,&navs,stas)) {
+    memset(stas,0,sizeof(stas));
+    if (!readobsnav(pp,ts,te,ti,infile,index,n,&popt_,fopt->cache,&pp->obss,
+                    &pp->navs,stas)) {
       err = 1;
       goto done;
     }
@@ -1122,8 +1557,8 @@ static int execses(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
     // If the names are automatic then use the rinex marker name or
     // the process name else use the supplied name.
     if (strcmp(popt_.name[0], "*") == 0) {
-      if (stas[0].name[0] == '\0' && strcmp(proc_rov, stas[0].name)) {
-        snprintf(stas[0].name, sizeof(stas[0].name), "%s", proc_rov);
+      if (stas[0].name[0] == '\0' && strcmp(pp->proc_rov, stas[0].name)) {
+        snprintf(stas[0].name, sizeof(stas[0].name), "%s", pp->proc_rov);
         trace(2, "effective rover name (%s)\n", stas[0].name);
       }
       snprintf(popt_.name[0], sizeof(popt_.name[0]), "%s", stas[0].name);
@@ -1133,8 +1568,8 @@ static int execses(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
     }
 
     if (strcmp(popt_.name[1], "*") == 0) {
-      if (stas[1].name[0] == '\0' && strcmp(proc_base, stas[1].name)) {
-        snprintf(stas[1].name, sizeof(stas[1].name), "%s", proc_base);
+      if (stas[1].name[0] == '\0' && strcmp(pp->proc_base, stas[1].name)) {
+        snprintf(stas[1].name, sizeof(stas[1].name), "%s", pp->proc_base);
         trace(2, "effective base name (%s)\n", stas[1].name);
       }
       snprintf(popt_.name[1], sizeof(popt_.name[1]), "%s", stas[1].name);
@@ -1148,37 +1583,44 @@ static int execses(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
     for (int i=0;i<MAX_CODE_BIASES;i++)
       for (k=0;k<NFREQ;k++) {
         /* FIXME: cbias later initialized with 0 in readdcb()!  */
-        for (j=0;j<MAXSAT;j++) navs.cbias[j][k][i]=0;
+        for (j=0;j<MAXSAT;j++) pp->navs.cbias[j][k][i]=0;
       }
     for (int i=0;i<n;i++) {  /* first check infiles for .BIA or .BSX files */
-        if ((dcb_ok=readdcb(infile[i],&navs,stas))) break;
+        if ((dcb_ok=readdcb(infile[i],&pp->navs,stas))) break;
     }
     if (!dcb_ok&&*fopt->dcb) {  /* then check if DCB file specified */
         reppath(fopt->dcb,path,ts,"","");
-        dcb_ok=readdcb(path,&navs,stas);
+        dcb_ok=readdcb(path,&pp->navs,stas);
     }
     if (!dcb_ok) {
 
     }
     /* set antenna parameters */
-    setpcv(obss.n>0?obss.data[0].time:timeget(),&popt_,&navs,&satsvns,&pcvss,&pcvsr,stas);
+    if (pp->prod) {
+        setpcv(pp->obss.n>0?pp->obss.data[0].time:timeget(),&popt_,&pp->navs,
+               &pp->prod->satsvns,&pp->prod->pcvs,&pp->prod->pcvr,stas);
+    }
+    else {
+        setpcv(pp->obss.n>0?pp->obss.data[0].time:timeget(),&popt_,&pp->navs,
+               &pp->satsvns,&pp->pcvss,&pp->pcvsr,stas);
+    }
     /* read ocean tide loading parameters */
     if (*fopt->blq) {
         readotl(&popt_,fopt->blq,stas);
     }
     /* rover/reference fixed position */
     if (popt_.mode==PMODE_FIXED) {
-        if (!antpos(&popt_,0,&obss,&navs,stas,fopt->stapos)) {
+        if (!antpos(&popt_,0,&pp->obss,&pp->navs,stas,fopt->stapos)) {
           err = 1;
           goto done;
         }
-        if (!antpos(&popt_,1,&obss,&navs,stas,fopt->stapos)) {
+        if (!antpos(&popt_,1,&pp->obss,&pp->navs,stas,fopt->stapos)) {
           err = 1;
           goto done;
         }
     }
     else if (PMODE_DGPS<=popt_.mode&&popt_.mode<=PMODE_STATIC_START) {
-        if (!antpos(&popt_,1,&obss,&navs,stas,fopt->stapos)) {
+        if (!antpos(&popt_,1,&pp->obss,&pp->navs,stas,fopt->stapos)) {
           err = 1;
           goto done;
         }
@@ -1200,16 +1642,18 @@ static int execses(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
         rtkopenstat(statfile,sopt->sstat);
     }
     /* write header to output file */
-    if (flag&&!outhead(outfile,infile,n,&popt_,sopt)) {
+    if (flag&&!outhead(pp,outfile,infile,n,&popt_,sopt)) {
       err = 1;
       goto done;
     }
     /* name time events file */
     namefiletm(outfiletm,outfile);
     /* write header to file with time marks */
-    outhead(outfiletm,infile,n,&popt_,sopt);
+    outhead(pp,outfiletm,infile,n,&popt_,sopt);
 
-    iobsu=iobsr=isbs=reverse=aborts=0;
+    pp->aborts=0;
+    initpass(pp,pp->pass  ,0,&pp->navs);
+    initpass(pp,pp->pass+1,1,&pp->navs);
 
     if (popt_.mode==PMODE_SINGLE||popt_.soltype==SOLTYPE_FORWARD) {
         FILE *fp=openfile(outfile);
@@ -1217,7 +1661,7 @@ static int execses(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
             FILE *fptm=openfile(outfiletm);
             if (fptm) {
                 rtkinit(rtk_ptr,&popt_);
-                procpos(fp,fptm,&popt_,sopt,rtk_ptr,SOLMODE_SINGLE_DIR);
+                procpos(pp,pp->pass,fp,fptm,&popt_,sopt,rtk_ptr,SOLMODE_SINGLE_DIR);
                 rtkfree(rtk_ptr);
                 fclose(fptm);
             }
@@ -1229,9 +1673,8 @@ static int execses(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
         if (fp) {
             FILE *fptm=openfile(outfiletm);
             if (fptm) {
-                reverse=1; iobsu=iobsr=obss.n-1; isbs=sbss.n-1;
                 rtkinit(rtk_ptr,&popt_);
-                procpos(fp,fptm,&popt_,sopt,rtk_ptr,SOLMODE_SINGLE_DIR);
+                procpos(pp,pp->pass+1,fp,fptm,&popt_,sopt,rtk_ptr,SOLMODE_SINGLE_DIR);
                 rtkfree(rtk_ptr);
                 fclose(fptm);
             }
@@ -1239,31 +1682,32 @@ static int execses(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
         }
     }
     else { /* combined or combined with no phase reset */
-        solf=(sol_t *)malloc(sizeof(sol_t)*nepoch);
-        solb=(sol_t *)malloc(sizeof(sol_t)*nepoch);
-        rbf=(double *)malloc(sizeof(double)*nepoch*3);
-        rbb=(double *)malloc(sizeof(double)*nepoch*3);
-
-        if (solf&&solb) {
-            isolf=isolb=0;
-            rtkinit(rtk_ptr,&popt_);
-            procpos(NULL,NULL,&popt_,sopt,rtk_ptr,SOLMODE_COMBINED); /* forward */
-            reverse=1; iobsu=iobsr=obss.n-1; isbs=sbss.n-1;
-            if (popt_.soltype!=SOLTYPE_COMBINED_NORESET) {
-                /* Reset */
-                rtkfree(rtk_ptr);
+        pppass_t *psf=pp->pass,*psb=pp->pass+1;
+
+        psf->sol=(sol_t *)malloc(sizeof(sol_t)*pp->nepoch);
+        psb->sol=(sol_t *)malloc(sizeof(sol_t)*pp->nepoch);
+        psf->rb=(double *)malloc(sizeof(double)*pp->nepoch*3);
+        psb->rb=(double *)malloc(sizeof(double)*pp->nepoch*3);
+
+        if (psf->sol&&psb->sol&&psf->rb&&psb->rb) {
+            if (!procpass(pp,&popt_,sopt,rtk_ptr)) {
                 rtkinit(rtk_ptr,&popt_);
+                procpos(pp,psf,NULL,NULL,&popt_,sopt,rtk_ptr,SOLMODE_COMBINED); /* forward */
+                if (popt_.soltype!=SOLTYPE_COMBINED_NORESET) {
+                    /* Reset */
+                    rtkfree(rtk_ptr);
+                    rtkinit(rtk_ptr,&popt_);
+                }
+                procpos(pp,psb,NULL,NULL,&popt_,sopt,rtk_ptr,SOLMODE_COMBINED); /* backward */
+                rtkfree(rtk_ptr);
             }
-            procpos(NULL,NULL,&popt_,sopt,rtk_ptr,SOLMODE_COMBINED); /* backward */
-            rtkfree(rtk_ptr);
-
             /* combine forward/backward solutions */
-            if (!aborts) {
+            if (!pp->aborts) {
                 FILE *fp=openfile(outfile);
                 if (fp) {
                     FILE *fptm=openfile(outfiletm);
                     if (fptm) {
-                        combres(fp,fptm,&popt_,sopt);
+                        combres(pp,fp,fptm,&popt_,sopt);
                         fclose(fptm);
                     }
                     fclose(fp);
@@ -1271,21 +1715,21 @@ static int execses(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
             }
         }
         else showmsg("error : memory allocation");
-        free(solf);
-        free(solb);
-        free(rbf);
-        free(rbb);
+        free(psf->sol); psf->sol=NULL;
+        free(psb->sol); psb->sol=NULL;
+        free(psf->rb); psf->rb=NULL;
+        free(psb->rb); psb->rb=NULL;
     }
     /* free rtk, obs and nav data */
 done:
     for (int i = 0; i < 2; i++) free_pcv(&popt_.pcvr[i]);
     free(rtk_ptr);
-    freeobsnav(&obss,&navs);
+    freeobsnav(&pp->obss,&pp->navs);
 
-    return (!err && aborts)?1:0;
+    return (!err && pp->aborts)?1:0;
 }
 /* execute processing session for each rover ---------------------------------*/
-static int execses_r(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
+static int execses_r(postpos_t *pp, gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
                      const solopt_t *sopt, const filopt_t *fopt, int flag,
                      const char **infile, const int *index, int n, const char *outfile,
                      const char *rov)
@@ -1313,9 +1757,9 @@ static int execses_r(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
             if ((q=strchr(p,' '))) *q='\0';
 
             if (*p) {
-                strcpy(proc_rov,p);
+                strcpy(pp->proc_rov,p);
                 if (ts.time) time2str(ts,s,0); else *s='\0';
-                if (checkbrk("reading    : %s",s)) {
+                if (checkbrk(pp,"reading    : %s",s)) {
                     stat=1;
                     break;
                 }
@@ -1323,7 +1767,7 @@ static int execses_r(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
                 reppath(outfile,ofile,t0,p,"");
 
                 /* execute processing session */
-                stat=execses(ts,te,ti,popt,sopt,fopt,flag,(const char **)ifile,index,n,ofile);
+                stat=execses(pp,ts,te,ti,popt,sopt,fopt,flag,(const char **)ifile,index,n,ofile);
             }
             if (stat==1||!q) break;
         }
@@ -1331,12 +1775,12 @@ static int execses_r(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
     }
     else {
         /* execute processing session */
-        stat=execses(ts,te,ti,popt,sopt,fopt,flag,infile,index,n,outfile);
+        stat=execses(pp,ts,te,ti,popt,sopt,fopt,flag,infile,index,n,outfile);
     }
     return stat;
 }
 /* execute processing session for each base station --------------------------*/
-static int execses_b(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
+static int execses_b(postpos_t *pp, gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
                      const solopt_t *sopt, const filopt_t *fopt, int flag,
                      const char **infile, const int *index, int n, const char *outfile,
                      const char *rov, const char *base)
@@ -1349,13 +1793,13 @@ static int execses_b(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
     trace(3,"execses_b: n=%d outfile=%s\n",n,outfile);
 
     /* read prec ephemeris and sbas data */
-    readpreceph(infile,n,popt,&navs,&sbss);
+    readpreceph(pp,infile,n,popt,&pp->navs,&pp->sbss);
 
     for (i=0;i<n;i++) if (strstr(infile[i],"%b")) break;
 
     if (i<n) { /* include base station keywords */
         if (!(base_=(char *)malloc(strlen(base)+1))) {
-            freepreceph(&navs,&sbss);
+            freepreceph(pp,&pp->navs,&pp->sbss);
             return 0;
         }
         strcpy(base_,base);
@@ -1363,7 +1807,7 @@ static int execses_b(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
         for (i=0;i<n;i++) {
             if (!(ifile[i]=(char *)malloc(1024))) {
                 free(base_); for (;i>=0;i--) free(ifile[i]);
-                freepreceph(&navs,&sbss);
+                freepreceph(pp,&pp->navs,&pp->sbss);
                 return 0;
             }
         }
@@ -1371,76 +1815,130 @@ static int execses_b(gtime_t ts, gtime_t te, double ti, const prcopt_t *popt,
             if ((q=strchr(p,' '))) *q='\0';
 
             if (*p) {
-                strcpy(proc_base,p);
+                strcpy(pp->proc_base,p);
                 if (ts.time) time2str(ts,s,0); else *s='\0';
-                if (checkbrk("reading    : %s",s)) {
+                if (checkbrk(pp,"reading    : %s",s)) {
                     stat=1;
                     break;
                 }
                 for (i=0;i<n;i++) reppath(infile[i],ifile[i],t0,"",p);
                 reppath(outfile,ofile,t0,"",p);
 
-                stat=execses_r(ts,te,ti,popt,sopt,fopt,flag,(const char **)ifile,index,n,(const char *)ofile,rov);
+                stat=execses_r(pp,ts,te,ti,popt,sopt,fopt,flag,(const char **)ifile,index,n,(const char *)ofile,rov);
             }
             if (stat==1||!q) break;
         }
         free(base_); for (i=0;i<n;i++) free(ifile[i]);
     }
     else {
-        stat=execses_r(ts,te,ti,popt,sopt,fopt,flag,infile,index,n,outfile,rov);
+        stat=execses_r(pp,ts,te,ti,popt,sopt,fopt,flag,infile,index,n,outfile,rov);
     }
     /* free prec ephemeris and sbas data */
-    freepreceph(&navs,&sbss);
+    freepreceph(pp,&pp->navs,&pp->sbss);
 
     return stat;
 }
-/* post-processing positioning -------------------------------------------------
-* post-processing positioning
-* args   : gtime_t ts       I   processing start time (ts.time==0: no limit)
-*        : gtime_t te       I   processing end time   (te.time==0: no limit)
-*          double ti        I   processing interval  (s) (0:all)
-*          double tu        I   processing unit time (s) (0:all)
-*          prcopt_t *popt   I   processing options
-*          solopt_t *sopt   I   solution options
-*          filopt_t *fopt   I   file options
-*          char   **infile  I   input files (see below)
-*          int    n         I   number of input files
-*          char   *outfile  I   output file ("":stdout, see below)
-*          char   *rov      I   rover id list        (separated by " ")
-*          char   *base     I   base station id list (separated by " ")
+/* new post-processing context -------------------------------------------------
+* allocate and initialize post-processing context
+* args   : ppprod_t *prod   I   shared read-only products (NULL: no shared)
+* return : post-processing context (NULL: memory allocation error)
+* notes  : each context holds the observation data, navigation data, sbas
+*          messages, rtcm ssr stream and solution buffers of its sessions, so
+*          contexts can be processed concurrently by postposc() in threads of
+*          one process.
+*          the shared products (precise ephemeris/clock and antenna parameters
+*          read by ppprodread()) are only referenced by the contexts and must
+*          not be modified or freed while any context using them is processed.
+*          with the shared products the geoid data are opened and closed by
+*          the caller (opengeoid(),closegeoid()) instead of each session.
+*          the debug trace, solution statistics (rtkopenstat()), geoid and
+*          signal code priorities (init_code2idx()) are still process wide, so
+*          concurrent sessions should use the same sigdef option with the
+*          trace and solution statistics outputs disabled. the priorities are
+*          updated by a session only if changed, so set them by
+*          init_code2idx() before the threads. the code biases (readdcb())
+*          are read to the navigation data of each context.
+*          with pp->passthread (default on) the forward and backward passes of
+*          the combined solutions run in two threads if they are independent
+*          (see procpass()). the solutions are identical to the serial passes.
+*-----------------------------------------------------------------------------*/
+postpos_t *postposnew(const ppprod_t *prod)
+{
+    postpos_t *pp;
+
+    trace(3,"postposnew:\n");
+
+    if (!(pp=(postpos_t *)calloc(1,sizeof(postpos_t)))) return NULL;
+    pp->prod=prod;
+    pp->passthread=1;
+    rtklib_initlock(&pp->lock);
+    return pp;
+}
+/* free post-processing context ------------------------------------------------
+* free post-processing context allocated by postposnew()
+* args   : postpos_t *pp    IO  post-processing context
+* return : none
+*-----------------------------------------------------------------------------*/
+void postposfree(postpos_t *pp)
+{
+    trace(3,"postposfree:\n");
+
+    free(pp);
+}
+/* read shared post-processing products ----------------------------------------
+* read precise ephemeris/clock and antenna parameters shared by contexts
+* args   : ppprod_t *prod   O   shared products
+*          prcopt_t *popt   I   processing options (pephfit)
+*          filopt_t *fopt   I   file options (satmeta,satantp,rcvantp)
+*          char   **infile  I   precise ephemeris and clock files
+*          int    n         I   number of files
+* return : status (1:ok,0:error)
+* notes  : the file paths are used as is without keyword replacement. the
+*          precise ephemeris/clock are kept only in the packed store (and
+*          Chebyshev fitted if popt->pephfit).
+*-----------------------------------------------------------------------------*/
+int ppprodread(ppprod_t *prod, const prcopt_t *popt, const filopt_t *fopt,
+               const char **infile, int n)
+{
+    trace(3,"ppprodread: n=%d\n",n);
+
+    memset(prod,0,sizeof(ppprod_t));
+
+    if (!readant(fopt,&prod->satsvns,&prod->pcvs,&prod->pcvr)) {
+        ppprodfree(prod);
+        return 0;
+    }
+    readpeph(infile,n,popt,&prod->nav);
+    return 1;
+}
+/* free shared post-processing products ----------------------------------------
+* free shared products read by ppprodread()
+* args   : ppprod_t *prod   IO  shared products
+* return : none
+*-----------------------------------------------------------------------------*/
+void ppprodfree(ppprod_t *prod)
+{
+    trace(3,"ppprodfree:\n");
+
+    free(prod->satsvns.satsvn); prod->satsvns.satsvn=NULL;
+    prod->satsvns.n=prod->satsvns.nmax=0;
+    free_pcvs(&prod->pcvs);
+    free_pcvs(&prod->pcvr);
+    free(prod->nav.peph); prod->nav.peph=NULL; prod->nav.ne=prod->nav.nemax=0;
+    free(prod->nav.pclk); prod->nav.pclk=NULL; prod->nav.nc=prod->nav.ncmax=0;
+    freepephp(&prod->nav,0x03);
+    freepephc(&prod->nav);
+}
+/* post-processing positioning with context ------------------------------------
+* post-processing positioning with context
+* args   : postpos_t *pp    IO  post-processing context (see postposnew())
+*          others               same as postpos()
 * return : status (0:ok,0>:error,1:aborted)
-* notes  : input files should contain observation data, navigation data, precise
-*          ephemeris/clock (optional), sbas log file (optional), ssr message
-*          log file (optional) and tec grid file (optional). only the first
-*          observation data file in the input files is recognized as the rover
-*          data.
-*
-*          the type of an input file is recognized by the file extension as ]
-*          follows:
-*              .sp3,.SP3,.eph*,.EPH*: precise ephemeris (sp3c)
-*              .sbs,.SBS,.ems,.EMS  : sbas message log files (rtklib or ems)
-*              .rtcm3,.RTCM3        : ssr message log files (rtcm3)
-*              .*i,.*I              : tec grid files (ionex)
-*              others               : rinex obs, nav, gnav, hnav, qnav or clock
-*
-*          inputs files can include wild-cards (*). if an file includes
-*          wild-cards, the wild-card expanded multiple files are used.
-*
-*          inputs files can include keywords. if an file includes keywords,
-*          the keywords are replaced by date, time, rover id and base station
-*          id and multiple session analyses run. refer reppath() for the
-*          keywords.
-*
-*          the output file can also include keywords. if the output file does
-*          not include keywords. the results of all multiple session analyses
-*          are output to a single output file.
-*
-*          ssr corrections are valid only for forward estimation.
 *-----------------------------------------------------------------------------*/
-int postpos(gtime_t ts, gtime_t te, double ti, double tu,
-                   const prcopt_t *popt, const solopt_t *sopt,
-                   const filopt_t *fopt, const char **infile, int n, const char *outfile,
-                   const char *rov, const char *base)
+int postposc(postpos_t *pp, gtime_t ts, gtime_t te, double ti, double tu,
+             const prcopt_t *popt, const solopt_t *sopt,
+             const filopt_t *fopt, const char **infile, int n,
+             const char *outfile, const char *rov, const char *base)
 {
     gtime_t tts,tte,ttte;
     double tunit,tss;
@@ -1448,23 +1946,25 @@ int postpos(gtime_t ts, gtime_t te, double ti, double tu,
     char *ifile[MAXINFILE],ofile[1024];
     const char *ext;
 
-    trace(3,"postpos : ti=%.0f tu=%.0f n=%d outfile=%s\n",ti,tu,n,outfile);
+    trace(3,"postposc: ti=%.0f tu=%.0f n=%d outfile=%s\n",ti,tu,n,outfile);
+
+    pp->nep=0;
 
     init_code2idx(popt->sigdef);
 
     /* open processing session */
-    if (!openses(popt,sopt,fopt,&navs,&satsvns,&pcvss,&pcvsr)) return -1;
+    if (!openses(pp,sopt,fopt)) return -1;
 
     if (ts.time!=0&&te.time!=0&&tu>=0.0) {
         if (timediff(te,ts)<0.0) {
             showmsg("error : no period");
-            closeses(&navs,&satsvns,&pcvss,&pcvsr);
+            closeses(pp);
             return 0;
         }
         for (i=0;i<MAXINFILE;i++) {
             if (!(ifile[i]=(char *)malloc(1024))) {
                 for (;i>=0;i--) free(ifile[i]);
-                closeses(&navs,&satsvns,&pcvss,&pcvsr);
+                closeses(pp);
                 return -1;
             }
         }
@@ -1480,10 +1980,10 @@ int postpos(gtime_t ts, gtime_t te, double ti, double tu,
             if (timediff(tts,ts)<0.0) tts=ts;
             if (timediff(tte,te)>0.0) tte=te;
 
-            strcpy(proc_rov ,"");
-            strcpy(proc_base,"");
+            strcpy(pp->proc_rov ,"");
+            strcpy(pp->proc_base,"");
             char tstr[40];
-            if (checkbrk("reading    : %s",time2str(tts,tstr,0))) {
+            if (checkbrk(pp,"reading    : %s",time2str(tts,tstr,0))) {
                 stat=1;
                 break;
             }
@@ -1516,7 +2016,7 @@ int postpos(gtime_t ts, gtime_t te, double ti, double tu,
             if (!reppath(outfile,ofile,tts,"","")&&i>0) flag=0;
 
             /* execute processing session */
-            stat=execses_b(tts,tte,ti,popt,sopt,fopt,flag,(const char **)ifile,index,nf,(const char *)ofile,
+            stat=execses_b(pp,tts,tte,ti,popt,sopt,fopt,flag,(const char **)ifile,index,nf,(const char *)ofile,
                            rov,base);
 
             if (stat==1) break;
@@ -1535,7 +2035,7 @@ int postpos(gtime_t ts, gtime_t te, double ti, double tu,
         reppath(outfile,ofile,ts,"","");
 
         /* execute processing session */
-        stat=execses_b(ts,te,ti,popt,sopt,fopt,1,(const char **)ifile,index,n,ofile,rov,
+        stat=execses_b(pp,ts,te,ti,popt,sopt,fopt,1,(const char **)ifile,index,n,ofile,rov,
                        base);
 
         for (i=0;i<n&&i<MAXINFILE;i++) free(ifile[i]);
@@ -1544,11 +2044,73 @@ int postpos(gtime_t ts, gtime_t te, double ti, double tu,
         for (i=0;i<n;i++) index[i]=i;
 
         /* execute processing session */
-        stat=execses_b(ts,te,ti,popt,sopt,fopt,1,infile,index,n,outfile,rov,
+        stat=execses_b(pp,ts,te,ti,popt,sopt,fopt,1,infile,index,n,outfile,rov,
                        base);
     }
     /* close processing session */
-    closeses(&navs,&satsvns,&pcvss,&pcvsr);
+    closeses(pp);
+
+    return stat;
+}
+/* post-processing positioning -------------------------------------------------
+* post-processing positioning
+* args   : gtime_t ts       I   processing start time (ts.time==0: no limit)
+*        : gtime_t te       I   processing end time   (te.time==0: no limit)
+*          double ti        I   processing interval  (s) (0:all)
+*          double tu        I   processing unit time (s) (0:all)
+*          prcopt_t *popt   I   processing options
+*          solopt_t *sopt   I   solution options
+*          filopt_t *fopt   I   file options
+*          char   **infile  I   input files (see below)
+*          int    n         I   number of input files
+*          char   *outfile  I   output file ("":stdout, see below)
+*          char   *rov      I   rover id list        (separated by " ")
+*          char   *base     I   base station id list (separated by " ")
+* return : status (0:ok,0>:error,1:aborted)
+* notes  : input files should contain observation data, navigation data, precise
+*          ephemeris/clock (optional), sbas log file (optional), ssr message
+*          log file (optional) and tec grid file (optional). only the first
+*          observation data file in the input files is recognized as the rover
+*          data.
+*
+*          the type of an input file is recognized by the file extension as ]
+*          follows:
+*              .sp3,.SP3,.eph*,.EPH*: precise ephemeris (sp3c)
+*              .sbs,.SBS,.ems,.EMS  : sbas message log files (rtklib or ems)
+*              .rtcm3,.RTCM3        : ssr message log files (rtcm3)
+*              .*i,.*I              : tec grid files (ionex)
+*              others               : rinex obs, nav, gnav, hnav, qnav or clock
+*
+*          inputs files can include wild-cards (*). if an file includes
+*          wild-cards, the wild-card expanded multiple files are used.
+*
+*          inputs files can include keywords. if an file includes keywords,
+*          the keywords are replaced by date, time, rover id and base station
+*          id and multiple session analyses run. refer reppath() for the
+*          keywords.
+*
+*          the output file can also include keywords. if the output file does
+*          not include keywords. the results of all multiple session analyses
+*          are output to a single output file.
+*
+*          ssr corrections are valid only for forward estimation.
+*-----------------------------------------------------------------------------*/
+int postpos(gtime_t ts, gtime_t te, double ti, double tu,
+                   const prcopt_t *popt, const solopt_t *sopt,
+                   const filopt_t *fopt, const char **infile, int n, const char *outfile,
+                   const char *rov, const char *base)
+{
+    postpos_t *pp;
+    int stat;
+
+    trace(3,"postpos : ti=%.0f tu=%.0f n=%d outfile=%s\n",ti,tu,n,outfile);
+
+    if (!(pp=postposnew(NULL))) {
+        showmsg("error : memory allocation");
+        return -1;
+    }
+    stat=postposc(pp,ts,te,ti,tu,popt,sopt,fopt,infile,n,outfile,rov,base);
 
+    postposfree(pp);
     return stat;
 }
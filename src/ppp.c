@@ -111,11 +111,18 @@
 #define NR(opt)     (NP(opt)+NC(opt)+NT(opt)+NI(opt)+ND(opt))
 #define NB(opt)     (NF(opt)*MAXSAT)
 #define NX(opt)     (NR(opt)+NB(opt))
-#define IC(s,opt)   (NP(opt)+(s))
-#define IT(opt)     (NP(opt)+NC(opt))
-#define II(s,opt)   (NP(opt)+NC(opt)+NT(opt)+(s)-1)
-#define ID(opt)     (NP(opt)+NC(opt)+NT(opt)+NI(opt))
-#define IB(s,f,opt) (NR(opt)+MAXSAT*(f)+(s)-1)
+/* state key */
+#define KC(s,opt)   (NP(opt)+(s))
+#define KT(opt)     (NP(opt)+NC(opt))
+#define KI(s,opt)   (NP(opt)+NC(opt)+NT(opt)+(s)-1)
+#define KD(opt)     (NP(opt)+NC(opt)+NT(opt)+NI(opt))
+#define KB(s,f,opt) (NR(opt)+MAXSAT*(f)+(s)-1)
+/* state variable index (-1: state not allocated) */
+#define IC(s,rtk)   ((rtk)->kx[KC(s,&(rtk)->opt)])
+#define IT(rtk)     ((rtk)->kx[KT(&(rtk)->opt)])
+#define II(s,rtk)   ((rtk)->kx[KI(s,&(rtk)->opt)])
+#define ID(rtk)     ((rtk)->kx[KD(&(rtk)->opt)])
+#define IB(s,f,rtk) ((rtk)->kx[KB(s,f,&(rtk)->opt)])
 
 /* standard deviation of state -----------------------------------------------*/
 static double STD(rtk_t *rtk, int i)
@@ -153,7 +160,7 @@ int pppoutstat(rtk_t *rtk, char *buff, int level)
                    vel[2],acc[0],acc[1],acc[2],0.0,0.0,0.0,0.0,0.0,0.0);
     }
     /* receiver clocks */
-    i=IC(0,&rtk->opt);
+    i=IC(0,rtk);
     p+=sprintf(p,"$CLK,%d,%.3f,%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n",
                week,tow,rtk->sol.stat,1,x[i]*1E9/CLIGHT,x[i+1]*1E9/CLIGHT,
                x[i+2]*1E9/CLIGHT,x[i+3]*1E9/CLIGHT,STD(rtk,i)*1E9/CLIGHT,
@@ -162,12 +169,12 @@ int pppoutstat(rtk_t *rtk, char *buff, int level)
 
     /* tropospheric parameters */
     if (rtk->opt.tropopt==TROPOPT_EST||rtk->opt.tropopt==TROPOPT_ESTG) {
-        i=IT(&rtk->opt);
+        i=IT(rtk);
         p+=sprintf(p,"$TROP,%d,%.3f,%d,%d,%.4f,%.4f\n",week,tow,rtk->sol.stat,
                    1,x[i],STD(rtk,i));
     }
     if (rtk->opt.tropopt==TROPOPT_ESTG) {
-        i=IT(&rtk->opt);
+        i=IT(rtk);
         p+=sprintf(p,"$TRPG,%d,%.3f,%d,%d,%.5f,%.5f,%.5f,%.5f\n",week,tow,
                    rtk->sol.stat,1,x[i+1],x[i+2],STD(rtk,i+1),STD(rtk,i+2));
     }
@@ -176,8 +183,8 @@ int pppoutstat(rtk_t *rtk, char *buff, int level)
         for (i=0;i<MAXSAT;i++) {
             ssat=rtk->ssat+i;
             if (!ssat->vs) continue;
-            j=II(i+1,&rtk->opt);
-            if (rtk->x[j]==0.0) continue;
+            j=II(i+1,rtk);
+            if (j<0||rtk->x[j]==0.0) continue;
             satno2id(i+1,id);
             p+=sprintf(p,"$ION,%d,%.3f,%d,%s,%.1f,%.1f,%.4f,%.4f\n",week,tow,
                        rtk->sol.stat,id,rtk->ssat[i].azel[0][0]*R2D,
@@ -192,13 +199,13 @@ int pppoutstat(rtk_t *rtk, char *buff, int level)
         if (!ssat->vs) continue;
         satno2id(i+1,id);
         for (int j=0;j<NF(&rtk->opt);j++) {
-            int k=IB(i+1,j,&rtk->opt);
+            int k=IB(i+1,j,rtk);
             p+=sprintf(p,"$SAT,%d,%.3f,%s,%d,%.1f,%.1f,%.4f,%.4f,%d,%.2f,%d,%d,%d,%u,%u,%u,%.2f,%.6f,%.5f\n",
                        week,tow,id,j+1,ssat->azel[0][0]*R2D,ssat->azel[0][1]*R2D,
                        ssat->resp[j],ssat->resc[j],ssat->vsat[j],ssat->snr_rover[j],
                        ssat->fix[j],ssat->slip[j]&(LLI_SLIP|LLI_HALFC),ssat->lock[j],ssat->outc[j],
-                       ssat->slipc[j],ssat->rejc[j],k<rtk->nx?rtk->x[k]:0,
-                       k<rtk->nx?rtk->P[k+k*rtk->nx]:0,ssat->icbias[j]);
+                       ssat->slipc[j],ssat->rejc[j],k>=0?rtk->x[k]:0,
+                       k>=0?rtk->P[k+k*rtk->nx]:0,ssat->icbias[j]);
         }
     }
     return (int)(p-buff);
@@ -453,6 +460,16 @@ static inline void initx(rtk_t *rtk, double xi, double var, int i)
     for (j=0;j<rtk->nx;j++) rtk->P[j+i*rtk->nx]=0.0;
     rtk->P[i+i*rtk->nx]=var;
 }
+/* allocate and initialize state of state key --------------------------------*/
+static void initxk(rtk_t *rtk, double xi, double var, int k)
+{
+    initx(rtk,xi,var,rtkxalloc(rtk,k));
+}
+/* state value (0: state not allocated) --------------------------------------*/
+static inline double xval(const rtk_t *rtk, int i)
+{
+    return i<0?0.0:rtk->x[i];
+}
 /* geometry-free phase measurement -------------------------------------------*/
 static double gfmeas(const obsd_t *obs, const nav_t *nav, int f2)
 {
@@ -704,14 +721,14 @@ static void udclk_ppp(rtk_t *rtk)
         else {
             dtr=i==0?rtk->sol.dtr[0]:rtk->sol.dtr[0]+rtk->sol.dtr[i];
         }
-        initx(rtk,CLIGHT*dtr,VAR_CLK,IC(i,&rtk->opt));
+        initx(rtk,CLIGHT*dtr,VAR_CLK,IC(i,rtk));
     }
 }
 /* temporal update of tropospheric parameters --------------------------------*/
 static void udtrop_ppp(rtk_t *rtk)
 {
     double pos[3],azel[]={0.0,PI/2.0},ztd,var;
-    int i=IT(&rtk->opt),j;
+    int i=IT(rtk),j;
 
     trace(3,"udtrop_ppp:\n");
 
@@ -748,22 +765,22 @@ static void udiono_ppp(rtk_t *rtk, const obsd_t *obs, int n, const nav_t *nav)
     }
     /* reset ionosphere delay estimate if outage too long */
     for (i=0;i<MAXSAT;i++) {
-        j=II(i+1,&rtk->opt);
-        if (rtk->x[j]!=0.0&&(int)rtk->ssat[i].outc[0]>gap_resion) {
+        j=II(i+1,rtk);
+        if (xval(rtk,j)!=0.0&&(int)rtk->ssat[i].outc[0]>gap_resion) {
             rtk->x[j]=0.0;
         }
     }
     /* reset ionosphere states if VTEC corrections just became available */
     if (rtk->vtec_used==0&&nav->vtec.nlay>0) {
         for (i=0;i<MAXSAT;i++) {
-            rtk->x[II(i+1,&rtk->opt)]=0.0;
+            if ((j=II(i+1,rtk))>=0) rtk->x[j]=0.0;
         }
         rtk->vtec_used=1;  // indicate that vtec coeffs have been used
     }
     for (i=0;i<n;i++) {
         sat=obs[i].sat;
-        j=II(sat,&rtk->opt);
-        if (rtk->x[j]==0.0&&(int)rtk->ssat[i].outc[0]<=gap_resion) {
+        j=II(sat,rtk);
+        if (xval(rtk,j)==0.0&&(int)rtk->ssat[i].outc[0]<=gap_resion) {
             /* initialize ionosphere delay estimates if zero */
             ecef2pos(rtk->sol.rr,pos);
             azel=rtk->ssat[sat-1].azel[0];
@@ -799,10 +816,10 @@ static void udiono_ppp(rtk_t *rtk, const obsd_t *obs, int n, const nav_t *nav)
             }
             /* adjust delay estimate by path length */
             ion/=ionmapf(pos,azel,ME_WGS84/1000,HION,1);
-            initx(rtk,ion,var,j);
+            initxk(rtk,ion,var,KI(sat,&rtk->opt));
             trace(3,"ion init: sat=%d ion=%.4f var=%.1f\n",sat,ion,var);
         }
-        else { /* temporal update */
+        else if (j>=0) { /* temporal update */
             sinel=sin(MAX(rtk->ssat[sat-1].azel[0][1],5.0*D2R));
             /* update variance of delay state */
             rtk->P[j+j*rtk->nx]+=SQR(rtk->opt.prn[1]/sinel)*fabs(rtk->tt);
@@ -812,7 +829,7 @@ static void udiono_ppp(rtk_t *rtk, const obsd_t *obs, int n, const nav_t *nav)
 /* temporal update of L5-receiver-dcb parameters -----------------------------*/
 static void uddcb_ppp(rtk_t *rtk)
 {
-    int i=ID(&rtk->opt);
+    int i=ID(rtk);
 
     trace(3,"uddcb_ppp:\n");
 
@@ -851,12 +868,12 @@ static void udbias_ppp(rtk_t *rtk, const obsd_t *obs, int n, const nav_t *nav)
         for (i=0;i<MAXSAT;i++) {
             if (++rtk->ssat[i].outc[f]>(uint32_t)rtk->opt.maxout||
                 rtk->opt.modear==ARMODE_INST||clk_jump) {
-                initx(rtk,0.0,0.0,IB(i+1,f,&rtk->opt));
+                if ((j=IB(i+1,f,rtk))>=0) initx(rtk,0.0,0.0,j);
             }
         }
         for (i=k=0;i<n&&i<MAXOBS;i++) {
             sat=obs[i].sat;
-            j=IB(sat,f,&rtk->opt);
+            j=IB(sat,f,rtk);
             corr_meas(obs+i,nav,rtk->ssat[sat-1].azel[0],&rtk->opt,0,0,0.0,
                       0.0,L,P,&Lc,&Pc);
 
@@ -877,7 +894,7 @@ static void udbias_ppp(rtk_t *rtk, const obsd_t *obs, int n, const nav_t *nav)
                     ion=(obs[i].P[0]-obs[i].P[f])/(1.0-SQR(freq1/freq2));
                 bias[i]=L[f]-P[f]+2.0*ion*SQR(freq1/freq2);
             }
-            if (rtk->x[j]==0.0||slip[i]||bias[i]==0.0) continue;
+            if (xval(rtk,j)==0.0||slip[i]||bias[i]==0.0) continue;
 
             offset+=bias[i]-rtk->x[j];
             k++;
@@ -885,8 +902,8 @@ static void udbias_ppp(rtk_t *rtk, const obsd_t *obs, int n, const nav_t *nav)
         /* correct phase-code jump to ensure phase-code coherence */
         if (k>=2&&fabs(offset/k)>0.0005*CLIGHT) {
             for (i=0;i<MAXSAT;i++) {
-                j=IB(i+1,f,&rtk->opt);
-                if (rtk->x[j]!=0.0) rtk->x[j]+=offset/k;
+                j=IB(i+1,f,rtk);
+                if (xval(rtk,j)!=0.0) rtk->x[j]+=offset/k;
             }
             char tstr[40];
             trace(2,"phase-code jump corrected: %s n=%2d dt=%12.9fs\n",
@@ -894,14 +911,14 @@ static void udbias_ppp(rtk_t *rtk, const obsd_t *obs, int n, const nav_t *nav)
         }
         for (i=0;i<n&&i<MAXOBS;i++) {
             sat=obs[i].sat;
-            j=IB(sat,f,&rtk->opt);
+            j=IB(sat,f,rtk);
 
-            rtk->P[j+j*rtk->nx]+=SQR(rtk->opt.prn[0])*fabs(rtk->tt);
+            if (j>=0) rtk->P[j+j*rtk->nx]+=SQR(rtk->opt.prn[0])*fabs(rtk->tt);
 
-            if (bias[i]==0.0||(rtk->x[j]!=0.0&&!slip[i])) continue;
+            if (bias[i]==0.0||(xval(rtk,j)!=0.0&&!slip[i])) continue;
 
             /* reinitialize phase-bias if detecting cycle slip */
-            initx(rtk,bias[i],VAR_BIAS,IB(sat,f,&rtk->opt));
+            initxk(rtk,bias[i],VAR_BIAS,KB(sat,f,&rtk->opt));
             trace(3,"init bias: sat=%d frq=%d\n", sat,f);
 
             /* reset fix flags */
@@ -936,6 +953,14 @@ static void udstate_ppp(rtk_t *rtk, const obsd_t *obs, int n, const nav_t *nav)
     }
     /* temporal update of phase-bias */
     udbias_ppp(rtk,obs,n,nav);
+
+    /* release the ionosphere and phase-bias states reset to zero */
+    if (!strstr(rtk->opt.pppopt,"-LEGACY_STATE")) {
+        for (int i=rtk->nx-1;i>=0;i--) {
+            if (rtk->x[i]!=0.0||pppxinit(&rtk->opt,rtk->xk[i])) continue;
+            rtkxfree(rtk,rtk->xk[i]);
+        }
+    }
 }
 /* Satellite antenna phase center variation setup ----------------------------*/
 static int satantpcv(const double *rs, const double *rr, double *nadir) {
@@ -985,9 +1010,10 @@ static double trop_model_prec(gtime_t time, const double *pos,
 }
 /* tropospheric model ---------------------------------------------------------*/
 static int model_trop(gtime_t time, const double *pos, const double *azel,
-                      const prcopt_t *opt, const double *x, double *dtdx,
+                      const rtk_t *rtk, const double *x, double *dtdx,
                       const nav_t *nav, double *dtrp, double *var)
 {
+    const prcopt_t *opt=&rtk->opt;
     (void)nav;
     double trp[3]={0};
 
@@ -1001,7 +1027,7 @@ static int model_trop(gtime_t time, const double *pos, const double *azel,
         return 1;
     }
     if (opt->tropopt==TROPOPT_EST||opt->tropopt==TROPOPT_ESTG) {
-        matcpy(trp,x+IT(opt),opt->tropopt==TROPOPT_EST?1:3,1);
+        matcpy(trp,x+IT(rtk),opt->tropopt==TROPOPT_EST?1:3,1);
         *dtrp=trop_model_prec(time,pos,azel,trp,dtdx,var);
         return 1;
     }
@@ -1009,9 +1035,11 @@ static int model_trop(gtime_t time, const double *pos, const double *azel,
 }
 /* ionospheric model ---------------------------------------------------------*/
 static int model_iono(gtime_t time, const double *pos, const double *azel,
-                      const prcopt_t *opt, int sat, const double *x,
+                      const rtk_t *rtk, int sat, const double *x,
                       const nav_t *nav, double *dion, double *var)
 {
+    const prcopt_t *opt=&rtk->opt;
+
     if (opt->ionoopt==IONOOPT_SBAS) {
         return sbsioncorr(time,nav,pos,azel,dion,var);
     }
@@ -1025,7 +1053,8 @@ static int model_iono(gtime_t time, const double *pos, const double *azel,
     }
     if (opt->ionoopt==IONOOPT_EST) {
         /* Estimated delay is a vertical delay, apply the mapping function. */
-        *dion=x[II(sat,opt)]*ionmapf(pos,azel,ME_WGS84/1000,HION,1);
+        int i=II(sat,rtk);
+        *dion=i<0?0.0:x[i]*ionmapf(pos,azel,ME_WGS84/1000,HION,1);
         *var=0.0;
         return 1;
     }
@@ -1081,8 +1110,8 @@ static int ppp_res(int post, const obsd_t *obs, int n, const double *rs,
             continue;
         }
         /* Tropospheric and ionospheric model */
-        if (!model_trop(obs[i].time,pos,azel+i*2,opt,x,dtdx,nav,&dtrp,&vart)||
-            !model_iono(obs[i].time,pos,azel+i*2,opt,sat,x,nav,&dion,&vari)) {
+        if (!model_trop(obs[i].time,pos,azel+i*2,rtk,x,dtdx,nav,&dtrp,&vart)||
+            !model_iono(obs[i].time,pos,azel+i*2,rtk,sat,x,nav,&dion,&vari)) {
             continue;
         }
         /* Satellite and receiver antenna model */
@@ -1133,30 +1162,31 @@ static int ppp_res(int post, const obsd_t *obs, int n, const double *rs,
                 case SYS_IRN: k=5; break;
                 default:      k=0; break;
             }
-            cdtr=x[IC(k,opt)];
+            cdtr=x[IC(k,rtk)];
             if (Hc && xi) {
-                cvwrite(Hi,nc,xi,IC(k,opt),1.0);
+                cvwrite(Hi,nc,xi,IC(k,rtk),1.0);
 
                 if (opt->tropopt==TROPOPT_EST||opt->tropopt==TROPOPT_ESTG) {
                     for (k=0;k<(opt->tropopt>=TROPOPT_ESTG?3:1);k++) {
-                        cvwrite(Hi,nc,xi,IT(opt)+k,dtdx[k]);
+                        cvwrite(Hi,nc,xi,IT(rtk)+k,dtdx[k]);
                     }
                 }
             }
             if (opt->ionoopt==IONOOPT_EST) {
-                if (rtk->x[II(sat,opt)]==0.0) continue;
+                if (xval(rtk,II(sat,rtk))==0.0) continue;
                 /* The vertical iono delay is estimated, but the residual is
                  * in the direction of the slant, so apply the slant factor
                  * mapping function. */
-                if (Hc && xi) cvwrite(Hi,nc,xi,II(sat,opt),C*ionmapf(pos,azel+i*2,ME_WGS84/1000,HION,1));
+                if (Hc && xi) cvwrite(Hi,nc,xi,II(sat,rtk),C*ionmapf(pos,azel+i*2,ME_WGS84/1000,HION,1));
             }
             if (frq==2&&code==1) { /* L5-receiver-dcb */
-                dcb+=rtk->x[ID(opt)];
-                if (Hc && xi) cvwrite(Hi,nc,xi,ID(opt),1.0);
+                dcb+=rtk->x[ID(rtk)];
+                if (Hc && xi) cvwrite(Hi,nc,xi,ID(rtk),1.0);
             }
             if (code==0) { /* Phase bias */
-                if ((bias=x[IB(sat,frq,opt)])==0.0) continue;
-                if (Hc && xi) cvwrite(Hi,nc,xi,IB(sat,frq,opt),1.0);
+                int ib=IB(sat,frq,rtk);
+                if (ib<0||(bias=x[ib])==0.0) continue;
+                if (Hc && xi) cvwrite(Hi,nc,xi,ib,1.0);
             }
             /* Residual */
             double res=y-(r+cdtr-CLIGHT*dts[i*2]+dtrp+C*dion+dcb+bias);
@@ -1215,6 +1245,19 @@ int pppnx(const prcopt_t *opt)
 {
     return NX(opt);
 }
+/* test state allocated at initialization --------------------------------------
+* args   : prcopt_t *opt    I   processing options
+*          int      k       I   state key (0 to pppnx(opt)-1)
+* return : 1: allocated at initialization, 0: allocated on demand
+* notes  : the ionosphere and phase-bias states are allocated as satellites are
+*          tracked and released when reset, unless opt->pppopt has
+*          -LEGACY_STATE to keep all the states allocated.
+*-----------------------------------------------------------------------------*/
+int pppxinit(const prcopt_t *opt, int k)
+{
+    if (strstr(opt->pppopt,"-LEGACY_STATE")) return 1;
+    return k<KI(1,opt)||(k>=KD(opt)&&k<NR(opt));
+}
 /* update solution status ----------------------------------------------------*/
 static void update_stat(rtk_t *rtk, const obsd_t *obs, int n, int stat)
 {
@@ -1261,11 +1304,11 @@ static void update_stat(rtk_t *rtk, const obsd_t *obs, int n, int stat)
             rtk->sol.qv[5]=(float)rtk->P[5+3*rtk->nx];
         }
     }
-    rtk->sol.dtr[0]=rtk->x[IC(0,opt)]/CLIGHT; /* GPS */
-    rtk->sol.dtr[1]=(rtk->x[IC(1,opt)]-rtk->x[IC(0,opt)])/CLIGHT; /* GLO-GPS */
-    rtk->sol.dtr[2]=(rtk->x[IC(2,opt)]-rtk->x[IC(0,opt)])/CLIGHT; /* GAL-GPS */
-    rtk->sol.dtr[3]=(rtk->x[IC(3,opt)]-rtk->x[IC(0,opt)])/CLIGHT; /* BDS2-GPS */
-    rtk->sol.dtr[4]=(rtk->x[IC(4,opt)]-rtk->x[IC(0,opt)])/CLIGHT; /* BDS3-GPS */
+    rtk->sol.dtr[0]=rtk->x[IC(0,rtk)]/CLIGHT; /* GPS */
+    rtk->sol.dtr[1]=(rtk->x[IC(1,rtk)]-rtk->x[IC(0,rtk)])/CLIGHT; /* GLO-GPS */
+    rtk->sol.dtr[2]=(rtk->x[IC(2,rtk)]-rtk->x[IC(0,rtk)])/CLIGHT; /* GAL-GPS */
+    rtk->sol.dtr[3]=(rtk->x[IC(3,rtk)]-rtk->x[IC(0,rtk)])/CLIGHT; /* BDS2-GPS */
+    rtk->sol.dtr[4]=(rtk->x[IC(4,rtk)]-rtk->x[IC(0,rtk)])/CLIGHT; /* BDS3-GPS */
 
     for (i=0;i<n&&i<MAXOBS;i++) for (j=0;j<opt->nf;j++) {
         rtk->ssat[obs[i].sat-1].snr_rover[j]=obs[i].SNR[j];
@@ -1307,10 +1350,10 @@ void pppos(rtk_t *rtk, const obsd_t *obs, int n, const nav_t *nav)
     double *rs,*dts,*var,*v,*R,*azel,*xp,dr[3]={0},std[3];
     char str[40];
     int nv,svh[MAXOBS],exc[MAXOBS]={0},stat=SOLQ_SINGLE;
-    int nx=rtk->nx,nc;
+    int nx,nc;
 
     time2str(obs[0].time,str,2);
-    trace(3,"pppos   : time=%s nx=%d n=%d\n",str,nx,n);
+    trace(3,"pppos   : time=%s nx=%d n=%d\n",str,rtk->nx,n);
 
     rs=mat(6,n); dts=mat(2,n); var=mat(1,n); azel=zeros(2,n);
 
@@ -1323,6 +1366,9 @@ void pppos(rtk_t *rtk, const obsd_t *obs, int n, const nav_t *nav)
     /* Temporal update of ekf states */
     udstate_ppp(rtk,obs,n,nav);
 
+    /* States are not allocated or released after the temporal update */
+    nx=rtk->nx;
+
     /* Satellite positions and clocks */
     satposs(obs[0].time,obs,n,nav,&rtk->opt,rs,dts,var,svh);
 
@@ -58,46 +58,47 @@
 #define EXTERR_CLK  0.4E-3          /* extrapolation error for clock (m/s) */
 #define EXTERR_EPH  5E-7            /* extrapolation error for ephem (m/s^2) */
 #define MAX_BIAS_SYS 6              /* # of constellations supported */
+#define NCHEB       12              /* number of Chebyshev coefficients */
+#define TSEGCHEB    3600.0          /* max length of Chebyshev segments (s) */
+#define NCHKCHEB    8               /* number of fit checks per segment */
 
-/* table to translate code to code bias table index  */
-static int8_t code_bias_ix[MAX_BIAS_SYS][MAXCODE];
-/* initialize code bias lookup table -------------------------------------------
+/* code to code bias table index -----------------------------------------------
 *       -1 = code not supported
 *        0 = reference code (0 bias)
 *        1-3 = table index for code
-* ----------------------------------------------------------------------------*/
-static void init_bias_ix(void) {
-    int i,j;
-
-    for (i=0;i<MAX_BIAS_SYS;i++) for (j=0;j<MAXCODE;j++)
-        code_bias_ix[i][j]=-1;
-
-    /* GPS */
-    code_bias_ix[0][CODE_L1W]=0;
-    code_bias_ix[0][CODE_L1C]=1;
-    code_bias_ix[0][CODE_L1L]=2;
-    code_bias_ix[0][CODE_L1X]=3;
-    code_bias_ix[0][CODE_L2W]=0;
-    code_bias_ix[0][CODE_L2L]=1;
-    code_bias_ix[0][CODE_L2S]=2;
-    code_bias_ix[0][CODE_L2X]=3;
-    /* GLONASS */
-    code_bias_ix[1][CODE_L1P]=0;
-    code_bias_ix[1][CODE_L1C]=1;
-    code_bias_ix[1][CODE_L2P]=0;
-    code_bias_ix[1][CODE_L2C]=1;
-    /* Galileo */
-    code_bias_ix[2][CODE_L1C]=0;
-    code_bias_ix[2][CODE_L1X]=1;
-    code_bias_ix[2][CODE_L5Q]=0;
-    code_bias_ix[2][CODE_L5I]=1;
-    code_bias_ix[2][CODE_L5X]=2;
-    code_bias_ix[2][CODE_L7Q]=0;
-    code_bias_ix[2][CODE_L7I]=1;
-    code_bias_ix[2][CODE_L7X]=2;
-    /* Beidou */
-    code_bias_ix[3][CODE_L2I]=0;
-    code_bias_ix[3][CODE_L6I]=0;
+* notes : no table state, so readdcb() and code2bias() are thread-safe
+*-----------------------------------------------------------------------------*/
+static int code_bias_ix(int sys_ix, int code)
+{
+    switch (sys_ix) {
+        case 0: /* GPS */
+            switch (code) {
+                case CODE_L1W: case CODE_L2W: return 0;
+                case CODE_L1C: case CODE_L2L: return 1;
+                case CODE_L1L: case CODE_L2S: return 2;
+                case CODE_L1X: case CODE_L2X: return 3;
+            }
+            break;
+        case 1: /* GLONASS */
+            switch (code) {
+                case CODE_L1P: case CODE_L2P: return 0;
+                case CODE_L1C: case CODE_L2C: return 1;
+            }
+            break;
+        case 2: /* Galileo */
+            switch (code) {
+                case CODE_L1C: case CODE_L5Q: case CODE_L7Q: return 0;
+                case CODE_L1X: case CODE_L5I: case CODE_L7I: return 1;
+                case CODE_L5X: case CODE_L7X: return 2;
+            }
+            break;
+        case 3: /* Beidou */
+            switch (code) {
+                case CODE_L2I: case CODE_L6I: return 0;
+            }
+            break;
+    }
+    return -1;
 }
 
 /* satellite code to satellite system ----------------------------------------*/
@@ -295,6 +296,194 @@ static void combpeph(nav_t *nav, int opt)
 
     trace(4,"combpeph: ne=%d\n",nav->ne);
 }
+/* free packed precise ephemeris/clock --------------------------------------*/
+static void freepack(pephp_t *p)
+{
+    int i;
+
+    free(p->time); p->time=NULL;
+    for (i=0;i<MAXSAT;i++) {
+        free(p->ie [i]); p->ie [i]=NULL;
+        free(p->val[i]); p->val[i]=NULL;
+        free(p->std[i]); p->std[i]=NULL;
+        p->nd[i]=0;
+    }
+    p->n=0;
+}
+/* precise ephemeris/clock record time ---------------------------------------*/
+static gtime_t rectime(const nav_t *nav, int eph, int i)
+{
+    return eph?nav->peph[i].time:nav->pclk[i].time;
+}
+/* precise ephemeris/clock record of satellite (0:no data) -------------------*/
+static int getrec(const nav_t *nav, int eph, int i, int sat, double *val,
+                  float *std)
+{
+    int j;
+
+    if (eph) {
+        const double *pos=nav->peph[i].pos[sat-1];
+        if (pos[0]==0.0&&pos[1]==0.0&&pos[2]==0.0&&pos[3]==0.0) return 0;
+        for (j=0;j<4;j++) {
+            val[j]=pos[j];
+            std[j]=nav->peph[i].std[sat-1][j];
+        }
+    }
+    else {
+        if (nav->pclk[i].clk[sat-1][0]==0.0) return 0;
+        val[0]=nav->pclk[i].clk[sat-1][0];
+        std[0]=nav->pclk[i].std[sat-1][0];
+    }
+    return 1;
+}
+/* pack precise ephemeris/clock records --------------------------------------
+* pack the records to the packed store. the data already packed are merged
+* if the records were dropped after packing. the records override the packed
+* data of the same epoch and satellite as combpeph() and combpclk().
+*-----------------------------------------------------------------------------*/
+static int packrec(nav_t *nav, int eph)
+{
+    pephp_t *p=eph?&nav->pephp:&nav->pclkp,q={0};
+    double dt,*val=NULL;
+    float *std=NULL;
+    int i,j,k,m,n,sat,nr=eph?nav->ne:nav->nc,nv=eph?4:1,*io,*ir,*ie=NULL;
+
+    trace(3,"packrec: eph=%d nr=%d n=%d drop=%d\n",eph,nr,p->n,p->drop);
+
+    if (!p->drop) freepack(p); /* records include all data */
+
+    n=p->n+nr;
+    io=(int *)malloc(sizeof(int)*(n+1));
+    ir=(int *)malloc(sizeof(int)*(n+1));
+    q.time=(gtime_t *)malloc(sizeof(gtime_t)*(n+1));
+    ie=(int *)malloc(sizeof(int)*(n+1));
+    val=(double *)malloc(sizeof(double)*nv*(n+1));
+    std=(float *)malloc(sizeof(float)*nv*(n+1));
+    if (!io||!ir||!q.time||!ie||!val||!std) {
+        trace(1,"packrec malloc error n=%d\n",n);
+        free(io); free(ir); free(q.time); free(ie); free(val); free(std);
+        return 0;
+    }
+    /* merge epochs of packed data and records */
+    for (i=j=n=0;i<p->n||j<nr;n++) {
+        if      (j>=nr  ) dt=-1.0;
+        else if (i>=p->n) dt= 1.0;
+        else dt=timediff(p->time[i],rectime(nav,eph,j));
+
+        if (fabs(dt)<1E-9) {io[n]=i++; ir[n]=j++;}
+        else if (dt<0.0)   {io[n]=i++; ir[n]=-1; }
+        else               {io[n]=-1;  ir[n]=j++;}
+        q.time[n]=io[n]>=0?p->time[io[n]]:rectime(nav,eph,ir[n]);
+    }
+    q.n=n;
+    q.nv=nv;
+    q.drop=p->drop;
+
+    for (sat=1;sat<=MAXSAT;sat++) {
+        for (k=m=j=0;k<n;k++) {
+            if (io[k]>=0) {
+                while (m<p->nd[sat-1]&&p->ie[sat-1][m]<io[k]) m++;
+            }
+            if (ir[k]>=0&&getrec(nav,eph,ir[k],sat,val+j*nv,std+j*nv)) {
+                ie[j++]=k;
+            }
+            else if (io[k]>=0&&m<p->nd[sat-1]&&p->ie[sat-1][m]==io[k]) {
+                for (i=0;i<nv;i++) {
+                    val[j*nv+i]=p->val[sat-1][m*nv+i];
+                    std[j*nv+i]=p->std[sat-1][m*nv+i];
+                }
+                ie[j++]=k;
+            }
+        }
+        if (j<=0) continue;
+
+        if (!(q.ie [sat-1]=(int    *)malloc(sizeof(int   )*j   ))||
+            !(q.val[sat-1]=(double *)malloc(sizeof(double)*j*nv))||
+            !(q.std[sat-1]=(float  *)malloc(sizeof(float )*j*nv))) {
+            trace(1,"packrec malloc error nd=%d\n",j);
+            freepack(&q);
+            free(io); free(ir); free(ie); free(val); free(std);
+            return 0;
+        }
+        memcpy(q.ie [sat-1],ie ,sizeof(int   )*j   );
+        memcpy(q.val[sat-1],val,sizeof(double)*j*nv);
+        memcpy(q.std[sat-1],std,sizeof(float )*j*nv);
+        q.nd[sat-1]=j;
+    }
+    free(io); free(ir); free(ie); free(val); free(std);
+
+    freepack(p);
+    *p=q;
+    trace(4,"packrec: n=%d\n",p->n);
+    return 1;
+}
+/* pack precise ephemeris/clock ------------------------------------------------
+* pack precise ephemeris and clock records (nav->peph and nav->pclk) to the
+* packed stores (nav->pephp and nav->pclkp) used by peph2pos() and pephclk()
+* args   : nav_t  *nav      IO  navigation data
+*          int    opt       I   option (0x01: pack ephemeris, 0x02: pack clock,
+*                               0x04: drop ephemeris records,
+*                               0x08: drop clock records)
+* return : status (1:ok,0:memory allocation error)
+* notes  : readsp3() and readrnxc() pack the records after reading. the packed
+*          store keeps only the satellites with data in each epoch, without the
+*          velocities and covariances of the records.
+*          dropping the records frees them after packing to save the memory
+*          and the records read afterwards are merged to the packed store.
+*          after modifying the records, call it to update the packed store.
+*-----------------------------------------------------------------------------*/
+int packpeph(nav_t *nav, int opt)
+{
+    int stat=1;
+
+    trace(3,"packpeph: opt=%d ne=%d nc=%d\n",opt,nav->ne,nav->nc);
+
+    if ((opt&0x01)&&!packrec(nav,1)) stat=0;
+    if ((opt&0x02)&&!packrec(nav,0)) stat=0;
+    if (opt&0x04) {
+        free(nav->peph); nav->peph=NULL; nav->ne=nav->nemax=0;
+        nav->pephp.drop=1;
+    }
+    if (opt&0x08) {
+        free(nav->pclk); nav->pclk=NULL; nav->nc=nav->ncmax=0;
+        nav->pclkp.drop=1;
+    }
+    return stat;
+}
+/* free packed precise ephemeris/clock -----------------------------------------
+* free packed precise ephemeris and clock
+* args   : nav_t  *nav      IO  navigation data
+*          int    opt       I   option (0x01: ephemeris, 0x02: clock)
+* return : none
+*-----------------------------------------------------------------------------*/
+void freepephp(nav_t *nav, int opt)
+{
+    if (opt&0x01) {freepack(&nav->pephp); nav->pephp.drop=0;}
+    if (opt&0x02) {freepack(&nav->pclkp); nav->pclkp.drop=0;}
+}
+/* memory of precise ephemeris/clock -------------------------------------------
+* memory allocated for precise ephemeris and clock
+* args   : nav_t  *nav      I   navigation data
+*          size_t *mrec     O   memory of records (bytes) (NULL: no output)
+* return : memory of packed stores (bytes)
+*-----------------------------------------------------------------------------*/
+size_t pephmem(const nav_t *nav, size_t *mrec)
+{
+    const pephp_t *p[2]={&nav->pephp,&nav->pclkp};
+    size_t mem=0;
+    int i,j;
+
+    for (i=0;i<2;i++) {
+        mem+=sizeof(gtime_t)*p[i]->n;
+        for (j=0;j<MAXSAT;j++) {
+            mem+=(sizeof(int)+(sizeof(double)+sizeof(float))*p[i]->nv)*p[i]->nd[j];
+        }
+    }
+    if (mrec) {
+        *mrec=sizeof(peph_t)*nav->nemax+sizeof(pclk_t)*nav->ncmax;
+    }
+    return mem;
+}
 /* read sp3 precise ephemeris file ---------------------------------------------
 * read sp3 precise ephemeris/clock files and set them to navigation data
 * args   : char   *file       I   sp3-c precise ephemeris file
@@ -308,11 +497,14 @@ static void combpeph(nav_t *nav, int opt)
 *          nav->peph and nav->ne must by properly initialized before calling the
 *          function
 *          only files with extensions of .sp3, .SP3, .eph* and .EPH* are read
+*          the files compressed (.gz,.Z,.zip) are uncompressed in memory
 *-----------------------------------------------------------------------------*/
 void readsp3(const char *file, nav_t *nav, int opt)
 {
     FILE *fp;
     gtime_t time={0};
+    uint8_t *buff;
+    size_t size;
     double bfact[2]={0};
     int i,j,n,ns,sats[MAXSAT]={0};
     char *efiles[MAXEXFILE],*ext,type=' ',tsys[4]="";
@@ -331,11 +523,24 @@ void readsp3(const char *file, nav_t *nav, int opt)
     for (i=j=0;i<n;i++) {
         if (!(ext=strrchr(efiles[i],'.'))) continue;
 
-        if (!strstr(ext,".sp3")&&!strstr(ext,".SP3")&&
-            !strstr(ext,".eph")&&!strstr(ext,".EPH")) continue;
+        /* extension before compression extension */
+        if (!strcmp(ext,".z"  )||!strcmp(ext,".Z"  )||
+            !strcmp(ext,".gz" )||!strcmp(ext,".GZ" )||
+            !strcmp(ext,".zip")||!strcmp(ext,".ZIP")) {
+            for (ext--;ext>efiles[i]&&*ext!='.';ext--) ;
+        }
+        if (strncmp(ext,".sp3",4)&&strncmp(ext,".SP3",4)&&
+            strncmp(ext,".eph",4)&&strncmp(ext,".EPH",4)) continue;
 
-        if (!(fp=fopen(efiles[i],"r"))) {
+        /* uncompress file in memory */
+        buff=NULL;
+        if (rtk_uncompbuf(efiles[i],&buff,&size)>0) {
+            fp=rtk_fmemopen(buff,size);
+        }
+        else fp=fopen(efiles[i],"r");
+        if (!fp) {
             trace(2,"sp3 file open error %s\n",efiles[i]);
+            free(buff);
             continue;
         }
         /* read sp3 header */
@@ -345,11 +550,15 @@ void readsp3(const char *file, nav_t *nav, int opt)
         readsp3b(fp,type,sats,ns,bfact,tsys,j++,opt,nav);
 
         fclose(fp);
+        free(buff);
     }
     for (i=0;i<MAXEXFILE;i++) free(efiles[i]);
 
-    /* combine precise ephemeris */
-    if (nav->ne>0) combpeph(nav,opt);
+    /* combine and pack precise ephemeris */
+    if (nav->ne>0) {
+        combpeph(nav,opt);
+        packpeph(nav,0x01);
+    }
 }
 
 /* Add precise attitude -----------------------------------------------------*/
@@ -687,7 +896,7 @@ double code2bias(const nav_t *nav, int sys, int sat, int code, int mode) {
     sys_ix=sys2ix(sys);
     frq_ix=code2idx(sys,code);
     if (sys_ix >= 0 && sys_ix < MAX_BIAS_SYS && frq_ix >= 0 && sat <= MAXSAT) {
-        code_ix = code_bias_ix[sys_ix][code];
+        code_ix = code_bias_ix(sys_ix,code);
         if (code_ix < 0) return 0;
         bias=nav->cbias[sat-1][frq_ix][code_ix];  // absolute bias
         if (mode==0)
@@ -725,7 +934,7 @@ static int readbiaf(const char *file, nav_t *nav)
         if (sys_ix < 0 || sys_ix >= MAX_BIAS_SYS) continue;
         if (!(code1=obs2code(&obs1[1]))) continue; /* skip if code not valid */
         if ((frq_ix=code2idx(sys,code1))<0) continue;
-        if ((bias_ix1=code_bias_ix[sys_ix][code1])<0) continue;
+        if ((bias_ix1=code_bias_ix(sys_ix,code1))<0) continue;
         if (strcmp(bias,"OSB")==0) {
             nav->cbias[sat-1][frq_ix][bias_ix1]=cbias*1E-9*CLIGHT; /* ns -> m */
         }
@@ -733,7 +942,7 @@ static int readbiaf(const char *file, nav_t *nav)
             /* differential signal bias */
             if (obs1[1]!=obs2[1]) continue; /* skip biases between freqs for now */
             if (!(code2=obs2code(&obs2[1]))) continue; /* skip if code not valid */
-            if ((bias_ix2=code_bias_ix[sys_ix][code2])<0) continue;
+            if ((bias_ix2=code_bias_ix(sys_ix,code2))<0) continue;
             if (bias_ix1==0) /* this is ref code */
                 nav->cbias[sat-1][frq_ix][bias_ix2]=-cbias*1E-9*CLIGHT; /* ns -> m */
             else if (bias_ix2==0) /* this is ref code */
@@ -763,8 +972,6 @@ int readdcb(const char *file, nav_t *nav, const sta_t *sta)
 
     trace(3,"readdcb : file=%s\n",file);
 
-    init_bias_ix(); /* init translation table from code to table column */
-
     for (i=0;i<MAXSAT;i++) for (j=0;j<NFREQ;j++) for (k=0;k<MAX_CODE_BIASES;k++) {
         nav->cbias[i][j][k]=0.0;
     }
@@ -799,11 +1006,97 @@ static double interppol(const double *x, double *y, int n)
     }
     return y[0];
 }
+/* search packed epoch ---------------------------------------------------------
+* search the first epoch at or after time (the last if none), starting from i
+*-----------------------------------------------------------------------------*/
+static int srchtime(gtime_t time, const pephp_t *p, int i)
+{
+    int j,k;
+
+    for (j=p->n-1;i<j;) {
+        k=(i+j)/2;
+        if (timediff(p->time[k],time)<0.0) i=k+1; else j=k;
+    }
+    return i;
+}
+/* search packed data of satellite at or after epoch k -----------------------*/
+static int srchdata(const pephp_t *p, int sat, int k)
+{
+    const int *ie=p->ie[sat-1];
+    int i=0,j=p->nd[sat-1],m;
+
+    while (i<j) {
+        m=(i+j)/2;
+        if (ie[m]<k) i=m+1; else j=m;
+    }
+    return i;
+}
+/* packed data of satellite at epoch k (NULL: no data) -----------------------*/
+static const double *getdata(const pephp_t *p, int sat, int k, const float **std)
+{
+    int j=srchdata(p,sat,k);
+
+    if (j>=p->nd[sat-1]||p->ie[sat-1][j]!=k) return NULL;
+    *std=p->std[sat-1]+j*p->nv;
+    return p->val[sat-1]+j*p->nv;
+}
+/* packed data of satellite at epochs k to k+n-1 without outage --------------*/
+static const double *getdatas(const pephp_t *p, int sat, int k, int n)
+{
+    int j=srchdata(p,sat,k);
+
+    /* epoch indices of data are increasing */
+    if (j+n-1>=p->nd[sat-1]||p->ie[sat-1][j+n-1]!=k+n-1) return NULL;
+    return p->val[sat-1]+j*p->nv;
+}
+/* Chebyshev fit segment of time ---------------------------------------------*/
+static int segpephc(gtime_t time, const nav_t *nav)
+{
+    const pephc_t *fit=&nav->pephc;
+    double t;
+    int k;
+
+    if (fit->nseg<=0||fit->ne!=nav->pephp.n||fit->nc!=nav->pclkp.n) return -1;
+    if (timediff(time,nav->pephp.time[nav->pephp.n-1])>=0.0) return -1;
+    if ((t=timediff(time,fit->ts))<0.0) return -1;
+    k=(int)(t/fit->tseg);
+    return k<fit->nseg?k:fit->nseg-1;
+}
+/* satellite position by Chebyshev fit of precise ephemeris ------------------*/
+static int pephcpos(gtime_t time, int sat, int k, const nav_t *nav, double *rs)
+{
+    const pephc_t *fit=&nav->pephc;
+    const double *c;
+    double x,b0,b1,b2,q[3],a,sina,cosa,tm;
+    int i,j;
+
+    if (!fit->coef[sat-1]||!fit->ok[sat-1][k]) return 0;
+
+    /* Clenshaw recurrence in segment normalized time x in [-1,1] */
+    tm=timediff(time,fit->ts)-(k+0.5)*fit->tseg;
+    x=tm/(0.5*fit->tseg);
+    for (i=0;i<3;i++) {
+        c=fit->coef[sat-1]+(k*3+i)*NCHEB;
+        for (j=NCHEB-1,b1=b2=0.0;j>0;j--) {
+            b0=2.0*x*b1-b2+c[j]; b2=b1; b1=b0;
+        }
+        q[i]=x*b1-b2+0.5*c[0];
+    }
+    /* rotate from earth-fixed frame at segment center */
+    a=-OMGE*tm; sina=sin(a); cosa=cos(a);
+    rs[0]=cosa*q[0]-sina*q[1];
+    rs[1]=sina*q[0]+cosa*q[1];
+    rs[2]=q[2];
+    return 1;
+}
 /* satellite position by precise ephemeris -----------------------------------*/
 static int pephpos(gtime_t time, int sat, const nav_t *nav, double *rs,
                    double *dts, double *vare, double *varc)
 {
-    double t[NMAX+1],p[3][NMAX+1],c[2],*pos,std=0.0,s[3],sinl,cosl;
+    const pephp_t *peph=&nav->pephp;
+    const double *pos,*val[2];
+    const float *sd[2];
+    double t[NMAX+1],p[3][NMAX+1],c[2],std=0.0,s[3],sinl,cosl;
     int i,j,k,index;
 
     char tstr[40];
@@ -811,71 +1104,89 @@ static int pephpos(gtime_t time, int sat, const nav_t *nav, double *rs,
 
     rs[0]=rs[1]=rs[2]=dts[0]=0.0;
 
-    if (nav->ne<NMAX+1||
-        timediff(time,nav->peph[0].time)<-MAXDTE||
-        timediff(time,nav->peph[nav->ne-1].time)>MAXDTE) {
+    if (peph->n<NMAX+1||
+        timediff(time,peph->time[0])<-MAXDTE||
+        timediff(time,peph->time[peph->n-1])>MAXDTE) {
         trace(3,"no prec ephem %s sat=%2d\n",time2str(time,tstr,0),sat);
         return 0;
     }
-    /* binary search */
-    for (i=0,j=nav->ne-1;i<j;) {
-        k=(i+j)/2;
-        if (timediff(nav->peph[k].time,time)<0.0) i=k+1; else j=k;
+    /* Chebyshev fit of orbit */
+    if ((k=segpephc(time,nav))>=0&&pephcpos(time,sat,k,nav,rs)) {
+        i=nav->pephc.ie[k];
+        while (i<peph->n-1&&timediff(peph->time[i],time)<0.0) i++;
+        index=i<=0?0:i-1;
+
+        if (vare) {
+            val[0]=getdata(peph,sat,index,sd);
+            for (i=0;i<3;i++) s[i]=val[0]?sd[0][i]:0.0;
+            std=norm(s,3);
+            *vare=SQR(std);
+        }
     }
-    index=i<=0?0:i-1;
+    else {
+        /* binary search */
+        i=srchtime(time,peph,0);
+        index=i<=0?0:i-1;
 
-    /* polynomial interpolation for orbit */
-    i=index-(NMAX+1)/2;
-    if (i<0) i=0; else if (i+NMAX>=nav->ne) i=nav->ne-NMAX-1;
+        /* polynomial interpolation for orbit */
+        i=index-(NMAX+1)/2;
+        if (i<0) i=0; else if (i+NMAX>=peph->n) i=peph->n-NMAX-1;
 
-    for (j=0;j<=NMAX;j++) {
-        t[j]=timediff(nav->peph[i+j].time,time);
-        if (norm(nav->peph[i+j].pos[sat-1],3)<=0.0) {
+        if (!(pos=getdatas(peph,sat,i,NMAX+1))) {
             trace(3,"prec ephem outage %s sat=%2d\n",time2str(time,tstr,0),sat);
             return 0;
         }
-    }
-    for (j=0;j<=NMAX;j++) {
-        pos=nav->peph[i+j].pos[sat-1];
-        /* correction for earth rotation ver.2.4.0 */
-        sinl=sin(OMGE*t[j]);
-        cosl=cos(OMGE*t[j]);
-        p[0][j]=cosl*pos[0]-sinl*pos[1];
-        p[1][j]=sinl*pos[0]+cosl*pos[1];
-        p[2][j]=pos[2];
-    }
-    for (i=0;i<3;i++) {
-        rs[i]=interppol(t,p[i],NMAX+1);
-    }
-    if (vare) {
-        for (i=0;i<3;i++) s[i]=nav->peph[index].std[sat-1][i];
-        std=norm(s,3);
-
-        /* extrapolation error for orbit */
-        if      (t[0   ]>0.0) std+=EXTERR_EPH*SQR(t[0   ])/2.0;
-        else if (t[NMAX]<0.0) std+=EXTERR_EPH*SQR(t[NMAX])/2.0;
-        *vare=SQR(std);
+        for (j=0;j<=NMAX;j++) {
+            t[j]=timediff(peph->time[i+j],time);
+            if (norm(pos+j*4,3)<=0.0) {
+                trace(3,"prec ephem outage %s sat=%2d\n",time2str(time,tstr,0),sat);
+                return 0;
+            }
+        }
+        for (j=0;j<=NMAX;j++,pos+=4) {
+            /* correction for earth rotation ver.2.4.0 */
+            sinl=sin(OMGE*t[j]);
+            cosl=cos(OMGE*t[j]);
+            p[0][j]=cosl*pos[0]-sinl*pos[1];
+            p[1][j]=sinl*pos[0]+cosl*pos[1];
+            p[2][j]=pos[2];
+        }
+        for (i=0;i<3;i++) {
+            rs[i]=interppol(t,p[i],NMAX+1);
+        }
+        if (vare) {
+            val[0]=getdata(peph,sat,index,sd);
+            for (i=0;i<3;i++) s[i]=val[0]?sd[0][i]:0.0;
+            std=norm(s,3);
+
+            /* extrapolation error for orbit */
+            if      (t[0   ]>0.0) std+=EXTERR_EPH*SQR(t[0   ])/2.0;
+            else if (t[NMAX]<0.0) std+=EXTERR_EPH*SQR(t[NMAX])/2.0;
+            *vare=SQR(std);
+        }
     }
     /* linear interpolation for clock */
-    t[0]=timediff(time,nav->peph[index  ].time);
-    t[1]=timediff(time,nav->peph[index+1].time);
-    c[0]=nav->peph[index  ].pos[sat-1][3];
-    c[1]=nav->peph[index+1].pos[sat-1][3];
+    t[0]=timediff(time,peph->time[index  ]);
+    t[1]=timediff(time,peph->time[index+1]);
+    val[0]=getdata(peph,sat,index  ,sd  );
+    val[1]=getdata(peph,sat,index+1,sd+1);
+    c[0]=val[0]?val[0][3]:0.0;
+    c[1]=val[1]?val[1][3]:0.0;
 
     if (t[0]<=0.0) {
         if ((dts[0]=c[0])!=0.0) {
-            std=nav->peph[index].std[sat-1][3]*CLIGHT-EXTERR_CLK*t[0];
+            std=sd[0][3]*CLIGHT-EXTERR_CLK*t[0];
         }
     }
     else if (t[1]>=0.0) {
         if ((dts[0]=c[1])!=0.0) {
-            std=nav->peph[index+1].std[sat-1][3]*CLIGHT+EXTERR_CLK*t[1];
+            std=sd[1][3]*CLIGHT+EXTERR_CLK*t[1];
         }
     }
     else if (c[0]!=0.0&&c[1]!=0.0) {
         dts[0]=(c[1]*t[0]-c[0]*t[1])/(t[0]-t[1]);
         i=t[0]<-t[1]?0:1;
-        std = nav->peph[index+i].std[sat-1][3] * CLIGHT + EXTERR_CLK * fabs(t[i]);
+        std = sd[i][3] * CLIGHT + EXTERR_CLK * fabs(t[i]);
     }
     else {
         dts[0]=0.0;
@@ -883,6 +1194,143 @@ static int pephpos(gtime_t time, int sat, const nav_t *nav, double *rs,
     if (varc) *varc=SQR(std);
     return 1;
 }
+/* free Chebyshev fit of precise ephemeris -------------------------------------
+* free Chebyshev fit of precise ephemeris
+* args   : nav_t  *nav      IO  navigation data
+* return : none
+*-----------------------------------------------------------------------------*/
+void freepephc(nav_t *nav)
+{
+    pephc_t *fit=&nav->pephc;
+    int i;
+
+    for (i=0;i<MAXSAT;i++) {
+        free(fit->coef[i]); fit->coef[i]=NULL;
+        free(fit->ok  [i]); fit->ok  [i]=NULL;
+    }
+    free(fit->ie); free(fit->ic); fit->ie=fit->ic=NULL;
+    fit->ne=fit->nc=fit->nseg=0;
+}
+/* fit satellite orbit in a segment ------------------------------------------*/
+static int fitseg(const nav_t *nav, int sat, int k, double *coef)
+{
+    const pephc_t *fit=&nav->pephc;
+    const pephp_t *peph=&nav->pephp;
+    const double *pos;
+    gtime_t ts,tm,time;
+    double f[3][NCHEB],rs[3],dts,x,a,sina,cosa,sum;
+    int i,j,n,i0,i1;
+
+    ts=timeadd(fit->ts,k*fit->tseg);
+    tm=timeadd(ts,0.5*fit->tseg);
+
+    /* all interpolation windows of the segment without outage */
+    i0=srchtime(ts,peph,0); i0=i0<=0?0:i0-1;
+    i1=srchtime(timeadd(ts,fit->tseg),peph,0); i1=i1<=0?0:i1-1;
+    i0-=(NMAX+1)/2; i1+=NMAX-(NMAX+1)/2;
+    if (i0<0) i0=0;
+    if (i1>peph->n-1) i1=peph->n-1;
+    if (i1-i0<NMAX) i1=i0+NMAX;
+    if (!(pos=getdatas(peph,sat,i0,i1-i0+1))) return 0;
+    for (i=i0;i<=i1;i++,pos+=4) {
+        if (norm(pos,3)<=0.0) return 0;
+    }
+    /* interpolated orbit at Chebyshev nodes in earth-fixed frame at center */
+    for (j=0;j<NCHEB;j++) {
+        x=cos(PI*(j+0.5)/NCHEB);
+        time=timeadd(tm,x*0.5*fit->tseg);
+        if (!pephpos(time,sat,nav,rs,&dts,NULL,NULL)) return 0;
+        a=OMGE*timediff(time,tm); sina=sin(a); cosa=cos(a);
+        f[0][j]=cosa*rs[0]-sina*rs[1];
+        f[1][j]=sina*rs[0]+cosa*rs[1];
+        f[2][j]=rs[2];
+    }
+    for (i=0;i<3;i++) for (n=0;n<NCHEB;n++) {
+        for (j=0,sum=0.0;j<NCHEB;j++) sum+=f[i][j]*cos(PI*n*(j+0.5)/NCHEB);
+        coef[i*NCHEB+n]=2.0*sum/NCHEB;
+    }
+    return 1;
+}
+/* fit precise ephemeris -------------------------------------------------------
+* fit the orbits of precise ephemeris by Chebyshev polynomials in segments
+* (<=1 hour) for fast evaluation by pephpos() and peph2pos()
+* args   : nav_t  *nav      IO  navigation data
+* return : number of fitted satellite segments
+* notes  : call it after reading precise ephemerides and clocks by readsp3(),
+*          readrnxc() or readrnxt(). the orbits are fitted to the polynomial
+*          interpolation at the Chebyshev nodes in the earth-fixed frame at
+*          the segment center and the max and rms errors versus the polynomial
+*          interpolation are set to nav->pephc.errmax and errrms.
+*          the fit is discarded if the number of precise ephemerides or clocks
+*          changes. times outside the span of precise ephemerides use the
+*          polynomial interpolation. clocks are linearly interpolated as is.
+*-----------------------------------------------------------------------------*/
+int fitpeph(nav_t *nav)
+{
+    pephc_t *fit=&nav->pephc;
+    const pephp_t *peph=&nav->pephp,*pclk=&nav->pclkp;
+    gtime_t ts,time;
+    double span,rs[3],rf[3],dts,err,sum=0.0;
+    int i,j,k,sat,nfit=0,nchk=0;
+
+    trace(3,"fitpeph: ne=%d nc=%d\n",peph->n,pclk->n);
+
+    freepephc(nav);
+    fit->errmax=fit->errrms=0.0;
+
+    if (peph->n<NMAX+1) return 0;
+
+    fit->ts=peph->time[0];
+    span=timediff(peph->time[peph->n-1],fit->ts);
+    if (span<=0.0) return 0;
+    fit->nseg=(int)ceil(span/TSEGCHEB);
+    fit->tseg=span/fit->nseg;
+
+    if (!(fit->ie=(int *)malloc(sizeof(int)*fit->nseg))||
+        !(fit->ic=(int *)malloc(sizeof(int)*fit->nseg))) {
+        freepephc(nav);
+        return 0;
+    }
+    for (k=0;k<fit->nseg;k++) {
+        ts=timeadd(fit->ts,k*fit->tseg);
+        fit->ie[k]=srchtime(ts,peph,0);
+        fit->ic[k]=pclk->n>0?srchtime(ts,pclk,0):0;
+    }
+    for (sat=1;sat<=MAXSAT;sat++) {
+        if (peph->nd[sat-1]<=0) continue;
+
+        if (!(fit->coef[sat-1]=(double *)malloc(sizeof(double)*fit->nseg*3*NCHEB))||
+            !(fit->ok[sat-1]=(uint8_t *)calloc(fit->nseg,1))) {
+            freepephc(nav);
+            return 0;
+        }
+        for (k=0;k<fit->nseg;k++) {
+            if (!fitseg(nav,sat,k,fit->coef[sat-1]+k*3*NCHEB)) continue;
+            fit->ok[sat-1][k]=1;
+            nfit++;
+
+            /* fit error versus polynomial interpolation */
+            for (j=0;j<NCHKCHEB;j++) {
+                time=timeadd(fit->ts,(k+(j+0.5)/NCHKCHEB)*fit->tseg);
+                if (!pephpos(time,sat,nav,rs,&dts,NULL,NULL)) continue;
+                if (!pephcpos(time,sat,k,nav,rf)) continue;
+                for (i=0;i<3;i++) rf[i]-=rs[i];
+                err=norm(rf,3);
+                if (err>fit->errmax) fit->errmax=err;
+                sum+=err*err; nchk++;
+            }
+        }
+    }
+    fit->errrms=nchk>0?sqrt(sum/nchk):0.0;
+
+    /* enable the fit */
+    fit->ne=peph->n;
+    fit->nc=pclk->n;
+
+    trace(2,"fitpeph: nseg=%d tseg=%.0f nfit=%d errmax=%.4f errrms=%.4f m\n",
+          fit->nseg,fit->tseg,nfit,fit->errmax,fit->errrms);
+    return nfit;
+}
 // Available precise ephemeris, for monitoring.
 //
 // The logic parallels pephpos, to return true for each satellite with
@@ -891,30 +1339,29 @@ static int pephpos(gtime_t time, int sat, const nav_t *nav, double *rs,
 // Returns the number of satellites with available precise ephemeris.
 //
 int pephpos_avail(gtime_t time, const nav_t *nav, int avail[MAXSAT]) {
+  const pephp_t *peph = &nav->pephp;
   for (int i = 0; i < MAXSAT; i++) avail[i] = 0;
 
-  if (nav->ne < NMAX + 1 ||
-      timediff(time, nav->peph[0].time) < -MAXDTE ||
-      timediff(time, nav->peph[nav->ne - 1].time) > MAXDTE) {
+  if (peph->n < NMAX + 1 ||
+      timediff(time, peph->time[0]) < -MAXDTE ||
+      timediff(time, peph->time[peph->n - 1]) > MAXDTE) {
     return 0;
   }
 
   // Binary search.
-  int i = 0;
-  for (int j = nav->ne - 1; i < j; ) {
-    int k = (i + j) / 2;
-    if (timediff(nav->peph[k].time, time) < 0.0) i = k + 1; else j = k;
-  }
+  int i = srchtime(time, peph, 0);
   int index = i <= 0 ? 0 : i - 1;
   // Polynomial interpolation for orbit.
   i = index - (NMAX + 1) / 2;
-  if (i < 0) i = 0; else if (i + NMAX >= nav->ne) i = nav->ne - NMAX - 1;
+  if (i < 0) i = 0; else if (i + NMAX >= peph->n) i = peph->n - NMAX - 1;
 
   int n = 0;
   for (int k = 0; k < MAXSAT; k++) {
+    const double *pos = getdatas(peph, k + 1, i, NMAX + 1);
+    if (!pos) continue;
     int ok = 1;
     for (int j = 0; j <= NMAX; j++) {
-      if (norm(nav->peph[i + j].pos[k], 3) <= 0.0) {
+      if (norm(pos + j * 4, 3) <= 0.0) {
         ok = 0;
         break;
       }
@@ -931,43 +1378,53 @@ int pephpos_avail(gtime_t time, const nav_t *nav, int avail[MAXSAT]) {
 static int pephclk1(gtime_t time, int sat, const nav_t *nav, double *dts,
                     double *varc)
 {
+    const pephp_t *pclk=&nav->pclkp;
+    const double *val[2];
+    const float *sd[2];
     double t[2],c[2],std;
-    int i,j,k,index;
+    int i,j,k,m,index;
 
     char tstr[40];
     trace(4,"pephclk : time=%s sat=%2d\n",time2str(time,tstr,3),sat);
 
-    if (nav->nc<2||
-        timediff(time,nav->pclk[0].time)<-MAXDTE||
-        timediff(time,nav->pclk[nav->nc-1].time)>MAXDTE) {
+    if (pclk->n<2||
+        timediff(time,pclk->time[0])<-MAXDTE||
+        timediff(time,pclk->time[pclk->n-1])>MAXDTE) {
         trace(3,"no prec clock %s sat=%2d\n",time2str(time,tstr,0),sat);
         return 0;
     }
-    /* binary search */
-    for (i=0,j=nav->nc-1;i<j;) {
-        k=(i+j)/2;
-        if (timediff(nav->pclk[k].time,time)<0.0) i=k+1; else j=k;
+    /* binary search within the segment of Chebyshev fit or all epochs */
+    if ((k=segpephc(time,nav))>=0) {
+        i=nav->pephc.ic[k];
+        j=k+1<nav->pephc.nseg?nav->pephc.ic[k+1]:pclk->n-1;
+        while (i<j) {
+            m=(i+j)/2;
+            if (timediff(pclk->time[m],time)<0.0) i=m+1; else j=m;
+        }
     }
+    else i=srchtime(time,pclk,0);
     index=i<=0?0:i-1;
 
     /* linear interpolation for clock */
-    t[0]=timediff(time,nav->pclk[index  ].time);
-    t[1]=timediff(time,nav->pclk[index+1].time);
-    c[0]=nav->pclk[index  ].clk[sat-1][0];
-    c[1]=nav->pclk[index+1].clk[sat-1][0];
+    t[0]=timediff(time,pclk->time[index  ]);
+    t[1]=timediff(time,pclk->time[index+1]);
+    val[0]=getdata(pclk,sat,index  ,sd  );
+    val[1]=getdata(pclk,sat,index+1,sd+1);
+    c[0]=val[0]?val[0][0]:0.0;
+    c[1]=val[1]?val[1][0]:0.0;
 
     if (t[0]<=0.0) {
         if ((dts[0]=c[0])==0.0) return 0;
-        std=nav->pclk[index].std[sat-1][0]*CLIGHT-EXTERR_CLK*t[0];
+        std=sd[0][0]*CLIGHT-EXTERR_CLK*t[0];
     }
     else if (t[1]>=0.0) {
         if ((dts[0]=c[1])==0.0) return 0;
-        std=nav->pclk[index+1].std[sat-1][0]*CLIGHT+EXTERR_CLK*t[1];
+        std=sd[1][0]*CLIGHT+EXTERR_CLK*t[1];
     }
     else if (c[0]!=0.0&&c[1]!=0.0) {
         dts[0]=(c[1]*t[0]-c[0]*t[1])/(t[0]-t[1]);
         i=t[0]<-t[1]?0:1;
-        std=nav->pclk[index+i].std[sat-1][0]*CLIGHT+EXTERR_CLK*fabs(t[i]);
+        std=sd[i][0]*CLIGHT+EXTERR_CLK*fabs(t[i]);
     }
     else {
         trace(3,"prec clock outage %s sat=%2d\n",time2str(time,tstr,0),sat);
@@ -1004,31 +1461,31 @@ int pephclk(gtime_t time, int sat, const nav_t *nav, double *dts, double *varc)
 // Returns the number of satellites with available precise clock.
 //
 int pephclk_avail(gtime_t time, const nav_t *nav, int avail[MAXSAT]) {
+  const pephp_t *pclk = &nav->pclkp;
   for (int i = 0; i < MAXSAT; i++) avail[i] = 0;
 
-  if (nav->nc < 2 ||
-      timediff(time, nav->pclk[0].time) < -MAXDTE ||
-      timediff(time, nav->pclk[nav->nc-1].time) > MAXDTE) {
+  if (pclk->n < 2 ||
+      timediff(time, pclk->time[0]) < -MAXDTE ||
+      timediff(time, pclk->time[pclk->n - 1]) > MAXDTE) {
     // trace(3,"no prec clock %s sat=%2d\n",time2str(time,tstr,0),sat);
     return 0;
   }
 
   // Binary search.
-  int i = 0;
-  for (int j = nav->nc - 1; i < j; ) {
-    int k = (i + j) / 2;
-    if (timediff(nav->pclk[k].time, time) < 0.0) i = k + 1; else j = k;
-  }
+  int i = srchtime(time, pclk, 0);
   int index = i <= 0 ? 0 : i - 1;
 
   // Linear interpolation for clock.
-  double t0 = timediff(time, nav->pclk[index].time);
-  double t1 = timediff(time, nav->pclk[index + 1].time);
+  double t0 = timediff(time, pclk->time[index]);
+  double t1 = timediff(time, pclk->time[index + 1]);
 
   int n = 0;
   for (int k = 0; k < MAXSAT; k++) {
-    double c0 = nav->pclk[index  ].clk[k][0];
-    double c1 = nav->pclk[index+1].clk[k][0];
+    const float *sd;
+    const double *v0 = getdata(pclk, k + 1, index, &sd);
+    const double *v1 = getdata(pclk, k + 1, index + 1, &sd);
+    double c0 = v0 ? v0[0] : 0.0;
+    double c1 = v1 ? v1[0] : 0.0;
     if (t0 <= 0.0) {
       if (c0 == 0.0) continue;
     } else if (t1 >= 0.0) {
@@ -1278,8 +1735,9 @@ void satantoff(gtime_t time, const double *rs, int sat, const nav_t *nav, double
 *                                 (NULL: no output)
 * return : status (1:ok,0:error or data outage)
 * notes  : clock includes relativistic correction but does not contain code bias
-*          before calling the function, nav->peph, nav->ne, nav->pclk and
-*          nav->nc must be set by calling readsp3(), readrnx() or readrnxt()
+*          before calling the function, the packed precise ephemeris/clock
+*          nav->pephp and nav->pclkp must be set by calling readsp3() and
+*          readrnxc(), or packpeph() after setting nav->peph and nav->pclk
 *          if precise clocks are not set, clocks in sp3 are used instead
 *-----------------------------------------------------------------------------*/
 int peph2pos(gtime_t time, int sat, const nav_t *nav, int opt,
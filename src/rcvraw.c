@@ -1474,16 +1474,8 @@ void free_raw(raw_t *raw)
     }
     raw->rcv_data=NULL;
 }
-/* input receiver raw data from stream -----------------------------------------
-* fetch next receiver raw data and input a message from stream
-* args   : raw_t  *raw   IO     receiver raw data control struct
-*          int    format I      receiver raw data format (STRFMT_???)
-*          uint8_t data     I   stream data (1 byte)
-* return : status (-1: error message, 0: no message, 1: input observation data,
-*                  2: input ephemeris, 3: input sbas message,
-*                  9: input ion/utc parameter)
-*-----------------------------------------------------------------------------*/
-int input_raw(raw_t *raw, int format, uint8_t data)
+/* input receiver raw data byte ----------------------------------------------*/
+static int input_rawb(raw_t *raw, int format, uint8_t data)
 {
     trace(5,"input_raw: format=%d data=0x%02x\n",format,data);
     
@@ -1505,6 +1497,96 @@ int input_raw(raw_t *raw, int format, uint8_t data)
     }
     return 0;
 }
+/* frame layout of length-prefixed raw formats -------------------------------*/
+static int rawframe(int format, uint8_t *sync, int *nsync, int *nhead, int *ncrc)
+{
+    switch (format) {
+        case STRFMT_UBX : *sync=0xB5; *nsync=2; *nhead=6; *ncrc=0; return 1;
+        case STRFMT_OEM4: *sync=0xAA; *nsync=3; *nhead=10; *ncrc=4; return 1;
+        case STRFMT_SEPT: *sync=0x24; *nsync=2; *nhead=8; *ncrc=0; return 1;
+        case STRFMT_SBP : *sync=0x55; *nsync=1; *nhead=6; *ncrc=0; return 1;
+        case STRFMT_STQ : *sync=0xA0; *nsync=2; *nhead=4; *ncrc=0; return 1;
+        case STRFMT_UNICORE: *sync=0xAA; *nsync=3; *nhead=8; *ncrc=4; return 1;
+    }
+    return 0;
+}
+/* input receiver raw data from stream buffer ----------------------------------
+* fetch receiver raw data from buffer and input messages until a message is
+* decoded or the buffer is consumed
+* args   : raw_t  *raw   IO     receiver raw data control struct
+*          int    format I      receiver raw data format (STRFMT_???)
+*          uint8_t *data I      stream data
+*          int    len    I      length of stream data (bytes)
+*          int    *consumed O   number of consumed bytes of data
+* return : status (same as input_raw())
+* notes  : for the length-prefixed formats (UBX, OEM4, SBF, SBP, STQ, UNICORE),
+*          the bytes before the first sync code are skipped by memchr() and the
+*          bytes of a frame after the header are copied to raw->buff at once.
+*          the state of raw is the same as input_raw() byte by byte. the frame
+*          is decoded and its checksum is validated as input_raw().
+*-----------------------------------------------------------------------------*/
+int input_raw_buf(raw_t *raw, int format, const uint8_t *data, int len,
+                  int *consumed)
+{
+    const uint8_t *q;
+    uint8_t sync=0;
+    int i=0,ret,n,nb,bw,nsync=0,nhead=0,ncrc=0,frame;
+    
+    trace(5,"input_raw_buf: format=%d len=%d\n",format,len);
+    
+    frame=rawframe(format,&sync,&nsync,&nhead,&ncrc);
+    
+    /* bytes before bw are input byte by byte to complete a sync code */
+    bw=nsync-1;
+    
+    while (i<len) {
+        if (frame&&i>=bw) {
+            if (raw->nbyte==0) {
+                /* skip to sync code keeping the sync history */
+                n=(q=(const uint8_t *)memchr(data+i,sync,len-i))?(int)(q-data):len;
+                if (n-i>nsync-1) i=n-(nsync-1);
+                bw=n+1;
+                if (i>=len) break;
+            }
+            else if (raw->nbyte>=nhead&&raw->nbyte<raw->len+ncrc-1) {
+                /* copy frame body except the last byte */
+                n=raw->len+ncrc-1-raw->nbyte;
+                if (n>len-i) n=len-i;
+                memcpy(raw->buff+raw->nbyte,data+i,n);
+                raw->nbyte+=n;
+                i+=n;
+                continue;
+            }
+        }
+        nb=raw->nbyte;
+        ret=input_rawb(raw,format,data[i++]);
+        if (raw->nbyte==0&&(nb>0||data[i-1]==sync)) {
+            bw=i+nsync-1; /* end of frame or sync code 1 */
+        }
+        if (ret) {
+            *consumed=i;
+            return ret;
+        }
+    }
+    *consumed=len;
+    return 0;
+}
+/* input receiver raw data from stream -----------------------------------------
+* fetch next receiver raw data and input a message from stream
+* args   : raw_t  *raw   IO     receiver raw data control struct
+*          int    format I      receiver raw data format (STRFMT_???)
+*          uint8_t data     I   stream data (1 byte)
+* return : status (-1: error message, 0: no message, 1: input observation data,
+*                  2: input ephemeris, 3: input sbas message,
+*                  9: input ion/utc parameter)
+* notes  : same as input_raw_buf() with 1 byte
+*-----------------------------------------------------------------------------*/
+int input_raw(raw_t *raw, int format, uint8_t data)
+{
+    int n;
+    
+    return input_raw_buf(raw,format,&data,1,&n);
+}
 /* input receiver raw data from file -------------------------------------------
 * fetch next receiver raw data and input a message from file
 * args   : raw_t  *raw   IO     receiver raw data control struct
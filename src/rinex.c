@@ -117,7 +117,11 @@
 *                           use integer types in stdint.h
 *                           suppress warnings
 *-----------------------------------------------------------------------------*/
+#define _POSIX_C_SOURCE 200809L
 #include "rtklib.h"
+#ifndef WIN32
+#include <unistd.h>
+#endif
 
 /* constants/macros ----------------------------------------------------------*/
 
@@ -129,10 +133,80 @@
 #define MINFREQ_GLO -7                  /* min frequency number GLONASS */
 #define MAXFREQ_GLO 13                  /* max frequency number GLONASS */
 #define NINCOBS     262144              /* incremental number of obs data */
+#define MAXRNXTHR   64                  /* max number of obs decoding threads */
+#define MINRNXCHUNK 4194304             /* default min size of obs chunk (bytes) */
+#define CRXORDER    3                   /* difference order of compact RINEX */
+#define MAXCRXLEN   4096                /* max line length of compact RINEX */
+#define MAXOUTBUF   16384               /* size of RINEX output buffer (bytes) */
 
 static const int navsys[RNX_NUMSYS]={ /* satellite systems */
     SYS_GPS,SYS_GLO,SYS_GAL,SYS_QZS,SYS_SBS,SYS_BDS,SYS_IRN
 };
+static int rnxnthread=1;                /* obs decoding threads (0:processors) */
+static long rnxchunk=MINRNXCHUNK;       /* min size of obs chunk (bytes) */
+
+typedef struct {        /* decoded obs epoch type */
+    int n,flag;         /* number of obs data and epoch flag */
+    int idata;          /* index of obs data in chunk */
+    int stime;          /* time of data[0] set without obs data */
+    gtime_t time;       /* time of data[0] without obs data */
+    gtime_t eventime;   /* event time (flag=5) */
+} rnxepo_t;
+
+typedef struct {        /* RINEX obs chunk type */
+    const char *file;   /* RINEX obs file */
+    const uint8_t *buff; /* RINEX obs file uncompressed in memory (NULL: file) */
+    long pos,end;       /* chunk start/end position in file */
+    const char *opt;    /* RINEX options */
+    double ver;         /* RINEX version */
+    int tsys;           /* time system */
+    char tobs[RNX_NUMSYS][MAXOBSTYPE][4]; /* obs types */
+    sta_t sta,*psta;    /* station parameters (NULL: no input) */
+    rnxepo_t *epo;      /* decoded epochs */
+    int nepo,nepomax;   /* number of decoded epochs/allocated */
+    obsd_t *data;       /* decoded obs data */
+    int ndata,ndatamax; /* number of decoded obs data/allocated */
+    int stat;           /* status (1:ok,0:error,-1:header changed) */
+} rnxchunk_t;
+
+typedef struct {        /* RINEX obs epoch reader type */
+    FILE *fp;           /* file pointer (NULL: decoded chunks) */
+    rnxchunk_t *chunk;  /* decoded chunks */
+    int nchunk,ichunk,iepo; /* number of chunks and current chunk/epoch */
+} rnxrd_t;
+
+typedef struct {        /* compact RINEX encoder data arc type */
+    int64_t d[CRXORDER+1]; /* value and differences */
+    int order;          /* difference order (-1:no data) */
+} crxdarc_t;
+
+typedef struct {        /* compact RINEX encoder satellite type */
+    crxdarc_t arc[MAXOBSTYPE]; /* data arcs by observation type */
+    char flag[2*MAXOBSTYPE+1]; /* LLI and signal strength flags */
+    int iep;            /* index of last epoch */
+} crxesat_t;
+
+typedef struct {        /* compact RINEX encoder state type */
+    char prog[81];      /* "CRINEX PROG / DATE" line */
+    char epoch[MAXCRXLEN]; /* epoch line */
+    int ntype[256];     /* number of obs types by system code (ver.1: [0]) */
+    int init;           /* initialize next epoch */
+    int iep;            /* epoch index */
+    crxdarc_t clk;      /* receiver clock offset */
+    crxesat_t *sat[256*100]; /* satellites by system code and prn */
+    char *buff;         /* RINEX text not encoded */
+    size_t n,nmax;      /* size of text and allocated (bytes) */
+    char *mbuf;         /* buffer of memory stream crx->tmp */
+    size_t msize;       /* size of memory stream buffer (bytes) */
+} crxstat_t;
+
+typedef struct {        /* RINEX output buffer type */
+    FILE *fp;           /* output file pointer */
+    int n;              /* number of buffered bytes */
+    int stat;           /* status (1:ok,0:output error) */
+    char buff[MAXOUTBUF]; /* buffered text */
+} outbuf_t;
+
 /* Satellite system codes, nul terminated. RNX_SYS_ */
 static const char syscodes[RNX_NUMSYS+1]="GREJSCI";
 
@@ -842,22 +916,27 @@ static int decode_obsdata(FILE *fp, const char *opt, char *buff, double ver, int
         default:      ind=index  ; break;
     }
     int codesig[MAXCODE] = {-1}, nsigs = 0;
+    int len=(int)strlen(buff);
     for (i=0,j=ver<=2.99?0:3;i<ind->n;i++,j+=16) {
 
         if (ver<=2.99&&j>=80) { /* ver.2 */
             if (!fgets(buff,MAXRNXLEN,fp)) break;
+            len=(int)strlen(buff);
             j=0;
         }
         int code = ind->code[i];
         if (stat && code != CODE_NONE) {
-            val[i]=str2num(buff,j,14)+ind->shift[i];
+            /* F14.3 by fixed-point decimal, LLI and SSI digits inline */
+            val[i]=(j<len?str2fix(buff+j,0,14):0.0)+ind->shift[i];
             if (ind->type[i] == 0 && val[i] != 0) {
               codesig[code] = nsigs;
               nsigs++;
             }
-            lli[i]=(uint8_t)str2num(buff,j+14,1)&3;
+            char c=j+14<len?buff[j+14]:'\0';
+            lli[i]=(uint8_t)(c>='0'&&c<='9'?c-'0':0)&3;
             /* measurement std from receiver, encoded */
-            std[i]=str2num(buff,j+15,1);
+            c=j+15<len?buff[j+15]:'\0';
+            std[i]=c>='0'&&c<='9'?c-'0':0.0;
         }
     }
     if (!stat) return 0;
@@ -1084,13 +1163,286 @@ static int readrnxobsb(FILE *fp, const char *opt, double ver, int *tsys,
     }
     return -1;
 }
+/* add decoded obs epoch to chunk --------------------------------------------*/
+static int addrnxepo(rnxchunk_t *c, int n, int flag, const obsd_t *data)
+{
+    rnxepo_t *epo;
+    obsd_t *obs_data;
+
+    if (c->nepo>=c->nepomax) {
+        c->nepomax=c->nepomax<=0?4096:c->nepomax*2;
+        if (!(epo=(rnxepo_t *)realloc(c->epo,sizeof(rnxepo_t)*c->nepomax))) return 0;
+        c->epo=epo;
+    }
+    if (c->ndata+n>c->ndatamax) {
+        c->ndatamax=c->ndatamax<=0?NINCOBS:c->ndatamax*2;
+        if (c->ndatamax<c->ndata+n) c->ndatamax=c->ndata+n;
+        if (!(obs_data=(obsd_t *)realloc(c->data,sizeof(obsd_t)*c->ndatamax))) {
+            return 0;
+        }
+        c->data=obs_data;
+    }
+    epo=c->epo+c->nepo++;
+    epo->n=n;
+    epo->flag=flag;
+    epo->idata=c->ndata;
+    epo->stime=n==0&&data[0].time.sec>=0.0;
+    epo->time=data[0].time;
+    epo->eventime=data[0].eventime;
+    memcpy(c->data+c->ndata,data,sizeof(obsd_t)*n);
+    c->ndata+=n;
+    return 1;
+}
+/* decode RINEX obs chunk ------------------------------------------------------
+* decode the epochs starting in the chunk as readrnxobsb() into the chunk. an
+* epoch resynchronized over the chunk end belongs to the next chunk.
+*-----------------------------------------------------------------------------*/
+static void decodernxchunk(rnxchunk_t *c)
+{
+    FILE *fp;
+    obsd_t *data;
+    char tobs[RNX_NUMSYS][MAXOBSTYPE][4];
+    long off=0;
+    int n,flag=0,tsys=c->tsys;
+
+    trace(4,"decodernxchunk: pos=%ld end=%ld\n",c->pos,c->end);
+
+    c->stat=0;
+    if (!(data=(obsd_t *)calloc(MAXOBS,sizeof(obsd_t)))) return;
+    if (c->buff) { /* chunk in memory */
+        fp=rtk_fmemopen(c->buff+c->pos,(size_t)(c->end-c->pos));
+        off=c->pos;
+    }
+    else if ((fp=fopen(c->file,"rb"))&&fseek(fp,c->pos,SEEK_SET)) {
+        fclose(fp);
+        fp=NULL;
+    }
+    if (!fp) {
+        free(data);
+        return;
+    }
+    memcpy(tobs,c->tobs,sizeof(tobs));
+    c->stat=1;
+
+    while (ftell(fp)+off<c->end) {
+        data[0].time.sec=-1.0; /* to detect time set without obs data */
+        if ((n=readrnxobsb(fp,c->opt,c->ver,&tsys,tobs,&flag,data,c->psta))<0) {
+            break;
+        }
+        if (ftell(fp)+off>c->end) break;
+        if (!addrnxepo(c,n,flag,data)) {c->stat=0; break;}
+    }
+    /* header records changing obs types, time system or station */
+    if (c->stat&&(tsys!=c->tsys||memcmp(tobs,c->tobs,sizeof(tobs)))) c->stat=-1;
+
+    fclose(fp);
+    free(data);
+}
+/* RINEX obs chunk thread ----------------------------------------------------*/
+typedef struct {
+    rnxchunk_t *chunk;
+    int nchunk,ichunk;
+    rtklib_lock_t lock;
+} rnxpool_t;
+
+#ifdef WIN32
+static DWORD WINAPI rnxchunkthread(void *arg)
+#else
+static void *rnxchunkthread(void *arg)
+#endif
+{
+    rnxpool_t *pool=(rnxpool_t *)arg;
+    int i;
+
+    for (;;) {
+        rtklib_lock(&pool->lock);
+        i=pool->ichunk<pool->nchunk?pool->ichunk++:-1;
+        rtklib_unlock(&pool->lock);
+        if (i<0) break;
+        decodernxchunk(pool->chunk+i);
+    }
+    return 0;
+}
+/* number of obs decoding threads --------------------------------------------*/
+static int nrnxthread(void)
+{
+    int n=rnxnthread;
+
+    if (n<=0) {
+#ifdef WIN32
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        n=(int)info.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+        n=(int)sysconf(_SC_NPROCESSORS_ONLN);
+#else
+        n=1;
+#endif
+    }
+    return n<1?1:(n>MAXRNXTHR?MAXRNXTHR:n);
+}
+/* free RINEX obs chunks -----------------------------------------------------*/
+static void freernxchunk(rnxchunk_t *chunk, int n)
+{
+    int i;
+
+    for (i=0;i<n;i++) {
+        free(chunk[i].epo);
+        free(chunk[i].data);
+    }
+    free(chunk);
+}
+/* open RINEX obs body as binary stream ----------------------------------------
+* open the file as binary stream positioned to the obs body, as seeking to byte
+* offsets not obtained by ftell() is not defined for text streams
+*-----------------------------------------------------------------------------*/
+static FILE *openrnxbody(const char *file, long *pos0)
+{
+    FILE *fp;
+    char line[MAXRNXLEN];
+
+    if (!(fp=fopen(file,"rb"))) return NULL;
+    while (fgets(line,MAXRNXLEN,fp)) {
+        if (strlen(line)>60&&strstr(line+60,"END OF HEADER")) {
+            if ((*pos0=ftell(fp))>=0) return fp;
+            break;
+        }
+    }
+    fclose(fp);
+    return NULL;
+}
+/* decode RINEX obs body by chunks in threads ----------------------------------
+* split the obs body at epoch records (RINEX 3/4 '>') into chunks decoded in
+* threads with the header shared. the file uncompressed in memory (buff) is
+* split in the buffer. the file is split by byte offsets of a binary stream.
+* return the number of chunks (0: not split or error, fp restored to the body)
+*-----------------------------------------------------------------------------*/
+static int readrnxchunks(FILE *fp, const char *file, const uint8_t *buff,
+                         const char *opt,
+                         double ver, int tsys, char tobs[][MAXOBSTYPE][4],
+                         const sta_t *sta, rnxchunk_t **chunk)
+{
+    rtklib_thread_t thread[MAXRNXTHR];
+    rnxpool_t pool={0};
+    rnxchunk_t *c;
+    FILE *fs=fp;
+    char line[MAXRNXLEN];
+    long pos0,size,pos,*bound;
+    int i,n=0,nc,nt=nrnxthread();
+
+    if ((!file||!*file)&&!buff) return 0;
+    if (ver<=2.99||nt<=1) return 0;
+    if (buff) { /* binary memory stream */
+        if ((pos0=ftell(fp))<0) return 0;
+    }
+    else if (!(fs=openrnxbody(file,&pos0))) return 0;
+
+    if (fseek(fs,0,SEEK_END)||(size=ftell(fs))<0) size=pos0;
+    nc=rnxchunk>0?(int)((size-pos0)/rnxchunk):0;
+    if (nc>nt*4) nc=nt*4;
+    if (nc<2||!(bound=(long *)malloc(sizeof(long)*(nc+1)))) {
+        if (fs!=fp) fclose(fs); else fseek(fp,pos0,SEEK_SET);
+        return 0;
+    }
+    trace(3,"readrnxchunks: file=%s size=%ld nchunk=%d nthread=%d\n",file,
+          size,nc,nt);
+
+    /* chunk bounds at epoch records */
+    bound[n++]=pos0;
+    for (i=1;i<nc;i++) {
+        if (fseek(fs,pos0+(size-pos0)/nc*i,SEEK_SET)) break;
+        if (!fgets(line,MAXRNXLEN,fs)) break; /* partial line */
+        for (pos=ftell(fs);fgets(line,MAXRNXLEN,fs);pos=ftell(fs)) {
+            if (line[0]=='>') break;
+        }
+        if (feof(fs)) break;
+        if (pos>bound[n-1]) bound[n++]=pos;
+    }
+    bound[n]=size;
+    if (fs!=fp) fclose(fs); else fseek(fp,pos0,SEEK_SET);
+
+    if (n<2||!(c=(rnxchunk_t *)calloc(n,sizeof(rnxchunk_t)))) {
+        free(bound);
+        return 0;
+    }
+    for (i=0;i<n;i++) {
+        c[i].file=file;
+        c[i].buff=buff;
+        c[i].pos=bound[i];
+        c[i].end=bound[i+1];
+        c[i].opt=opt;
+        c[i].ver=ver;
+        c[i].tsys=tsys;
+        memcpy(c[i].tobs,tobs,sizeof(c[i].tobs));
+        if (sta) {c[i].sta=*sta; c[i].psta=&c[i].sta;}
+    }
+    free(bound);
+
+    /* decode chunks in threads */
+    pool.chunk=c;
+    pool.nchunk=n;
+    rtklib_initlock(&pool.lock);
+    if (nt>n) nt=n;
+
+    for (i=0;i<nt;i++) {
+#ifdef WIN32
+        if (!(thread[i]=CreateThread(NULL,0,rnxchunkthread,&pool,0,NULL))) break;
+#else
+        if (pthread_create(thread+i,NULL,rnxchunkthread,&pool)) break;
+#endif
+    }
+    rnxchunkthread(&pool);
+    for (nt=i,i=0;i<nt;i++) {
+#ifdef WIN32
+        WaitForSingleObject(thread[i],INFINITE);
+        CloseHandle(thread[i]);
+#else
+        pthread_join(thread[i],NULL);
+#endif
+    }
+    /* station parameters changed or errors: decode serially */
+    for (i=0;i<n;i++) {
+        if (c[i].stat<=0||(sta&&memcmp(&c[i].sta,sta,sizeof(sta_t)))) break;
+    }
+    if (i<n) {
+        trace(2,"readrnxchunks: decode serially chunk=%d stat=%d\n",i,c[i].stat);
+        freernxchunk(c,n);
+        return 0;
+    }
+    *chunk=c;
+    return n;
+}
+/* read RINEX obs epoch from file or decoded chunks --------------------------*/
+static int readrnxepo(rnxrd_t *rd, const char *opt, double ver, int *tsys,
+                      char tobs[][MAXOBSTYPE][4], int *flag, obsd_t *data,
+                      sta_t *sta)
+{
+    const rnxepo_t *epo;
+    const rnxchunk_t *c;
+
+    if (rd->fp) return readrnxobsb(rd->fp,opt,ver,tsys,tobs,flag,data,sta);
+
+    for (;rd->ichunk<rd->nchunk;rd->ichunk++,rd->iepo=0) {
+        c=rd->chunk+rd->ichunk;
+        if (rd->iepo>=c->nepo) continue;
+        epo=c->epo+rd->iepo++;
+        *flag=epo->flag;
+        memcpy(data,c->data+epo->idata,sizeof(obsd_t)*epo->n);
+        if (epo->stime) data[0].time=epo->time;
+        if (epo->flag==5) data[0].eventime=epo->eventime;
+        return epo->n;
+    }
+    return -1;
+}
 /* read RINEX observation data -----------------------------------------------*/
-static int readrnxobs(FILE *fp, gtime_t ts, gtime_t te, double tint,
-                      const char *opt, int rcv, double ver, int *tsys,
+static int readrnxobs(FILE *fp, const char *file, const uint8_t *buff,
+                      gtime_t ts, gtime_t te, double tint, const char *opt,
+                      int rcv, double ver, int *tsys,
                       char tobs[][MAXOBSTYPE][4], obs_t *obs, sta_t *sta)
 {
     gtime_t eventime={0},time0={0},time1={0};
     obsd_t *data;
+    rnxrd_t rd={0};
     uint8_t slips[MAXSAT][MAXCODE]={{0}};
     int i,n,n1=0,flag=0,stat=0;
     double dtime1=0;
@@ -1099,16 +1451,21 @@ static int readrnxobs(FILE *fp, gtime_t ts, gtime_t te, double tint,
 
     if (!obs||rcv>MAXRCV) return 0;
 
-    if (!(data=(obsd_t *)malloc(sizeof(obsd_t)*MAXOBS))) return 0;
+    if (!(data=(obsd_t *)calloc(MAXOBS,sizeof(obsd_t)))) return 0;
 
+    /* decode body by chunks in threads or read serially */
+    if (!(rd.nchunk=readrnxchunks(fp,file,buff,opt,ver,*tsys,tobs,sta,
+                                   &rd.chunk))) {
+        rd.fp=fp;
+    }
     /* read RINEX observation data body */
-    while ((n=readrnxobsb(fp,opt,ver,tsys,tobs,&flag,data,sta))>=0&&stat>=0) {
+    while ((n=readrnxepo(&rd,opt,ver,tsys,tobs,&flag,data,sta))>=0&&stat>=0) {
 
         if (flag == 5) {
             eventime = data[0].eventime;
-            n = readrnxobsb(fp,opt,ver,tsys,tobs,&flag,data,sta);
+            n = readrnxepo(&rd,opt,ver,tsys,tobs,&flag,data,sta);
             if (fabs(timediff(data[0].time,time1)-dtime1)>=DTTOL)
-                n = readrnxobsb(fp,opt,ver,tsys,tobs,&flag,data,sta);
+                n = readrnxepo(&rd,opt,ver,tsys,tobs,&flag,data,sta);
         }
 
         if (eventime.time==0 || obs->n-n1<=0 || timediff(eventime,time1)>=0) {
@@ -1147,6 +1504,7 @@ static int readrnxobs(FILE *fp, gtime_t ts, gtime_t te, double tint,
     }
     trace(4,"readrnxobs: nobs=%d stat=%d\n",obs->n,stat);
 
+    if (rd.chunk) freernxchunk(rd.chunk,rd.nchunk);
     free(data);
 
     return stat;
@@ -1408,13 +1766,13 @@ static int readrnxnavb(FILE *fp, const char *opt, double ver, int sys,
             }
             /* decode data fields */
             for (j=0,p=buff+sp+19;j<3;j++,p+=19) {
-                data[i++]=str2num(p,0,19);
+                data[i++]=str2fix(p,0,19);
             }
         }
         else {
             /* decode data fields */
             for (j=0,p=buff+sp;j<4;j++,p+=19) {
-                data[i++]=str2num(p,0,19);
+                data[i++]=str2fix(p,0,19);
             }
             /* decode ephemeris */
             if (sys==SYS_GLO&&i>=nglo) {
@@ -1542,7 +1900,7 @@ static int readrnxclk(FILE *fp, const char *opt, double ver, int index, nav_t *n
         if (!(satsyst(sat, time, NULL) & mask)) continue;
 
         double data[2];
-        for (int i=0,j=40+off;i<2;i++,j+=20) data[i]=str2num(buff,j,19);
+        for (int i=0,j=40+off;i<2;i++,j+=20) data[i]=str2fix(buff,j,19);
 
         if (nav->nc>=nav->ncmax) {
             nav->ncmax+=1024;
@@ -1602,9 +1960,9 @@ static int readrnxclk(FILE *fp, const char *opt, double ver, int index, nav_t *n
     return nav->nc>0;
 }
 /* read RINEX file -----------------------------------------------------------*/
-static int readrnxfp(FILE *fp, gtime_t ts, gtime_t te, double tint,
-                     const char *opt, int flag, int index, char *type,
-                     obs_t *obs, nav_t *nav, sta_t *sta)
+static int readrnxfp(FILE *fp, const char *file, const uint8_t *buff,
+                     gtime_t ts, gtime_t te, double tint, const char *opt, int flag, int index,
+                     char *type, obs_t *obs, nav_t *nav, sta_t *sta)
 {
     double ver;
     int sys,tsys=TSYS_GPS;
@@ -1620,8 +1978,8 @@ static int readrnxfp(FILE *fp, gtime_t ts, gtime_t te, double tint,
 
     /* read RINEX file body */
     switch (*type) {
-        case 'O': return readrnxobs(fp,ts,te,tint,opt,index,ver,&tsys,tobs,obs,
-                                    sta);
+        case 'O': return readrnxobs(fp,file,buff,ts,te,tint,opt,index,ver,
+                                    &tsys,tobs,obs,sta);
         case 'N': return readrnxnav(fp,opt,ver,sys    ,nav);
         case 'G': return readrnxnav(fp,opt,ver,SYS_GLO,nav);
         case 'H': return readrnxnav(fp,opt,ver,SYS_SBS,nav);
@@ -1638,6 +1996,8 @@ static int readrnxfile(const char *file, gtime_t ts, gtime_t te, double tint,
                        obs_t *obs, nav_t *nav, sta_t *sta)
 {
     FILE *fp;
+    uint8_t *buff;
+    size_t size;
     int cstat,stat;
     char tmpfile[1024];
 
@@ -1645,6 +2005,18 @@ static int readrnxfile(const char *file, gtime_t ts, gtime_t te, double tint,
 
     if (sta) init_sta(sta);
 
+    /* uncompress file in memory */
+    if (rtk_uncompbuf(file,&buff,&size)>0) {
+        if (!(fp=rtk_fmemopen(buff,size))) {
+            free(buff);
+            return 0;
+        }
+        stat=readrnxfp(fp,file,buff,ts,te,tint,opt,flag,index,type,obs,nav,
+                       sta);
+        fclose(fp);
+        free(buff);
+        return stat;
+    }
     /* uncompress file */
     if ((cstat=rtk_uncompress(file,tmpfile))<0) {
         trace(2,"rinex file uncompact error: %s\n",file);
@@ -1655,7 +2027,8 @@ static int readrnxfile(const char *file, gtime_t ts, gtime_t te, double tint,
         return 0;
     }
     /* read RINEX file */
-    stat=readrnxfp(fp,ts,te,tint,opt,flag,index,type,obs,nav,sta);
+    stat=readrnxfp(fp,cstat?tmpfile:file,NULL,ts,te,tint,opt,flag,index,type,obs,
+                   nav,sta);
 
     fclose(fp);
 
@@ -1748,7 +2121,7 @@ int readrnxt(const char *file, int rcv, gtime_t ts, gtime_t te,
     trace(3,"readrnxt: file=%s rcv=%d\n",file,rcv);
 
     if (!*file) {
-        return readrnxfp(stdin,ts,te,tint,opt,0,1,&type,obs,nav,sta);
+        return readrnxfp(stdin,NULL,NULL,ts,te,tint,opt,0,1,&type,obs,nav,sta);
     }
     for (i=0;i<MAXEXFILE;i++) {
         if (!(files[i]=(char *)malloc(1024))) {
@@ -1774,6 +2147,26 @@ int readrnxt(const char *file, int rcv, gtime_t ts, gtime_t te,
 
     return stat;
 }
+/* set RINEX obs decoding threads ----------------------------------------------
+* set the threads to decode RINEX 3/4 obs files by chunks
+* args   : int    nthread   I   number of threads (0:processors,1:no thread)
+*          long   chunk     I   min size of chunk (bytes) (0:default)
+* return : none
+* notes  : the obs body is split at epoch records into chunks decoded in the
+*          threads with the header shared and concatenated in order. the obs
+*          data are the same as decoded serially. files with the header records
+*          in the body changing obs types or station parameters are decoded
+*          serially. the setting is process wide. the default is no thread
+*          (nthread=1). the threads are in addition to the threads of the
+*          caller, as the jobs reading files concurrently.
+*-----------------------------------------------------------------------------*/
+void setrnxthread(int nthread, long chunk)
+{
+    trace(3,"setrnxthread: nthread=%d chunk=%ld\n",nthread,chunk);
+
+    rnxnthread=nthread;
+    rnxchunk=chunk>0?chunk:MINRNXCHUNK;
+}
 int readrnx(const char *file, int rcv, const char *opt, obs_t *obs,
                    nav_t *nav, sta_t *sta)
 {
@@ -1829,6 +2222,7 @@ static void combpclk(nav_t *nav)
 * args   : char *file    I      file (wild-card * expanded)
 *          nav_t *nav    IO     navigation data    (NULL: no input)
 * return : number of precise clock
+* notes  : precise clock is appended, combined and packed (packpeph())
 *-----------------------------------------------------------------------------*/
 int readrnxc(const char *file, nav_t *nav)
 {
@@ -1859,8 +2253,9 @@ int readrnxc(const char *file, nav_t *nav)
 
     if (!stat) return 0;
 
-    /* unique and combine ephemeris and precise clock */
+    /* unique, combine and pack precise clock */
     combpclk(nav);
+    packpeph(nav,0x02);
 
     return nav->nc;
 }
@@ -2317,22 +2712,73 @@ int outrnxobsh(FILE *fp, const rnxopt_t *opt, const nav_t *nav)
     }
     return fprintf(fp,"%-60.60s%-20s\n","","END OF HEADER")!=EOF;
 }
+/* initialize output buffer -------------------------------------------------*/
+static void outbuf_init(outbuf_t *b, FILE *fp)
+{
+    b->fp=fp;
+    b->n=0;
+    b->stat=1;
+}
+/* flush output buffer ------------------------------------------------------*/
+static int outbuf_flush(outbuf_t *b)
+{
+    if (b->n>0&&fwrite(b->buff,1,b->n,b->fp)!=(size_t)b->n) b->stat=0;
+    b->n=0;
+    return b->stat;
+}
+/* output buffer with free space (flushed if less than n bytes) --------------*/
+static char *outbuf_ptr(outbuf_t *b, int n)
+{
+    if (b->n+n>MAXOUTBUF) outbuf_flush(b);
+    return b->buff+b->n;
+}
+/* output string to buffer ---------------------------------------------------*/
+static void outbuf_puts(outbuf_t *b, const char *str, int n)
+{
+    if (n>MAXOUTBUF) {
+        outbuf_flush(b);
+        if (fwrite(str,1,n,b->fp)!=(size_t)n) b->stat=0;
+        return;
+    }
+    memcpy(outbuf_ptr(b,n),str,n);
+    b->n+=n;
+}
+/* output formatted string to buffer -----------------------------------------*/
+static void outbuf_printf(outbuf_t *b, const char *format, ...)
+{
+    va_list ap;
+    char buff[1024];
+    int n;
+
+    va_start(ap,format);
+    n=vsnprintf(buff,sizeof(buff),format,ap);
+    va_end(ap);
+    if (n>=(int)sizeof(buff)) n=(int)sizeof(buff)-1;
+    if (n>0) outbuf_puts(b,buff,n);
+}
 /* output observation data field ---------------------------------------------*/
-static void outrnxobsf(FILE *fp, double obs, int lli, int std)
+static void outrnxobsf(outbuf_t *b, double obs, int lli, int std)
 {
+    char *p=outbuf_ptr(b,64),str[64];
+    int n;
+
     if (obs==0.0) {
-        fprintf(fp,"              ");
-    }
-    else {
-        fprintf(fp,"%14.3f",fmod(obs,1e9));
-    }
-    if (lli<0||!(lli&(LLI_SLIP|LLI_HALFC|LLI_BOCTRK))) {
-        fprintf(fp," ");
+        memset(p,' ',14);
+        p+=14;
     }
-    else {
-        fprintf(fp,"%1.1d",lli&(LLI_SLIP|LLI_HALFC|LLI_BOCTRK));
+    else { /* %14.3f */
+        n=fix2str(str,sizeof(str),fmod(obs,1e9),3);
+        if (n<14) {
+            memset(p,' ',14-n);
+            p+=14-n;
+        }
+        memcpy(p,str,n);
+        p+=n;
     }
-    if (std<=0) fprintf(fp," "); else fprintf(fp,"%1.1x", std > 9 ? 9 : std);
+    lli=lli<0?0:lli&(LLI_SLIP|LLI_HALFC|LLI_BOCTRK);
+    *p++=lli?(char)('0'+lli):' ';
+    *p++=std<=0?' ':(char)('0'+(std>9?9:std));
+    b->n=(int)(p-b->buff);
 }
 /* search observation data index -------------------------------------------*/
 static int obsindex(int rnxver, int sys, const uint8_t *code, const char *tobs,
@@ -2399,7 +2845,7 @@ static int obsindex(int rnxver, int sys, const uint8_t *code, const char *tobs,
     return -1;
 }
 /* output rinex event time ---------------------------------------------------*/
-static void outrinexevent(FILE *fp, const rnxopt_t *opt, const obsd_t *obs,
+static void outrinexevent(outbuf_t *b, const rnxopt_t *opt, const obsd_t *obs,
                           const double epdiff)
 {
     int n;
@@ -2414,21 +2860,21 @@ static void outrinexevent(FILE *fp, const rnxopt_t *opt, const obsd_t *obs,
     n = obs->timevalid ? 0 : 1;
 
     if (opt->rnxver<=299) { /* ver.2 */
-        if (epdiff < 0) fprintf(fp,"\n");
-        fprintf(fp," %02d %02.0f %02.0f %02.0f %02.0f%11.7f  %d%3d",
-                (int)epe[0]%100,epe[1],epe[2],epe[3],epe[4],epe[5],5,n);
-        if (epdiff >= 0) fprintf(fp,"\n");
+        if (epdiff < 0) outbuf_puts(b,"\n",1);
+        outbuf_printf(b," %02d %02.0f %02.0f %02.0f %02.0f%11.7f  %d%3d",
+                      (int)epe[0]%100,epe[1],epe[2],epe[3],epe[4],epe[5],5,n);
+        if (epdiff >= 0) outbuf_puts(b,"\n",1);
     } else if (opt->rnxver <= 401) { // Ver 3, 4.00 and 4.01.
-        fprintf(fp,"> %04.0f %02.0f %02.0f %02.0f %02.0f%11.7f  %d%3d\n",
-                epe[0],epe[1],epe[2],epe[3],epe[4],epe[5],5,n);
+        outbuf_printf(b,"> %04.0f %02.0f %02.0f %02.0f %02.0f%11.7f  %d%3d\n",
+                      epe[0],epe[1],epe[2],epe[3],epe[4],epe[5],5,n);
     } else { // Ver 4.02
       char sbuf[20];
       snprintf(sbuf, sizeof(sbuf), "%16.12lf", epe[5]);
       if (strlen(sbuf) >= 16 && strcmp(sbuf + 11, "00000") == 0) sbuf[11] = '\0';
-      fprintf(fp,"> %04.0f %02.0f %02.0f %02.0f %02.0f%11.11s  %d%3d%21s%5.5s\n",
-              epe[0], epe[1], epe[2], epe[3], epe[4], sbuf, 5, n, "", sbuf + 11);
+      outbuf_printf(b,"> %04.0f %02.0f %02.0f %02.0f %02.0f%11.11s  %d%3d%21s%5.5s\n",
+                    epe[0], epe[1], epe[2], epe[3], epe[4], sbuf, 5, n, "", sbuf + 11);
     }
-    if (n) fprintf(fp,"%-60.60s%-20s\n"," Time mark is not valid","COMMENT");
+    if (n) outbuf_printf(b,"%-60.60s%-20s\n"," Time mark is not valid","COMMENT");
 }
 /* output RINEX observation data body ------------------------------------------
 * output RINEX observation data body
@@ -2438,10 +2884,13 @@ static void outrinexevent(FILE *fp, const rnxopt_t *opt, const obsd_t *obs,
 *          int    n         I   number of observation data
 *          int    flag      I   epoch flag (0:ok,1:power failure,>1:event flag)
 * return : status (1:ok, 0:output error)
+* notes  : the fields are formatted to a buffer and the epoch is written by
+*          fwrite() at once
 *-----------------------------------------------------------------------------*/
 int outrnxobsb(FILE *fp, const rnxopt_t *opt, const obsd_t *obs, int n,
                       int flag)
 {
+    outbuf_t b;
     double epdiff,ep[6],dL;
     char sats[MAXOBS][4]={""};
     int i,k,ns,sys,ind[MAXOBS],s[MAXOBS]={0};
@@ -2474,28 +2923,31 @@ int outrnxobsb(FILE *fp, const rnxopt_t *opt, const obsd_t *obs, int n,
         ind[ns++] = i;
     }
     if (ns<=0) return 1;
+
+    outbuf_init(&b,fp);
+
     /* if epoch of event less than epoch of observation, then first output
     time mark, else first output observation record */
     epdiff = timediff(obs[0].time,obs[0].eventime);
     if (flag == 5 && epdiff >= 0) {
-        outrinexevent(fp, opt, obs, epdiff);
+        outrinexevent(&b, opt, obs, epdiff);
     }
     if (opt->rnxver<=299) { /* ver.2 */
-        fprintf(fp," %02d %02.0f %02.0f %02.0f %02.0f %010.7f  %d%3d",
-                (int)ep[0]%100,ep[1],ep[2],ep[3],ep[4],ep[5],0,ns);
+        outbuf_printf(&b," %02d %02.0f %02.0f %02.0f %02.0f %010.7f  %d%3d",
+                      (int)ep[0]%100,ep[1],ep[2],ep[3],ep[4],ep[5],0,ns);
         for (i=0;i<ns;i++) {
-            if (i>0&&i%12==0) fprintf(fp,"\n%32s","");
-            fprintf(fp,"%-3s",sats[i]);
+            if (i>0&&i%12==0) outbuf_printf(&b,"\n%32s","");
+            outbuf_printf(&b,"%-3s",sats[i]);
         }
     } else if (opt->rnxver <= 401) { // Ver 3, 4.00 and 4.01.
-      fprintf(fp,"> %04.0f %02.0f %02.0f %02.0f %02.0f %010.7f  %d%3d%21s\n",
-              ep[0],ep[1],ep[2],ep[3],ep[4],ep[5],0,ns,"");
+      outbuf_printf(&b,"> %04.0f %02.0f %02.0f %02.0f %02.0f %010.7f  %d%3d%21s\n",
+                    ep[0],ep[1],ep[2],ep[3],ep[4],ep[5],0,ns,"");
     } else { // Ver 4.02
       char sbuf[20];
       snprintf(sbuf, sizeof(sbuf), "%16.12lf", ep[5]);
       if (strlen(sbuf) >= 16 && strcmp(sbuf + 11, "00000") == 0) sbuf[11] = '\0';
-      fprintf(fp,"> %04.0f %02.0f %02.0f %02.0f %02.0f%11.11s  %d%3d%21s%5.5s\n",
-              ep[0], ep[1], ep[2], ep[3], ep[4], sbuf, 0, ns, "", sbuf + 11);
+      outbuf_printf(&b,"> %04.0f %02.0f %02.0f %02.0f %02.0f%11.11s  %d%3d%21s%5.5s\n",
+                    ep[0], ep[1], ep[2], ep[3], ep[4], sbuf, 0, ns, "", sbuf + 11);
     }
     for (i=0;i<ns;i++) {
         sys = satsyst(obs[ind[i]].sat, obs[ind[i]].time, NULL);
@@ -2507,19 +2959,19 @@ int outrnxobsb(FILE *fp, const rnxopt_t *opt, const obsd_t *obs, int n,
             mask=opt->mask[s[i]];
         }
         else { /* ver.3 */
-            fprintf(fp,"%-3s",sats[i]);
+            outbuf_printf(&b,"%-3s",sats[i]);
             m=s[i];
             mask=opt->mask[m];
         }
         for (int j=0;j<opt->nobs[m];j++) {
 
             if (opt->rnxver<=299) { /* ver.2 */
-                if (j%5==0) fprintf(fp,"\n");
+                if (j%5==0) outbuf_puts(&b,"\n",1);
             }
             /* search obs data index */
             if ((k=obsindex(opt->rnxver,sys,obs[ind[i]].code,opt->tobs[m][j],
                             mask))<0) {
-                outrnxobsf(fp,0.0,-1,-1);
+                outrnxobsf(&b,0.0,-1,-1);
                 continue;
             }
             /* phase shift (cyc) */
@@ -2532,17 +2984,17 @@ int outrnxobsb(FILE *fp, const rnxopt_t *opt, const obsd_t *obs, int n,
                   // To RTKLib RINEX encoding
                   float std = obs[ind[i]].Pstd[k];
                   int stdi = std > 0.0003125 ? (int)trunc(log2(std * 100) - 5 + 0.5) : 0;
-                  outrnxobsf(fp,obs[ind[i]].P[k],-1,stdi);
+                  outrnxobsf(&b,obs[ind[i]].P[k],-1,stdi);
                   break;
                 }
                 case 'L': {
                   // To RTKLib RINEX encoding
                   int lstdi = (int)trunc(obs[ind[i]].Lstd[k] / 0.004 + 0.5);
-                  outrnxobsf(fp,obs[ind[i]].L[k]+dL,obs[ind[i]].LLI[k],lstdi);
+                  outrnxobsf(&b,obs[ind[i]].L[k]+dL,obs[ind[i]].LLI[k],lstdi);
                   break;
                 }
-                case 'D': outrnxobsf(fp,obs[ind[i]].D[k],-1,-1); break;
-                case 'S': outrnxobsf(fp,obs[ind[i]].SNR[k],-1,-1); break;
+                case 'D': outrnxobsf(&b,obs[ind[i]].D[k],-1,-1); break;
+                case 'S': outrnxobsf(&b,obs[ind[i]].SNR[k],-1,-1); break;
             }
         }
 
@@ -2558,18 +3010,416 @@ int outrnxobsb(FILE *fp, const rnxopt_t *opt, const obsd_t *obs, int n,
         }
 #endif
 
-        if (opt->rnxver>=300&&fprintf(fp,"\n")==EOF) return 0;
+        if (opt->rnxver>=300) outbuf_puts(&b,"\n",1);
     }
 
     if (flag == 5 && epdiff < 0) {
-        outrinexevent(fp, opt, obs, epdiff);
+        outrinexevent(&b, opt, obs, epdiff);
     }
-    if (opt->rnxver>=300) return 1;
+    if (opt->rnxver<=299) outbuf_puts(&b,"\n",1);
 
-    return fprintf(fp,"\n")!=EOF;
+    return outbuf_flush(&b);
 }
-/* output data field in RINEX navigation data --------------------------------*/
-static void outnavf_n(FILE *fp, double value, int n)
+/* get line of RINEX text to be compacted (NULL: no complete line) -----------*/
+static const char *crxgetline(const char *p, const char *end, char *line)
+{
+    const char *q=(const char *)memchr(p,'\n',end-p);
+    int n;
+
+    if (!q) return NULL;
+    n=(int)(q-p);
+    if (n>0&&p[n-1]=='\r') n--;
+    if (n>MAXCRXLEN-1) n=MAXCRXLEN-1;
+    memcpy(line,p,n);
+    line[n]='\0';
+    return q+1;
+}
+/* trim trailing spaces ------------------------------------------------------*/
+static void crxtrim(char *str)
+{
+    char *p=str+strlen(str);
+
+    while (p>str&&p[-1]==' ') p--;
+    *p='\0';
+}
+/* text difference of compact RINEX ------------------------------------------
+* the string is updated as it is repaired by the difference in the decoder */
+static void crxtextdiff(char *str, const char *s, char *diff)
+{
+    int i,k=0,n=(int)strlen(str),m=(int)strlen(s);
+    char c;
+
+    for (i=0;i<n||i<m;i++) {
+        c=i<m?s[i]:' ';
+        if (i>=n) diff[i]=c;
+        else if (str[i]==c) diff[i]=' ';
+        else diff[i]=c==' '?'&':c;
+        if (diff[i]!=' ') k=i+1;
+    }
+    diff[k]='\0';
+    for (i=0;i<k;i++) {
+        if (i>=n) str[i]=diff[i]=='&'?' ':diff[i];
+        else if (diff[i]=='&') str[i]=' ';
+        else if (diff[i]!=' ') str[i]=diff[i];
+    }
+    if (k>n) str[k]='\0';
+}
+/* fixed-point value of RINEX field (1:ok,0:blank,-1:error) ------------------*/
+static int crxfix(const char *p, int n, int dec, int64_t *v)
+{
+    int64_t a=0;
+    int i,sgn=0,dig=0,d=-1;
+
+    for (i=0;i<n&&p[i];i++) {
+        if (p[i]==' ') {
+            if (sgn||dig||d>=0) return -1;
+        }
+        else if (p[i]=='-'&&!sgn&&!dig&&d<0) sgn=1;
+        else if (p[i]=='.'&&d<0) d=0;
+        else if (p[i]>='0'&&p[i]<='9') {
+            a=a*10+(p[i]-'0');
+            dig++;
+            if (d>=0) d++;
+        }
+        else return -1;
+    }
+    if (!dig) return sgn||d>=0?-1:0;
+    if (d>dec||dig>18) return -1;
+    for (d=d<0?0:d;d<dec;d++) a*=10;
+    *v=sgn?-a:a;
+    return 1;
+}
+/* encode value by data arc of compact RINEX ---------------------------------*/
+static char *crxarc(char *p, crxdarc_t *a, int64_t v)
+{
+    int64_t d=v;
+    int k;
+
+    if (a->order<0) { /* initialize arc */
+        a->order=0;
+        a->d[0]=v;
+        return p+sprintf(p,"%d&%lld",CRXORDER,(long long)v);
+    }
+    if (a->order<CRXORDER) a->order++;
+    for (k=0;k<a->order;k++) d-=a->d[k];
+    a->d[a->order]=d;
+    for (k=a->order-1;k>=0;k--) a->d[k]+=a->d[k+1];
+    return p+sprintf(p,"%lld",(long long)d);
+}
+/* number of obs types in header line of RINEX -------------------------------*/
+static void crxtypes(crxstat_t *s, int ver, const char *line)
+{
+    if (strlen(line)<60) return;
+    if (ver==1&&strstr(line+60,"# / TYPES OF OBSERV")) {
+        if (line[5]!=' ') s->ntype[0]=(int)str2num(line,0,6);
+    }
+    else if (ver==3&&strstr(line+60,"SYS / # / OBS TYPES")) {
+        if (line[0]!=' ') s->ntype[(uint8_t)line[0]]=(int)str2num(line,3,3);
+    }
+}
+/* skip lines of RINEX text (NULL: incomplete) -------------------------------*/
+static const char *crxskip(const char *p, const char *end, int n)
+{
+    for (;p&&n>0;n--) {
+        if ((p=(const char *)memchr(p,'\n',end-p))) p++;
+    }
+    return p;
+}
+/* encode epoch of RINEX text (1:ok,0:incomplete,-1:error) -------------------*/
+static int crxepoch(crxenc_t *crx, crxstat_t *s, const char **text,
+                    const char *end)
+{
+    char line[MAXCRXLEN],data[MAXCRXLEN*2],diff[MAXCRXLEN],flag[2*MAXOBSTYPE+1];
+    char *q;
+    const char *p,*r,*id;
+    crxesat_t *sat;
+    int64_t v;
+    int i,j,k,n,ev,nsat,ntype,nl,prn,key,clk,v1=crx->ver==1,stat;
+
+    if (!(p=crxgetline(*text,end,line))) return 0;
+    crxtrim(line);
+    if (!*line) { /* blank line */
+        *text=p;
+        return 1;
+    }
+    n=(int)strlen(line);
+    k=v1?28:31;
+    ev=n>k&&line[k]>='2'&&line[k]<='5';
+    nsat=(int)str2num(line,k+1,3);
+    if (nsat<0||nsat>999) return -1;
+    ntype=s->ntype[0];
+    if (ev) nl=nsat;
+    else if (!v1) nl=nsat;
+    else if (ntype<=0||ntype>MAXOBSTYPE) return -1;
+    else nl=(nsat+11)/12-(nsat>0)+nsat*((ntype+4)/5);
+    if (!crxskip(p,end,nl)) return 0;
+
+    /* event records copied */
+    if (ev) {
+        line[0]=v1?'&':'>';
+        fprintf(crx->fp,"%s\n",line);
+        for (i=0;i<nsat;i++) {
+            p=crxgetline(p,end,line);
+            crxtypes(s,crx->ver,line);
+            fprintf(crx->fp,"%s\n",line);
+        }
+        s->init=1;
+        *text=p;
+        return 1;
+    }
+    /* epoch line with satellite list */
+    k=v1?32:41;
+    memset(data,' ',k);
+    memcpy(data,line,n<(v1?32:35)?n:(v1?32:35));
+    clk=v1?(n>68?crxfix(line+68,12,9,&v):0):(n>41?crxfix(line+41,15,12,&v):0);
+    if (clk<0) return -1;
+    for (i=0,r=p;i<nsat;i++) {
+        if (v1) {
+            if (i>0&&i%12==0) r=crxgetline(r,end,line);
+            id=line+32+i%12*3;
+            if ((int)strlen(line)<32+i%12*3+3) return -1;
+        }
+        else {
+            id=r;
+            r=crxskip(r,end,1);
+            if (r-id<4) return -1;
+        }
+        memcpy(data+k+i*3,id,3);
+    }
+    data[k+nsat*3]='\0';
+    if (v1) p=r; /* records after continuation lines */
+
+    if (!s->init) {
+        crxtextdiff(s->epoch,data,diff);
+        if (!*diff) s->init=1; /* same epoch line */
+    }
+    if (s->init) {
+        data[0]=v1?'&':'>';
+        s->epoch[0]='\0';
+        s->clk.order=-1;
+        s->iep++; /* no previous epoch */
+        crxtextdiff(s->epoch,data,diff);
+        s->init=0;
+    }
+    if (v1) s->epoch[0]=' ';
+    fprintf(crx->fp,"%s\n",diff);
+
+    /* receiver clock offset */
+    if (clk) crxarc(line,&s->clk,v);
+    else {
+        s->clk.order=-1;
+        line[0]='\0';
+    }
+    fprintf(crx->fp,"%s\n",line);
+    s->iep++;
+
+    /* observation data records */
+    for (i=0;i<nsat;i++) {
+        id=s->epoch+k+i*3;
+        prn=(id[1]==' '?0:id[1]-'0')*10+(id[2]-'0');
+        if (prn<0||prn>99||id[2]<'0'||id[2]>'9') return -1;
+        key=(uint8_t)(id[0]==' '?'G':id[0])*100+prn;
+        ntype=s->ntype[v1?0:(uint8_t)(id[0]==' '?'G':id[0])];
+        if (ntype<=0||ntype>MAXOBSTYPE) return -1;
+
+        /* record fields padded by spaces */
+        memset(data,' ',16*MAXOBSTYPE+3);
+        for (j=0;j<(v1?(ntype+4)/5:1);j++) {
+            p=crxgetline(p,end,line);
+            n=(int)strlen(line);
+            if (v1) memcpy(data+j*80,line,n<80?n:80);
+            else memcpy(data,line,n<16*ntype+3?n:16*ntype+3);
+        }
+        r=v1?data:data+3;
+
+        if (!s->sat[key]&&!(s->sat[key]=(crxesat_t *)calloc(1,sizeof(crxesat_t)))) {
+            return -1;
+        }
+        sat=s->sat[key];
+        if (sat->iep!=s->iep-1) { /* no previous epoch */
+            for (j=0;j<MAXOBSTYPE;j++) sat->arc[j].order=-1;
+            sat->flag[0]='\0';
+        }
+        sat->iep=s->iep;
+
+        for (j=0,q=line;j<ntype;j++) {
+            if (j>0) *q++=' ';
+            if ((stat=crxfix(r+j*16,14,3,&v))<0) return -1;
+            if (stat) q=crxarc(q,sat->arc+j,v);
+            else sat->arc[j].order=-1;
+            flag[j*2  ]=r[j*16+14];
+            flag[j*2+1]=r[j*16+15];
+        }
+        flag[ntype*2]='\0';
+        crxtrim(flag);
+        crxtextdiff(sat->flag,flag,diff);
+        sprintf(q," %s",diff);
+        crxtrim(line);
+        fprintf(crx->fp,"%s\n",line);
+    }
+    *text=p;
+    return 1;
+}
+/* read RINEX text to be compacted -------------------------------------------*/
+static int crxread(crxenc_t *crx, crxstat_t *s)
+{
+    char *buff;
+    long n;
+
+    if (fflush(crx->tmp)||ferror(crx->tmp)||(n=ftell(crx->tmp))<0) {
+        trace(2,"compact rinex text read error\n");
+        return 0;
+    }
+    if (s->n+n+1>s->nmax) {
+        s->nmax=s->n+n+1>2*s->nmax?s->n+n+1:2*s->nmax;
+        if (!(buff=(char *)realloc(s->buff,s->nmax))) return 0;
+        s->buff=buff;
+    }
+#ifdef WIN32
+    rewind(crx->tmp);
+    if (fread(s->buff+s->n,1,n,crx->tmp)!=(size_t)n) return 0;
+#else
+    if (n>0) memcpy(s->buff+s->n,s->mbuf,n);
+#endif
+    s->n+=n;
+    rewind(crx->tmp);
+    return 1;
+}
+/* initialize compact RINEX encoder --------------------------------------------
+* initialize compact RINEX (hatanaka-compression) encoder
+* args   : crxenc_t *crx    IO  compact RINEX encoder
+*          FILE   *fp       I   compact RINEX output file
+*          int    rnxver    I   RINEX version (x100)
+* return : status (1:ok,0:memory allocation error or version not supported)
+* notes  : the RINEX OBS header and data records written to crx->tmp by
+*          outrnxobsh() and outrnxobsb() are encoded to compact RINEX ver.1.0
+*          (RINEX 2) or ver.3.0 (RINEX 3 and 4) by outcrxh() and outcrxb().
+*          the data arcs are differenced by 3rd order. RINEX 4.02 is not
+*          supported for the extended seconds field in the epoch line.
+*          crx->tmp is a growable memory stream (a temporary file for WIN32),
+*          so an epoch is not limited in size.
+*-----------------------------------------------------------------------------*/
+int init_crxenc(crxenc_t *crx, FILE *fp, int rnxver)
+{
+    crxstat_t *s;
+
+    trace(3,"init_crxenc: rnxver=%d\n",rnxver);
+
+    crx->fp=fp;
+    crx->ver=rnxver<=299?1:3;
+    crx->tmp=NULL;
+    crx->state=NULL;
+    if (rnxver>401) {
+        trace(2,"compact rinex not supported: rnxver=%d\n",rnxver);
+        return 0;
+    }
+    if (!(s=(crxstat_t *)calloc(1,sizeof(crxstat_t)))) return 0;
+#ifdef WIN32
+    crx->tmp=tmpfile();
+#else
+    crx->tmp=open_memstream(&s->mbuf,&s->msize);
+#endif
+    if (!crx->tmp) {
+        free(s);
+        return 0;
+    }
+    s->init=1;
+    s->clk.order=-1;
+    crx->state=s;
+    return 1;
+}
+/* free compact RINEX encoder --------------------------------------------------
+* free compact RINEX encoder
+* args   : crxenc_t *crx    IO  compact RINEX encoder
+* return : none
+* notes  : the compact RINEX output file is not closed
+*-----------------------------------------------------------------------------*/
+void free_crxenc(crxenc_t *crx)
+{
+    crxstat_t *s=(crxstat_t *)crx->state;
+    int i;
+
+    trace(3,"free_crxenc:\n");
+
+    if (crx->tmp) fclose(crx->tmp);
+    if (s) {
+        for (i=0;i<256*100;i++) free(s->sat[i]);
+        free(s->buff);
+        free(s->mbuf);
+        free(s);
+    }
+    crx->tmp=NULL;
+    crx->state=NULL;
+}
+/* output compact RINEX header -------------------------------------------------
+* encode RINEX OBS header written to crx->tmp to compact RINEX
+* args   : crxenc_t *crx    IO  compact RINEX encoder
+* return : status (1:ok, 0:output error)
+* notes  : the header is output at the current position of crx->fp. the same
+*          program/date line is output if the header is rewritten.
+*-----------------------------------------------------------------------------*/
+int outcrxh(crxenc_t *crx)
+{
+    static const char *mon[]={
+        "Jan","Feb","Mar","Apr","May","Jun","Jul","Aug","Sep","Oct","Nov","Dec"
+    };
+    crxstat_t *s=(crxstat_t *)crx->state;
+    char line[MAXCRXLEN],date[32];
+    const char *p,*end;
+    double ep[6];
+
+    trace(3,"outcrxh:\n");
+
+    s->n=0;
+    if (!crxread(crx,s)) return 0;
+    if (!*s->prog) {
+        time2epoch(timeget(),ep);
+        sprintf(date,"%02d-%s-%02d %02d:%02d",(int)ep[2],mon[(int)ep[1]-1],
+                (int)ep[0]%100,(int)ep[3],(int)ep[4]);
+        sprintf(s->prog,"%-40.40s%-20.20s%-20s","RTKLIB "VER_RTKLIB" "PATCH_LEVEL,
+                date,"CRINEX PROG / DATE");
+    }
+    fprintf(crx->fp,"%-20s%-40s%-20s\n",crx->ver==1?"1.0":"3.0",
+            "COMPACT RINEX FORMAT","CRINEX VERS   / TYPE");
+    fprintf(crx->fp,"%s\n",s->prog);
+
+    for (p=s->buff,end=s->buff+s->n;(p=crxgetline(p,end,line));) {
+        crxtypes(s,crx->ver,line);
+        fprintf(crx->fp,"%s\n",line);
+    }
+    s->n=0;
+    return !ferror(crx->fp);
+}
+/* output compact RINEX body ---------------------------------------------------
+* encode RINEX OBS data records written to crx->tmp to compact RINEX
+* args   : crxenc_t *crx    IO  compact RINEX encoder
+* return : status (1:ok, 0:output error)
+* notes  : incomplete epoch records are kept and encoded with the next records
+*-----------------------------------------------------------------------------*/
+int outcrxb(crxenc_t *crx)
+{
+    crxstat_t *s=(crxstat_t *)crx->state;
+    const char *p,*end;
+    int stat=1;
+
+    trace(4,"outcrxb:\n");
+
+    if (!crxread(crx,s)) return 0;
+
+    for (p=s->buff,end=s->buff+s->n;p<end&&(stat=crxepoch(crx,s,&p,end))>0;) ;
+    if (stat<0) {
+        trace(2,"compact rinex encode error\n");
+        s->n=0;
+        return 0;
+    }
+    s->n=end-p;
+    memmove(s->buff,p,s->n);
+    return !ferror(crx->fp);
+}
+/* data field in RINEX navigation data ---------------------------------------
+* format "%s%0*.*lf%s%+03.0lf" of sign, mantissa and exponent by fix2str(),
+* return length of field (str: at least 64 bytes) */
+static int navfstr(char *str, double value, int n)
 {
     double e = (fabs(value) < 1E-99) ? 0.0 : floor(log10(fabs(value)));
     int d = n + 2; // Leading digit, decimal point, n decimal places
@@ -2578,11 +3428,36 @@ static void outnavf_n(FILE *fp, double value, int n)
         v *= 0.1;
         e += 1.0;
     }
-    fprintf(fp, "%s%0*.*lf%s%+03.0lf", value < 0.0 ? "-" : " ", d, n, v, NAVEXP, e);
+    if (!isfinite(v)||!isfinite(e)||fabs(e)>999.0||n>17) {
+        int len = snprintf(str, 64, "%s%0*.*lf%s%+03.0lf", value < 0.0 ? "-" : " ",
+                           d, n, v, NAVEXP, e);
+        return len < 64 ? len : 63;
+    }
+    char *p = str, buff[40];
+    int len = fix2str(buff, sizeof(buff), v, n);
+    *p++ = value < 0.0 ? '-' : ' ';
+    for (; len < d; d--) *p++ = '0';
+    memcpy(p, buff, len);
+    p += len;
+    *p++ = NAVEXP[0];
+    int ie = (int)e;
+    *p++ = ie < 0 ? '-' : '+';
+    if (ie < 0) ie = -ie;
+    if (ie >= 100) *p++ = (char)('0' + ie / 100);
+    *p++ = (char)('0' + ie / 10 % 10);
+    *p++ = (char)('0' + ie % 10);
+    *p = '\0';
+    return (int)(p - str);
+}
+static void outnavf_n(FILE *fp, double value, int n)
+{
+    char str[64];
+    fputs(navfstr(str, value, n) > 0 ? str : "", fp);
 }
-static void outnavf(FILE *fp, double value)
+static void outnavf(outbuf_t *b, double value)
 {
-    outnavf_n(fp,value,12);
+    char *p = outbuf_ptr(b, 64);
+    b->n += navfstr(p, value, 12);
 }
 /* output iono correction for a system ---------------------------------------*/
 static void out_iono_sys(FILE *fp, const char *sys, const double *ion, int n)
@@ -2762,6 +3637,7 @@ int outrnxnavh(FILE *fp, const rnxopt_t *opt, const nav_t *nav)
 *-----------------------------------------------------------------------------*/
 int outrnxnavb(FILE *fp, const rnxopt_t *opt, const eph_t *eph)
 {
+    outbuf_t b;
     double ep[6],ttr;
     int week;
     char code[32],*sep;
@@ -2776,101 +3652,104 @@ int outrnxnavb(FILE *fp, const rnxopt_t *opt, const eph_t *eph)
     } else {
         time2epoch(eph->toc,ep);
     }
+    outbuf_init(&b,fp);
+
     if ((opt->rnxver>=300&&sys==SYS_GPS)||(opt->rnxver>=212&&sys==SYS_GAL)||
         (opt->rnxver>=302&&sys==SYS_QZS)||(opt->rnxver>=302&&(sys & SYS_BDS))||
         (opt->rnxver>=303&&sys==SYS_IRN)) {
         if (!sat2code(eph->sat,code)) return 0;
-        fprintf(fp,"%-3s %04.0f %02.0f %02.0f %02.0f %02.0f %02.0f",code,ep[0],
-                ep[1],ep[2],ep[3],ep[4],ep[5]);
+        outbuf_printf(&b,"%-3s %04.0f %02.0f %02.0f %02.0f %02.0f %02.0f",code,
+                      ep[0],ep[1],ep[2],ep[3],ep[4],ep[5]);
         sep="    ";
     }
     else if (opt->rnxver<=299&&sys==SYS_GPS) {
-        fprintf(fp,"%2d %02d %02.0f %02.0f %02.0f %02.0f %04.1f",prn,
-                (int)ep[0]%100,ep[1],ep[2],ep[3],ep[4],ep[5]);
+        outbuf_printf(&b,"%2d %02d %02.0f %02.0f %02.0f %02.0f %04.1f",prn,
+                      (int)ep[0]%100,ep[1],ep[2],ep[3],ep[4],ep[5]);
         sep="   ";
     }
     else {
         return 0;
     }
-    outnavf(fp,eph->f0     );
-    outnavf(fp,eph->f1     );
-    outnavf(fp,eph->f2     );
-    fprintf(fp,"\n%s",sep  );
-
-    outnavf(fp,eph->iode   ); /* GPS/QZS: IODE, GAL: IODnav, BDS: AODE */
-    outnavf(fp,eph->crs    );
-    outnavf(fp,eph->deln   );
-    outnavf(fp,eph->M0     );
-    fprintf(fp,"\n%s",sep  );
-
-    outnavf(fp,eph->cuc    );
-    outnavf(fp,eph->e      );
-    outnavf(fp,eph->cus    );
-    outnavf(fp,sqrt(eph->A));
-    fprintf(fp,"\n%s",sep  );
-
-    outnavf(fp,eph->toes   );
-    outnavf(fp,eph->cic    );
-    outnavf(fp,eph->OMG0   );
-    outnavf(fp,eph->cis    );
-    fprintf(fp,"\n%s",sep  );
-
-    outnavf(fp,eph->i0     );
-    outnavf(fp,eph->crc    );
-    outnavf(fp,eph->omg    );
-    outnavf(fp,eph->OMGd   );
-    fprintf(fp,"\n%s",sep  );
-
-    outnavf(fp,eph->idot   );
-    outnavf(fp,eph->code   );
-    outnavf(fp,eph->week   ); /* GPS/QZS: GPS week, GAL: GAL week, BDS: BDT week */
+    outnavf(&b,eph->f0     );
+    outnavf(&b,eph->f1     );
+    outnavf(&b,eph->f2     );
+    outbuf_printf(&b,"\n%s",sep);
+
+    outnavf(&b,eph->iode   ); /* GPS/QZS: IODE, GAL: IODnav, BDS: AODE */
+    outnavf(&b,eph->crs    );
+    outnavf(&b,eph->deln   );
+    outnavf(&b,eph->M0     );
+    outbuf_printf(&b,"\n%s",sep);
+
+    outnavf(&b,eph->cuc    );
+    outnavf(&b,eph->e      );
+    outnavf(&b,eph->cus    );
+    outnavf(&b,sqrt(eph->A));
+    outbuf_printf(&b,"\n%s",sep);
+
+    outnavf(&b,eph->toes   );
+    outnavf(&b,eph->cic    );
+    outnavf(&b,eph->OMG0   );
+    outnavf(&b,eph->cis    );
+    outbuf_printf(&b,"\n%s",sep);
+
+    outnavf(&b,eph->i0     );
+    outnavf(&b,eph->crc    );
+    outnavf(&b,eph->omg    );
+    outnavf(&b,eph->OMGd   );
+    outbuf_printf(&b,"\n%s",sep);
+
+    outnavf(&b,eph->idot   );
+    outnavf(&b,eph->code   );
+    outnavf(&b,eph->week   ); /* GPS/QZS: GPS week, GAL: GAL week, BDS: BDT week */
     if (sys==SYS_GPS||sys==SYS_QZS) {
-        outnavf(fp,eph->flag);
+        outnavf(&b,eph->flag);
     }
     else {
-        outnavf(fp,0.0); /* spare */
+        outnavf(&b,0.0); /* spare */
     }
-    fprintf(fp,"\n%s",sep  );
+    outbuf_printf(&b,"\n%s",sep);
 
     if (sys==SYS_GAL) {
-        outnavf(fp,sisa_value(eph->sva));
+        outnavf(&b,sisa_value(eph->sva));
     }
     else {
-        outnavf(fp,uravalue(eph->sva));
+        outnavf(&b,uravalue(eph->sva));
     }
-    outnavf(fp,eph->svh    );
-    outnavf(fp,eph->tgd[0] ); /* GPS/QZS:TGD, GAL:BGD E5a/E1, BDS: TGD1 B1/B3 */
+    outnavf(&b,eph->svh    );
+    outnavf(&b,eph->tgd[0] ); /* GPS/QZS:TGD, GAL:BGD E5a/E1, BDS: TGD1 B1/B3 */
     if (sys==SYS_GAL||(sys & SYS_BDS)) {
-        outnavf(fp,eph->tgd[1]); /* GAL:BGD E5b/E1, BDS: TGD2 B2/B3 */
+        outnavf(&b,eph->tgd[1]); /* GAL:BGD E5b/E1, BDS: TGD2 B2/B3 */
     }
     else if (sys==SYS_GPS||sys==SYS_QZS) {
-        outnavf(fp,eph->iodc);   /* GPS/QZS:IODC */
+        outnavf(&b,eph->iodc);   /* GPS/QZS:IODC */
     }
     else {
-        outnavf(fp,0.0); /* spare */
+        outnavf(&b,0.0); /* spare */
     }
-    fprintf(fp,"\n%s",sep  );
+    outbuf_printf(&b,"\n%s",sep);
 
     if (sys & SYS_BDS) {
         ttr=time2bdt(gpst2bdt(eph->ttr),&week); /* gpst -> bdt */
     } else {
         ttr=time2gpst(eph->ttr,&week);
     }
-    outnavf(fp,ttr+(week-eph->week)*604800.0);
+    outnavf(&b,ttr+(week-eph->week)*604800.0);
 
     if (sys==SYS_GPS) {
-        outnavf(fp,eph->fit);
+        outnavf(&b,eph->fit);
     }
     else if (sys==SYS_QZS) {
-        outnavf(fp,eph->fit>2?1.0:0.0);
+        outnavf(&b,eph->fit>2?1.0:0.0);
     }
     else if (sys & SYS_BDS) {
-        outnavf(fp,eph->iodc); /* AODC */
+        outnavf(&b,eph->iodc); /* AODC */
     }
     else {
-        outnavf(fp,0.0); /* spare */
+        outnavf(&b,0.0); /* spare */
     }
-    return fprintf(fp,"\n")!=EOF;
+    outbuf_puts(&b,"\n",1);
+    return outbuf_flush(&b);
 }
 /* output RINEX GNAV file header -----------------------------------------------
 * output RINEX GNAV (GLONASS navigation data) file header
@@ -2917,6 +3796,7 @@ int outrnxgnavh(FILE *fp, const rnxopt_t *opt, const nav_t *nav)
 *-----------------------------------------------------------------------------*/
 int outrnxgnavb(FILE *fp, const rnxopt_t *opt, const geph_t *geph)
 {
+    outbuf_t b;
     gtime_t toe;
     double ep[6],tof;
     int prn;
@@ -2931,48 +3811,50 @@ int outrnxgnavb(FILE *fp, const rnxopt_t *opt, const geph_t *geph)
 
     toe=gpst2utc(geph->toe); /* gpst -> utc */
     time2epoch(toe,ep);
+    outbuf_init(&b,fp);
 
     if (opt->rnxver<=299) { /* ver.2 */
-        fprintf(fp,"%2d %02d %02.0f %02.0f %02.0f %02.0f %04.1f",prn,
-                (int)ep[0]%100,ep[1],ep[2],ep[3],ep[4],ep[5]);
+        outbuf_printf(&b,"%2d %02d %02.0f %02.0f %02.0f %02.0f %04.1f",prn,
+                      (int)ep[0]%100,ep[1],ep[2],ep[3],ep[4],ep[5]);
         sep="   ";
     }
     else { /* ver.3 */
         if (!sat2code(geph->sat,code)) return 0;
-        fprintf(fp,"%-3s %04.0f %02.0f %02.0f %02.0f %02.0f %02.0f",code,ep[0],
-                ep[1],ep[2],ep[3],ep[4],ep[5]);
+        outbuf_printf(&b,"%-3s %04.0f %02.0f %02.0f %02.0f %02.0f %02.0f",code,
+                      ep[0],ep[1],ep[2],ep[3],ep[4],ep[5]);
         sep="    ";
     }
-    outnavf(fp,-geph->taun     );
-    outnavf(fp,geph->gamn      );
-    outnavf(fp,tof             );
-    fprintf(fp,"\n%s",sep      );
+    outnavf(&b,-geph->taun     );
+    outnavf(&b,geph->gamn      );
+    outnavf(&b,tof             );
+    outbuf_printf(&b,"\n%s",sep);
 
-    outnavf(fp,geph->pos[0]/1E3);
-    outnavf(fp,geph->vel[0]/1E3);
-    outnavf(fp,geph->acc[0]/1E3);
-    outnavf(fp,geph->svh & 1   );
-    fprintf(fp,"\n%s",sep      );
+    outnavf(&b,geph->pos[0]/1E3);
+    outnavf(&b,geph->vel[0]/1E3);
+    outnavf(&b,geph->acc[0]/1E3);
+    outnavf(&b,geph->svh & 1   );
+    outbuf_printf(&b,"\n%s",sep);
 
-    outnavf(fp,geph->pos[1]/1E3);
-    outnavf(fp,geph->vel[1]/1E3);
-    outnavf(fp,geph->acc[1]/1E3);
-    outnavf(fp,geph->frq       );
-    fprintf(fp,"\n%s",sep      );
+    outnavf(&b,geph->pos[1]/1E3);
+    outnavf(&b,geph->vel[1]/1E3);
+    outnavf(&b,geph->acc[1]/1E3);
+    outnavf(&b,geph->frq       );
+    outbuf_printf(&b,"\n%s",sep);
 
-    outnavf(fp,geph->pos[2]/1E3);
-    outnavf(fp,geph->vel[2]/1E3);
-    outnavf(fp,geph->acc[2]/1E3);
-    outnavf(fp,geph->age       );
+    outnavf(&b,geph->pos[2]/1E3);
+    outnavf(&b,geph->vel[2]/1E3);
+    outnavf(&b,geph->acc[2]/1E3);
+    outnavf(&b,geph->age       );
 
     if (opt->rnxver>=305) {
-      fprintf(fp,"\n%s",sep     );
-      outnavf(fp,geph->flags    );
-      outnavf(fp,geph->dtaun    );
-      outnavf(fp,geph->sva      );
-      outnavf(fp,(geph->svh >> 1) & 7);
+      outbuf_printf(&b,"\n%s",sep);
+      outnavf(&b,geph->flags    );
+      outnavf(&b,geph->dtaun    );
+      outnavf(&b,geph->sva      );
+      outnavf(&b,(geph->svh >> 1) & 7);
     }
-    return fprintf(fp,"\n")!=EOF;
+    outbuf_puts(&b,"\n",1);
+    return outbuf_flush(&b);
 }
 /* output RINEX GEO navigation data file header --------------------------------
 * output RINEX GEO navigation data file header
@@ -3019,6 +3901,7 @@ int outrnxhnavh(FILE *fp, const rnxopt_t *opt, const nav_t *nav)
 *-----------------------------------------------------------------------------*/
 int outrnxhnavb(FILE *fp, const rnxopt_t *opt, const seph_t *seph)
 {
+    outbuf_t b;
     double ep[6];
     int prn;
     char code[32],*sep;
@@ -3028,41 +3911,43 @@ int outrnxhnavb(FILE *fp, const rnxopt_t *opt, const seph_t *seph)
     if ((satsyst(seph->sat, seph->t0, &prn) & opt->navsys) != SYS_SBS) return 0;
 
     time2epoch(seph->t0,ep);
+    outbuf_init(&b,fp);
 
     if (opt->rnxver<=299) { /* ver.2 */
-        fprintf(fp,"%2d %02d %02.0f %02.0f %02.0f %02.0f %04.1f",prn-100,
-                (int)ep[0]%100,ep[1],ep[2],ep[3],ep[4],ep[5]);
+        outbuf_printf(&b,"%2d %02d %02.0f %02.0f %02.0f %02.0f %04.1f",prn-100,
+                      (int)ep[0]%100,ep[1],ep[2],ep[3],ep[4],ep[5]);
         sep="   ";
     }
     else { /* ver.3 */
         if (!sat2code(seph->sat,code)) return 0;
-        fprintf(fp,"%-3s %04.0f %02.0f %02.0f %02.0f %02.0f %02.0f",code,ep[0],ep[1],
-                ep[2],ep[3],ep[4],ep[5]);
+        outbuf_printf(&b,"%-3s %04.0f %02.0f %02.0f %02.0f %02.0f %02.0f",code,
+                      ep[0],ep[1],ep[2],ep[3],ep[4],ep[5]);
         sep="    ";
     }
-    outnavf(fp,seph->af0          );
-    outnavf(fp,seph->af1          );
-    outnavf(fp,time2gpst(seph->tof,NULL));
-    fprintf(fp,"\n%s",sep         );
-
-    outnavf(fp,seph->pos[0]/1E3   );
-    outnavf(fp,seph->vel[0]/1E3   );
-    outnavf(fp,seph->acc[0]/1E3   );
-    outnavf(fp,seph->svh          );
-    fprintf(fp,"\n%s",sep         );
-
-    outnavf(fp,seph->pos[1]/1E3   );
-    outnavf(fp,seph->vel[1]/1E3   );
-    outnavf(fp,seph->acc[1]/1E3   );
-    outnavf(fp,uravalue(seph->sva));
-    fprintf(fp,"\n%s",sep         );
-
-    outnavf(fp,seph->pos[2]/1E3   );
-    outnavf(fp,seph->vel[2]/1E3   );
-    outnavf(fp,seph->acc[2]/1E3   );
-    outnavf(fp,0                  );
-
-    return fprintf(fp,"\n")!=EOF;
+    outnavf(&b,seph->af0          );
+    outnavf(&b,seph->af1          );
+    outnavf(&b,time2gpst(seph->tof,NULL));
+    outbuf_printf(&b,"\n%s",sep);
+
+    outnavf(&b,seph->pos[0]/1E3   );
+    outnavf(&b,seph->vel[0]/1E3   );
+    outnavf(&b,seph->acc[0]/1E3   );
+    outnavf(&b,seph->svh          );
+    outbuf_printf(&b,"\n%s",sep);
+
+    outnavf(&b,seph->pos[1]/1E3   );
+    outnavf(&b,seph->vel[1]/1E3   );
+    outnavf(&b,seph->acc[1]/1E3   );
+    outnavf(&b,uravalue(seph->sva));
+    outbuf_printf(&b,"\n%s",sep);
+
+    outnavf(&b,seph->pos[2]/1E3   );
+    outnavf(&b,seph->vel[2]/1E3   );
+    outnavf(&b,seph->acc[2]/1E3   );
+    outnavf(&b,0                  );
+
+    outbuf_puts(&b,"\n",1);
+    return outbuf_flush(&b);
 }
 /* output RINEX Galileo NAV header ---------------------------------------------
 * output RINEX Galileo NAV file header (2.12)
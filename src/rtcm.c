@@ -102,6 +102,7 @@ int init_rtcm(rtcm_t *rtcm)
         rtcm->lockt[i][code] = -1;
     }
     rtcm->nbyte=rtcm->nbit=rtcm->len=0;
+    rtcm->frame=NULL;
     rtcm->word=0;
     for (i=0;i<100;i++) rtcm->nmsg2[i]=0;
     for (i=0;i<400;i++) rtcm->nmsg3[i]=0;
@@ -309,6 +310,82 @@ int input_rtcm3(rtcm_t *rtcm, uint8_t data)
     /* decode rtcm3 message */
     return decode_rtcm3(rtcm);
 }
+/* input RTCM 3 messages from buffer -------------------------------------------
+* input RTCM 3 messages in a buffer of stream data and decode the first message
+* args   : rtcm_t  *rtcm     IO  rtcm control struct
+*          uint8_t *data     I   stream data
+*          int     len       I   stream data length (bytes)
+*          int     *consumed O   number of bytes consumed
+* return : status (same as input_rtcm3(), 0: no message in the data)
+* notes  : preambles are searched over the data and the parity of a frame
+*          contained in the data is checked in place. a frame with valid
+*          parity is copied to rtcm->buff and decoded there, which bounds
+*          reads beyond the end of a corrupt message to rtcm->buff. a frame
+*          split over calls is stored in rtcm->buff.
+*          on a parity error, the input is resumed next to the preamble as
+*          input_rtcm3f() does by rewinding the file. for a frame split over
+*          calls, it is resumed at the beginning of the data.
+*          input the rest of data (data+*consumed) by the next call until
+*          *consumed reaches len.
+*-----------------------------------------------------------------------------*/
+int input_rtcm3_buf(rtcm_t *rtcm, const uint8_t *data, int len, int *consumed)
+{
+    const uint8_t *p;
+    int i=0,n,ret;
+    
+    trace(5,"input_rtcm3_buf: len=%d nbyte=%d\n",len,rtcm->nbyte);
+    
+    while (i<len) {
+        
+        /* frame stored by previous calls */
+        if (rtcm->nbyte>0) {
+            n=(rtcm->nbyte<3?3:rtcm->len+3)-rtcm->nbyte;
+            if (n>len-i) n=len-i;
+            memcpy(rtcm->buff+rtcm->nbyte,data+i,n);
+            rtcm->nbyte+=n;
+            i+=n;
+            if (rtcm->nbyte==3) rtcm->len=getbitu(rtcm->buff,14,10)+3;
+            if (rtcm->nbyte<3||rtcm->nbyte<rtcm->len+3) continue;
+            rtcm->nbyte=0;
+            
+            if (rtk_crc24q(rtcm->buff,rtcm->len)==getbitu(rtcm->buff,rtcm->len*8,24)) {
+                if ((ret=decode_rtcm3(rtcm))) {
+                    *consumed=i;
+                    return ret;
+                }
+                continue;
+            }
+            trace(2,"rtcm3 parity error: len=%d\n",rtcm->len);
+            i=0; /* resume at beginning of data */
+            continue;
+        }
+        /* synchronize frame */
+        if (!(p=memchr(data+i,RTCM3PREAMB,len-i))) break;
+        i=(int)(p-data);
+        if (len-i>=3) rtcm->len=getbitu(p,14,10)+3; /* length without parity */
+        
+        /* store frame split over calls */
+        if (len-i<3||len-i<rtcm->len+3) {
+            rtcm->nbyte=len-i;
+            memcpy(rtcm->buff,p,rtcm->nbyte);
+            break;
+        }
+        /* check parity in place and decode frame */
+        if (rtk_crc24q(p,rtcm->len)!=getbitu(p,rtcm->len*8,24)) {
+            trace(2,"rtcm3 parity error: len=%d\n",rtcm->len);
+            i++;
+            continue;
+        }
+        i+=rtcm->len+3;
+        memcpy(rtcm->buff,p,rtcm->len+3);
+        if ((ret=decode_rtcm3(rtcm))) {
+            *consumed=i;
+            return ret;
+        }
+    }
+    *consumed=len;
+    return 0;
+}
 /* input RTCM 2 message from file ----------------------------------------------
 * fetch next RTCM 2 message and input a message from file
 * args   : rtcm_t *rtcm IO   rtcm control struct
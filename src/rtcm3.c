@@ -470,7 +470,7 @@ static int test_staid(rtcm_t *rtcm, int staid)
         rtcm->staid=staid;
     }
     else if (staid!=rtcm->staid) {
-        type=getbitu(rtcm->buff,24,12);
+        type=getbitu(rtcm->frame,24,12);
         trace(2,"rtcm3 %d staid invalid id=%d %d\n",type,staid,rtcm->staid);
         
         /* reset station id if station id error */
@@ -488,13 +488,13 @@ static int decode_head1001(rtcm_t *rtcm, int *sync)
     
     if (rtcm->obsflag) rtcm->obs.n = rtcm->obsflag = 0;
 
-    type=getbitu(rtcm->buff,i,12); i+=12;
+    type=getbitu(rtcm->frame,i,12); i+=12;
     
     if (i+52<=rtcm->len*8) {
-        staid=getbitu(rtcm->buff,i,12);       i+=12;
-        tow  =getbitu(rtcm->buff,i,30)*0.001; i+=30;
-        *sync=getbitu(rtcm->buff,i, 1);       i+= 1;
-        nsat =getbitu(rtcm->buff,i, 5);
+        staid=getbitu(rtcm->frame,i,12);       i+=12;
+        tow  =getbitu(rtcm->frame,i,30)*0.001; i+=30;
+        *sync=getbitu(rtcm->frame,i, 1);       i+= 1;
+        nsat =getbitu(rtcm->frame,i, 5);
     }
     else {
         trace(2,"rtcm3 %d length error: len=%d\n",type,rtcm->len);
@@ -536,13 +536,13 @@ static int decode_type1002(rtcm_t *rtcm)
     }
 
     for (j=0;j<nsat&&i+74<=rtcm->len*8;j++) {
-        prn  =getbitu(rtcm->buff,i, 6); i+= 6;
-        code =getbitu(rtcm->buff,i, 1); i+= 1;
-        pr1  =getbitu(rtcm->buff,i,24); i+=24;
-        ppr1 =getbits(rtcm->buff,i,20); i+=20;
-        lti1=getbitu(rtcm->buff,i, 7); i+= 7;
-        amb  =getbitu(rtcm->buff,i, 8); i+= 8;
-        cnr1 =getbitu(rtcm->buff,i, 8); i+= 8;
+        prn  =getbitu(rtcm->frame,i, 6); i+= 6;
+        code =getbitu(rtcm->frame,i, 1); i+= 1;
+        pr1  =getbitu(rtcm->frame,i,24); i+=24;
+        ppr1 =getbits(rtcm->frame,i,20); i+=20;
+        lti1=getbitu(rtcm->frame,i, 7); i+= 7;
+        amb  =getbitu(rtcm->frame,i, 8); i+= 8;
+        cnr1 =getbitu(rtcm->frame,i, 8); i+= 8;
         if (prn<40) {
             sys=SYS_GPS;
         }
@@ -599,18 +599,18 @@ static int decode_type1004(rtcm_t *rtcm)
     }
 
     for (j=0;j<nsat&&i+125<=rtcm->len*8;j++) {
-        prn  =getbitu(rtcm->buff,i, 6); i+= 6;
-        code1=getbitu(rtcm->buff,i, 1); i+= 1;
-        pr1  =getbitu(rtcm->buff,i,24); i+=24;
-        ppr1 =getbits(rtcm->buff,i,20); i+=20;
-        lti1=getbitu(rtcm->buff,i, 7); i+= 7;
-        amb  =getbitu(rtcm->buff,i, 8); i+= 8;
-        cnr1 =getbitu(rtcm->buff,i, 8); i+= 8;
-        code2=getbitu(rtcm->buff,i, 2); i+= 2;
-        pr21 =getbits(rtcm->buff,i,14); i+=14;
-        ppr2 =getbits(rtcm->buff,i,20); i+=20;
-        lti2=getbitu(rtcm->buff,i, 7); i+= 7;
-        cnr2 =getbitu(rtcm->buff,i, 8); i+= 8;
+        prn  =getbitu(rtcm->frame,i, 6); i+= 6;
+        code1=getbitu(rtcm->frame,i, 1); i+= 1;
+        pr1  =getbitu(rtcm->frame,i,24); i+=24;
+        ppr1 =getbits(rtcm->frame,i,20); i+=20;
+        lti1=getbitu(rtcm->frame,i, 7); i+= 7;
+        amb  =getbitu(rtcm->frame,i, 8); i+= 8;
+        cnr1 =getbitu(rtcm->frame,i, 8); i+= 8;
+        code2=getbitu(rtcm->frame,i, 2); i+= 2;
+        pr21 =getbits(rtcm->frame,i,14); i+=14;
+        ppr2 =getbits(rtcm->frame,i,20); i+=20;
+        lti2=getbitu(rtcm->frame,i, 7); i+= 7;
+        cnr2 =getbitu(rtcm->frame,i, 8); i+= 8;
         if (prn<40) {
             sys=SYS_GPS;
         }
@@ -678,11 +678,11 @@ static int decode_type1005(rtcm_t *rtcm)
     int i=24+12,j,staid,itrf;
     
     if (i+140==rtcm->len*8) {
-        staid=getbitu(rtcm->buff,i,12); i+=12;
-        itrf =getbitu(rtcm->buff,i, 6); i+= 6+4;
-        rr[0]=getbits_38(rtcm->buff,i); i+=38+2;
-        rr[1]=getbits_38(rtcm->buff,i); i+=38+2;
-        rr[2]=getbits_38(rtcm->buff,i);
+        staid=getbitu(rtcm->frame,i,12); i+=12;
+        itrf =getbitu(rtcm->frame,i, 6); i+= 6+4;
+        rr[0]=getbits_38(rtcm->frame,i); i+=38+2;
+        rr[1]=getbits_38(rtcm->frame,i); i+=38+2;
+        rr[2]=getbits_38(rtcm->frame,i);
     }
     else {
         trace(2,"rtcm3 1005 length error: len=%d\n",rtcm->len);
@@ -716,12 +716,12 @@ static int decode_type1006(rtcm_t *rtcm)
     int i=24+12,j,staid,itrf;
     
     if (i+156<=rtcm->len*8) {
-        staid=getbitu(rtcm->buff,i,12); i+=12;
-        itrf =getbitu(rtcm->buff,i, 6); i+= 6+4;
-        rr[0]=getbits_38(rtcm->buff,i); i+=38+2;
-        rr[1]=getbits_38(rtcm->buff,i); i+=38+2;
-        rr[2]=getbits_38(rtcm->buff,i); i+=38;
-        anth =getbitu(rtcm->buff,i,16);
+        staid=getbitu(rtcm->frame,i,12); i+=12;
+        itrf =getbitu(rtcm->frame,i, 6); i+= 6+4;
+        rr[0]=getbits_38(rtcm->frame,i); i+=38+2;
+        rr[1]=getbits_38(rtcm->frame,i); i+=38+2;
+        rr[2]=getbits_38(rtcm->frame,i); i+=38;
+        anth =getbitu(rtcm->frame,i,16);
     }
     else {
         trace(2,"rtcm3 1006 length error: len=%d\n",rtcm->len);
@@ -754,14 +754,14 @@ static int decode_type1007(rtcm_t *rtcm)
     char *msg;
     int i=24+12,j,staid,n,setup;
     
-    n=getbitu(rtcm->buff,i+12,8);
+    n=i+20<=rtcm->len*8?getbitu(rtcm->frame,i+12,8):0;
     
     if (i+28+8*n<=rtcm->len*8) {
-        staid=getbitu(rtcm->buff,i,12); i+=12+8;
+        staid=getbitu(rtcm->frame,i,12); i+=12+8;
         for (j=0;j<n&&j<31;j++) {
-            des[j]=(char)getbitu(rtcm->buff,i,8); i+=8;
+            des[j]=(char)getbitu(rtcm->frame,i,8); i+=8;
         }
-        setup=getbitu(rtcm->buff,i, 8);
+        setup=getbitu(rtcm->frame,i, 8);
     }
     else {
         trace(2,"rtcm3 1007 length error: len=%d\n",rtcm->len);
@@ -787,17 +787,17 @@ static int decode_type1008(rtcm_t *rtcm)
     char *msg;
     int i=24+12,j,staid,n,m,setup;
     
-    n=getbitu(rtcm->buff,i+12,8);
-    m=getbitu(rtcm->buff,i+28+8*n,8);
+    n=i+20<=rtcm->len*8?getbitu(rtcm->frame,i+12,8):0;
+    m=i+36+8*n<=rtcm->len*8?getbitu(rtcm->frame,i+28+8*n,8):0;
     
     if (i+36+8*(n+m)<=rtcm->len*8) {
-        staid=getbitu(rtcm->buff,i,12); i+=12+8;
+        staid=getbitu(rtcm->frame,i,12); i+=12+8;
         for (j=0;j<n&&j<31;j++) {
-            des[j]=(char)getbitu(rtcm->buff,i,8); i+=8;
+            des[j]=(char)getbitu(rtcm->frame,i,8); i+=8;
         }
-        setup=getbitu(rtcm->buff,i, 8); i+=8+8;
+        setup=getbitu(rtcm->frame,i, 8); i+=8+8;
         for (j=0;j<m&&j<31;j++) {
-            sno[j]=(char)getbitu(rtcm->buff,i,8); i+=8;
+            sno[j]=(char)getbitu(rtcm->frame,i,8); i+=8;
         }
     }
     else {
@@ -826,13 +826,13 @@ static int decode_head1009(rtcm_t *rtcm, int *sync)
     
     if (rtcm->obsflag) rtcm->obs.n = rtcm->obsflag = 0;
 
-    type=getbitu(rtcm->buff,i,12); i+=12;
+    type=getbitu(rtcm->frame,i,12); i+=12;
     
     if (i+49<=rtcm->len*8) {
-        staid=getbitu(rtcm->buff,i,12);       i+=12;
-        tod  =getbitu(rtcm->buff,i,27)*0.001; i+=27; /* sec in a day */
-        *sync=getbitu(rtcm->buff,i, 1);       i+= 1;
-        nsat =getbitu(rtcm->buff,i, 5);
+        staid=getbitu(rtcm->frame,i,12);       i+=12;
+        tod  =getbitu(rtcm->frame,i,27)*0.001; i+=27; /* sec in a day */
+        *sync=getbitu(rtcm->frame,i, 1);       i+= 1;
+        nsat =getbitu(rtcm->frame,i, 5);
     }
     else {
         trace(2,"rtcm3 %d length error: len=%d\n",type,rtcm->len);
@@ -874,14 +874,14 @@ static int decode_type1010(rtcm_t *rtcm)
     }
 
     for (j=0;j<nsat&&i+79<=rtcm->len*8;j++) {
-        prn  =getbitu(rtcm->buff,i, 6); i+= 6;
-        code =getbitu(rtcm->buff,i, 1); i+= 1;
-        fcn  =getbitu(rtcm->buff,i, 5); i+= 5; /* fcn+7 */
-        pr1  =getbitu(rtcm->buff,i,25); i+=25;
-        ppr1 =getbits(rtcm->buff,i,20); i+=20;
-        lti1=getbitu(rtcm->buff,i, 7); i+= 7;
-        amb  =getbitu(rtcm->buff,i, 7); i+= 7;
-        cnr1 =getbitu(rtcm->buff,i, 8); i+= 8;
+        prn  =getbitu(rtcm->frame,i, 6); i+= 6;
+        code =getbitu(rtcm->frame,i, 1); i+= 1;
+        fcn  =getbitu(rtcm->frame,i, 5); i+= 5; /* fcn+7 */
+        pr1  =getbitu(rtcm->frame,i,25); i+=25;
+        ppr1 =getbits(rtcm->frame,i,20); i+=20;
+        lti1=getbitu(rtcm->frame,i, 7); i+= 7;
+        amb  =getbitu(rtcm->frame,i, 7); i+= 7;
+        cnr1 =getbitu(rtcm->frame,i, 8); i+= 8;
         if (!(sat=satno(sys,prn))) {
             trace(2,"rtcm3 1010 satellite number error: prn=%d\n",prn);
             continue;
@@ -934,19 +934,19 @@ static int decode_type1012(rtcm_t *rtcm)
     }
 
     for (j=0;j<nsat&&i+130<=rtcm->len*8;j++) {
-        prn  =getbitu(rtcm->buff,i, 6); i+= 6;
-        code1=getbitu(rtcm->buff,i, 1); i+= 1;
-        fcn  =getbitu(rtcm->buff,i, 5); i+= 5; /* fcn+7 */
-        double pr1  =getbitu(rtcm->buff,i,25); i+=25;
-        ppr1 =getbits(rtcm->buff,i,20); i+=20;
-        lti1=getbitu(rtcm->buff,i, 7); i+= 7;
-        amb  =getbitu(rtcm->buff,i, 7); i+= 7;
-        cnr1 =getbitu(rtcm->buff,i, 8); i+= 8;
-        code2=getbitu(rtcm->buff,i, 2); i+= 2;
-        pr21 =getbits(rtcm->buff,i,14); i+=14;
-        ppr2 =getbits(rtcm->buff,i,20); i+=20;
-        lti2=getbitu(rtcm->buff,i, 7); i+= 7;
-        cnr2 =getbitu(rtcm->buff,i, 8); i+= 8;
+        prn  =getbitu(rtcm->frame,i, 6); i+= 6;
+        code1=getbitu(rtcm->frame,i, 1); i+= 1;
+        fcn  =getbitu(rtcm->frame,i, 5); i+= 5; /* fcn+7 */
+        double pr1  =getbitu(rtcm->frame,i,25); i+=25;
+        ppr1 =getbits(rtcm->frame,i,20); i+=20;
+        lti1=getbitu(rtcm->frame,i, 7); i+= 7;
+        amb  =getbitu(rtcm->frame,i, 7); i+= 7;
+        cnr1 =getbitu(rtcm->frame,i, 8); i+= 8;
+        code2=getbitu(rtcm->frame,i, 2); i+= 2;
+        pr21 =getbits(rtcm->frame,i,14); i+=14;
+        ppr2 =getbits(rtcm->frame,i,20); i+=20;
+        lti2=getbitu(rtcm->frame,i, 7); i+= 7;
+        cnr2 =getbitu(rtcm->frame,i, 8); i+= 8;
         if (!(sat=satno(sys,prn))) {
             trace(2,"rtcm3 1012 satellite number error: sys=%d prn=%d\n",sys,prn);
             continue;
@@ -1005,15 +1005,15 @@ static int decode_type1013(rtcm_t *rtcm)
     return -1;
   }
 
-  unsigned refid = getbitu(rtcm->buff, i, 12);
+  unsigned refid = getbitu(rtcm->frame, i, 12);
   i += 12;
-  unsigned mjd =getbitu(rtcm->buff, i, 16);
+  unsigned mjd =getbitu(rtcm->frame, i, 16);
   i += 16;
-  unsigned tod = getbitu(rtcm->buff, i, 17);
+  unsigned tod = getbitu(rtcm->frame, i, 17);
   i += 17;
-  unsigned nmsg = getbitu(rtcm->buff, i, 5);
+  unsigned nmsg = getbitu(rtcm->frame, i, 5);
   i += 5;
-  unsigned leaps = getbitu(rtcm->buff, i, 8);
+  unsigned leaps = getbitu(rtcm->frame, i, 8);
   i += 8;
 
   if (i + nmsg * 29 > (size_t)rtcm->len * 8) {
@@ -1024,11 +1024,11 @@ static int decode_type1013(rtcm_t *rtcm)
   rtcm->nmsg = nmsg;
   uint8_t sync[32];
   for (unsigned n = 0; n < nmsg; n++) {
-    rtcm->msgs[n] = getbitu(rtcm->buff, i, 12);
+    rtcm->msgs[n] = getbitu(rtcm->frame, i, 12);
     i += 12;
-    sync[n] = getbitu(rtcm->buff, i, 1);
+    sync[n] = getbitu(rtcm->frame, i, 1);
     i += 1;
-    rtcm->tint[n] = getbitu(rtcm->buff, i, 16) * 0.1;
+    rtcm->tint[n] = getbitu(rtcm->frame, i, 16) * 0.1;
     i += 16;
   }
 
@@ -1054,36 +1054,36 @@ static int decode_type1019(rtcm_t *rtcm)
     int i=24+12,prn,sat,week,sys=SYS_GPS;
     
     if (i+476<=rtcm->len*8) {
-        prn       =getbitu(rtcm->buff,i, 6);              i+= 6;
-        week      =getbitu(rtcm->buff,i,10);              i+=10;
-        eph.sva   =getbitu(rtcm->buff,i, 4);              i+= 4;
-        eph.code  =getbitu(rtcm->buff,i, 2);              i+= 2;
-        eph.idot  =getbits(rtcm->buff,i,14)*P2_43*SC2RAD; i+=14;
-        eph.iode  =getbitu(rtcm->buff,i, 8);              i+= 8;
-        toc       =getbitu(rtcm->buff,i,16)*16.0;         i+=16;
-        eph.f2    =getbits(rtcm->buff,i, 8)*P2_55;        i+= 8;
-        eph.f1    =getbits(rtcm->buff,i,16)*P2_43;        i+=16;
-        eph.f0    =getbits(rtcm->buff,i,22)*P2_31;        i+=22;
-        eph.iodc  =getbitu(rtcm->buff,i,10);              i+=10;
-        eph.crs   =getbits(rtcm->buff,i,16)*P2_5;         i+=16;
-        eph.deln  =getbits(rtcm->buff,i,16)*P2_43*SC2RAD; i+=16;
-        eph.M0    =getbits(rtcm->buff,i,32)*P2_31*SC2RAD; i+=32;
-        eph.cuc   =getbits(rtcm->buff,i,16)*P2_29;        i+=16;
-        eph.e     =getbitu(rtcm->buff,i,32)*P2_33;        i+=32;
-        eph.cus   =getbits(rtcm->buff,i,16)*P2_29;        i+=16;
-        sqrtA     =getbitu(rtcm->buff,i,32)*P2_19;        i+=32;
-        eph.toes  =getbitu(rtcm->buff,i,16)*16.0;         i+=16;
-        eph.cic   =getbits(rtcm->buff,i,16)*P2_29;        i+=16;
-        eph.OMG0  =getbits(rtcm->buff,i,32)*P2_31*SC2RAD; i+=32;
-        eph.cis   =getbits(rtcm->buff,i,16)*P2_29;        i+=16;
-        eph.i0    =getbits(rtcm->buff,i,32)*P2_31*SC2RAD; i+=32;
-        eph.crc   =getbits(rtcm->buff,i,16)*P2_5;         i+=16;
-        eph.omg   =getbits(rtcm->buff,i,32)*P2_31*SC2RAD; i+=32;
-        eph.OMGd  =getbits(rtcm->buff,i,24)*P2_43*SC2RAD; i+=24;
-        eph.tgd[0]=getbits(rtcm->buff,i, 8)*P2_31;        i+= 8;
-        eph.svh   =getbitu(rtcm->buff,i, 6);              i+= 6;
-        eph.flag  =getbitu(rtcm->buff,i, 1);              i+= 1;
-        eph.fit   =getbitu(rtcm->buff,i, 1)?6:4; /* 0:4hr,1:>4hr */
+        prn       =getbitu(rtcm->frame,i, 6);              i+= 6;
+        week      =getbitu(rtcm->frame,i,10);              i+=10;
+        eph.sva   =getbitu(rtcm->frame,i, 4);              i+= 4;
+        eph.code  =getbitu(rtcm->frame,i, 2);              i+= 2;
+        eph.idot  =getbits(rtcm->frame,i,14)*P2_43*SC2RAD; i+=14;
+        eph.iode  =getbitu(rtcm->frame,i, 8);              i+= 8;
+        toc       =getbitu(rtcm->frame,i,16)*16.0;         i+=16;
+        eph.f2    =getbits(rtcm->frame,i, 8)*P2_55;        i+= 8;
+        eph.f1    =getbits(rtcm->frame,i,16)*P2_43;        i+=16;
+        eph.f0    =getbits(rtcm->frame,i,22)*P2_31;        i+=22;
+        eph.iodc  =getbitu(rtcm->frame,i,10);              i+=10;
+        eph.crs   =getbits(rtcm->frame,i,16)*P2_5;         i+=16;
+        eph.deln  =getbits(rtcm->frame,i,16)*P2_43*SC2RAD; i+=16;
+        eph.M0    =getbits(rtcm->frame,i,32)*P2_31*SC2RAD; i+=32;
+        eph.cuc   =getbits(rtcm->frame,i,16)*P2_29;        i+=16;
+        eph.e     =getbitu(rtcm->frame,i,32)*P2_33;        i+=32;
+        eph.cus   =getbits(rtcm->frame,i,16)*P2_29;        i+=16;
+        sqrtA     =getbitu(rtcm->frame,i,32)*P2_19;        i+=32;
+        eph.toes  =getbitu(rtcm->frame,i,16)*16.0;         i+=16;
+        eph.cic   =getbits(rtcm->frame,i,16)*P2_29;        i+=16;
+        eph.OMG0  =getbits(rtcm->frame,i,32)*P2_31*SC2RAD; i+=32;
+        eph.cis   =getbits(rtcm->frame,i,16)*P2_29;        i+=16;
+        eph.i0    =getbits(rtcm->frame,i,32)*P2_31*SC2RAD; i+=32;
+        eph.crc   =getbits(rtcm->frame,i,16)*P2_5;         i+=16;
+        eph.omg   =getbits(rtcm->frame,i,32)*P2_31*SC2RAD; i+=32;
+        eph.OMGd  =getbits(rtcm->frame,i,24)*P2_43*SC2RAD; i+=24;
+        eph.tgd[0]=getbits(rtcm->frame,i, 8)*P2_31;        i+= 8;
+        eph.svh   =getbitu(rtcm->frame,i, 6);              i+= 6;
+        eph.flag  =getbitu(rtcm->frame,i, 1);              i+= 1;
+        eph.fit   =getbitu(rtcm->frame,i, 1)?6:4; /* 0:4hr,1:>4hr */
     }
     else {
         trace(2,"rtcm3 1019 length error: len=%d\n",rtcm->len);
@@ -1133,36 +1133,36 @@ static int decode_type1020(rtcm_t *rtcm)
         trace(2,"rtcm3 1020 length error: len=%d\n",rtcm->len);
         return -1;
     }
-    int prn    =getbitu(rtcm->buff,i, 6);           i+= 6;
-    geph.frq   =getbitu(rtcm->buff,i, 5)-7;         i+= 5;
-    int Cn     =getbitu(rtcm->buff,i, 1);           i+= 1;
-    int Cn_a   =getbitu(rtcm->buff,i, 1);           i+= 1;
-    int P1     =getbitu(rtcm->buff,i, 2);           i+= 2;
-    double tk_h=getbitu(rtcm->buff,i, 5);           i+= 5;
-    double tk_m=getbitu(rtcm->buff,i, 6);           i+= 6;
-    double tk_s=getbitu(rtcm->buff,i, 1)*30.0;      i+= 1;
-    int Bn     =getbitu(rtcm->buff,i, 1);           i+= 1;
-    int P2     =getbitu(rtcm->buff,i, 1);           i+= 1;
-    int tb     =getbitu(rtcm->buff,i, 7);           i+= 7;
-    geph.vel[0]=getbitg(rtcm->buff,i,24)*P2_20*1E3; i+=24;
-    geph.pos[0]=getbitg(rtcm->buff,i,27)*P2_11*1E3; i+=27;
-    geph.acc[0]=getbitg(rtcm->buff,i, 5)*P2_30*1E3; i+= 5;
-    geph.vel[1]=getbitg(rtcm->buff,i,24)*P2_20*1E3; i+=24;
-    geph.pos[1]=getbitg(rtcm->buff,i,27)*P2_11*1E3; i+=27;
-    geph.acc[1]=getbitg(rtcm->buff,i, 5)*P2_30*1E3; i+= 5;
-    geph.vel[2]=getbitg(rtcm->buff,i,24)*P2_20*1E3; i+=24;
-    geph.pos[2]=getbitg(rtcm->buff,i,27)*P2_11*1E3; i+=27;
-    geph.acc[2]=getbitg(rtcm->buff,i, 5)*P2_30*1E3; i+= 5;
-    int P3     =getbitu(rtcm->buff,i, 1);           i+= 1;
-    geph.gamn  =getbitg(rtcm->buff,i,11)*P2_40;     i+=11;
-    int P      =getbitu(rtcm->buff,i, 2);           i+= 2;
-    int ln     =getbitu(rtcm->buff,i, 1);           i+= 1;
-    geph.taun  =getbitg(rtcm->buff,i,22)*P2_30;     i+=22;
-    geph.dtaun =getbitg(rtcm->buff,i, 5)*P2_30;     i+= 5;
-    geph.age   =getbitu(rtcm->buff,i, 5);           i+= 5;
-    int P4     =getbitu(rtcm->buff,i, 1);           i+= 1;
-    geph.sva   =getbitu(rtcm->buff,i, 4);           i+= 4;
-    int M      =getbitu(rtcm->buff,i, 2);
+    int prn    =getbitu(rtcm->frame,i, 6);           i+= 6;
+    geph.frq   =getbitu(rtcm->frame,i, 5)-7;         i+= 5;
+    int Cn     =getbitu(rtcm->frame,i, 1);           i+= 1;
+    int Cn_a   =getbitu(rtcm->frame,i, 1);           i+= 1;
+    int P1     =getbitu(rtcm->frame,i, 2);           i+= 2;
+    double tk_h=getbitu(rtcm->frame,i, 5);           i+= 5;
+    double tk_m=getbitu(rtcm->frame,i, 6);           i+= 6;
+    double tk_s=getbitu(rtcm->frame,i, 1)*30.0;      i+= 1;
+    int Bn     =getbitu(rtcm->frame,i, 1);           i+= 1;
+    int P2     =getbitu(rtcm->frame,i, 1);           i+= 1;
+    int tb     =getbitu(rtcm->frame,i, 7);           i+= 7;
+    geph.vel[0]=getbitg(rtcm->frame,i,24)*P2_20*1E3; i+=24;
+    geph.pos[0]=getbitg(rtcm->frame,i,27)*P2_11*1E3; i+=27;
+    geph.acc[0]=getbitg(rtcm->frame,i, 5)*P2_30*1E3; i+= 5;
+    geph.vel[1]=getbitg(rtcm->frame,i,24)*P2_20*1E3; i+=24;
+    geph.pos[1]=getbitg(rtcm->frame,i,27)*P2_11*1E3; i+=27;
+    geph.acc[1]=getbitg(rtcm->frame,i, 5)*P2_30*1E3; i+= 5;
+    geph.vel[2]=getbitg(rtcm->frame,i,24)*P2_20*1E3; i+=24;
+    geph.pos[2]=getbitg(rtcm->frame,i,27)*P2_11*1E3; i+=27;
+    geph.acc[2]=getbitg(rtcm->frame,i, 5)*P2_30*1E3; i+= 5;
+    int P3     =getbitu(rtcm->frame,i, 1);           i+= 1;
+    geph.gamn  =getbitg(rtcm->frame,i,11)*P2_40;     i+=11;
+    int P      =getbitu(rtcm->frame,i, 2);           i+= 2;
+    int ln     =getbitu(rtcm->frame,i, 1);           i+= 1;
+    geph.taun  =getbitg(rtcm->frame,i,22)*P2_30;     i+=22;
+    geph.dtaun =getbitg(rtcm->frame,i, 5)*P2_30;     i+= 5;
+    geph.age   =getbitu(rtcm->frame,i, 5);           i+= 5;
+    int P4     =getbitu(rtcm->frame,i, 1);           i+= 1;
+    geph.sva   =getbitu(rtcm->frame,i, 4);           i+= 4;
+    int M      =getbitu(rtcm->frame,i, 2);
 
     if (!(sat=satno(sys,prn))) {
         trace(2,"rtcm3 1020 satellite number error: prn=%d\n",prn);
@@ -1256,11 +1256,11 @@ static int decode_type1029(rtcm_t *rtcm)
     int i=24+12,j,staid,mjd,tod,nchar,cunit;
     
     if (i+60<=rtcm->len*8) {
-        staid=getbitu(rtcm->buff,i,12); i+=12;
-        mjd  =getbitu(rtcm->buff,i,16); i+=16;
-        tod  =getbitu(rtcm->buff,i,17); i+=17;
-        nchar=getbitu(rtcm->buff,i, 7); i+= 7;
-        cunit=getbitu(rtcm->buff,i, 8); i+= 8;
+        staid=getbitu(rtcm->frame,i,12); i+=12;
+        mjd  =getbitu(rtcm->frame,i,16); i+=16;
+        tod  =getbitu(rtcm->frame,i,17); i+=17;
+        nchar=getbitu(rtcm->frame,i, 7); i+= 7;
+        cunit=getbitu(rtcm->frame,i, 8); i+= 8;
     }
     else {
         trace(2,"rtcm3 1029 length error: len=%d\n",rtcm->len);
@@ -1271,7 +1271,7 @@ static int decode_type1029(rtcm_t *rtcm)
         return -1;
     } 
     for (j=0;j<nchar&&j<126;j++) {
-        rtcm->msg[j]=getbitu(rtcm->buff,i,8); i+=8;
+        rtcm->msg[j]=getbitu(rtcm->frame,i,8); i+=8;
     }
     rtcm->msg[j]='\0';
     
@@ -1309,32 +1309,33 @@ static int decode_type1033(rtcm_t *rtcm)
     char *msg;
     int i=24+12,j,staid,n,m,n1,n2,n3,setup;
     
-    n =getbitu(rtcm->buff,i+12,8);
-    m =getbitu(rtcm->buff,i+28+8*n,8);
-    n1=getbitu(rtcm->buff,i+36+8*(n+m),8);
-    n2=getbitu(rtcm->buff,i+44+8*(n+m+n1),8);
-    n3=getbitu(rtcm->buff,i+52+8*(n+m+n1+n2),8);
+    /* lengths of strings (0: out of message) */
+    n =i+20<=rtcm->len*8?getbitu(rtcm->frame,i+12,8):0;
+    m =i+36+8*n<=rtcm->len*8?getbitu(rtcm->frame,i+28+8*n,8):0;
+    n1=i+44+8*(n+m)<=rtcm->len*8?getbitu(rtcm->frame,i+36+8*(n+m),8):0;
+    n2=i+52+8*(n+m+n1)<=rtcm->len*8?getbitu(rtcm->frame,i+44+8*(n+m+n1),8):0;
+    n3=i+60+8*(n+m+n1+n2)<=rtcm->len*8?getbitu(rtcm->frame,i+52+8*(n+m+n1+n2),8):0;
     
     if (i+60+8*(n+m+n1+n2+n3)<=rtcm->len*8) {
-        staid=getbitu(rtcm->buff,i,12); i+=12+8;
+        staid=getbitu(rtcm->frame,i,12); i+=12+8;
         for (j=0;j<n&&j<31;j++) {
-            des[j]=(char)getbitu(rtcm->buff,i,8); i+=8;
+            des[j]=(char)getbitu(rtcm->frame,i,8); i+=8;
         }
-        setup=getbitu(rtcm->buff,i, 8); i+=8+8;
+        setup=getbitu(rtcm->frame,i, 8); i+=8+8;
         for (j=0;j<m&&j<31;j++) {
-            sno[j]=(char)getbitu(rtcm->buff,i,8); i+=8;
+            sno[j]=(char)getbitu(rtcm->frame,i,8); i+=8;
         }
         i+=8;
         for (j=0;j<n1&&j<31;j++) {
-            rec[j]=(char)getbitu(rtcm->buff,i,8); i+=8;
+            rec[j]=(char)getbitu(rtcm->frame,i,8); i+=8;
         }
         i+=8;
         for (j=0;j<n2&&j<31;j++) {
-            ver[j]=(char)getbitu(rtcm->buff,i,8); i+=8;
+            ver[j]=(char)getbitu(rtcm->frame,i,8); i+=8;
         }
         i+=8;
         for (j=0;j<n3&&j<31;j++) {
-            rsn[j]=(char)getbitu(rtcm->buff,i,8); i+=8;
+            rsn[j]=(char)getbitu(rtcm->frame,i,8); i+=8;
         }
     }
     else {
@@ -1403,32 +1404,32 @@ static int decode_type1041(rtcm_t *rtcm)
     int i=24+12,prn,sat,week,sys=SYS_IRN;
     
     if (i+482-12<=rtcm->len*8) {
-        prn       =getbitu(rtcm->buff,i, 6);              i+= 6;
-        week      =getbitu(rtcm->buff,i,10);              i+=10;
-        eph.f0    =getbits(rtcm->buff,i,22)*P2_31;        i+=22;
-        eph.f1    =getbits(rtcm->buff,i,16)*P2_43;        i+=16;
-        eph.f2    =getbits(rtcm->buff,i, 8)*P2_55;        i+= 8;
-        eph.sva   =getbitu(rtcm->buff,i, 4);              i+= 4;
-        toc       =getbitu(rtcm->buff,i,16)*16.0;         i+=16;
-        eph.tgd[0]=getbits(rtcm->buff,i, 8)*P2_31;        i+= 8;
-        eph.deln  =getbits(rtcm->buff,i,22)*P2_41*SC2RAD; i+=22;
-        eph.iode  =getbitu(rtcm->buff,i, 8);              i+= 8+10; /* IODEC */
-        eph.svh   =getbitu(rtcm->buff,i, 2);              i+= 2; /* L5+Sflag */
-        eph.cuc   =getbits(rtcm->buff,i,15)*P2_28;        i+=15;
-        eph.cus   =getbits(rtcm->buff,i,15)*P2_28;        i+=15;
-        eph.cic   =getbits(rtcm->buff,i,15)*P2_28;        i+=15;
-        eph.cis   =getbits(rtcm->buff,i,15)*P2_28;        i+=15;
-        eph.crc   =getbits(rtcm->buff,i,15)*0.0625;       i+=15;
-        eph.crs   =getbits(rtcm->buff,i,15)*0.0625;       i+=15;
-        eph.idot  =getbits(rtcm->buff,i,14)*P2_43*SC2RAD; i+=14;
-        eph.M0    =getbits(rtcm->buff,i,32)*P2_31*SC2RAD; i+=32;
-        eph.toes  =getbitu(rtcm->buff,i,16)*16.0;         i+=16;
-        eph.e     =getbitu(rtcm->buff,i,32)*P2_33;        i+=32;
-        sqrtA     =getbitu(rtcm->buff,i,32)*P2_19;        i+=32;
-        eph.OMG0  =getbits(rtcm->buff,i,32)*P2_31*SC2RAD; i+=32;
-        eph.omg   =getbits(rtcm->buff,i,32)*P2_31*SC2RAD; i+=32;
-        eph.OMGd  =getbits(rtcm->buff,i,22)*P2_41*SC2RAD; i+=22;
-        eph.i0    =getbits(rtcm->buff,i,32)*P2_31*SC2RAD;
+        prn       =getbitu(rtcm->frame,i, 6);              i+= 6;
+        week      =getbitu(rtcm->frame,i,10);              i+=10;
+        eph.f0    =getbits(rtcm->frame,i,22)*P2_31;        i+=22;
+        eph.f1    =getbits(rtcm->frame,i,16)*P2_43;        i+=16;
+        eph.f2    =getbits(rtcm->frame,i, 8)*P2_55;        i+= 8;
+        eph.sva   =getbitu(rtcm->frame,i, 4);              i+= 4;
+        toc       =getbitu(rtcm->frame,i,16)*16.0;         i+=16;
+        eph.tgd[0]=getbits(rtcm->frame,i, 8)*P2_31;        i+= 8;
+        eph.deln  =getbits(rtcm->frame,i,22)*P2_41*SC2RAD; i+=22;
+        eph.iode  =getbitu(rtcm->frame,i, 8);              i+= 8+10; /* IODEC */
+        eph.svh   =getbitu(rtcm->frame,i, 2);              i+= 2; /* L5+Sflag */
+        eph.cuc   =getbits(rtcm->frame,i,15)*P2_28;        i+=15;
+        eph.cus   =getbits(rtcm->frame,i,15)*P2_28;        i+=15;
+        eph.cic   =getbits(rtcm->frame,i,15)*P2_28;        i+=15;
+        eph.cis   =getbits(rtcm->frame,i,15)*P2_28;        i+=15;
+        eph.crc   =getbits(rtcm->frame,i,15)*0.0625;       i+=15;
+        eph.crs   =getbits(rtcm->frame,i,15)*0.0625;       i+=15;
+        eph.idot  =getbits(rtcm->frame,i,14)*P2_43*SC2RAD; i+=14;
+        eph.M0    =getbits(rtcm->frame,i,32)*P2_31*SC2RAD; i+=32;
+        eph.toes  =getbitu(rtcm->frame,i,16)*16.0;         i+=16;
+        eph.e     =getbitu(rtcm->frame,i,32)*P2_33;        i+=32;
+        sqrtA     =getbitu(rtcm->frame,i,32)*P2_19;        i+=32;
+        eph.OMG0  =getbits(rtcm->frame,i,32)*P2_31*SC2RAD; i+=32;
+        eph.omg   =getbits(rtcm->frame,i,32)*P2_31*SC2RAD; i+=32;
+        eph.OMGd  =getbits(rtcm->frame,i,22)*P2_41*SC2RAD; i+=22;
+        eph.i0    =getbits(rtcm->frame,i,32)*P2_31*SC2RAD;
     }
     else {
         trace(2,"rtcm3 1041 length error: len=%d\n",rtcm->len);
@@ -1473,35 +1474,35 @@ static int decode_type1044(rtcm_t *rtcm)
     int i=24+12,prn,sat,week,sys=SYS_QZS;
     
     if (i+473<=rtcm->len*8) {
-        prn       =getbitu(rtcm->buff,i, 4)+192;          i+= 4;
-        toc       =getbitu(rtcm->buff,i,16)*16.0;         i+=16;
-        eph.f2    =getbits(rtcm->buff,i, 8)*P2_55;        i+= 8;
-        eph.f1    =getbits(rtcm->buff,i,16)*P2_43;        i+=16;
-        eph.f0    =getbits(rtcm->buff,i,22)*P2_31;        i+=22;
-        eph.iode  =getbitu(rtcm->buff,i, 8);              i+= 8;
-        eph.crs   =getbits(rtcm->buff,i,16)*P2_5;         i+=16;
-        eph.deln  =getbits(rtcm->buff,i,16)*P2_43*SC2RAD; i+=16;
-        eph.M0    =getbits(rtcm->buff,i,32)*P2_31*SC2RAD; i+=32;
-        eph.cuc   =getbits(rtcm->buff,i,16)*P2_29;        i+=16;
-        eph.e     =getbitu(rtcm->buff,i,32)*P2_33;        i+=32;
-        eph.cus   =getbits(rtcm->buff,i,16)*P2_29;        i+=16;
-        sqrtA     =getbitu(rtcm->buff,i,32)*P2_19;        i+=32;
-        eph.toes  =getbitu(rtcm->buff,i,16)*16.0;         i+=16;
-        eph.cic   =getbits(rtcm->buff,i,16)*P2_29;        i+=16;
-        eph.OMG0  =getbits(rtcm->buff,i,32)*P2_31*SC2RAD; i+=32;
-        eph.cis   =getbits(rtcm->buff,i,16)*P2_29;        i+=16;
-        eph.i0    =getbits(rtcm->buff,i,32)*P2_31*SC2RAD; i+=32;
-        eph.crc   =getbits(rtcm->buff,i,16)*P2_5;         i+=16;
-        eph.omg   =getbits(rtcm->buff,i,32)*P2_31*SC2RAD; i+=32;
-        eph.OMGd  =getbits(rtcm->buff,i,24)*P2_43*SC2RAD; i+=24;
-        eph.idot  =getbits(rtcm->buff,i,14)*P2_43*SC2RAD; i+=14;
-        eph.code  =getbitu(rtcm->buff,i, 2);              i+= 2;
-        week      =getbitu(rtcm->buff,i,10);              i+=10;
-        eph.sva   =getbitu(rtcm->buff,i, 4);              i+= 4;
-        eph.svh   =getbitu(rtcm->buff,i, 6);              i+= 6;
-        eph.tgd[0]=getbits(rtcm->buff,i, 8)*P2_31;        i+= 8;
-        eph.iodc  =getbitu(rtcm->buff,i,10);              i+=10;
-        eph.fit   =getbitu(rtcm->buff,i, 1)?4:2; /* 0:2hr,1:>2hr */
+        prn       =getbitu(rtcm->frame,i, 4)+192;          i+= 4;
+        toc       =getbitu(rtcm->frame,i,16)*16.0;         i+=16;
+        eph.f2    =getbits(rtcm->frame,i, 8)*P2_55;        i+= 8;
+        eph.f1    =getbits(rtcm->frame,i,16)*P2_43;        i+=16;
+        eph.f0    =getbits(rtcm->frame,i,22)*P2_31;        i+=22;
+        eph.iode  =getbitu(rtcm->frame,i, 8);              i+= 8;
+        eph.crs   =getbits(rtcm->frame,i,16)*P2_5;         i+=16;
+        eph.deln  =getbits(rtcm->frame,i,16)*P2_43*SC2RAD; i+=16;
+        eph.M0    =getbits(rtcm->frame,i,32)*P2_31*SC2RAD; i+=32;
+        eph.cuc   =getbits(rtcm->frame,i,16)*P2_29;        i+=16;
+        eph.e     =getbitu(rtcm->frame,i,32)*P2_33;        i+=32;
+        eph.cus   =getbits(rtcm->frame,i,16)*P2_29;        i+=16;
+        sqrtA     =getbitu(rtcm->frame,i,32)*P2_19;        i+=32;
+        eph.toes  =getbitu(rtcm->frame,i,16)*16.0;         i+=16;
+        eph.cic   =getbits(rtcm->frame,i,16)*P2_29;        i+=16;
+        eph.OMG0  =getbits(rtcm->frame,i,32)*P2_31*SC2RAD; i+=32;
+        eph.cis   =getbits(rtcm->frame,i,16)*P2_29;        i+=16;
+        eph.i0    =getbits(rtcm->frame,i,32)*P2_31*SC2RAD; i+=32;
+        eph.crc   =getbits(rtcm->frame,i,16)*P2_5;         i+=16;
+        eph.omg   =getbits(rtcm->frame,i,32)*P2_31*SC2RAD; i+=32;
+        eph.OMGd  =getbits(rtcm->frame,i,24)*P2_43*SC2RAD; i+=24;
+        eph.idot  =getbits(rtcm->frame,i,14)*P2_43*SC2RAD; i+=14;
+        eph.code  =getbitu(rtcm->frame,i, 2);              i+= 2;
+        week      =getbitu(rtcm->frame,i,10);              i+=10;
+        eph.sva   =getbitu(rtcm->frame,i, 4);              i+= 4;
+        eph.svh   =getbitu(rtcm->frame,i, 6);              i+= 6;
+        eph.tgd[0]=getbits(rtcm->frame,i, 8)*P2_31;        i+= 8;
+        eph.iodc  =getbitu(rtcm->frame,i,10);              i+=10;
+        eph.fit   =getbitu(rtcm->frame,i, 1)?4:2; /* 0:2hr,1:>2hr */
     }
     else {
         trace(2,"rtcm3 1044 length error: len=%d\n",rtcm->len);
@@ -1549,34 +1550,34 @@ static int decode_type1045(rtcm_t *rtcm)
     if (strstr(rtcm->opt,"-GALINAV")) return 0;
 
     if (i+484<=rtcm->len*8) {
-        prn       =getbitu(rtcm->buff,i, 6);              i+= 6;
-        week      =getbitu(rtcm->buff,i,12);              i+=12; /* gst-week */
-        eph.iode  =getbitu(rtcm->buff,i,10);              i+=10;
-        eph.sva   =getbitu(rtcm->buff,i, 8);              i+= 8;
-        eph.idot  =getbits(rtcm->buff,i,14)*P2_43*SC2RAD; i+=14;
-        toc       =getbitu(rtcm->buff,i,14)*60.0;         i+=14;
-        eph.f2    =getbits(rtcm->buff,i, 6)*P2_59;        i+= 6;
-        eph.f1    =getbits(rtcm->buff,i,21)*P2_46;        i+=21;
-        eph.f0    =getbits(rtcm->buff,i,31)*P2_34;        i+=31;
-        eph.crs   =getbits(rtcm->buff,i,16)*P2_5;         i+=16;
-        eph.deln  =getbits(rtcm->buff,i,16)*P2_43*SC2RAD; i+=16;
-        eph.M0    =getbits(rtcm->buff,i,32)*P2_31*SC2RAD; i+=32;
-        eph.cuc   =getbits(rtcm->buff,i,16)*P2_29;        i+=16;
-        eph.e     =getbitu(rtcm->buff,i,32)*P2_33;        i+=32;
-        eph.cus   =getbits(rtcm->buff,i,16)*P2_29;        i+=16;
-        sqrtA     =getbitu(rtcm->buff,i,32)*P2_19;        i+=32;
-        eph.toes  =getbitu(rtcm->buff,i,14)*60.0;         i+=14;
-        eph.cic   =getbits(rtcm->buff,i,16)*P2_29;        i+=16;
-        eph.OMG0  =getbits(rtcm->buff,i,32)*P2_31*SC2RAD; i+=32;
-        eph.cis   =getbits(rtcm->buff,i,16)*P2_29;        i+=16;
-        eph.i0    =getbits(rtcm->buff,i,32)*P2_31*SC2RAD; i+=32;
-        eph.crc   =getbits(rtcm->buff,i,16)*P2_5;         i+=16;
-        eph.omg   =getbits(rtcm->buff,i,32)*P2_31*SC2RAD; i+=32;
-        eph.OMGd  =getbits(rtcm->buff,i,24)*P2_43*SC2RAD; i+=24;
-        eph.tgd[0]=getbits(rtcm->buff,i,10)*P2_32;        i+=10; /* E5a/E1 */
-        e5a_hs    =getbitu(rtcm->buff,i, 2);              i+= 2; /* OSHS */
-        e5a_dvs   =getbitu(rtcm->buff,i, 1);              i+= 1; /* OSDVS */
-        rsv       =getbitu(rtcm->buff,i, 7);
+        prn       =getbitu(rtcm->frame,i, 6);              i+= 6;
+        week      =getbitu(rtcm->frame,i,12);              i+=12; /* gst-week */
+        eph.iode  =getbitu(rtcm->frame,i,10);              i+=10;
+        eph.sva   =getbitu(rtcm->frame,i, 8);              i+= 8;
+        eph.idot  =getbits(rtcm->frame,i,14)*P2_43*SC2RAD; i+=14;
+        toc       =getbitu(rtcm->frame,i,14)*60.0;         i+=14;
+        eph.f2    =getbits(rtcm->frame,i, 6)*P2_59;        i+= 6;
+        eph.f1    =getbits(rtcm->frame,i,21)*P2_46;        i+=21;
+        eph.f0    =getbits(rtcm->frame,i,31)*P2_34;        i+=31;
+        eph.crs   =getbits(rtcm->frame,i,16)*P2_5;         i+=16;
+        eph.deln  =getbits(rtcm->frame,i,16)*P2_43*SC2RAD; i+=16;
+        eph.M0    =getbits(rtcm->frame,i,32)*P2_31*SC2RAD; i+=32;
+        eph.cuc   =getbits(rtcm->frame,i,16)*P2_29;        i+=16;
+        eph.e     =getbitu(rtcm->frame,i,32)*P2_33;        i+=32;
+        eph.cus   =getbits(rtcm->frame,i,16)*P2_29;        i+=16;
+        sqrtA     =getbitu(rtcm->frame,i,32)*P2_19;        i+=32;
+        eph.toes  =getbitu(rtcm->frame,i,14)*60.0;         i+=14;
+        eph.cic   =getbits(rtcm->frame,i,16)*P2_29;        i+=16;
+        eph.OMG0  =getbits(rtcm->frame,i,32)*P2_31*SC2RAD; i+=32;
+        eph.cis   =getbits(rtcm->frame,i,16)*P2_29;        i+=16;
+        eph.i0    =getbits(rtcm->frame,i,32)*P2_31*SC2RAD; i+=32;
+        eph.crc   =getbits(rtcm->frame,i,16)*P2_5;         i+=16;
+        eph.omg   =getbits(rtcm->frame,i,32)*P2_31*SC2RAD; i+=32;
+        eph.OMGd  =getbits(rtcm->frame,i,24)*P2_43*SC2RAD; i+=24;
+        eph.tgd[0]=getbits(rtcm->frame,i,10)*P2_32;        i+=10; /* E5a/E1 */
+        e5a_hs    =getbitu(rtcm->frame,i, 2);              i+= 2; /* OSHS */
+        e5a_dvs   =getbitu(rtcm->frame,i, 1);              i+= 1; /* OSDVS */
+        rsv       =getbitu(rtcm->frame,i, 7);
     }
     else {
         trace(2,"rtcm3 1045 length error: len=%d\n",rtcm->len);
@@ -1628,36 +1629,36 @@ static int decode_type1046(rtcm_t *rtcm)
     if (strstr(rtcm->opt,"-GALFNAV")) return 0;
 
     if (i+492<=rtcm->len*8) {
-        prn       =getbitu(rtcm->buff,i, 6);              i+= 6;
-        week      =getbitu(rtcm->buff,i,12);              i+=12;
-        eph.iode  =getbitu(rtcm->buff,i,10);              i+=10;
-        eph.sva   =getbitu(rtcm->buff,i, 8);              i+= 8;
-        eph.idot  =getbits(rtcm->buff,i,14)*P2_43*SC2RAD; i+=14;
-        toc       =getbitu(rtcm->buff,i,14)*60.0;         i+=14;
-        eph.f2    =getbits(rtcm->buff,i, 6)*P2_59;        i+= 6;
-        eph.f1    =getbits(rtcm->buff,i,21)*P2_46;        i+=21;
-        eph.f0    =getbits(rtcm->buff,i,31)*P2_34;        i+=31;
-        eph.crs   =getbits(rtcm->buff,i,16)*P2_5;         i+=16;
-        eph.deln  =getbits(rtcm->buff,i,16)*P2_43*SC2RAD; i+=16;
-        eph.M0    =getbits(rtcm->buff,i,32)*P2_31*SC2RAD; i+=32;
-        eph.cuc   =getbits(rtcm->buff,i,16)*P2_29;        i+=16;
-        eph.e     =getbitu(rtcm->buff,i,32)*P2_33;        i+=32;
-        eph.cus   =getbits(rtcm->buff,i,16)*P2_29;        i+=16;
-        sqrtA     =getbitu(rtcm->buff,i,32)*P2_19;        i+=32;
-        eph.toes  =getbitu(rtcm->buff,i,14)*60.0;         i+=14;
-        eph.cic   =getbits(rtcm->buff,i,16)*P2_29;        i+=16;
-        eph.OMG0  =getbits(rtcm->buff,i,32)*P2_31*SC2RAD; i+=32;
-        eph.cis   =getbits(rtcm->buff,i,16)*P2_29;        i+=16;
-        eph.i0    =getbits(rtcm->buff,i,32)*P2_31*SC2RAD; i+=32;
-        eph.crc   =getbits(rtcm->buff,i,16)*P2_5;         i+=16;
-        eph.omg   =getbits(rtcm->buff,i,32)*P2_31*SC2RAD; i+=32;
-        eph.OMGd  =getbits(rtcm->buff,i,24)*P2_43*SC2RAD; i+=24;
-        eph.tgd[0]=getbits(rtcm->buff,i,10)*P2_32;        i+=10; /* E5a/E1 */
-        eph.tgd[1]=getbits(rtcm->buff,i,10)*P2_32;        i+=10; /* E5b/E1 */
-        e5b_hs    =getbitu(rtcm->buff,i, 2);              i+= 2; /* E5b OSHS */
-        e5b_dvs   =getbitu(rtcm->buff,i, 1);              i+= 1; /* E5b OSDVS */
-        e1_hs     =getbitu(rtcm->buff,i, 2);              i+= 2; /* E1 OSHS */
-        e1_dvs    =getbitu(rtcm->buff,i, 1);              i+= 1; /* E1 OSDVS */
+        prn       =getbitu(rtcm->frame,i, 6);              i+= 6;
+        week      =getbitu(rtcm->frame,i,12);              i+=12;
+        eph.iode  =getbitu(rtcm->frame,i,10);              i+=10;
+        eph.sva   =getbitu(rtcm->frame,i, 8);              i+= 8;
+        eph.idot  =getbits(rtcm->frame,i,14)*P2_43*SC2RAD; i+=14;
+        toc       =getbitu(rtcm->frame,i,14)*60.0;         i+=14;
+        eph.f2    =getbits(rtcm->frame,i, 6)*P2_59;        i+= 6;
+        eph.f1    =getbits(rtcm->frame,i,21)*P2_46;        i+=21;
+        eph.f0    =getbits(rtcm->frame,i,31)*P2_34;        i+=31;
+        eph.crs   =getbits(rtcm->frame,i,16)*P2_5;         i+=16;
+        eph.deln  =getbits(rtcm->frame,i,16)*P2_43*SC2RAD; i+=16;
+        eph.M0    =getbits(rtcm->frame,i,32)*P2_31*SC2RAD; i+=32;
+        eph.cuc   =getbits(rtcm->frame,i,16)*P2_29;        i+=16;
+        eph.e     =getbitu(rtcm->frame,i,32)*P2_33;        i+=32;
+        eph.cus   =getbits(rtcm->frame,i,16)*P2_29;        i+=16;
+        sqrtA     =getbitu(rtcm->frame,i,32)*P2_19;        i+=32;
+        eph.toes  =getbitu(rtcm->frame,i,14)*60.0;         i+=14;
+        eph.cic   =getbits(rtcm->frame,i,16)*P2_29;        i+=16;
+        eph.OMG0  =getbits(rtcm->frame,i,32)*P2_31*SC2RAD; i+=32;
+        eph.cis   =getbits(rtcm->frame,i,16)*P2_29;        i+=16;
+        eph.i0    =getbits(rtcm->frame,i,32)*P2_31*SC2RAD; i+=32;
+        eph.crc   =getbits(rtcm->frame,i,16)*P2_5;         i+=16;
+        eph.omg   =getbits(rtcm->frame,i,32)*P2_31*SC2RAD; i+=32;
+        eph.OMGd  =getbits(rtcm->frame,i,24)*P2_43*SC2RAD; i+=24;
+        eph.tgd[0]=getbits(rtcm->frame,i,10)*P2_32;        i+=10; /* E5a/E1 */
+        eph.tgd[1]=getbits(rtcm->frame,i,10)*P2_32;        i+=10; /* E5b/E1 */
+        e5b_hs    =getbitu(rtcm->frame,i, 2);              i+= 2; /* E5b OSHS */
+        e5b_dvs   =getbitu(rtcm->frame,i, 1);              i+= 1; /* E5b OSDVS */
+        e1_hs     =getbitu(rtcm->frame,i, 2);              i+= 2; /* E1 OSHS */
+        e1_dvs    =getbitu(rtcm->frame,i, 1);              i+= 1; /* E1 OSDVS */
     }
     else {
         trace(2,"rtcm3 1046 length error: len=%d\n",rtcm->len);
@@ -1707,34 +1708,34 @@ static int decode_type1042(rtcm_t *rtcm)
     int i=24+12,prn,sat,week,sys=SYS_BDS;
     
     if (i+499<=rtcm->len*8) {
-        prn       =getbitu(rtcm->buff,i, 6);              i+= 6;
-        week      =getbitu(rtcm->buff,i,13);              i+=13;
-        eph.sva   =getbitu(rtcm->buff,i, 4);              i+= 4;
-        eph.idot  =getbits(rtcm->buff,i,14)*P2_43*SC2RAD; i+=14;
+        prn       =getbitu(rtcm->frame,i, 6);              i+= 6;
+        week      =getbitu(rtcm->frame,i,13);              i+=13;
+        eph.sva   =getbitu(rtcm->frame,i, 4);              i+= 4;
+        eph.idot  =getbits(rtcm->frame,i,14)*P2_43*SC2RAD; i+=14;
                                                           i+= 5; /* AODE */
-        toc       =getbitu(rtcm->buff,i,17)*8.0;          i+=17;
-        eph.f2    =getbits(rtcm->buff,i,11)*P2_66;        i+=11;
-        eph.f1    =getbits(rtcm->buff,i,22)*P2_50;        i+=22;
-        eph.f0    =getbits(rtcm->buff,i,24)*P2_33;        i+=24;
-        eph.iodc  =getbitu(rtcm->buff,i, 5);              i+= 5; /* AODC */
-        eph.crs   =getbits(rtcm->buff,i,18)*P2_6;         i+=18;
-        eph.deln  =getbits(rtcm->buff,i,16)*P2_43*SC2RAD; i+=16;
-        eph.M0    =getbits(rtcm->buff,i,32)*P2_31*SC2RAD; i+=32;
-        eph.cuc   =getbits(rtcm->buff,i,18)*P2_31;        i+=18;
-        eph.e     =getbitu(rtcm->buff,i,32)*P2_33;        i+=32;
-        eph.cus   =getbits(rtcm->buff,i,18)*P2_31;        i+=18;
-        sqrtA     =getbitu(rtcm->buff,i,32)*P2_19;        i+=32;
-        eph.toes  =getbitu(rtcm->buff,i,17)*8.0;          i+=17;
-        eph.cic   =getbits(rtcm->buff,i,18)*P2_31;        i+=18;
-        eph.OMG0  =getbits(rtcm->buff,i,32)*P2_31*SC2RAD; i+=32;
-        eph.cis   =getbits(rtcm->buff,i,18)*P2_31;        i+=18;
-        eph.i0    =getbits(rtcm->buff,i,32)*P2_31*SC2RAD; i+=32;
-        eph.crc   =getbits(rtcm->buff,i,18)*P2_6;         i+=18;
-        eph.omg   =getbits(rtcm->buff,i,32)*P2_31*SC2RAD; i+=32;
-        eph.OMGd  =getbits(rtcm->buff,i,24)*P2_43*SC2RAD; i+=24;
-        eph.tgd[0]=getbits(rtcm->buff,i,10)*1E-10;        i+=10;
-        eph.tgd[1]=getbits(rtcm->buff,i,10)*1E-10;        i+=10;
-        eph.svh   =getbitu(rtcm->buff,i, 1);              i+= 1;
+        toc       =getbitu(rtcm->frame,i,17)*8.0;          i+=17;
+        eph.f2    =getbits(rtcm->frame,i,11)*P2_66;        i+=11;
+        eph.f1    =getbits(rtcm->frame,i,22)*P2_50;        i+=22;
+        eph.f0    =getbits(rtcm->frame,i,24)*P2_33;        i+=24;
+        eph.iodc  =getbitu(rtcm->frame,i, 5);              i+= 5; /* AODC */
+        eph.crs   =getbits(rtcm->frame,i,18)*P2_6;         i+=18;
+        eph.deln  =getbits(rtcm->frame,i,16)*P2_43*SC2RAD; i+=16;
+        eph.M0    =getbits(rtcm->frame,i,32)*P2_31*SC2RAD; i+=32;
+        eph.cuc   =getbits(rtcm->frame,i,18)*P2_31;        i+=18;
+        eph.e     =getbitu(rtcm->frame,i,32)*P2_33;        i+=32;
+        eph.cus   =getbits(rtcm->frame,i,18)*P2_31;        i+=18;
+        sqrtA     =getbitu(rtcm->frame,i,32)*P2_19;        i+=32;
+        eph.toes  =getbitu(rtcm->frame,i,17)*8.0;          i+=17;
+        eph.cic   =getbits(rtcm->frame,i,18)*P2_31;        i+=18;
+        eph.OMG0  =getbits(rtcm->frame,i,32)*P2_31*SC2RAD; i+=32;
+        eph.cis   =getbits(rtcm->frame,i,18)*P2_31;        i+=18;
+        eph.i0    =getbits(rtcm->frame,i,32)*P2_31*SC2RAD; i+=32;
+        eph.crc   =getbits(rtcm->frame,i,18)*P2_6;         i+=18;
+        eph.omg   =getbits(rtcm->frame,i,32)*P2_31*SC2RAD; i+=32;
+        eph.OMGd  =getbits(rtcm->frame,i,24)*P2_43*SC2RAD; i+=24;
+        eph.tgd[0]=getbits(rtcm->frame,i,10)*1E-10;        i+=10;
+        eph.tgd[1]=getbits(rtcm->frame,i,10)*1E-10;        i+=10;
+        eph.svh   =getbitu(rtcm->frame,i, 1);              i+= 1;
     }
     else {
         trace(2,"rtcm3 1042 length error: len=%d\n",rtcm->len);
@@ -1781,17 +1782,17 @@ static int decode_ssr_epoch(rtcm_t *rtcm, int sys, int subtype)
     if (subtype==0) { /* RTCM SSR */
     
     if (sys==SYS_GLO) {
-        tod=getbitu(rtcm->buff,i,17); i+=17;
+        tod=getbitu(rtcm->frame,i,17); i+=17;
         adjday_glot(rtcm,tod);
     }
     else {
-        tow=getbitu(rtcm->buff,i,20); i+=20;
+        tow=getbitu(rtcm->frame,i,20); i+=20;
         adjweek(rtcm,tow);
     }
     }
     else { /* IGS SSR */
         i+=3+8;
-        tow=getbitu(rtcm->buff,i,20); i+=20;
+        tow=getbitu(rtcm->frame,i,20); i+=20;
         adjweek(rtcm,tow);
     }
     return i;
@@ -1812,18 +1813,18 @@ static int decode_ssr1_head(rtcm_t *rtcm, int sys, int subtype, int *sync,
         if (i+3+8+50+ns>rtcm->len*8) return -1;
     }
     i=decode_ssr_epoch(rtcm,sys,subtype);
-    udi   =getbitu(rtcm->buff,i, 4); i+= 4;
-    *sync =getbitu(rtcm->buff,i, 1); i+= 1;
+    udi   =getbitu(rtcm->frame,i, 4); i+= 4;
+    *sync =getbitu(rtcm->frame,i, 1); i+= 1;
     if (subtype==0) { /* RTCM SSR */
-    *refd =getbitu(rtcm->buff,i, 1); i+= 1; /* satellite ref datum */
+    *refd =getbitu(rtcm->frame,i, 1); i+= 1; /* satellite ref datum */
     }
-    *iod  =getbitu(rtcm->buff,i, 4); i+= 4; /* IOD SSR */
-    provid=getbitu(rtcm->buff,i,16); i+=16; /* provider ID */
-    solid =getbitu(rtcm->buff,i, 4); i+= 4; /* solution ID */
+    *iod  =getbitu(rtcm->frame,i, 4); i+= 4; /* IOD SSR */
+    provid=getbitu(rtcm->frame,i,16); i+=16; /* provider ID */
+    solid =getbitu(rtcm->frame,i, 4); i+= 4; /* solution ID */
     if (subtype>0) { /* IGS SSR */
-        *refd=getbitu(rtcm->buff,i,1); i+=1; /* global/regional CRS indicator */
+        *refd=getbitu(rtcm->frame,i,1); i+=1; /* global/regional CRS indicator */
     }
-    nsat  =getbitu(rtcm->buff,i,ns); i+=ns;
+    nsat  =getbitu(rtcm->frame,i,ns); i+=ns;
     *udint=ssrudint[udi];
     
     time2str(rtcm->time,tstr,2);
@@ -1854,12 +1855,12 @@ static int decode_ssr2_head(rtcm_t *rtcm, int sys, int subtype, int *sync,
         if (i+3+8+49+ns>rtcm->len*8) return -1;
     }
     i=decode_ssr_epoch(rtcm,sys,subtype);
-    udi   =getbitu(rtcm->buff,i, 4); i+= 4;
-    *sync =getbitu(rtcm->buff,i, 1); i+= 1;
-    *iod  =getbitu(rtcm->buff,i, 4); i+= 4;
-    provid=getbitu(rtcm->buff,i,16); i+=16; /* provider ID */
-    solid =getbitu(rtcm->buff,i, 4); i+= 4; /* solution ID */
-    nsat  =getbitu(rtcm->buff,i,ns); i+=ns;
+    udi   =getbitu(rtcm->frame,i, 4); i+= 4;
+    *sync =getbitu(rtcm->frame,i, 1); i+= 1;
+    *iod  =getbitu(rtcm->frame,i, 4); i+= 4;
+    provid=getbitu(rtcm->frame,i,16); i+=16; /* provider ID */
+    solid =getbitu(rtcm->frame,i, 4); i+= 4; /* solution ID */
+    nsat  =getbitu(rtcm->frame,i,ns); i+=ns;
     *udint=ssrudint[udi];
     
     time2str(rtcm->time,tstr,2);
@@ -1880,7 +1881,7 @@ static int decode_ssr1(rtcm_t *rtcm, int sys, int subtype)
     double udint,deph[3],ddeph[3];
     int i,j,k,type,sync,iod,nsat,prn,sat,iode,iodcrc=0,refd=0,np,ni,nj,offp;
     
-    type=getbitu(rtcm->buff,24,12);
+    type=getbitu(rtcm->frame,24,12);
     
     if ((nsat=decode_ssr1_head(rtcm,sys,subtype,&sync,&iod,&udint,&refd,&i))<0) {
         trace(2,"rtcm3 %d/%d length error: len=%d\n",type,subtype,rtcm->len);
@@ -1900,15 +1901,15 @@ static int decode_ssr1(rtcm_t *rtcm, int sys, int subtype)
         if (sys==SYS_SBS) offp=119;
     }
     for (j=0;j<nsat&&i+121+np+ni+nj<=rtcm->len*8;j++) {
-        prn     =getbitu(rtcm->buff,i,np)+offp; i+=np;
-        iode    =getbitu(rtcm->buff,i,ni);      i+=ni;
-        iodcrc  =getbitu(rtcm->buff,i,nj);      i+=nj;
-        deph [0]=getbits(rtcm->buff,i,22)*1E-4; i+=22;
-        deph [1]=getbits(rtcm->buff,i,20)*4E-4; i+=20;
-        deph [2]=getbits(rtcm->buff,i,20)*4E-4; i+=20;
-        ddeph[0]=getbits(rtcm->buff,i,21)*1E-6; i+=21;
-        ddeph[1]=getbits(rtcm->buff,i,19)*4E-6; i+=19;
-        ddeph[2]=getbits(rtcm->buff,i,19)*4E-6; i+=19;
+        prn     =getbitu(rtcm->frame,i,np)+offp; i+=np;
+        iode    =getbitu(rtcm->frame,i,ni);      i+=ni;
+        iodcrc  =getbitu(rtcm->frame,i,nj);      i+=nj;
+        deph [0]=getbits(rtcm->frame,i,22)*1E-4; i+=22;
+        deph [1]=getbits(rtcm->frame,i,20)*4E-4; i+=20;
+        deph [2]=getbits(rtcm->frame,i,20)*4E-4; i+=20;
+        ddeph[0]=getbits(rtcm->frame,i,21)*1E-6; i+=21;
+        ddeph[1]=getbits(rtcm->frame,i,19)*4E-6; i+=19;
+        ddeph[2]=getbits(rtcm->frame,i,19)*4E-6; i+=19;
         
         if (!(sat=satno(sys,prn))) {
             trace(2,"rtcm3 %d/%d satellite number error: prn=%d\n",type,subtype,prn);
@@ -1938,7 +1939,7 @@ static int decode_ssr2(rtcm_t *rtcm, int sys, int subtype)
     double udint,dclk[3];
     int i,j,k,type,sync,iod,nsat,prn,sat,np,offp;
     
-    type=getbitu(rtcm->buff,24,12);
+    type=getbitu(rtcm->frame,24,12);
     
     if ((nsat=decode_ssr2_head(rtcm,sys,subtype,&sync,&iod,&udint,&i))<0) {
         trace(2,"rtcm3 %d/%d length error: len=%d\n",type,subtype,rtcm->len);
@@ -1958,10 +1959,10 @@ static int decode_ssr2(rtcm_t *rtcm, int sys, int subtype)
         if (sys==SYS_SBS) offp=119;
     }
     for (j=0;j<nsat&&i+70+np<=rtcm->len*8;j++) {
-        prn    =getbitu(rtcm->buff,i,np)+offp; i+=np;
-        dclk[0]=getbits(rtcm->buff,i,22)*1E-4; i+=22;
-        dclk[1]=getbits(rtcm->buff,i,21)*1E-6; i+=21;
-        dclk[2]=getbits(rtcm->buff,i,27)*2E-8; i+=27;
+        prn    =getbitu(rtcm->frame,i,np)+offp; i+=np;
+        dclk[0]=getbits(rtcm->frame,i,22)*1E-4; i+=22;
+        dclk[1]=getbits(rtcm->frame,i,21)*1E-6; i+=21;
+        dclk[2]=getbits(rtcm->frame,i,27)*2E-8; i+=27;
         
         if (!(sat=satno(sys,prn))) {
             trace(2,"rtcm3 %d/%d satellite number error: prn=%d\n",type,subtype,prn);
@@ -1985,7 +1986,7 @@ static int decode_ssr3(rtcm_t *rtcm, int sys, int subtype)
     double udint,bias,cbias[MAXCODE];
     int i,j,k,type,mode,sync,iod,nsat,prn,sat,nbias,np,offp;
     
-    type=getbitu(rtcm->buff,24,12);
+    type=getbitu(rtcm->frame,24,12);
     
     if ((nsat=decode_ssr2_head(rtcm,sys,subtype,&sync,&iod,&udint,&i))<0) {
         trace(2,"rtcm3 %d/%d length error: len=%d\n",type,subtype,rtcm->len);
@@ -2013,13 +2014,13 @@ static int decode_ssr3(rtcm_t *rtcm, int sys, int subtype)
       }
     }
     for (j=0;j<nsat&&i+5+np<=rtcm->len*8;j++) {
-        prn  =getbitu(rtcm->buff,i,np)+offp; i+=np;
-        nbias=getbitu(rtcm->buff,i, 5);      i+= 5;
+        prn  =getbitu(rtcm->frame,i,np)+offp; i+=np;
+        nbias=getbitu(rtcm->frame,i, 5);      i+= 5;
         
         for (k=0;k<MAXCODE;k++) cbias[k]=0.0;
         for (k=0;k<nbias&&i+19<=rtcm->len*8;k++) {
-            mode=getbitu(rtcm->buff,i, 5);      i+= 5;
-            bias=getbits(rtcm->buff,i,14)*0.01; i+=14;
+            mode=getbitu(rtcm->frame,i, 5);      i+= 5;
+            bias=getbits(rtcm->frame,i,14)*0.01; i+=14;
             if (sigs[mode]) {
                 cbias[sigs[mode]-1]=bias;
             }
@@ -2048,7 +2049,7 @@ static int decode_ssr4(rtcm_t *rtcm, int sys, int subtype)
     double udint,deph[3],ddeph[3],dclk[3];
     int i,j,k,type,nsat,sync,iod,prn,sat,iode,iodcrc=0,refd=0,np,ni,nj,offp;
     
-    type=getbitu(rtcm->buff,24,12);
+    type=getbitu(rtcm->frame,24,12);
     
     if ((nsat=decode_ssr1_head(rtcm,sys,subtype,&sync,&iod,&udint,&refd,&i))<0) {
         trace(2,"rtcm3 %d/%d length error: len=%d\n",type,subtype,rtcm->len);
@@ -2068,19 +2069,19 @@ static int decode_ssr4(rtcm_t *rtcm, int sys, int subtype)
         if (sys==SYS_SBS) offp=119;
     }
     for (j=0;j<nsat&&i+191+np+ni+nj<=rtcm->len*8;j++) {
-        prn     =getbitu(rtcm->buff,i,np)+offp; i+=np;
-        iode    =getbitu(rtcm->buff,i,ni);      i+=ni;
-        iodcrc  =getbitu(rtcm->buff,i,nj);      i+=nj;
-        deph [0]=getbits(rtcm->buff,i,22)*1E-4; i+=22;
-        deph [1]=getbits(rtcm->buff,i,20)*4E-4; i+=20;
-        deph [2]=getbits(rtcm->buff,i,20)*4E-4; i+=20;
-        ddeph[0]=getbits(rtcm->buff,i,21)*1E-6; i+=21;
-        ddeph[1]=getbits(rtcm->buff,i,19)*4E-6; i+=19;
-        ddeph[2]=getbits(rtcm->buff,i,19)*4E-6; i+=19;
+        prn     =getbitu(rtcm->frame,i,np)+offp; i+=np;
+        iode    =getbitu(rtcm->frame,i,ni);      i+=ni;
+        iodcrc  =getbitu(rtcm->frame,i,nj);      i+=nj;
+        deph [0]=getbits(rtcm->frame,i,22)*1E-4; i+=22;
+        deph [1]=getbits(rtcm->frame,i,20)*4E-4; i+=20;
+        deph [2]=getbits(rtcm->frame,i,20)*4E-4; i+=20;
+        ddeph[0]=getbits(rtcm->frame,i,21)*1E-6; i+=21;
+        ddeph[1]=getbits(rtcm->frame,i,19)*4E-6; i+=19;
+        ddeph[2]=getbits(rtcm->frame,i,19)*4E-6; i+=19;
         
-        dclk [0]=getbits(rtcm->buff,i,22)*1E-4; i+=22;
-        dclk [1]=getbits(rtcm->buff,i,21)*1E-6; i+=21;
-        dclk [2]=getbits(rtcm->buff,i,27)*2E-8; i+=27;
+        dclk [0]=getbits(rtcm->frame,i,22)*1E-4; i+=22;
+        dclk [1]=getbits(rtcm->frame,i,21)*1E-6; i+=21;
+        dclk [2]=getbits(rtcm->frame,i,27)*2E-8; i+=27;
         
         if (!(sat=satno(sys,prn))) {
             trace(2,"rtcm3 %d/%d satellite number error: prn=%d\n",type,subtype,prn);
@@ -2111,7 +2112,7 @@ static int decode_ssr5(rtcm_t *rtcm, int sys, int subtype)
     double udint;
     int i,j,type,nsat,sync,iod,prn,sat,ura,np,offp;
     
-    type=getbitu(rtcm->buff,24,12);
+    type=getbitu(rtcm->frame,24,12);
     
     if ((nsat=decode_ssr2_head(rtcm,sys,subtype,&sync,&iod,&udint,&i))<0) {
         trace(2,"rtcm3 %d/%d length error: len=%d\n",type,subtype,rtcm->len);
@@ -2131,8 +2132,8 @@ static int decode_ssr5(rtcm_t *rtcm, int sys, int subtype)
         if (sys==SYS_SBS) offp=119;
     }
     for (j=0;j<nsat&&i+6+np<=rtcm->len*8;j++) {
-        prn=getbitu(rtcm->buff,i,np)+offp; i+=np;
-        ura=getbitu(rtcm->buff,i, 6);      i+= 6;
+        prn=getbitu(rtcm->frame,i,np)+offp; i+=np;
+        ura=getbitu(rtcm->frame,i, 6);      i+= 6;
         
         if (!(sat=satno(sys,prn))) {
             trace(2,"rtcm3 %d/%d satellite number error: prn=%d\n",type,subtype,prn);
@@ -2152,7 +2153,7 @@ static int decode_ssr6(rtcm_t *rtcm, int sys, int subtype)
     double udint,hrclk;
     int i,j,type,nsat,sync,iod,prn,sat,np,offp;
     
-    type=getbitu(rtcm->buff,24,12);
+    type=getbitu(rtcm->frame,24,12);
     
     if ((nsat=decode_ssr2_head(rtcm,sys,subtype,&sync,&iod,&udint,&i))<0) {
         trace(2,"rtcm3 %d/%d length error: len=%d\n",type,subtype,rtcm->len);
@@ -2172,8 +2173,8 @@ static int decode_ssr6(rtcm_t *rtcm, int sys, int subtype)
         if (sys==SYS_SBS) offp=119;
     }
     for (j=0;j<nsat&&i+22+np<=rtcm->len*8;j++) {
-        prn  =getbitu(rtcm->buff,i,np)+offp; i+=np;
-        hrclk=getbits(rtcm->buff,i,22)*1E-4; i+=22;
+        prn  =getbitu(rtcm->frame,i,np)+offp; i+=np;
+        hrclk=getbits(rtcm->frame,i,22)*1E-4; i+=22;
         
         if (!(sat=satno(sys,prn))) {
             trace(2,"rtcm3 %d/%d satellite number error: prn=%d\n",type,subtype,prn);
@@ -2204,14 +2205,14 @@ static int decode_ssr7_head(rtcm_t *rtcm, int sys, int subtype, int *sync,
         if (i+3+8+51+ns>rtcm->len*8) return -1;
     }
     i=decode_ssr_epoch(rtcm,sys,subtype);
-    udi   =getbitu(rtcm->buff,i, 4); i+= 4;
-    *sync =getbitu(rtcm->buff,i, 1); i+= 1;
-    *iod  =getbitu(rtcm->buff,i, 4); i+= 4;
-    provid=getbitu(rtcm->buff,i,16); i+=16; /* provider ID */
-    solid =getbitu(rtcm->buff,i, 4); i+= 4; /* solution ID */
-    *dispe=getbitu(rtcm->buff,i, 1); i+= 1; /* dispersive bias consistency ind */
-    *mw   =getbitu(rtcm->buff,i, 1); i+= 1; /* MW consistency indicator */
-    nsat  =getbitu(rtcm->buff,i,ns); i+=ns;
+    udi   =getbitu(rtcm->frame,i, 4); i+= 4;
+    *sync =getbitu(rtcm->frame,i, 1); i+= 1;
+    *iod  =getbitu(rtcm->frame,i, 4); i+= 4;
+    provid=getbitu(rtcm->frame,i,16); i+=16; /* provider ID */
+    solid =getbitu(rtcm->frame,i, 4); i+= 4; /* solution ID */
+    *dispe=getbitu(rtcm->frame,i, 1); i+= 1; /* dispersive bias consistency ind */
+    *mw   =getbitu(rtcm->frame,i, 1); i+= 1; /* MW consistency indicator */
+    nsat  =getbitu(rtcm->frame,i,ns); i+=ns;
     *udint=ssrudint[udi];
     
     time2str(rtcm->time,tstr,2);
@@ -2234,7 +2235,7 @@ static int decode_ssr7(rtcm_t *rtcm, int sys, int subtype)
     int i,j,k,type,mode,sync,iod,nsat,prn,sat,nbias,np,mw,offp,sii,swl;
     int dispe,sdc,yaw_ang,yaw_rate;
     
-    type=getbitu(rtcm->buff,24,12);
+    type=getbitu(rtcm->frame,24,12);
     
     if ((nsat=decode_ssr7_head(rtcm,sys,subtype,&sync,&iod,&udint,&dispe,&mw,
                                &i))<0) {
@@ -2263,18 +2264,18 @@ static int decode_ssr7(rtcm_t *rtcm, int sys, int subtype)
       }
     }
     for (j=0;j<nsat&&i+5+17+np<=rtcm->len*8;j++) {
-        prn     =getbitu(rtcm->buff,i,np)+offp; i+=np;
-        nbias   =getbitu(rtcm->buff,i, 5);      i+= 5;
-        yaw_ang =getbitu(rtcm->buff,i, 9);      i+= 9;
-        yaw_rate=getbits(rtcm->buff,i, 8);      i+= 8;
+        prn     =getbitu(rtcm->frame,i,np)+offp; i+=np;
+        nbias   =getbitu(rtcm->frame,i, 5);      i+= 5;
+        yaw_ang =getbitu(rtcm->frame,i, 9);      i+= 9;
+        yaw_rate=getbits(rtcm->frame,i, 8);      i+= 8;
         
         for (k=0;k<MAXCODE;k++) pbias[k]=0.0;
         for (k=0;k<nbias&&i+((subtype==0)?49:32)<=rtcm->len*8;k++) {
-            mode=getbitu(rtcm->buff,i, 5); i+= 5;
-            sii =getbitu(rtcm->buff,i, 1); i+= 1; /* integer-indicator */
-            swl =getbitu(rtcm->buff,i, 2); i+= 2; /* WL integer-indicator */
-            sdc =getbitu(rtcm->buff,i, 4); i+= 4; /* discontinuity counter */
-            bias=getbits(rtcm->buff,i,20); i+=20; /* phase bias (m) */
+            mode=getbitu(rtcm->frame,i, 5); i+= 5;
+            sii =getbitu(rtcm->frame,i, 1); i+= 1; /* integer-indicator */
+            swl =getbitu(rtcm->frame,i, 2); i+= 2; /* WL integer-indicator */
+            sdc =getbitu(rtcm->frame,i, 4); i+= 4; /* discontinuity counter */
+            bias=getbits(rtcm->frame,i,20); i+=20; /* phase bias (m) */
             if (sigs[mode]) {
                 pbias[sigs[mode]-1]=bias*0.0001; /* (m) */
             }
@@ -2305,17 +2306,21 @@ static int decode_ssr8(rtcm_t *rtcm, int subtype)
     int i=0,type,sync,iod,udi,nlay,nmax,mmax,qi;
     char *msg,tstr[40];
 
-    type=getbitu(rtcm->buff,24,12);
+    type=getbitu(rtcm->frame,24,12);
 
+    if (24+12+(subtype==0?20:31)+40>rtcm->len*8) {
+        trace(2,"rtcm3 %d length error: len=%d\n",type,rtcm->len);
+        return -1;
+    }
     i+=decode_ssr_epoch(rtcm,SYS_GPS,subtype);
-    udi  =getbitu(rtcm->buff,i, 4);             i+= 4;
+    udi  =getbitu(rtcm->frame,i, 4);             i+= 4;
     udint=ssrudint[udi];
-    sync =getbitu(rtcm->buff,i,1);              i+= 1;
-    iod  =getbitu(rtcm->buff,i,4);              i+= 4;
-    getbitu(rtcm->buff,i,16);                   i+=16; /* provider ID */
-    getbitu(rtcm->buff,i, 4);                   i+= 4; /* solution ID */
-    qi   =getbitu(rtcm->buff,i,9);              i+= 9; /* quality indicator */
-    nlay =getbitu(rtcm->buff,i,2)+1;            i+= 2;  /* number of layers (1-4) */
+    sync =getbitu(rtcm->frame,i,1);              i+= 1;
+    iod  =getbitu(rtcm->frame,i,4);              i+= 4;
+    getbitu(rtcm->frame,i,16);                   i+=16; /* provider ID */
+    getbitu(rtcm->frame,i, 4);                   i+= 4; /* solution ID */
+    qi   =getbitu(rtcm->frame,i,9);              i+= 9; /* quality indicator */
+    nlay =getbitu(rtcm->frame,i,2)+1;            i+= 2;  /* number of layers (1-4) */
 
     if (rtcm->outtype) {
         time2str(rtcm->time,tstr,2);
@@ -2329,9 +2334,9 @@ static int decode_ssr8(rtcm_t *rtcm, int subtype)
     }
 
     for (int j=0;j<nlay&&i+16<=rtcm->len*8;j++) {
-        hgt         =getbitu(rtcm->buff,i,8)*10;     i+=8; /* height (km) DF472 */
-        nmax        =getbitu(rtcm->buff,i, 4)+1;     i+= 4; /* degree DF473 */
-        mmax        =getbitu(rtcm->buff,i, 4)+1;     i+= 4; /* order  DF474 */
+        hgt         =getbitu(rtcm->frame,i,8)*10;     i+=8; /* height (km) DF472 */
+        nmax        =getbitu(rtcm->frame,i, 4)+1;     i+= 4; /* degree DF473 */
+        mmax        =getbitu(rtcm->frame,i, 4)+1;     i+= 4; /* order  DF474 */
 
         rtcm->nav.vtec.hgt[j]=hgt;
         rtcm->nav.vtec.nmax[j]=nmax;
@@ -2343,14 +2348,14 @@ static int decode_ssr8(rtcm_t *rtcm, int subtype)
         /* cosine coefficients: for order o=0..mmax, degree n=o..nmax */
         for (int m=0;m<=mmax;m++) {
             for (int n=m;n<=nmax&&i+16<=rtcm->len*8;n++) {
-                cosC=getbits(rtcm->buff,i,16); i+=16;
+                cosC=getbits(rtcm->frame,i,16); i+=16;
                 rtcm->nav.vtec.cosC[j][n][m]=cosC/200.0;
             }
         }
         /* sine coefficients: for order o=1..mmax, degree n=o..nmax */
         for (int m=1;m<=mmax;m++) {
             for (int n=m;n<=nmax&&i+16<=rtcm->len*8;n++) {
-                sinC=getbits(rtcm->buff,i,16); i+=16;
+                sinC=getbits(rtcm->frame,i,16); i+=16;
                 rtcm->nav.vtec.sinC[j][n][m]=sinC/200.0;
             }
         }
@@ -2373,7 +2378,7 @@ static void save_msm_obs(rtcm_t *rtcm, int sys, msm_h_t *h, const double *r,
     char *msm_type="",*q=NULL;
     int i,j,k,type,prn,sat,fcn,index=0;
     
-    type=getbitu(rtcm->buff,24,12);
+    type=getbitu(rtcm->frame,24,12);
 
     switch (sys) {
         case SYS_GPS: msm_type=q=rtcm->msmtype[0]; break;
@@ -2473,48 +2478,49 @@ static void save_msm_obs(rtcm_t *rtcm, int sys, msm_h_t *h, const double *r,
 }
 /* decode type MSM message header --------------------------------------------*/
 static int decode_msm_head(rtcm_t *rtcm, int sys, int *sync, int *iod,
-                           msm_h_t *h, int *hsize)
+                           msm_h_t *h, bitrd_t *b)
 {
     msm_h_t h0={0};
     double tow,tod;
     char *msg,tstr[40];
-    int i=24,j,dow,mask,staid,type,ncell=0;
+    int j,dow,mask,staid,type,ncell=0;
     
     if (rtcm->obsflag) rtcm->obs.n = rtcm->obsflag = 0;
 
-    type=getbitu(rtcm->buff,i,12); i+=12;
+    initbitrd(b,rtcm->frame,rtcm->len,24);
+    type=rdbitu(b,12);
     
     *h=h0;
-    if (i+157<=rtcm->len*8) {
-        staid     =getbitu(rtcm->buff,i,12);       i+=12;
+    if (bitrdpos(b)+157<=rtcm->len*8) {
+        staid     =rdbitu(b,12);
         
         if (sys==SYS_GLO) {
-            dow   =getbitu(rtcm->buff,i, 3);       i+= 3;
-            tod   =getbitu(rtcm->buff,i,27)*0.001; i+=27;
+            dow   =rdbitu(b,3);
+            tod   =rdbitu(b,27)*0.001;
             adjday_glot(rtcm,tod);
         }
         else if (sys==SYS_BDS) {
-            tow   =getbitu(rtcm->buff,i,30)*0.001; i+=30;
+            tow   =rdbitu(b,30)*0.001;
             tow+=14.0; /* BDT -> GPST */
             adjweek(rtcm,tow);
         }
         else {
-            tow   =getbitu(rtcm->buff,i,30)*0.001; i+=30;
+            tow   =rdbitu(b,30)*0.001;
             adjweek(rtcm,tow);
         }
-        *sync     =getbitu(rtcm->buff,i, 1);       i+= 1;
-        *iod      =getbitu(rtcm->buff,i, 3);       i+= 3;
-        h->time_s =getbitu(rtcm->buff,i, 7);       i+= 7;
-        h->clk_str=getbitu(rtcm->buff,i, 2);       i+= 2;
-        h->clk_ext=getbitu(rtcm->buff,i, 2);       i+= 2;
-        h->smooth =getbitu(rtcm->buff,i, 1);       i+= 1;
-        h->tint_s =getbitu(rtcm->buff,i, 3);       i+= 3;
+        *sync     =rdbitu(b,1);
+        *iod      =rdbitu(b,3);
+        h->time_s =rdbitu(b,7);
+        h->clk_str=rdbitu(b,2);
+        h->clk_ext=rdbitu(b,2);
+        h->smooth =rdbitu(b,1);
+        h->tint_s =rdbitu(b,3);
         for (j=1;j<=64;j++) {
-            mask=getbitu(rtcm->buff,i,1); i+=1;
+            mask=rdbitu(b,1);
             if (mask) h->sats[h->nsat++]=j;
         }
         for (j=1;j<=32;j++) {
-            mask=getbitu(rtcm->buff,i,1); i+=1;
+            mask=rdbitu(b,1);
             if (mask) h->sigs[h->nsig++]=j;
         }
     }
@@ -2530,16 +2536,15 @@ static int decode_msm_head(rtcm_t *rtcm, int sys, int *sync, int *iod,
               type,h->nsat,h->nsig);
         return -1;
     }
-    if (i+h->nsat*h->nsig>rtcm->len*8) {
+    if (bitrdpos(b)+h->nsat*h->nsig>rtcm->len*8) {
         trace(2,"rtcm3 %d length error: len=%d nsat=%d nsig=%d\n",type,
               rtcm->len,h->nsat,h->nsig);
         return -1;
     }
     for (j=0;j<h->nsat*h->nsig;j++) {
-        h->cellmask[j]=getbitu(rtcm->buff,i,1); i+=1;
+        h->cellmask[j]=rdbitu(b,1);
         if (h->cellmask[j]) ncell++;
     }
-    *hsize=i;
     
     time2str(rtcm->time,tstr,2);
     trace(4,"decode_head_msm: time=%s sys=%d staid=%d nsat=%d nsig=%d sync=%d iod=%d ncell=%d\n",
@@ -2556,8 +2561,9 @@ static int decode_msm_head(rtcm_t *rtcm, int sys, int *sync, int *iod,
 static int decode_msm0(rtcm_t *rtcm, int sys)
 {
     msm_h_t h={0};
-    int i,sync,iod;
-    if (decode_msm_head(rtcm,sys,&sync,&iod,&h,&i)<0) return -1;
+    bitrd_t b;
+    int sync,iod;
+    if (decode_msm_head(rtcm,sys,&sync,&iod,&h,&b)<0) return -1;
     rtcm->obsflag=!sync;
     return sync?0:1;
 }
@@ -2565,15 +2571,16 @@ static int decode_msm0(rtcm_t *rtcm, int sys)
 static int decode_msm4(rtcm_t *rtcm, int sys)
 {
     msm_h_t h={0};
+    bitrd_t b;
     double r[64],pr[64],cp[64],cnr[64];
-    int i,j,type,sync,iod,ncell,rng,rng_m,prv,cpv,lti[64],half[64];
+    int j,type,sync,iod,ncell,rng,rng_m,prv,cpv,lti[64],half[64];
     
-    type=getbitu(rtcm->buff,24,12);
+    type=getbitu(rtcm->frame,24,12);
     
     /* decode msm header */
-    if ((ncell=decode_msm_head(rtcm,sys,&sync,&iod,&h,&i))<0) return -1;
+    if ((ncell=decode_msm_head(rtcm,sys,&sync,&iod,&h,&b))<0) return -1;
     
-    if (i+h.nsat*18+ncell*48>rtcm->len*8) {
+    if (bitrdpos(&b)+h.nsat*18+ncell*48>rtcm->len*8) {
         trace(2,"rtcm3 %d length error: nsat=%d ncell=%d len=%d\n",type,h.nsat,
               ncell,rtcm->len);
         rtcm->obsflag=!sync;  /* header ok, so return sync bit */
@@ -2589,30 +2596,30 @@ static int decode_msm4(rtcm_t *rtcm, int sys)
     
     /* decode satellite data */
     for (j=0;j<h.nsat;j++) { /* range */
-        rng  =getbitu(rtcm->buff,i, 8); i+= 8;
+        rng  =rdbitu(&b,8);
         if (rng!=255) r[j]=rng*RANGE_MS;
     }
     for (j=0;j<h.nsat;j++) {
-        rng_m=getbitu(rtcm->buff,i,10); i+=10;
+        rng_m=rdbitu(&b,10);
         if (r[j]!=0.0) r[j]+=rng_m*P2_10*RANGE_MS;
     }
     /* decode signal data */
     for (j=0;j<ncell;j++) { /* pseudorange */
-        prv=getbits(rtcm->buff,i,15); i+=15;
+        prv=rdbits(&b,15);
         if (prv!=-16384) pr[j]=prv*P2_24*RANGE_MS;
     }
     for (j=0;j<ncell;j++) { /* phaserange */
-        cpv=getbits(rtcm->buff,i,22); i+=22;
+        cpv=rdbits(&b,22);
         if (cpv!=-2097152) cp[j]=cpv*P2_29*RANGE_MS;
     }
     for (j=0;j<ncell;j++) { /* lock time indicator */
-        lti[j]=getbitu(rtcm->buff,i,4); i+=4;
+        lti[j]=rdbitu(&b,4);
     }
     for (j=0;j<ncell;j++) { /* half-cycle ambiguity */
-        half[j]=getbitu(rtcm->buff,i,1); i+=1;
+        half[j]=rdbitu(&b,1);
     }
     for (j=0;j<ncell;j++) { /* cnr */
-        cnr[j]=getbitu(rtcm->buff,i,6)*1.0; i+=6;
+        cnr[j]=rdbitu(&b,6)*1.0;
     }
     /* save obs data in msm message */
     save_msm_obs(rtcm,sys,&h,r,pr,cp,NULL,NULL,cnr,lti,4,NULL,half);
@@ -2624,16 +2631,17 @@ static int decode_msm4(rtcm_t *rtcm, int sys)
 static int decode_msm5(rtcm_t *rtcm, int sys)
 {
     msm_h_t h={0};
+    bitrd_t b;
     double r[64],rr[64],pr[64],cp[64],rrf[64],cnr[64];
-    int i,j,type,sync,iod,ncell,rng,rng_m,rate,prv,cpv,rrv,lti[64];
+    int j,type,sync,iod,ncell,rng,rng_m,rate,prv,cpv,rrv,lti[64];
     int ex[64],half[64];
     
-    type=getbitu(rtcm->buff,24,12);
+    type=getbitu(rtcm->frame,24,12);
     
     /* decode msm header */
-    if ((ncell=decode_msm_head(rtcm,sys,&sync,&iod,&h,&i))<0) return -1;
+    if ((ncell=decode_msm_head(rtcm,sys,&sync,&iod,&h,&b))<0) return -1;
     
-    if (i+h.nsat*36+ncell*63>rtcm->len*8) {
+    if (bitrdpos(&b)+h.nsat*36+ncell*63>rtcm->len*8) {
         trace(2,"rtcm3 %d length error: nsat=%d ncell=%d len=%d\n",type,h.nsat,
               ncell,rtcm->len);
         rtcm->obsflag=!sync;  /* header ok, so return sync bit */
@@ -2650,40 +2658,40 @@ static int decode_msm5(rtcm_t *rtcm, int sys)
     
     /* decode satellite data */
     for (j=0;j<h.nsat;j++) { /* range */
-        rng  =getbitu(rtcm->buff,i, 8); i+= 8;
+        rng  =rdbitu(&b,8);
         if (rng!=255) r[j]=rng*RANGE_MS;
     }
     for (j=0;j<h.nsat;j++) { /* extended info */
-        ex[j]=getbitu(rtcm->buff,i, 4); i+= 4;
+        ex[j]=rdbitu(&b,4);
     }
     for (j=0;j<h.nsat;j++) {
-        rng_m=getbitu(rtcm->buff,i,10); i+=10;
+        rng_m=rdbitu(&b,10);
         if (r[j]!=0.0) r[j]+=rng_m*P2_10*RANGE_MS;
     }
     for (j=0;j<h.nsat;j++) { /* phaserangerate */
-        rate =getbits(rtcm->buff,i,14); i+=14;
+        rate =rdbits(&b,14);
         if (rate!=-8192) rr[j]=rate*1.0;
     }
     /* decode signal data */
     for (j=0;j<ncell;j++) { /* pseudorange */
-        prv=getbits(rtcm->buff,i,15); i+=15;
+        prv=rdbits(&b,15);
         if (prv!=-16384) pr[j]=prv*P2_24*RANGE_MS;
     }
     for (j=0;j<ncell;j++) { /* phaserange */
-        cpv=getbits(rtcm->buff,i,22); i+=22;
+        cpv=rdbits(&b,22);
         if (cpv!=-2097152) cp[j]=cpv*P2_29*RANGE_MS;
     }
     for (j=0;j<ncell;j++) { /* lock time indicator */
-        lti[j]=getbitu(rtcm->buff,i,4); i+=4;
+        lti[j]=rdbitu(&b,4);
     }
     for (j=0;j<ncell;j++) { /* half-cycle ambiguity */
-        half[j]=getbitu(rtcm->buff,i,1); i+=1;
+        half[j]=rdbitu(&b,1);
     }
     for (j=0;j<ncell;j++) { /* cnr */
-        cnr[j]=getbitu(rtcm->buff,i,6)*1.0; i+=6;
+        cnr[j]=rdbitu(&b,6)*1.0;
     }
     for (j=0;j<ncell;j++) { /* phaserangerate */
-        rrv=getbits(rtcm->buff,i,15); i+=15;
+        rrv=rdbits(&b,15);
         if (rrv!=-16384) rrf[j]=rrv*0.0001;
     }
     /* save obs data in msm message */
@@ -2696,15 +2704,16 @@ static int decode_msm5(rtcm_t *rtcm, int sys)
 static int decode_msm6(rtcm_t *rtcm, int sys)
 {
     msm_h_t h={0};
+    bitrd_t b;
     double r[64],pr[64],cp[64],cnr[64];
-    int i,j,type,sync,iod,ncell,rng,rng_m,prv,cpv,lti[64],half[64];
+    int j,type,sync,iod,ncell,rng,rng_m,prv,cpv,lti[64],half[64];
     
-    type=getbitu(rtcm->buff,24,12);
+    type=getbitu(rtcm->frame,24,12);
     
     /* decode msm header */
-    if ((ncell=decode_msm_head(rtcm,sys,&sync,&iod,&h,&i))<0) return -1;
+    if ((ncell=decode_msm_head(rtcm,sys,&sync,&iod,&h,&b))<0) return -1;
     
-    if (i+h.nsat*18+ncell*65>rtcm->len*8) {
+    if (bitrdpos(&b)+h.nsat*18+ncell*65>rtcm->len*8) {
         trace(2,"rtcm3 %d length error: nsat=%d ncell=%d len=%d\n",type,h.nsat,
               ncell,rtcm->len);
         rtcm->obsflag=!sync;  /* header ok, so return sync bit */
@@ -2719,30 +2728,30 @@ static int decode_msm6(rtcm_t *rtcm, int sys)
     
     /* decode satellite data */
     for (j=0;j<h.nsat;j++) { /* range */
-        rng  =getbitu(rtcm->buff,i, 8); i+= 8;
+        rng  =rdbitu(&b,8);
         if (rng!=255) r[j]=rng*RANGE_MS;
     }
     for (j=0;j<h.nsat;j++) {
-        rng_m=getbitu(rtcm->buff,i,10); i+=10;
+        rng_m=rdbitu(&b,10);
         if (r[j]!=0.0) r[j]+=rng_m*P2_10*RANGE_MS;
     }
     /* decode signal data */
     for (j=0;j<ncell;j++) { /* pseudorange */
-        prv=getbits(rtcm->buff,i,20); i+=20;
+        prv=rdbits(&b,20);
         if (prv!=-524288) pr[j]=prv*P2_29*RANGE_MS;
     }
     for (j=0;j<ncell;j++) { /* phaserange */
-        cpv=getbits(rtcm->buff,i,24); i+=24;
+        cpv=rdbits(&b,24);
         if (cpv!=-8388608) cp[j]=cpv*P2_31*RANGE_MS;
     }
     for (j=0;j<ncell;j++) { /* lock time indicator */
-        lti[j]=getbitu(rtcm->buff,i,10); i+=10;
+        lti[j]=rdbitu(&b,10);
     }
     for (j=0;j<ncell;j++) { /* half-cycle ambiguity */
-        half[j]=getbitu(rtcm->buff,i,1); i+=1;
+        half[j]=rdbitu(&b,1);
     }
     for (j=0;j<ncell;j++) { /* cnr */
-        cnr[j]=getbitu(rtcm->buff,i,10)*0.0625; i+=10;
+        cnr[j]=rdbitu(&b,10)*0.0625;
     }
     /* save obs data in msm message */
     save_msm_obs(rtcm,sys,&h,r,pr,cp,NULL,NULL,cnr,lti,10,NULL,half);
@@ -2754,16 +2763,17 @@ static int decode_msm6(rtcm_t *rtcm, int sys)
 static int decode_msm7(rtcm_t *rtcm, int sys)
 {
     msm_h_t h={0};
+    bitrd_t b;
     double r[64],rr[64],pr[64],cp[64],rrf[64],cnr[64];
-    int i,j,type,sync,iod,ncell,rng,rng_m,rate,prv,cpv,rrv,lti[64];
-    int ex[64],half[64];
+    int j,type,sync,iod,ncell,rng,rng_m,rate,prv,cpv,rrv,lti[64];
+    int ex[64],half[64],inv=strstr(rtcm->opt,"-INVPRR")!=NULL;
     
-    type=getbitu(rtcm->buff,24,12);
+    type=getbitu(rtcm->frame,24,12);
     
     /* decode msm header */
-    if ((ncell=decode_msm_head(rtcm,sys,&sync,&iod,&h,&i))<0) return -1;
+    if ((ncell=decode_msm_head(rtcm,sys,&sync,&iod,&h,&b))<0) return -1;
     
-    if (i+h.nsat*36+ncell*80>rtcm->len*8) {
+    if (bitrdpos(&b)+h.nsat*36+ncell*80>rtcm->len*8) {
         trace(2,"rtcm3 %d length error: nsat=%d ncell=%d len=%d\n",type,h.nsat,
               ncell,rtcm->len);
         rtcm->obsflag=!sync;  /* header ok, so return sync bit */
@@ -2780,46 +2790,46 @@ static int decode_msm7(rtcm_t *rtcm, int sys)
     
     /* decode satellite data */
     for (j=0;j<h.nsat;j++) { /* range */
-        rng  =getbitu(rtcm->buff,i, 8); i+= 8;
+        rng  =rdbitu(&b,8);
         if (rng!=255) r[j]=rng*RANGE_MS;
     }
     for (j=0;j<h.nsat;j++) { /* extended info */
-        ex[j]=getbitu(rtcm->buff,i, 4); i+= 4;
+        ex[j]=rdbitu(&b,4);
     }
     for (j=0;j<h.nsat;j++) {
-        rng_m=getbitu(rtcm->buff,i,10); i+=10;
+        rng_m=rdbitu(&b,10);
         if (r[j]!=0.0) r[j]+=rng_m*P2_10*RANGE_MS;
     }
     for (j=0;j<h.nsat;j++) { /* phaserangerate */
-        rate =getbits(rtcm->buff,i,14); i+=14;
+        rate =rdbits(&b,14);
         if (rate!=-8192) {
             rr[j]=rate*1.0;
-            if (strstr(rtcm->opt,"-INVPRR")) rr[j] = -rr[j];
+            if (inv) rr[j] = -rr[j];
         }
     }
     /* decode signal data */
     for (j=0;j<ncell;j++) { /* pseudorange */
-        prv=getbits(rtcm->buff,i,20); i+=20;
+        prv=rdbits(&b,20);
         if (prv!=-524288) pr[j]=prv*P2_29*RANGE_MS;
     }
     for (j=0;j<ncell;j++) { /* phaserange */
-        cpv=getbits(rtcm->buff,i,24); i+=24;
+        cpv=rdbits(&b,24);
         if (cpv!=-8388608) cp[j]=cpv*P2_31*RANGE_MS;
     }
     for (j=0;j<ncell;j++) { /* lock time indicator */
-        lti[j]=getbitu(rtcm->buff,i,10); i+=10;
+        lti[j]=rdbitu(&b,10);
     }
     for (j=0;j<ncell;j++) { /* half-cycle ambiguity */
-        half[j]=getbitu(rtcm->buff,i,1); i+=1;
+        half[j]=rdbitu(&b,1);
     }
     for (j=0;j<ncell;j++) { /* cnr */
-        cnr[j]=getbitu(rtcm->buff,i,10)*0.0625; i+=10;
+        cnr[j]=rdbitu(&b,10)*0.0625;
     }
     for (j=0;j<ncell;j++) { /* phaserangerate */
-        rrv=getbits(rtcm->buff,i,15); i+=15;
+        rrv=rdbits(&b,15);
         if (rrv!=-16384) {
             rrf[j]=rrv*0.0001;
-            if (strstr(rtcm->opt,"-INVPRR")) rrf[j] = -rrf[j];
+            if (inv) rrf[j] = -rrf[j];
         }
     }
     /* save obs data in msm message */
@@ -2837,9 +2847,9 @@ static int decode_type1230(rtcm_t *rtcm)
         trace(2,"rtcm3 1230: length error len=%d\n",rtcm->len);
         return -1;
     }
-    staid=getbitu(rtcm->buff,i,12); i+=12;
-    align=getbitu(rtcm->buff,i, 1); i+= 1+3;
-    mask =getbitu(rtcm->buff,i, 4); i+= 4;
+    staid=getbitu(rtcm->frame,i,12); i+=12;
+    align=getbitu(rtcm->frame,i, 1); i+= 1+3;
+    mask =getbitu(rtcm->frame,i, 4); i+= 4;
     
     if (rtcm->outtype) {
         sprintf(rtcm->msgtype+strlen(rtcm->msgtype),
@@ -2854,7 +2864,7 @@ static int decode_type1230(rtcm_t *rtcm)
     }
     for (j=0;j<4&&i+16<=rtcm->len*8;j++) {
         if (!(mask&(1<<(3-j)))) continue;
-        bias=getbits(rtcm->buff,i,16); i+=16;
+        bias=getbits(rtcm->frame,i,16); i+=16;
         if (bias!=-32768) {
             rtcm->sta.glo_cp_bias[j]=bias*0.02;
         }
@@ -2866,7 +2876,7 @@ static int decode_type4073(rtcm_t *rtcm)
 {
     int i=24+12,subtype;
     
-    subtype=getbitu(rtcm->buff,i,4); i+=4;
+    subtype=getbitu(rtcm->frame,i,4); i+=4;
     
     if (rtcm->outtype) {
         sprintf(rtcm->msgtype+strlen(rtcm->msgtype)," subtype=%d",subtype);
@@ -2883,8 +2893,8 @@ static int decode_type4076(rtcm_t *rtcm)
         trace(2,"rtcm3 4076: length error len=%d\n",rtcm->len);
         return -1;
     }
-    ver    =getbitu(rtcm->buff,i,3); i+=3;
-    subtype=getbitu(rtcm->buff,i,8); i+=8;
+    ver    =getbitu(rtcm->frame,i,3); i+=3;
+    subtype=getbitu(rtcm->frame,i,8); i+=8;
     
     if (rtcm->outtype) {
         sprintf(rtcm->msgtype+strlen(rtcm->msgtype)," ver=%d subtype=%3d",ver,
@@ -2938,11 +2948,17 @@ static int decode_type4076(rtcm_t *rtcm)
     trace(2,"rtcm3 4076: unsupported message subtype=%d\n",subtype);
     return 0;
 }
-/* decode RTCM ver.3 message -------------------------------------------------*/
+/* decode RTCM ver.3 message ---------------------------------------------------
+* decode the message frame rtcm->frame (rtcm->buff if NULL) of rtcm->len bytes
+* without parity. rtcm->frame is reset to NULL on return.
+*-----------------------------------------------------------------------------*/
 int decode_rtcm3(rtcm_t *rtcm)
 {
     double tow;
-    int ret=0,type=getbitu(rtcm->buff,24,12),week;
+    int ret=0,type,week;
+    
+    if (!rtcm->frame) rtcm->frame=rtcm->buff;
+    type=getbitu(rtcm->frame,24,12);
     
     trace(3,"decode_rtcm3: len=%3d type=%d\n",rtcm->len,type);
     
@@ -3094,5 +3110,6 @@ int decode_rtcm3(rtcm_t *rtcm)
         else if (4070<=type&&type<=4099) rtcm->nmsg3[type-3770]++; /* 300-329 */
         else rtcm->nmsg3[0]++; /* other */
     }
+    rtcm->frame=NULL;
     return ret;
 }
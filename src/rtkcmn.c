@@ -143,7 +143,7 @@
 *                           use integer types in stdint.h
 *                           suppress warnings
 *-----------------------------------------------------------------------------*/
-#define _POSIX_C_SOURCE 200112L
+#define _POSIX_C_SOURCE 200809L
 #include <stdarg.h>
 #include <ctype.h>
 #include <errno.h>
@@ -445,6 +445,232 @@ static const uint32_t tbl_CRC24Q[]={
     0xE37B16,0x6537ED,0x69AE1B,0xEFE2E0,0x709DF7,0xF6D10C,0xFA48FA,0x7C0401,
     0x42FA2F,0xC4B6D4,0xC82F22,0x4E63D9,0xD11CCE,0x575035,0x5BC9C3,0xDD8538
 };
+static const uint32_t tbl_CRC24Q_S8[7][256]={ /* slicing-by-8, k+1 zero bytes followed */
+    {0x000000,0x668F48,0xCD1E90,0xAB91D8,0x1C71DB,0x7AFE93,0xD16F4B,0xB7E003,
+     0x38E3B6,0x5E6CFE,0xF5FD26,0x93726E,0x24926D,0x421D25,0xE98CFD,0x8F03B5,
+     0x71C76C,0x174824,0xBCD9FC,0xDA56B4,0x6DB6B7,0x0B39FF,0xA0A827,0xC6276F,
+     0x4924DA,0x2FAB92,0x843A4A,0xE2B502,0x555501,0x33DA49,0x984B91,0xFEC4D9,
+     0xE38ED8,0x850190,0x2E9048,0x481F00,0xFFFF03,0x99704B,0x32E193,0x546EDB,
+     0xDB6D6E,0xBDE226,0x1673FE,0x70FCB6,0xC71CB5,0xA193FD,0x0A0225,0x6C8D6D,
+     0x9249B4,0xF4C6FC,0x5F5724,0x39D86C,0x8E386F,0xE8B727,0x4326FF,0x25A9B7,
+     0xAAAA02,0xCC254A,0x67B492,0x013BDA,0xB6DBD9,0xD05491,0x7BC549,0x1D4A01,
+     0x41514B,0x27DE03,0x8C4FDB,0xEAC093,0x5D2090,0x3BAFD8,0x903E00,0xF6B148,
+     0x79B2FD,0x1F3DB5,0xB4AC6D,0xD22325,0x65C326,0x034C6E,0xA8DDB6,0xCE52FE,
+     0x309627,0x56196F,0xFD88B7,0x9B07FF,0x2CE7FC,0x4A68B4,0xE1F96C,0x877624,
+     0x087591,0x6EFAD9,0xC56B01,0xA3E449,0x14044A,0x728B02,0xD91ADA,0xBF9592,
+     0xA2DF93,0xC450DB,0x6FC103,0x094E4B,0xBEAE48,0xD82100,0x73B0D8,0x153F90,
+     0x9A3C25,0xFCB36D,0x5722B5,0x31ADFD,0x864DFE,0xE0C2B6,0x4B536E,0x2DDC26,
+     0xD318FF,0xB597B7,0x1E066F,0x788927,0xCF6924,0xA9E66C,0x0277B4,0x64F8FC,
+     0xEBFB49,0x8D7401,0x26E5D9,0x406A91,0xF78A92,0x9105DA,0x3A9402,0x5C1B4A,
+     0x82A296,0xE42DDE,0x4FBC06,0x29334E,0x9ED34D,0xF85C05,0x53CDDD,0x354295,
+     0xBA4120,0xDCCE68,0x775FB0,0x11D0F8,0xA630FB,0xC0BFB3,0x6B2E6B,0x0DA123,
+     0xF365FA,0x95EAB2,0x3E7B6A,0x58F422,0xEF1421,0x899B69,0x220AB1,0x4485F9,
+     0xCB864C,0xAD0904,0x0698DC,0x601794,0xD7F797,0xB178DF,0x1AE907,0x7C664F,
+     0x612C4E,0x07A306,0xAC32DE,0xCABD96,0x7D5D95,0x1BD2DD,0xB04305,0xD6CC4D,
+     0x59CFF8,0x3F40B0,0x94D168,0xF25E20,0x45BE23,0x23316B,0x88A0B3,0xEE2FFB,
+     0x10EB22,0x76646A,0xDDF5B2,0xBB7AFA,0x0C9AF9,0x6A15B1,0xC18469,0xA70B21,
+     0x280894,0x4E87DC,0xE51604,0x83994C,0x34794F,0x52F607,0xF967DF,0x9FE897,
+     0xC3F3DD,0xA57C95,0x0EED4D,0x686205,0xDF8206,0xB90D4E,0x129C96,0x7413DE,
+     0xFB106B,0x9D9F23,0x360EFB,0x5081B3,0xE761B0,0x81EEF8,0x2A7F20,0x4CF068,
+     0xB234B1,0xD4BBF9,0x7F2A21,0x19A569,0xAE456A,0xC8CA22,0x635BFA,0x05D4B2,
+     0x8AD707,0xEC584F,0x47C997,0x2146DF,0x96A6DC,0xF02994,0x5BB84C,0x3D3704,
+     0x207D05,0x46F24D,0xED6395,0x8BECDD,0x3C0CDE,0x5A8396,0xF1124E,0x979D06,
+     0x189EB3,0x7E11FB,0xD58023,0xB30F6B,0x04EF68,0x626020,0xC9F1F8,0xAF7EB0,
+     0x51BA69,0x373521,0x9CA4F9,0xFA2BB1,0x4DCBB2,0x2B44FA,0x80D522,0xE65A6A,
+     0x6959DF,0x0FD697,0xA4474F,0xC2C807,0x752804,0x13A74C,0xB83694,0xDEB9DC},
+    {0x000000,0x8309D7,0x805F55,0x035682,0x86F251,0x05FB86,0x06AD04,0x85A4D3,
+     0x8BA859,0x08A18E,0x0BF70C,0x88FEDB,0x0D5A08,0x8E53DF,0x8D055D,0x0E0C8A,
+     0x911C49,0x12159E,0x11431C,0x924ACB,0x17EE18,0x94E7CF,0x97B14D,0x14B89A,
+     0x1AB410,0x99BDC7,0x9AEB45,0x19E292,0x9C4641,0x1F4F96,0x1C1914,0x9F10C3,
+     0xA47469,0x277DBE,0x242B3C,0xA722EB,0x228638,0xA18FEF,0xA2D96D,0x21D0BA,
+     0x2FDC30,0xACD5E7,0xAF8365,0x2C8AB2,0xA92E61,0x2A27B6,0x297134,0xAA78E3,
+     0x356820,0xB661F7,0xB53775,0x363EA2,0xB39A71,0x3093A6,0x33C524,0xB0CCF3,
+     0xBEC079,0x3DC9AE,0x3E9F2C,0xBD96FB,0x383228,0xBB3BFF,0xB86D7D,0x3B64AA,
+     0xCEA429,0x4DADFE,0x4EFB7C,0xCDF2AB,0x485678,0xCB5FAF,0xC8092D,0x4B00FA,
+     0x450C70,0xC605A7,0xC55325,0x465AF2,0xC3FE21,0x40F7F6,0x43A174,0xC0A8A3,
+     0x5FB860,0xDCB1B7,0xDFE735,0x5CEEE2,0xD94A31,0x5A43E6,0x591564,0xDA1CB3,
+     0xD41039,0x5719EE,0x544F6C,0xD746BB,0x52E268,0xD1EBBF,0xD2BD3D,0x51B4EA,
+     0x6AD040,0xE9D997,0xEA8F15,0x6986C2,0xEC2211,0x6F2BC6,0x6C7D44,0xEF7493,
+     0xE17819,0x6271CE,0x61274C,0xE22E9B,0x678A48,0xE4839F,0xE7D51D,0x64DCCA,
+     0xFBCC09,0x78C5DE,0x7B935C,0xF89A8B,0x7D3E58,0xFE378F,0xFD610D,0x7E68DA,
+     0x706450,0xF36D87,0xF03B05,0x7332D2,0xF69601,0x759FD6,0x76C954,0xF5C083,
+     0x1B04A9,0x980D7E,0x9B5BFC,0x18522B,0x9DF6F8,0x1EFF2F,0x1DA9AD,0x9EA07A,
+     0x90ACF0,0x13A527,0x10F3A5,0x93FA72,0x165EA1,0x955776,0x9601F4,0x150823,
+     0x8A18E0,0x091137,0x0A47B5,0x894E62,0x0CEAB1,0x8FE366,0x8CB5E4,0x0FBC33,
+     0x01B0B9,0x82B96E,0x81EFEC,0x02E63B,0x8742E8,0x044B3F,0x071DBD,0x84146A,
+     0xBF70C0,0x3C7917,0x3F2F95,0xBC2642,0x398291,0xBA8B46,0xB9DDC4,0x3AD413,
+     0x34D899,0xB7D14E,0xB487CC,0x378E1B,0xB22AC8,0x31231F,0x32759D,0xB17C4A,
+     0x2E6C89,0xAD655E,0xAE33DC,0x2D3A0B,0xA89ED8,0x2B970F,0x28C18D,0xABC85A,
+     0xA5C4D0,0x26CD07,0x259B85,0xA69252,0x233681,0xA03F56,0xA369D4,0x206003,
+     0xD5A080,0x56A957,0x55FFD5,0xD6F602,0x5352D1,0xD05B06,0xD30D84,0x500453,
+     0x5E08D9,0xDD010E,0xDE578C,0x5D5E5B,0xD8FA88,0x5BF35F,0x58A5DD,0xDBAC0A,
+     0x44BCC9,0xC7B51E,0xC4E39C,0x47EA4B,0xC24E98,0x41474F,0x4211CD,0xC1181A,
+     0xCF1490,0x4C1D47,0x4F4BC5,0xCC4212,0x49E6C1,0xCAEF16,0xC9B994,0x4AB043,
+     0x71D4E9,0xF2DD3E,0xF18BBC,0x72826B,0xF726B8,0x742F6F,0x7779ED,0xF4703A,
+     0xFA7CB0,0x797567,0x7A23E5,0xF92A32,0x7C8EE1,0xFF8736,0xFCD1B4,0x7FD863,
+     0xE0C8A0,0x63C177,0x6097F5,0xE39E22,0x663AF1,0xE53326,0xE665A4,0x656C73,
+     0x6B60F9,0xE8692E,0xEB3FAC,0x68367B,0xED92A8,0x6E9B7F,0x6DCDFD,0xEEC42A},
+    {0x000000,0x360952,0x6C12A4,0x5A1BF6,0xD82548,0xEE2C1A,0xB437EC,0x823EBE,
+     0x36066B,0x000F39,0x5A14CF,0x6C1D9D,0xEE2323,0xD82A71,0x823187,0xB438D5,
+     0x6C0CD6,0x5A0584,0x001E72,0x361720,0xB4299E,0x8220CC,0xD83B3A,0xEE3268,
+     0x5A0ABD,0x6C03EF,0x361819,0x00114B,0x822FF5,0xB426A7,0xEE3D51,0xD83403,
+     0xD819AC,0xEE10FE,0xB40B08,0x82025A,0x003CE4,0x3635B6,0x6C2E40,0x5A2712,
+     0xEE1FC7,0xD81695,0x820D63,0xB40431,0x363A8F,0x0033DD,0x5A282B,0x6C2179,
+     0xB4157A,0x821C28,0xD807DE,0xEE0E8C,0x6C3032,0x5A3960,0x002296,0x362BC4,
+     0x821311,0xB41A43,0xEE01B5,0xD808E7,0x5A3659,0x6C3F0B,0x3624FD,0x002DAF,
+     0x367FA3,0x0076F1,0x5A6D07,0x6C6455,0xEE5AEB,0xD853B9,0x82484F,0xB4411D,
+     0x0079C8,0x36709A,0x6C6B6C,0x5A623E,0xD85C80,0xEE55D2,0xB44E24,0x824776,
+     0x5A7375,0x6C7A27,0x3661D1,0x006883,0x82563D,0xB45F6F,0xEE4499,0xD84DCB,
+     0x6C751E,0x5A7C4C,0x0067BA,0x366EE8,0xB45056,0x825904,0xD842F2,0xEE4BA0,
+     0xEE660F,0xD86F5D,0x8274AB,0xB47DF9,0x364347,0x004A15,0x5A51E3,0x6C58B1,
+     0xD86064,0xEE6936,0xB472C0,0x827B92,0x00452C,0x364C7E,0x6C5788,0x5A5EDA,
+     0x826AD9,0xB4638B,0xEE787D,0xD8712F,0x5A4F91,0x6C46C3,0x365D35,0x005467,
+     0xB46CB2,0x8265E0,0xD87E16,0xEE7744,0x6C49FA,0x5A40A8,0x005B5E,0x36520C,
+     0x6CFF46,0x5AF614,0x00EDE2,0x36E4B0,0xB4DA0E,0x82D35C,0xD8C8AA,0xEEC1F8,
+     0x5AF92D,0x6CF07F,0x36EB89,0x00E2DB,0x82DC65,0xB4D537,0xEECEC1,0xD8C793,
+     0x00F390,0x36FAC2,0x6CE134,0x5AE866,0xD8D6D8,0xEEDF8A,0xB4C47C,0x82CD2E,
+     0x36F5FB,0x00FCA9,0x5AE75F,0x6CEE0D,0xEED0B3,0xD8D9E1,0x82C217,0xB4CB45,
+     0xB4E6EA,0x82EFB8,0xD8F44E,0xEEFD1C,0x6CC3A2,0x5ACAF0,0x00D106,0x36D854,
+     0x82E081,0xB4E9D3,0xEEF225,0xD8FB77,0x5AC5C9,0x6CCC9B,0x36D76D,0x00DE3F,
+     0xD8EA3C,0xEEE36E,0xB4F898,0x82F1CA,0x00CF74,0x36C626,0x6CDDD0,0x5AD482,
+     0xEEEC57,0xD8E505,0x82FEF3,0xB4F7A1,0x36C91F,0x00C04D,0x5ADBBB,0x6CD2E9,
+     0x5A80E5,0x6C89B7,0x369241,0x009B13,0x82A5AD,0xB4ACFF,0xEEB709,0xD8BE5B,
+     0x6C868E,0x5A8FDC,0x00942A,0x369D78,0xB4A3C6,0x82AA94,0xD8B162,0xEEB830,
+     0x368C33,0x008561,0x5A9E97,0x6C97C5,0xEEA97B,0xD8A029,0x82BBDF,0xB4B28D,
+     0x008A58,0x36830A,0x6C98FC,0x5A91AE,0xD8AF10,0xEEA642,0xB4BDB4,0x82B4E6,
+     0x829949,0xB4901B,0xEE8BED,0xD882BF,0x5ABC01,0x6CB553,0x36AEA5,0x00A7F7,
+     0xB49F22,0x829670,0xD88D86,0xEE84D4,0x6CBA6A,0x5AB338,0x00A8CE,0x36A19C,
+     0xEE959F,0xD89CCD,0x82873B,0xB48E69,0x36B0D7,0x00B985,0x5AA273,0x6CAB21,
+     0xD893F4,0xEE9AA6,0xB48150,0x828802,0x00B6BC,0x36BFEE,0x6CA418,0x5AAD4A},
+    {0x000000,0xD9FE8C,0x35B1E3,0xEC4F6F,0x6B63C6,0xB29D4A,0x5ED225,0x872CA9,
+     0xD6C78C,0x0F3900,0xE3766F,0x3A88E3,0xBDA44A,0x645AC6,0x8815A9,0x51EB25,
+     0x2BC3E3,0xF23D6F,0x1E7200,0xC78C8C,0x40A025,0x995EA9,0x7511C6,0xACEF4A,
+     0xFD046F,0x24FAE3,0xC8B58C,0x114B00,0x9667A9,0x4F9925,0xA3D64A,0x7A28C6,
+     0x5787C6,0x8E794A,0x623625,0xBBC8A9,0x3CE400,0xE51A8C,0x0955E3,0xD0AB6F,
+     0x81404A,0x58BEC6,0xB4F1A9,0x6D0F25,0xEA238C,0x33DD00,0xDF926F,0x066CE3,
+     0x7C4425,0xA5BAA9,0x49F5C6,0x900B4A,0x1727E3,0xCED96F,0x229600,0xFB688C,
+     0xAA83A9,0x737D25,0x9F324A,0x46CCC6,0xC1E06F,0x181EE3,0xF4518C,0x2DAF00,
+     0xAF0F8C,0x76F100,0x9ABE6F,0x4340E3,0xC46C4A,0x1D92C6,0xF1DDA9,0x282325,
+     0x79C800,0xA0368C,0x4C79E3,0x95876F,0x12ABC6,0xCB554A,0x271A25,0xFEE4A9,
+     0x84CC6F,0x5D32E3,0xB17D8C,0x688300,0xEFAFA9,0x365125,0xDA1E4A,0x03E0C6,
+     0x520BE3,0x8BF56F,0x67BA00,0xBE448C,0x396825,0xE096A9,0x0CD9C6,0xD5274A,
+     0xF8884A,0x2176C6,0xCD39A9,0x14C725,0x93EB8C,0x4A1500,0xA65A6F,0x7FA4E3,
+     0x2E4FC6,0xF7B14A,0x1BFE25,0xC200A9,0x452C00,0x9CD28C,0x709DE3,0xA9636F,
+     0xD34BA9,0x0AB525,0xE6FA4A,0x3F04C6,0xB8286F,0x61D6E3,0x8D998C,0x546700,
+     0x058C25,0xDC72A9,0x303DC6,0xE9C34A,0x6EEFE3,0xB7116F,0x5B5E00,0x82A08C,
+     0xD853E3,0x01AD6F,0xEDE200,0x341C8C,0xB33025,0x6ACEA9,0x8681C6,0x5F7F4A,
+     0x0E946F,0xD76AE3,0x3B258C,0xE2DB00,0x65F7A9,0xBC0925,0x50464A,0x89B8C6,
+     0xF39000,0x2A6E8C,0xC621E3,0x1FDF6F,0x98F3C6,0x410D4A,0xAD4225,0x74BCA9,
+     0x25578C,0xFCA900,0x10E66F,0xC918E3,0x4E344A,0x97CAC6,0x7B85A9,0xA27B25,
+     0x8FD425,0x562AA9,0xBA65C6,0x639B4A,0xE4B7E3,0x3D496F,0xD10600,0x08F88C,
+     0x5913A9,0x80ED25,0x6CA24A,0xB55CC6,0x32706F,0xEB8EE3,0x07C18C,0xDE3F00,
+     0xA417C6,0x7DE94A,0x91A625,0x4858A9,0xCF7400,0x168A8C,0xFAC5E3,0x233B6F,
+     0x72D04A,0xAB2EC6,0x4761A9,0x9E9F25,0x19B38C,0xC04D00,0x2C026F,0xF5FCE3,
+     0x775C6F,0xAEA2E3,0x42ED8C,0x9B1300,0x1C3FA9,0xC5C125,0x298E4A,0xF070C6,
+     0xA19BE3,0x78656F,0x942A00,0x4DD48C,0xCAF825,0x1306A9,0xFF49C6,0x26B74A,
+     0x5C9F8C,0x856100,0x692E6F,0xB0D0E3,0x37FC4A,0xEE02C6,0x024DA9,0xDBB325,
+     0x8A5800,0x53A68C,0xBFE9E3,0x66176F,0xE13BC6,0x38C54A,0xD48A25,0x0D74A9,
+     0x20DBA9,0xF92525,0x156A4A,0xCC94C6,0x4BB86F,0x9246E3,0x7E098C,0xA7F700,
+     0xF61C25,0x2FE2A9,0xC3ADC6,0x1A534A,0x9D7FE3,0x44816F,0xA8CE00,0x71308C,
+     0x0B184A,0xD2E6C6,0x3EA9A9,0xE75725,0x607B8C,0xB98500,0x55CA6F,0x8C34E3,
+     0xDDDFC6,0x04214A,0xE86E25,0x3190A9,0xB6BC00,0x6F428C,0x830DE3,0x5AF36F},
+    {0x000000,0x36EB3D,0x6DD67A,0x5B3D47,0xDBACF4,0xED47C9,0xB67A8E,0x8091B3,
+     0x311513,0x07FE2E,0x5CC369,0x6A2854,0xEAB9E7,0xDC52DA,0x876F9D,0xB184A0,
+     0x622A26,0x54C11B,0x0FFC5C,0x391761,0xB986D2,0x8F6DEF,0xD450A8,0xE2BB95,
+     0x533F35,0x65D408,0x3EE94F,0x080272,0x8893C1,0xBE78FC,0xE545BB,0xD3AE86,
+     0xC4544C,0xF2BF71,0xA98236,0x9F690B,0x1FF8B8,0x291385,0x722EC2,0x44C5FF,
+     0xF5415F,0xC3AA62,0x989725,0xAE7C18,0x2EEDAB,0x180696,0x433BD1,0x75D0EC,
+     0xA67E6A,0x909557,0xCBA810,0xFD432D,0x7DD29E,0x4B39A3,0x1004E4,0x26EFD9,
+     0x976B79,0xA18044,0xFABD03,0xCC563E,0x4CC78D,0x7A2CB0,0x2111F7,0x17FACA,
+     0x0EE463,0x380F5E,0x633219,0x55D924,0xD54897,0xE3A3AA,0xB89EED,0x8E75D0,
+     0x3FF170,0x091A4D,0x52270A,0x64CC37,0xE45D84,0xD2B6B9,0x898BFE,0xBF60C3,
+     0x6CCE45,0x5A2578,0x01183F,0x37F302,0xB762B1,0x81898C,0xDAB4CB,0xEC5FF6,
+     0x5DDB56,0x6B306B,0x300D2C,0x06E611,0x8677A2,0xB09C9F,0xEBA1D8,0xDD4AE5,
+     0xCAB02F,0xFC5B12,0xA76655,0x918D68,0x111CDB,0x27F7E6,0x7CCAA1,0x4A219C,
+     0xFBA53C,0xCD4E01,0x967346,0xA0987B,0x2009C8,0x16E2F5,0x4DDFB2,0x7B348F,
+     0xA89A09,0x9E7134,0xC54C73,0xF3A74E,0x7336FD,0x45DDC0,0x1EE087,0x280BBA,
+     0x998F1A,0xAF6427,0xF45960,0xC2B25D,0x4223EE,0x74C8D3,0x2FF594,0x191EA9,
+     0x1DC8C6,0x2B23FB,0x701EBC,0x46F581,0xC66432,0xF08F0F,0xABB248,0x9D5975,
+     0x2CDDD5,0x1A36E8,0x410BAF,0x77E092,0xF77121,0xC19A1C,0x9AA75B,0xAC4C66,
+     0x7FE2E0,0x4909DD,0x12349A,0x24DFA7,0xA44E14,0x92A529,0xC9986E,0xFF7353,
+     0x4EF7F3,0x781CCE,0x232189,0x15CAB4,0x955B07,0xA3B03A,0xF88D7D,0xCE6640,
+     0xD99C8A,0xEF77B7,0xB44AF0,0x82A1CD,0x02307E,0x34DB43,0x6FE604,0x590D39,
+     0xE88999,0xDE62A4,0x855FE3,0xB3B4DE,0x33256D,0x05CE50,0x5EF317,0x68182A,
+     0xBBB6AC,0x8D5D91,0xD660D6,0xE08BEB,0x601A58,0x56F165,0x0DCC22,0x3B271F,
+     0x8AA3BF,0xBC4882,0xE775C5,0xD19EF8,0x510F4B,0x67E476,0x3CD931,0x0A320C,
+     0x132CA5,0x25C798,0x7EFADF,0x4811E2,0xC88051,0xFE6B6C,0xA5562B,0x93BD16,
+     0x2239B6,0x14D28B,0x4FEFCC,0x7904F1,0xF99542,0xCF7E7F,0x944338,0xA2A805,
+     0x710683,0x47EDBE,0x1CD0F9,0x2A3BC4,0xAAAA77,0x9C414A,0xC77C0D,0xF19730,
+     0x401390,0x76F8AD,0x2DC5EA,0x1B2ED7,0x9BBF64,0xAD5459,0xF6691E,0xC08223,
+     0xD778E9,0xE193D4,0xBAAE93,0x8C45AE,0x0CD41D,0x3A3F20,0x610267,0x57E95A,
+     0xE66DFA,0xD086C7,0x8BBB80,0xBD50BD,0x3DC10E,0x0B2A33,0x501774,0x66FC49,
+     0xB552CF,0x83B9F2,0xD884B5,0xEE6F88,0x6EFE3B,0x581506,0x032841,0x35C37C,
+     0x8447DC,0xB2ACE1,0xE991A6,0xDF7A9B,0x5FEB28,0x690015,0x323D52,0x04D66F},
+    {0x000000,0x3B918C,0x772318,0x4CB294,0xEE4630,0xD5D7BC,0x996528,0xA2F4A4,
+     0x5AC09B,0x615117,0x2DE383,0x16720F,0xB486AB,0x8F1727,0xC3A5B3,0xF8343F,
+     0xB58136,0x8E10BA,0xC2A22E,0xF933A2,0x5BC706,0x60568A,0x2CE41E,0x177592,
+     0xEF41AD,0xD4D021,0x9862B5,0xA3F339,0x01079D,0x3A9611,0x762485,0x4DB509,
+     0xED4E97,0xD6DF1B,0x9A6D8F,0xA1FC03,0x0308A7,0x38992B,0x742BBF,0x4FBA33,
+     0xB78E0C,0x8C1F80,0xC0AD14,0xFB3C98,0x59C83C,0x6259B0,0x2EEB24,0x157AA8,
+     0x58CFA1,0x635E2D,0x2FECB9,0x147D35,0xB68991,0x8D181D,0xC1AA89,0xFA3B05,
+     0x020F3A,0x399EB6,0x752C22,0x4EBDAE,0xEC490A,0xD7D886,0x9B6A12,0xA0FB9E,
+     0x5CD1D5,0x674059,0x2BF2CD,0x106341,0xB297E5,0x890669,0xC5B4FD,0xFE2571,
+     0x06114E,0x3D80C2,0x713256,0x4AA3DA,0xE8577E,0xD3C6F2,0x9F7466,0xA4E5EA,
+     0xE950E3,0xD2C16F,0x9E73FB,0xA5E277,0x0716D3,0x3C875F,0x7035CB,0x4BA447,
+     0xB39078,0x8801F4,0xC4B360,0xFF22EC,0x5DD648,0x6647C4,0x2AF550,0x1164DC,
+     0xB19F42,0x8A0ECE,0xC6BC5A,0xFD2DD6,0x5FD972,0x6448FE,0x28FA6A,0x136BE6,
+     0xEB5FD9,0xD0CE55,0x9C7CC1,0xA7ED4D,0x0519E9,0x3E8865,0x723AF1,0x49AB7D,
+     0x041E74,0x3F8FF8,0x733D6C,0x48ACE0,0xEA5844,0xD1C9C8,0x9D7B5C,0xA6EAD0,
+     0x5EDEEF,0x654F63,0x29FDF7,0x126C7B,0xB098DF,0x8B0953,0xC7BBC7,0xFC2A4B,
+     0xB9A3AA,0x823226,0xCE80B2,0xF5113E,0x57E59A,0x6C7416,0x20C682,0x1B570E,
+     0xE36331,0xD8F2BD,0x944029,0xAFD1A5,0x0D2501,0x36B48D,0x7A0619,0x419795,
+     0x0C229C,0x37B310,0x7B0184,0x409008,0xE264AC,0xD9F520,0x9547B4,0xAED638,
+     0x56E207,0x6D738B,0x21C11F,0x1A5093,0xB8A437,0x8335BB,0xCF872F,0xF416A3,
+     0x54ED3D,0x6F7CB1,0x23CE25,0x185FA9,0xBAAB0D,0x813A81,0xCD8815,0xF61999,
+     0x0E2DA6,0x35BC2A,0x790EBE,0x429F32,0xE06B96,0xDBFA1A,0x97488E,0xACD902,
+     0xE16C0B,0xDAFD87,0x964F13,0xADDE9F,0x0F2A3B,0x34BBB7,0x780923,0x4398AF,
+     0xBBAC90,0x803D1C,0xCC8F88,0xF71E04,0x55EAA0,0x6E7B2C,0x22C9B8,0x195834,
+     0xE5727F,0xDEE3F3,0x925167,0xA9C0EB,0x0B344F,0x30A5C3,0x7C1757,0x4786DB,
+     0xBFB2E4,0x842368,0xC891FC,0xF30070,0x51F4D4,0x6A6558,0x26D7CC,0x1D4640,
+     0x50F349,0x6B62C5,0x27D051,0x1C41DD,0xBEB579,0x8524F5,0xC99661,0xF207ED,
+     0x0A33D2,0x31A25E,0x7D10CA,0x468146,0xE475E2,0xDFE46E,0x9356FA,0xA8C776,
+     0x083CE8,0x33AD64,0x7F1FF0,0x448E7C,0xE67AD8,0xDDEB54,0x9159C0,0xAAC84C,
+     0x52FC73,0x696DFF,0x25DF6B,0x1E4EE7,0xBCBA43,0x872BCF,0xCB995B,0xF008D7,
+     0xBDBDDE,0x862C52,0xCA9EC6,0xF10F4A,0x53FBEE,0x686A62,0x24D8F6,0x1F497A,
+     0xE77D45,0xDCECC9,0x905E5D,0xABCFD1,0x093B75,0x32AAF9,0x7E186D,0x4589E1},
+    {0x000000,0xF50BAF,0x6C5BA5,0x99500A,0xD8B74A,0x2DBCE5,0xB4ECEF,0x41E740,
+     0x37226F,0xC229C0,0x5B79CA,0xAE7265,0xEF9525,0x1A9E8A,0x83CE80,0x76C52F,
+     0x6E44DE,0x9B4F71,0x021F7B,0xF714D4,0xB6F394,0x43F83B,0xDAA831,0x2FA39E,
+     0x5966B1,0xAC6D1E,0x353D14,0xC036BB,0x81D1FB,0x74DA54,0xED8A5E,0x1881F1,
+     0xDC89BC,0x298213,0xB0D219,0x45D9B6,0x043EF6,0xF13559,0x686553,0x9D6EFC,
+     0xEBABD3,0x1EA07C,0x87F076,0x72FBD9,0x331C99,0xC61736,0x5F473C,0xAA4C93,
+     0xB2CD62,0x47C6CD,0xDE96C7,0x2B9D68,0x6A7A28,0x9F7187,0x06218D,0xF32A22,
+     0x85EF0D,0x70E4A2,0xE9B4A8,0x1CBF07,0x5D5847,0xA853E8,0x3103E2,0xC4084D,
+     0x3F5F83,0xCA542C,0x530426,0xA60F89,0xE7E8C9,0x12E366,0x8BB36C,0x7EB8C3,
+     0x087DEC,0xFD7643,0x642649,0x912DE6,0xD0CAA6,0x25C109,0xBC9103,0x499AAC,
+     0x511B5D,0xA410F2,0x3D40F8,0xC84B57,0x89AC17,0x7CA7B8,0xE5F7B2,0x10FC1D,
+     0x663932,0x93329D,0x0A6297,0xFF6938,0xBE8E78,0x4B85D7,0xD2D5DD,0x27DE72,
+     0xE3D63F,0x16DD90,0x8F8D9A,0x7A8635,0x3B6175,0xCE6ADA,0x573AD0,0xA2317F,
+     0xD4F450,0x21FFFF,0xB8AFF5,0x4DA45A,0x0C431A,0xF948B5,0x6018BF,0x951310,
+     0x8D92E1,0x78994E,0xE1C944,0x14C2EB,0x5525AB,0xA02E04,0x397E0E,0xCC75A1,
+     0xBAB08E,0x4FBB21,0xD6EB2B,0x23E084,0x6207C4,0x970C6B,0x0E5C61,0xFB57CE,
+     0x7EBF06,0x8BB4A9,0x12E4A3,0xE7EF0C,0xA6084C,0x5303E3,0xCA53E9,0x3F5846,
+     0x499D69,0xBC96C6,0x25C6CC,0xD0CD63,0x912A23,0x64218C,0xFD7186,0x087A29,
+     0x10FBD8,0xE5F077,0x7CA07D,0x89ABD2,0xC84C92,0x3D473D,0xA41737,0x511C98,
+     0x27D9B7,0xD2D218,0x4B8212,0xBE89BD,0xFF6EFD,0x0A6552,0x933558,0x663EF7,
+     0xA236BA,0x573D15,0xCE6D1F,0x3B66B0,0x7A81F0,0x8F8A5F,0x16DA55,0xE3D1FA,
+     0x9514D5,0x601F7A,0xF94F70,0x0C44DF,0x4DA39F,0xB8A830,0x21F83A,0xD4F395,
+     0xCC7264,0x3979CB,0xA029C1,0x55226E,0x14C52E,0xE1CE81,0x789E8B,0x8D9524,
+     0xFB500B,0x0E5BA4,0x970BAE,0x620001,0x23E741,0xD6ECEE,0x4FBCE4,0xBAB74B,
+     0x41E085,0xB4EB2A,0x2DBB20,0xD8B08F,0x9957CF,0x6C5C60,0xF50C6A,0x0007C5,
+     0x76C2EA,0x83C945,0x1A994F,0xEF92E0,0xAE75A0,0x5B7E0F,0xC22E05,0x3725AA,
+     0x2FA45B,0xDAAFF4,0x43FFFE,0xB6F451,0xF71311,0x0218BE,0x9B48B4,0x6E431B,
+     0x188634,0xED8D9B,0x74DD91,0x81D63E,0xC0317E,0x353AD1,0xAC6ADB,0x596174,
+     0x9D6939,0x686296,0xF1329C,0x043933,0x45DE73,0xB0D5DC,0x2985D6,0xDC8E79,
+     0xAA4B56,0x5F40F9,0xC610F3,0x331B5C,0x72FC1C,0x87F7B3,0x1EA7B9,0xEBAC16,
+     0xF32DE7,0x062648,0x9F7642,0x6A7DED,0x2B9AAD,0xDE9102,0x47C108,0xB2CAA7,
+     0xC40F88,0x310427,0xA8542D,0x5D5F82,0x1CB8C2,0xE9B36D,0x70E367,0x85E8C8}
+};
 /* function prototypes -------------------------------------------------------*/
 #ifdef MKL
 #define LAPACK
@@ -931,14 +1157,14 @@ const char *getcodebandname(int sys, int band)
 //
 // For example, verbose: '-G 1C,2L,2S,5Q -E 1C,5QX,6B -C2 6I -C3 1P,5P,6I -S 1C -I 1C,5Q'
 //
-void init_code2idx(const char *sigdef)
+static void sigdef2idx(const char *sigdef, char pris[8][9][16], int bandidx[8][9],
+                       int idxband[8][MAXFREQ])
 {
-  trace(2, "init_code2idx: sigdef='%s'\n", sigdef);
-  // Reinitialize the defaults, so that the effect of the signal definition is
+  // Start from the defaults, so that the effect of the signal definition is
   // repeatable and modifies the defaults rather than being incremental.
-  memcpy(codepris, default_codepris, sizeof(codepris));
-  memcpy(codebandidx, default_codebandidx, sizeof(codebandidx));
-  memcpy(idxcodeband, default_idxcodeband, sizeof(idxcodeband));
+  memcpy(pris, default_codepris, sizeof(default_codepris));
+  memcpy(bandidx, default_codebandidx, sizeof(default_codebandidx));
+  memcpy(idxband, default_idxcodeband, sizeof(default_idxcodeband));
   const char *p = sigdef;
   int sysn = -1;
   while (p[0]) {
@@ -989,8 +1215,8 @@ void init_code2idx(const char *sigdef)
         continue;
     }
     // Clear the assignments for this system.
-    for (int i = 0; i < 9; i++) codebandidx[sysn][i] = -1;
-    for (int idx = 0; idx < MAXFREQ; idx++) idxcodeband[sysn][idx] = 0;;
+    for (int i = 0; i < 9; i++) bandidx[sysn][i] = -1;
+    for (int idx = 0; idx < MAXFREQ; idx++) idxband[sysn][idx] = 0;;
     int idx = -1, band = -1, npri = 0;
     for (; p[0]; p++) {
       if (p[0] == '-') break;
@@ -1003,8 +1229,8 @@ void init_code2idx(const char *sigdef)
         idx++;
         if (b > 0) {
           if (idx < 6) {
-            codebandidx[sysn][b - 1] = idx;
-            idxcodeband[sysn][idx] = b;
+            bandidx[sysn][b - 1] = idx;
+            idxband[sysn][idx] = b;
           }
           else
             trace(0, "Frequency index overflow at '%s'\n", p);
@@ -1020,13 +1246,13 @@ void init_code2idx(const char *sigdef)
           continue;
         }
         // The first code priority clears the priorities list.
-        if (npri == 0) memset(codepris[sysn][band - 1], 0, sizeof(codepris[0][0]));
+        if (npri == 0) memset(pris[sysn][band - 1], 0, sizeof(pris[0][0]));
         // Add this code to the priorities list.
-        if (npri >= (int)sizeof(codepris[0][0]) - 1) {
+        if (npri >= (int)sizeof(pris[0][0]) - 1) {
           trace(0, "Code priorities overflow at '%s'\n", p);
           continue;
         }
-        codepris[sysn][band - 1][npri] = p[0];
+        pris[sysn][band - 1][npri] = p[0];
         npri++;
         continue;
       }
@@ -1034,6 +1260,26 @@ void init_code2idx(const char *sigdef)
     }
   }
 }
+void init_code2idx(const char *sigdef)
+{
+  char pris[8][9][16];
+  int bandidx[8][9], idxband[8][MAXFREQ];
+
+  trace(2, "init_code2idx: sigdef='%s'\n", sigdef);
+  sigdef2idx(sigdef, pris, bandidx, idxband);
+
+  // Update the tables only if changed, so that concurrent sessions with the
+  // same signal definition do not modify the tables in use by each other.
+  if (memcmp(codepris, pris, sizeof(pris))) {
+    memcpy(codepris, pris, sizeof(pris));
+  }
+  if (memcmp(codebandidx, bandidx, sizeof(bandidx))) {
+    memcpy(codebandidx, bandidx, sizeof(bandidx));
+  }
+  if (memcmp(idxcodeband, idxband, sizeof(idxband))) {
+    memcpy(idxcodeband, idxband, sizeof(idxband));
+  }
+}
 
 // sigindex --------------------------------------------
 //
@@ -1419,14 +1665,23 @@ int getcodepri(int sys, uint8_t code, const char *opt)
 *          unsigned   pos     I   bit position from start of data (bits)
 *          unsigned   len     I   bit length (bits) (len<=32)
 * return : extracted unsigned/signed bits
+* notes  : the bytes containing the bits are loaded to a 64-bit word at once
 *-----------------------------------------------------------------------------*/
 uint32_t getbitu(const uint8_t *buff, unsigned pos, unsigned len)
 {
-  if (len > 32) trace(2, "getbitu: len=%u out of range\n", len);
-  uint32_t bits = 0;
-  for (unsigned i = pos; i < pos + len; i++)
-      bits = (bits << 1) | ((buff[i / 8] >> (7 - i % 8)) & 1u);
-  return bits;
+  if (len > 32) {
+      trace(2, "getbitu: len=%u out of range\n", len);
+      uint32_t bits = 0;
+      for (unsigned i = pos; i < pos + len; i++)
+          bits = (bits << 1) | ((buff[i / 8] >> (7 - i % 8)) & 1u);
+      return bits;
+  }
+  if (len == 0) return 0;
+  const uint8_t *p = buff + pos / 8;
+  unsigned n = (pos % 8 + len + 7) / 8; /* number of bytes (<=5) */
+  uint64_t word = 0;
+  for (unsigned i = 0; i < n; i++) word = (word << 8) | p[i];
+  return (uint32_t)(word >> (n * 8 - pos % 8 - len)) & (0xFFFFFFFFu >> (32 - len));
 }
 int32_t getbits(const uint8_t *buff, unsigned pos, unsigned len)
 {
@@ -1444,6 +1699,83 @@ int32_t getbits(const uint8_t *buff, unsigned pos, unsigned len)
   if (!(bits & (1u << (len - 1)))) return (int32_t)bits;
   return (int32_t)(bits | (~0u << len)); /* Extend sign */
 }
+/* initialize bit stream reader -----------------------------------------------
+* initialize bit stream reader to read bits in sequence from byte data
+* args   : bitrd_t  *b       O   bit stream reader
+*          uint8_t  *buff    I   byte data
+*          unsigned nbyte    I   data length (bytes)
+*          unsigned pos      I   bit position to start from start of data (bits)
+* return : none
+* notes  : the data are loaded to a 64-bit word buffer by 8 bytes. bits beyond
+*          the data length are read as 0.
+*-----------------------------------------------------------------------------*/
+void initbitrd(bitrd_t *b, const uint8_t *buff, unsigned nbyte, unsigned pos)
+{
+    b->buff=buff;
+    b->nbyte=nbyte;
+    b->pos=pos/8;
+    b->word=0;
+    b->nbit=0;
+    if (pos%8) rdbitu(b,pos%8);
+}
+/* fill word buffer of bit stream reader -------------------------------------*/
+static void fillbitrd(bitrd_t *b)
+{
+    const uint8_t *p=b->buff+b->pos;
+    uint64_t word=0;
+    unsigned n=(64-b->nbit)/8;
+    
+    if (b->pos+8<=b->nbyte) {
+        word=((uint64_t)p[0]<<56)|((uint64_t)p[1]<<48)|((uint64_t)p[2]<<40)|
+             ((uint64_t)p[3]<<32)|((uint64_t)p[4]<<24)|((uint64_t)p[5]<<16)|
+             ((uint64_t)p[6]<< 8)| (uint64_t)p[7];
+    }
+    else {
+        for (unsigned i=0;i<8;i++) {
+            word=(word<<8)|(b->pos+i<b->nbyte?p[i]:0);
+        }
+    }
+    /* bits below nbit+n*8 are the same as the next fill */
+    b->word|=word>>b->nbit;
+    b->pos+=n;
+    b->nbit+=n*8;
+}
+/* read unsigned/signed bits by bit stream reader ------------------------------
+* read unsigned/signed bits at the current position and advance the position
+* args   : bitrd_t  *b       IO  bit stream reader
+*          unsigned len      I   bit length (bits) (len<=32)
+* return : read unsigned/signed bits
+*-----------------------------------------------------------------------------*/
+uint32_t rdbitu(bitrd_t *b, unsigned len)
+{
+    uint32_t bits;
+    
+    if (len==0) return 0;
+    if (len>32) {
+        trace(2,"rdbitu: len=%u out of range\n",len);
+        return 0;
+    }
+    if (b->nbit<len) fillbitrd(b);
+    bits=(uint32_t)(b->word>>(64-len));
+    b->word<<=len;
+    b->nbit-=len;
+    return bits;
+}
+int32_t rdbits(bitrd_t *b, unsigned len)
+{
+    uint32_t bits=rdbitu(b,len);
+    
+    if (len==0||len>=32||!(bits&(1u<<(len-1)))) return (int32_t)bits;
+    return (int32_t)(bits|(~0u<<len)); /* extend sign */
+}
+/* bit position of bit stream reader -------------------------------------------
+* args   : bitrd_t  *b       I   bit stream reader
+* return : current bit position from start of data (bits)
+*-----------------------------------------------------------------------------*/
+int bitrdpos(const bitrd_t *b)
+{
+    return (int)(b->pos*8-b->nbit);
+}
 /* Set unsigned/signed bits ----------------------------------------------------
 * set unsigned/signed bits to byte data
 * args   : uint8_t    *buff IO byte data
@@ -1526,13 +1858,21 @@ uint32_t rtk_crc32(const uint8_t *buff, unsigned len)
 *          unsigned  len     I   data length (bytes)
 * return : crc-24Q parity
 * notes  : see reference [2] A.4.3.3 Parity
+*          8 bytes are processed at once by slicing-by-8 tables
 *-----------------------------------------------------------------------------*/
 uint32_t rtk_crc24q(const uint8_t *buff, unsigned len)
 {
     trace(4, "rtk_crc24q: len=%u\n",len);
 
+    const uint32_t (*t)[256]=tbl_CRC24Q_S8;
     uint32_t crc=0;
-    for (unsigned i=0;i<len;i++)
+    unsigned i=0;
+    for (;i+8<=len;i+=8) {
+        const uint8_t *p=buff+i;
+        crc=t[6][p[0]^(crc>>16)]^t[5][p[1]^((crc>>8)&0xFF)]^t[4][p[2]^(crc&0xFF)]^
+            t[3][p[3]]^t[2][p[4]]^t[1][p[5]]^t[0][p[6]]^tbl_CRC24Q[p[7]];
+    }
+    for (;i<len;i++)
         crc=((crc<<8)&0xFFFFFF)^tbl_CRC24Q[(crc>>16)^buff[i]];
     return crc;
 }
@@ -2148,6 +2488,115 @@ double str2num(const char *s, int i, int n)
     *p='\0';
     return strtod(str,NULL);
 }
+/* string to number by fixed-point decimal ------------------------------------
+* convert substring in string to number as str2num() without strtod(). the
+* digits are accumulated to an integer mantissa and scaled by the exact power
+* of 10 of the decimal count and exponent, which is one correctly rounded
+* operation and the same double as strtod(). the other forms (over 15 digits,
+* exponent over 22, hex, inf/nan) fall back to str2num().
+* args   : char   *s        I   string ("... nnn.nnn ...")
+*          int    i,n       I   substring position and width
+* return : converted number (0.0:error)
+*-----------------------------------------------------------------------------*/
+double str2fix(const char *s, int i, int n)
+{
+    static const double pow10[]={
+        1E0,1E1,1E2,1E3,1E4,1E5,1E6,1E7,1E8,1E9,1E10,1E11,1E12,1E13,1E14,1E15,
+        1E16,1E17,1E18,1E19,1E20,1E21,1E22
+    };
+    const char *p,*q,*e;
+    int64_t mant=0;
+    int k,neg=0,nd=0,nf=0,ne=0,eneg=0,exp;
+
+    if (i<0||255<n) return 0.0;
+    for (k=0;k<i;k++) if (!s[k]) return 0.0;
+
+    for (p=s+i,e=p+n;p<e&&(*p==' '||(*p>='\t'&&*p<='\r'));p++) ;
+    if (p<e&&(*p=='-'||*p=='+')) neg=*p++=='-';
+
+    for (q=p;p<e&&*p=='0';p++) ; /* leading zeros */
+    for (;p<e&&*p>='0'&&*p<='9';p++) if (++nd<=15) mant=mant*10+(*p-'0');
+    if (p<e&&*p=='.') {
+        if (nd==0) for (p++;p<e&&*p=='0';p++) nf++;
+        else p++;
+        for (;p<e&&*p>='0'&&*p<='9';p++,nf++) if (++nd<=15) mant=mant*10+(*p-'0');
+    }
+    if (p==q||(p==q+1&&*q=='.')) { /* no digit */
+        return p<e&&*p&&*p!=' '&&(*p<'\t'||*p>'\r')&&*p!='.'?str2num(s,i,n):0.0;
+    }
+    if (nd>15||(p<e&&(*p=='x'||*p=='X'))) return str2num(s,i,n);
+
+    if (p+1<e&&((*p|0x20)=='e'||(*p|0x20)=='d')) {
+        q=p+1;
+        if (*q=='-'||*q=='+') eneg=*q++=='-';
+        if (q<e&&*q>='0'&&*q<='9') {
+            for (;q<e&&*q>='0'&&*q<='9'&&ne<1000;q++) ne=ne*10+(*q-'0');
+            if (eneg) ne=-ne;
+        }
+    }
+    if (mant==0) return neg?-0.0:0.0;
+    exp=ne-nf;
+    if (exp<-22||exp>22) return str2num(s,i,n);
+    return (neg?-1.0:1.0)*(exp<0?(double)mant/pow10[-exp]:(double)mant*pow10[exp]);
+}
+/* number to string by fixed-point decimal ------------------------------------
+* convert number to string as snprintf(s,size,"%.*f",n,value) without printf.
+* the binary mantissa is split to the integer and fraction part and the
+* decimal digits of the fraction are generated exactly by multiplying by 10,
+* then rounded to nearest even at the last digit as glibc printf. the other
+* forms (abs(value)>=2^53, abs(value)<2^-7 except 0, n>17, inf/nan or size
+* less than n+19) fall back to snprintf().
+* args   : char   *s        O   string
+*          size_t size      I   size of string buffer (bytes)
+*          double value     I   number
+*          int    n         I   number of decimal places
+* return : length of string (as snprintf())
+*-----------------------------------------------------------------------------*/
+int fix2str(char *s, size_t size, double value, int n)
+{
+    char dig[40],*p=s;
+    uint64_t mant,ip,fp,half,mask;
+    double a=fabs(value);
+    int i,k,e,nd=0;
+
+    if (!isfinite(value)||a>=9007199254740992.0||n<0||n>17||
+        (a!=0.0&&a<0.0078125)||size<(size_t)n+19) {
+        return snprintf(s,size,"%.*f",n,value);
+    }
+    mant=(uint64_t)ldexp(frexp(a,&e),53);
+    k=53-e;
+    if (a==0.0||k<=0) {
+        ip=(uint64_t)a;
+        for (i=0;i<n;i++) dig[i]=0;
+    }
+    else {
+        mask=((uint64_t)1<<k)-1;
+        half=(uint64_t)1<<(k-1);
+        ip=mant>>k;
+        fp=mant&mask;
+        for (i=0;i<n;i++) {
+            fp*=10;
+            dig[i]=(char)(fp>>k);
+            fp&=mask;
+        }
+        /* round to nearest even */
+        if (fp>half||(fp==half&&(n>0?dig[n-1]&1:ip&1))) {
+            for (i=n-1;i>=0&&dig[i]==9;i--) dig[i]=0;
+            if (i>=0) dig[i]++; else ip++;
+        }
+    }
+    if (signbit(value)) *p++='-';
+    do {
+        dig[n+nd++]=(char)(ip%10);
+    } while (ip/=10);
+    while (nd>0) *p++=(char)('0'+dig[n+--nd]);
+    if (n>0) {
+        *p++='.';
+        for (i=0;i<n;i++) *p++=(char)('0'+dig[i]);
+    }
+    *p='\0';
+    return (int)(p-s);
+}
 /* string to time --------------------------------------------------------------
 * convert substring in string to gtime_t struct
 * args   : char   *s        I   string ("... yyyy mm dd hh mm ss ...")
@@ -2597,6 +3046,32 @@ uint32_t tickget(void)
 #endif
 #endif /* WIN32 */
 }
+/* get tick time in us ---------------------------------------------------------
+* get current tick in us for measuring short intervals
+* args   : none
+* return : current tick in us
+*-----------------------------------------------------------------------------*/
+uint64_t tickgetus(void)
+{
+#ifdef WIN32
+    LARGE_INTEGER freq,count;
+    
+    if (!QueryPerformanceFrequency(&freq)||!QueryPerformanceCounter(&count)) {
+        return (uint64_t)timeGetTime()*1000u;
+    }
+    return (uint64_t)(count.QuadPart/freq.QuadPart*1000000u+
+                      count.QuadPart%freq.QuadPart*1000000u/freq.QuadPart);
+#else
+    struct timespec tp={0};
+    struct timeval  tv={0};
+    
+    if (!clock_gettime(CLOCK_MONOTONIC,&tp)) {
+        return (uint64_t)tp.tv_sec*1000000u+(uint64_t)tp.tv_nsec/1000u;
+    }
+    gettimeofday(&tv,NULL);
+    return (uint64_t)tv.tv_sec*1000000u+(uint64_t)tv.tv_usec;
+#endif /* WIN32 */
+}
 /* sleep ms --------------------------------------------------------------------
 * sleep ms
 * args   : int   ms         I   milliseconds to sleep (<0:no sleep)
@@ -2614,6 +3089,151 @@ void sleepms(int ms)
     nanosleep(&ts,NULL);
 #endif
 }
+/* load/store ring pointer with acquire/release ordering ---------------------*/
+static uint32_t ringload(const volatile uint32_t *p)
+{
+#if defined(__GNUC__)||defined(__clang__)
+    return __atomic_load_n(p,__ATOMIC_ACQUIRE);
+#elif defined(WIN32)
+    uint32_t v=*p;
+    MemoryBarrier();
+    return v;
+#else
+    return *p;
+#endif
+}
+static void ringstore(volatile uint32_t *p, uint32_t v)
+{
+#if defined(__GNUC__)||defined(__clang__)
+    __atomic_store_n(p,v,__ATOMIC_RELEASE);
+#elif defined(WIN32)
+    MemoryBarrier();
+    *p=v;
+#else
+    *p=v;
+#endif
+}
+/* initialize ring buffer ------------------------------------------------------
+* initialize single-producer/single-consumer ring buffer
+* args   : ring_t *ring     IO  ring buffer
+*          int    size      I   number of elements (rounded up to power of 2)
+*          int    esize     I   element size (bytes)
+* return : status (1:ok,0:memory allocation error)
+* notes  : ringpush() may be called by one producer thread and ringpop() by one
+*          consumer thread concurrently without any lock. both are wait-free.
+*-----------------------------------------------------------------------------*/
+int ringinit(ring_t *ring, int size, int esize)
+{
+    uint32_t n=2;
+    
+    while (n<(uint32_t)size&&n<0x40000000) n<<=1;
+    ring->wp=ring->rp=0;
+    ring->esize=esize;
+    if (!(ring->buff=(uint8_t *)malloc((size_t)n*esize))) {
+        ring->size=0;
+        return 0;
+    }
+    ring->size=n;
+    return 1;
+}
+/* free ring buffer ------------------------------------------------------------
+* free ring buffer
+* args   : ring_t *ring     IO  ring buffer
+* return : none
+*-----------------------------------------------------------------------------*/
+void ringfree(ring_t *ring)
+{
+    free(ring->buff);
+    ring->buff=NULL;
+    ring->size=ring->wp=ring->rp=0;
+}
+/* push element to ring buffer -------------------------------------------------
+* push an element to ring buffer (producer)
+* args   : ring_t *ring     IO  ring buffer
+*          void   *data     I   element (esize bytes)
+* return : status (1:ok,0:buffer full)
+*-----------------------------------------------------------------------------*/
+int ringpush(ring_t *ring, const void *data)
+{
+    uint32_t wp=ring->wp;
+    
+    if (wp-ringload(&ring->rp)>=ring->size) return 0;
+    memcpy(ring->buff+(size_t)(wp&(ring->size-1))*ring->esize,data,ring->esize);
+    ringstore(&ring->wp,wp+1);
+    return 1;
+}
+/* pop element from ring buffer ------------------------------------------------
+* pop an element from ring buffer (consumer)
+* args   : ring_t *ring     IO  ring buffer
+*          void   *data     O   element (esize bytes)
+* return : status (1:ok,0:buffer empty)
+*-----------------------------------------------------------------------------*/
+int ringpop(ring_t *ring, void *data)
+{
+    uint32_t rp=ring->rp;
+    
+    if (ringload(&ring->wp)==rp) return 0;
+    memcpy(data,ring->buff+(size_t)(rp&(ring->size-1))*ring->esize,ring->esize);
+    ringstore(&ring->rp,rp+1);
+    return 1;
+}
+/* write elements to ring buffer ----------------------------------------------
+* write elements to ring buffer up to free space (producer)
+* args   : ring_t *ring     IO  ring buffer
+*          void   *data     I   elements (n*esize bytes)
+*          int    n         I   number of elements
+* return : number of written elements
+*-----------------------------------------------------------------------------*/
+int ringwrite(ring_t *ring, const void *data, int n)
+{
+    uint32_t wp=ring->wp,i=wp&(ring->size-1),m;
+    uint32_t nfree=ring->size-(wp-ringload(&ring->rp));
+    
+    if (n<=0||!nfree) return 0;
+    if ((uint32_t)n>nfree) n=(int)nfree;
+    m=ring->size-i<(uint32_t)n?ring->size-i:(uint32_t)n;
+    memcpy(ring->buff+(size_t)i*ring->esize,data,(size_t)m*ring->esize);
+    if (m<(uint32_t)n) {
+        memcpy(ring->buff,(const uint8_t *)data+(size_t)m*ring->esize,
+               (size_t)(n-m)*ring->esize);
+    }
+    ringstore(&ring->wp,wp+n);
+    return n;
+}
+/* read elements from ring buffer ----------------------------------------------
+* read elements from ring buffer (consumer)
+* args   : ring_t *ring     IO  ring buffer
+*          void   *data     O   elements (nmax*esize bytes) (NULL: discard)
+*          int    nmax      I   max number of elements
+* return : number of read elements
+*-----------------------------------------------------------------------------*/
+int ringread(ring_t *ring, void *data, int nmax)
+{
+    uint32_t rp=ring->rp,i=rp&(ring->size-1),m,n;
+    
+    n=ringload(&ring->wp)-rp;
+    if (nmax<=0||!n) return 0;
+    if (n>(uint32_t)nmax) n=(uint32_t)nmax;
+    if (data) {
+        m=ring->size-i<n?ring->size-i:n;
+        memcpy(data,ring->buff+(size_t)i*ring->esize,(size_t)m*ring->esize);
+        if (m<n) {
+            memcpy((uint8_t *)data+(size_t)m*ring->esize,ring->buff,
+                   (size_t)(n-m)*ring->esize);
+        }
+    }
+    ringstore(&ring->rp,rp+n);
+    return (int)n;
+}
+/* number of elements in ring buffer -------------------------------------------
+* get number of elements in ring buffer
+* args   : ring_t *ring     I   ring buffer
+* return : number of elements
+*-----------------------------------------------------------------------------*/
+int ringcount(const ring_t *ring)
+{
+    return (int)(ringload(&ring->wp)-ringload(&ring->rp));
+}
 /* convert degree to deg-min-sec -----------------------------------------------
 * convert degree to degree-minute-second
 * args   : double deg       I   degree
@@ -4498,6 +5118,104 @@ void uniqnav(nav_t *nav)
     uniqeph (nav);
     uniqgeph(nav);
     uniqseph(nav);
+
+    /* index ephemeris by satellite */
+    indexnav(nav,0x07);
+}
+/* compare ephemeris index keys ----------------------------------------------*/
+typedef struct {        /* ephemeris index key type */
+    gtime_t toe;        /* toe */
+    int sat,i;          /* satellite number and ephemeris index */
+} ephkey_t;
+
+static int cmpephkey(const void *p1, const void *p2)
+{
+    const ephkey_t *q1=(const ephkey_t *)p1,*q2=(const ephkey_t *)p2;
+    double tt;
+    if (q1->sat!=q2->sat) return q1->sat-q2->sat;
+    if ((tt=timediff(q1->toe,q2->toe))!=0.0) return tt<0.0?-1:1;
+    return q1->i-q2->i;
+}
+/* free ephemeris index ------------------------------------------------------*/
+static void freeephidx(ephidx_t *x)
+{
+    free(x->idx); free(x->toe); free(x->off);
+    x->idx=x->off=NULL; x->toe=NULL; x->n=0;
+}
+/* build ephemeris index from keys -------------------------------------------*/
+static void setephidx(ephidx_t *x, ephkey_t *key, int nkey, int n)
+{
+    int i,k;
+
+    if (x->n!=n||!x->idx) {
+        freeephidx(x);
+        if (!(x->idx=(int *)malloc(sizeof(int)*(n>0?n:1)))||
+            !(x->toe=(gtime_t *)malloc(sizeof(gtime_t)*(n>0?n:1)))||
+            !(x->off=(int *)malloc(sizeof(int)*(MAXSAT+1)))) {
+            freeephidx(x);
+            return;
+        }
+    }
+    qsort(key,nkey,sizeof(ephkey_t),cmpephkey);
+    x->gen++;
+
+    for (i=k=0;i<=MAXSAT;i++) {
+        x->off[i]=k;
+        for (;k<nkey&&key[k].sat==i+1;k++) {
+            x->idx[k]=key[k].i;
+            x->toe[k]=key[k].toe;
+        }
+    }
+    x->n=n;
+}
+/* index ephemerides -----------------------------------------------------------
+* build per-satellite indices of ephemerides sorted by toe, used by seleph(),
+* selgeph() and selseph() for binary search instead of a linear scan
+* args   : nav_t  *nav      IO  navigation data
+*          int    opt       I   index option (or of followings)
+*                                 (0x01: gps/qzs/gal/bds/irn ephemeris,
+*                                  0x02: glonass ephemeris,
+*                                  0x04: sbas ephemeris)
+* return : none
+* notes  : the index is ignored while its size differs from the number of
+*          ephemerides, so appending data falls back to a linear scan. call
+*          indexnav() again after ephemerides are replaced in place.
+*-----------------------------------------------------------------------------*/
+void indexnav(nav_t *nav, int opt)
+{
+    ephkey_t *key;
+    int i,n,nmax=0;
+
+    trace(3,"indexnav: opt=%d\n",opt);
+
+    if ((opt&0x01)&&nav->n >nmax) nmax=nav->n;
+    if ((opt&0x02)&&nav->ng>nmax) nmax=nav->ng;
+    if ((opt&0x04)&&nav->ns>nmax) nmax=nav->ns;
+
+    if (!(key=(ephkey_t *)malloc(sizeof(ephkey_t)*(nmax>0?nmax:1)))) return;
+
+    if (opt&0x01) {
+        for (i=n=0;i<nav->n;i++) {
+            if (nav->eph[i].sat<=0||nav->eph[i].sat>MAXSAT) continue;
+            key[n].toe=nav->eph[i].toe; key[n].sat=nav->eph[i].sat; key[n++].i=i;
+        }
+        setephidx(&nav->ieph,key,n,nav->n);
+    }
+    if (opt&0x02) {
+        for (i=n=0;i<nav->ng;i++) {
+            if (nav->geph[i].sat<=0||nav->geph[i].sat>MAXSAT) continue;
+            key[n].toe=nav->geph[i].toe; key[n].sat=nav->geph[i].sat; key[n++].i=i;
+        }
+        setephidx(&nav->igeph,key,n,nav->ng);
+    }
+    if (opt&0x04) {
+        for (i=n=0;i<nav->ns;i++) {
+            if (nav->seph[i].sat<=0||nav->seph[i].sat>MAXSAT) continue;
+            key[n].toe=nav->seph[i].t0; key[n].sat=nav->seph[i].sat; key[n++].i=i;
+        }
+        setephidx(&nav->iseph,key,n,nav->ns);
+    }
+    free(key);
 }
 /* compare observation data -------------------------------------------------*/
 static int cmpobs(const void *p1, const void *p2)
@@ -4629,6 +5347,7 @@ int readnav(const char *file, nav_t *nav)
         }
     }
     fclose(fp);
+    indexnav(nav,0x03);
     return 1;
 }
 int savenav(const char *file, const nav_t *nav)
@@ -4707,11 +5426,15 @@ void freeobs(obs_t *obs)
 *-----------------------------------------------------------------------------*/
 void freenav(nav_t *nav, int opt)
 {
-    if (opt&0x01) {free(nav->eph ); nav->eph =NULL; nav->n =nav->nmax =0;}
-    if (opt&0x02) {free(nav->geph); nav->geph=NULL; nav->ng=nav->ngmax=0;}
-    if (opt&0x04) {free(nav->seph); nav->seph=NULL; nav->ns=nav->nsmax=0;}
-    if (opt&0x08) {free(nav->peph); nav->peph=NULL; nav->ne=nav->nemax=0;}
-    if (opt&0x10) {free(nav->pclk); nav->pclk=NULL; nav->nc=nav->ncmax=0;}
+    if (opt&0x01) {free(nav->eph ); nav->eph =NULL; nav->n =nav->nmax =0; freeephidx(&nav->ieph );
+                   free(nav->ephc); nav->ephc=NULL;}
+    if (opt&0x02) {free(nav->geph); nav->geph=NULL; nav->ng=nav->ngmax=0; freeephidx(&nav->igeph);
+                   free(nav->gephc); nav->gephc=NULL;}
+    if (opt&0x04) {free(nav->seph); nav->seph=NULL; nav->ns=nav->nsmax=0; freeephidx(&nav->iseph);}
+    if (opt&0x08) {free(nav->peph); nav->peph=NULL; nav->ne=nav->nemax=0; freepephp(nav,0x01);
+                   freepephc(nav);}
+    if (opt&0x10) {free(nav->pclk); nav->pclk=NULL; nav->nc=nav->ncmax=0; freepephp(nav,0x02);
+                   freepephc(nav);}
     if (opt&0x20) {free(nav->alm ); nav->alm =NULL; nav->na=nav->namax=0;}
     if (opt&0x40) {free(nav->tec ); nav->tec =NULL; nav->nt=nav->ntmax=0;}
     if (opt&0x80) {free(nav->patt); nav->patt=NULL; nav->natt=nav->nattmax=0;}
@@ -5867,16 +6590,1141 @@ void sunmoonpos(gtime_t tutc, const double *erpv, double *rsun, double *rmoon,
   }
 }
 
+/* in-process uncompression --------------------------------------------------*/
+#define HUFFBITS    10          /* bits of huffman fast decoding table */
+#define CRXMAXORD   9           /* max difference order of compact RINEX */
+#define CRXMAXLEN   4096        /* max line length of compact RINEX */
+#define GZHASHBITS  15          /* bits of hash table of deflate */
+#define GZWSIZE     32768       /* window size of deflate (bytes) */
+#define GZMAXCHAIN  64          /* max length of hash chain search of deflate */
+#define GZNSYM      32768       /* max number of symbols in deflate block */
+
+typedef struct {        /* uncompressed data buffer type */
+    uint8_t *buff;      /* data */
+    size_t n,nmax;      /* data size and allocated size (bytes) */
+} ubuf_t;
+
+typedef struct {        /* input bit stream type */
+    const uint8_t *in;  /* input data */
+    size_t nin,iin;     /* input size and position (bytes) */
+    uint64_t bits;      /* bit buffer (lsb first) */
+    int nbit;           /* number of bits in bit buffer */
+} bitin_t;
+
+typedef struct {        /* output bit stream type */
+    ubuf_t *out;        /* output data */
+    uint64_t bits;      /* bit buffer (lsb first) */
+    int nbit;           /* number of bits in bit buffer */
+    int stat;           /* status (0:error) */
+} bitout_t;
+
+typedef struct {        /* canonical huffman code type */
+    uint16_t fast[1<<HUFFBITS]; /* symbol<<4|length by next bits (0:long code) */
+    uint16_t count[16]; /* number of codes by length */
+    uint16_t symbol[320]; /* symbols ordered by code */
+} huff_t;
+
+typedef struct {        /* compact RINEX data arc type */
+    int64_t d[CRXMAXORD+1]; /* value and differences (x 1E-3) */
+    int order,arc;      /* difference order and arc order (order<0:no data) */
+} crxarc_t;
+
+typedef struct {        /* compact RINEX satellite type */
+    crxarc_t arc[MAXOBSTYPE]; /* data arcs by observation type */
+    char flag[2*MAXOBSTYPE+1]; /* LLI and signal strength flags */
+    int iep;            /* index of last epoch */
+} crxsat_t;
+
+typedef struct {        /* compact RINEX decoder type */
+    int ver;            /* compact RINEX version (1,3) */
+    int ntype[256];     /* number of obs types by system code (ver.1: [0]) */
+    char epoch[CRXMAXLEN]; /* epoch line */
+    crxarc_t clk;       /* receiver clock offset */
+    int iep;            /* epoch index */
+    int slot[256*100];  /* satellite index+1 by system code and prn */
+    crxsat_t *sat;      /* satellites */
+    int nsat,nsatmax;   /* number of satellites and allocated */
+} crx_t;
+
+static const uint16_t lbase[]={
+    3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,
+    195,227,258
+};
+static const uint8_t lext[]={
+    0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0
+};
+static const uint16_t dbase[]={
+    1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,
+    3073,4097,6145,8193,12289,16385,24577
+};
+static const uint8_t dext[]={
+    0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13
+};
+/* extend uncompressed data buffer -------------------------------------------*/
+static int ubufext(ubuf_t *b, size_t n)
+{
+    uint8_t *p;
+    size_t nmax;
+
+    if (b->n+n<=b->nmax) return 1;
+    for (nmax=b->nmax?b->nmax:65536;nmax<b->n+n;nmax*=2) ;
+    if (!(p=(uint8_t *)realloc(b->buff,nmax))) return 0;
+    b->buff=p; b->nmax=nmax;
+    return 1;
+}
+static int ubufadd(ubuf_t *b, const char *s, size_t n)
+{
+    if (!ubufext(b,n)) return 0;
+    memcpy(b->buff+b->n,s,n);
+    b->n+=n;
+    return 1;
+}
+/* get bits from input bit stream --------------------------------------------*/
+static void bitfill(bitin_t *s)
+{
+    while (s->nbit<=56&&s->iin<s->nin) {
+        s->bits|=(uint64_t)s->in[s->iin++]<<s->nbit;
+        s->nbit+=8;
+    }
+}
+static int bitget(bitin_t *s, int n, uint32_t *val)
+{
+    if (s->nbit<n) {
+        bitfill(s);
+        if (s->nbit<n) return 0;
+    }
+    *val=(uint32_t)(s->bits&((1ULL<<n)-1));
+    s->bits>>=n;
+    s->nbit-=n;
+    return 1;
+}
+/* generate canonical huffman code by code lengths ---------------------------*/
+static int huffgen(huff_t *h, const uint8_t *len, int n)
+{
+    uint16_t offs[16];
+    int i,j,k,code,sym,rev,left=1;
+
+    memset(h->count,0,sizeof(h->count));
+    memset(h->fast,0,sizeof(h->fast));
+    for (i=0;i<n;i++) h->count[len[i]]++;
+    for (i=1;i<16;i++) {
+        left=(left<<1)-h->count[i];
+        if (left<0) return 0; /* over-subscribed */
+    }
+    for (i=1,offs[1]=0;i<15;i++) offs[i+1]=offs[i]+h->count[i];
+    for (i=0;i<n;i++) {
+        if (len[i]) h->symbol[offs[len[i]]++]=(uint16_t)i;
+    }
+    /* fast table indexed by the next HUFFBITS bits (lsb first) */
+    for (i=1,code=sym=0;i<=HUFFBITS;i++,code<<=1) {
+        for (j=0;j<h->count[i];j++,code++,sym++) {
+            for (k=rev=0;k<i;k++) rev|=((code>>k)&1)<<(i-1-k);
+            for (k=rev;k<(1<<HUFFBITS);k+=1<<i) {
+                h->fast[k]=(uint16_t)(h->symbol[sym]<<4|i);
+            }
+        }
+    }
+    return 1;
+}
+/* decode huffman code -------------------------------------------------------*/
+static int huffdec(bitin_t *s, const huff_t *h)
+{
+    uint32_t b;
+    int e,len,code=0,first=0,index=0;
+
+    if (s->nbit<HUFFBITS) bitfill(s);
+    e=h->fast[s->bits&((1<<HUFFBITS)-1)];
+    if (e&&(e&15)<=s->nbit) {
+        s->bits>>=e&15;
+        s->nbit-=e&15;
+        return e>>4;
+    }
+    for (len=1;len<16;len++) { /* canonical decoding bit by bit */
+        if (!bitget(s,1,&b)) return -1;
+        code|=(int)b;
+        if (code-h->count[len]<first) return h->symbol[index+code-first];
+        index+=h->count[len];
+        first=(first+h->count[len])<<1;
+        code<<=1;
+    }
+    return -1;
+}
+/* inflate huffman-coded block -----------------------------------------------*/
+static int inflatecodes(bitin_t *s, ubuf_t *out, const huff_t *lc,
+                        const huff_t *dc)
+{
+    uint32_t b;
+    uint8_t *p;
+    size_t len,dist,i;
+    int sym;
+
+    for (;;) {
+        if ((sym=huffdec(s,lc))<0) return 0;
+        if (sym<256) {
+            if (!ubufext(out,1)) return 0;
+            out->buff[out->n++]=(uint8_t)sym;
+            continue;
+        }
+        if (sym==256) return 1; /* end of block */
+        if ((sym-=257)>=29||!bitget(s,lext[sym],&b)) return 0;
+        len=lbase[sym]+b;
+        if ((sym=huffdec(s,dc))<0||sym>=30||!bitget(s,dext[sym],&b)) return 0;
+        dist=dbase[sym]+b;
+        if (dist>out->n||!ubufext(out,len)) return 0;
+        p=out->buff+out->n;
+        for (i=0;i<len;i++) p[i]=p[i-dist];
+        out->n+=len;
+    }
+}
+/* inflate stored block ------------------------------------------------------*/
+static int inflatestored(bitin_t *s, ubuf_t *out)
+{
+    uint32_t len,nlen,b,i;
+
+    s->bits>>=s->nbit&7; /* align to byte boundary */
+    s->nbit-=s->nbit&7;
+    if (!bitget(s,16,&len)||!bitget(s,16,&nlen)||len!=(~nlen&0xFFFF)) return 0;
+    if (!ubufext(out,len)) return 0;
+    for (i=0;i<len;i++) {
+        if (!bitget(s,8,&b)) return 0;
+        out->buff[out->n++]=(uint8_t)b;
+    }
+    return 1;
+}
+/* inflate dynamic huffman block ---------------------------------------------*/
+static int inflatedynamic(bitin_t *s, ubuf_t *out, huff_t *lc, huff_t *dc)
+{
+    static const uint8_t order[19]={
+        16,17,18,0,8,7,9,6,10,5,11,4,12,3,13,2,14,1,15
+    };
+    uint8_t len[320]={0};
+    uint32_t nlen,ndist,ncode,b;
+    int i,n,sym,rep;
+
+    if (!bitget(s,5,&nlen)||!bitget(s,5,&ndist)||!bitget(s,4,&ncode)) return 0;
+    nlen+=257; ndist+=1; ncode+=4;
+    if (nlen>286||ndist>30) return 0;
+    for (i=0;i<(int)ncode;i++) {
+        if (!bitget(s,3,&b)) return 0;
+        len[order[i]]=(uint8_t)b;
+    }
+    if (!huffgen(lc,len,19)) return 0;
+
+    for (i=0,n=(int)(nlen+ndist);i<n;) {
+        if ((sym=huffdec(s,lc))<0) return 0;
+        if (sym<16) {
+            len[i++]=(uint8_t)sym;
+            continue;
+        }
+        if (sym==16) {
+            if (i==0||!bitget(s,2,&b)) return 0;
+            sym=len[i-1]; rep=3+(int)b;
+        }
+        else if (sym==17) {
+            if (!bitget(s,3,&b)) return 0;
+            sym=0; rep=3+(int)b;
+        }
+        else {
+            if (!bitget(s,7,&b)) return 0;
+            sym=0; rep=11+(int)b;
+        }
+        if (i+rep>n) return 0;
+        while (rep--) len[i++]=(uint8_t)sym;
+    }
+    if (!len[256]) return 0; /* no end of block */
+    if (!huffgen(lc,len,nlen)||!huffgen(dc,len+nlen,ndist)) return 0;
+    return inflatecodes(s,out,lc,dc);
+}
+/* inflate deflate stream ----------------------------------------------------*/
+static int inflate_(bitin_t *s, ubuf_t *out)
+{
+    huff_t *lc,*dc;
+    uint8_t len[288];
+    uint32_t last,type;
+    int i,stat=1;
+
+    if (!(lc=(huff_t *)malloc(sizeof(huff_t)*2))) return 0;
+    dc=lc+1;
+    do {
+        if (!bitget(s,1,&last)||!bitget(s,2,&type)) {
+            stat=0;
+            break;
+        }
+        if (type==0) {
+            stat=inflatestored(s,out);
+        }
+        else if (type==1) { /* fixed huffman codes */
+            for (i=0;i<288;i++) len[i]=i<144?8:(i<256?9:(i<280?7:8));
+            huffgen(lc,len,288);
+            for (i=0;i<30;i++) len[i]=5;
+            huffgen(dc,len,30);
+            stat=inflatecodes(s,out,lc,dc);
+        }
+        else if (type==2) {
+            stat=inflatedynamic(s,out,lc,dc);
+        }
+        else stat=0;
+    } while (stat&&!last);
+
+    /* return unused bytes in bit buffer to input */
+    s->iin-=s->nbit/8;
+    s->bits=0;
+    s->nbit=0;
+    free(lc);
+    return stat;
+}
+static uint32_t getu32le(const uint8_t *p)
+{
+    return (uint32_t)p[0]|(uint32_t)p[1]<<8|(uint32_t)p[2]<<16|(uint32_t)p[3]<<24;
+}
+/* crc-32 by table -----------------------------------------------------------*/
+static uint32_t crc32tbl(const uint8_t *buff, size_t len)
+{
+    uint32_t tbl[256],crc=0xFFFFFFFFu,c;
+    size_t i;
+    int j;
+
+    for (i=0;i<256;i++) {
+        for (c=(uint32_t)i,j=0;j<8;j++) c=(c&1)?(c>>1)^POLYCRC32:c>>1;
+        tbl[i]=c;
+    }
+    for (i=0;i<len;i++) crc=tbl[(crc^buff[i])&0xFF]^(crc>>8);
+    return ~crc;
+}
+/* uncompress gzip members ---------------------------------------------------*/
+static int gunzip_(const uint8_t *in, size_t nin, ubuf_t *out)
+{
+    bitin_t s={0};
+    size_t i=0,n0;
+    int flg,nmem=0;
+
+    while (i+10<=nin&&in[i]==0x1F&&in[i+1]==0x8B) {
+        if (in[i+2]!=8) return 0; /* deflate only */
+        flg=in[i+3];
+        i+=10;
+        if ((flg&0x04)&&i+2<=nin) i+=2+(in[i]|in[i+1]<<8); /* FEXTRA */
+        if (flg&0x08) while (i<nin&&in[i++]) ; /* FNAME */
+        if (flg&0x10) while (i<nin&&in[i++]) ; /* FCOMMENT */
+        if (flg&0x02) i+=2; /* FHCRC */
+        if (i>nin) return 0;
+
+        s.in=in; s.nin=nin; s.iin=i;
+        n0=out->n;
+        if (!inflate_(&s,out)||(i=s.iin)+8>nin) return 0;
+        if (crc32tbl(out->buff+n0,out->n-n0)!=getu32le(in+i)||
+            (uint32_t)(out->n-n0)!=getu32le(in+i+4)) {
+            return 0;
+        }
+        i+=8;
+        nmem++;
+    }
+    return nmem>0;
+}
+/* uncompress first member of zip archive ------------------------------------*/
+static int unzip_(const uint8_t *in, size_t nin, ubuf_t *out)
+{
+    bitin_t s={0};
+    size_t i,size;
+    int method,flag;
+
+    if (nin<30||getu32le(in)!=0x04034B50) return 0;
+    flag=in[6]|in[7]<<8;
+    method=in[8]|in[9]<<8;
+    size=getu32le(in+18);
+    i=30+(size_t)(in[26]|in[27]<<8)+(size_t)(in[28]|in[29]<<8);
+    if (i>nin) return 0;
+
+    if (method==8) { /* deflate */
+        s.in=in; s.nin=nin; s.iin=i;
+        return inflate_(&s,out);
+    }
+    if (method==0&&!(flag&0x08)&&i+size<=nin) { /* stored */
+        return ubufadd(out,(const char *)in+i,size);
+    }
+    return 0;
+}
+/* uncompress unix compress (lzw) data ---------------------------------------*/
+static int unlzw_(const uint8_t *in, size_t nin, ubuf_t *out)
+{
+    uint16_t *prefix;
+    uint8_t *suffix,*stack,*sp,finchar=0;
+    uint64_t pos=24,base=24,total=(uint64_t)nin*8;
+    uint32_t code,incode,freeent,maxcode,maxmax,c;
+    int maxbits,block,nbits=9,oldcode=-1,stat=1;
+    size_t p;
+
+    if (nin<3||in[0]!=0x1F||in[1]!=0x9D) return 0;
+    maxbits=in[2]&0x1F;
+    block=in[2]&0x80;
+    if (maxbits<9||maxbits>16) return 0;
+    maxmax=1u<<maxbits;
+    maxcode=nbits==maxbits?maxmax:(1u<<nbits)-1;
+    freeent=block?257:256;
+
+    prefix=(uint16_t *)calloc(maxmax,sizeof(uint16_t));
+    suffix=(uint8_t *)calloc(maxmax,1);
+    stack=(uint8_t *)malloc(maxmax+1);
+    if (!prefix||!suffix||!stack) {
+        free(prefix); free(suffix); free(stack);
+        return 0;
+    }
+    for (c=0;c<256;c++) suffix[c]=(uint8_t)c;
+
+    for (;;) {
+        if (freeent>maxcode&&nbits<maxbits) { /* codes in groups of 8 per width */
+            pos=base+(pos-base+nbits*8-1)/(nbits*8)*(nbits*8);
+            nbits++;
+            maxcode=nbits==maxbits?maxmax:(1u<<nbits)-1;
+            base=pos;
+        }
+        if (pos+nbits>total) break;
+        p=(size_t)(pos>>3);
+        c=in[p]|(p+1<nin?in[p+1]<<8:0)|(p+2<nin?in[p+2]<<16:0);
+        code=(c>>(pos&7))&((1u<<nbits)-1);
+        pos+=nbits;
+
+        if (oldcode<0) {
+            if (code>=256) {
+                stat=0;
+                break;
+            }
+            finchar=(uint8_t)(oldcode=code);
+            if (!(stat=ubufext(out,1))) break;
+            out->buff[out->n++]=finchar;
+            continue;
+        }
+        if (code==256&&block) { /* clear */
+            pos=base+(pos-base+nbits*8-1)/(nbits*8)*(nbits*8);
+            nbits=9;
+            maxcode=nbits==maxbits?maxmax:(1u<<nbits)-1;
+            freeent=256;
+            base=pos;
+            continue;
+        }
+        if (code>=maxmax||code>freeent||(uint32_t)oldcode>=maxmax) { /* corrupt */
+            stat=0;
+            break;
+        }
+        incode=code;
+        sp=stack;
+        if (code==freeent) { /* KwKwK */
+            *sp++=finchar;
+            code=(uint32_t)oldcode;
+        }
+        while (code>=256&&sp<stack+maxmax) {
+            *sp++=suffix[code];
+            code=prefix[code];
+        }
+        if (code>=256) { /* loop of table */
+            stat=0;
+            break;
+        }
+        *sp++=finchar=(uint8_t)code;
+        if (!(stat=ubufext(out,sp-stack))) break;
+        while (sp>stack) out->buff[out->n++]=*--sp;
+
+        if (freeent<maxmax) {
+            prefix[freeent]=(uint16_t)oldcode;
+            suffix[freeent++]=finchar;
+        }
+        oldcode=(int)incode;
+    }
+    free(prefix); free(suffix); free(stack);
+    return stat;
+}
+/* get line of compact RINEX -------------------------------------------------*/
+static int crxline(const uint8_t *in, size_t nin, size_t *i, char *line)
+{
+    int n=0;
+
+    if (*i>=nin) return -1;
+    for (;*i<nin&&in[*i]!='\n';(*i)++) {
+        if (n<CRXMAXLEN-1) line[n++]=(char)in[*i];
+    }
+    if (*i<nin) (*i)++;
+    if (n>0&&line[n-1]=='\r') n--;
+    line[n]='\0';
+    return n;
+}
+/* repair string by text difference of compact RINEX -------------------------*/
+static void crxrepair(char *str, const char *diff, int size)
+{
+    int i,n=(int)strlen(str);
+
+    for (i=0;diff[i]&&i<size-1;i++) {
+        if (i>=n) str[i]=diff[i]=='&'?' ':diff[i];
+        else if (diff[i]=='&') str[i]=' ';
+        else if (diff[i]!=' ') str[i]=diff[i];
+    }
+    if (i>n) str[i]='\0';
+}
+/* decode data arc field of compact RINEX ------------------------------------*/
+static int crxfield(crxarc_t *a, const char *p, const char *q)
+{
+    int64_t v=0;
+    int k,sgn=1;
+
+    if (q-p>=2&&p[1]=='&') { /* initialize arc */
+        if (p[0]<'0'||p[0]>'0'+CRXMAXORD) return 0;
+        a->arc=p[0]-'0';
+        a->order=-1;
+        p+=2;
+    }
+    else if (a->order<0) return 0;
+
+    if (p<q&&(*p=='-'||*p=='+')) sgn=*p++=='-'?-1:1;
+    if (p>=q) return 0;
+    for (;p<q;p++) {
+        if (*p<'0'||*p>'9') return 0;
+        v=v*10+(*p-'0');
+    }
+    if (a->order<a->arc) a->order++;
+    a->d[a->order]=sgn*v;
+    for (k=a->order-1;k>=0;k--) a->d[k]+=a->d[k+1];
+    return 1;
+}
+/* output fixed-point value of compact RINEX ---------------------------------*/
+static char *crxvalue(char *p, int64_t v, int dec, int width)
+{
+    char s[32],*q=s+sizeof(s);
+    uint64_t u=v<0?(uint64_t)0-(uint64_t)v:(uint64_t)v;
+    int i;
+
+    for (i=0;i<dec||u;i++) {
+        if (i==dec) *--q='.';
+        *--q=(char)('0'+u%10);
+        u/=10;
+    }
+    if (i==dec) {*--q='.'; *--q='0';}
+    if (v<0) *--q='-';
+    for (i=width-(int)(s+sizeof(s)-q);i>0;i--) *p++=' ';
+    memcpy(p,q,s+sizeof(s)-q);
+    return p+(s+sizeof(s)-q);
+}
+/* append line to output with trailing spaces removed ------------------------*/
+static int crxout(ubuf_t *out, const char *line, const char *end)
+{
+    while (end>line&&end[-1]==' ') end--;
+    return ubufadd(out,line,end-line)&&ubufadd(out,"\n",1);
+}
+/* number of obs types in header line of RINEX -------------------------------*/
+static void crxtypes(crx_t *crx, const char *line)
+{
+    if (strlen(line)<60) return;
+    if (crx->ver==1&&strstr(line+60,"# / TYPES OF OBSERV")) {
+        if (line[5]!=' ') crx->ntype[0]=(int)str2num(line,0,6);
+    }
+    else if (crx->ver==3&&strstr(line+60,"SYS / # / OBS TYPES")) {
+        if (line[0]!=' ') crx->ntype[(uint8_t)line[0]]=(int)str2num(line,3,3);
+    }
+}
+/* decode epoch of compact RINEX ---------------------------------------------*/
+static int crxepoch(crx_t *crx, const uint8_t *in, size_t nin, size_t *i,
+                    const char *line, ubuf_t *out)
+{
+    char buff[CRXMAXLEN],data[CRXMAXLEN*2],*p,*r;
+    const char *q,*s,*id;
+    crxsat_t *sat;
+    int j,k,n,flag,nsat,ntype,prn,prev,key,nl;
+
+    if ((crx->ver==1&&line[0]=='&')||(crx->ver==3&&line[0]=='>')) {
+        crx->epoch[0]='\0';
+        crx->iep++; /* no previous epoch */
+    }
+    crxrepair(crx->epoch,line,CRXMAXLEN);
+    n=(int)strlen(crx->epoch);
+    if (crx->ver==1) {
+        crx->epoch[0]=' ';
+        flag=n>28?crx->epoch[28]-'0':0;
+        nsat=(int)str2num(crx->epoch,29,3);
+    }
+    else {
+        flag=n>31?crx->epoch[31]-'0':0;
+        nsat=(int)str2num(crx->epoch,32,3);
+    }
+    if (nsat<0||nsat>999) return 0;
+
+    /* event records copied */
+    if (flag>=2&&flag<=5) {
+        k=crx->ver==1?32:35;
+        if (!crxout(out,crx->epoch,crx->epoch+(n<k?n:k))) return 0;
+        for (j=0;j<nsat;j++) {
+            if ((nl=crxline(in,nin,i,buff))<0) return 0;
+            crxtypes(crx,buff);
+            if (!crxout(out,buff,buff+nl)) return 0;
+        }
+        return 1;
+    }
+    /* receiver clock offset */
+    if (crxline(in,nin,i,buff)<0) return 0;
+    if (!buff[0]) crx->clk.order=-1;
+    else if (!crxfield(&crx->clk,buff,buff+strlen(buff))) return 0;
+
+    /* epoch line */
+    p=data;
+    if (crx->ver==1) {
+        memcpy(p,crx->epoch,32<n?32:n);
+        for (k=n;k<32;k++) p[k]=' ';
+        p+=32;
+        for (j=0;j<nsat;j++) {
+            if (j>0&&j%12==0) {
+                if (!crxout(out,data,p)) return 0;
+                memset(p=data,' ',32); p+=32;
+            }
+            for (k=0;k<3;k++) *p++=32+j*3+k<n?crx->epoch[32+j*3+k]:' ';
+            if (j==11&&crx->clk.order>=0) { /* clock on first line */
+                p=crxvalue(p,crx->clk.d[0],9,12);
+            }
+        }
+        if (nsat<12&&crx->clk.order>=0) {
+            for (k=(int)(p-data);k<68;k++) *p++=' ';
+            p=crxvalue(p,crx->clk.d[0],9,12);
+        }
+    }
+    else {
+        memcpy(p,crx->epoch,35<n?35:n);
+        for (k=n;k<35;k++) p[k]=' ';
+        p+=35;
+        if (crx->clk.order>=0) {
+            memset(p,' ',6); p+=6;
+            p=crxvalue(p,crx->clk.d[0],12,15);
+        }
+    }
+    if (!crxout(out,data,p)) return 0;
+    crx->iep++;
+
+    /* observation data records */
+    for (j=0;j<nsat;j++) {
+        id=crx->epoch+(crx->ver==1?32:41)+j*3;
+        if (id+3>crx->epoch+n) return 0;
+        prn=(id[1]==' '?0:id[1]-'0')*10+(id[2]-'0');
+        if (prn<0||prn>99) return 0;
+        key=(uint8_t)(id[0]==' '?'G':id[0])*100+prn;
+        ntype=crx->ntype[crx->ver==1?0:(uint8_t)(id[0]==' '?'G':id[0])];
+        if (ntype<=0||ntype>MAXOBSTYPE) return 0;
+
+        if (!crx->slot[key]) {
+            if (crx->nsat>=crx->nsatmax) {
+                crx->nsatmax=crx->nsatmax?crx->nsatmax*2:64;
+                sat=(crxsat_t *)realloc(crx->sat,sizeof(crxsat_t)*crx->nsatmax);
+                if (!sat) return 0;
+                crx->sat=sat;
+            }
+            memset(crx->sat+crx->nsat,0,sizeof(crxsat_t));
+            crx->slot[key]=++crx->nsat;
+        }
+        sat=crx->sat+crx->slot[key]-1;
+        prev=sat->iep==crx->iep-1;
+        sat->iep=crx->iep;
+        if (!prev) sat->flag[0]='\0';
+
+        if (crxline(in,nin,i,buff)<0) return 0;
+        for (k=0,q=buff;k<ntype;k++) {
+            if (!*q||*q==' ') { /* no data */
+                sat->arc[k].order=-1;
+                if (*q) q++;
+                continue;
+            }
+            for (s=q;*s&&*s!=' ';s++) ;
+            if (!prev&&!(s-q>=2&&q[1]=='&')) return 0;
+            if (!crxfield(sat->arc+k,q,s)) return 0;
+            q=*s?s+1:s;
+        }
+        crxrepair(sat->flag,q,2*MAXOBSTYPE+1);
+        nl=(int)strlen(sat->flag);
+
+        p=r=data;
+        if (crx->ver==3) {
+            memcpy(p,id,3); p+=3;
+        }
+        for (k=0;k<ntype;k++) {
+            if (crx->ver==1&&k>0&&k%5==0) {
+                if (!crxout(out,r,p)) return 0;
+                r=p;
+            }
+            if (sat->arc[k].order>=0) p=crxvalue(p,sat->arc[k].d[0],3,14);
+            else {memset(p,' ',14); p+=14;}
+            *p++=2*k<nl?sat->flag[2*k]:' ';
+            *p++=2*k+1<nl?sat->flag[2*k+1]:' ';
+        }
+        if (!crxout(out,r,p)) return 0;
+    }
+    return 1;
+}
+/* decode compact RINEX ------------------------------------------------------*/
+static int crx2rnx_(const uint8_t *in, size_t nin, ubuf_t *out)
+{
+    crx_t *crx;
+    char line[CRXMAXLEN];
+    size_t i=0;
+    int n,stat=1;
+
+    if ((n=crxline(in,nin,&i,line))<71||!strstr(line+60,"CRINEX VERS")) return 0;
+    if (!(crx=(crx_t *)calloc(1,sizeof(crx_t)))) return 0;
+    crx->ver=str2num(line,0,9)<2.0?1:3;
+    crx->clk.order=-1;
+
+    /* skip "CRINEX PROG / DATE" and copy RINEX header */
+    if (crxline(in,nin,&i,line)<0) stat=0;
+    while (stat&&(n=crxline(in,nin,&i,line))>=0) {
+        crxtypes(crx,line);
+        if (!(stat=crxout(out,line,line+n))) break;
+        if (n>=60&&strstr(line+60,"END OF HEADER")) break;
+    }
+    /* decode epochs */
+    while (stat&&(n=crxline(in,nin,&i,line))>=0) {
+        if (n==0) continue;
+        stat=crxepoch(crx,in,nin,&i,line,out);
+    }
+    free(crx->sat);
+    free(crx);
+    return stat;
+}
+/* uncompress file into memory -------------------------------------------------
+* uncompress (gzip/zip/unix compress/compact RINEX) file into memory buffer
+* args   : char    *file    I   input file
+*          uint8_t **buff   O   uncompressed data (allocated, free by caller)
+*          size_t  *size    O   uncompressed data size (bytes)
+* return : status (-1:error,0:not compressed file,1:uncompress completed)
+* notes  : the compression is selected by file extension as rtk_uncompress()
+*          (.z,.Z,.gz,.GZ,.zip,.ZIP and hatanaka-compression ".??d",".crx")
+*          and the data by their magic numbers and header. compact RINEX
+*          ver.1.0 and 3.0 are supported. tar files are not supported.
+*-----------------------------------------------------------------------------*/
+int rtk_uncompbuf(const char *file, uint8_t **buff, size_t *size)
+{
+    FILE *fp;
+    ubuf_t in={0},out={0};
+    char name[1024],*p;
+    int comp=0,crx=0,stat=0;
+    long n;
+
+    trace(3,"rtk_uncompbuf: file=%s\n",file);
+
+    *buff=NULL;
+    *size=0;
+    if (strlen(file)>=sizeof(name)) return 0;
+    strcpy(name,file);
+    if (!(p=strrchr(name,'.'))) return 0;
+
+    if (!strcmp(p,".z"  )||!strcmp(p,".Z"  )||
+        !strcmp(p,".gz" )||!strcmp(p,".GZ" )||
+        !strcmp(p,".zip")||!strcmp(p,".ZIP")) {
+        comp=1;
+        *p='\0';
+        p=strrchr(name,'.');
+    }
+    if (p&&!strcmp(p,".tar")) return 0;
+    if (p&&((strlen(p)>3&&(p[3]=='d'||p[3]=='D'))||
+            !strcmp(p,".crx")||!strcmp(p,".CRX"))) {
+        crx=1;
+    }
+    if (!comp&&!crx) return 0;
+
+    /* read input file */
+    if (!(fp=fopen(file,"rb"))) {
+        trace(2,"rtk_uncompbuf: file open error %s\n",file);
+        return -1;
+    }
+    if (fseek(fp,0,SEEK_END)||(n=ftell(fp))<0||fseek(fp,0,SEEK_SET)||
+        !ubufext(&in,(size_t)n+1)||fread(in.buff,1,(size_t)n,fp)!=(size_t)n) {
+        fclose(fp);
+        free(in.buff);
+        return -1;
+    }
+    fclose(fp);
+    in.n=(size_t)n;
+
+    if (comp) {
+        if (in.n>=2&&in.buff[0]==0x1F&&in.buff[1]==0x8B) {
+            stat=gunzip_(in.buff,in.n,&out);
+        }
+        else if (in.n>=2&&in.buff[0]==0x1F&&in.buff[1]==0x9D) {
+            stat=unlzw_(in.buff,in.n,&out);
+        }
+        else if (in.n>=4&&getu32le(in.buff)==0x04034B50) {
+            stat=unzip_(in.buff,in.n,&out);
+        }
+        free(in.buff);
+        if (!stat) {
+            trace(2,"rtk_uncompbuf: uncompress error %s\n",file);
+            free(out.buff);
+            return -1;
+        }
+        in=out;
+        memset(&out,0,sizeof(out));
+    }
+    /* decode compact RINEX */
+    if (in.n>=80&&!memcmp(in.buff+60,"CRINEX VERS",11)) {
+        stat=crx2rnx_(in.buff,in.n,&out);
+        free(in.buff);
+        if (!stat) {
+            trace(2,"rtk_uncompbuf: compact RINEX error %s\n",file);
+            free(out.buff);
+            return -1;
+        }
+        in=out;
+    }
+    else if (!comp) { /* not compact RINEX */
+        free(in.buff);
+        return 0;
+    }
+    *buff=in.buff;
+    *size=in.n;
+
+    trace(3,"rtk_uncompbuf: size=%lu\n",(unsigned long)*size);
+    return 1;
+}
+/* open memory buffer as file --------------------------------------------------
+* open memory buffer as read-only file stream
+* args   : uint8_t *buff    I   data (NULL: read/write scratch stream)
+*          size_t  size     I   data size (bytes)
+* return : file pointer (NULL: error)
+* notes  : the buffer must be kept until the stream is closed by fclose().
+*          if buff is NULL, a read/write stream of max size bytes is opened.
+*          on windows, the data are copied to a temporary file.
+*-----------------------------------------------------------------------------*/
+FILE *rtk_fmemopen(const uint8_t *buff, size_t size)
+{
+    FILE *fp;
+
+#ifndef WIN32
+    if (!buff&&size>0) return fmemopen(NULL,size,"w+");
+    if (size>0) return fmemopen((void *)buff,size,"r");
+#endif
+    if (!buff) return tmpfile();
+    if (!(fp=tmpfile())) return NULL;
+    if (fwrite(buff,1,size,fp)!=size) {
+        fclose(fp);
+        return NULL;
+    }
+    rewind(fp);
+    return fp;
+}
+/* put bits to output bit stream ---------------------------------------------*/
+static void bitput(bitout_t *s, uint32_t val, int n)
+{
+    int i;
+
+    s->bits|=(uint64_t)val<<s->nbit;
+    s->nbit+=n;
+    if (s->nbit<32) return;
+    if (!ubufext(s->out,4)) s->stat=0;
+    for (i=0;i<4;i++) {
+        if (s->stat) s->out->buff[s->out->n++]=(uint8_t)s->bits;
+        s->bits>>=8;
+    }
+    s->nbit-=32;
+}
+/* flush bits of output bit stream to byte boundary --------------------------*/
+static void bitflush(bitout_t *s)
+{
+    for (;s->nbit>0;s->nbit-=8) {
+        uint8_t c=(uint8_t)s->bits;
+        if (!ubufadd(s->out,(const char *)&c,1)) s->stat=0;
+        s->bits>>=8;
+    }
+    s->nbit=0;
+    s->bits=0;
+}
+/* huffman code lengths limited to max length --------------------------------*/
+static void hufflen(uint32_t *freq, int n, int maxlen, uint8_t *len)
+{
+    uint32_t f[640];
+    int sym[320],par[640],dep[640],count[320]={0};
+    int i,j,k,a,b,m,nn=0,maxdep=0;
+
+    /* at least two codes to keep the code complete */
+    for (i=j=0;i<n;i++) if (freq[i]) j++;
+    for (i=0;j<2&&i<n;i++) if (!freq[i]) {freq[i]=1; j++;}
+
+    /* symbols sorted by frequency */
+    for (i=0;i<n;i++) {
+        len[i]=0;
+        if (!freq[i]) continue;
+        for (j=nn++;j>0&&freq[sym[j-1]]>freq[i];j--) sym[j]=sym[j-1];
+        sym[j]=i;
+    }
+    /* huffman tree by two queues of leaves and nodes */
+    for (i=0;i<nn;i++) f[i]=freq[sym[i]];
+    for (a=0,b=m=nn;m<2*nn-1;m++) {
+        for (f[m]=0,k=0;k<2;k++) {
+            i=(a<nn&&(b>=m||f[a]<=f[b]))?a++:b++;
+            par[i]=m;
+            f[m]+=f[i];
+        }
+    }
+    dep[2*nn-2]=0;
+    for (i=2*nn-3;i>=0;i--) dep[i]=dep[par[i]]+1;
+    for (i=0;i<nn;i++) {
+        count[dep[i]]++;
+        if (dep[i]>maxdep) maxdep=dep[i];
+    }
+    /* limit code lengths by moving leaves up the tree */
+    for (i=maxdep;i>maxlen;i--) {
+        while (count[i]>0) {
+            for (j=i-2;count[j]==0;j--) ;
+            count[i]-=2;
+            count[i-1]++;
+            count[j+1]+=2;
+            count[j]--;
+        }
+    }
+    /* longer codes to less frequent symbols */
+    for (i=0,k=maxlen<maxdep?maxlen:maxdep;k>0;k--) {
+        for (j=0;j<count[k];j++) len[sym[i++]]=(uint8_t)k;
+    }
+}
+/* canonical huffman codes in bit-reversed order -----------------------------*/
+static void huffcode(const uint8_t *len, int n, uint16_t *code)
+{
+    uint16_t next[16];
+    int i,j,c=0,count[16]={0};
+
+    for (i=0;i<n;i++) count[len[i]]++;
+    for (count[0]=0,i=1;i<16;i++) {
+        c=(c+count[i-1])<<1;
+        next[i]=(uint16_t)c;
+    }
+    for (i=0;i<n;i++) {
+        if (!len[i]) continue;
+        for (c=next[len[i]]++,code[i]=0,j=0;j<len[i];j++) {
+            code[i]=(uint16_t)(code[i]<<1|(c>>j&1));
+        }
+    }
+}
+/* output deflate block with dynamic huffman codes ---------------------------*/
+static void deflateblock(bitout_t *s, const uint16_t *lit, const uint16_t *dist,
+                         int nsym, int final)
+{
+    static const uint8_t order[]={
+        16,17,18,0,8,7,9,6,10,5,11,4,12,3,13,2,14,1,15
+    };
+    uint32_t lfreq[286]={0},dfreq[30]={0},cfreq[19]={0};
+    uint16_t lcode[286],dcode[30],ccode[19],rle[286+30];
+    uint8_t llen[286],dlen[30],clen[19],seq[286+30],lsym[259],dsym[512];
+    int i,j,k,r,nrle=0,hlit,hdist,hclen;
+
+    /* length and distance symbols */
+    for (i=0;i<29;i++) {
+        for (j=lbase[i];j<(i<28?lbase[i+1]:259);j++) lsym[j]=(uint8_t)i;
+    }
+    for (i=0;i<30;i++) {
+        for (j=dbase[i]-1;j<(i<29?dbase[i+1]-1:32768);j++) {
+            if (j<256) dsym[j]=(uint8_t)i;
+            else if (!((j-256)&127)) dsym[256+((j-256)>>7)]=(uint8_t)i;
+        }
+    }
+#define DSYM(d) ((d)<=256?dsym[(d)-1]:dsym[256+(((d)-257)>>7)])
+    for (i=0;i<nsym;i++) {
+        if (!dist[i]) lfreq[lit[i]]++;
+        else {
+            lfreq[257+lsym[lit[i]]]++;
+            dfreq[DSYM(dist[i])]++;
+        }
+    }
+    lfreq[256]=1;
+    hufflen(lfreq,286,15,llen);
+    hufflen(dfreq,30,15,dlen);
+    huffcode(llen,286,lcode);
+    huffcode(dlen,30,dcode);
+    for (hlit=286;hlit>257&&!llen[hlit-1];hlit--) ;
+    for (hdist=30;hdist>1&&!dlen[hdist-1];hdist--) ;
+
+    /* run-length codes of code lengths */
+    memcpy(seq,llen,hlit);
+    memcpy(seq+hlit,dlen,hdist);
+    for (i=0;i<hlit+hdist;i+=r) {
+        for (r=1;i+r<hlit+hdist&&seq[i+r]==seq[i];r++) ;
+        if (seq[i]==0&&r>=3) {
+            k=r<=10?17:18;
+            if (r>138) r=138;
+            rle[nrle++]=(uint16_t)(k|(r-(k==17?3:11))<<5);
+        }
+        else if (seq[i]!=0&&r>=4) {
+            if (r>7) r=7;
+            rle[nrle++]=seq[i];
+            rle[nrle++]=(uint16_t)(16|(r-4)<<5);
+        }
+        else {
+            r=1;
+            rle[nrle++]=seq[i];
+        }
+    }
+    for (i=0;i<nrle;i++) cfreq[rle[i]&31]++;
+    hufflen(cfreq,19,7,clen);
+    huffcode(clen,19,ccode);
+    for (hclen=19;hclen>4&&!clen[order[hclen-1]];hclen--) ;
+
+    /* block header */
+    bitput(s,final?1:0,1);
+    bitput(s,2,2);
+    bitput(s,hlit-257,5);
+    bitput(s,hdist-1,5);
+    bitput(s,hclen-4,4);
+    for (i=0;i<hclen;i++) bitput(s,clen[order[i]],3);
+    for (i=0;i<nrle;i++) {
+        k=rle[i]&31;
+        bitput(s,ccode[k],clen[k]);
+        if (k==16) bitput(s,rle[i]>>5,2);
+        else if (k==17) bitput(s,rle[i]>>5,3);
+        else if (k==18) bitput(s,rle[i]>>5,7);
+    }
+    /* compressed data */
+    for (i=0;i<nsym;i++) {
+        if (!dist[i]) {
+            bitput(s,lcode[lit[i]],llen[lit[i]]);
+            continue;
+        }
+        k=lsym[lit[i]];
+        bitput(s,lcode[257+k],llen[257+k]);
+        if (lext[k]) bitput(s,lit[i]-lbase[k],lext[k]);
+        k=DSYM(dist[i]);
+        bitput(s,dcode[k],dlen[k]);
+        if (dext[k]) bitput(s,dist[i]-dbase[k],dext[k]);
+    }
+    bitput(s,lcode[256],llen[256]);
+#undef DSYM
+}
+/* deflate data by lz77 with hash chains and dynamic huffman codes -----------*/
+static int deflate_(const uint8_t *in, size_t nin, ubuf_t *out)
+{
+    bitout_t s={0};
+    uint16_t *lit,*dist;
+    int32_t *head,*prev;
+    size_t i,j,k,m;
+    uint32_t h;
+    int n,nsym=0,len,best,bdist,chain;
+
+    s.out=out;
+    s.stat=1;
+    lit =(uint16_t *)malloc(sizeof(uint16_t)*GZNSYM);
+    dist=(uint16_t *)malloc(sizeof(uint16_t)*GZNSYM);
+    head=(int32_t *)malloc(sizeof(int32_t)<<GZHASHBITS);
+    prev=(int32_t *)malloc(sizeof(int32_t)*GZWSIZE);
+    if (!lit||!dist||!head||!prev) {
+        free(lit); free(dist); free(head); free(prev);
+        return 0;
+    }
+    for (n=0;n<1<<GZHASHBITS;n++) head[n]=-1;
+
+#define HASH(p) ((((uint32_t)(p)[0]<<16|(uint32_t)(p)[1]<<8|(p)[2])*2654435761u)>>(32-GZHASHBITS))
+    for (i=0;i<nin;i+=len) {
+        best=len=1;
+        bdist=0;
+        if (i+3<=nin) {
+            m=nin-i<258?nin-i:258;
+            h=HASH(in+i);
+            for (k=(size_t)head[h],chain=GZMAXCHAIN;head[h]>=0&&i-k<=GZWSIZE&&
+                 chain>0;chain--) {
+                if (in[k+best-1]==in[i+best-1]) {
+                    for (j=0;j<m&&in[k+j]==in[i+j];j++) ;
+                    if ((int)j>best) {
+                        best=(int)j;
+                        bdist=(int)(i-k);
+                        if (j>=m) break;
+                    }
+                }
+                if (prev[k&(GZWSIZE-1)]<0||(size_t)prev[k&(GZWSIZE-1)]>=k) break;
+                k=(size_t)prev[k&(GZWSIZE-1)];
+            }
+            if (best>=3) len=best;
+        }
+        if (len>=3) {
+            lit[nsym]=(uint16_t)len;
+            dist[nsym++]=(uint16_t)bdist;
+        }
+        else {
+            lit[nsym]=in[i];
+            dist[nsym++]=0;
+        }
+        /* insert strings to hash chains */
+        for (k=i;k<i+len&&k+3<=nin;k++) {
+            h=HASH(in+k);
+            prev[k&(GZWSIZE-1)]=head[h];
+            head[h]=(int32_t)k;
+        }
+        if (nsym>=GZNSYM) {
+            deflateblock(&s,lit,dist,nsym,0);
+            nsym=0;
+        }
+    }
+#undef HASH
+    deflateblock(&s,lit,dist,nsym,1);
+    bitflush(&s);
+    free(lit); free(dist); free(head); free(prev);
+    return s.stat;
+}
+/* gzip compress file ----------------------------------------------------------
+* compress file to gzip file in process
+* args   : char   *file     I   input file
+*          char   *gzfile   I   output gzip file
+* return : status (1:ok,0:error)
+* notes  : the input file is read into memory and compressed by deflate with
+*          dynamic huffman codes in a single gzip member.
+*-----------------------------------------------------------------------------*/
+int rtk_gzip(const char *file, const char *gzfile)
+{
+    static const uint8_t hdr[]={0x1F,0x8B,8,0,0,0,0,0,0,3};
+    FILE *fp;
+    ubuf_t in={0},out={0};
+    uint8_t tail[8];
+    uint32_t crc;
+    long n;
+    int i,stat=0;
+
+    trace(3,"rtk_gzip: file=%s gzfile=%s\n",file,gzfile);
+
+    if (!(fp=fopen(file,"rb"))) {
+        trace(2,"rtk_gzip: file open error %s\n",file);
+        return 0;
+    }
+    if (!fseek(fp,0,SEEK_END)&&(n=ftell(fp))>=0&&!fseek(fp,0,SEEK_SET)&&
+        ubufext(&in,(size_t)n+1)) {
+        in.n=fread(in.buff,1,(size_t)n,fp);
+        stat=in.n==(size_t)n;
+    }
+    fclose(fp);
+
+    if (stat) stat=ubufadd(&out,(const char *)hdr,sizeof(hdr))&&
+                   deflate_(in.buff,in.n,&out);
+    if (stat) {
+        crc=crc32tbl(in.buff,in.n);
+        for (i=0;i<4;i++) {
+            tail[i  ]=(uint8_t)(crc>>(8*i));
+            tail[i+4]=(uint8_t)((uint32_t)in.n>>(8*i));
+        }
+        stat=ubufadd(&out,(const char *)tail,8);
+    }
+    if (stat) {
+        if (!(fp=fopen(gzfile,"wb"))) stat=0;
+        else {
+            stat=fwrite(out.buff,1,out.n,fp)==out.n;
+            if (fclose(fp)) stat=0;
+            if (!stat) remove(gzfile);
+        }
+    }
+    if (!stat) trace(2,"rtk_gzip: compress error %s\n",file);
+    free(in.buff);
+    free(out.buff);
+    return stat;
+}
 /* uncompress file -------------------------------------------------------------
 * uncompress (uncompress/unzip/uncompact hatanaka-compression/tar) file
 * args   : char   *file     I   input file
 *          char   *uncfile  O   uncompressed file
 * return : status (-1:error,0:not compressed file,1:uncompress completed)
 * note   : creates uncompressed file in temporary directory
-*          gzip, tar and crx2rnx commands have to be installed in commands path
+*          gzip, zip, unix compress and compact RINEX files are uncompressed
+*          in process by rtk_uncompbuf(). tar files or the files failed are
+*          processed by gzip, tar and crx2rnx commands, which have to be
+*          installed in commands path
 *-----------------------------------------------------------------------------*/
 int rtk_uncompress(const char *file, char *uncfile)
 {
+    FILE *fp;
+    uint8_t *data;
+    size_t size;
     int stat=0;
     char *p,cmd[64+2048]="",tmpfile[1024]="",buff[1024],*fname,*dir="";
 
@@ -5885,6 +7733,33 @@ int rtk_uncompress(const char *file, char *uncfile)
     strcpy(tmpfile,file);
     if (!(p=strrchr(tmpfile,'.'))) return 0;
 
+    /* uncompress in process */
+    if (rtk_uncompbuf(file,&data,&size)>0) {
+        if (!strcmp(p,".z"  )||!strcmp(p,".Z"  )||
+            !strcmp(p,".gz" )||!strcmp(p,".GZ" )||
+            !strcmp(p,".zip")||!strcmp(p,".ZIP")) {
+            *p='\0';
+        }
+        strcpy(uncfile,tmpfile);
+        if ((p=strrchr(tmpfile,'.'))&&
+            ((strlen(p)>3&&(*(p+3)=='d'||*(p+3)=='D'))||
+             !strcmp(p,".crx")||!strcmp(p,".CRX"))) {
+            uncfile[p-tmpfile+3]=*(p+3)=='D'?'O':'o';
+        }
+        if ((fp=fopen(uncfile,"wb"))) {
+            stat=fwrite(data,1,size,fp)==size;
+            if (fclose(fp)) stat=0;
+            if (!stat) remove(uncfile);
+        }
+        free(data);
+        if (stat) {
+            trace(3,"rtk_uncompress: stat=%d\n",stat);
+            return 1;
+        }
+        strcpy(tmpfile,file);
+        p=strrchr(tmpfile,'.');
+    }
+
     /* uncompress by gzip */
     if (!strcmp(p,".z"  )||!strcmp(p,".Z"  )||
         !strcmp(p,".gz" )||!strcmp(p,".GZ" )||
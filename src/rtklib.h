@@ -270,6 +270,7 @@ extern "C" {
 #define MAXDTOE_GLO 1800.0              /* max time difference to GLONASS Toe (s) */
 #define MAXDTOE_IRN 7200.0              /* max time difference to IRNSS Toe (s) */
 #define MAXDTOE_SBS 360.0               /* max time difference to SBAS Toe (s) */
+#define NGLONODE    16                  /* number of GLONASS orbit nodes each side of Toe */
 #define MAXDTOE_S   86400.0             /* max time difference to ephem toe (s) for other */
 #define MAXGDOP     300.0               /* max GDOP */
 
@@ -293,6 +294,7 @@ extern "C" {
 #define RTKSVRNSOL  3                   // Number of RTK server output streams.
 #endif
 #define MAXSTRRTK   (RTKSVRNIN * 2 + RTKSVRNSOL) // Max number of stream in RTK server.
+#define RTKSVRQLEN  64                  /* length of RTK server stage queues */
 #define MAXSBSMSG   32                  /* max number of SBAS msg in RTK server */
 #define MAXSOLLEN   512                 /* max line length of solution message */
 #define MAXSOLMSG   32768               /* max length of solution messages */
@@ -300,13 +302,14 @@ extern "C" {
 #define MAXERRMSG   4096                /* max length of error/warning message */
 #define MAXANT      64                  /* max length of station name/antenna type */
 #define MAXSOLBUF   256                 /* max number of solution buffer */
-#define MAXOBSBUF   128                 /* max number of observation data buffer */
+#define MAXLATBUF   1024                /* max number of latency samples */
 #define MAXNRPOS    16                  /* max number of reference positions */
 #define MAXLEAPS    64                  /* max number of leap seconds table */
 #define MAXGISLAYER 32                  /* max number of GIS data layers */
 #define MAXRCVCMD   4096                /* max length of receiver commands */
 #define MAX_CODE_BIASES 4               /* max # of different code biases per freq */
 #define MAXINFILES   6                  // Max # of rtksvr input files.
+#define MAXINVALIDTM 100                /* max number of invalid time marks in post-processing */
 
 #define RNX2VER     2.10                /* RINEX ver.2 default output version */
 #define RNX3VER     3.00                /* RINEX ver.3 default output version */
@@ -578,6 +581,11 @@ extern "C" {
 #define rtklib_initlock(f) InitializeCriticalSection(f)
 #define rtklib_lock(f)     EnterCriticalSection(f)
 #define rtklib_unlock(f)   LeaveCriticalSection(f)
+#define rtklib_cond_t      CONDITION_VARIABLE
+#define rtklib_initcond(c) InitializeConditionVariable(c)
+#define rtklib_signal(c)   WakeConditionVariable(c)
+#define rtklib_broadcast(c) WakeAllConditionVariable(c)
+#define rtklib_wait(c,f)   SleepConditionVariableCS(c,f,INFINITE)
 #define RTKLIB_FILEPATHSEP '\\'
 /* strtok_r not supported in Windows */
 #ifdef _MSC_VER
@@ -591,6 +599,11 @@ extern "C" {
 #define rtklib_initlock(f) pthread_mutex_init(f,NULL)
 #define rtklib_lock(f)     pthread_mutex_lock(f)
 #define rtklib_unlock(f)   pthread_mutex_unlock(f)
+#define rtklib_cond_t      pthread_cond_t
+#define rtklib_initcond(c) pthread_cond_init(c,NULL)
+#define rtklib_signal(c)   pthread_cond_signal(c)
+#define rtklib_broadcast(c) pthread_cond_broadcast(c)
+#define rtklib_wait(c,f)   pthread_cond_wait(c,f)
 #define RTKLIB_FILEPATHSEP '/'
 #endif
 
@@ -729,6 +742,22 @@ typedef struct {        /* GPS/QZS/GAL broadcast ephemeris type */
     double Adot,ndot;   /* Adot,ndot for CNAV */
 } eph_t;
 
+typedef struct {        /* evaluated broadcast ephemeris type */
+    int sat;            /* satellite number */
+    int geo;            /* BeiDou GEO satellite (0:no,1:yes) */
+    gtime_t toe,toc;    /* Toe,Toc (gpst) */
+    double A,e,i0,M0,omg,idot; /* SV orbit parameters */
+    double crc,crs,cuc,cus,cic,cis; /* harmonic correction terms */
+    double f0,f1,f2;    /* SV clock parameters (af0,af1,af2) */
+    double n;           /* corrected mean motion sqrt(mu/A^3)+deln (rad/s) */
+    double sqe;         /* sqrt(1-e^2) */
+    double OMG0,OMGd;   /* OMG0 (rad), OMGd-omge (OMGd for GEO) (rad/s) */
+    double OMGt;        /* omge*toes (rad) */
+    double omge;        /* earth angular velocity (rad/s) */
+    double rel;         /* relativity coefficient 2*sqrt(mu*A)*e (m) */
+    double var;         /* position and clock error variance (m^2) */
+} ephc_t;
+
 typedef struct {        /* GLONASS broadcast ephemeris type */
     int sat;            /* satellite number */
     int iode;           /* IODE (0-6 bit of tb field) */
@@ -745,6 +774,15 @@ typedef struct {        /* GLONASS broadcast ephemeris type */
     double dtaun;       /* delay between L1 and L2 (s) */
 } geph_t;
 
+typedef struct {        /* evaluated GLONASS ephemeris type */
+    int sat;            /* satellite number */
+    int herm;           /* orbit between nodes (0:RK4 integration,1:Hermite) */
+    gtime_t toe;        /* epoch of ephemerides (gpst) */
+    double acc[3];      /* satellite acceleration (ecef) (m/s^2) */
+    double taun,gamn;   /* SV clock bias (s)/relative freq bias */
+    double x[(NGLONODE*2+1)*6]; /* orbit {pos,vel} at Toe+k*60s (k=-NGLONODE..NGLONODE) */
+} gephc_t;
+
 typedef struct {        /* precise ephemeris type */
     gtime_t time;       /* time (GPST) */
     int index;          /* ephemeris index for multiple files */
@@ -756,6 +794,28 @@ typedef struct {        /* precise ephemeris type */
     float  vco[MAXSAT][3]; /* satellite velocity covariance (m^2) */
 } peph_t;
 
+typedef struct {        /* packed precise ephemeris/clock type */
+    int n;              /* number of epochs */
+    int nv;             /* number of values per data (4:ephemeris,1:clock) */
+    int drop;           /* records dropped after packing (0:no,1:yes) */
+    gtime_t *time;      /* epoch times (gpst) */
+    int nd[MAXSAT];     /* number of data per satellite */
+    int *ie[MAXSAT];    /* epoch indices of data */
+    double *val[MAXSAT]; /* satellite position/clock (ecef) (m|s) {x,y,z,clk}|{clk} */
+    float *std[MAXSAT]; /* satellite position/clock std (m|s) */
+} pephp_t;
+
+typedef struct {        /* Chebyshev fit of precise ephemeris type */
+    int ne,nc;          /* number of packed ephemeris/clock epochs when fitted */
+    int nseg;           /* number of segments */
+    gtime_t ts;         /* start time of first segment (gpst) */
+    double tseg;        /* segment length (s) */
+    int *ie,*ic;        /* first ephemeris/clock index searched for segments */
+    double *coef[MAXSAT]; /* orbit Chebyshev coefficients per segment (NULL: no data) */
+    uint8_t *ok[MAXSAT]; /* segment fitted flags */
+    double errmax,errrms; /* max and rms fit error vs. interpolation (m) */
+} pephc_t;
+
 typedef struct {        /* precise clock type */
     gtime_t time;       /* time (GPST) */
     int index;          /* clock index for multiple files */
@@ -918,6 +978,14 @@ typedef struct {        /* SSR correction type */
     uint8_t update;     /* update flag (0:no update,1:update) */
 } ssr_t;
 
+typedef struct {        /* ephemeris index type */
+    int n;              /* number of ephemerides when indexed */
+    int gen;            /* generation of index (incremented on build) */
+    int *idx;           /* ephemeris indices sorted by satellite and toe */
+    gtime_t *toe;       /* toe of sorted ephemerides */
+    int *off;           /* first sorted entry of each satellite {0..MAXSAT} */
+} ephidx_t;
+
 typedef struct {        /* navigation data type */
     int n,nmax;         /* number of broadcast ephemeris */
     int ng,ngmax;       /* number of glonass ephemeris */
@@ -935,6 +1003,12 @@ typedef struct {        /* navigation data type */
     patt_t *patt;       // Precise attitude.
     alm_t *alm;         /* almanac data */
     tec_t *tec;         /* tec grid data */
+    ephidx_t ieph,igeph,iseph; /* ephemeris indices by satellite */
+    ephc_t *ephc;       /* evaluated ephemerides (parallel to eph) */
+    gephc_t *gephc;     /* evaluated GLONASS ephemerides (parallel to geph) */
+    pephp_t pephp,pclkp; /* packed precise ephemeris/clock */
+    pephc_t pephc;      /* Chebyshev fit of precise ephemeris */
+    int ephcgen,gephcgen; /* index generations of evaluated ephemerides */
     erp_t  erp;         /* earth rotation parameters */
     double utc_gps[8];  /* GPS delta-UTC parameters {A0,A1,Tot,WNt,dt_LS,WN_LSF,DN,dt_LSF} */
     double utc_glo[8];  /* GLONASS UTC time parameters {tau_C,tau_GPS} */
@@ -1031,6 +1105,14 @@ typedef struct {        /* solution status buffer type */
     solstat_t *data;    /* solution status data */
 } solstatbuf_t;
 
+typedef struct {        /* bit stream reader type */
+    const uint8_t *buff; /* byte data */
+    unsigned nbyte;     /* data length (bytes) */
+    unsigned pos;       /* byte position of next fill */
+    uint64_t word;      /* word buffer (MSB first) */
+    unsigned nbit;      /* number of bits in word buffer */
+} bitrd_t;
+
 typedef struct {        /* RTCM control struct type */
     int staid;          /* station id */
     int stah;           /* station health */
@@ -1061,6 +1143,7 @@ typedef struct {        /* RTCM control struct type */
     int nbit;           /* number of bits in word buffer */
     int len;            /* message length (bytes) */
     uint8_t buff[1200]; /* message buffer */
+    const uint8_t *frame; /* message frame in decoding (NULL: buff) */
     uint32_t word;      /* word buffer for rtcm 2 */
     uint32_t nmsg2[100]; /* message count of RTCM 2 (1-99:1-99,0:other) */
     uint32_t nmsg3[400]; /* message count of RTCM 3 (1-299:1001-1299,300-329:4070-4099,0:other) */
@@ -1085,6 +1168,13 @@ typedef struct {        /* RINEX control struct type */
     char   opt[256];    /* rinex dependent options */
 } rnxctr_t;
 
+typedef struct {        /* compact RINEX encoder type */
+    FILE *fp;           /* compact RINEX output file */
+    FILE *tmp;          /* RINEX text stream to be encoded */
+    int ver;            /* compact RINEX version (1,3) */
+    void *state;        /* encoder state */
+} crxenc_t;
+
 typedef struct {        /* download URL type */
     char type[32];      /* data type */
     char path[1024];    /* URL path */
@@ -1177,6 +1267,8 @@ typedef struct {        /* processing options type */
     int  freqopt;       /* disable L2-AR */
     char pppopt[256];   /* ppp option */
     elmask_t elmask[2]; // Elevation mask pattern: rover, base.
+    int  gloorb;        /* GLONASS orbit (0:RK4 integration,1:Hermite interpolation) */
+    int  pephfit;       /* precise orbit (0:polynomial interpolation,1:Chebyshev fit) */
 } prcopt_t;
 
 typedef struct {        /* solution options type */
@@ -1216,6 +1308,7 @@ typedef struct {        /* file options type */
     char geexe  [MAXSTRPATH]; /* google earth exec file */
     char solstat[MAXSTRPATH]; /* solution statistics file */
     char trace  [MAXSTRPATH]; /* debug trace file */
+    char cache  [MAXSTRPATH]; /* obs/nav cache directory ("":no cache) */
 } filopt_t;
 
 typedef struct {        /* RINEX options type */
@@ -1257,6 +1350,8 @@ typedef struct {        /* RINEX options type */
     int ltspan;         /* Lock time span correction */
     int sortsats;       /* Sort by satellite index */
     int sep_nav;        /* separated nav files */
+    int crx;            /* compact RINEX (hatanaka) obs output */
+    int gzip;           /* gzip compressed output files */
     gtime_t tstart;     /* first obs time */
     gtime_t tend;       /* last obs time */
     gtime_t trtcm;      /* approx log start time for rtcm */
@@ -1310,6 +1405,10 @@ typedef struct {        /* RTK control/result type */
     double tt;          /* time difference between current and previous (s) */
     double *x, *P;      /* float states and their covariance */
     double *xa,*Pa;     /* fixed states and their covariance */
+    int nk,nkr;         // Number of state keys, keys of the real-valued states.
+    int nxmax,namax;    // Allocated number of float/fixed states.
+    int *kx;            // State index of each state key (-1: not allocated).
+    int *xk;            // State key of each allocated state.
     int nfix;           /* number of continuous fixes of ambiguity */
     int excsat;         /* index of next satellite to be excluded for partial ambiguity resolution */
     int nb_ar;          /* number of ambiguities used for AR last epoch */
@@ -1389,6 +1488,7 @@ typedef struct {        /* stream server type */
     int buffsize;       /* input/monitor buffer size (bytes) */
     int nmeacycle;      /* NMEA request cycle (ms) (0:no) */
     int relayback;      /* relay back of output streams (0:no) */
+    int cliqlen,cliqpol; /* client output queue length/policy */
     int nstr;           /* number of streams (1 input + (nstr-1) outputs */
     int npb;            /* data length in peek buffer (bytes) */
     char cmds_periodic[16][MAXRCVCMD]; /* periodic commands */
@@ -1403,6 +1503,26 @@ typedef struct {        /* stream server type */
     rtklib_lock_t lock; /* lock flag */
 } strsvr_t;
 
+typedef struct {        /* single-producer/single-consumer ring buffer type */
+    uint8_t *buff;      /* buffer of elements */
+    uint32_t size;      /* number of elements (power of 2) */
+    int esize;          /* element size (bytes) */
+    uint8_t pad1[48];   /* padding to separate cache lines of pointers */
+    volatile uint32_t wp; /* write pointer (written by producer only) */
+    uint8_t pad2[60];
+    volatile uint32_t rp; /* read pointer (written by consumer only) */
+    uint8_t pad3[60];
+} ring_t;
+
+typedef struct {        /* RTK server stage queue type */
+    ring_t ring;        /* ring buffer of message pointers */
+    void *svr;          /* RTK server */
+    int index;          /* queue index (0-(RTKSVRNIN-1):input,RTKSVRNIN:output) */
+    uint32_t nmsg;      /* number of queued messages */
+    uint32_t nfull;     /* number of waits on full queue (back-pressure) */
+    int npeak;          /* peak number of queued messages */
+} rtkque_t;
+
 typedef struct {        /* RTK server type */
     int state;          /* server state (0:stop,1:running) */
     int cycle;          /* processing cycle (ms) */
@@ -1417,26 +1537,32 @@ typedef struct {        /* RTK server type */
     int nsol;           /* number of solution buffer */
     rtk_t rtk;          /* RTK control/result struct */
     int nb [RTKSVRNIN];  /* bytes in input buffers {rov,base} */
-    int nsb[RTKSVRNSOL]; /* bytes in solution buffers */
-    int npb[RTKSVRNIN];  /* bytes in input peek buffers */
     uint8_t *buff[RTKSVRNIN];  /* input buffers {rov,base,corr} */
-    uint8_t *sbuf[RTKSVRNSOL]; /* output buffers {sol1,sol2} */
-    uint8_t *pbuf[RTKSVRNIN];  /* peek buffers {rov,base,corr} */
+    ring_t sbuf[RTKSVRNSOL]; /* output peek buffers {sol1,sol2,sol3} */
+    ring_t pbuf[RTKSVRNIN];  /* input peek buffers {rov,base,corr} */
     sol_t solbuf[MAXSOLBUF]; /* solution line buffer */
     uint32_t nmsg[RTKSVRNIN][10]; /* input message counts */
     raw_t  raw [RTKSVRNIN]; /* receiver raw control {rov,base,corr} */
     rtcm_t rtcm[RTKSVRNIN]; /* RTCM control {rov,base,corr} */
     gtime_t ftime[RTKSVRNIN];  /* download time {rov,base,corr} */
     char files[RTKSVRNIN][MAXSTRPATH]; /* download paths {rov,base,corr} */
-    obs_t obs[RTKSVRNIN][MAXOBSBUF]; /* observation data {rov,base,corr} */
+    obs_t obs[RTKSVRNIN]; /* observation data {rov,base,corr} */
     nav_t nav;          /* navigation data */
     sbsmsg_t sbsmsg[MAXSBSMSG]; /* SBAS message buffer */
     stream_t stream[MAXSTRRTK]; /* streams {rov,base,corr1,corr2,logr,logb,logc1,logc2,sol1,sol2,sol3} */
     stream_t *moni;     /* monitor stream */
     uint32_t tick;      /* start tick */
-    rtklib_thread_t thread; /* server thread */
+    rtklib_thread_t thread; /* server thread (positioning stage) */
+    rtklib_thread_t ithread[RTKSVRNIN]; /* input stage threads {rov,base,corr} */
+    rtklib_thread_t othread; /* output stage thread */
+    rtkque_t que[RTKSVRNIN+1]; /* stage queues {rov,base,corr,sol} */
+    ring_t mark;        /* mark messages to output stage */
+    rtklib_lock_t qlock; /* lock flag of stage wakeup */
+    rtklib_cond_t qcond[2]; /* wakeup of positioning/output stage */
     int cputime;        /* CPU time (ms) for a processing cycle */
     int prcout;         /* missing observation data count */
+    int nlat;           /* number of latency samples */
+    float lat[MAXLATBUF]; /* input-to-solution latency samples (ring) (ms) */
     int nave;           /* number of averaging base pos */
     double rb_ave[3];   /* averaging base pos */
     char cmds_periodic[RTKSVRNIN][MAXRCVCMD]; /* periodic commands */
@@ -1444,11 +1570,56 @@ typedef struct {        /* RTK server type */
     double bl_reset;    /* baseline length to reset (km) */
     pcvs_t pcvsr;       // Receiver antenna parameters.
     rtklib_lock_t lock; /* lock flag */
+    rtklib_lock_t ilock[RTKSVRNIN]; /* lock flags of input decoders {rov,base,corr} */
     char name[2][MAXANT]; // Rover and reference effective names.
     char infiles[MAXINFILES][MAXSTRPATH]; // Queued SP3, CLK and ERP files.
     int ninfiles;       // Number of queued SP3, CLK and ERP files.
 } rtksvr_t;
 
+typedef struct {        /* post-processing shared products type */
+    satsvns_t satsvns;  /* satellite SINEX meta data (svn to prn mapping) */
+    pcvs_t pcvs;        /* satellite antenna parameters */
+    pcvs_t pcvr;        /* receiver antenna parameters */
+    nav_t nav;          /* precise ephemeris/clock (packed and fitted) */
+} ppprod_t;
+
+typedef struct {        /* post-processing pass type */
+    int reverse;        /* analysis direction (0:forward,1:backward) */
+    int iobsu;          /* current rover observation data index */
+    int iobsr;          /* current reference observation data index */
+    int isbs;           /* current sbas message index */
+    int prog;           /* show progress (0:off,1:on) */
+    nav_t *nav;         /* navigation data of the pass */
+    sol_t *sol;         /* solutions (combined mode) */
+    double *rb;         /* base positions (combined mode) */
+    int nsol;           /* number of solutions */
+} pppass_t;
+
+typedef struct {        /* post-processing context type */
+    const ppprod_t *prod; /* shared read-only products (NULL: read by session) */
+    int passthread;     /* combined passes in threads (0:off,1:on) */
+    satsvns_t satsvns;  /* satellite SINEX meta data (svn to prn mapping) */
+    pcvs_t pcvss;       /* satellite antenna parameters */
+    pcvs_t pcvsr;       /* receiver antenna parameters */
+    obs_t obss;         /* observation data */
+    nav_t navs;         /* navigation data */
+    sbs_t sbss;         /* sbas messages */
+    int nepoch;         /* number of observation epochs */
+    int nitm;           /* number of invalid time marks */
+    int iitm;           /* current invalid time mark index */
+    int aborts;         /* abort status */
+    int nep;            /* number of processed rover epochs */
+    pppass_t pass[2];   /* forward/backward passes */
+    char proc_rov [64]; /* rover for current processing */
+    char proc_base[64]; /* base station for current processing */
+    char rtcm_file[1024]; /* rtcm data file */
+    char rtcm_path[1024]; /* rtcm data path */
+    gtime_t invalidtm[MAXINVALIDTM]; /* invalid time marks */
+    rtcm_t rtcm;        /* rtcm control struct */
+    FILE *fp_rtcm;      /* rtcm data file pointer */
+    rtklib_lock_t lock; /* lock flag */
+} postpos_t;
+
 typedef struct {        /* GIS data point type */
     double pos[3];      /* point data {lat,lon,height} (rad,m) */
 } gis_pnt_t;
@@ -1614,6 +1785,8 @@ EXPORT void add_fatal(fatalfunc_t *func);
 /* time and string functions -------------------------------------------------*/
 EXPORT void    setstr(char *dst, const char *src, int n);
 EXPORT double  str2num(const char *s, int i, int n);
+EXPORT double  str2fix(const char *s, int i, int n);
+EXPORT int     fix2str(char *s, size_t size, double value, int n);
 EXPORT int     str2time(const char *s, size_t i, size_t n, gtime_t *t);
 EXPORT char    *time2str(gtime_t t, char str[40], int n);
 EXPORT gtime_t epoch2time(const double *ep);
@@ -1669,8 +1842,17 @@ EXPORT int read_leaps(const char *file);
 
 EXPORT int adjgpsweek(int week);
 EXPORT uint32_t tickget(void);
+EXPORT uint64_t tickgetus(void);
 EXPORT void sleepms(int ms);
 
+EXPORT int  ringinit (ring_t *ring, int size, int esize);
+EXPORT void ringfree (ring_t *ring);
+EXPORT int  ringpush (ring_t *ring, const void *data);
+EXPORT int  ringpop  (ring_t *ring, void *data);
+EXPORT int  ringwrite(ring_t *ring, const void *data, int n);
+EXPORT int  ringread (ring_t *ring, void *data, int nmax);
+EXPORT int  ringcount(const ring_t *ring);
+
 EXPORT int reppath(const char *path, char *rpath, gtime_t time, const char *rov,
                    const char *base);
 EXPORT int reppaths(const char *path, char *rpaths[], int nmax, gtime_t ts,
@@ -1692,6 +1874,7 @@ EXPORT double dms2deg(const double *dms);
 EXPORT void readpos(const char *file, const char *rcv, double *pos);
 EXPORT int  sortobs(obs_t *obs);
 EXPORT void uniqnav(nav_t *nav);
+EXPORT void indexnav(nav_t *nav, int opt);
 EXPORT int  screent(gtime_t time, gtime_t ts, gtime_t te, double tint);
 EXPORT int  readnav(const char *file, nav_t *nav);
 EXPORT int  savenav(const char *file, const nav_t *nav);
@@ -1826,6 +2009,7 @@ EXPORT int readrnxt(const char *file, int rcv, gtime_t ts, gtime_t te,
                     double tint, const char *opt, obs_t *obs, nav_t *nav,
                     sta_t *sta);
 EXPORT int readrnxc(const char *file, nav_t *nav);
+EXPORT void setrnxthread(int nthread, long chunk);
 EXPORT int outrnxobsh(FILE *fp, const rnxopt_t *opt, const nav_t *nav);
 EXPORT int outrnxobsb(FILE *fp, const rnxopt_t *opt, const obsd_t *obs, int n,
                       int epflag);
@@ -1840,7 +2024,14 @@ EXPORT int outrnxnavb (FILE *fp, const rnxopt_t *opt, const eph_t *eph);
 EXPORT int outrnxgnavb(FILE *fp, const rnxopt_t *opt, const geph_t *geph);
 EXPORT int outrnxhnavb(FILE *fp, const rnxopt_t *opt, const seph_t *seph);
 EXPORT int rnxcomment(rnxopt_t *opt, const char *format, ...);
+EXPORT int  init_crxenc(crxenc_t *crx, FILE *fp, int rnxver);
+EXPORT void free_crxenc(crxenc_t *crx);
+EXPORT int  outcrxh(crxenc_t *crx);
+EXPORT int  outcrxb(crxenc_t *crx);
 EXPORT int rtk_uncompress(const char *file, char *uncfile);
+EXPORT int rtk_uncompbuf(const char *file, uint8_t **buff, size_t *size);
+EXPORT FILE *rtk_fmemopen(const uint8_t *buff, size_t size);
+EXPORT int  rtk_gzip(const char *file, const char *gzfile);
 EXPORT int convrnx(int format, rnxopt_t *opt, const char *file, char **ofile);
 EXPORT int  init_rnxctr (rnxctr_t *rnx);
 EXPORT void free_rnxctr (rnxctr_t *rnx);
@@ -1855,12 +2046,26 @@ EXPORT double geph2clk(gtime_t time, const geph_t *geph);
 EXPORT double seph2clk(gtime_t time, const seph_t *seph);
 EXPORT void eph2pos (gtime_t time, const eph_t  *eph,  double *rs, double *dts,
                      double *var);
+EXPORT void eph2ephc(const eph_t *eph, ephc_t *ephc);
+EXPORT void ephc2pos(gtime_t time, const ephc_t *ephc, double *rs, double *dts,
+                     double *var);
+EXPORT void ephc2poss(const gtime_t *time, const ephc_t **ephc, int n,
+                      double *rs, double *dts, double *var);
+EXPORT void geph2gephc(const geph_t *geph, int herm, gephc_t *gephc);
+EXPORT void gephc2pos(gtime_t time, const gephc_t *gephc, double *rs,
+                      double *dts, double *var);
+EXPORT void evalnav (nav_t *nav, int gloorb);
 EXPORT void geph2pos(gtime_t time, const geph_t *geph, double *rs, double *dts,
                      double *var);
 EXPORT void seph2pos(gtime_t time, const seph_t *seph, double *rs, double *dts,
                      double *var);
 EXPORT int  peph2pos(gtime_t time, int sat, const nav_t *nav, int opt,
                      double *rs, double *dts, double *var);
+EXPORT int  fitpeph (nav_t *nav);
+EXPORT void freepephc(nav_t *nav);
+EXPORT int  packpeph(nav_t *nav, int opt);
+EXPORT void freepephp(nav_t *nav, int opt);
+EXPORT size_t pephmem(const nav_t *nav, size_t *mrec);
 EXPORT int pephatt(gtime_t time, int sat, const nav_t *nav, double *ex, double *ey, double *ez);
 EXPORT int pephpos_avail(gtime_t time, const nav_t *nav, int avail[MAXSAT]);
 EXPORT int pephclk_avail(gtime_t time, const nav_t *nav, int avail[MAXSAT]);
@@ -1893,6 +2098,11 @@ EXPORT uint32_t getbitu(const uint8_t *buff, unsigned pos, unsigned len);
 EXPORT int32_t getbits(const uint8_t *buff, unsigned pos, unsigned len);
 EXPORT void setbitu(uint8_t *buff, unsigned pos, unsigned len, uint32_t data);
 EXPORT void setbits(uint8_t *buff, unsigned pos, unsigned len, int32_t data);
+EXPORT void initbitrd(bitrd_t *b, const uint8_t *buff, unsigned nbyte,
+                      unsigned pos);
+EXPORT uint32_t rdbitu(bitrd_t *b, unsigned len);
+EXPORT int32_t rdbits(bitrd_t *b, unsigned len);
+EXPORT int bitrdpos(const bitrd_t *b);
 EXPORT uint32_t rtk_crc32(const uint8_t *buff, unsigned len);
 EXPORT uint32_t rtk_crc24q(const uint8_t *buff, unsigned len);
 EXPORT uint16_t rtk_crc16(const uint8_t *buff, unsigned len);
@@ -1914,6 +2124,8 @@ EXPORT int decode_irn_nav(const uint8_t *buff, eph_t *eph, double *ion,
 EXPORT int init_raw   (raw_t *raw, int format);
 EXPORT void free_raw  (raw_t *raw);
 EXPORT int input_raw  (raw_t *raw, int format, uint8_t data);
+EXPORT int input_raw_buf(raw_t *raw, int format, const uint8_t *data, int len,
+                         int *consumed);
 EXPORT int input_rawf (raw_t *raw, int format, FILE *fp);
 
 EXPORT int init_rt17  (raw_t *raw);
@@ -1961,6 +2173,8 @@ EXPORT int init_rtcm   (rtcm_t *rtcm);
 EXPORT void free_rtcm  (rtcm_t *rtcm);
 EXPORT int input_rtcm2 (rtcm_t *rtcm, uint8_t data);
 EXPORT int input_rtcm3 (rtcm_t *rtcm, uint8_t data);
+EXPORT int input_rtcm3_buf(rtcm_t *rtcm, const uint8_t *data, int len,
+                          int *consumed);
 EXPORT int input_rtcm2f(rtcm_t *rtcm, FILE *fp);
 EXPORT int input_rtcm3f(rtcm_t *rtcm, FILE *fp);
 EXPORT int gen_rtcm2   (rtcm_t *rtcm, int type, int sync);
@@ -2052,6 +2266,7 @@ EXPORT int  stropen  (stream_t *stream, int type, int mode, const char *path);
 EXPORT void strclose (stream_t *stream);
 EXPORT int  strread  (stream_t *stream, uint8_t *buff, int n);
 EXPORT int  strwrite (stream_t *stream, uint8_t *buff, int n);
+EXPORT int  strwait  (stream_t *stream, int n, int timeout);
 EXPORT void strsync  (stream_t *stream1, stream_t *stream2);
 EXPORT int  strstat  (stream_t *stream, char *msg);
 EXPORT int  strstatx (stream_t *stream, char *msg);
@@ -2083,10 +2298,13 @@ EXPORT int  rtkpos (rtk_t *rtk, const obsd_t *obs, int nobs, const nav_t *nav);
 EXPORT int  rtkopenstat(const char *file, int level);
 EXPORT void rtkclosestat(void);
 EXPORT int  rtkoutstat(rtk_t *rtk, int level, char *buff);
+EXPORT int  rtkxalloc(rtk_t *rtk, int k);
+EXPORT void rtkxfree (rtk_t *rtk, int k);
 
 /* precise point positioning -------------------------------------------------*/
 EXPORT void pppos(rtk_t *rtk, const obsd_t *obs, int n, const nav_t *nav);
 EXPORT int pppnx(const prcopt_t *opt);
+EXPORT int pppxinit(const prcopt_t *opt, int k);
 EXPORT int pppoutstat(rtk_t *rtk, char *buff, int level);
 
 EXPORT int ppp_ar(rtk_t *rtk, const obsd_t *obs, int n, int *exc,
@@ -2097,13 +2315,28 @@ EXPORT int postpos(gtime_t ts, gtime_t te, double ti, double tu,
                    const prcopt_t *popt, const solopt_t *sopt,
                    const filopt_t *fopt, const char **infile, int n, const char *outfile,
                    const char *rov, const char *base);
+EXPORT postpos_t *postposnew(const ppprod_t *prod);
+EXPORT void postposfree(postpos_t *pp);
+EXPORT int  postposc(postpos_t *pp, gtime_t ts, gtime_t te, double ti, double tu,
+                     const prcopt_t *popt, const solopt_t *sopt,
+                     const filopt_t *fopt, const char **infile, int n,
+                     const char *outfile, const char *rov, const char *base);
+EXPORT int  ppprodread(ppprod_t *prod, const prcopt_t *popt, const filopt_t *fopt,
+                       const char **infile, int n);
+EXPORT void ppprodfree(ppprod_t *prod);
 EXPORT int getstapos(const char *file, const char *name, double *r);
+EXPORT int  readobscache (const char *file, uint64_t key, obs_t *obs, nav_t *nav,
+                          sta_t *sta, int nsta, int *nepoch);
+EXPORT int  writeobscache(const char *file, uint64_t key, const obs_t *obs,
+                          const nav_t *nav, const sta_t *sta, int nsta,
+                          int nepoch);
 
 /* stream server functions ---------------------------------------------------*/
 EXPORT void strsvrinit (strsvr_t *svr, int nout);
 EXPORT int  strsvrstart(strsvr_t *svr, int *opts, int *strs, const char **paths,
                         const char **logs, strconv_t **conv, const char **cmds,
                         const char **cmds_periodic, const double *nmeapos);
+EXPORT void strsvrsetcliq(strsvr_t *svr, int qlen, int qpol);
 EXPORT void strsvrstop (strsvr_t *svr, const char **cmds);
 EXPORT void strsvrstat (strsvr_t *svr, int *stat, int *log_stat, int *byte,
                         int *bps, char *msg);
@@ -2125,10 +2358,15 @@ EXPORT int  rtksvropenstr(rtksvr_t *svr, int index, int str, const char *path,
 EXPORT void rtksvrclosestr(rtksvr_t *svr, int index);
 EXPORT void rtksvrlock  (rtksvr_t *svr);
 EXPORT void rtksvrunlock(rtksvr_t *svr);
+EXPORT void rtksvrlockin  (rtksvr_t *svr, int index);
+EXPORT void rtksvrunlockin(rtksvr_t *svr, int index);
 EXPORT int  rtksvrostat (rtksvr_t *svr, int type, gtime_t *time, int sat[MAXSAT],
                          double *az, double *el, double snr[MAXSAT][NFREQ], int vsat[MAXSAT][NFREQ]);
 EXPORT void rtksvrsstat (rtksvr_t *svr, int *sstat, char *msg);
+EXPORT int  rtksvrlatency(rtksvr_t *svr, double *p50, double *p99);
+EXPORT void rtksvrqstat(rtksvr_t *svr, int *nq, int *npeak, uint32_t *nfull);
 EXPORT int  rtksvrmark(rtksvr_t *svr, const char *name, const char *comment);
+EXPORT int  rtksvrpeek(rtksvr_t *svr, int index, uint8_t *buff, int nmax);
 
 /* downloader functions ------------------------------------------------------*/
 EXPORT int dl_readurls(const char *file, const char **types, int ntype, url_t *urls,
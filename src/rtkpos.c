@@ -94,11 +94,17 @@
 #define NR(opt)     (NP(opt)+NI(opt)+NT(opt)+NL(opt))
 #define NX(opt)     (NR(opt)+NB(opt))
 
-/* state variable index */
-#define II(s,opt)   (NP(opt)+(s)-1)                 /* ionos (s:satellite no) */
-#define IT(r,opt)   (NP(opt)+NI(opt)+NT(opt)/2*(r)) /* tropos (r:0=rov,1:ref) */
-#define IL(f,opt)   (NP(opt)+NI(opt)+NT(opt)+(f))   // GLONASS receiver h/w bias for L1 and L2 only.
-#define IB(s,f,opt) (NR(opt)+MAXSAT*(f)+(s)-1) /* phase bias (s:satno,f:freq) */
+/* state key */
+#define KI(s,opt)   (NP(opt)+(s)-1)                 /* ionos (s:satellite no) */
+#define KT(r,opt)   (NP(opt)+NI(opt)+NT(opt)/2*(r)) /* tropos (r:0=rov,1:ref) */
+#define KL(f,opt)   (NP(opt)+NI(opt)+NT(opt)+(f))   // GLONASS receiver h/w bias for L1 and L2 only.
+#define KB(s,f,opt) (NR(opt)+MAXSAT*(f)+(s)-1) /* phase bias (s:satno,f:freq) */
+
+/* state variable index (-1: state not allocated) */
+#define II(s,rtk)   ((rtk)->kx[KI(s,&(rtk)->opt)])
+#define IT(r,rtk)   ((rtk)->kx[KT(r,&(rtk)->opt)])
+#define IL(f,rtk)   ((rtk)->kx[KL(f,&(rtk)->opt)])
+#define IB(s,f,rtk) ((rtk)->kx[KB(s,f,&(rtk)->opt)])
 
 /* poly coeffs used to adjust AR ratio by # of sats, derived by fitting to  example from:
    https://www.tudelft.nl/citg/over-faculteit/afdelingen/geoscience-remote-sensing/research/lambda/lambda */
@@ -296,8 +302,8 @@ int rtkoutstat(rtk_t *rtk, int level, char *buff)
                 ssat=rtk->ssat+i;
                 if (!ssat->vs) continue;
                 satno2id(i+1,id);
-                int j=II(i+1,&rtk->opt);
-                xa[0]=j<rtk->na?rtk->xa[j]:0.0;
+                int j=II(i+1,rtk);
+                xa[0]=j>=0&&j<rtk->na?rtk->xa[j]:0.0;
                 double az = ssat->azel[0][0] * R2D, el = ssat->azel[0][1]*R2D;
                 if (rtk->opt.mode >= PMODE_DGPS) {
                   // Use the average azimuth and minimum elevation for now.
@@ -305,13 +311,13 @@ int rtkoutstat(rtk_t *rtk, int level, char *buff)
                   el = MIN(el, ssat->azel[1][1] * R2D);
                 }
                 p+=sprintf(p,"$ION,%d,%.3f,%d,%s,%.1f,%.1f,%.4f,%.4f\n",week,tow,
-                           rtk->sol.stat,id,az,el,rtk->x[j],xa[0]);
+                           rtk->sol.stat,id,az,el,j>=0?rtk->x[j]:0.0,xa[0]);
             }
         }
         /* Tropospheric parameters */
         if (est&&(rtk->opt.tropopt>=TROPOPT_EST)) {
             for (int i=0;i<2;i++) {
-                int j=IT(i,&rtk->opt);
+                int j=IT(i,rtk);
                 xa[0]=j<rtk->na?rtk->xa[j]:0.0;
                 p+=sprintf(p,"$TROP,%d,%.3f,%d,%d,%.4f,%.4f\n",week,tow,
                            rtk->sol.stat,i+1,rtk->x[j],xa[0]);
@@ -320,7 +326,7 @@ int rtkoutstat(rtk_t *rtk, int level, char *buff)
         /* Receiver h/w bias */
         if (est&&rtk->opt.glomodear==GLO_ARMODE_AUTOCAL) {
             for (int i=0;i<NFREQGLO;i++) {
-                int j=IL(i,&rtk->opt);
+                int j=IL(i,rtk);
                 xa[0]=j<rtk->na?rtk->xa[j]:0.0;
                 p+=sprintf(p,"$HWBIAS,%d,%.3f,%d,%d,%.4f,%.4f\n",week,tow,
                            rtk->sol.stat,i+1,rtk->x[j],xa[0]);
@@ -334,7 +340,7 @@ int rtkoutstat(rtk_t *rtk, int level, char *buff)
             if (!ssat->vs) continue;
             satno2id(i+1,id);
             for (int j=0;j<nfreq;j++) {
-                int k=IB(i+1,j,&rtk->opt);
+                int k=NB(&rtk->opt)>0?IB(i+1,j,rtk):-1;
                 double az = ssat->azel[0][0] * R2D, el = ssat->azel[0][1]*R2D;
                 if (rtk->opt.mode >= PMODE_DGPS && rtk->opt.mode < PMODE_PPP_KINEMA) {
                   // Use the average azimuth and minimum elevation for now.
@@ -345,8 +351,8 @@ int rtkoutstat(rtk_t *rtk, int level, char *buff)
                            week,tow,id,j+1,az,el,
                            ssat->resp[j],ssat->resc[j],ssat->vsat[j],ssat->snr_rover[j],
                            ssat->fix[j],ssat->slip[j]&(LLI_SLIP|LLI_HALFC),ssat->lock[j],ssat->outc[j],
-                           ssat->slipc[j],ssat->rejc[j],k<rtk->nx?rtk->x[k]:0,
-                           k<rtk->nx?rtk->P[k+k*rtk->nx]:0,ssat->icbias[j]);
+                           ssat->slipc[j],ssat->rejc[j],k>=0?rtk->x[k]:0,
+                           k>=0?rtk->P[k+k*rtk->nx]:0,ssat->icbias[j]);
             }
         }
     }
@@ -575,6 +581,16 @@ static inline void initx(rtk_t *rtk, double xi, double var, int i)
     for (j=0;j<rtk->nx;j++) rtk->P[j+i*rtk->nx]=0.0;
     rtk->P[i+i*rtk->nx]=var;
 }
+/* initialize state by key allocating it if required -------------------------*/
+static void initxk(rtk_t *rtk, double xi, double var, int k)
+{
+    initx(rtk,xi,var,rtkxalloc(rtk,k));
+}
+/* float state value, zero if not allocated ----------------------------------*/
+static inline double xval(const rtk_t *rtk, int i)
+{
+    return i<0?0.0:rtk->x[i];
+}
 /* select common satellites between rover and reference station --------------*/
 static int selsat(const obsd_t *obs, const double *azel, int nu, int nr,
                   const prcopt_t *opt, int *sat, int *iu, int *ir)
@@ -690,17 +706,17 @@ static void udion(rtk_t *rtk, double tt, double bl, const int *sat, int ns)
 
     /* reset ionospheric delays for sats with long outages */
     for (int i=1;i<=MAXSAT;i++) {
-        int j=II(i,&rtk->opt);
-        if (rtk->x[j]!=0.0&&
+        int j=II(i,rtk);
+        if (j>=0&&rtk->x[j]!=0.0&&
             rtk->ssat[i-1].outc[0]>GAP_RESION&&rtk->ssat[i-1].outc[1]>GAP_RESION)
-            rtk->x[j]=0.0;
+            rtkxfree(rtk,KI(i,&rtk->opt));
     }
     for (int i=0;i<ns;i++) {
-        int j=II(sat[i],&rtk->opt);
+        int j=II(sat[i],rtk);
 
-        if (rtk->x[j]==0.0) {
+        if (j<0||rtk->x[j]==0.0) {
             /* initialize ionospheric delay state */
-            initx(rtk,1E-6,SQR(rtk->opt.std[1]*bl/1E4),j);
+            initxk(rtk,1E-6,SQR(rtk->opt.std[1]*bl/1E4),KI(sat[i],&rtk->opt));
         }
         else {
           // Elevation dependent factor of process noise, rover and base.
@@ -720,7 +736,7 @@ static void udtrop(rtk_t *rtk, double tt, double bl)
     trace(3,"udtrop  : tt=%.3f\n",tt);
 
     for (i=0;i<2;i++) {
-        j=IT(i,&rtk->opt);
+        j=IT(i,rtk);
 
         if (rtk->x[j]==0.0) {
             initx(rtk,INIT_ZWD,SQR(rtk->opt.std[2]),j); /* initial zwd */
@@ -748,7 +764,7 @@ static void udrcvbias(rtk_t *rtk, double tt)
     trace(3,"udrcvbias: tt=%.3f\n",tt);
 
     for (i=0;i<NFREQGLO;i++) {
-        j=IL(i,&rtk->opt);
+        j=IL(i,rtk);
 
         if (rtk->x[j]==0.0) {
             /* add small offset to avoid initializing with zero */
@@ -993,24 +1009,29 @@ static void udbias(rtk_t *rtk, double tt, const obsd_t *obs, const int *sat,
 
             int reset=++rtk->ssat[i-1].outc[k]>(uint32_t)rtk->opt.maxout;
 
-            if (rtk->opt.modear==ARMODE_INST&&rtk->x[IB(i,k,&rtk->opt)]!=0.0) {
-                initx(rtk,0.0,0.0,IB(i,k,&rtk->opt));
+            int j=IB(i,k,rtk);
+            if (rtk->opt.modear==ARMODE_INST&&j>=0&&rtk->x[j]!=0.0) {
+                rtkxfree(rtk,KB(i,k,&rtk->opt));
             }
-            else if (reset&&rtk->x[IB(i,k,&rtk->opt)]!=0.0) {
-                initx(rtk,0.0,0.0,IB(i,k,&rtk->opt));
+            else if (reset&&j>=0&&rtk->x[j]!=0.0) {
+                rtkxfree(rtk,KB(i,k,&rtk->opt));
                 trace(3,"udbias : obs outage counter overflow (sat=%3d L%d n=%d)\n",
                       i,k+1,rtk->ssat[i-1].outc[k]);
                 rtk->ssat[i-1].outc[k]=0;
             }
+            else if (reset&&j>=0) {
+                /* Release a phase-bias left without an estimate by a slip */
+                rtkxfree(rtk,KB(i,k,&rtk->opt));
+            }
             if (rtk->opt.modear!=ARMODE_INST&&reset) {
                 rtk->ssat[i-1].lock[k]=-rtk->opt.minlock;
             }
         }
         /* Update phase bias noise and check for cycle slips */
         for (int i=0;i<ns;i++) {
-            int j=IB(sat[i],k,&rtk->opt);
+            int j=IB(sat[i],k,rtk);
             // Don't update if not used.
-            if (rtk->x[j] == 0.0) continue;
+            if (j<0||rtk->x[j] == 0.0) continue;
             rtk->P[j+j*rtk->nx]+=rtk->opt.prn[0]*rtk->opt.prn[0]*fabs(tt);
             int slip=rtk->ssat[sat[i]-1].slip[k];
             int rejc=rtk->ssat[sat[i]-1].rejc[k];
@@ -1063,8 +1084,9 @@ static void udbias(rtk_t *rtk, double tt, const obsd_t *obs, const int *sat,
                 /* Estimate bias in meters */
                 bias[i]=(C1*cp1*CLIGHT/freq1+C2*cp2*CLIGHT/freq2)-(C1*pr1+C2*pr2);
             }
-            if (rtk->x[IB(sat[i],k,&rtk->opt)]!=0.0) {
-                offset+=bias[i]-rtk->x[IB(sat[i],k,&rtk->opt)];
+            int jb=IB(sat[i],k,rtk);
+            if (jb>=0&&rtk->x[jb]!=0.0) {
+                offset+=bias[i]-rtk->x[jb];
                 j++;
             }
         }
@@ -1073,7 +1095,8 @@ static void udbias(rtk_t *rtk, double tt, const obsd_t *obs, const int *sat,
             for (int i=1;i<=MAXSAT;i++) {
                 int sys = rtk->ssat[i - 1].sys;
                 if (!test_sys(sys, m)) continue;
-                if (rtk->x[IB(i,k,&rtk->opt)]!=0.0) rtk->x[IB(i,k,&rtk->opt)]+=offset/j;
+                int jb=IB(i,k,rtk);
+                if (jb>=0&&rtk->x[jb]!=0.0) rtk->x[jb]+=offset/j;
             }
         }
 
@@ -1081,8 +1104,9 @@ static void udbias(rtk_t *rtk, double tt, const obsd_t *obs, const int *sat,
         for (int i=0;i<ns;i++) {
             int sys = rtk->ssat[sat[i] - 1].sys;
             if (!test_sys(sys, m)) continue;
-            if (bias[i]==0.0||rtk->x[IB(sat[i],k,&rtk->opt)]!=0.0) continue;
-            initx(rtk,bias[i],SQR(rtk->opt.std[0]),IB(sat[i],k,&rtk->opt));
+            int jb=IB(sat[i],k,rtk);
+            if (bias[i]==0.0||(jb>=0&&rtk->x[jb]!=0.0)) continue;
+            initxk(rtk,bias[i],SQR(rtk->opt.std[0]),KB(sat[i],k,&rtk->opt));
             trace(3,"     m=%d sys=%d sat=%3d, F=%d: init phase=%.3f\n",m,sys,sat[i],k+1,bias[i]);
             if (rtk->opt.modear!=ARMODE_INST) {
                 rtk->ssat[sat[i]-1].lock[k]=-rtk->opt.minlock;
@@ -1400,12 +1424,11 @@ static int constbl(rtk_t *rtk, const double *x, const double *P,
     return 1;
 }
 /* precise tropospheric model -------------------------------------------------*/
-static double prectrop(gtime_t time, const double *pos, int r,
+static double prectrop(gtime_t time, const double *pos, int i,
                        const double *azel, const prcopt_t *opt, const double *x,
                        double *dtdx)
 {
     double m_w=0.0,cotz,grad_n,grad_e;
-    int i=IT(r,opt);
 
     /* wet mapping function */
     tropmapf(time,pos,azel,&m_w);
@@ -1475,8 +1498,8 @@ static int ddres(rtk_t *rtk, const obsd_t *obs, double dt, const double *x,
                    ionmapf(posr,azel+ir[i]*2,ME_WGS84/1000,HION,1))/2.0;
         }
         if (opt->tropopt>=TROPOPT_EST) {
-            tropu[i]=prectrop(rtk->sol.time,posu,0,azel+iu[i]*2,opt,x,dtdxu+i*3);
-            tropr[i]=prectrop(rtk->sol.time,posr,1,azel+ir[i]*2,opt,x,dtdxr+i*3);
+            tropu[i]=prectrop(rtk->sol.time,posu,IT(0,rtk),azel+iu[i]*2,opt,x,dtdxu+i*3);
+            tropr[i]=prectrop(rtk->sol.time,posr,IT(1,rtk),azel+ir[i]*2,opt,x,dtdxr+i*3);
         }
     }
     // Step through sat systems: m=0:gps/sbs,1:glo,2:gal,3:bds2,4:bds3,5:qzs,6:irn
@@ -1531,10 +1554,10 @@ static int ddres(rtk_t *rtk, const obsd_t *obs, double dt, const double *x,
                     /* Adjust double-differenced measurements by double-differenced ionospheric delay term */
                     didxi=(code?-1.0:1.0)*im[i]*SQR(FREQL1/freqi);
                     didxj=(code?-1.0:1.0)*im[j]*SQR(FREQL1/freqj);
-                    v[nv]-=didxi*x[II(sat[i],opt)]-didxj*x[II(sat[j],opt)];
+                    v[nv]-=didxi*x[II(sat[i],rtk)]-didxj*x[II(sat[j],rtk)];
                     if (Hc) {
-                        cvwrite(Hi,nc,xi,II(sat[i],opt), didxi);
-                        cvwrite(Hi,nc,xi,II(sat[j],opt),-didxi);
+                        cvwrite(Hi,nc,xi,II(sat[i],rtk), didxi);
+                        cvwrite(Hi,nc,xi,II(sat[j],rtk),-didxi);
                     }
                 }
                 if (opt->tropopt>=TROPOPT_EST) {
@@ -1542,13 +1565,13 @@ static int ddres(rtk_t *rtk, const obsd_t *obs, double dt, const double *x,
                     v[nv]-=(tropu[i]-tropu[j])-(tropr[i]-tropr[j]);
                     if (!Hc) continue;
                     for (int k=0;k<(opt->tropopt<TROPOPT_ESTG?1:3);k++) {
-                        cvwrite(Hi,nc,xi,IT(0,opt)+k, (dtdxu[k+i*3]-dtdxu[k+j*3]));
-                        cvwrite(Hi,nc,xi,IT(1,opt)+k,-(dtdxr[k+i*3]-dtdxr[k+j*3]));
+                        cvwrite(Hi,nc,xi,IT(0,rtk)+k, (dtdxu[k+i*3]-dtdxu[k+j*3]));
+                        cvwrite(Hi,nc,xi,IT(1,rtk)+k,-(dtdxr[k+i*3]-dtdxr[k+j*3]));
                     }
                 }
                 if (opt->mode > PMODE_DGPS && !code) {
-                    int ii = IB(sat[i], frq, opt);
-                    int jj = IB(sat[j], frq, opt);
+                    int ii = IB(sat[i], frq, rtk);
+                    int jj = IB(sat[j], frq, rtk);
                     /* Adjust phase residual by double-differenced phase-bias term,
                           IB=look up index by sat&freq */
                     if (opt->ionoopt!=IONOOPT_IFLC) {
@@ -1575,12 +1598,12 @@ static int ddres(rtk_t *rtk, const obsd_t *obs, double dt, const double *x,
                         const char *cobs = code2obs(obs[iu[i]].code[frq]);
                         if (cobs[0] == '1' && NFREQGLO >= 1) {
                           double df = (freqi - freqj) / DFRQ1_GLO;
-                          v[nv] -= df * x[IL(0, opt)];
-                          if (Hc) cvwrite(Hi, nc, xi, IL(0, opt), df);
+                          v[nv] -= df * x[IL(0, rtk)];
+                          if (Hc) cvwrite(Hi, nc, xi, IL(0, rtk), df);
                         } else if (cobs[0] == '2' && NFREQGLO >= 2) {
                           double df = (freqi - freqj) / DFRQ2_GLO;
-                          v[nv] -= df * x[IL(1, opt)];
-                          if (Hc) cvwrite(Hi, nc, xi, IL(1, opt), df);
+                          v[nv] -= df * x[IL(1, rtk)];
+                          if (Hc) cvwrite(Hi, nc, xi, IL(1, rtk), df);
                         }
                     }
                     else if (rtk->opt.glomodear==GLO_ARMODE_FIXHOLD && frq<NFREQGLO) {
@@ -1610,8 +1633,8 @@ static int ddres(rtk_t *rtk, const obsd_t *obs, double dt, const double *x,
                 double threshadj = 1;
                 if (opt->mode > PMODE_DGPS) {
                   // Open up outlier threshold if one of the phase biases was just initialized.
-                  int ii = IB(sat[i], frq, opt);
-                  int jj = IB(sat[j], frq, opt);
+                  int ii = IB(sat[i], frq, rtk);
+                  int jj = IB(sat[j], frq, rtk);
                   if (cmatread(P, rtk->nx, Pc, nc, xi, ii, ii) == SQR(rtk->opt.std[0]) ||
                       cmatread(P, rtk->nx, Pc, nc, xi, jj, jj) == SQR(rtk->opt.std[0]))
                     threshadj = 10;
@@ -1652,8 +1675,8 @@ static int ddres(rtk_t *rtk, const obsd_t *obs, double dt, const double *x,
                 double icb = 0.0;
                 if (rtk->opt.glomodear==GLO_ARMODE_AUTOCAL) {
                     const char *cobs = code2obs(obs[iu[i]].code[frq]);
-                    if (cobs[0] == '1' && NFREQGLO >= 1) icb = x[IL(0, opt)];
-                    else if (cobs[0] == '2' && NFREQGLO >= 2) icb = x[IL(1, opt)];
+                    if (cobs[0] == '1' && NFREQGLO >= 1) icb = x[IL(0, rtk)];
+                    else if (cobs[0] == '2' && NFREQGLO >= 2) icb = x[IL(1, rtk)];
                 }
                 else {
                     icb=rtk->ssat[sat[i]-1].icbias[frq]*CLIGHT/freqi -
@@ -1661,7 +1684,7 @@ static int ddres(rtk_t *rtk, const obsd_t *obs, double dt, const double *x,
                 }
                 double xjj = 0.0, Pjj = 0.0;
                 if (opt->mode>PMODE_DGPS) {
-                    int jj = IB(sat[j], frq, &rtk->opt);
+                    int jj = IB(sat[j], frq, rtk);
                     xjj = x[jj];
                     Pjj = cmatread(P,rtk->nx,Pc,nc,xi,jj,jj);
                 }
@@ -1778,7 +1801,7 @@ static int ddidx(rtk_t *rtk, int *ix, int gps, int glo, int sbs) {
       int sat1;
       for (sat1 = 0; sat1 < MAXSAT; sat1++) {
         /* Skip if sat not active */
-        if (rtk->x[IB(sat1 + 1, f, &rtk->opt)] == 0.0 || !test_sys(rtk->ssat[sat1].sys, m) ||
+        if (xval(rtk, IB(sat1 + 1, f, rtk)) == 0.0 || !test_sys(rtk->ssat[sat1].sys, m) ||
             !rtk->ssat[sat1].vsat[f]) {
           continue;
         }
@@ -1797,7 +1820,7 @@ static int ddidx(rtk_t *rtk, int *ix, int gps, int glo, int sbs) {
       if (sat1 >= MAXSAT || rtk->ssat[sat1].fix[f] != 2) continue; /* No good sat found */
       int n = 0;
       for (int sat2 = sat1 + 1; sat2 < MAXSAT; sat2++) {
-        if (rtk->x[IB(sat2 + 1, f, &rtk->opt)] == 0.0 ||
+        if (xval(rtk, IB(sat2 + 1, f, rtk)) == 0.0 ||
             !test_sys(rtk->ssat[sat2].sys, m) || !rtk->ssat[sat2].vsat[f]) {
           continue;
         }
@@ -1808,8 +1831,8 @@ static int ddidx(rtk_t *rtk, int *ix, int gps, int glo, int sbs) {
             rtk->ssat[sat2].azel[1][1] >= rtk->opt.elmaskar &&
             !nofix) {
           /* Set D coeffs to subtract sat2 from sat1 */
-          ix[nb * 2] = IB(sat1 + 1, f, &rtk->opt);     /* State index of ref bias */
-          ix[nb * 2 + 1] = IB(sat2 + 1, f, &rtk->opt); /* State index of target bias */
+          ix[nb * 2] = IB(sat1 + 1, f, rtk);     /* State index of ref bias */
+          ix[nb * 2 + 1] = IB(sat2 + 1, f, rtk); /* State index of target bias */
           ref[nb] = sat1 + 1;
           fix[nb++] = sat2 + 1;
           rtk->ssat[sat2].fix[f] = 2; /* Fix */
@@ -1900,7 +1923,7 @@ static void holdamb(rtk_t *rtk, const double *xa)
                 rtk->ssat[i].azel[1][1] < rtk->opt.elmaskhold) {
                 continue;
             }
-            index[n++]=IB(i+1,f,&rtk->opt);
+            index[n++]=IB(i+1,f,rtk);
             rtk->ssat[i].fix[f]=3; /* hold */
         }
         /* Use ambiguity resolution results to generate a set of pseudo-innovations
@@ -1954,9 +1977,9 @@ static void holdamb(rtk_t *rtk, const double *xa)
                 }
                 else {  /* Adjust the rest */
                     /* Find phase-bias difference */
-                    double dd=rtk->x[IB(j+1,f,&rtk->opt)]-rtk->x[IB(i+1,f,&rtk->opt)];
+                    double dd=rtk->x[IB(j+1,f,rtk)]-rtk->x[IB(i+1,f,rtk)];
                     dd=rtk->opt.gainholdamb*(dd-ROUND(dd));  /* Throwout integer part of answer and multiply by filter gain */
-                    rtk->x[IB(j+1,f,&rtk->opt)]-=dd;  /* Remove fractional part from phase bias */
+                    rtk->x[IB(j+1,f,rtk)]-=dd;  /* Remove fractional part from phase bias */
                     rtk->ssat[j].icbias[f]+=dd;       /* and move to IC bias */
                     index[nv++]=j;
                 }
@@ -1976,9 +1999,9 @@ static void holdamb(rtk_t *rtk, const double *xa)
                 else {  /* Adjust the SBS sats */
                     if (rtk->ssat[j].sys!=SYS_SBS) continue;
                     /* find phase-bias difference */
-                    double dd=rtk->x[IB(j+1,f,&rtk->opt)]-rtk->x[IB(i+1,f,&rtk->opt)];
+                    double dd=rtk->x[IB(j+1,f,rtk)]-rtk->x[IB(i+1,f,rtk)];
                     dd=rtk->opt.gainholdamb*(dd-ROUND(dd));  /* Throwout integer part of answer and multiply by filter gain */
-                    rtk->x[IB(j+1,f,&rtk->opt)]-=dd;  /* Remove fractional part from phase bias diff */
+                    rtk->x[IB(j+1,f,rtk)]-=dd;  /* Remove fractional part from phase bias diff */
                     rtk->ssat[j].icbias[f]+=dd;       /* and move to IC bias */
                     index[nv++]=j;
                 }
@@ -2259,6 +2282,51 @@ static int valpos(rtk_t *rtk, const double *v, const double *R, const int *vflg,
     }
     return stat;
 }
+/* states used by observations -----------------------------------------------
+* allocate the phase-bias states of the signals observed in the epoch and
+* release the idle phase-bias states, those unobserved without an estimate or
+* covariance
+* args   : rtk_t    *rtk    IO  rtk control/result struct
+*          obsd_t   *obs    I   observation data (rover and base)
+*          int      n       I   number of observation data
+*          int      *sat    I   common satellites
+*          int      ns      I   number of common satellites
+* return : flags of the states used by the observations (rtk->nx x 1)
+*-----------------------------------------------------------------------------*/
+static int *usestate(rtk_t *rtk, const obsd_t *obs, int n, const int *sat, int ns)
+{
+    const prcopt_t *opt=&rtk->opt;
+    int nf=NF(opt);
+
+    if (opt->mode>PMODE_DGPS) {
+        for (int i=0;i<n;i++) for (int f=0;f<nf;f++) {
+            if (obs[i].code[f]!=CODE_NONE) rtkxalloc(rtk,KB(obs[i].sat,f,opt));
+        }
+        for (int i=0;i<ns;i++) for (int f=0;f<nf;f++) {
+            rtkxalloc(rtk,KB(sat[i],f,opt));
+        }
+    }
+    int nx=rtk->nx,*used=imat(nx,1);
+    for (int i=0;i<nx;i++) used[i]=0;
+    if (opt->mode>PMODE_DGPS) {
+        for (int i=0;i<n;i++) for (int f=0;f<nf;f++) {
+            if (obs[i].code[f]!=CODE_NONE) used[IB(obs[i].sat,f,rtk)]=1;
+        }
+        for (int i=0;i<ns;i++) for (int f=0;f<nf;f++) used[IB(sat[i],f,rtk)]=1;
+    }
+    /* Release from the end so the lower state indices remain valid */
+    for (int i=nx-1;i>=rtk->na;i--) {
+        if (used[i]||rtk->x[i]!=0.0) continue;
+        const double *P=rtk->P;
+        int j;
+        for (j=0;j<nx;j++) if (P[i+j*nx]!=0.0||P[j+i*nx]!=0.0) break;
+        if (j<nx) continue;
+        rtkxfree(rtk,rtk->xk[i]);
+        for (j=i;j<nx-1;j++) used[j]=used[j+1];
+        nx--;
+    }
+    return used;
+}
 /* relpos() relative positioning ------------------------------------------------------
  *  args:  rtk      IO      gps solution structure
            obs      I       satellite observations
@@ -2361,10 +2429,15 @@ static int relpos(rtk_t *rtk, const obsd_t *obs, int nu, int nr,
     }
 
     /* Update kalman filter states (pos,vel,acc,ionosp, troposp, sat phase biases) */
-    double *x=rtk->x;
-    trace(4,"before udstate: x="); tracemat(4,x,1,NR(opt),13,4);
+    trace(4,"before udstate: x="); tracemat(4,rtk->x,1,rtk->na,13,4);
     udstate(rtk,obs,sat,iu,ir,ns,nav);
-    trace(4,"after udstate x="); tracemat(4,x,1,NR(opt),13,4);
+    trace(4,"after udstate x="); tracemat(4,rtk->x,1,rtk->na,13,4);
+
+    /* Allocate the phase-bias states of the observed signals, releasing idle
+     * states, and flag the states used. No states are allocated or released
+     * after this point so the state indices remain valid for this epoch. */
+    int *used=usestate(rtk,obs,n,sat,ns);
+    double *x=rtk->x;
 
     /* Backup rtk->x to xp, in case of rollback */
     int nx=rtk->nx;
@@ -2383,33 +2456,19 @@ static int relpos(rtk_t *rtk, const obsd_t *obs, int nu, int nr,
     /* Always include the first 3 elements, so the compressed array can still
      * be passed as a vector of the 3 axis. Also always include the other
      * parameters that are enabled as they may be set even if zero now. */
-    for (int i = 0; i < NR(opt); i++) {
+    for (int i = 0; i < rtk->na; i++) {
         xi[i] = nc;
         ix[nc++] = i;
     }
-    // Flag the phase bias indices used.
-    int *ibf = imat(nx, 1);
-    for (int i = 0; i < nx; i++) ibf[i] = 0;
-    if (rtk->opt.mode > PMODE_DGPS) {
-      // All observations
-      for (int i = 0; i < nu + nr; i++) {
-        for (int frq = 0; frq < nf; frq++) {
-          if (obs[i].code[frq] != CODE_NONE) {
-            int j = IB(obs[i].sat, frq, opt);
-            if (j > 0) ibf[j] = 1;
-          }
-        }
-      }
-    }
-    for (int i = NR(opt); i < nx; i++) {
-      if (ibf[i] || (x[i] != 0.0 && P[i + i * nx] > 0.0)) {
+    for (int i = rtk->na; i < nx; i++) {
+      if (used[i] || (x[i] != 0.0 && P[i + i * nx] > 0.0)) {
         xi[i] = nc;
         ix[nc++] = i;
       } else {
         xi[i] = 0xfffffff; /* Invalid value >= nc */
       }
     }
-    free(ibf);
+    free(used);
     /* Compress array by removing zero elements to save computation time */
     double *xc=mat(nc,1),*Pc=mat(nc,nc),*Ppc=mat(nc,nc);
     for (int i=0;i<nc;i++) xc[i]=x[ix[i]];
@@ -2621,11 +2680,118 @@ static int relpos(rtk_t *rtk, const obsd_t *obs, int nu, int nr,
 
     return stat!=SOLQ_NONE;
 }
+/* grow state storage --------------------------------------------------------
+* grow state vector and covariance matrix capacity keeping the n x n contents
+*-----------------------------------------------------------------------------*/
+static void growx(double **x, double **P, int n, int *nmax, int nreq)
+{
+    if (nreq<=*nmax) return;
+    int nmax2=*nmax*2>nreq?*nmax*2:nreq;
+    double *x2=mat(nmax2,1),*P2=mat(nmax2,nmax2);
+    if (n>0) {
+        memcpy(x2,*x,sizeof(double)*n);
+        memcpy(P2,*P,sizeof(double)*n*n);
+    }
+    free(*x); free(*P);
+    *x=x2; *P=P2; *nmax=nmax2;
+}
+/* insert zero state at index p into state vector and covariance (n x n) -----*/
+static void insx(double *x, double *P, int n, int p)
+{
+    int m=n+1;
+
+    /* move from the end as the new element index is never below the old */
+    for (int j=n-1;j>=0;j--) {
+        int jj=j<p?j:j+1;
+        for (int i=n-1;i>=0;i--) P[(i<p?i:i+1)+jj*m]=P[i+j*n];
+    }
+    for (int i=0;i<m;i++) P[p+i*m]=P[i+p*m]=0.0;
+    for (int i=n;i>p;i--) x[i]=x[i-1];
+    x[p]=0.0;
+}
+/* delete state at index p from state vector and covariance (n x n) ----------*/
+static void delx(double *x, double *P, int n, int p)
+{
+    int m=n-1;
+
+    /* move from the start as the new element index is never above the old */
+    for (int j=0;j<n;j++) {
+        if (j==p) continue;
+        int jj=j<p?j:j-1;
+        for (int i=0;i<n;i++) {
+            if (i!=p) P[(i<p?i:i-1)+jj*m]=P[i+j*n];
+        }
+    }
+    for (int i=p;i<m;i++) x[i]=x[i+1];
+}
+/* allocate state --------------------------------------------------------------
+* allocate the float state of a state key if not allocated
+* args   : rtk_t    *rtk    IO  rtk control/result struct
+*          int      k       I   state key (0 to rtk->nk-1)
+* return : state index
+* notes  : states are stored in the order of the state keys, so the allocation
+*          moves the states with higher keys up by one index. the new state
+*          and its covariance are zero. a real-valued state key (k<rtk->nkr)
+*          also allocates the fixed state.
+*-----------------------------------------------------------------------------*/
+int rtkxalloc(rtk_t *rtk, int k)
+{
+    if (rtk->kx[k]>=0) return rtk->kx[k];
+
+    int p=rtk->nx;
+    while (p>0&&rtk->xk[p-1]>k) p--;
+
+    if (rtk->nx>=rtk->nxmax) {
+        growx(&rtk->x,&rtk->P,rtk->nx,&rtk->nxmax,rtk->nx+1);
+        int *xk=imat(rtk->nxmax,1);
+        if (rtk->nx>0) memcpy(xk,rtk->xk,sizeof(int)*rtk->nx);
+        free(rtk->xk); rtk->xk=xk;
+    }
+    insx(rtk->x,rtk->P,rtk->nx,p);
+    for (int i=rtk->nx;i>p;i--) rtk->xk[i]=rtk->xk[i-1];
+    rtk->xk[p]=k;
+    rtk->nx++;
+    for (int i=p;i<rtk->nx;i++) rtk->kx[rtk->xk[i]]=i;
+
+    if (k<rtk->nkr) {
+        growx(&rtk->xa,&rtk->Pa,rtk->na,&rtk->namax,rtk->na+1);
+        insx(rtk->xa,rtk->Pa,rtk->na,p);
+        rtk->na++;
+    }
+    return p;
+}
+/* free state ------------------------------------------------------------------
+* free the float state of a state key
+* args   : rtk_t    *rtk    IO  rtk control/result struct
+*          int      k       I   state key (0 to rtk->nk-1)
+* return : none
+* notes  : the states with higher keys move down by one index
+*-----------------------------------------------------------------------------*/
+void rtkxfree(rtk_t *rtk, int k)
+{
+    int p=rtk->kx[k];
+
+    if (p<0) return;
+
+    delx(rtk->x,rtk->P,rtk->nx,p);
+    for (int i=p;i<rtk->nx-1;i++) rtk->xk[i]=rtk->xk[i+1];
+    rtk->nx--;
+    rtk->kx[k]=-1;
+    for (int i=p;i<rtk->nx;i++) rtk->kx[rtk->xk[i]]=i;
+
+    if (k<rtk->nkr) {
+        delx(rtk->xa,rtk->Pa,rtk->na,p);
+        rtk->na--;
+    }
+}
 /* initialize RTK control ------------------------------------------------------
 * initialize RTK control struct
 * args   : rtk_t    *rtk    IO  TKk control/result struct
 *          prcopt_t *opt    I   positioning options (see rtklib.h)
 * return : none
+* notes  : the ionosphere and phase-bias states are allocated as satellites
+*          are tracked, see rtkxalloc() and pppxinit(). the other states are
+*          allocated here.
 *-----------------------------------------------------------------------------*/
 void rtkinit(rtk_t *rtk, const prcopt_t *opt)
 {
@@ -2638,14 +2804,22 @@ void rtkinit(rtk_t *rtk, const prcopt_t *opt)
 
     rtk->sol=sol0;
     for (i=0;i<6;i++) rtk->rb[i]=0.0;
-    rtk->nx=opt->mode<=PMODE_FIXED?NX(opt):pppnx(opt);
-    rtk->na=opt->mode<=PMODE_FIXED?NR(opt):pppnx(opt);
+    rtk->nk=opt->mode<=PMODE_FIXED?NX(opt):pppnx(opt);
+    rtk->nkr=opt->mode<=PMODE_FIXED?NR(opt):pppnx(opt);
+    rtk->kx=imat(rtk->nk,1);
+    rtk->xk=NULL;
+    rtk->x=rtk->P=rtk->xa=rtk->Pa=NULL;
+    rtk->nx=rtk->na=rtk->nxmax=rtk->namax=0;
+    for (i=0;i<rtk->nk;i++) rtk->kx[i]=-1;
+    for (i=0;i<rtk->nk;i++) {
+        if (opt->mode<=PMODE_FIXED) {
+            if ((i>=KI(1,opt)&&i<KI(1,opt)+NI(opt))||i>=NR(opt)) continue;
+        }
+        else if (!pppxinit(opt,i)) continue;
+        rtkxalloc(rtk,i);
+    }
     rtk->tt=0.0;
     rtk->epoch=0;
-    rtk->x=zeros(rtk->nx,1);
-    rtk->P=zeros(rtk->nx,rtk->nx);
-    rtk->xa=zeros(rtk->na,1);
-    rtk->Pa=zeros(rtk->na,rtk->na);
     rtk->nfix=rtk->neb=0;
     for (i=0;i<MAXSAT;i++) {
         rtk->ambc[i]=ambc0;
@@ -2669,11 +2843,13 @@ void rtkfree(rtk_t *rtk)
 {
     trace(3,"rtkfree :\n");
 
-    rtk->nx=rtk->na=0;
+    rtk->nx=rtk->na=rtk->nk=rtk->nkr=rtk->nxmax=rtk->namax=0;
     free(rtk->x ); rtk->x =NULL;
     free(rtk->P ); rtk->P =NULL;
     free(rtk->xa); rtk->xa=NULL;
     free(rtk->Pa); rtk->Pa=NULL;
+    free(rtk->kx); rtk->kx=NULL;
+    free(rtk->xk); rtk->xk=NULL;
 }
 /* precise positioning ---------------------------------------------------------
 * input observation data and navigation message, compute rover position by
@@ -46,6 +46,120 @@
 #include "rtklib.h"
 
 #define MIN_INT_RESET   30000   /* mininum interval of reset command (ms) */
+#define SVRMSG_SOL      0       /* stage message type: solution */
+#define SVRMSG_MARK     -2      /* stage message type: mark */
+#define MAXMARKMSG      16      /* max number of queued mark messages */
+
+typedef struct {        /* ion/utc parameters type */
+    double utc_gps[8],utc_glo[8],utc_gal[8],utc_qzs[8],utc_cmp[8],utc_irn[9];
+    double utc_sbs[4];
+    double ion_gps[8],ion_gal[4],ion_qzs[8],ion_cmp[8],ion_irn[8];
+} ionutc_t;
+
+typedef struct {        /* ssr correction record type */
+    int sat;            /* satellite number */
+    ssr_t ssr;          /* ssr corrections */
+} ssrrec_t;
+
+typedef struct {        /* rtk server stage message type */
+    int type;           /* type (decoder status or SVRMSG_SOL) */
+    int ephsat,ephset;  /* satellite and set of ephemeris */
+    int staid;          /* station id (0:unknown) */
+    int n;              /* number of payload records */
+    uint64_t tread;     /* tick of reading rover input (us) (0:unknown) */
+    union {
+        eph_t eph;      /* ephemeris */
+        geph_t geph;    /* GLONASS ephemeris */
+        sbsmsg_t sbsmsg; /* SBAS message */
+        ionutc_t ionutc; /* ion/utc parameters */
+        sta_t sta;      /* station parameters */
+        vtec_t vtec;    /* ionosphere VTEC coefficients */
+        struct {
+            sol_t sol;  /* solution */
+            double rb[6]; /* base position/velocity (ecef) (m|m/s) */
+            int nssat;  /* number of satellite status records (0 or MAXSAT) */
+            int nstat[RTKSVRNSOL]; /* length of solution status outputs */
+        } sol;
+        int nmark[RTKSVRNSOL+1]; /* length of mark outputs {sol1,...,moni} */
+    } u;
+} svrmsg_t;         /* followed by payload records */
+
+/* new stage message ---------------------------------------------------------*/
+static svrmsg_t *newmsg(int type, size_t size)
+{
+    svrmsg_t *msg;
+
+    if (!(msg=(svrmsg_t *)calloc(1,sizeof(svrmsg_t)+size))) {
+        trace(1,"newmsg: malloc error type=%d size=%d\n",type,(int)size);
+        return NULL;
+    }
+    msg->type=type;
+    return msg;
+}
+/* push message to stage queue -------------------------------------------------
+* back-pressure: the producer waits while the queue is full and counts the
+* waits, so a slow stage throttles its inputs instead of losing epochs
+*-----------------------------------------------------------------------------*/
+static int quepush(rtksvr_t *svr, int index, svrmsg_t *msg)
+{
+    rtkque_t *que=svr->que+index;
+    int n;
+
+    while (!ringpush(&que->ring,&msg)) {
+        if (!svr->state) {
+            free(msg);
+            return 0;
+        }
+        que->nfull++;
+        sleepms(1);
+    }
+    que->nmsg++;
+    if ((n=ringcount(&que->ring))>que->npeak) que->npeak=n;
+
+    /* wake up consumer stage */
+    rtklib_lock(&svr->qlock);
+    rtklib_signal(svr->qcond+(index<RTKSVRNIN?0:1));
+    rtklib_unlock(&svr->qlock);
+    return 1;
+}
+/* wait message in stage queues ----------------------------------------------*/
+static void quewait(rtksvr_t *svr, int stage, int timeout)
+{
+    int i,i0=stage?RTKSVRNIN:0,i1=stage?RTKSVRNIN:RTKSVRNIN-1;
+
+    if (timeout<=0) return;
+
+    rtklib_lock(&svr->qlock);
+    for (i=i0;i<=i1;i++) {
+        if (ringcount(&svr->que[i].ring)>0) break;
+    }
+    if (i>i1&&stage&&ringcount(&svr->mark)>0) i=i0;
+    if (i>i1&&svr->state) {
+#ifdef WIN32
+        SleepConditionVariableCS(svr->qcond+stage,&svr->qlock,timeout);
+#else
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME,&ts);
+        ts.tv_sec+=timeout/1000;
+        ts.tv_nsec+=(timeout%1000)*1000000L;
+        if (ts.tv_nsec>=1000000000L) {
+            ts.tv_sec++;
+            ts.tv_nsec-=1000000000L;
+        }
+        pthread_cond_timedwait(svr->qcond+stage,&svr->qlock,&ts);
+#endif
+    }
+    rtklib_unlock(&svr->qlock);
+}
+/* free messages in stage queue ----------------------------------------------*/
+static void quefree(ring_t *ring)
+{
+    svrmsg_t *msg;
+
+    if (!ring->buff) return;
+    while (ringpop(ring,&msg)) free(msg);
+    ringfree(ring);
+}
 
 /* write solution header to output stream ------------------------------------*/
 static void writesolhead(stream_t *stream, const solopt_t *solopt, const prcopt_t *prcopt)
@@ -78,115 +192,150 @@ static void writesolhead(stream_t *stream, const solopt_t *solopt, const prcopt_
   int n = outsolheads(buff, solopt);
   strwrite(stream,buff,n);
 }
-/* save output buffer --------------------------------------------------------*/
-// The caller is expected to hold the rtksvr lock.
-static void saveoutbuf(rtksvr_t *svr, uint8_t *buff, int n, int index)
+/* new solution message --------------------------------------------------------
+* snapshot the solution and the outputs which need the rtk control state. the
+* caller is expected to hold the rtksvr lock.
+*-----------------------------------------------------------------------------*/
+static svrmsg_t *solmsg(rtksvr_t *svr, uint64_t tread)
+{
+    svrmsg_t *msg,*msg2;
+    uint8_t buff[MAXSOLMSG+1];
+    size_t size=0;
+    int i,n,nssat=0;
+
+    for (i=0;i<RTKSVRNSOL;i++) {
+        if (svr->solopt[i].posf==SOLF_NMEA) nssat=MAXSAT;
+    }
+    if (!(msg=newmsg(SVRMSG_SOL,sizeof(ssat_t)*nssat))) return NULL;
+    msg->tread=tread;
+    msg->u.sol.sol=svr->rtk.sol;
+    matcpy(msg->u.sol.rb,svr->rtk.rb,6,1);
+    msg->u.sol.nssat=nssat;
+    if (nssat>0) memcpy(msg+1,svr->rtk.ssat,sizeof(ssat_t)*nssat);
+    size=sizeof(ssat_t)*nssat;
+
+    /* output solution status */
+    for (i=0;i<RTKSVRNSOL;i++) {
+        if (svr->solopt[i].posf!=SOLF_STAT) continue;
+        if ((n=rtkoutstat(&svr->rtk,svr->solopt[i].sstat,(char *)buff))<=0) {
+            continue;
+        }
+        if (!(msg2=(svrmsg_t *)realloc(msg,sizeof(svrmsg_t)+size+n))) {
+            trace(1,"solmsg: malloc error n=%d\n",n);
+            break;
+        }
+        msg=msg2;
+        memcpy((uint8_t *)(msg+1)+size,buff,n);
+        msg->u.sol.nstat[i]=n;
+        size+=n;
+    }
+    return msg;
+}
+/* save output buffer ----------------------------------------------------------
+* the output stage is the only writer of the output peek buffers
+*-----------------------------------------------------------------------------*/
+static void saveoutbuf(rtksvr_t *svr, const uint8_t *buff, int n, int index)
 {
-    n=n<svr->buffsize-svr->nsb[index]?n:svr->buffsize-svr->nsb[index];
-    memcpy(svr->sbuf[index]+svr->nsb[index],buff,n);
-    svr->nsb[index]+=n;
+    ringwrite(svr->sbuf+index,buff,n);
 }
 /* write solution to output stream -------------------------------------------*/
-static void writesol(rtksvr_t *svr, int index)
+static void writesol(rtksvr_t *svr, const svrmsg_t *msg)
 {
     solopt_t solopt=solopt_default;
+    const sol_t *sol=&msg->u.sol.sol;
+    const ssat_t *ssat=msg->u.sol.nssat?(const ssat_t *)(msg+1):NULL;
+    const uint8_t *stat=(const uint8_t *)(msg+1)+sizeof(ssat_t)*msg->u.sol.nssat;
     uint8_t buff[MAXSOLMSG+1];
     int i,n;
     
-    tracet(4,"writesol: index=%d\n",index);
+    tracet(4,"writesol:\n");
     
     for (i=0;i<RTKSVRNSOL;i++) {
         
         if (svr->solopt[i].posf==SOLF_STAT) {
             /* output solution status */
-            rtksvrlock(svr);
-            n=rtkoutstat(&svr->rtk,svr->solopt[i].sstat,(char *)buff);
-            rtksvrunlock(svr);
+            n=msg->u.sol.nstat[i];
+            memcpy(buff,stat,n);
+            stat+=n;
         }
         else {
             /* output solution */
-            n=outsols(buff,&svr->rtk.sol,svr->rtk.rb,svr->solopt+i);
+            n=outsols(buff,sol,msg->u.sol.rb,svr->solopt+i);
         }
         strwrite(svr->stream+RTKSVRNIN*2+i,buff,n);
 
         /* save output buffer */
-        rtksvrlock(svr);
         saveoutbuf(svr,buff,n,i);
-        rtksvrunlock(svr);
 
         /* output extended solution */
-        n=outsolexs(buff,&svr->rtk.sol,svr->rtk.ssat,svr->solopt+i);
+        if (!ssat) continue;
+        n=outsolexs(buff,sol,ssat,svr->solopt+i);
         strwrite(svr->stream+RTKSVRNIN*2+i,buff,n);
         
         /* save output buffer */
-        rtksvrlock(svr);
         saveoutbuf(svr,buff,n,i);
-        rtksvrunlock(svr);
     }
     /* output solution to monitor port */
     if (svr->moni) {
-        n=outsols(buff,&svr->rtk.sol,svr->rtk.rb,&solopt);
+        n=outsols(buff,sol,msg->u.sol.rb,&solopt);
         strwrite(svr->moni,buff,n);
     }
     /* save solution buffer */
+    rtksvrlock(svr);
     if (svr->nsol<MAXSOLBUF) {
-        rtksvrlock(svr);
-        svr->solbuf[svr->nsol++]=svr->rtk.sol;
-        rtksvrunlock(svr);
+        svr->solbuf[svr->nsol++]=*sol;
     }
+    rtksvrunlock(svr);
 }
-/* update glonass frequency channel number in raw data struct ----------------*/
-static void update_glofcn(rtksvr_t *svr)
+/* update glonass frequency channel number -------------------------------------
+* set the channel of a received GLONASS ephemeris to the raw decoders of all
+* inputs without the ephemeris, under the lock of the input decoder
+*-----------------------------------------------------------------------------*/
+static void update_glofcn(rtksvr_t *svr, const geph_t *geph, int prn)
 {
-    int i,j,sat,frq;
+    geph_t *geph1;
+    int i,sat=satno(SYS_GLO,prn);
     
-    for (i=0;i<MAXPRNGLO;i++) {
-        sat=satno(SYS_GLO,i+1);
-        
-        for (j=0,frq=-999;j<3;j++) {
-            if (svr->raw[j].nav.geph[i].sat!=sat) continue;
-            frq=svr->raw[j].nav.geph[i].frq;
-        }
-        if (frq<-7||frq>6) continue;
-        
-        for (j=0;j<3;j++) {
-            if (svr->raw[j].nav.geph[i].sat==sat) continue;
-            svr->raw[j].nav.geph[i].sat=sat;
-            svr->raw[j].nav.geph[i].frq=frq;
+    if (geph->frq<-7||geph->frq>6) return;
+    
+    for (i=0;i<RTKSVRNIN;i++) {
+        rtklib_lock(&svr->ilock[i]);
+        if ((geph1=svr->raw[i].nav.geph)&&geph1[prn-1].sat!=sat) {
+            geph1[prn-1].sat=sat;
+            geph1[prn-1].frq=geph->frq;
         }
+        rtklib_unlock(&svr->ilock[i]);
     }
 }
 /* update observation data ---------------------------------------------------*/
-static void update_obs(rtksvr_t *svr, obs_t *obs, int index, int iobs)
+static void update_obs(rtksvr_t *svr, const obsd_t *data, int nobs, int index)
 {
     int i,n=0,sat,sys;
     
-        if (iobs<MAXOBSBUF) {
-            for (i=0;i<obs->n;i++) {
-            sat=obs->data[i].sat;
-            sys = satsyst(sat, obs->data[i].time, NULL);
-            if (svr->rtk.opt.exsats[sat-1]==1||!(sys&svr->rtk.opt.navsys)) {
-                continue;
-            }
-                svr->obs[index][iobs].data[n]=obs->data[i];
-                svr->obs[index][iobs].data[n++].rcv=index+1;
-            }
-            svr->obs[index][iobs].n=n;
-            sortobs(&svr->obs[index][iobs]);
+    for (i=0;i<nobs&&n<MAXOBS;i++) {
+        sat=data[i].sat;
+        sys=satsyst(sat,data[i].time,NULL);
+        if (svr->rtk.opt.exsats[sat-1]==1||!(sys&svr->rtk.opt.navsys)) {
+            continue;
         }
-        svr->nmsg[index][0]++;
+        svr->obs[index].data[n]=data[i];
+        svr->obs[index].data[n++].rcv=index+1;
     }
+    svr->obs[index].n=n;
+    sortobs(&svr->obs[index]);
+    svr->nmsg[index][0]++;
+}
 /* update ephemeris ----------------------------------------------------------*/
-static void update_eph(rtksvr_t *svr, nav_t *nav, int ephsat, int ephset,
-                       int index)
+static void update_eph(rtksvr_t *svr, const svrmsg_t *msg, int index)
 {
-    eph_t *eph1,*eph2,*eph3;
-    int prn;
+    const eph_t *eph1;
+    eph_t *eph2,*eph3;
+    int prn,ephsat=msg->ephsat,ephset=msg->ephset;
     
     if (satsys(ephsat,&prn)!=SYS_GLO) {
             if (!svr->navsel||svr->navsel==index+1) {
             /* svr->nav.eph={current_set1,current_set2,prev_set1,prev_set2} */
-            eph1=nav->eph+ephsat-1+MAXSAT*ephset;         /* received */
+            eph1=&msg->u.eph;                             /* received */
             eph2=svr->nav.eph+ephsat-1+MAXSAT*ephset;     /* current */
             eph3=svr->nav.eph+ephsat-1+MAXSAT*(2+ephset); /* previous */
                 if (eph2->ttr.time==0||
@@ -197,22 +346,27 @@ static void update_eph(rtksvr_t *svr, nav_t *nav, int ephsat, int ephset,
                  timediff(eph1->toc,eph2->toc)!=0.0)) {
                 *eph3=*eph2; /* current ->previous */
                 *eph2=*eph1; /* received->current */
+                indexnav(&svr->nav,0x01);
+                evalnav(&svr->nav,svr->rtk.opt.gloorb);
                 trace(4,"update_eph: sat=%d iode %d->%d\n",ephsat,eph3->iode,eph2->iode);
                 }
             }
             svr->nmsg[index][1]++;
         }
     else {
+           update_glofcn(svr,&msg->u.geph,prn);
            if (!svr->navsel||svr->navsel==index+1) {
-               geph_t *geph1,*geph2,*geph3;
-               geph1=nav->geph+prn-1;
+               const geph_t *geph1;
+               geph_t *geph2,*geph3;
+               geph1=&msg->u.geph;
                geph2=svr->nav.geph+prn-1;
                geph3=svr->nav.geph+prn-1+MAXPRNGLO;
                if (geph2->tof.time==0||
                    (geph1->iode!=geph3->iode&&geph1->iode!=geph2->iode)) {
                    *geph3=*geph2;
                    *geph2=*geph1;
-                   update_glofcn(svr);
+                   indexnav(&svr->nav,0x02);
+                   evalnav(&svr->nav,svr->rtk.opt.gloorb);
                    trace(4,"update_eph: sat=%d iode %d->%d\n",ephsat,geph3->iode,geph2->iode);
                }
            }
@@ -220,12 +374,11 @@ static void update_eph(rtksvr_t *svr, nav_t *nav, int ephsat, int ephset,
     }
 }
 /* update sbas message -------------------------------------------------------*/
-static void update_sbs(rtksvr_t *svr, sbsmsg_t *sbsmsg, int index)
+static void update_sbs(rtksvr_t *svr, const sbsmsg_t *sbsmsg, int index)
 {
     int i,sbssat=svr->rtk.opt.sbassatsel;
     
         if (sbsmsg&&(sbssat==sbsmsg->prn||sbssat==0)) {
-        sbsmsg->rcv=index+1;
             if (svr->nsbs<MAXSBSMSG) {
                 svr->sbsmsg[svr->nsbs++]=*sbsmsg;
             }
@@ -233,12 +386,12 @@ static void update_sbs(rtksvr_t *svr, sbsmsg_t *sbsmsg, int index)
                 for (i=0;i<MAXSBSMSG-1;i++) svr->sbsmsg[i]=svr->sbsmsg[i+1];
                 svr->sbsmsg[i]=*sbsmsg;
             }
-            sbsupdatecorr(sbsmsg,&svr->nav);
+            if (sbsupdatecorr(sbsmsg,&svr->nav)==9) indexnav(&svr->nav,0x04);
         }
         svr->nmsg[index][3]++;
     }
 /* update ion/utc parameters -------------------------------------------------*/
-static void update_ionutc(rtksvr_t *svr, nav_t *nav, int index)
+static void update_ionutc(rtksvr_t *svr, const ionutc_t *nav, int index)
 {
         if (svr->navsel==0||svr->navsel==index+1) {
         matcpy(svr->nav.utc_gps,nav->utc_gps,8,1);
@@ -257,13 +410,7 @@ static void update_ionutc(rtksvr_t *svr, nav_t *nav, int index)
         svr->nmsg[index][2]++;
     }
 // Update antenna position ---------------------------------------------------
-static void update_antpos(rtksvr_t *svr, int index) {
-  sta_t *sta;
-  if (svr->format[index] == STRFMT_RTCM2 || svr->format[index] == STRFMT_RTCM3) {
-    sta = &svr->rtcm[index].sta;
-  } else {
-    sta = &svr->raw[index].sta;
-  }
+static void update_antpos(rtksvr_t *svr, const sta_t *sta, int index) {
   if (index == 1 && svr->rtk.opt.refpos == POSOPT_RTCM && norm(sta->pos, 3) > RE_WGS84 / 2) {
     // Update base station position.
     for (int i = 0; i < 3; i++) svr->rtk.rb[i] = sta->pos[i];
@@ -311,121 +458,192 @@ static void update_antpos(rtksvr_t *svr, int index) {
   svr->nmsg[index][4]++;
 }
 /* update ssr corrections ----------------------------------------------------*/
-static void update_ssr(rtksvr_t *svr, int index)
+static void update_ssr(rtksvr_t *svr, const svrmsg_t *msg, int index)
 {
-    for (int i=0;i<MAXSAT;i++) {
-        if (!svr->rtcm[index].ssr[i].update) continue;
-        if (svr->rtcm[index].ssr[i].iod[0]!=svr->rtcm[index].ssr[i].iod[1]) continue;
-        int ssr_iode = svr->rtcm[index].ssr[i].iode;
+    const ssrrec_t *rec=(const ssrrec_t *)(msg+1);
+
+    for (int j=0;j<msg->n;j++) {
+        int i=rec[j].sat-1;
+        int ssr_iode = rec[j].ssr.iode;
         if (svr->nav.ssr[i][0].iode != ssr_iode) {
           trace(4, "update_ssr new sat=%d iode %d to %d\n", i + 1, svr->nav.ssr[i][0].iode, ssr_iode);
           // New SSR IODE, save old SSR.
           svr->nav.ssr[i][1] = svr->nav.ssr[i][0];
         }
-        svr->nav.ssr[i][0] = svr->rtcm[index].ssr[i];
-        svr->rtcm[index].ssr[i].update = 0;
+        svr->nav.ssr[i][0] = rec[j].ssr;
     }
     svr->nmsg[index][7]++;
 
     /* update vtec */
-    svr->nav.vtec=svr->rtcm[index].nav.vtec;
+    svr->nav.vtec=msg->u.vtec;
 }
 /* update rtk server struct --------------------------------------------------*/
-static void update_svr(rtksvr_t *svr, int ret, obs_t *obs, nav_t *nav,
-                       int ephsat, int ephset, sbsmsg_t *sbsmsg, int index,
-                       int iobs)
+static void update_svr(rtksvr_t *svr, const svrmsg_t *msg, int index)
 {
-    tracet(4,"updatesvr: ret=%d ephsat=%d ephset=%d index=%d\n",ret,ephsat,
-           ephset,index);
+    int ret=msg->type;
+    
+    tracet(4,"updatesvr: ret=%d ephsat=%d ephset=%d index=%d\n",ret,
+           msg->ephsat,msg->ephset,index);
     
     if (ret==1) { /* observation data */
-        update_obs(svr,obs,index,iobs);
+        update_obs(svr,(const obsd_t *)(msg+1),msg->n,index);
     }
     else if (ret==2) { /* ephemeris */
-        update_eph(svr,nav,ephsat,ephset,index);
+        update_eph(svr,msg,index);
     }
     else if (ret==3) { /* sbas message */
-        update_sbs(svr,sbsmsg,index);
+        update_sbs(svr,msg->n?&msg->u.sbsmsg:NULL,index);
     }
     else if (ret==9) { /* ion/utc parameters */
-        update_ionutc(svr,nav,index);
+        update_ionutc(svr,&msg->u.ionutc,index);
     }
     else if (ret==5) { /* antenna position */
-        update_antpos(svr,index);
+        update_antpos(svr,&msg->u.sta,index);
     }
     else if (ret==7) { /* dgps correction */
         svr->nmsg[index][5]++;
     }
     else if (ret==10) { /* ssr message */
-        update_ssr(svr,index);
+        update_ssr(svr,msg,index);
     }
     else if (ret==-1) { /* error */
         svr->nmsg[index][9]++;
     }
 }
-/* decode receiver raw/rtcm data ---------------------------------------------*/
-static int decoderaw(rtksvr_t *svr, int index)
+/* new message of decoded data -------------------------------------------------
+* copy the data decoded by the input stage into a message for the positioning
+* stage, as the decoder control is reused for the following data
+*-----------------------------------------------------------------------------*/
+static svrmsg_t *decodemsg(rtksvr_t *svr, int ret, int index, uint64_t tread)
+{
+    const obs_t *obs;
+    const nav_t *nav;
+    const sta_t *sta;
+    ssrrec_t *rec;
+    svrmsg_t *msg;
+    int i,n,prn,rtcm;
+    
+    rtcm=svr->format[index]==STRFMT_RTCM2||svr->format[index]==STRFMT_RTCM3;
+    obs=rtcm?&svr->rtcm[index].obs:&svr->raw[index].obs;
+    nav=rtcm?&svr->rtcm[index].nav:&svr->raw[index].nav;
+    sta=rtcm?&svr->rtcm[index].sta:&svr->raw[index].sta;
+    
+    switch (ret) {
+        case 1: /* observation data */
+            if (!(msg=newmsg(ret,sizeof(obsd_t)*obs->n))) return NULL;
+            memcpy(msg+1,obs->data,sizeof(obsd_t)*obs->n);
+            msg->n=obs->n;
+            msg->tread=tread;
+            if (rtcm) msg->staid=svr->rtcm[index].staid;
+            return msg;
+        case 2: /* ephemeris */
+            if (!(msg=newmsg(ret,0))) return NULL;
+            msg->ephsat=rtcm?svr->rtcm[index].ephsat:svr->raw[index].ephsat;
+            msg->ephset=rtcm?svr->rtcm[index].ephset:svr->raw[index].ephset;
+            if (satsys(msg->ephsat,&prn)==SYS_GLO) {
+                msg->u.geph=nav->geph[prn-1];
+            }
+            else {
+                msg->u.eph=nav->eph[msg->ephsat-1+MAXSAT*msg->ephset];
+            }
+            return msg;
+        case 3: /* sbas message */
+            if (!(msg=newmsg(ret,0))) return NULL;
+            if (!rtcm) {
+                msg->u.sbsmsg=svr->raw[index].sbsmsg;
+                msg->u.sbsmsg.rcv=index+1;
+                msg->n=1;
+            }
+            return msg;
+        case 9: /* ion/utc parameters */
+            if (!(msg=newmsg(ret,0))) return NULL;
+            matcpy(msg->u.ionutc.utc_gps,nav->utc_gps,8,1);
+            matcpy(msg->u.ionutc.utc_glo,nav->utc_glo,8,1);
+            matcpy(msg->u.ionutc.utc_gal,nav->utc_gal,8,1);
+            matcpy(msg->u.ionutc.utc_qzs,nav->utc_qzs,8,1);
+            matcpy(msg->u.ionutc.utc_cmp,nav->utc_cmp,8,1);
+            matcpy(msg->u.ionutc.utc_irn,nav->utc_irn,9,1);
+            matcpy(msg->u.ionutc.utc_sbs,nav->utc_sbs,4,1);
+            matcpy(msg->u.ionutc.ion_gps,nav->ion_gps,8,1);
+            matcpy(msg->u.ionutc.ion_gal,nav->ion_gal,4,1);
+            matcpy(msg->u.ionutc.ion_qzs,nav->ion_qzs,8,1);
+            matcpy(msg->u.ionutc.ion_cmp,nav->ion_cmp,8,1);
+            matcpy(msg->u.ionutc.ion_irn,nav->ion_irn,8,1);
+            return msg;
+        case 5: /* antenna position */
+            if (!(msg=newmsg(ret,0))) return NULL;
+            msg->u.sta=*sta;
+            return msg;
+        case 7: /* dgps correction */
+            return newmsg(ret,0);
+        case 10: /* ssr message */
+            for (i=n=0;i<MAXSAT;i++) {
+                if (svr->rtcm[index].ssr[i].update) n++;
+            }
+            if (!(msg=newmsg(ret,sizeof(ssrrec_t)*n))) return NULL;
+            rec=(ssrrec_t *)(msg+1);
+            for (i=0;i<MAXSAT;i++) {
+                if (!svr->rtcm[index].ssr[i].update) continue;
+                if (svr->rtcm[index].ssr[i].iod[0]!=svr->rtcm[index].ssr[i].iod[1]) continue;
+                rec[msg->n].sat=i+1;
+                rec[msg->n++].ssr=svr->rtcm[index].ssr[i];
+                svr->rtcm[index].ssr[i].update=0;
+            }
+            msg->u.vtec=svr->rtcm[index].nav.vtec;
+            return msg;
+    }
+    return NULL;
+}
+/* decode receiver raw/rtcm data -----------------------------------------------
+* decode the input buffer in the input stage thread of the stream and queue
+* the decoded data to the positioning stage. the decoder control is locked by
+* the lock of the input decoder except while waiting on the full queue.
+*-----------------------------------------------------------------------------*/
+static int decoderaw(rtksvr_t *svr, int index, uint64_t tread)
 {
-    obs_t *obs;
-    nav_t *nav;
-    sbsmsg_t *sbsmsg=NULL;
-    int i,ret,ephsat,ephset,fobs=0;
+    svrmsg_t *msg;
+    int i,n,ret,stat,fobs=0;
     
     tracet(4,"decoderaw: index=%d\n",index);
     
-    rtksvrlock(svr);
+    rtklib_lock(&svr->ilock[index]);
     
-    for (i=0;i<svr->nb[index];i++) {
+    for (i=0;i<svr->nb[index];i+=n) {
+        n=1;
         
         /* input rtcm/receiver raw data from stream */
         if (svr->format[index]==STRFMT_RTCM2) {
             ret=input_rtcm2(svr->rtcm+index,svr->buff[index][i]);
-            obs=&svr->rtcm[index].obs;
-            nav=&svr->rtcm[index].nav;
-            ephsat=svr->rtcm[index].ephsat;
-            ephset=svr->rtcm[index].ephset;
         }
         else if (svr->format[index]==STRFMT_RTCM3) {
-            ret=input_rtcm3(svr->rtcm+index,svr->buff[index][i]);
-            if (svr->rtcm[index].nbyte_invalid!=0) {    /* If last message had error: */
-                i-=svr->rtcm[index].nbyte_invalid-1;      /* rewind to last preamble+1 */
-                i=i>=0?i:0;                         /* or beginning of buffer */
-                trace(4,"rewind buff %3d bytes, i=%d\n",svr->rtcm[index].nbyte_invalid-1,i);
-                svr->rtcm[index].nbyte_invalid=0;
-            }
-            obs=&svr->rtcm[index].obs;
-            nav=&svr->rtcm[index].nav;
-            ephsat=svr->rtcm[index].ephsat;
-            ephset=svr->rtcm[index].ephset;
+            ret=input_rtcm3_buf(svr->rtcm+index,svr->buff[index]+i,
+                                svr->nb[index]-i,&n);
         }
         else {
-            ret=input_raw(svr->raw+index,svr->format[index],svr->buff[index][i]);
-            obs=&svr->raw[index].obs;
-            nav=&svr->raw[index].nav;
-            ephsat=svr->raw[index].ephsat;
-            ephset=svr->raw[index].ephset;
-            sbsmsg=&svr->raw[index].sbsmsg;
+            ret=input_raw_buf(svr->raw+index,svr->format[index],svr->buff[index]+i,
+                              svr->nb[index]-i,&n);
         }
 #ifdef RTK_DISABLED /* record for receiving tick for debug */
         if (ret==1) {
             char tstr[40];
             trace(0,"%d %10d T=%s NS=%2d\n",index,tickget(),
-                  time2str(obs->data[0].time,tstr,0),obs->n);
+                  time2str(svr->raw[index].obs.data[0].time,tstr,0),
+                  svr->raw[index].obs.n);
         }
 #endif
-        /* update rtk server */
-        if (ret>0) {
-            update_svr(svr,ret,obs,nav,ephsat,ephset,sbsmsg,index,fobs);
+        /* queue decoded data to positioning stage */
+        if (ret>0&&(msg=decodemsg(svr,ret,index,tread))) {
+            rtklib_unlock(&svr->ilock[index]);
+            stat=quepush(svr,index,msg);
+            rtklib_lock(&svr->ilock[index]);
+            if (!stat) break;
         }
         /* observation data received */
-        if (ret==1) {
-            if (fobs<MAXOBSBUF) fobs++; else svr->prcout++;
-        }
+        if (ret==1) fobs++;
     }
+    rtklib_unlock(&svr->ilock[index]);
     svr->nb[index]=0;
     
-    rtksvrunlock(svr);
-    
     return fobs;
 }
 /* decode download file ------------------------------------------------------*/
@@ -467,10 +685,11 @@ static void decodefile(rtksvr_t *svr, int index)
         /* update precise ephemeris */
         rtksvrlock(svr);
         
-        if (svr->nav.peph) free(svr->nav.peph);
+        freenav(&svr->nav,0x08);
         svr->nav.ne = nav->ne;
         svr->nav.nemax = nav->nemax;
         svr->nav.peph=nav->peph;
+        svr->nav.pephp=nav->pephp;
         svr->ftime[index]=utc2gpst(timeget());
         strcpy(svr->files[index],file);
         
@@ -487,10 +706,11 @@ static void decodefile(rtksvr_t *svr, int index)
         /* update precise clock */
         rtksvrlock(svr);
         
-        if (svr->nav.pclk) free(svr->nav.pclk);
+        freenav(&svr->nav,0x10);
         svr->nav.nc = nav->nc;
         svr->nav.ncmax = nav->ncmax;
         svr->nav.pclk=nav->pclk;
+        svr->nav.pclkp=nav->pclkp;
         svr->ftime[index]=utc2gpst(timeget());
         strcpy(svr->files[index],file);
         
@@ -571,17 +791,19 @@ static void read_infiles(rtksvr_t *svr) {
   if (nav->ne > 0 || nav->nc > 0 || nav->natt > 0 || nav->erp.n > 0) {
     if (nav->ne > 0) {
       // Update precise ephemeris.
-      if (svr->nav.peph) free(svr->nav.peph);
+      freenav(&svr->nav, 0x08);
       svr->nav.ne = nav->ne;
       svr->nav.nemax = nav->nemax;
       svr->nav.peph = nav->peph;
+      svr->nav.pephp = nav->pephp;
     }
     if (nav->nc > 0) {
       // Update precise clock.
-      if (svr->nav.pclk) free(svr->nav.pclk);
+      freenav(&svr->nav, 0x10);
       svr->nav.nc = nav->nc;
       svr->nav.ncmax = nav->ncmax;
       svr->nav.pclk = nav->pclk;
+      svr->nav.pclkp = nav->pclkp;
     }
     if (nav->natt > 0) {
       // Update precise attitude.
@@ -711,7 +933,177 @@ static void send_nmea(rtksvr_t *svr, uint32_t *tickreset)
             sol_nmea.stat, sol_nmea.ns, sol_nmea.age, sol_nmea.refstationid,
             sol_nmea.rr[0], sol_nmea.rr[1], sol_nmea.rr[2]);
 }
-/* rtk server thread ---------------------------------------------------------*/
+/* add input-to-solution latency sample -------------------------------------*/
+static void addlatency(rtksvr_t *svr, double lat)
+{
+    rtksvrlock(svr);
+    svr->lat[svr->nlat++%MAXLATBUF]=(float)lat;
+    if (svr->nlat>=2*MAXLATBUF) svr->nlat-=MAXLATBUF;
+    rtksvrunlock(svr);
+}
+/* compare latency samples ---------------------------------------------------*/
+static int cmplat(const void *p1, const void *p2)
+{
+    float d=*(const float *)p1-*(const float *)p2;
+    return d<0.0f?-1:(d>0.0f?1:0);
+}
+/* input stage thread ----------------------------------------------------------
+* read an input stream, log and decode it, and queue the decoded data to the
+* positioning stage
+*-----------------------------------------------------------------------------*/
+#ifdef WIN32
+static DWORD WINAPI rtksvrinthread(void *arg)
+#else
+static void *rtksvrinthread(void *arg)
+#endif
+{
+    rtkque_t *que=(rtkque_t *)arg;
+    rtksvr_t *svr=(rtksvr_t *)que->svr;
+    uint64_t tread;
+    uint8_t *p,*q;
+    int n,index=que->index;
+    
+    tracet(3,"rtksvrinthread: index=%d\n",index);
+    
+    while (svr->state) {
+        p=svr->buff[index]+svr->nb[index]; q=svr->buff[index]+svr->buffsize;
+        
+        /* read receiver raw/rtcm data from input stream */
+        if ((n=strread(svr->stream+index,p,q-p))<=0) {
+            
+            /* wait input data until next cycle */
+            strwait(svr->stream+index,1,svr->cycle);
+            continue;
+        }
+        tread=tickgetus();
+        
+        /* write receiver raw/rtcm data to log stream */
+        strwrite(svr->stream+index+RTKSVRNIN,p,n);
+        svr->nb[index]+=n;
+        
+        /* save peek buffer */
+        ringwrite(svr->pbuf+index,p,n);
+        
+        if (svr->format[index]==STRFMT_SP3||svr->format[index]==STRFMT_RNXCLK) {
+            /* decode download file */
+            decodefile(svr,index);
+        }
+        else {
+            /* decode receiver raw/rtcm data */
+            decoderaw(svr,index,tread);
+        }
+    }
+    return 0;
+}
+/* write mark to output stream -----------------------------------------------*/
+static void writemark(rtksvr_t *svr, const svrmsg_t *msg)
+{
+    const uint8_t *p=(const uint8_t *)(msg+1);
+    int i;
+    
+    for (i=0;i<RTKSVRNSOL;i++) {
+        strwrite(svr->stream+RTKSVRNIN*2+i,(uint8_t *)p,msg->u.nmark[i]);
+        saveoutbuf(svr,p,msg->u.nmark[i],i);
+        p+=msg->u.nmark[i];
+    }
+    if (svr->moni) {
+        strwrite(svr->moni,(uint8_t *)p,msg->u.nmark[i]);
+    }
+}
+/* output stage thread -------------------------------------------------------*/
+#ifdef WIN32
+static DWORD WINAPI rtksvroutthread(void *arg)
+#else
+static void *rtksvroutthread(void *arg)
+#endif
+{
+    rtksvr_t *svr=(rtksvr_t *)arg;
+    svrmsg_t *msg;
+    
+    tracet(3,"rtksvroutthread:\n");
+    
+    while (svr->state) {
+        while (ringpop(&svr->mark,&msg)) {
+            writemark(svr,msg);
+            free(msg);
+        }
+        while (ringpop(&svr->que[RTKSVRNIN].ring,&msg)) {
+            
+            /* write solution */
+            writesol(svr,msg);
+            
+            /* input-to-solution latency */
+            if (msg->tread) addlatency(svr,(tickgetus()-msg->tread)*1E-3);
+            free(msg);
+        }
+        quewait(svr,1,svr->cycle);
+    }
+    return 0;
+}
+/* process rover observation data ----------------------------------------------
+* the caller is expected to hold the rtksvr lock
+* return : solution message (NULL: no solution)
+*-----------------------------------------------------------------------------*/
+static svrmsg_t *procrov(rtksvr_t *svr, obs_t *obs, uint64_t tread)
+{
+    svrmsg_t *sol=NULL;
+    double tt;
+    int j;
+    
+    obs->n=0;
+    for (j=0;j<svr->obs[0].n&&obs->n<MAXOBS*2;j++) {
+        obs->data[obs->n++]=svr->obs[0].data[j];
+    }
+    for (j=0;j<svr->obs[1].n&&obs->n<MAXOBS*2;j++) {
+        obs->data[obs->n++]=svr->obs[1].data[j];
+    }
+    /* carrier phase bias correction */
+    if (!strstr(svr->rtk.opt.pppopt,"-DIS_FCB")) {
+        corr_phase_bias(obs->data,obs->n,&svr->nav);
+    }
+    /* rtk positioning */
+    rtkpos(&svr->rtk,obs->data,obs->n,&svr->nav);
+    
+    if (svr->rtk.sol.stat!=SOLQ_NONE) {
+        
+        /* adjust current time */
+        tt=(tickgetus()-tread)*1E-6+DTTOL;
+        timeset(gpst2utc(timeadd(svr->rtk.sol.time,tt)));
+        
+        /* snapshot solution for output stage */
+        sol=solmsg(svr,tread);
+    }
+    /* if cpu overload, increment obs outage counter */
+    if ((tickgetus()-tread)*1E-3>=svr->cycle) {
+        svr->prcout++;
+    }
+    return sol;
+}
+/* process base station observation data -------------------------------------*/
+static void procbase(rtksvr_t *svr, int staid)
+{
+    sol_t sol={{0}};
+    char msg[128];
+    int i;
+    
+    if (svr->rtk.opt.refpos!=POSOPT_SINGLE) return;
+    
+    /* averaging single base pos */
+    if (staid>0) sol.refstationid=staid;
+    if ((svr->rtk.opt.maxaveep<=0||svr->nave<svr->rtk.opt.maxaveep)&&
+        pntpos(svr->obs[1].data,svr->obs[1].n,&svr->nav,
+               &svr->rtk.opt,1,&sol,NULL,NULL,msg)) {
+        svr->nave++;
+        for (i=0;i<3;i++) {
+            svr->rb_ave[i]+=(sol.rr[i]-svr->rb_ave[i])/svr->nave;
+        }
+    }
+    for (i=0;i<3;i++) svr->rtk.opt.rb[i]=svr->rb_ave[i];
+}
+/* rtk server thread -----------------------------------------------------------
+* positioning stage: apply the data queued by the input stages in order and
+* queue the solution of each rover epoch to the output stage
+*-----------------------------------------------------------------------------*/
 #ifdef WIN32
 static DWORD WINAPI rtksvrthread(void *arg)
 #else
@@ -719,13 +1111,10 @@ static void *rtksvrthread(void *arg)
 #endif
 {
     rtksvr_t *svr=(rtksvr_t *)arg;
+    svrmsg_t *msg,*sol;
     obs_t obs;
-    sol_t sol={{0}};
-    double tt;
-    uint32_t tick,ticknmea,tick1hz,tickreset;
-    uint8_t *p,*q;
-    char msg[128];
-    int i,j,n,cycle,cputime;
+    uint32_t tick,ticknmea,tick1hz,tickreset,tickcyc;
+    int i,cycle=0,cputime=0;
     
     tracet(3,"rtksvrthread:\n");
     
@@ -738,95 +1127,46 @@ static void *rtksvrthread(void *arg)
     obs.n = 0;
     obs.nmax = MAXOBS * 2;
 
-    svr->state=1;
-    svr->tick=tickget();
     ticknmea=tick1hz=svr->tick-1000;
     tickreset=svr->tick-MIN_INT_RESET;
+    tickcyc=svr->tick-svr->cycle;
 
-    for (cycle=0;svr->state;cycle++) {
+    while (svr->state) {
         tick=tickget();
         read_infiles(svr);
-        for (i=0;i<RTKSVRNIN;i++) {
-            p=svr->buff[i]+svr->nb[i]; q=svr->buff[i]+svr->buffsize;
-            
-            /* read receiver raw/rtcm data from input stream */
-            if ((n=strread(svr->stream+i,p,q-p))<=0) {
-                continue;
-            }
-            /* write receiver raw/rtcm data to log stream */
-            strwrite(svr->stream+i+RTKSVRNIN,p,n);
-            svr->nb[i]+=n;
-            
-            /* save peek buffer */
-            rtksvrlock(svr);
-            n=n<svr->buffsize-svr->npb[i]?n:svr->buffsize-svr->npb[i];
-            memcpy(svr->pbuf[i]+svr->npb[i],p,n);
-            svr->npb[i]+=n;
-            rtksvrunlock(svr);
-        }
-        int fobs[RTKSVRNIN]={0};
-        for (i=0;i<RTKSVRNIN;i++) {
-            if (svr->format[i]==STRFMT_SP3||svr->format[i]==STRFMT_RNXCLK) {
-                /* decode download file */
-                decodefile(svr,i);
-            }
-            else {
-                /* decode receiver raw/rtcm data */
-                fobs[i]=decoderaw(svr,i);
-                if (1==i&&svr->rtcm[1].staid>0) sol.refstationid=svr->rtcm[1].staid; 
-            }
-        }
-        /* averaging single base pos */
-        if (fobs[1]>0&&svr->rtk.opt.refpos==POSOPT_SINGLE) {
-            if ((svr->rtk.opt.maxaveep<=0||svr->nave<svr->rtk.opt.maxaveep)&&
-                pntpos(svr->obs[1][0].data,svr->obs[1][0].n,&svr->nav,
-                       &svr->rtk.opt,1,&sol,NULL,NULL,msg)) {
-                svr->nave++;
-                for (i=0;i<3;i++) {
-                    svr->rb_ave[i]+=(sol.rr[i]-svr->rb_ave[i])/svr->nave;
+        
+        /* apply base station and correction data before rover data */
+        for (i=RTKSVRNIN-1;i>=0;i--) {
+            while (ringpop(&svr->que[i].ring,&msg)) {
+                sol=NULL;
+                rtksvrlock(svr);
+                update_svr(svr,msg,i);
+                if (msg->type==1) {
+                    if (i==0) sol=procrov(svr,&obs,msg->tread);
+                    else if (i==1) procbase(svr,msg->staid);
                 }
-            }
-            for (i=0;i<3;i++) svr->rtk.opt.rb[i]=svr->rb_ave[i];
-        }
-        for (i=0;i<fobs[0];i++) { /* for each rover observation data */
-            obs.n=0;
-            for (j=0;j<svr->obs[0][i].n&&obs.n<MAXOBS*2;j++) {
-                obs.data[obs.n++]=svr->obs[0][i].data[j];
-            }
-            for (j=0;j<svr->obs[1][0].n&&obs.n<MAXOBS*2;j++) {
-                obs.data[obs.n++]=svr->obs[1][0].data[j];
-            }
-            /* carrier phase bias correction */
-            if (!strstr(svr->rtk.opt.pppopt,"-DIS_FCB")) {
-                corr_phase_bias(obs.data,obs.n,&svr->nav);
-            }
-            /* rtk positioning */
-            rtksvrlock(svr);
-            rtkpos(&svr->rtk,obs.data,obs.n,&svr->nav);
-            rtksvrunlock(svr);
-            
-            if (svr->rtk.sol.stat!=SOLQ_NONE) {
-                
-                /* adjust current time */
-                tt=(int)(tickget()-tick)/1000.0+DTTOL;
-                timeset(gpst2utc(timeadd(svr->rtk.sol.time,tt)));
+                rtksvrunlock(svr);
+                free(msg);
                 
                 /* write solution */
-                writesol(svr,i);
-            }
-            /* if cpu overload, increment obs outage counter and break */
-            if ((int)(tickget()-tick)>=svr->cycle) {
-                svr->prcout+=fobs[0]-i-1;
+                if (sol) quepush(svr,RTKSVRNIN,sol);
             }
         }
         /* send null solution if no solution (1hz) */
         if (svr->rtk.sol.stat==SOLQ_NONE&&(int)(tick-tick1hz)>=1000) {
-            writesol(svr,0);
+            rtksvrlock(svr);
+            sol=solmsg(svr,0);
+            rtksvrunlock(svr);
+            if (sol) quepush(svr,RTKSVRNIN,sol);
             tick1hz=tick;
         }
-        /* write periodic command to input stream */
-        for (i=0;i<RTKSVRNIN;i++) {
-            periodic_cmd(cycle*svr->cycle,svr->cmds_periodic[i],svr->stream+i);
+        /* write periodic command to input stream at each cycle */
+        if ((int)(tick-tickcyc)>=svr->cycle) {
+            for (i=0;i<RTKSVRNIN;i++) {
+                periodic_cmd(cycle*svr->cycle,svr->cmds_periodic[i],svr->stream+i);
+            }
+            cycle++;
+            tickcyc=tick;
         }
         /* send nmea request to base/nrtk input stream */
         if (svr->nmeacycle>0&&(int)(tick-ticknmea)>=svr->nmeacycle) {
@@ -835,23 +1175,56 @@ static void *rtksvrthread(void *arg)
         }
         if ((cputime=(int)(tickget()-tick))>0) svr->cputime=cputime;
         
-        /* sleep until next cycle */
-        sleepms(svr->cycle-cputime);
+        /* wait input data until next cycle */
+        quewait(svr,0,svr->cycle-cputime);
     }
     free(data);
+    return 0;
+}
+/* stop rtk server stage threads ---------------------------------------------*/
+static void stopthreads(rtksvr_t *svr, int nin, int out, int pos)
+{
+    int i;
+    
+    svr->state=0;
+    rtklib_lock(&svr->qlock);
+    rtklib_signal(svr->qcond);
+    rtklib_signal(svr->qcond+1);
+    rtklib_unlock(&svr->qlock);
+    
+#ifdef WIN32
+    for (i=0;i<nin;i++) {
+        WaitForSingleObject(svr->ithread[i],10000);
+        CloseHandle(svr->ithread[i]);
+    }
+    if (pos) {
+        WaitForSingleObject(svr->thread,10000);
+        CloseHandle(svr->thread);
+    }
+    if (out) {
+        WaitForSingleObject(svr->othread,10000);
+        CloseHandle(svr->othread);
+    }
+#else
+    for (i=0;i<nin;i++) pthread_join(svr->ithread[i],NULL);
+    if (pos) pthread_join(svr->thread,NULL);
+    if (out) pthread_join(svr->othread,NULL);
+#endif
     for (i=0;i<MAXSTRRTK;i++) strclose(svr->stream+i);
+    for (i=0;i<=RTKSVRNIN;i++) quefree(&svr->que[i].ring);
+    quefree(&svr->mark);
     for (i=0;i<RTKSVRNIN;i++) {
-        svr->nb[i]=svr->npb[i]=0;
+        svr->nb[i]=0;
         free(svr->buff[i]); svr->buff[i]=NULL;
-        free(svr->pbuf[i]); svr->pbuf[i]=NULL;
+        ringfree(svr->pbuf+i);
+        rtklib_lock(&svr->ilock[i]);
         free_raw (svr->raw +i);
         free_rtcm(svr->rtcm+i);
+        rtklib_unlock(&svr->ilock[i]);
     }
     for (i=0;i<RTKSVRNSOL;i++) {
-        svr->nsb[i]=0;
-        free(svr->sbuf[i]); svr->sbuf[i]=NULL;
+        ringfree(svr->sbuf+i);
     }
-    return 0;
 }
 /* initialize rtk server -------------------------------------------------------
 * initialize rtk server
@@ -876,9 +1249,8 @@ int rtksvrinit(rtksvr_t *svr)
     for (i=0;i<RTKSVRNIN;i++) {
       svr->format[i]=0;
       svr->nb[i]=0;
-      svr->npb[i]=0;
       svr->buff[i]=NULL;
-      svr->pbuf[i]=NULL;
+      memset(svr->pbuf+i,0,sizeof(ring_t));
       for (j=0;j<10;j++) svr->nmsg[i][j]=0;
       svr->ftime[i]=time0;
       svr->files[i][0]='\0';
@@ -886,14 +1258,21 @@ int rtksvrinit(rtksvr_t *svr)
     }
     for (i=0;i<RTKSVRNSOL;i++) {
       svr->solopt[i]=solopt_default;
-      svr->nsb[i]=0;
-      svr->sbuf[i]=NULL;
+      memset(svr->sbuf+i,0,sizeof(ring_t));
     }
     for (i=0;i<MAXSOLBUF;i++) svr->solbuf[i]=sol0;
     svr->moni=NULL;
     svr->tick=0;
     svr->thread=0;
-    svr->cputime=svr->prcout=svr->nave=0;
+    svr->othread=0;
+    for (i=0;i<RTKSVRNIN;i++) svr->ithread[i]=0;
+    for (i=0;i<=RTKSVRNIN;i++) {
+        memset(svr->que+i,0,sizeof(rtkque_t));
+        svr->que[i].svr=svr;
+        svr->que[i].index=i;
+    }
+    memset(&svr->mark,0,sizeof(ring_t));
+    svr->cputime=svr->prcout=svr->nave=svr->nlat=0;
     for (i=0;i<3;i++) svr->rb_ave[i]=0.0;
     
     memset(&svr->nav,0,sizeof(nav_t));
@@ -920,14 +1299,14 @@ int rtksvrinit(rtksvr_t *svr)
       for (i = 0; i < MAXPRNGLO * 2; i++) svr->nav.geph[i] = geph0;
     }
     svr->nav.ng = svr->nav.ngmax = MAXPRNGLO * 2;
+    indexnav(&svr->nav,0x07);
+    evalnav(&svr->nav,0);
 
     for (i=0;i<RTKSVRNIN;i++) {
-      for (j=0;j<MAXOBSBUF;j++) {
-        if (!(svr->obs[i][j].data=(obsd_t *)malloc(sizeof(obsd_t)*MAXOBS))) {
-            tracet(1,"rtksvrinit: malloc error\n");
-            rtksvrfree(svr);
-            return 0;
-        }
+      if (!(svr->obs[i].data=(obsd_t *)malloc(sizeof(obsd_t)*MAXOBS))) {
+          tracet(1,"rtksvrinit: malloc error\n");
+          rtksvrfree(svr);
+          return 0;
       }
       memset(svr->raw +i,0,sizeof(raw_t ));
       memset(svr->rtcm+i,0,sizeof(rtcm_t));
@@ -948,6 +1327,10 @@ int rtksvrinit(rtksvr_t *svr)
     for (int i = 0; i < MAXINFILES; i++) svr->infiles[i][0] = '\0';
     svr->ninfiles = 0;
     rtklib_initlock(&svr->lock);
+    for (i=0;i<RTKSVRNIN;i++) rtklib_initlock(&svr->ilock[i]);
+    rtklib_initlock(&svr->qlock);
+    rtklib_initcond(svr->qcond);
+    rtklib_initcond(svr->qcond+1);
     
     return 1;
 }
@@ -958,14 +1341,10 @@ int rtksvrinit(rtksvr_t *svr)
 *-----------------------------------------------------------------------------*/
 void rtksvrfree(rtksvr_t *svr)
 {
-    int i,j;
+    int i;
     
-    free(svr->nav.eph );
-    free(svr->nav.geph);
-    free(svr->nav.seph);
-    for (i=0;i<RTKSVRNIN;i++) for (j=0;j<MAXOBSBUF;j++) {
-        free(svr->obs[i][j].data);
-    }
+    freenav(&svr->nav,0x07);
+    for (i=0;i<RTKSVRNIN;i++) free(svr->obs[i].data);
     rtkfree(&svr->rtk);
 }
 /* lock/unlock rtk server ------------------------------------------------------
@@ -976,6 +1355,17 @@ void rtksvrfree(rtksvr_t *svr)
 void rtksvrlock  (rtksvr_t *svr) {rtklib_lock  (&svr->lock);}
 void rtksvrunlock(rtksvr_t *svr) {rtklib_unlock(&svr->lock);}
 
+/* lock/unlock input decoder of rtk server -------------------------------------
+* lock/unlock the receiver raw and rtcm control of an input, which are updated
+* by the input stage thread without the lock of rtk server
+* args   : rtksvr_t *svr    IO rtk server
+*          int     index    I  input index (0-(RTKSVRNIN-1))
+* return : none
+* notes  : lock the rtk server first to lock both
+*-----------------------------------------------------------------------------*/
+void rtksvrlockin  (rtksvr_t *svr, int index) {rtklib_lock  (&svr->ilock[index]);}
+void rtksvrunlockin(rtksvr_t *svr, int index) {rtklib_unlock(&svr->ilock[index]);}
+
 /* start rtk server ------------------------------------------------------------
 * start rtk server thread
 * args   : rtksvr_t *svr    IO rtk server
@@ -1056,24 +1446,25 @@ int rtksvrstart(rtksvr_t *svr, int cycle, int buffsize, int *strs,
     svr->navsel=navsel;
     svr->nsbs=0;
     svr->nsol=0;
-    svr->prcout=0;
+    svr->prcout=svr->nlat=0;
     rtkfree(&svr->rtk);
     rtkinit(&svr->rtk,prcopt);
+    evalnav(&svr->nav,prcopt->gloorb);
     
     if (prcopt->initrst) { /* init averaging pos by restart */
         svr->nave=0;
         for (i=0;i<3;i++) svr->rb_ave[i]=0.0;
     }
     for (i=0;i<RTKSVRNIN;i++) { /* input/log streams */
-        svr->nb[i]=svr->npb[i]=0;
+        svr->nb[i]=0;
         if (!(svr->buff[i]=(uint8_t *)malloc(buffsize))||
-            !(svr->pbuf[i]=(uint8_t *)malloc(buffsize))) {
+            !ringinit(svr->pbuf+i,buffsize,1)) {
             tracet(1,"rtksvrstart: malloc error\n");
             sprintf(errmsg,"rtk server malloc error");
             return 0;
         }
         for (j=0;j<10;j++) svr->nmsg[i][j]=0;
-        for (j=0;j<MAXOBSBUF;j++) svr->obs[i][j].n=0;
+        svr->obs[i].n=0;
         strcpy(svr->cmds_periodic[i],!cmds_periodic[i]?"":cmds_periodic[i]);
         
         /* initialize receiver raw and rtcm control */
@@ -1088,12 +1479,27 @@ int rtksvrstart(rtksvr_t *svr, int cycle, int buffsize, int *strs,
         svr->rtcm[i].dgps=svr->nav.dgps;
     }
     for (i=0;i<RTKSVRNSOL;i++) { /* output peek buffer */
-        if (!(svr->sbuf[i]=(uint8_t *)malloc(buffsize))) {
+        if (!ringinit(svr->sbuf+i,buffsize,1)) {
             tracet(1,"rtksvrstart: malloc error\n");
             sprintf(errmsg,"rtk server malloc error");
             return 0;
         }
     }
+    if (!ringinit(&svr->mark,MAXMARKMSG,sizeof(svrmsg_t *))) {
+        tracet(1,"rtksvrstart: malloc error\n");
+        sprintf(errmsg,"rtk server malloc error");
+        return 0;
+    }
+    for (i=0;i<=RTKSVRNIN;i++) { /* stage queues */
+        svr->que[i].nmsg=svr->que[i].nfull=0;
+        svr->que[i].npeak=0;
+        if (!ringinit(&svr->que[i].ring,RTKSVRQLEN,sizeof(svrmsg_t *))) {
+            tracet(1,"rtksvrstart: malloc error\n");
+            sprintf(errmsg,"rtk server malloc error");
+            for (i--;i>=0;i--) ringfree(&svr->que[i].ring);
+            return 0;
+        }
+    }
     /* set solution options */
     for (i=0;i<RTKSVRNSOL;i++) {
         svr->solopt[i]=solopt[i];
@@ -1122,6 +1528,7 @@ int rtksvrstart(rtksvr_t *svr, int cycle, int buffsize, int *strs,
         if (!stropen(svr->stream+i,strs[i],rw,paths[i])) {
             sprintf(errmsg,"str%d open error path=%s",i+1,paths[i]);
             for (i--;i>=0;i--) strclose(svr->stream+i);
+            for (i=0;i<=RTKSVRNIN;i++) ringfree(&svr->que[i].ring);
             return 0;
         }
         /* set initial time for rtcm and raw */
@@ -1155,16 +1562,39 @@ int rtksvrstart(rtksvr_t *svr, int cycle, int buffsize, int *strs,
     for (i=RTKSVRNIN*2;i<MAXSTRRTK;i++) {
         writesolhead(svr->stream+i,svr->solopt+(i-RTKSVRNIN*2), prcopt);
     }
-    /* create rtk server thread */
+    svr->state=1;
+    svr->tick=tickget();
+    
+    /* create output, positioning and input stage threads */
+#ifdef WIN32
+    if (!(svr->othread=CreateThread(NULL,0,rtksvroutthread,svr,0,NULL))) {
+#else
+    if (pthread_create(&svr->othread,NULL,rtksvroutthread,svr)) {
+#endif
+        stopthreads(svr,0,0,0);
+        sprintf(errmsg,"thread create error\n");
+        return 0;
+    }
 #ifdef WIN32
     if (!(svr->thread=CreateThread(NULL,0,rtksvrthread,svr,0,NULL))) {
 #else
     if (pthread_create(&svr->thread,NULL,rtksvrthread,svr)) {
 #endif
-        for (i=0;i<MAXSTRRTK;i++) strclose(svr->stream+i);
+        stopthreads(svr,0,1,0);
         sprintf(errmsg,"thread create error\n");
         return 0;
     }
+    for (i=0;i<RTKSVRNIN;i++) {
+#ifdef WIN32
+        if (!(svr->ithread[i]=CreateThread(NULL,0,rtksvrinthread,svr->que+i,0,NULL))) {
+#else
+        if (pthread_create(svr->ithread+i,NULL,rtksvrinthread,svr->que+i)) {
+#endif
+            stopthreads(svr,i,1,1);
+            sprintf(errmsg,"thread create error\n");
+            return 0;
+        }
+    }
     return 1;
 }
 /* stop rtk server -------------------------------------------------------------
@@ -1182,6 +1612,8 @@ void rtksvrstop(rtksvr_t *svr, const char **cmds)
     
     tracet(3,"rtksvrstop:\n");
     
+    if (!svr->state) return;
+    
     /* write stop commands to input streams */
     rtksvrlock(svr);
     for (i=0;i<RTKSVRNIN;i++) {
@@ -1189,16 +1621,8 @@ void rtksvrstop(rtksvr_t *svr, const char **cmds)
     }
     rtksvrunlock(svr);
     
-    /* stop rtk server */
-    svr->state=0;
-    
-    /* free rtk server thread */
-#ifdef WIN32
-    WaitForSingleObject(svr->thread,10000);
-    CloseHandle(svr->thread);
-#else
-    pthread_join(svr->thread,NULL);
-#endif
+    /* stop rtk server and free stage threads */
+    stopthreads(svr,RTKSVRNIN,1,1);
 }
 /* open output/log stream ------------------------------------------------------
 * open output/log stream
@@ -1278,18 +1702,18 @@ int rtksvrostat(rtksvr_t *svr, int rcv, gtime_t *time, int sat[MAXSAT],
     
     if (!svr->state) return 0;
     rtksvrlock(svr);
-    int ns=svr->obs[rcv][0].n;
+    int ns=svr->obs[rcv].n;
     if (ns>0) {
-        *time=svr->obs[rcv][0].data[0].time;
+        *time=svr->obs[rcv].data[0].time;
     }
     for (int i=0;i<ns;i++) {
-        sat [i]=svr->obs[rcv][0].data[i].sat;
+        sat [i]=svr->obs[rcv].data[i].sat;
         // No corrections azel data so use the base.
         int base = rcv <= 1 ? rcv : 1;
         az  [i]=svr->rtk.ssat[sat[i]-1].azel[base][0];
         el  [i]=svr->rtk.ssat[sat[i]-1].azel[base][1];
         for (int j=0;j<NFREQ;j++) {
-            snr[i][j] = svr->obs[rcv][0].data[i].SNR[j] + 0.5;
+            snr[i][j] = svr->obs[rcv].data[i].SNR[j] + 0.5;
             if (svr->rtk.sol.stat == SOLQ_NONE || svr->rtk.sol.stat == SOLQ_SINGLE)
               vsat[i][j] = svr->rtk.ssat[sat[i] - 1].vs;
             else
@@ -1320,6 +1744,55 @@ void rtksvrsstat(rtksvr_t *svr, int *sstat, char *msg)
     }
     rtksvrunlock(svr);
 }
+/* get input-to-solution latency -----------------------------------------------
+* get percentiles of latency from reading rover input data until writing
+* solution for the last MAXLATBUF solutions
+* args   : rtksvr_t *svr    I  rtk server
+*          double  *p50     O  50 percentile of latency (ms)
+*          double  *p99     O  99 percentile of latency (ms)
+* return : number of latency samples
+*-----------------------------------------------------------------------------*/
+int rtksvrlatency(rtksvr_t *svr, double *p50, double *p99)
+{
+    float lat[MAXLATBUF];
+    int n;
+    
+    tracet(4,"rtksvrlatency:\n");
+    
+    rtksvrlock(svr);
+    n=svr->nlat<MAXLATBUF?svr->nlat:MAXLATBUF;
+    memcpy(lat,svr->lat,sizeof(float)*n);
+    rtksvrunlock(svr);
+    
+    *p50=*p99=0.0;
+    if (n<=0) return 0;
+    qsort(lat,n,sizeof(float),cmplat);
+    *p50=lat[n/2];
+    *p99=lat[(int)(n*0.99)];
+    return n;
+}
+/* get stage queue status ------------------------------------------------------
+* get status of the queues between the input, positioning and output stages
+* args   : rtksvr_t *svr    I  rtk server
+*          int     *nq      O  number of queued messages {rov,base,corr,sol}
+*          int     *npeak   O  peak number of queued messages {rov,base,corr,sol}
+*          uint32_t *nfull  O  number of waits on full queue {rov,base,corr,sol}
+* return : none
+* notes  : a queue is full when its consumer stage can not keep up. the
+*          producer stage then waits (back-pressure) and counts the waits.
+*-----------------------------------------------------------------------------*/
+void rtksvrqstat(rtksvr_t *svr, int *nq, int *npeak, uint32_t *nfull)
+{
+    int i;
+    
+    tracet(4,"rtksvrqstat:\n");
+    
+    for (i=0;i<=RTKSVRNIN;i++) {
+        nq[i]=svr->que[i].ring.buff?ringcount(&svr->que[i].ring):0;
+        npeak[i]=svr->que[i].npeak;
+        nfull[i]=svr->que[i].nfull;
+    }
+}
 /* mark current position -------------------------------------------------------
 * mark current position
 * args   : rtksvr_t *svr    IO rtk server
@@ -1329,13 +1802,15 @@ void rtksvrsstat(rtksvr_t *svr, int *sstat, char *msg)
 *-----------------------------------------------------------------------------*/
 int rtksvrmark(rtksvr_t *svr, const char *name, const char *comment)
 {
+    svrmsg_t *msg,*msg2;
     char buff[MAXSOLMSG+1],tstr[40],*p,*q;
     double tow,pos[3];
-    int i,sum,week;
+    size_t size=0;
+    int i,sum,week,stat=1;
     
     tracet(4,"rtksvrmark:name=%s comment=%s\n",name,comment);
     
-    if (!svr->state) return 0;
+    if (!svr->state||!(msg=newmsg(SVRMSG_MARK,0))) return 0;
     
     rtksvrlock(svr);
     
@@ -1343,9 +1818,16 @@ int rtksvrmark(rtksvr_t *svr, const char *name, const char *comment)
     tow=time2gpst(svr->rtk.sol.time,&week);
     ecef2pos(svr->rtk.sol.rr,pos);
     
-    for (i=0;i<RTKSVRNSOL;i++) {
+    for (i=0;i<=RTKSVRNSOL;i++) {
         p=buff;
-        if (svr->solopt[i].posf==SOLF_STAT) {
+        if (i==RTKSVRNSOL) { /* monitor */
+            if (svr->moni) {
+                p+=sprintf(p,"%s MARK: %s,%s,%.9f,%.9f,%.4f,%d,%s\r\n",COMMENTH,
+                           name,tstr,pos[0]*R2D,pos[1]*R2D,pos[2],svr->rtk.sol.stat,
+                           comment);
+            }
+        }
+        else if (svr->solopt[i].posf==SOLF_STAT) {
             p+=sprintf(p,"$MARK,%d,%.3f,%d,%.4f,%.4f,%.4f,%s,%s\r\n",week,tow,
                        svr->rtk.sol.stat,svr->rtk.sol.rr[0],svr->rtk.sol.rr[1],
                        svr->rtk.sol.rr[2],name,comment);
@@ -1362,16 +1844,53 @@ int rtksvrmark(rtksvr_t *svr, const char *name, const char *comment)
                        name,tstr,pos[0]*R2D,pos[1]*R2D,pos[2],svr->rtk.sol.stat,
                        comment);
         }
-        strwrite(svr->stream+RTKSVRNIN*2+i,(uint8_t *)buff,(int)(p-buff));
-        saveoutbuf(svr,(uint8_t *)buff,(int)(p-buff),i);
+        if (!(msg2=(svrmsg_t *)realloc(msg,sizeof(svrmsg_t)+size+(p-buff)))) {
+            stat=0;
+            break;
+        }
+        msg=msg2;
+        memcpy((char *)(msg+1)+size,buff,p-buff);
+        msg->u.nmark[i]=(int)(p-buff);
+        size+=p-buff;
     }
-    if (svr->moni) {
-        p=buff;
-        p+=sprintf(p,"%s MARK: %s,%s,%.9f,%.9f,%.4f,%d,%s\r\n",COMMENTH,
-                   name,tstr,pos[0]*R2D,pos[1]*R2D,pos[2],svr->rtk.sol.stat,
-                   comment);
-        strwrite(svr->moni,(uint8_t *)buff,(int)(p-buff));
+    /* queue mark to output stage (the lock serializes the callers) */
+    if (stat&&!ringpush(&svr->mark,&msg)) {
+        tracet(2,"rtksvrmark: mark queue full\n");
+        stat=0;
     }
     rtksvrunlock(svr);
+    
+    if (!stat) {
+        free(msg);
+        return 0;
+    }
+    rtklib_lock(&svr->qlock);
+    rtklib_signal(svr->qcond+1);
+    rtklib_unlock(&svr->qlock);
     return 1;
 }
+/* peek stream buffer ----------------------------------------------------------
+* read and remove the data saved in the peek buffer of an input or solution
+* stream for monitoring
+* args   : rtksvr_t *svr    IO rtk server
+*          int     index    I  stream index
+*                              (0:input rover,1:input base,2:input corr,...,
+*                               RTKSVRNIN*2+i:solution i+1)
+*          uint8_t *buff    O  peek data (NULL: discard)
+*          int     nmax     I  max size of peek data (bytes)
+* return : size of peek data (bytes)
+* notes  : the peek buffers are single-producer/single-consumer rings filled
+*          by the input and output stage threads without lock, so only one
+*          thread may peek each buffer
+*-----------------------------------------------------------------------------*/
+int rtksvrpeek(rtksvr_t *svr, int index, uint8_t *buff, int nmax)
+{
+    ring_t *ring;
+    
+    if (index>=0&&index<RTKSVRNIN) ring=svr->pbuf+index;
+    else if (index>=RTKSVRNIN*2&&index<MAXSTRRTK) ring=svr->sbuf+index-RTKSVRNIN*2;
+    else return 0;
+    
+    if (!ring->buff) return 0;
+    return ringread(ring,buff,nmax);
+}
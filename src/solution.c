@@ -1366,7 +1366,7 @@ static int outenu(uint8_t *buff, const char *s, const sol_t *sol,
 /* output solution in the form of NMEA RMC sentence --------------------------*/
 int outnmea_rmc(uint8_t *buff, const sol_t *sol)
 {
-    static double dirp=0.0;
+    static THREADLOCAL double dirp=0.0;
     gtime_t time;
     double ep[6],pos[3],enuv[3],dms1[3],dms2[3],vel,dir,amag=0.0;
     char *p=(char *)buff,*q,sum;
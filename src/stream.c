@@ -94,6 +94,11 @@
 #include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <netdb.h>
+#include <poll.h>
+#if defined(__linux__)&&!defined(NO_EPOLL)
+#include <sys/epoll.h>
+#define USE_EPOLL           /* poll sockets by epoll/poll instead of select */
+#endif
 #endif
 
 /* constants -----------------------------------------------------------------*/
@@ -101,7 +106,12 @@
 #define TINTACT             200         /* period for stream active (ms) */
 #define SERIBUFFSIZE        4096        /* serial buffer size (bytes) */
 #define TIMETAGH_LEN        64          /* time tag file header length */
-#define MAXCLI              32          /* max client connection for tcp svr */
+#define MAXCLI              4096        /* max client connection for tcp svr */
+#define NCLIALLOC           32          /* client controls allocated at once */
+#define MAXSOCKEV           256         /* max socket events polled at once */
+#define MAXSTRWAIT          32          /* max streams waited by strwait() */
+#define CLIQLEN             256         /* default client output queue length */
+#define MAXSTATCLI          8           /* max clients in extended state */
 #define MAXSTATMSG          32          /* max length of status message */
 #define DEFAULT_MEMBUF_SIZE 4096        /* default memory buffer size (bytes) */
 
@@ -174,9 +184,34 @@ typedef struct {            /* tcp control type */
     uint32_t tdis;          /* disconnect tick */
 } tcp_t;
 
+typedef struct {            /* shared message buffer type */
+    int ref;                /* reference count */
+    int n;                  /* message length (bytes) */
+    uint32_t tick;          /* tick written */
+    uint8_t *data;          /* message data */
+} msgbuf_t;
+
+typedef struct {            /* client output queue type */
+    msgbuf_t **buf;         /* ring buffer of queued messages */
+    int size;               /* size of ring buffer (messages) */
+    int head,n;             /* head index and number of queued messages */
+    int off;                /* bytes sent of head message */
+    int nbyte;              /* queued bytes not sent */
+    int npeak;              /* peak number of queued messages */
+    int err;                /* send error in flush */
+    int pollout;            /* polling socket writable */
+    uint32_t ndrop;         /* number of dropped messages */
+} cliq_t;
+
 typedef struct tcpsvr_tag { /* tcp server type */
     tcp_t svr;              /* tcp server control */
-    tcp_t cli[MAXCLI];      /* tcp client controls */
+    tcp_t *cli;             /* tcp client controls */
+    cliq_t *que;            /* client output queues */
+    int nmax;               /* number of client controls allocated */
+    int epfd;               /* epoll descriptor (-1: no epoll) */
+    int acc;                /* server socket ready to accept */
+    int nrdy;               /* number of clients ready to receive */
+    int *rdy;               /* indexes of clients ready to receive */
 } tcpsvr_t;
 
 typedef struct {            /* tcp cilent type */
@@ -189,11 +224,9 @@ typedef struct {            /* serial control type */
     dev_t dev;              /* serial device */
     int error;              /* error state */
 #ifdef WIN32
-    int state,wp,rp;        /* state,write/read pointer */
-    int buffsize;           /* write buffer size (bytes) */
+    int state;              /* state */
     HANDLE thread;          /* write thread */
-    rtklib_lock_t lock;     /* lock flag */
-    uint8_t *buff;          /* write buffer */
+    ring_t ring;            /* write buffer (ring buffer of bytes) */
 #endif
     tcpsvr_t *tcpsvr;       /* tcp server for received stream */
 } serial_t;
@@ -216,7 +249,7 @@ typedef struct {            /* ntrip client/server connection type */
     char mntpnt[256];       /* mountpoint */
     char str[NTRIP_MAXSTR]; /* mountpoint string for server */
     int nb;                 /* request buffer size */
-    uint8_t buff[NTRIP_MAXRSP]; /* request buffer */
+    uint8_t *buff;          /* request buffer (NULL: not requesting) */
 } ntripc_con_t;
 
 typedef struct {            /* ntrip caster control type */
@@ -227,7 +260,8 @@ typedef struct {            /* ntrip caster control type */
     char passwd[256];       /* password */
     char srctbl[NTRIP_MAXSTR]; /* source table */
     tcpsvr_t *tcp;          /* tcp server */
-    ntripc_con_t con[MAXCLI]; /* ntrip client/server connections */
+    int ncon;               /* number of connections allocated */
+    ntripc_con_t *con;      /* ntrip client/server connections */
 } ntripc_t;
 
 typedef struct {            /* udp type */
@@ -277,8 +311,13 @@ static char localdir[1024]=""; /* local directory for ftp/http */
 static char proxyaddr[256]=""; /* http/ntrip/ftp proxy address */
 static uint32_t tick_master=0; /* time tick master for replay */
 static int fswapmargin=30;  /* file swap margin (s) */
+static int cliqlen  =CLIQLEN; /* client output queue length (messages) */
+static int cliqpol  =0;     /* client output queue policy (0:drop oldest,1:disconnect) */
 
-/* read/write serial buffer --------------------------------------------------*/
+/* read/write serial buffer ----------------------------------------------------
+* the stream writer is the only producer and the serial write thread the only
+* consumer of the ring buffer, so neither takes a lock
+*-----------------------------------------------------------------------------*/
 #ifdef WIN32
 static int readseribuff(serial_t *serial, uint8_t *buff, int nmax)
 {
@@ -286,33 +325,20 @@ static int readseribuff(serial_t *serial, uint8_t *buff, int nmax)
     
     tracet(5,"readseribuff: dev=%d\n",serial->dev);
     
-    rtklib_lock(&serial->lock);
-    for (ns=0;serial->rp!=serial->wp&&ns<nmax;ns++) {
-       buff[ns]=serial->buff[serial->rp];
-       if (++serial->rp>=serial->buffsize) serial->rp=0;
-    }
-    rtklib_unlock(&serial->lock);
-    tracet(5,"readseribuff: ns=%d rp=%d wp=%d\n",ns,serial->rp,serial->wp);
+    ns=ringread(&serial->ring,buff,nmax);
+    tracet(5,"readseribuff: ns=%d\n",ns);
     return ns;
 }
 static int writeseribuff(serial_t *serial, uint8_t *buff, int n)
 {
-    int ns,wp;
+    int ns;
     
     tracet(5,"writeseribuff: dev=%d n=%d\n",serial->dev,n);
     
-    rtklib_lock(&serial->lock);
-    for (ns=0;ns<n;ns++) {
-        serial->buff[wp=serial->wp]=buff[ns];
-        if (++wp>=serial->buffsize) wp=0;
-        if (wp!=serial->rp) serial->wp=wp;
-        else {
-            tracet(2,"serial buffer overflow: size=%d\n",serial->buffsize);
-            break;
-        }
+    if ((ns=ringwrite(&serial->ring,buff,n))<n) {
+        tracet(2,"serial buffer overflow: size=%d\n",(int)serial->ring.size);
     }
-    rtklib_unlock(&serial->lock);
-    tracet(5,"writeseribuff: ns=%d rp=%d wp=%d\n",ns,serial->rp,serial->wp);
+    tracet(5,"writeseribuff: ns=%d\n",ns);
     return ns;
 }
 #endif /* WIN32 */
@@ -337,7 +363,7 @@ static DWORD WINAPI serialthread(void *arg)
         if (!serial->state) break;
         sleepms(10-(int)(tickget()-tick)); /* cycle=10ms */
     }
-    free(serial->buff);
+    ringfree(&serial->ring);
     return 0;
 }
 #endif /* WIN32 */
@@ -438,10 +464,8 @@ static serial_t *openserial(const char *path, int mode, char *msg)
     PurgeComm(serial->dev,PURGE_TXABORT|PURGE_RXABORT|PURGE_TXCLEAR|PURGE_RXCLEAR);
     
     /* create write thread */
-    rtklib_initlock(&serial->lock);
-    serial->state=serial->wp=serial->rp=serial->error=0;
-    serial->buffsize=buffsize;
-    if (!(serial->buff=(uint8_t *)malloc(buffsize))) {
+    serial->state=serial->error=0;
+    if (!ringinit(&serial->ring,buffsize,1)) {
         CloseHandle(serial->dev);
         free(serial);
         return NULL;
@@ -452,6 +476,7 @@ static serial_t *openserial(const char *path, int mode, char *msg)
         tracet(1,"openserial: %s\n",msg);
         CloseHandle(serial->dev);
         serial->state=0;
+        ringfree(&serial->ring);
         free(serial);
         return NULL;
     }
@@ -585,9 +610,9 @@ static int statexserial(serial_t *serial, char *msg)
 #endif
     p+=sprintf(p,"  error   = %d\n",serial->error);
 #ifdef WIN32
-    p+=sprintf(p,"  buffsize= %d\n",serial->buffsize);
-    p+=sprintf(p,"  wp      = %d\n",serial->wp);
-    p+=sprintf(p,"  rp      = %d\n",serial->rp);
+    p+=sprintf(p,"  buffsize= %d\n",(int)serial->ring.size);
+    p+=sprintf(p,"  wp      = %u\n",serial->ring.wp);
+    p+=sprintf(p,"  rp      = %u\n",serial->ring.rp);
 #endif
     return state;
 }
@@ -1044,13 +1069,67 @@ static int setsock(socket_t sock, char *msg)
     }
     return 1;
 }
+/* set socket non-blocking ---------------------------------------------------*/
+static void setnonblock(socket_t sock)
+{
+#ifdef WIN32
+    u_long mode=1;
+    ioctlsocket(sock,FIONBIO,&mode);
+#else
+    fcntl(sock,F_SETFL,fcntl(sock,F_GETFL,0)|O_NONBLOCK);
+#endif
+}
+/* test socket readable/writable without blocking ----------------------------*/
+static int selsock(socket_t sock, int rd, int wr)
+{
+#ifdef USE_EPOLL
+    struct pollfd pfd={0};
+    pfd.fd=sock;
+    pfd.events=(rd?POLLIN:0)|(wr?POLLOUT:0);
+    return poll(&pfd,1,0);
+#else
+    struct timeval tv={0};
+    fd_set rs,ws;
+    FD_ZERO(&rs); FD_ZERO(&ws);
+    if (rd) FD_SET(sock,&rs);
+    if (wr) FD_SET(sock,&ws);
+    return select(sock+1,rd?&rs:NULL,wr?&ws:NULL,NULL,&tv);
+#endif
+}
+#ifdef USE_EPOLL
+/* receive without select and blocking ---------------------------------------*/
+static int recvsock(socket_t sock, uint8_t *buff, int n, int *err)
+{
+    int nr;
+    
+    *err=0;
+    if (n<=0) return 0;
+    if ((nr=recv(sock,(char *)buff,n,MSG_DONTWAIT))>0) return nr;
+    if (nr==0) return -1;
+    if (errno==EAGAIN||errno==EWOULDBLOCK||errno==EINTR) return 0;
+    *err=errsock();
+    return -1;
+}
+/* send without select -------------------------------------------------------*/
+static int sendsock(socket_t sock, uint8_t *buff, int n, int *err)
+{
+    int ns=send(sock,(char *)buff,n,MSG_DONTWAIT),m;
+    
+    *err=0;
+    if (ns<0) {
+        if (errno==EAGAIN||errno==EWOULDBLOCK||errno==EINTR) return 0;
+        *err=errsock();
+        return -1;
+    }
+    /* send rest by blocking send as send_nb() after select */
+    if (ns<n&&(m=send(sock,(char *)buff+ns,n-ns,0))>0) ns+=m;
+    return ns;
+}
+#endif
 /* non-block accept ----------------------------------------------------------*/
 static socket_t accept_nb(socket_t sock, struct sockaddr *addr, socklen_t *len, int *err)
 {
-    fd_set rs;
-    FD_ZERO(&rs); FD_SET(sock, &rs);
-    struct timeval tv = {0};
-    int ret = select(sock + 1, &rs, NULL, NULL, &tv);
+    int ret = selsock(sock, 1, 0);
     if (ret == 0) {
       *err = 0;
       return (socket_t)ret;
@@ -1085,10 +1164,7 @@ static int connect_nb(socket_t sock, struct sockaddr *addr, socklen_t len, int *
     if (connect(sock, addr, len) == -1) {
         *err = errsock();
         if (*err != EISCONN && *err != EINPROGRESS && *err != EALREADY) return -1;
-        fd_set rs, ws;
-        FD_ZERO(&rs); FD_SET(sock, &rs); ws = rs;
-        struct timeval tv = {0};
-        if (select(sock + 1, &rs, &ws, NULL, &tv) == 0) {
+        if (selsock(sock, 1, 1) == 0) {
           *err = 0;
           return 0;
         }
@@ -1102,10 +1178,10 @@ static int connect_nb(socket_t sock, struct sockaddr *addr, socklen_t len, int *
 /* non-block receive ---------------------------------------------------------*/
 static int recv_nb(socket_t sock, uint8_t *buff, int n, int *err)
 {
-    fd_set rs;
-    FD_ZERO(&rs); FD_SET(sock, &rs);
-    struct timeval tv = {0};
-    int ret = select(sock + 1, &rs, NULL, NULL, &tv);
+#ifdef USE_EPOLL
+    return recvsock(sock, buff, n, err);
+#else
+    int ret = selsock(sock, 1, 0);
     if (ret < 0) {
       *err = errsock();
       return ret;
@@ -1125,14 +1201,15 @@ static int recv_nb(socket_t sock, uint8_t *buff, int n, int *err)
     }
     *err = 0;
     return nr;
+#endif
 }
 /* non-block send ------------------------------------------------------------*/
 static int send_nb(socket_t sock, uint8_t *buff, int n, int *err)
 {
-    fd_set ws;
-    FD_ZERO(&ws); FD_SET(sock, &ws);
-    struct timeval tv = {0};
-    int ret = select(sock + 1, NULL, &ws, NULL, &tv);
+#ifdef USE_EPOLL
+    return sendsock(sock, buff, n, err);
+#else
+    int ret = selsock(sock, 0, 1);
     if (ret < 0) {
       *err = errsock();
       return ret;
@@ -1148,6 +1225,7 @@ static int send_nb(socket_t sock, uint8_t *buff, int n, int *err)
     }
     *err = 0;
     return ns;
+#endif
 }
 /* generate tcp socket -------------------------------------------------------*/
 static int gentcp(tcp_t *tcp, int type, char *msg)
@@ -1199,7 +1277,7 @@ static int gentcp(tcp_t *tcp, int type, char *msg)
             tcp->state=-1;
             return 0;
         }
-        listen(tcp->sock,5);
+        listen(tcp->sock,SOMAXCONN);
     }
     else { /* client socket */
         if (!(hp=gethostbyname(tcp->saddr))) {
@@ -1229,6 +1307,51 @@ static void discontcp(tcp_t *tcp, int tcon)
     tcp->tcon=tcon;
     tcp->tdis=tickget();
 }
+/* new shared message buffer -------------------------------------------------*/
+static msgbuf_t *newmsgbuf(const uint8_t *buff, int n)
+{
+    msgbuf_t *m;
+    
+    if (!(m=(msgbuf_t *)malloc(sizeof(msgbuf_t)+n))) return NULL;
+    m->ref=0;
+    m->n=n;
+    m->tick=tickget();
+    m->data=(uint8_t *)(m+1);
+    memcpy(m->data,buff,n);
+    return m;
+}
+/* release shared message buffer ---------------------------------------------*/
+static void relmsgbuf(msgbuf_t *m)
+{
+    if (--m->ref<=0) free(m);
+}
+/* drop oldest message not in sending from client output queue ---------------*/
+static void dropcliq(cliq_t *q)
+{
+    msgbuf_t *m=q->buf[q->head];
+    int j;
+    
+    if (q->off>0) { /* keep head message partly sent */
+        j=(q->head+1)%q->size;
+        m=q->buf[j];
+        q->buf[j]=q->buf[q->head];
+    }
+    q->head=(q->head+1)%q->size;
+    q->n--;
+    q->nbyte-=m->n;
+    q->ndrop++;
+    relmsgbuf(m);
+}
+/* clear client output queue -------------------------------------------------*/
+static void clearcliq(cliq_t *q)
+{
+    cliq_t q0={0};
+    int i;
+    
+    for (i=0;i<q->n;i++) relmsgbuf(q->buf[(q->head+i)%q->size]);
+    free(q->buf);
+    *q=q0;
+}
 /* open tcp server -----------------------------------------------------------*/
 static tcpsvr_t *opentcpsvr(const char *path, char *msg)
 {
@@ -1239,6 +1362,7 @@ static tcpsvr_t *opentcpsvr(const char *path, char *msg)
     
     if (!(tcpsvr=(tcpsvr_t *)malloc(sizeof(tcpsvr_t)))) return NULL;
     *tcpsvr=tcpsvr0;
+    tcpsvr->epfd=-1;
     decodetcppath(path,tcpsvr->svr.saddr,port,NULL,NULL,NULL,NULL);
     if (sscanf(port,"%d",&tcpsvr->svr.port)<1) {
         sprintf(msg,"port error: %s",port);
@@ -1246,10 +1370,33 @@ static tcpsvr_t *opentcpsvr(const char *path, char *msg)
         free(tcpsvr);
         return NULL;
     }
+    if (!(tcpsvr->cli=(tcp_t *)calloc(NCLIALLOC,sizeof(tcp_t)))||
+        !(tcpsvr->que=(cliq_t *)calloc(NCLIALLOC,sizeof(cliq_t)))||
+        !(tcpsvr->rdy=(int *)malloc(sizeof(int)*NCLIALLOC))) {
+        free(tcpsvr->cli); free(tcpsvr->que);
+        free(tcpsvr);
+        return NULL;
+    }
+    tcpsvr->nmax=NCLIALLOC;
+    
     if (!gentcp(&tcpsvr->svr,0,msg)) {
+        free(tcpsvr->cli); free(tcpsvr->que); free(tcpsvr->rdy);
         free(tcpsvr);
         return NULL;
     }
+#ifdef USE_EPOLL
+    /* register server socket to epoll (fallback to select on error) */
+    if ((tcpsvr->epfd=epoll_create(NCLIALLOC))>=0) {
+        struct epoll_event ev={0};
+        ev.events=EPOLLIN;
+        ev.data.u32=(uint32_t)-1;
+        if (epoll_ctl(tcpsvr->epfd,EPOLL_CTL_ADD,tcpsvr->svr.sock,&ev)<0) {
+            tracet(2,"opentcpsvr: epoll_ctl error err=%d\n",errsock());
+            close(tcpsvr->epfd);
+            tcpsvr->epfd=-1;
+        }
+    }
+#endif
     tcpsvr->svr.tcon=0;
     return tcpsvr;
 }
@@ -1260,25 +1407,31 @@ static void closetcpsvr(tcpsvr_t *tcpsvr)
     
     tracet(3,"closetcpsvr:\n");
     
-    for (i=0;i<MAXCLI;i++) {
+    for (i=0;i<tcpsvr->nmax;i++) {
         if (tcpsvr->cli[i].state) closesocket(tcpsvr->cli[i].sock);
+        clearcliq(tcpsvr->que+i);
     }
     closesocket(tcpsvr->svr.sock);
+#ifdef USE_EPOLL
+    if (tcpsvr->epfd>=0) close(tcpsvr->epfd);
+#endif
+    free(tcpsvr->cli);
+    free(tcpsvr->que);
+    free(tcpsvr->rdy);
     free(tcpsvr);
 }
 /* update tcp server ---------------------------------------------------------*/
 static void updatetcpsvr(tcpsvr_t *tcpsvr, char *msg)
 {
-    char saddr[256]="";
-    int i,n=0;
+    int i,j=0,n=0;
     
     tracet(4,"updatetcpsvr: state=%d\n",tcpsvr->svr.state);
     
     if (tcpsvr->svr.state==0) return;
     
-    for (i=0;i<MAXCLI;i++) {
+    for (i=0;i<tcpsvr->nmax;i++) {
         if (!tcpsvr->cli[i].state) continue;
-        strcpy(saddr,tcpsvr->cli[i].saddr);
+        j=i;
         n++;
     }
     if (n==0) {
@@ -1287,7 +1440,30 @@ static void updatetcpsvr(tcpsvr_t *tcpsvr, char *msg)
         return;
     }
     tcpsvr->svr.state=2;
-    if (n==1) sprintf(msg,"%s",saddr); else sprintf(msg,"%d clients",n);
+    if (n==1) sprintf(msg,"%s",tcpsvr->cli[j].saddr); else sprintf(msg,"%d clients",n);
+}
+/* expand client controls of tcp server --------------------------------------*/
+static int growtcpsvr(tcpsvr_t *tcpsvr)
+{
+    tcp_t *cli;
+    cliq_t *que;
+    int *rdy,nmax=tcpsvr->nmax*2;
+    
+    if (nmax>MAXCLI) nmax=MAXCLI;
+    if (nmax<=tcpsvr->nmax) return 0;
+    
+    if (!(cli=(tcp_t *)realloc(tcpsvr->cli,sizeof(tcp_t)*nmax))) return 0;
+    tcpsvr->cli=cli;
+    if (!(que=(cliq_t *)realloc(tcpsvr->que,sizeof(cliq_t)*nmax))) return 0;
+    tcpsvr->que=que;
+    if (!(rdy=(int *)realloc(tcpsvr->rdy,sizeof(int)*nmax))) return 0;
+    tcpsvr->rdy=rdy;
+    memset(tcpsvr->cli+tcpsvr->nmax,0,sizeof(tcp_t)*(nmax-tcpsvr->nmax));
+    memset(tcpsvr->que+tcpsvr->nmax,0,sizeof(cliq_t)*(nmax-tcpsvr->nmax));
+    
+    tracet(3,"growtcpsvr: nmax=%d->%d\n",tcpsvr->nmax,nmax);
+    tcpsvr->nmax=nmax;
+    return 1;
 }
 /* accept client connection --------------------------------------------------*/
 static int accsock(tcpsvr_t *tcpsvr, char *msg)
@@ -1299,11 +1475,15 @@ static int accsock(tcpsvr_t *tcpsvr, char *msg)
     
     tracet(4,"accsock: sock=%d\n",tcpsvr->svr.sock);
     
-    for (i=0;i<MAXCLI;i++) {
+    for (i=0;i<tcpsvr->nmax;i++) {
         if (tcpsvr->cli[i].state==0) break;
     }
-    if (i>=MAXCLI) {
+    if (i>=tcpsvr->nmax&&!growtcpsvr(tcpsvr)) {
         tracet(2,"accsock: too many clients sock=%d\n",tcpsvr->svr.sock);
+        
+        /* refuse pending connection not to keep listening socket readable */
+        sock=accept_nb(tcpsvr->svr.sock,(struct sockaddr *)&addr,&len,&err);
+        if (sock!=(socket_t)-1&&sock!=0) closesocket(sock);
         return 0;
     }
     if ((sock=accept_nb(tcpsvr->svr.sock,(struct sockaddr *)&addr,&len,&err))==(socket_t)-1) {
@@ -1315,7 +1495,27 @@ static int accsock(tcpsvr_t *tcpsvr, char *msg)
     }
     if (sock==0) return 0;
     if (!setsock(sock,msg)) return 0;
-    
+    setnonblock(sock);
+    
+#ifdef USE_EPOLL
+    if (tcpsvr->epfd>=0) {
+        struct epoll_event ev={0};
+        ev.events=EPOLLIN;
+        ev.data.u32=(uint32_t)i;
+        if (epoll_ctl(tcpsvr->epfd,EPOLL_CTL_ADD,sock,&ev)<0) {
+            tracet(1,"accsock: epoll_ctl error sock=%d err=%d\n",sock,errsock());
+            closesocket(sock);
+            return 0;
+        }
+    }
+#endif
+#ifndef WIN32
+    if (tcpsvr->epfd<0&&sock>=FD_SETSIZE) { /* out of fd_set for select */
+        tracet(2,"accsock: too many clients sock=%d\n",sock);
+        closesocket(sock);
+        return 0;
+    }
+#endif
     tcpsvr->cli[i].sock=sock;
     memcpy(&tcpsvr->cli[i].addr,&addr,sizeof(addr));
     strcpy(tcpsvr->cli[i].saddr,inet_ntoa(addr.sin_addr));
@@ -1326,6 +1526,159 @@ static int accsock(tcpsvr_t *tcpsvr, char *msg)
     tcpsvr->cli[i].tact=tickget();
     return 1;
 }
+/* set polling tcp server client socket writable -----------------------------*/
+static void pollouttcpsvr(tcpsvr_t *tcpsvr, int i, int pollout)
+{
+#ifdef USE_EPOLL
+    struct epoll_event ev={0};
+    
+    if (tcpsvr->epfd<0||tcpsvr->que[i].pollout==pollout) return;
+    
+    ev.events=EPOLLIN|(pollout?EPOLLOUT:0);
+    ev.data.u32=(uint32_t)i;
+    if (epoll_ctl(tcpsvr->epfd,EPOLL_CTL_MOD,tcpsvr->cli[i].sock,&ev)<0) {
+        tracet(2,"pollouttcpsvr: epoll_ctl error sock=%d err=%d\n",
+               tcpsvr->cli[i].sock,errsock());
+        return;
+    }
+    tcpsvr->que[i].pollout=pollout;
+#else
+    (void)tcpsvr; (void)i; (void)pollout;
+#endif
+}
+/* disconnect tcp server client ----------------------------------------------*/
+static void disctcpsvr(tcpsvr_t *tcpsvr, int i)
+{
+    discontcp(&tcpsvr->cli[i],ticonnect);
+    clearcliq(tcpsvr->que+i);
+}
+/* flush client output queue of tcp server -----------------------------------*/
+static int flushtcpsvr(tcpsvr_t *tcpsvr, int i)
+{
+    cliq_t *q=tcpsvr->que+i;
+    msgbuf_t *m;
+    int ns,err;
+    
+    if (q->err) return -1;
+    
+    while (q->n>0) {
+        m=q->buf[q->head];
+        if ((ns=send_nb(tcpsvr->cli[i].sock,m->data+q->off,m->n-q->off,&err))<0) {
+            tracet(2,"flushtcpsvr: send error i=%d sock=%d err=%d\n",i,
+                   tcpsvr->cli[i].sock,err);
+            q->err=1;
+            pollouttcpsvr(tcpsvr,i,0);
+            return -1;
+        }
+        if (ns>0) tcpsvr->cli[i].tact=tickget();
+        q->off+=ns;
+        q->nbyte-=ns;
+        if (q->off<m->n) return q->n;
+        relmsgbuf(m);
+        q->head=(q->head+1)%q->size;
+        q->n--;
+        q->off=0;
+    }
+    pollouttcpsvr(tcpsvr,i,0);
+    return 0;
+}
+/* output message to tcp server client -----------------------------------------
+* send message to the client without blocking and queue the rest to the client
+* output queue. the messages queued before are flushed first. if the queue is
+* full, the oldest message not in sending is dropped (cliqpol=0) or error is
+* returned to disconnect the client (cliqpol=1). the message buffer is shared
+* by the queues of all the clients and allocated at the first queueing.
+* args   : tcpsvr_t *tcpsvr IO  tcp server
+*          int    i         I   client index
+*          uint8_t *buff    I   message
+*          int    n         I   message length (bytes)
+*          msgbuf_t **mbuf  IO  shared message buffer (NULL: not allocated)
+* return : status (1:sent or queued,0:not queued,-1:error)
+*-----------------------------------------------------------------------------*/
+static int outtcpsvr(tcpsvr_t *tcpsvr, int i, uint8_t *buff, int n,
+                     msgbuf_t **mbuf)
+{
+    cliq_t *q=tcpsvr->que+i;
+    int ns=0,err;
+    
+    if (q->n>0&&flushtcpsvr(tcpsvr,i)<0) return -1;
+    
+    if (q->n==0) {
+        if ((ns=send_nb(tcpsvr->cli[i].sock,buff,n,&err))<0) {
+            tracet(2,"outtcpsvr: send error i=%d sock=%d err=%d\n",i,
+                   tcpsvr->cli[i].sock,err);
+            return -1;
+        }
+        if (ns>0) tcpsvr->cli[i].tact=tickget();
+        if (ns>=n) return 1;
+    }
+    if (!q->buf) {
+        if (!(q->buf=(msgbuf_t **)malloc(sizeof(msgbuf_t *)*cliqlen))) {
+            return ns>0?-1:0;
+        }
+        q->size=cliqlen;
+    }
+    if (q->n>=q->size) { /* queue full */
+        if (cliqpol) {
+            tracet(2,"outtcpsvr: queue full i=%d sock=%d\n",i,tcpsvr->cli[i].sock);
+            return -1;
+        }
+        dropcliq(q);
+    }
+    if (!*mbuf&&!(*mbuf=newmsgbuf(buff,n))) return ns>0?-1:0;
+    
+    (*mbuf)->ref++;
+    q->buf[(q->head+q->n++)%q->size]=*mbuf;
+    if (q->n==1) q->off=ns;
+    q->nbyte+=n-ns;
+    if (q->n>q->npeak) q->npeak=q->n;
+    pollouttcpsvr(tcpsvr,i,1);
+    return 1;
+}
+/* poll tcp server sockets -----------------------------------------------------
+* poll the server and client sockets of tcp server without blocking, set the
+* accept flag and the indexes of the clients ready to receive and flush the
+* client output queues. by epoll, only the sockets with events are returned
+* (level-triggered, so the clients not read are returned again by the next
+* poll) and the queues are flushed when the sockets get writable. without
+* epoll, all the connected clients are returned and each of them is checked
+* by select in recv_nb().
+*-----------------------------------------------------------------------------*/
+static void polltcpsvr(tcpsvr_t *tcpsvr)
+{
+    int i,j;
+    
+    tcpsvr->acc=1;
+    tcpsvr->nrdy=0;
+#ifdef USE_EPOLL
+    if (tcpsvr->epfd>=0) {
+        struct epoll_event ev[MAXSOCKEV];
+        int n=epoll_wait(tcpsvr->epfd,ev,MAXSOCKEV,0);
+        
+        tcpsvr->acc=0;
+        for (i=0;i<n;i++) {
+            if (ev[i].data.u32==(uint32_t)-1) {
+                tcpsvr->acc=1;
+                continue;
+            }
+            if (ev[i].data.u32>=(uint32_t)tcpsvr->nmax) continue;
+            j=(int)ev[i].data.u32;
+            if (tcpsvr->cli[j].state!=2) continue;
+            if (ev[i].events&EPOLLOUT) flushtcpsvr(tcpsvr,j);
+            if (ev[i].events&(EPOLLIN|EPOLLHUP|EPOLLERR)) {
+                tcpsvr->rdy[tcpsvr->nrdy++]=j;
+            }
+        }
+        return;
+    }
+#endif
+    for (i=0;i<tcpsvr->nmax;i++) {
+        if (tcpsvr->cli[i].state!=2) continue;
+        if (tcpsvr->que[i].n>0) flushtcpsvr(tcpsvr,i);
+        tcpsvr->rdy[tcpsvr->nrdy++]=i;
+    }
+    (void)j;
+}
 /* wait socket accept --------------------------------------------------------*/
 static int waittcpsvr(tcpsvr_t *tcpsvr, char *msg)
 {
@@ -1333,21 +1686,25 @@ static int waittcpsvr(tcpsvr_t *tcpsvr, char *msg)
     
     if (tcpsvr->svr.state<=0) return 0;
     
-    while (accsock(tcpsvr,msg)) ;
+    polltcpsvr(tcpsvr);
     
+    if (tcpsvr->acc) {
+        while (accsock(tcpsvr,msg)) ;
+    }
     updatetcpsvr(tcpsvr,msg);
     return tcpsvr->svr.state==2;
 }
 /* read tcp server -----------------------------------------------------------*/
 static int readtcpsvr(tcpsvr_t *tcpsvr, uint8_t *buff, int n, char *msg)
 {
-    int i,nr,err;
+    int i,j,nr,err;
     
     tracet(4,"readtcpsvr: state=%d\n",tcpsvr->svr.state);
     
     if (!waittcpsvr(tcpsvr,msg)) return 0;
     
-    for (i=0;i<MAXCLI;i++) {
+    for (j=0;j<tcpsvr->nrdy;j++) {
+        i=tcpsvr->rdy[j];
         if (tcpsvr->cli[i].state!=2) continue;
         
         if ((nr=recv_nb(tcpsvr->cli[i].sock,buff,n,&err))==-1) {
@@ -1355,7 +1712,7 @@ static int readtcpsvr(tcpsvr_t *tcpsvr, uint8_t *buff, int n, char *msg)
                 tracet(2,"readtcpsvr: recv error sock=%d err=%d\n",
                        tcpsvr->cli[i].sock,err);
             }
-            discontcp(&tcpsvr->cli[i],ticonnect);
+            disctcpsvr(tcpsvr,i);
             updatetcpsvr(tcpsvr,msg);
         }
         if (nr>0) {
@@ -1368,29 +1725,24 @@ static int readtcpsvr(tcpsvr_t *tcpsvr, uint8_t *buff, int n, char *msg)
 /* write tcp server ----------------------------------------------------------*/
 static int writetcpsvr(tcpsvr_t *tcpsvr, uint8_t *buff, int n, char *msg)
 {
-    int i,ns=0,nmax=0,err;
+    msgbuf_t *mbuf=NULL;
+    int i,stat,ns=0;
     
     tracet(4,"writetcpsvr: state=%d n=%d\n",tcpsvr->svr.state,n);
     
     if (!waittcpsvr(tcpsvr,msg)) return 0;
     
-    for (i=0;i<MAXCLI;i++) {
+    for (i=0;i<tcpsvr->nmax;i++) {
         if (tcpsvr->cli[i].state!=2) continue;
         
-        if ((ns=send_nb(tcpsvr->cli[i].sock,buff,n,&err))==-1) {
-            if (err) {
-                tracet(2,"writetcpsvr: send error i=%d sock=%d err=%d\n",i,
-                       tcpsvr->cli[i].sock,err);
-            }
-            discontcp(&tcpsvr->cli[i],ticonnect);
+        if ((stat=outtcpsvr(tcpsvr,i,buff,n,&mbuf))<0) {
+            disctcpsvr(tcpsvr,i);
             updatetcpsvr(tcpsvr,msg);
         }
-        else {
-            if (ns>nmax) nmax=ns;
-            if (ns>0) tcpsvr->cli[i].tact=tickget();
-        }
+        else if (stat>0) ns=n;
     }
-    return nmax;
+    if (mbuf&&mbuf->ref<=0) free(mbuf);
+    return ns;
 }
 /* get state tcp server ------------------------------------------------------*/
 static int statetcpsvr(tcpsvr_t *tcpsvr)
@@ -1413,21 +1765,68 @@ static int statextcp(tcp_t *tcp, char *msg)
 #endif
     return (int)(p-msg);
 }
+/* print extended state client output queue ----------------------------------*/
+static int statexcliq(const cliq_t *q, char *msg)
+{
+    char *p=msg;
+    int lag=q->n>0?(int)(tickget()-q->buf[q->head]->tick):0;
+    
+    p+=sprintf(p,"    qmsg  = %d\n",q->n);
+    p+=sprintf(p,"    qbyte = %d\n",q->nbyte);
+    p+=sprintf(p,"    qpeak = %d\n",q->npeak);
+    p+=sprintf(p,"    lag   = %d\n",lag);
+    p+=sprintf(p,"    drop  = %u\n",q->ndrop);
+    return (int)(p-msg);
+}
+/* print extended state summary of tcp server clients ------------------------*/
+static int statexclis(tcpsvr_t *tcpsvr, char *msg)
+{
+    const cliq_t *q;
+    char *p=msg;
+    int i,n=0,nmsg=0,nbyte=0,lag,lagmax=0,imax=-1;
+    uint32_t ndrop=0;
+    
+    for (i=0;i<tcpsvr->nmax;i++) {
+        if (!tcpsvr->cli[i].state) continue;
+        q=tcpsvr->que+i;
+        n++;
+        nmsg+=q->n;
+        nbyte+=q->nbyte;
+        ndrop+=q->ndrop;
+        lag=q->n>0?(int)(tickget()-q->buf[q->head]->tick):0;
+        if (lag>lagmax) {
+            lagmax=lag;
+            imax=i;
+        }
+    }
+    p+=sprintf(p,"  ncli    = %d\n",n);
+    p+=sprintf(p,"  qlen    = %d\n",cliqlen);
+    p+=sprintf(p,"  qpolicy = %d\n",cliqpol);
+    p+=sprintf(p,"  qmsg    = %d\n",nmsg);
+    p+=sprintf(p,"  qbyte   = %d\n",nbyte);
+    p+=sprintf(p,"  lagmax  = %d\n",lagmax);
+    p+=sprintf(p,"  lagcli  = %d\n",imax);
+    p+=sprintf(p,"  drop    = %u\n",ndrop);
+    return (int)(p-msg);
+}
 /* get extended state tcp server ---------------------------------------------*/
 static int statextcpsvr(tcpsvr_t *tcpsvr, char *msg)
 {
     char *p=msg;
-    int i,state=tcpsvr?tcpsvr->svr.state:0;
+    int i,n=0,state=tcpsvr?tcpsvr->svr.state:0;
     
     p+=sprintf(p,"tcpsvr:\n");
     p+=sprintf(p,"  state   = %d\n",state);
     if (!state) return 0;
+    p+=statexclis(tcpsvr,p);
     p+=sprintf(p,"  svr:\n");
     p+=statextcp(&tcpsvr->svr,p);
-    for (i=0;i<MAXCLI;i++) {
+    for (i=0;i<tcpsvr->nmax&&n<MAXSTATCLI;i++) {
         if (!tcpsvr->cli[i].state) continue;
         p+=sprintf(p,"  cli#%d:\n",i);
         p+=statextcp(tcpsvr->cli+i,p);
+        p+=statexcliq(tcpsvr->que+i,p);
+        n++;
     }
     return state;
 }
@@ -1879,7 +2278,6 @@ static int statexntrip(ntrip_t *ntrip, char *msg)
 static ntripc_t *openntripc(const char *path, char *msg)
 {
     ntripc_t *ntripc;
-    int i;
     char port[256]="",tpath[MAXSTRPATH];
     
     tracet(3,"openntripc: path=%s\n",path);
@@ -1888,11 +2286,9 @@ static ntripc_t *openntripc(const char *path, char *msg)
     
     ntripc->state=0;
     ntripc->mntpnt[0]=ntripc->user[0]=ntripc->passwd[0]=ntripc->srctbl[0]='\0';
-    for (i=0;i<MAXCLI;i++) {
-        ntripc->con[i].state=0;
-        ntripc->con[i].nb=0;
-        memset(ntripc->con[i].buff,0,NTRIP_MAXRSP);
-    }
+    ntripc->ncon=0;
+    ntripc->con=NULL;
+    
     /* decode tcp/ntrip path */
     decodetcppath(path,NULL,port,ntripc->user,ntripc->passwd,ntripc->mntpnt,
                   ntripc->srctbl);
@@ -1919,19 +2315,40 @@ static ntripc_t *openntripc(const char *path, char *msg)
 /* close ntrip-caster --------------------------------------------------------*/
 static void closentripc(ntripc_t *ntripc)
 {
+    int i;
+    
     tracet(3,"closentripc: state=%d\n",ntripc->state);
     
     closetcpsvr(ntripc->tcp);
+    for (i=0;i<ntripc->ncon;i++) free(ntripc->con[i].buff);
+    free(ntripc->con);
     free(ntripc);
 }
+/* expand connections of ntrip-caster to clients of tcp server ---------------*/
+static int growntripc(ntripc_t *ntripc)
+{
+    ntripc_con_t *con;
+    int nmax=ntripc->tcp->nmax;
+    
+    if (nmax<=ntripc->ncon) return ntripc->ncon;
+    
+    if (!(con=(ntripc_con_t *)realloc(ntripc->con,sizeof(ntripc_con_t)*nmax))) {
+        return ntripc->ncon;
+    }
+    memset(con+ntripc->ncon,0,sizeof(ntripc_con_t)*(nmax-ntripc->ncon));
+    ntripc->con=con;
+    ntripc->ncon=nmax;
+    return nmax;
+}
 /* disconnect ntrip-caster connection ----------------------------------------*/
 static void discon_ntripc(ntripc_t *ntripc, int i)
 {
     tracet(3,"discon_ntripc: i=%d\n",i);
     
-    discontcp(&ntripc->tcp->cli[i],ticonnect);
+    disctcpsvr(ntripc->tcp,i);
+    free(ntripc->con[i].buff);
+    ntripc->con[i].buff=NULL;
     ntripc->con[i].nb=0;
-    ntripc->con[i].buff[0]='\0';
     ntripc->con[i].state=0;
 }
 /* send ntrip source table ---------------------------------------------------*/
@@ -2015,12 +2432,15 @@ static void rsp_ntripc(ntripc_t *ntripc, int i)
     
     con->state=1;
     strcpy(con->mntpnt,mntpnt);
+    free(con->buff);
+    con->buff=NULL;
+    con->nb=0;
 }
 /* handle ntrip client connect request ---------------------------------------*/
 static void wait_ntripc(ntripc_t *ntripc, char *msg)
 {
     uint8_t *buff;
-    int i,n,nmax,err;
+    int i,j,n,nmax,ncon,err;
     
     tracet(4,"wait_ntripc\n");
     
@@ -2028,9 +2448,18 @@ static void wait_ntripc(ntripc_t *ntripc, char *msg)
     
     if (!waittcpsvr(ntripc->tcp,msg)) return;
     
-    for (i=0;i<MAXCLI;i++) {
-        if (ntripc->tcp->cli[i].state!=2||ntripc->con[i].state) continue;
+    ncon=growntripc(ntripc);
+    
+    for (j=0;j<ntripc->tcp->nrdy;j++) {
+        i=ntripc->tcp->rdy[j];
+        if (i>=ncon||ntripc->tcp->cli[i].state!=2||ntripc->con[i].state) continue;
         
+        /* allocate request buffer while requesting */
+        if (!ntripc->con[i].buff&&
+            !(ntripc->con[i].buff=(uint8_t *)malloc(NTRIP_MAXRSP))) {
+            discon_ntripc(ntripc,i);
+            continue;
+        }
         /* receive ntrip client request */
         buff=ntripc->con[i].buff+ntripc->con[i].nb;
         nmax=NTRIP_MAXRSP-ntripc->con[i].nb-1;
@@ -2053,14 +2482,15 @@ static void wait_ntripc(ntripc_t *ntripc, char *msg)
 /* read ntrip-caster ---------------------------------------------------------*/
 static int readntripc(ntripc_t *ntripc, uint8_t *buff, int n, char *msg)
 {
-    int i,nr,err;
+    int i,j,nr,err;
     
     tracet(4,"readntripc:\n");
     
     wait_ntripc(ntripc,msg);
     
-    for (i=0;i<MAXCLI;i++) {
-        if (!ntripc->con[i].state) continue;
+    for (j=0;j<ntripc->tcp->nrdy;j++) {
+        i=ntripc->tcp->rdy[j];
+        if (i>=ntripc->ncon||!ntripc->con[i].state) continue;
         
         nr=recv_nb(ntripc->tcp->cli[i].sock,buff,n,&err);
         
@@ -2081,28 +2511,22 @@ static int readntripc(ntripc_t *ntripc, uint8_t *buff, int n, char *msg)
 /* write ntrip-caster --------------------------------------------------------*/
 static int writentripc(ntripc_t *ntripc, uint8_t *buff, int n, char *msg)
 {
-    int i,ns=0,err;
+    msgbuf_t *mbuf=NULL;
+    int i,stat,ns=0;
 
     tracet(4,"writentripc: n=%d\n",n);
     
     wait_ntripc(ntripc,msg);
     
-    for (i=0;i<MAXCLI;i++) {
+    for (i=0;i<ntripc->ncon;i++) {
         if (!ntripc->con[i].state) continue;
         
-        ns=send_nb(ntripc->tcp->cli[i].sock,buff,n,&err);
-        
-        if (ns<n) {
-            if (err) {
-                tracet(2,"writentripc: send error i=%d sock=%d err=%d\n",i,
-                       ntripc->tcp->cli[i].sock,err);
-            }
+        if ((stat=outtcpsvr(ntripc->tcp,i,buff,n,&mbuf))<0) {
             discon_ntripc(ntripc,i);
         }
-        else {
-            ntripc->tcp->cli[i].tact=tickget();
-        }
+        else if (stat>0) ns=n;
     }
+    if (mbuf&&mbuf->ref<=0) free(mbuf);
     return ns;
 }
 /* get state ntrip-caster ----------------------------------------------------*/
@@ -2114,7 +2538,7 @@ static int statentripc(ntripc_t *ntripc)
 static int statexntripc(ntripc_t *ntripc, char *msg)
 {
     char *p=msg;
-    int i,state=!ntripc?0:ntripc->state;
+    int i,n=0,state=!ntripc?0:ntripc->state;
     
     p+=sprintf(p,"ntripc:\n");
     p+=sprintf(p,"  state   = %d\n",ntripc->state);
@@ -2124,14 +2548,17 @@ static int statexntripc(ntripc_t *ntripc, char *msg)
     p+=sprintf(p,"  user    = %s\n",ntripc->user);
     p+=sprintf(p,"  passwd  = %s\n",ntripc->passwd);
     p+=sprintf(p,"  srctbl  = %s\n",ntripc->srctbl);
+    p+=statexclis(ntripc->tcp,p);
     p+=sprintf(p,"  svr:\n");
     p+=statextcp(&ntripc->tcp->svr,p);
-    for (i=0;i<MAXCLI;i++) {
+    for (i=0;i<ntripc->ncon&&n<MAXSTATCLI;i++) {
         if (!ntripc->tcp->cli[i].state) continue;
         p+=sprintf(p,"  cli#%d:\n",i);
         p+=statextcp(ntripc->tcp->cli+i,p);
         p+=sprintf(p,"    mntpnt= %s\n",ntripc->con[i].mntpnt);
         p+=sprintf(p,"    nb    = %d\n",ntripc->con[i].nb);
+        p+=statexcliq(ntripc->tcp->que+i,p);
+        n++;
     }
     return state;
 }
@@ -2223,17 +2650,26 @@ static void closeudpsvr(udp_t *udpsvr)
 static int readudpsvr(udp_t *udpsvr, uint8_t *buff, int n, char *msg)
 {
     (void)msg;
-    struct timeval tv={0};
-    fd_set rs;
-    int ret,nr;
+    int nr;
     
     tracet(4,"readudpsvr: sock=%d n=%d\n",udpsvr->sock,n);
     
+#ifdef USE_EPOLL
+    if ((nr=recvfrom(udpsvr->sock,(char *)buff,n,MSG_DONTWAIT,NULL,NULL))<0) {
+        return errno==EAGAIN||errno==EWOULDBLOCK||errno==EINTR?0:-1;
+    }
+    return nr==0?-1:nr;
+#else
+    struct timeval tv={0};
+    fd_set rs;
+    int ret;
+    
     FD_ZERO(&rs); FD_SET(udpsvr->sock,&rs);
     ret=select(udpsvr->sock+1,&rs,NULL,NULL,&tv);
     if (ret<=0) return ret;
     nr=recvfrom(udpsvr->sock,(char *)buff,n,0,NULL,NULL);
     return nr<=0?-1:nr;
+#endif
 }
 /* get state udp server ------------------------------------------------------*/
 static int stateudpsvr(udp_t *udpsvr)
@@ -2949,6 +3385,67 @@ int strread(stream_t *stream, uint8_t *buff, int n)
     strunlock(stream);
     return nr;
 }
+#ifndef WIN32
+/* get descriptor to wait stream input (-1:no descriptor,-2:data buffered) ---*/
+static int waitfdstr(stream_t *stream)
+{
+    tcpcli_t *tcpcli;
+    ntrip_t *ntrip;
+    
+    switch (stream->type) {
+        case STR_SERIAL  : return ((serial_t *)stream->port)->dev;
+        case STR_TCPSVR  : return ((tcpsvr_t *)stream->port)->epfd;
+        case STR_NTRIPCAS: return ((ntripc_t *)stream->port)->tcp->epfd;
+        case STR_UDPSVR  : return ((udp_t    *)stream->port)->sock;
+        case STR_TCPCLI  : tcpcli=(tcpcli_t *)stream->port; break;
+        case STR_NTRIPSVR:
+        case STR_NTRIPCLI:
+            ntrip=(ntrip_t *)stream->port;
+            if (ntrip->state==2&&ntrip->nb>0) return -2;
+            tcpcli=ntrip->tcp;
+            break;
+        default: return -1;
+    }
+    return tcpcli->svr.state==2?tcpcli->svr.sock:-1;
+}
+#endif
+/* wait stream input -----------------------------------------------------------
+* wait until any of the streams has input data or timeout
+* args   : stream_t *stream I  streams
+*          int    n         I  number of streams
+*          int    timeout   I  timeout (ms) (<=0: no wait)
+* return : status (1:input ready,0:timeout)
+* notes  : serial, tcp client, ntrip server/client, udp server and tcp server
+*          or ntrip caster with epoll are waited for. the other streams (file,
+*          memory buffer, ftp, connecting tcp client, ...) have no descriptor
+*          to wait and are read by strread() after timeout. on windows, the
+*          function just sleeps until timeout.
+*-----------------------------------------------------------------------------*/
+int strwait(stream_t *stream, int n, int timeout)
+{
+#ifdef WIN32
+    sleepms(timeout);
+    return 0;
+#else
+    struct pollfd pfd[MAXSTRWAIT];
+    int i,fd,nfd=0;
+    
+    tracet(4,"strwait: n=%d timeout=%d\n",n,timeout);
+    
+    for (i=0;i<n&&nfd<MAXSTRWAIT;i++) {
+        if (!(stream[i].mode&STR_MODE_R)||!stream[i].port) continue;
+        strlock(stream+i);
+        fd=stream[i].port?waitfdstr(stream+i):-1;
+        strunlock(stream+i);
+        if (fd==-2) return 1;
+        if (fd<0) continue;
+        pfd[nfd].fd=fd;
+        pfd[nfd].events=POLLIN;
+        pfd[nfd++].revents=0;
+    }
+    return poll(pfd,nfd,timeout>0?timeout:0)>0;
+#endif
+}
 /* write stream ----------------------------------------------------------------
 * write data to stream (unblocked)
 * args   : stream_t *stream I   stream
@@ -3108,8 +3605,8 @@ void strsum(stream_t *stream, int *inb, int *inr, int *outb, int *outr)
 *              opt[2]= averaging time of data rate (ms)
 *              opt[3]= receive/send buffer size (bytes);
 *              opt[4]= file swap margin (s)
-*              opt[5]= reserved
-*              opt[6]= reserved
+*              opt[5]= client output queue length (messages) (0:default)
+*              opt[6]= client output queue policy (0:drop oldest,1:disconnect)
 *              opt[7]= reserved
 * return : none
 *-----------------------------------------------------------------------------*/
@@ -3123,6 +3620,8 @@ void strsetopt(const int *opt)
     tirate     =opt[2]<100 ?100 :opt[2]; /* >=0.1s */
     buffsize   =opt[3]<4096?4096:opt[3]; /* >=4096byte */
     fswapmargin=opt[4]<0?0:opt[4];
+    cliqlen    =opt[5]<=0?CLIQLEN:(opt[5]<2?2:opt[5]); /* >=2 */
+    cliqpol    =opt[6];
 }
 /* set timeout time ------------------------------------------------------------
 * set timeout time
@@ -31,6 +31,7 @@
 *                           support multiple ephemeris sets (e.g. I/NAV-F/NAV)
 *                           delete API strsvrsetsrctbl()
 *                           use integer types in stdint.h
+*           2026/10/16 1.16 add api strsvrsetcliq()
 *-----------------------------------------------------------------------------*/
 #define _POSIX_C_SOURCE 200112L
 #include "rtklib.h"
@@ -424,9 +425,10 @@ static void write_sta_cycle(stream_t *str, strconv_t *conv)
 /* convert stearm ------------------------------------------------------------*/
 static void strconv(stream_t *str, strconv_t *conv, uint8_t *buff, int n)
 {
-    int i,ret;
+    int i,m,ret;
     
-    for (i=0;i<n;i++) {
+    for (i=0;i<n;i+=m) {
+        m=1;
         
         /* input rtcm 2 messages */
         if (conv->itype==STRFMT_RTCM2) {
@@ -435,12 +437,12 @@ static void strconv(stream_t *str, strconv_t *conv, uint8_t *buff, int n)
         }
         /* input rtcm 3 messages */
         else if (conv->itype==STRFMT_RTCM3) {
-            ret=input_rtcm3(&conv->rtcm,buff[i]);
+            ret=input_rtcm3_buf(&conv->rtcm,buff+i,n-i,&m);
             rtcm2rtcm(&conv->out,&conv->rtcm,ret,conv->stasel);
         }
         /* input receiver raw messages */
         else {
-            ret=input_raw(&conv->raw,conv->itype,buff[i]);
+            ret=input_raw_buf(&conv->raw,conv->itype,buff+i,n-i,&m);
             raw2rtcm(&conv->out,&conv->raw,ret);
         }
         /* write obs and nav data messages to stream */
@@ -577,6 +579,7 @@ void strsvrinit(strsvr_t *svr, int nout)
     svr->buffsize=0;
     svr->nmeacycle=0;
     svr->relayback=0;
+    svr->cliqlen=svr->cliqpol=0;
     svr->npb=0;
     for (i=0;i<16;i++) *svr->cmds_periodic[i]='\0';
     for (i=0;i<3;i++) svr->nmeapos[i]=0.0;
@@ -589,6 +592,22 @@ void strsvrinit(strsvr_t *svr, int nout)
     svr->thread=0;
     rtklib_initlock(&svr->lock);
 }
+/* set client output queue options of stream server ---------------------------
+* set output queue options of tcp server and ntrip caster clients of output
+* streams, applied by the next strsvrstart()
+* args   : strsvr_t *svr    IO  stream sever struct
+*          int    qlen      I   client output queue length (messages) (0:default)
+*          int    qpol      I   client output queue policy
+*                               (0:drop oldest,1:disconnect)
+* return : none
+*-----------------------------------------------------------------------------*/
+void strsvrsetcliq(strsvr_t *svr, int qlen, int qpol)
+{
+    tracet(3,"strsvrsetcliq: qlen=%d qpol=%d\n",qlen,qpol);
+    
+    svr->cliqlen=qlen;
+    svr->cliqpol=qpol;
+}
 /* start stream server ---------------------------------------------------------
 * start stream server
 * args   : strsvr_t *svr    IO  stream sever struct
@@ -654,6 +673,8 @@ int strsvrstart(strsvr_t *svr, int *opts, int *strs, const char **paths,
     
     for (i=0;i<4;i++) stropt[i]=opts[i];
     stropt[4]=opts[6];
+    stropt[5]=svr->cliqlen;
+    stropt[6]=svr->cliqpol;
     strsetopt(stropt);
     svr->cycle=opts[4];
     svr->buffsize=opts[3]<4096?4096:opts[3]; /* >=4096byte */
@@ -0,0 +1,319 @@
+/*------------------------------------------------------------------------------
+* rtklib benchmark : decoder throughput of receiver raw and RTCM formats
+*
+* usage : b_decode [-r nrep] [-t time] [-o jsonfile] [-l label] [-c basefile
+*                  [-x tol]] [format:file ...]
+*
+* replays the sample files of every stream format with a decoder (default the
+* test/data/rcvraw data and an RTCM 3 MSM4-7/ephemeris file generated from the
+* UBX data) by input_rtcm2f(), input_rtcm3f() or input_rawf() at least nrep
+* (default 3) times and time (default 500) ms. format is rtcm2, rtcm3 or the
+* format name of convbin -r option (nov,ubx,sbp,hemis,stq,javad,nvs,binex,
+* rt17,sbf,unicore,anpp). the formats without a file are reported with no
+* data. prints and writes to jsonfile (default b_decode.json) for each file:
+*
+*   MB/s, messages/s : replay throughput including file reading
+*   allocs, bytes    : heap allocations and allocated bytes per replay
+*   heap             : peak heap in use above the start of replay (bytes)
+*   rss              : peak resident set size of process (kB) (cumulative)
+*
+* the allocations are counted by the malloc() family replaced by this program
+* (glibc only, -1 otherwise). jsonfile has one result object per line with the
+* label (e.g. commit id). with -c, the MB/s are compared with the results of
+* the same format and file in basefile and it fails if any is lower than
+* (1-tol) (tol default 0.2) times the base.
+*-----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+#include "rtklib.h"
+#include "genrtcm3.h"
+
+#define MAXFILE     32
+#define TMPFILE     "b_decode_tmp.rtcm3"
+
+/* heap allocation counters --------------------------------------------------*/
+static int cntalloc=0;          /* allocations counted (glibc only) */
+static long nalloc=0;           /* number of allocations */
+static double nbyte=0.0;        /* allocated bytes */
+static size_t heap=0,heapmax=0; /* heap in use and peak (bytes) */
+
+#ifdef __GLIBC__
+#include <malloc.h>
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *p, size_t size);
+extern void __libc_free(void *p);
+
+/* count allocation ----------------------------------------------------------*/
+static void *addalloc(void *p)
+{
+    if (p) {
+        size_t size=malloc_usable_size(p);
+        nalloc++;
+        nbyte+=size;
+        heap+=size;
+        if (heap>heapmax) heapmax=heap;
+    }
+    return p;
+}
+void *malloc(size_t size)
+{
+    return addalloc(__libc_malloc(size));
+}
+void *calloc(size_t n, size_t size)
+{
+    return addalloc(__libc_calloc(n,size));
+}
+void *realloc(void *p, size_t size)
+{
+    size_t size0=p?malloc_usable_size(p):0;
+    void *q=__libc_realloc(p,size);
+    if (q||size==0) heap-=size0<heap?size0:heap;
+    return addalloc(q);
+}
+void free(void *p)
+{
+    if (p) {
+        size_t size=malloc_usable_size(p);
+        heap-=size<heap?size:heap;
+    }
+    __libc_free(p);
+}
+#endif /* __GLIBC__ */
+
+static const char *fmtname[]={ /* format names */
+    "rtcm2","rtcm3","nov","ubx","sbp","hemis","stq","javad","nvs","binex",
+    "rt17","sbf","unicore","anpp",NULL
+};
+static const int fmtcode[]={ /* format codes */
+    STRFMT_RTCM2,STRFMT_RTCM3,STRFMT_OEM4,STRFMT_UBX,STRFMT_SBP,STRFMT_CRES,
+    STRFMT_STQ,STRFMT_JAVAD,STRFMT_NVS,STRFMT_BINEX,STRFMT_RT17,STRFMT_SEPT,
+    STRFMT_UNICORE,STRFMT_ANPP
+};
+
+typedef struct {        /* benchmark result type */
+    int format;         /* stream format */
+    const char *file;   /* file (NULL: no data) */
+    double size;        /* file size (bytes) */
+    int nrep;           /* number of replays */
+    int nmsg,nobs,nerr; /* number of messages/obs epochs/errors per replay */
+    double time;        /* time per replay (ms) */
+    double nalloc;      /* number of allocations per replay */
+    double nbyte;       /* allocated bytes per replay */
+    double heap;        /* peak heap in use (bytes) */
+    long rss;           /* peak resident set size (kB) */
+} result_t;
+
+/* output generated frame to file -------------------------------------------*/
+static void outframe(const uint8_t *buff, int nbyte, int type, void *arg)
+{
+    (void)type;
+    fwrite(buff,1,nbyte,(FILE *)arg);
+}
+/* replay file by decoder ----------------------------------------------------*/
+static int replay(int format, const char *file, result_t *res)
+{
+    FILE *fp;
+    raw_t raw;
+    rtcm_t rtcm;
+    int ret,rtcm_fmt=format==STRFMT_RTCM2||format==STRFMT_RTCM3;
+
+    if (!(fp=fopen(file,"rb"))) return 0;
+    if (rtcm_fmt?!init_rtcm(&rtcm):!init_raw(&raw,format)) {
+        fclose(fp);
+        return 0;
+    }
+    res->nmsg=res->nobs=res->nerr=0;
+    for (;;) {
+        if      (format==STRFMT_RTCM2) ret=input_rtcm2f(&rtcm,fp);
+        else if (format==STRFMT_RTCM3) ret=input_rtcm3f(&rtcm,fp);
+        else                           ret=input_rawf(&raw,format,fp);
+        if (ret<-1) break;
+        if (ret>0) res->nmsg++;
+        if (ret==1) res->nobs++;
+        if (ret==-1) res->nerr++;
+    }
+    if (rtcm_fmt) free_rtcm(&rtcm); else free_raw(&raw);
+    fclose(fp);
+    return 1;
+}
+/* run benchmark of file -----------------------------------------------------*/
+static int runbench(result_t *res, int nrep, int mintime)
+{
+    struct rusage usage;
+    size_t heap0=heap;
+    FILE *fp;
+
+    if (!(fp=fopen(res->file,"rb"))) return 0;
+    fseek(fp,0,SEEK_END);
+    res->size=(double)ftell(fp);
+    fclose(fp);
+
+    nbyte=0.0;
+    heapmax=heap;
+    nalloc=0;
+    uint32_t tick=tickget();
+    int r;
+    for (r=0;r<nrep||(int)(tickget()-tick)<mintime;r++) {
+        if (!replay(res->format,res->file,res)) return 0;
+    }
+    res->nrep=r;
+    res->time=(double)(tickget()-tick)/r;
+    res->nalloc=cntalloc?(double)nalloc/r:-1.0;
+    res->nbyte=cntalloc?nbyte/r:-1.0;
+    res->heap=cntalloc?(double)(heapmax-heap0):-1.0;
+    getrusage(RUSAGE_SELF,&usage);
+    res->rss=usage.ru_maxrss;
+    return 1;
+}
+/* write result as json ------------------------------------------------------*/
+static void outjson(FILE *fp, const char *label, const result_t *res)
+{
+    double mbs=res->time>0.0?res->size/res->time/1E3:0.0;
+    double msgs=res->time>0.0?res->nmsg/res->time*1E3:0.0;
+
+    fprintf(fp,"{\"label\":\"%s\",\"format\":\"%s\",",label,formatstrs[res->format]);
+    if (!res->file) {
+        fprintf(fp,"\"file\":null,\"status\":\"no data\"}");
+        return;
+    }
+    fprintf(fp,"\"file\":\"%s\",\"status\":\"ok\",\"size\":%.0f,\"repeat\":%d,",
+            res->file,res->size,res->nrep);
+    fprintf(fp,"\"msgs\":%d,\"obs\":%d,\"errors\":%d,\"time_ms\":%.3f,",res->nmsg,
+            res->nobs,res->nerr,res->time);
+    fprintf(fp,"\"mb_s\":%.3f,\"msgs_s\":%.1f,\"allocs\":%.1f,\"alloc_bytes\":%.0f,",
+            mbs,msgs,res->nalloc,res->nbyte);
+    fprintf(fp,"\"peak_heap\":%.0f,\"peak_rss_kb\":%ld}",res->heap,res->rss);
+}
+/* read base MB/s of format and file from json file --------------------------*/
+static double basembs(const char *basefile, const result_t *res)
+{
+    FILE *fp=fopen(basefile,"r");
+    char buff[2048],key[1024],*p;
+    double mbs=-1.0;
+
+    if (!fp) return -1.0;
+    sprintf(key,"\"format\":\"%s\",\"file\":\"%s\"",formatstrs[res->format],
+            res->file);
+    while (fgets(buff,sizeof(buff),fp)) {
+        if (!strstr(buff,key)||!(p=strstr(buff,"\"mb_s\":"))) continue;
+        mbs=atof(p+7);
+    }
+    fclose(fp);
+    return mbs;
+}
+int main(int argc, char **argv)
+{
+    const char *file[MAXFILE]={
+        "../data/rcvraw/testglo.rtcm2","../data/rcvraw/testglo.rtcm3",
+        "../data/rcvraw/GMSD7_20121014.rtcm3",TMPFILE,
+        "../data/rcvraw/oemv_200911218.gps","../data/rcvraw/ubx_20080526.ubx",
+        "../data/rcvraw/cres_20080526.bin","../data/rcvraw/javad_20110115.jps"
+    };
+    int format[MAXFILE]={
+        STRFMT_RTCM2,STRFMT_RTCM3,STRFMT_RTCM3,STRFMT_RTCM3,STRFMT_OEM4,
+        STRFMT_UBX,STRFMT_CRES,STRFMT_JAVAD
+    };
+    const char *outfile="b_decode.json",*label="",*basefile=NULL;
+    result_t res[MAXFILE+16]={{0}};
+    int nfile=0,nres=0,nrep=3,mintime=500,stat=0;
+    double tol=0.2;
+
+    for (int i=1;i<argc;i++) {
+        if (!strcmp(argv[i],"-r")&&i+1<argc) nrep=atoi(argv[++i]);
+        else if (!strcmp(argv[i],"-t")&&i+1<argc) mintime=atoi(argv[++i]);
+        else if (!strcmp(argv[i],"-o")&&i+1<argc) outfile=argv[++i];
+        else if (!strcmp(argv[i],"-l")&&i+1<argc) label=argv[++i];
+        else if (!strcmp(argv[i],"-c")&&i+1<argc) basefile=argv[++i];
+        else if (!strcmp(argv[i],"-x")&&i+1<argc) tol=atof(argv[++i]);
+        else if (nfile<MAXFILE) {
+            const char *p=strchr(argv[i],':');
+            int k;
+            for (k=0;p&&fmtname[k];k++) {
+                if (!strncmp(fmtname[k],argv[i],p-argv[i])&&
+                    !fmtname[k][p-argv[i]]) break;
+            }
+            if (!p||!fmtname[k]) {
+                fprintf(stderr,"invalid format: %s\n",argv[i]);
+                return 1;
+            }
+            format[nfile]=fmtcode[k];
+            file[nfile++]=p+1;
+        }
+    }
+    if (nrep<1) nrep=1;
+#ifdef __GLIBC__
+    cntalloc=1;
+#endif
+    /* generate RTCM 3 file */
+    if (nfile==0) {
+        static const int msgs[]={1074,1075,1076,1077};
+        FILE *fp=fopen(TMPFILE,"wb");
+        int nframe=fp?genrtcm3("../data/rcvraw/ubx_20080526.ubx",msgs,4,
+                               GENRTCM3_EPH|GENRTCM3_TURN,outframe,fp):0;
+        if (fp) fclose(fp);
+        if (!nframe) {
+            fprintf(stderr,"rtcm3 generation error: %s\n",TMPFILE);
+            return 1;
+        }
+        nfile=8;
+    }
+    for (int i=0;i<nfile;i++) {
+        res[nres].format=format[i];
+        res[nres].file=file[i];
+        if (!runbench(res+nres,nrep,mintime)) {
+            fprintf(stderr,"file read error: %s\n",file[i]);
+            return 1;
+        }
+        nres++;
+    }
+    /* formats without data */
+    for (int k=0;fmtname[k];k++) {
+        int i;
+        for (i=0;i<nres;i++) if (res[i].format==fmtcode[k]) break;
+        if (i<nres) continue;
+        res[nres].format=fmtcode[k];
+        res[nres++].file=NULL;
+    }
+    remove(TMPFILE);
+
+    printf("%-22s %-36s %8s %8s %9s %10s %9s %11s %10s %9s\n","format","file",
+           "size(kB)","msgs","MB/s","msgs/s","allocs","bytes","heap","rss(kB)");
+    for (int i=0;i<nres;i++) {
+        const result_t *r=res+i;
+        if (!r->file) {
+            printf("%-22s %s\n",formatstrs[r->format],"(no data)");
+            continue;
+        }
+        double mbs=r->time>0.0?r->size/r->time/1E3:0.0;
+        printf("%-22s %-36s %8.1f %8d %9.1f %10.0f %9.0f %11.0f %10.0f %9ld",
+               formatstrs[r->format],r->file,r->size/1E3,r->nmsg,mbs,
+               r->time>0.0?r->nmsg/r->time*1E3:0.0,r->nalloc,r->nbyte,r->heap,
+               r->rss);
+        if (basefile) {
+            double base=basembs(basefile,r);
+            if (base>0.0) {
+                printf(" %6.2fx",mbs/base);
+                if (mbs<base*(1.0-tol)) {
+                    printf(" regression");
+                    stat=1;
+                }
+            }
+        }
+        printf("\n");
+    }
+    FILE *fp=fopen(outfile,"w");
+    if (!fp) {
+        fprintf(stderr,"file open error: %s\n",outfile);
+        return 1;
+    }
+    fprintf(fp,"[\n");
+    for (int i=0;i<nres;i++) {
+        outjson(fp,label,res+i);
+        fprintf(fp,"%s\n",i<nres-1?",":"");
+    }
+    fprintf(fp,"]\n");
+    fclose(fp);
+    return stat;
+}
@@ -0,0 +1,161 @@
+/*------------------------------------------------------------------------------
+* rtklib benchmark : RTCM 3 MSM7 decoding
+*
+* usage : b_msm7 [-r nrep] [ubxfile]
+*
+* generates RTCM 3 MSM7 messages from the u-blox raw log (default the 2008 UBX
+* test data) and decodes them nrep (default 200) times by input_rtcm3_buf().
+* then extracts the header and the satellite/signal data fields of the MSM7
+* frames nrep times by the bit by bit loop of the former getbitu(), by
+* getbitu() and by the bit stream reader rdbitu(). prints the message and
+* cell decode rate and the field extraction rate of each, and fails if the
+* extracted fields differ.
+*-----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "rtklib.h"
+#include "genrtcm3.h"
+
+#define MAXFRM      65536               /* max number of frames */
+
+typedef struct {        /* frames type */
+    uint8_t *data;      /* frame data */
+    int n,nmax;         /* data length/allocated (bytes) */
+    int nfrm;           /* number of frames */
+    int off[MAXFRM];    /* frame offsets */
+} frames_t;
+
+/* add frame -----------------------------------------------------------------*/
+static int addframe(frames_t *f, const uint8_t *data, int n)
+{
+    if (f->nfrm>=MAXFRM) return 0;
+    if (f->n+n>f->nmax) {
+        int nmax=f->nmax<=0?65536:f->nmax*2;
+        uint8_t *p;
+        while (nmax<f->n+n) nmax*=2;
+        if (!(p=(uint8_t *)realloc(f->data,nmax))) return 0;
+        f->data=p;
+        f->nmax=nmax;
+    }
+    memcpy(f->data+f->n,data,n);
+    f->off[f->nfrm++]=f->n;
+    f->n+=n;
+    return 1;
+}
+/* output generated frame ----------------------------------------------------*/
+static void outframe(const uint8_t *buff, int nbyte, int type, void *arg)
+{
+    (void)type;
+    addframe((frames_t *)arg,buff,nbyte);
+}
+/* bit by bit getbitu() ------------------------------------------------------*/
+static uint32_t getbitu_bit(const uint8_t *buff, unsigned pos, unsigned len)
+{
+    uint32_t bits=0;
+    for (unsigned i=pos;i<pos+len;i++) {
+        bits=(bits<<1)|((buff[i/8]>>(7-i%8))&1u);
+    }
+    return bits;
+}
+/* read field by method ------------------------------------------------------*/
+static uint32_t rdfield(int method, const uint8_t *buff, bitrd_t *b, unsigned *pos,
+                        unsigned len)
+{
+    uint32_t bits;
+
+    if (method==2) return rdbitu(b,len);
+    bits=method==0?getbitu_bit(buff,*pos,len):getbitu(buff,*pos,len);
+    *pos+=len;
+    return bits;
+}
+/* extract MSM7 fields, return number of fields ------------------------------*/
+static int extmsm7(int method, const uint8_t *buff, int len, uint32_t *sum)
+{
+    static const int hdr[]={12,30,1,3,7,2,2,1,3}; /* staid ... smooth interval */
+    static const int sat[]={8,4,10,14},sig[]={20,24,10,1,10,15};
+    bitrd_t b;
+    unsigned pos=36;
+    int nsat=0,nsig=0,ncell=0,nfield=0;
+
+    initbitrd(&b,buff,len,36);
+    for (int i=0;i<9;i++,nfield++) *sum=*sum*31+rdfield(method,buff,&b,&pos,hdr[i]);
+    for (int i=0;i<64+32;i++,nfield++) {
+        if (!rdfield(method,buff,&b,&pos,1)) continue;
+        if (i<64) nsat++; else nsig++;
+    }
+    for (int i=0;i<nsat*nsig;i++,nfield++) ncell+=rdfield(method,buff,&b,&pos,1);
+    for (int i=0;i<4;i++) {
+        for (int j=0;j<nsat;j++,nfield++) {
+            *sum=*sum*31+rdfield(method,buff,&b,&pos,sat[i]);
+        }
+    }
+    for (int i=0;i<6;i++) {
+        for (int j=0;j<ncell;j++,nfield++) {
+            *sum=*sum*31+rdfield(method,buff,&b,&pos,sig[i]);
+        }
+    }
+    return nfield;
+}
+int main(int argc, char **argv)
+{
+    static const int msgs[]={1077,1087,1097,1117,1127};
+    static frames_t f={0};
+    const char *file="../data/rcvraw/ubx_20080526.ubx";
+    const char *name[]={"bitloop","getbitu","rdbitu"};
+    rtcm_t rtcm;
+    uint32_t sum[3]={0};
+    double t[3],nfield=0.0;
+    int nrep=200,nmsg=0,ncell=0;
+
+    for (int i=1;i<argc;i++) {
+        if (!strcmp(argv[i],"-r")&&i+1<argc) nrep=atoi(argv[++i]);
+        else file=argv[i];
+    }
+    if (nrep<1) nrep=1;
+
+    if (!genrtcm3(file,msgs,5,0,outframe,&f)) {
+        fprintf(stderr,"no msm7 data: %s\n",file);
+        return 1;
+    }
+    /* decode messages */
+    if (!init_rtcm(&rtcm)) return 1;
+    uint32_t tick=tickget();
+    for (int r=0;r<nrep;r++) {
+        for (int i=0,m;i<f.n;i+=m) {
+            if (input_rtcm3_buf(&rtcm,f.data+i,f.n-i,&m)!=1) continue;
+            nmsg++;
+            ncell+=rtcm.obs.n;
+        }
+    }
+    double t0=(double)(tickget()-tick);
+    free_rtcm(&rtcm);
+    if (nmsg!=f.nfrm*nrep) {
+        fprintf(stderr,"decode error: msgs=%d frames=%d\n",nmsg,f.nfrm*nrep);
+        return 1;
+    }
+    /* extract fields */
+    for (int k=0;k<3;k++) {
+        tick=tickget();
+        nfield=0.0;
+        for (int r=0;r<nrep;r++) {
+            for (int i=0;i<f.nfrm;i++) {
+                int len=(i<f.nfrm-1?f.off[i+1]:f.n)-f.off[i];
+                nfield+=extmsm7(k,f.data+f.off[i],len,sum+k);
+            }
+        }
+        t[k]=(double)(tickget()-tick);
+    }
+    if (sum[0]!=sum[1]||sum[0]!=sum[2]) {
+        fprintf(stderr,"extracted fields differ\n");
+        return 1;
+    }
+    printf("file=%s msm7=%d repeat=%d\n",file,f.nfrm,nrep);
+    printf("%12s %12s","msgs/s","obs/s");
+    for (int k=0;k<3;k++) printf(" %14s",name[k]);
+    printf(" %8s\n","speedup");
+    printf("%12.0f %12.0f",t0>0.0?nmsg/t0*1E3:0.0,t0>0.0?ncell/t0*1E3:0.0);
+    for (int k=0;k<3;k++) printf(" %8.1f Mf/s ",t[k]>0.0?nfield/t[k]/1E3:0.0);
+    printf(" %8.2f\n",t[2]>0.0?t[0]/t[2]:0.0);
+    free(f.data);
+    return 0;
+}
@@ -0,0 +1,112 @@
+/*------------------------------------------------------------------------------
+* rtklib benchmark : obs/nav cache
+*
+* usage : b_obscache [-r nrep] [file ...]
+*
+* reads the RINEX files (default the 2005 rover/base obs and nav data) nrep
+* (default 20) times by readrnx(), sortobs() and uniqnav() as readobsnav() of
+* postpos does without cache (cold), writes the decoded data to an obs/nav
+* cache file by writeobscache() and reads it nrep times by readobscache()
+* (warm). prints the load latency of both and fails if the data differ.
+*-----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "rtklib.h"
+
+#define CACHEFILE   "b_obscache_tmp.obsc"
+#define CACHEKEY    0x0123456789ABCDEFULL
+
+/* read files by readrnx(), return number of epochs --------------------------*/
+static int readfiles(const char **file, int nfile, obs_t *obs, nav_t *nav,
+                     sta_t *sta)
+{
+    for (int i=0;i<nfile;i++) {
+        int rcv=strstr(file[i],"0759")?1:2;
+        readrnx(file[i],rcv,"",obs,nav,sta+rcv-1);
+    }
+    int nepoch=sortobs(obs);
+    uniqnav(nav);
+    return nepoch;
+}
+/* compare obs/nav data ------------------------------------------------------*/
+static int cmpdata(const obs_t *obs1, const nav_t *nav1, const obs_t *obs2,
+                   const nav_t *nav2)
+{
+    return obs1->n==obs2->n&&nav1->n==nav2->n&&nav1->ng==nav2->ng&&
+           nav1->ns==nav2->ns&&
+           !memcmp(obs1->data,obs2->data,sizeof(obsd_t)*obs1->n)&&
+           !memcmp(nav1->eph,nav2->eph,sizeof(eph_t)*nav1->n)&&
+           !memcmp(nav1->geph,nav2->geph,sizeof(geph_t)*nav1->ng)&&
+           !memcmp(nav1->seph,nav2->seph,sizeof(seph_t)*nav1->ns)&&
+           !memcmp(nav1->ion_gps,nav2->ion_gps,sizeof(nav1->ion_gps))&&
+           !memcmp(nav1->utc_gps,nav2->utc_gps,sizeof(nav1->utc_gps))&&
+           !memcmp(nav1->glo_fcn,nav2->glo_fcn,sizeof(nav1->glo_fcn));
+}
+int main(int argc, char **argv)
+{
+    const char *file[16]={
+        "../data/rinex/07590920.05o","../data/rinex/30400920.05o",
+        "../data/rinex/30400920.05n"
+    };
+    obs_t obs1={0},obs2={0};
+    nav_t nav1={0},nav2={0};
+    sta_t sta1[2]={0},sta2[2]={0};
+    int nfile=0,nrep=20,nepoch1=0,nepoch2=0;
+
+    for (int i=1;i<argc;i++) {
+        if (!strcmp(argv[i],"-r")&&i+1<argc) nrep=atoi(argv[++i]);
+        else if (nfile<16) file[nfile++]=argv[i];
+    }
+    if (nfile==0) nfile=3;
+    if (nrep<1) nrep=1;
+
+    /* cold: decode RINEX files */
+    uint32_t tick=tickget();
+    for (int r=0;r<nrep;r++) {
+        freeobs(&obs1);
+        freenav(&nav1,0xFF);
+        nepoch1=readfiles(file,nfile,&obs1,&nav1,sta1);
+    }
+    double t0=(double)(tickget()-tick)/nrep;
+
+    if (obs1.n<=0||!writeobscache(CACHEFILE,CACHEKEY,&obs1,&nav1,sta1,2,nepoch1)) {
+        fprintf(stderr,"cache write error: %s\n",CACHEFILE);
+        return 1;
+    }
+    /* warm: load cache file */
+    tick=tickget();
+    for (int r=0;r<nrep;r++) {
+        freeobs(&obs2);
+        freenav(&nav2,0xFF);
+        if (!readobscache(CACHEFILE,CACHEKEY,&obs2,&nav2,sta2,2,&nepoch2)) {
+            fprintf(stderr,"cache read error: %s\n",CACHEFILE);
+            return 1;
+        }
+    }
+    double t1=(double)(tickget()-tick)/nrep;
+
+    /* invalid key */
+    int stat=readobscache(CACHEFILE,CACHEKEY+1,&obs1,&nav1,sta1,2,&nepoch1);
+    remove(CACHEFILE);
+    if (stat) {
+        fprintf(stderr,"cache read with invalid key\n");
+        return 1;
+    }
+    freeobs(&obs1);
+    freenav(&nav1,0xFF);
+    readfiles(file,nfile,&obs1,&nav1,sta1);
+
+    if (nepoch1!=nepoch2||!cmpdata(&obs1,&nav1,&obs2,&nav2)||
+        memcmp(sta1,sta2,sizeof(sta1))) {
+        fprintf(stderr,"cached data differ\n");
+        return 1;
+    }
+    printf("files=%d obs=%d eph=%d geph=%d epochs=%d repeat=%d\n",nfile,obs1.n,
+           nav1.n,nav1.ng,nepoch1,nrep);
+    printf("%12s %12s %8s\n","cold(ms)","warm(ms)","speedup");
+    printf("%12.2f %12.2f %8.2f\n",t0,t1,t1>0.0?t0/t1:0.0);
+
+    freeobs(&obs1); freenav(&nav1,0xFF);
+    freeobs(&obs2); freenav(&nav2,0xFF);
+    return 0;
+}
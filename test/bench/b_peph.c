@@ -0,0 +1,104 @@
+/*------------------------------------------------------------------------------
+* rtklib benchmark : precise ephemeris interpolation
+*
+* usage : b_peph [-r nrep] [sp3/clkfile ...]
+*
+* reads the precise ephemeris and clock files and computes the satellite
+* positions and clocks by peph2pos() every 30 s over the span with the
+* polynomial interpolation and with the Chebyshev fit of the orbits (after
+* fitpeph()). prints the time per epoch and the fit errors versus the
+* polynomial interpolation and fails if the fit error is 1E-3 m or more. the
+* positions at any time may differ more (<5E-3 m) by the steps of polynomial
+* interpolation where its window shifts. the clocks differ only by the
+* relativity correction with the velocities (<1E-12 s).
+*-----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "rtklib.h"
+
+/* compute satellite positions over the span, return time (ms) ---------------*/
+static double procpeph(gtime_t ts, int nep, const nav_t *nav, int nrep,
+                       double *rs, double *dts)
+{
+    double var;
+    uint32_t tick=tickget();
+
+    for (int k=0;k<nrep;k++) {
+        for (int i=0;i<nep;i++) {
+            gtime_t time=timeadd(ts,i*30.0);
+            for (int j=0;j<MAXSAT;j++) {
+                double *r=rs+(i*MAXSAT+j)*6,*c=dts+(i*MAXSAT+j)*2;
+                if (!peph2pos(time,j+1,nav,1,r,c,&var)) {
+                    r[0]=r[1]=r[2]=r[3]=r[4]=r[5]=c[0]=c[1]=0.0;
+                }
+            }
+        }
+    }
+    return (double)(tickget()-tick)/nrep;
+}
+int main(int argc, char **argv)
+{
+    const char *file[16]={
+        "../data/sp3/igs15904.sp3","../data/sp3/igs15905.sp3","../data/sp3/igs15904.clk"
+    };
+    nav_t nav={0};
+    int nfile=0,nrep=1;
+
+    for (int i=1;i<argc;i++) {
+        if (!strcmp(argv[i],"-r")&&i+1<argc) nrep=atoi(argv[++i]);
+        else if (nfile<16) file[nfile++]=argv[i];
+    }
+    if (nfile==0) nfile=3;
+
+    for (int i=0;i<nfile;i++) readsp3(file[i],&nav,0);
+    for (int i=0;i<nfile;i++) readrnxc(file[i],&nav);
+    if (nav.ne<=0) {
+        fprintf(stderr,"no precise ephemeris\n");
+        return 1;
+    }
+    gtime_t ts=nav.peph[0].time;
+    int nep=(int)(timediff(nav.peph[nav.ne-1].time,ts)/30.0);
+    double *rs0=mat(6*MAXSAT,nep),*rs1=mat(6*MAXSAT,nep);
+    double *dts0=mat(2*MAXSAT,nep),*dts1=mat(2*MAXSAT,nep);
+
+    double t0=procpeph(ts,nep,&nav,nrep,rs0,dts0);
+
+    uint32_t tick=tickget();
+    int nfit=fitpeph(&nav);
+    double tf=(double)(tickget()-tick);
+
+    double t1=procpeph(ts,nep,&nav,nrep,rs1,dts1);
+
+    /* fit errors of satellite positions and velocities, clock differences */
+    double pmax=0.0,vmax=0.0,cmax=0.0;
+    for (int i=0;i<nep*MAXSAT;i++) {
+        double dp[3],dv[3];
+        for (int j=0;j<3;j++) {
+            dp[j]=rs1[i*6+j]-rs0[i*6+j];
+            dv[j]=rs1[i*6+3+j]-rs0[i*6+3+j];
+        }
+        if (norm(dp,3)>pmax) pmax=norm(dp,3);
+        if (norm(dv,3)>vmax) vmax=norm(dv,3);
+        if (fabs(dts1[i*2]-dts0[i*2])>cmax) cmax=fabs(dts1[i*2]-dts0[i*2]);
+    }
+    printf("ne=%d nc=%d nseg=%d nfit=%d epochs=%d repeat=%d fit=%.0fms\n",nav.ne,
+           nav.nc,nav.pephc.nseg,nfit,nep,nrep,tf);
+    printf("%14s %14s %7s\n","neville(ms/ep)","cheb(ms/ep)","speedup");
+    printf("%14.4f %14.4f %7.1f\n",t0/nep,t1/nep,t1>0.0?t0/t1:0.0);
+    printf("fit errmax(m)=%.3E errrms(m)=%.3E\n",nav.pephc.errmax,nav.pephc.errrms);
+    printf("maxdiff pos(m)=%.3E vel(m/s)=%.3E clk(s)=%.3E\n",pmax,vmax,cmax);
+    if (nfit<=0) {
+        fprintf(stderr,"no chebyshev segment fitted\n");
+        return 1;
+    }
+    if (nav.pephc.errmax>=1E-3||pmax>=5E-3||cmax>=1E-12) {
+        fprintf(stderr,"chebyshev fit error: errmax=%.3E pos=%.3E clk=%.3E\n",
+                nav.pephc.errmax,pmax,cmax);
+        return 1;
+    }
+
+    free(rs0); free(rs1); free(dts0); free(dts1);
+    freenav(&nav,0xFF);
+    return 0;
+}
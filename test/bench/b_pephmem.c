@@ -0,0 +1,139 @@
+/*------------------------------------------------------------------------------
+* rtklib benchmark : packed precise ephemeris/clock store
+*
+* usage : b_pephmem [sp3/clkfile ...]
+*
+* reads the precise ephemeris and clock files keeping only the packed store
+* (dropping the records after each file by packpeph() as postpos) and keeping
+* the records, each in a child process, and prints the load time, the increase
+* of peak resident memory by loading and the max memory of the records and
+* the memory of the packed store. computes the satellite positions and clocks
+* by peph2pos() every 30 s over the span and fails if they differ between the
+* two.
+*-----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "rtklib.h"
+
+/* resident memory (bytes) ---------------------------------------------------*/
+static double getrss(void)
+{
+    FILE *fp;
+    long size,rss=0;
+
+    if (!(fp=fopen("/proc/self/statm","r"))) return 0.0;
+    if (fscanf(fp,"%ld %ld",&size,&rss)<2) rss=0;
+    fclose(fp);
+    return (double)rss*sysconf(_SC_PAGESIZE);
+}
+/* read precise ephemeris/clock files ----------------------------------------*/
+static void readpeph(const char **file, int n, int drop, nav_t *nav, size_t *mrec)
+{
+    size_t mem;
+
+    *mrec=0;
+    for (int i=0;i<n;i++) {
+        readsp3(file[i],nav,0);
+        pephmem(nav,&mem); if (mem>*mrec) *mrec=mem;
+        if (drop) packpeph(nav,0x04);
+    }
+    for (int i=0;i<n;i++) {
+        readrnxc(file[i],nav);
+        pephmem(nav,&mem); if (mem>*mrec) *mrec=mem;
+        if (drop) packpeph(nav,0x08);
+    }
+}
+/* read files in child process, return {time (ms),rss,records,packed} -------*/
+static int loadpeph(const char **file, int n, int drop, double *stat)
+{
+    int fd[2];
+    pid_t pid;
+
+    if (pipe(fd)) return 0;
+    if ((pid=fork())==0) {
+        nav_t nav={0};
+        struct rusage ru;
+        size_t mrec;
+        double rss0=getrss();
+        uint32_t tick=tickget();
+        readpeph(file,n,drop,&nav,&mrec);
+        stat[0]=(double)(tickget()-tick);
+        getrusage(RUSAGE_SELF,&ru);
+        stat[1]=ru.ru_maxrss*1024.0-rss0;
+        stat[2]=(double)mrec;
+        stat[3]=(double)pephmem(&nav,NULL);
+        if (write(fd[1],stat,sizeof(double)*4)<0) _exit(1);
+        _exit(0);
+    }
+    close(fd[1]);
+    int ok=pid>0&&read(fd[0],stat,sizeof(double)*4)==sizeof(double)*4;
+    close(fd[0]);
+    if (pid>0) waitpid(pid,NULL,0);
+    return ok;
+}
+/* compute satellite positions over the span ---------------------------------*/
+static void procpeph(gtime_t ts, int nep, const nav_t *nav, double *rs)
+{
+    double dts[2],var;
+
+    for (int i=0;i<nep;i++) {
+        gtime_t time=timeadd(ts,i*30.0);
+        for (int j=0;j<MAXSAT;j++) {
+            double *r=rs+(i*MAXSAT+j)*9;
+            memset(r,0,sizeof(double)*9);
+            if (peph2pos(time,j+1,nav,0,r,dts,&var)) {
+                r[6]=dts[0]; r[7]=dts[1]; r[8]=var;
+            }
+        }
+    }
+}
+int main(int argc, char **argv)
+{
+    const char *file[16]={
+        "../data/sp3/igs15904.sp3","../data/sp3/igs15905.sp3","../data/sp3/igs15904.clk"
+    };
+    nav_t nav0={0},nav1={0};
+    double stat[2][4];
+    size_t mrec;
+    int nfile=0;
+
+    for (int i=1;i<argc&&nfile<16;i++) file[nfile++]=argv[i];
+    if (nfile==0) nfile=3;
+
+    if (!loadpeph(file,nfile,1,stat[0])||!loadpeph(file,nfile,0,stat[1])) {
+        fprintf(stderr,"load error\n");
+        return 1;
+    }
+    readpeph(file,nfile,1,&nav0,&mrec);
+    readpeph(file,nfile,0,&nav1,&mrec);
+    if (nav1.pephp.n<=0) {
+        fprintf(stderr,"no precise ephemeris\n");
+        return 1;
+    }
+    printf("ne=%d nc=%d\n",nav1.pephp.n,nav1.pclkp.n);
+    printf("%-8s %10s %10s %12s %12s\n","store","load(ms)","rss(MB)","records(MB)",
+           "packed(MB)");
+    for (int i=0;i<2;i++) {
+        printf("%-8s %10.0f %10.1f %12.1f %12.3f\n",i?"records":"packed",stat[i][0],
+               stat[i][1]/1048576.0,stat[i][2]/1048576.0,stat[i][3]/1048576.0);
+    }
+
+    /* the packed store only does not change the satellite positions */
+    gtime_t ts=nav1.pephp.time[0];
+    int nep=(int)(timediff(nav1.pephp.time[nav1.pephp.n-1],ts)/30.0)+1;
+    double *rs0=mat(9*MAXSAT,nep),*rs1=mat(9*MAXSAT,nep);
+    procpeph(ts,nep,&nav0,rs0);
+    procpeph(ts,nep,&nav1,rs1);
+    if (memcmp(rs0,rs1,sizeof(double)*9*MAXSAT*nep)) {
+        fprintf(stderr,"satellite positions differ: packed store\n");
+        return 1;
+    }
+
+    free(rs0); free(rs1);
+    freenav(&nav0,0xFF);
+    freenav(&nav1,0xFF);
+    return 0;
+}
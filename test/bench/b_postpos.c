@@ -0,0 +1,157 @@
+/*------------------------------------------------------------------------------
+* rtklib benchmark : concurrent post-processing sessions
+*
+* usage : b_postpos [-t nthread] [-j njob] [prodfile ...]
+*
+* processes njob (default 8) sessions of the 2005 rover/base data cycling the
+* positioning modes (kinematic, static, dgps, combined, ppp-kinematic) by
+* postpos() one after another, and then by postposc() with a context per
+* session in nthread (default 4) threads sharing the products read by
+* ppprodread() (the precise ephemeris/clock files given as prodfile). prints
+* the time of the serial and concurrent runs and fails if the solution files
+* differ.
+*-----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include "rtklib.h"
+
+#define MAXJOB      64
+
+typedef struct {        /* session job type */
+    prcopt_t popt;      /* processing options */
+    char name[32];      /* output file name without extension */
+} job_t;
+
+static const char *infile[]={
+    "../data/rinex/07590920.05o","../data/rinex/30400920.05n",
+    "../data/rinex/30400920.05o"
+};
+static job_t jobs[MAXJOB];
+static int njob=8,ijob=0;
+static solopt_t sopt;
+static filopt_t fopt={0};
+static const ppprod_t *prod=NULL;
+static pthread_mutex_t lock=PTHREAD_MUTEX_INITIALIZER;
+
+/* set session job options ---------------------------------------------------*/
+static void setjob(job_t *job, int k)
+{
+    const double rb[]={-3978241.958,3382840.234,3649900.853};
+    const int modes[]={PMODE_KINEMA,PMODE_STATIC,PMODE_DGPS,PMODE_KINEMA,
+                       PMODE_PPP_KINEMA};
+
+    job->popt=prcopt_default;
+    job->popt.mode=modes[k%5];
+    job->popt.navsys=SYS_GPS|SYS_GLO;
+    job->popt.refpos=job->popt.rovpos=POSOPT_POS_XYZ;
+    matcpy(job->popt.rb,rb,3,1);
+    matcpy(job->popt.ru,rb,3,1);
+    if (k%5==3) job->popt.soltype=SOLTYPE_COMBINED;
+    if (k%2) job->popt.elmin=20.0*D2R;
+}
+/* session worker thread -----------------------------------------------------*/
+static void *worker(void *arg)
+{
+    gtime_t t0={0};
+    postpos_t *pp=postposnew(prod);
+    char outfile[64];
+
+    (void)arg;
+    if (!pp) {
+        fprintf(stderr,"postposnew error\n");
+        return (void *)1;
+    }
+    for (;;) {
+        pthread_mutex_lock(&lock);
+        int k=ijob<njob?ijob++:-1;
+        pthread_mutex_unlock(&lock);
+        if (k<0) break;
+        sprintf(outfile,"%s_par.pos",jobs[k].name);
+        postposc(pp,t0,t0,0.0,0.0,&jobs[k].popt,&sopt,&fopt,infile,3,outfile,"","");
+    }
+    postposfree(pp);
+    return NULL;
+}
+/* compare files -------------------------------------------------------------*/
+static int cmpfile(const char *file1, const char *file2)
+{
+    FILE *fp1=fopen(file1,"rb"),*fp2=fopen(file2,"rb");
+    int c1=0,c2=0,n=0;
+
+    if (fp1&&fp2) {
+        do {
+            c1=fgetc(fp1); c2=fgetc(fp2); n++;
+        } while (c1==c2&&c1!=EOF);
+    }
+    if (fp1) fclose(fp1);
+    if (fp2) fclose(fp2);
+    return fp1&&fp2&&c1==c2&&n>1;
+}
+int main(int argc, char **argv)
+{
+    const char *pfile[16];
+    gtime_t t0={0};
+    pthread_t thread[64];
+    ppprod_t prods;
+    char outfile[64];
+    int nthread=4,npfile=0;
+
+    for (int i=1;i<argc;i++) {
+        if (!strcmp(argv[i],"-t")&&i+1<argc) nthread=atoi(argv[++i]);
+        else if (!strcmp(argv[i],"-j")&&i+1<argc) njob=atoi(argv[++i]);
+        else if (npfile<16) pfile[npfile++]=argv[i];
+    }
+    if (njob>MAXJOB) njob=MAXJOB;
+    if (nthread>64) nthread=64;
+    sopt=solopt_default;
+    sopt.posf=SOLF_XYZ;
+
+    for (int k=0;k<njob;k++) {
+        setjob(jobs+k,k);
+        sprintf(jobs[k].name,"b_postpos_%02d",k);
+    }
+    /* serial sessions by postpos() */
+    uint32_t tick=tickget();
+    for (int k=0;k<njob;k++) {
+        sprintf(outfile,"%s_ser.pos",jobs[k].name);
+        postpos(t0,t0,0.0,0.0,&jobs[k].popt,&sopt,&fopt,infile,3,outfile,"","");
+    }
+    double t1=(double)(tickget()-tick);
+
+    /* concurrent sessions by postposc() sharing products */
+    tick=tickget();
+    if (!ppprodread(&prods,&prcopt_default,&fopt,pfile,npfile)) {
+        fprintf(stderr,"products read error\n");
+        return 1;
+    }
+    prod=&prods;
+    for (int i=0;i<nthread;i++) pthread_create(thread+i,NULL,worker,NULL);
+    int stat=1;
+    for (int i=0;i<nthread;i++) {
+        void *ret=NULL;
+        pthread_join(thread[i],&ret);
+        if (ret) stat=0;
+    }
+    if (!stat) return 1;
+    double t2=(double)(tickget()-tick);
+
+    printf("jobs=%d threads=%d\n",njob,nthread);
+    printf("%12s %14s %8s\n","serial(ms)","concurrent(ms)","speedup");
+    printf("%12.0f %14.0f %8.2f\n",t1,t2,t2>0.0?t1/t2:0.0);
+
+    for (int k=0;k<njob;k++) {
+        char file1[80],file2[80];
+        sprintf(file1,"%s_ser.pos",jobs[k].name);
+        sprintf(file2,"%s_par.pos",jobs[k].name);
+        if (!cmpfile(file1,file2)) {
+            fprintf(stderr,"solutions differ: %s %s\n",file1,file2);
+            return 1;
+        }
+        remove(file1); remove(file2);
+        sprintf(file1,"%s_ser_events.pos",jobs[k].name); remove(file1);
+        sprintf(file2,"%s_par_events.pos",jobs[k].name); remove(file2);
+    }
+    ppprodfree(&prods);
+    return 0;
+}
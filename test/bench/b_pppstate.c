@@ -0,0 +1,95 @@
+/*------------------------------------------------------------------------------
+* rtklib benchmark : ppp state layout
+*
+* usage : b_pppstate [-r nrep] [obsfile navfile]
+*
+* processes the observation data in ppp-kinematic mode with the ionosphere and
+* troposphere estimated, limiting the number of satellites per epoch, with the
+* legacy state layout (misc-pppopt=-LEGACY_STATE) and the compact state
+* layout. prints the time per epoch versus the number of tracked satellites
+* and fails if the solutions of the two layouts differ.
+*-----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "rtklib.h"
+
+/* process all epochs, return time (ms) ---------------------------------------*/
+static double procobs(const obs_t *obs, const nav_t *nav, const prcopt_t *opt,
+                      int nsat, int nrep, double *sol, int *nxmax)
+{
+    rtk_t rtk;
+    uint32_t tick=tickget();
+
+    for (int k=0;k<nrep;k++) {
+        rtkinit(&rtk,opt);
+        *nxmax=0;
+        for (int i=0,ne=0;i<obs->n;ne++) {
+            int n=1;
+            while (i+n<obs->n&&timediff(obs->data[i+n].time,obs->data[i].time)<DTTOL) n++;
+
+            rtkpos(&rtk,obs->data+i,n<nsat?n:nsat,nav);
+            if (rtk.nx>*nxmax) *nxmax=rtk.nx;
+            for (int j=0;j<3;j++) sol[j+ne*3]=rtk.sol.stat?rtk.sol.rr[j]:0.0;
+            i+=n;
+        }
+        rtkfree(&rtk);
+    }
+    return (double)(tickget()-tick)/nrep;
+}
+int main(int argc, char **argv)
+{
+    const char *file[]={"../data/rinex/07590920.05o","../data/rinex/07590920.05n"};
+    const int nsats[]={4,5,6,7,8,MAXOBS};
+    prcopt_t opt=prcopt_default;
+    obs_t obs={0};
+    nav_t nav={0};
+    sta_t sta={0};
+    int nrep=20,nfile=0;
+
+    for (int i=1;i<argc;i++) {
+        if (!strcmp(argv[i],"-r")&&i+1<argc) nrep=atoi(argv[++i]);
+        else if (nfile<2) file[nfile++]=argv[i];
+    }
+    if (!readrnx(file[0],1,"",&obs,&nav,&sta)||!readrnx(file[1],1,"",&obs,&nav,&sta)) {
+        fprintf(stderr,"file read error: %s %s\n",file[0],file[1]);
+        return 1;
+    }
+    int ne=sortobs(&obs);
+    uniqnav(&nav);
+
+    opt.mode=PMODE_PPP_KINEMA;
+    opt.navsys=SYS_GPS;
+    opt.ionoopt=IONOOPT_EST;
+    opt.tropopt=TROPOPT_EST;
+    opt.dynamics=0;
+
+    double *sol0=mat(3,ne),*sol1=mat(3,ne);
+
+    printf("epochs=%d repeat=%d\n",ne,nrep);
+    printf("%5s %5s %8s %8s %14s %14s %7s\n","nsat","nsol","nx(leg)","nx(cmp)",
+           "legacy(ms/ep)","compact(ms/ep)","speedup");
+
+    for (int i=0;i<(int)(sizeof(nsats)/sizeof(nsats[0]));i++) {
+        int nx0,nx1;
+
+        strcpy(opt.pppopt,"-LEGACY_STATE");
+        double t0=procobs(&obs,&nav,&opt,nsats[i],nrep,sol0,&nx0);
+        strcpy(opt.pppopt,"");
+        double t1=procobs(&obs,&nav,&opt,nsats[i],nrep,sol1,&nx1);
+
+        int nsol=0;
+        for (int j=0;j<ne;j++) if (sol1[j*3]!=0.0) nsol++;
+
+        printf("%5d %5d %8d %8d %14.4f %14.4f %7.1f\n",nsats[i],nsol,nx0,nx1,t0/ne,
+               t1/ne,t1>0.0?t0/t1:0.0);
+
+        /* the state layout does not change the solutions */
+        if (memcmp(sol0,sol1,sizeof(double)*3*ne)) {
+            fprintf(stderr,"solutions differ: nsat=%d\n",nsats[i]);
+            return 1;
+        }
+    }
+    free(sol0); free(sol1);
+    free(obs.data); freenav(&nav,0xFF);
+    return 0;
+}
@@ -0,0 +1,149 @@
+/*------------------------------------------------------------------------------
+* rtklib benchmark : receiver raw data input by buffer
+*
+* usage : b_rawbuf [-r nrep] [-b size] [format:file ...]
+*
+* reads the receiver raw data files (default the UBX, OEM4, Hemisphere and
+* JAVAD test data) to memory and inputs them nrep (default 20) times by
+* input_raw() byte by byte and by input_raw_buf() in blocks of size (default
+* 4096) bytes as a stream server does. format is the format name of convbin
+* -r option (nov,ubx,sbp,hemis,stq,javad,nvs,binex,rt17,sbf,unicore,anpp).
+* prints the decoded MB/s of both and fails if the sequences of the decoded
+* messages differ.
+*-----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "rtklib.h"
+
+#define MAXFILE     16
+
+static const char *fmtname[]={ /* format names */
+    "nov","ubx","sbp","hemis","stq","javad","nvs","binex","rt17","sbf",
+    "unicore","anpp",NULL
+};
+static const int fmtcode[]={ /* format codes */
+    STRFMT_OEM4,STRFMT_UBX,STRFMT_SBP,STRFMT_CRES,STRFMT_STQ,STRFMT_JAVAD,
+    STRFMT_NVS,STRFMT_BINEX,STRFMT_RT17,STRFMT_SEPT,STRFMT_UNICORE,STRFMT_ANPP
+};
+
+typedef struct {        /* decoded message summary type */
+    int nmsg;           /* number of messages (status!=0) */
+    int nobs;           /* number of obs data */
+    uint32_t sum;       /* checksum of status sequence */
+} msgsum_t;
+
+/* update message summary ----------------------------------------------------*/
+static void summsg(msgsum_t *s, const raw_t *raw, int ret)
+{
+    if (ret==0) return;
+    s->nmsg++;
+    s->sum=s->sum*31+(uint32_t)(ret+2);
+    if (ret==1) s->nobs+=raw->obs.n;
+}
+/* input data, return time (ms) ----------------------------------------------*/
+static double inputdata(int format, const uint8_t *data, int len, int nrep,
+                        int bsize, msgsum_t *s)
+{
+    raw_t raw;
+    uint32_t tick=tickget();
+
+    for (int r=0;r<nrep;r++) {
+        memset(s,0,sizeof(msgsum_t));
+        if (!init_raw(&raw,format)) return -1.0;
+        if (bsize<=0) {
+            for (int i=0;i<len;i++) summsg(s,&raw,input_raw(&raw,format,data[i]));
+        }
+        else {
+            for (int i=0;i<len;i+=bsize) {
+                int n=len-i<bsize?len-i:bsize;
+                for (int j=0,m;j<n;j+=m) {
+                    summsg(s,&raw,input_raw_buf(&raw,format,data+i+j,n-j,&m));
+                }
+            }
+        }
+        free_raw(&raw);
+    }
+    return (double)(tickget()-tick);
+}
+/* read file to memory -------------------------------------------------------*/
+static uint8_t *readfile(const char *file, int *len)
+{
+    FILE *fp=fopen(file,"rb");
+    uint8_t *data=NULL;
+    long n;
+
+    if (!fp) return NULL;
+    if (!fseek(fp,0,SEEK_END)&&(n=ftell(fp))>0&&!fseek(fp,0,SEEK_SET)&&
+        (data=(uint8_t *)malloc(n))&&fread(data,1,n,fp)==(size_t)n) {
+        *len=(int)n;
+    }
+    else {
+        free(data);
+        data=NULL;
+    }
+    fclose(fp);
+    return data;
+}
+int main(int argc, char **argv)
+{
+    const char *file[MAXFILE]={
+        "../data/rcvraw/ubx_20080526.ubx","../data/rcvraw/oemv_200911218.gps",
+        "../data/rcvraw/cres_20080526.bin","../data/rcvraw/javad_20110115.jps"
+    };
+    int format[MAXFILE]={STRFMT_UBX,STRFMT_OEM4,STRFMT_CRES,STRFMT_JAVAD};
+    int nfile=0,nrep=20,bsize=4096;
+
+    for (int i=1;i<argc;i++) {
+        if (!strcmp(argv[i],"-r")&&i+1<argc) nrep=atoi(argv[++i]);
+        else if (!strcmp(argv[i],"-b")&&i+1<argc) bsize=atoi(argv[++i]);
+        else if (nfile<MAXFILE) {
+            const char *p=strchr(argv[i],':');
+            int k;
+            for (k=0;p&&fmtname[k];k++) {
+                if (!strncmp(fmtname[k],argv[i],p-argv[i])&&
+                    !fmtname[k][p-argv[i]]) break;
+            }
+            if (!p||!fmtname[k]) {
+                fprintf(stderr,"invalid format: %s\n",argv[i]);
+                return 1;
+            }
+            format[nfile]=fmtcode[k];
+            file[nfile++]=p+1;
+        }
+    }
+    if (nfile==0) nfile=4;
+    if (nrep<1) nrep=1;
+    if (bsize<1) bsize=1;
+
+    printf("repeat=%d block=%d\n",nrep,bsize);
+    printf("%-36s %-12s %8s %8s %12s %12s %8s\n","file","format","size(kB)","msgs",
+           "byte(MB/s)","buff(MB/s)","speedup");
+
+    for (int i=0;i<nfile;i++) {
+        msgsum_t s1,s2;
+        uint8_t *data;
+        int len=0;
+
+        if (!(data=readfile(file[i],&len))) {
+            fprintf(stderr,"file read error: %s\n",file[i]);
+            return 1;
+        }
+        double t1=inputdata(format[i],data,len,nrep,0,&s1);
+        double t2=inputdata(format[i],data,len,nrep,bsize,&s2);
+        free(data);
+        if (t1<0.0||t2<0.0) {
+            fprintf(stderr,"init_raw error: %s\n",file[i]);
+            return 1;
+        }
+        if (s1.nmsg!=s2.nmsg||s1.nobs!=s2.nobs||s1.sum!=s2.sum) {
+            fprintf(stderr,"decoded messages differ: %s nmsg=%d %d nobs=%d %d\n",
+                    file[i],s1.nmsg,s2.nmsg,s1.nobs,s2.nobs);
+            return 1;
+        }
+        double mb=len*(double)nrep/1E6;
+        printf("%-36s %-12.12s %8.1f %8d %12.1f %12.1f %8.2f\n",file[i],
+               formatstrs[format[i]],len/1E3,s1.nmsg,t1>0.0?mb/t1*1E3:0.0,
+               t2>0.0?mb/t2*1E3:0.0,t2>0.0?t1/t2:0.0);
+    }
+    return 0;
+}
@@ -0,0 +1,218 @@
+/*------------------------------------------------------------------------------
+* rtklib benchmark : single-producer/single-consumer ring buffer contention
+*
+* usage : b_ring [-n nmsg] [-s size] [-b buffsize]
+*
+* a producer thread writes nmsg (default 1000000) messages of size (default
+* 512) bytes to a peek buffer of buffsize (default 32768) bytes while a
+* consumer thread drains it continuously, as the rtk server input/output
+* stages and the monitor do. compares the lock-free ring buffer (ringwrite()/
+* ringread()) with the locked linear buffer used before (lock, append or copy
+* and reset, unlock). prints the producer time per message (mean, p50, p99,
+* max) and the bytes received by the consumer. the producer is never blocked:
+* data which does not fit is dropped. then compares the throughput of
+* ringpush()/ringpop() of pointers, as the rtk server stage queues, against a
+* locked ring, and checks the order of the received pointers.
+*-----------------------------------------------------------------------------*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include "rtklib.h"
+
+typedef struct {            /* locked linear buffer type */
+    rtklib_lock_t lock;
+    uint8_t *buff;
+    int size,n;
+} lbuf_t;
+
+typedef struct {            /* locked ring of pointers type */
+    rtklib_lock_t lock;
+    void **buff;
+    uint32_t size,wp,rp;
+} lring_t;
+
+static ring_t ring;
+static lbuf_t lbuf;
+static lring_t lring;
+static int type,nmsg=1000000,size=512,bsize=32768;
+static volatile int done;
+static uint64_t nrecv,nerr;
+
+/* monotonic time (ns) -------------------------------------------------------*/
+static double timens(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec*1E9+ts.tv_nsec;
+}
+/* compare doubles -----------------------------------------------------------*/
+static int cmpdbl(const void *p1, const void *p2)
+{
+    double d=*(const double *)p1-*(const double *)p2;
+    return d<0.0?-1:(d>0.0?1:0);
+}
+/* locked linear buffer write/read (old rtksvr peek buffer) ------------------*/
+static void lbufwrite(lbuf_t *b, const uint8_t *data, int n)
+{
+    rtklib_lock(&b->lock);
+    n=n<b->size-b->n?n:b->size-b->n;
+    memcpy(b->buff+b->n,data,n);
+    b->n+=n;
+    rtklib_unlock(&b->lock);
+}
+static int lbufread(lbuf_t *b, uint8_t *data)
+{
+    int n;
+
+    rtklib_lock(&b->lock);
+    memcpy(data,b->buff,n=b->n);
+    b->n=0;
+    rtklib_unlock(&b->lock);
+    return n;
+}
+/* locked ring of pointers push/pop ------------------------------------------*/
+static int lringpush(lring_t *r, void *p)
+{
+    int stat=0;
+
+    rtklib_lock(&r->lock);
+    if (r->wp-r->rp<r->size) {
+        r->buff[r->wp++&(r->size-1)]=p;
+        stat=1;
+    }
+    rtklib_unlock(&r->lock);
+    return stat;
+}
+static int lringpop(lring_t *r, void **p)
+{
+    int stat=0;
+
+    rtklib_lock(&r->lock);
+    if (r->wp!=r->rp) {
+        *p=r->buff[r->rp++&(r->size-1)];
+        stat=1;
+    }
+    rtklib_unlock(&r->lock);
+    return stat;
+}
+/* consumer of byte stream ---------------------------------------------------*/
+static void *consumer(void *arg)
+{
+    uint8_t *buff=(uint8_t *)malloc(bsize);
+    int n;
+
+    (void)arg;
+    for (;;) {
+        int fin=done;
+        n=type?lbufread(&lbuf,buff):ringread(&ring,buff,bsize);
+        nrecv+=n;
+        if (fin&&!n) break;
+        if (!n) sched_yield();
+    }
+    free(buff);
+    return NULL;
+}
+/* byte stream benchmark -----------------------------------------------------*/
+static void bench_stream(void)
+{
+    pthread_t thread;
+    uint8_t *data=(uint8_t *)malloc(size);
+    double *t=(double *)malloc(sizeof(double)*nmsg),t0,t1,sum=0.0;
+    int i;
+
+    for (i=0;i<size;i++) data[i]=(uint8_t)i;
+    done=0; nrecv=0;
+    pthread_create(&thread,NULL,consumer,NULL);
+    for (i=0;i<nmsg;i++) {
+        t0=timens();
+        if (type) lbufwrite(&lbuf,data,size); else ringwrite(&ring,data,size);
+        t1=timens();
+        sum+=t[i]=t1-t0;
+    }
+    done=1;
+    pthread_join(thread,NULL);
+    qsort(t,nmsg,sizeof(double),cmpdbl);
+    printf("%-14s %10.1f %10.1f %10.1f %10.1f %12.1f\n",
+           type?"locked buffer":"ring buffer",sum/nmsg,t[nmsg/2],
+           t[(int)(nmsg*0.99)],t[nmsg-1],nrecv*1E-6);
+    free(data);
+    free(t);
+}
+/* consumer of pointers ------------------------------------------------------*/
+static void *popper(void *arg)
+{
+    void *p;
+    int n=0;
+
+    (void)arg;
+    while (n<nmsg) {
+        if (type?lringpop(&lring,&p):ringpop(&ring,&p)) {
+            if ((size_t)p!=(size_t)++n) nerr++;
+        }
+        else sched_yield();
+    }
+    return NULL;
+}
+/* pointer queue benchmark ---------------------------------------------------*/
+static void bench_queue(void)
+{
+    pthread_t thread;
+    double t0,t1;
+    size_t i;
+
+    nerr=0;
+    pthread_create(&thread,NULL,popper,NULL);
+    t0=timens();
+    for (i=1;i<=(size_t)nmsg;i++) {
+        void *p=(void *)i;
+        while (!(type?lringpush(&lring,p):ringpush(&ring,&p))) sched_yield();
+    }
+    pthread_join(thread,NULL);
+    t1=timens();
+    printf("%-14s %10.1f %12.2f %12s\n",type?"locked ring":"ring buffer",
+           (t1-t0)/nmsg,nmsg/(t1-t0)*1E3,
+           nerr?"error":"ok");
+}
+int main(int argc, char **argv)
+{
+    int i;
+
+    for (i=1;i<argc;i++) {
+        if      (!strcmp(argv[i],"-n")&&i+1<argc) nmsg =atoi(argv[++i]);
+        else if (!strcmp(argv[i],"-s")&&i+1<argc) size =atoi(argv[++i]);
+        else if (!strcmp(argv[i],"-b")&&i+1<argc) bsize=atoi(argv[++i]);
+    }
+    if (nmsg<1||size<1||bsize<size) {
+        fprintf(stderr,"usage: b_ring [-n nmsg] [-s size] [-b buffsize]\n");
+        return 1;
+    }
+    ringinit(&ring,bsize,1);
+    bsize=(int)ring.size;
+    rtklib_initlock(&lbuf.lock);
+    lbuf.buff=(uint8_t *)malloc(bsize);
+    lbuf.size=bsize;
+    lbuf.n=0;
+
+    printf("peek buffer: msgs=%d size=%d buffsize=%d\n",nmsg,size,bsize);
+    printf("%-14s %10s %10s %10s %10s %12s\n","","write(ns)","p50(ns)",
+           "p99(ns)","max(ns)","recv(MB)");
+    for (type=0;type<2;type++) bench_stream();
+    ringfree(&ring);
+    free(lbuf.buff);
+
+    ringinit(&ring,RTKSVRQLEN,sizeof(void *));
+    rtklib_initlock(&lring.lock);
+    lring.size=ring.size;
+    lring.wp=lring.rp=0;
+    lring.buff=(void **)malloc(sizeof(void *)*lring.size);
+
+    printf("\nqueue of pointers: msgs=%d qlen=%d\n",nmsg,(int)ring.size);
+    printf("%-14s %10s %12s %12s\n","","push(ns)","Mmsg/s","sequence");
+    for (type=0;type<2;type++) bench_queue();
+    ringfree(&ring);
+    free(lring.buff);
+    return 0;
+}
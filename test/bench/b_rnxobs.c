@@ -0,0 +1,153 @@
+/*------------------------------------------------------------------------------
+* rtklib benchmark : RINEX observation field decoding
+*
+* usage : b_rnxobs [-r nrep] [-t nthread] [-c chunk] [obsfile ...]
+*
+* reads the RINEX observation files (default the 2005 rover/base data) and
+* decodes the 16-column observation fields (F14.3 value, LLI and SSI) of all
+* data records nrep (default 20) times by str2num() and by the fixed-point
+* str2fix(), then reads the files nrep times by readrnx() serially and by
+* chunks in nthread (default 8) threads (setrnxthread(), RINEX 3/4 only, chunk
+* default 4 MB). prints the throughput in MB/s of the data records and the
+* files and fails if the decoded values or the obs data differ.
+*-----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "rtklib.h"
+
+#define MAXLINES    1000000
+
+typedef struct {        /* data record lines type */
+    char **line;        /* lines */
+    int n;              /* number of lines */
+    size_t size;        /* size of lines (bytes) */
+} lines_t;
+
+/* read data record lines after header ---------------------------------------*/
+static int readlines(const char *file, lines_t *lines, size_t *fsize)
+{
+    FILE *fp;
+    char buff[4096];
+    int data=0;
+
+    if (!(fp=fopen(file,"r"))) return 0;
+    while (fgets(buff,sizeof(buff),fp)) {
+        *fsize+=strlen(buff);
+        if (!data) {
+            data=strstr(buff,"END OF HEADER")!=NULL;
+            continue;
+        }
+        if (lines->n>=MAXLINES) break;
+        lines->line[lines->n]=(char *)malloc(strlen(buff)+1);
+        strcpy(lines->line[lines->n++],buff);
+        lines->size+=strlen(buff);
+    }
+    fclose(fp);
+    return 1;
+}
+/* read files by readrnx(), return time (ms) ---------------------------------*/
+static double readfiles(const char **file, int nfile, int nrep, obs_t *obs)
+{
+    uint32_t tick=tickget();
+
+    for (int r=0;r<nrep;r++) {
+        freeobs(obs);
+        for (int i=0;i<nfile;i++) readrnx(file[i],i+1,"",obs,NULL,NULL);
+    }
+    return (double)(tickget()-tick);
+}
+/* decode fields of lines, return time (ms) ----------------------------------*/
+static double decode(const lines_t *lines, int nrep, int fix, double *sum)
+{
+    uint32_t tick=tickget();
+    double s=0.0;
+
+    for (int r=0;r<nrep;r++) {
+        for (int i=0;i<lines->n;i++) {
+            const char *buff=lines->line[i];
+            int len=(int)strlen(buff);
+            for (int j=len%16==4?3:0;j<len;j+=16) {
+                if (fix) {
+                    char c=j+14<len?buff[j+14]:'\0',d=j+15<len?buff[j+15]:'\0';
+                    s+=str2fix(buff+j,0,14);
+                    s+=(c>='0'&&c<='9'?c-'0':0)&3;
+                    s+=d>='0'&&d<='9'?d-'0':0;
+                }
+                else {
+                    s+=str2num(buff,j,14);
+                    s+=(int)str2num(buff,j+14,1)&3;
+                    s+=str2num(buff,j+15,1);
+                }
+            }
+        }
+    }
+    *sum=s;
+    return (double)(tickget()-tick);
+}
+int main(int argc, char **argv)
+{
+    const char *file[16]={"../data/rinex/07590920.05o","../data/rinex/30400920.05o"};
+    lines_t lines={0};
+    obs_t obs1={0},obs2={0};
+    size_t fsize=0;
+    long chunk=0;
+    int nfile=0,nrep=20,nthread=8;
+
+    for (int i=1;i<argc;i++) {
+        if (!strcmp(argv[i],"-r")&&i+1<argc) nrep=atoi(argv[++i]);
+        else if (!strcmp(argv[i],"-t")&&i+1<argc) nthread=atoi(argv[++i]);
+        else if (!strcmp(argv[i],"-c")&&i+1<argc) chunk=atol(argv[++i]);
+        else if (nfile<16) file[nfile++]=argv[i];
+    }
+    if (nfile==0) nfile=2;
+    if (nrep<1) nrep=1;
+
+    lines.line=(char **)malloc(sizeof(char *)*MAXLINES);
+    for (int i=0;i<nfile;i++) {
+        if (!readlines(file[i],&lines,&fsize)) {
+            fprintf(stderr,"file read error: %s\n",file[i]);
+            return 1;
+        }
+    }
+    double s0,s1;
+    double t0=decode(&lines,nrep,0,&s0);
+    double t1=decode(&lines,nrep,1,&s1);
+
+    /* same decoded values */
+    if (s0!=s1) {
+        fprintf(stderr,"decoded values differ: sum=%.17g %.17g\n",s0,s1);
+        return 1;
+    }
+
+    setrnxthread(1,0);
+    double t2=readfiles(file,nfile,nrep,&obs1);
+    setrnxthread(nthread,chunk);
+    double t3=readfiles(file,nfile,nrep,&obs2);
+
+    /* same obs data */
+    int same=obs1.n==obs2.n;
+    for (int i=0;same&&i<obs1.n;i++) {
+        const obsd_t *d1=obs1.data+i,*d2=obs2.data+i;
+        same=timediff(d1->time,d2->time)==0.0&&d1->sat==d2->sat&&
+             !memcmp(d1->L,d2->L,sizeof(d1->L))&&!memcmp(d1->P,d2->P,sizeof(d1->P))&&
+             !memcmp(d1->LLI,d2->LLI,sizeof(d1->LLI));
+    }
+    if (!same) {
+        fprintf(stderr,"obs data differ: obs=%d %d\n",obs1.n,obs2.n);
+        return 1;
+    }
+    double mb=lines.size*nrep/1E6,mbf=fsize*nrep/1E6;
+    printf("files=%d lines=%d size=%.1f MB obs=%d repeat=%d threads=%d\n",nfile,
+           lines.n,fsize/1E6,obs1.n,nrep,nthread);
+    printf("%14s %14s %8s %14s %14s %8s\n","str2num(MB/s)","str2fix(MB/s)",
+           "speedup","readrnx(MB/s)","chunked(MB/s)","speedup");
+    printf("%14.1f %14.1f %8.2f %14.1f %14.1f %8.2f\n",t0>0.0?mb/t0*1E3:0.0,
+           t1>0.0?mb/t1*1E3:0.0,t1>0.0?t0/t1:0.0,t2>0.0?mbf/t2*1E3:0.0,
+           t3>0.0?mbf/t3*1E3:0.0,t3>0.0?t2/t3:0.0);
+
+    freeobs(&obs1);
+    freeobs(&obs2);
+    for (int i=0;i<lines.n;i++) free(lines.line[i]);
+    free(lines.line);
+    return 0;
+}
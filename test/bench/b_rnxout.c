@@ -0,0 +1,140 @@
+/*------------------------------------------------------------------------------
+* rtklib benchmark : RINEX output
+*
+* usage : b_rnxout [-r nrep] [-v ver] [ubxfile]
+*
+* converts the u-blox raw log (default the 2008 UBX test data) to RINEX obs and
+* nav files (version ver, default 3.04) nrep (default 10) times by convrnx() as
+* convbin does, then formats the fields of the output obs data nrep times by
+* fprintf() style "%14.3f" (snprintf()) and by the fixed-point fix2str() used
+* by outrnxobsb(). prints the latency and the throughput of the conversion and
+* the throughput of the field formatting, and fails if the formatted fields
+* differ.
+*-----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "rtklib.h"
+
+#define NOUTFILE    9                   /* number of convrnx output files */
+
+/* convert log to RINEX, return time (ms) ------------------------------------*/
+static double convfile(const char *file, int ver, int nrep, char **ofile)
+{
+    uint32_t tick=tickget();
+
+    for (int r=0;r<nrep;r++) {
+        rnxopt_t opt={0};
+        opt.rnxver=ver;
+        opt.obstype=OBSTYPE_PR|OBSTYPE_CP|OBSTYPE_DOP|OBSTYPE_SNR;
+        opt.navsys=SYS_ALL;
+        opt.freqtype=FREQTYPE_ALL;
+        opt.ttol=0.005;
+        for (int i=0;i<RNX_NUMSYS;i++) {
+            for (int j=0;j<MAXCODE;j++) opt.mask[i][j]='1';
+        }
+        if (convrnx(STRFMT_UBX,&opt,file,ofile)<=0) return -1.0;
+    }
+    return (double)(tickget()-tick);
+}
+/* format obs data fields, return time (ms) ----------------------------------*/
+static double format(const obs_t *obs, int nrep, int fix, char *out, size_t *size)
+{
+    uint32_t tick=tickget();
+    char *p=out;
+
+    for (int r=0;r<nrep;r++) {
+        p=out;
+        for (int i=0;i<obs->n;i++) {
+            const obsd_t *d=obs->data+i;
+            for (int j=0;j<NFREQ+NEXOBS;j++) {
+                double v[4]={d->L[j],d->P[j],d->D[j],d->SNR[j]};
+                for (int k=0;k<4;k++) {
+                    if (v[k]==0.0) continue;
+                    if (fix) {
+                        char str[64];
+                        int n=fix2str(str,sizeof(str),fmod(v[k],1e9),3);
+                        if (n<14) {
+                            memset(p,' ',14-n);
+                            p+=14-n;
+                        }
+                        memcpy(p,str,n);
+                        p+=n;
+                    }
+                    else {
+                        p+=sprintf(p,"%14.3f",fmod(v[k],1e9));
+                    }
+                }
+            }
+        }
+    }
+    *size=(size_t)(p-out);
+    return (double)(tickget()-tick);
+}
+/* size of file (bytes) ------------------------------------------------------*/
+static long filesize(const char *file)
+{
+    FILE *fp=fopen(file,"rb");
+    long n=0;
+
+    if (fp) {
+        if (!fseek(fp,0,SEEK_END)) n=ftell(fp);
+        fclose(fp);
+    }
+    return n;
+}
+int main(int argc, char **argv)
+{
+    const char *file="../data/rcvraw/ubx_20080526.ubx";
+    const char *obsfile="b_rnxout_tmp.obs",*navfile="b_rnxout_tmp.nav";
+    char *ofile[NOUTFILE],buff[NOUTFILE][1024]={"",""};
+    obs_t obs={0};
+    size_t size0,size1;
+    int nrep=10,ver=304;
+
+    for (int i=1;i<argc;i++) {
+        if (!strcmp(argv[i],"-r")&&i+1<argc) nrep=atoi(argv[++i]);
+        else if (!strcmp(argv[i],"-v")&&i+1<argc) ver=(int)(atof(argv[++i])*100.0+0.5);
+        else file=argv[i];
+    }
+    if (nrep<1) nrep=1;
+    strcpy(buff[0],obsfile);
+    strcpy(buff[1],navfile);
+    for (int i=0;i<NOUTFILE;i++) ofile[i]=buff[i];
+
+    double t0=convfile(file,ver,nrep,ofile);
+    if (t0<0.0) {
+        fprintf(stderr,"convert error: %s\n",file);
+        return 1;
+    }
+    long osize=filesize(obsfile)+filesize(navfile);
+    readrnx(obsfile,1,"",&obs,NULL,NULL);
+    remove(obsfile);
+    remove(navfile);
+    if (obs.n<=0) {
+        fprintf(stderr,"no obs data: %s\n",obsfile);
+        return 1;
+    }
+    char *out0=(char *)malloc((size_t)obs.n*(NFREQ+NEXOBS)*4*32+1);
+    char *out1=(char *)malloc((size_t)obs.n*(NFREQ+NEXOBS)*4*32+1);
+    if (!out0||!out1) return 1;
+    double t1=format(&obs,nrep,0,out0,&size0);
+    double t2=format(&obs,nrep,1,out1,&size1);
+
+    /* same formatted fields */
+    if (size0!=size1||memcmp(out0,out1,size0)) {
+        fprintf(stderr,"formatted fields differ\n");
+        return 1;
+    }
+    double mb=osize*nrep/1E6,mbf=size0*nrep/1E6;
+    printf("file=%s size=%.1f MB rinex=%.2f obs=%d repeat=%d\n",file,
+           filesize(file)/1E6,ver/100.0,obs.n,nrep);
+    printf("%12s %14s %14s %14s %8s\n","convrnx(ms)","convrnx(MB/s)",
+           "fprintf(MB/s)","fix2str(MB/s)","speedup");
+    printf("%12.2f %14.1f %14.1f %14.1f %8.2f\n",t0/nrep,t0>0.0?mb/t0*1E3:0.0,
+           t1>0.0?mbf/t1*1E3:0.0,t2>0.0?mbf/t2*1E3:0.0,t2>0.0?t1/t2:0.0);
+
+    free(out0);
+    free(out1);
+    freeobs(&obs);
+    return 0;
+}
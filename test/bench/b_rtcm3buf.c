@@ -0,0 +1,188 @@
+/*------------------------------------------------------------------------------
+* rtklib benchmark : RTCM 3 input by buffer
+*
+* usage : b_rtcm3buf [-r nrep] [-b size] [ubxfile|rtcm3file]
+*
+* generates RTCM 3 MSM7 and ephemeris messages from the u-blox raw log (default
+* the 2008 UBX test data) with junk bytes between the frames, or reads the
+* RTCM 3 file (*.rtcm3), to memory and inputs them nrep (default 200) times by
+* input_rtcm3() byte by byte and by input_rtcm3_buf() in blocks of size
+* (default 4096) bytes as a stream server does. then computes the CRC-24Q of
+* the frames nrep times by the byte-wise table loop and by rtk_crc24q().
+* prints the MB/s of both and fails if the decoded messages or the CRCs
+* differ.
+*-----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "rtklib.h"
+#include "genrtcm3.h"
+
+typedef struct {        /* data buffer type */
+    uint8_t *data;      /* data */
+    int n,nmax;         /* number of data/allocated */
+} databuf_t;
+
+typedef struct {        /* decoded message summary type */
+    int nmsg;           /* number of messages (status!=0) */
+    int nobs;           /* number of obs data */
+    uint32_t sum;       /* checksum of status sequence */
+} msgsum_t;
+
+/* add data to buffer --------------------------------------------------------*/
+static int adddata(databuf_t *buf, const uint8_t *data, int n)
+{
+    if (buf->n+n>buf->nmax) {
+        int nmax=buf->nmax<=0?65536:buf->nmax*2;
+        uint8_t *p;
+        while (nmax<buf->n+n) nmax*=2;
+        if (!(p=(uint8_t *)realloc(buf->data,nmax))) return 0;
+        buf->data=p;
+        buf->nmax=nmax;
+    }
+    memcpy(buf->data+buf->n,data,n);
+    buf->n+=n;
+    return 1;
+}
+/* output generated frame with junk bytes after MSM -------------------------*/
+static void outframe(const uint8_t *buff, int nbyte, int type, void *arg)
+{
+    static const uint8_t junk[]={0x00,0xFF,0x55,0xAA,0x12,0x34,0xD2,0xD4};
+    static int nframe=0;
+    databuf_t *buf=(databuf_t *)arg;
+
+    adddata(buf,buff,nbyte);
+    if (type!=1019) adddata(buf,junk,1+nframe++%(int)sizeof(junk));
+}
+/* read file to buffer -------------------------------------------------------*/
+static int readfile(const char *file, databuf_t *buf)
+{
+    FILE *fp=fopen(file,"rb");
+    uint8_t data[4096];
+    size_t n;
+
+    if (!fp) return 0;
+    while ((n=fread(data,1,sizeof(data),fp))>0) adddata(buf,data,(int)n);
+    fclose(fp);
+    return buf->n>0;
+}
+/* update message summary ----------------------------------------------------*/
+static void summsg(msgsum_t *s, const rtcm_t *rtcm, int ret)
+{
+    if (ret==0) return;
+    s->nmsg++;
+    s->sum=s->sum*31+(uint32_t)(ret+2);
+    if (ret==1) s->nobs+=rtcm->obs.n;
+}
+/* input data, return time (ms) ----------------------------------------------*/
+static double inputdata(const uint8_t *data, int len, int nrep, int bsize,
+                        msgsum_t *s)
+{
+    rtcm_t rtcm;
+    uint32_t tick=tickget();
+
+    for (int r=0;r<nrep;r++) {
+        memset(s,0,sizeof(msgsum_t));
+        if (!init_rtcm(&rtcm)) return -1.0;
+        if (bsize<=0) {
+            for (int i=0;i<len;i++) summsg(s,&rtcm,input_rtcm3(&rtcm,data[i]));
+        }
+        else {
+            for (int i=0;i<len;i+=bsize) {
+                int n=len-i<bsize?len-i:bsize;
+                for (int j=0,m;j<n;j+=m) {
+                    summsg(s,&rtcm,input_rtcm3_buf(&rtcm,data+i+j,n-j,&m));
+                }
+            }
+        }
+        free_rtcm(&rtcm);
+    }
+    return (double)(tickget()-tick);
+}
+/* byte-wise crc-24q ---------------------------------------------------------*/
+static uint32_t crc24q_byte(const uint8_t *buff, int len)
+{
+    static uint32_t tbl[256];
+    uint32_t crc=0;
+
+    if (!tbl[1]) {
+        for (int i=0;i<256;i++) {
+            uint32_t c=(uint32_t)i<<16;
+            for (int j=0;j<8;j++) c=(c&0x800000)?(c<<1)^0x864CFB:c<<1;
+            tbl[i]=c&0xFFFFFF;
+        }
+    }
+    for (int i=0;i<len;i++) crc=((crc<<8)&0xFFFFFF)^tbl[(crc>>16)^buff[i]];
+    return crc;
+}
+/* crc-24q of frames, return time (ms) ---------------------------------------*/
+static double crcframes(const uint8_t *data, int len, int nrep, int slice,
+                        uint32_t *sum, double *nbyte)
+{
+    uint32_t tick=tickget();
+
+    *sum=0;
+    *nbyte=0.0;
+    for (int r=0;r<nrep;r++) {
+        for (int i=0;i+3<=len;) {
+            int n=((data[i+1]&3)<<8|data[i+2])+3;
+            if (data[i]!=0xD3||i+n+3>len) {
+                i++;
+                continue;
+            }
+            *sum+=slice?rtk_crc24q(data+i,n):crc24q_byte(data+i,n);
+            *nbyte+=n;
+            i+=n+3;
+        }
+    }
+    return (double)(tickget()-tick);
+}
+int main(int argc, char **argv)
+{
+    static const int msgs[]={1077,1087,1097,1117,1127};
+    const char *file="../data/rcvraw/ubx_20080526.ubx";
+    databuf_t buf={0};
+    msgsum_t s1,s2;
+    uint32_t c1,c2;
+    double n1,n2;
+    int nrep=200,bsize=4096;
+
+    for (int i=1;i<argc;i++) {
+        if (!strcmp(argv[i],"-r")&&i+1<argc) nrep=atoi(argv[++i]);
+        else if (!strcmp(argv[i],"-b")&&i+1<argc) bsize=atoi(argv[++i]);
+        else file=argv[i];
+    }
+    if (nrep<1) nrep=1;
+    if (bsize<1) bsize=1;
+
+    if (!(strstr(file,".rtcm3")?readfile(file,&buf):genrtcm3(file,msgs,5,GENRTCM3_EPH,outframe,&buf))) {
+        fprintf(stderr,"no rtcm3 data: %s\n",file);
+        return 1;
+    }
+    double t1=inputdata(buf.data,buf.n,nrep,0,&s1);
+    double t2=inputdata(buf.data,buf.n,nrep,bsize,&s2);
+    if (t1<0.0||t2<0.0) {
+        fprintf(stderr,"init_rtcm error\n");
+        return 1;
+    }
+    if (s1.nmsg<=0||s1.nmsg!=s2.nmsg||s1.nobs!=s2.nobs||s1.sum!=s2.sum) {
+        fprintf(stderr,"decoded messages differ: nmsg=%d %d nobs=%d %d\n",
+                s1.nmsg,s2.nmsg,s1.nobs,s2.nobs);
+        return 1;
+    }
+    double t3=crcframes(buf.data,buf.n,nrep,0,&c1,&n1);
+    double t4=crcframes(buf.data,buf.n,nrep,1,&c2,&n2);
+    if (c1!=c2) {
+        fprintf(stderr,"crc-24q differ: %06X %06X\n",c1,c2);
+        return 1;
+    }
+    double mb=buf.n*(double)nrep/1E6;
+    printf("file=%s size=%.1f kB msgs=%d repeat=%d block=%d\n",file,buf.n/1E3,
+           s1.nmsg,nrep,bsize);
+    printf("%12s %12s %8s %12s %12s %8s\n","byte(MB/s)","buff(MB/s)","speedup",
+           "crc(MB/s)","slice8(MB/s)","speedup");
+    printf("%12.1f %12.1f %8.2f %12.1f %12.1f %8.2f\n",t1>0.0?mb/t1*1E3:0.0,
+           t2>0.0?mb/t2*1E3:0.0,t2>0.0?t1/t2:0.0,t3>0.0?n1/1E3/t3:0.0,
+           t4>0.0?n2/1E3/t4:0.0,t4>0.0?t3/t4:0.0);
+    free(buf.data);
+    return 0;
+}
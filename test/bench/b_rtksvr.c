@@ -0,0 +1,210 @@
+/*------------------------------------------------------------------------------
+* rtklib benchmark : rtk server input-to-solution latency
+*
+* usage : b_rtksvr [-c cycle] [-m nepoch] [-p port] [file]
+*
+* starts the rtk server in single point positioning with the rover input and
+* the solution 1 output as tcp server streams on the loopback ports port
+* (default 12111) and port+1. the receiver raw data file (default the u-blox
+* data in test/data/rcvraw) is split at the ends of the observation epochs and
+* the epochs are sent to the rover input one by one at random phases of the
+* server cycle (default 10 ms). the epochs before the first solution are for
+* warm-up (ephemerides) and not measured. prints the percentiles of the
+* latency from sending the last byte of an epoch until receiving its solution
+* and the latency measured by the server, rtksvrlatency(), for nepoch
+* (default 200) solutions.
+*-----------------------------------------------------------------------------*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include "rtklib.h"
+
+#define MAXEPOCH    4096
+#define TIMEOUT     1000            /* timeout of solution (ms) */
+
+/* monotonic time (us) -------------------------------------------------------*/
+static double timeus(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec*1E6+ts.tv_nsec*1E-3;
+}
+/* compare doubles -----------------------------------------------------------*/
+static int cmpdbl(const void *p1, const void *p2)
+{
+    double d=*(const double *)p1-*(const double *)p2;
+    return d<0.0?-1:(d>0.0?1:0);
+}
+/* connect to loopback port, return socket (-1: error) -----------------------*/
+static int concli(int port)
+{
+    struct sockaddr_in addr={0};
+    int sock,mode=1;
+
+    addr.sin_family=AF_INET;
+    addr.sin_port=htons(port);
+    addr.sin_addr.s_addr=htonl(INADDR_LOOPBACK);
+    if ((sock=socket(AF_INET,SOCK_STREAM,0))<0) return -1;
+    setsockopt(sock,IPPROTO_TCP,TCP_NODELAY,&mode,sizeof(mode));
+    if (connect(sock,(struct sockaddr *)&addr,sizeof(addr))<0) {
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+/* split raw data at ends of observation epochs ------------------------------*/
+static int splitepoch(const char *file, int format, uint8_t **buff, int *end,
+                      gtime_t *time)
+{
+    raw_t raw;
+    FILE *fp;
+    long size;
+    int i,n=0;
+
+    if (!(fp=fopen(file,"rb"))) return 0;
+    fseek(fp,0,SEEK_END); size=ftell(fp); fseek(fp,0,SEEK_SET);
+    if (size<=0||!(*buff=(uint8_t *)malloc(size))||
+        fread(*buff,1,size,fp)!=(size_t)size) {
+        fclose(fp);
+        return 0;
+    }
+    fclose(fp);
+    if (!init_raw(&raw,format)) return 0;
+    for (i=0;i<size&&n<MAXEPOCH;i++) {
+        if (input_raw(&raw,format,(*buff)[i])!=1) continue;
+        if (n==0) *time=raw.time;
+        end[n++]=i+1;
+    }
+    free_raw(&raw);
+    return n;
+}
+/* receive solution line, return quality (-1: timeout) -----------------------*/
+static int recvsol(int sock, char *line, int *nb, int timeout)
+{
+    struct pollfd pfd={0};
+    char *p;
+    int n,q;
+
+    pfd.fd=sock;
+    pfd.events=POLLIN;
+    for (;;) {
+        while ((p=strchr(line,'\n'))) {
+            *p='\0';
+            q=-1;
+            if (*line!='%') sscanf(line,"%*s %*s %*s %*s %*s %d",&q);
+            n=(int)(p-line)+1;
+            memmove(line,p+1,*nb-n+1);
+            *nb-=n;
+            if (q>0) return q;
+        }
+        if (poll(&pfd,1,timeout)<=0) return -1;
+        if ((n=recv(sock,line+*nb,4095-*nb,0))<=0) return -1;
+        line[*nb+=n]='\0';
+    }
+}
+int main(int argc, char **argv)
+{
+    static rtksvr_t svr;
+    prcopt_t prcopt=prcopt_default;
+    solopt_t solopt[RTKSVRNSOL];
+    gtime_t time={0};
+    const char *file="../data/rcvraw/ubx_20080526.ubx";
+    const char *paths[MAXSTRRTK],*cmds[RTKSVRNIN]={0},*cmds_p[RTKSVRNIN]={0};
+    const char *ropts[RTKSVRNIN]={"","","",""};
+    char path_in[32],path_out[32],line[4096]="",errmsg[2048];
+    uint8_t *buff=NULL;
+    double nmeapos[3]={0},*lat,p50,p99;
+    int cycle=10,nepoch=200,port=12111,strs[MAXSTRRTK]={0};
+    int formats[RTKSVRNIN]={STRFMT_UBX,STRFMT_RTCM3,STRFMT_RTCM3,STRFMT_RTCM3};
+    int *end,nend,sin,sout,nb=0,n=0,nmiss=0,nwarm=0;
+
+    for (int i=1;i<argc;i++) {
+        if (!strcmp(argv[i],"-c")&&i+1<argc) cycle=atoi(argv[++i]);
+        else if (!strcmp(argv[i],"-m")&&i+1<argc) nepoch=atoi(argv[++i]);
+        else if (!strcmp(argv[i],"-p")&&i+1<argc) port=atoi(argv[++i]);
+        else file=argv[i];
+    }
+    if (cycle<1) cycle=1;
+    if (nepoch<1) nepoch=1;
+    signal(SIGPIPE,SIG_IGN);
+
+    end=(int *)malloc(sizeof(int)*MAXEPOCH);
+    lat=(double *)malloc(sizeof(double)*nepoch);
+    if (!end||!lat||!(nend=splitepoch(file,formats[0],&buff,end,&time))) {
+        fprintf(stderr,"data read error: %s\n",file);
+        return 1;
+    }
+    /* set current time to resolve week numbers of ephemerides */
+    timeset(gpst2utc(time));
+
+    /* start rtk server */
+    for (int i=0;i<MAXSTRRTK;i++) paths[i]="";
+    for (int i=0;i<RTKSVRNSOL;i++) {
+        solopt[i]=solopt_default;
+        solopt[i].outhead=0;
+    }
+    sprintf(path_in,":%d",port);
+    sprintf(path_out,":%d",port+1);
+    strs[0]=STR_TCPSVR; paths[0]=path_in;
+    strs[RTKSVRNIN*2]=STR_TCPSVR; paths[RTKSVRNIN*2]=path_out;
+    prcopt.mode=PMODE_SINGLE;
+    prcopt.navsys=SYS_GPS;
+
+    strinitcom();
+    rtksvrinit(&svr);
+    if (!rtksvrstart(&svr,cycle,32768,strs,paths,formats,0,cmds,cmds_p,ropts,
+                     0,0,nmeapos,&prcopt,solopt,NULL,errmsg)) {
+        fprintf(stderr,"rtk server start error: %s\n",errmsg);
+        return 1;
+    }
+    if ((sin=concli(port))<0||(sout=concli(port+1))<0) {
+        fprintf(stderr,"connect error: port=%d\n",port);
+        return 1;
+    }
+    sleepms(200+2*cycle); /* wait for accepting connections */
+
+    /* send epochs at random phases of the server cycle */
+    srand(1);
+    for (int k=0;k<nend&&n<nepoch;k++) {
+        int start=k>0?end[k-1]:0;
+        usleep(1000+rand()%(cycle*1000));
+        double t0=timeus();
+        if (send(sin,buff+start,end[k]-start,0)!=end[k]-start) {
+            fprintf(stderr,"send error: epoch=%d\n",k);
+            return 1;
+        }
+        if (recvsol(sout,line,&nb,n>0?TIMEOUT:2*cycle+50)<0) {
+            if (n>0) nmiss++; else nwarm++;
+            continue;
+        }
+        lat[n++]=(timeus()-t0)*1E-3;
+    }
+    int nlat=rtksvrlatency(&svr,&p50,&p99);
+    rtksvrstop(&svr,cmds);
+    close(sin);
+    close(sout);
+
+    if (n<=0) {
+        fprintf(stderr,"no solution: epochs=%d\n",nend);
+        return 1;
+    }
+    qsort(lat,n,sizeof(double),cmpdbl);
+    printf("file=%s cycle=%d ms epochs=%d warmup=%d solutions=%d missing=%d\n",
+           file,cycle,nend,nwarm,n,nmiss);
+    printf("%10s %10s %10s %10s %14s %14s\n","p50(ms)","p99(ms)","max(ms)",
+           "mean(ms)","svr p50(ms)","svr p99(ms)");
+    double mean=0.0;
+    for (int i=0;i<n;i++) mean+=lat[i]/n;
+    printf("%10.3f %10.3f %10.3f %10.3f %14.3f %14.3f\n",lat[n/2],
+           lat[(int)(n*0.99)],lat[n-1],mean,nlat>0?p50:0.0,nlat>0?p99:0.0);
+    free(buff); free(end); free(lat);
+    return 0;
+}
@@ -0,0 +1,201 @@
+/*------------------------------------------------------------------------------
+* rtklib benchmark : broadcast ephemeris selection
+*
+* usage : b_satposs [-d ndays] [-r nrep] [navfile ...]
+*
+* reads the navigation files, replicates the ephemerides shifted by whole days
+* to ndays (default 7) of data and computes the satellite positions by
+* satposs() every 30 s over the span with the per-satellite ephemeris index
+* and the evaluated ephemerides (after uniqnav() and evalnav()), with the index
+* only and with the linear scan (index disabled). prints the time per epoch
+* and fails if the satellite positions differ. the glonass orbits with the
+* Hermite interpolation (pos1-gloorb=hermite) are compared with the RK4
+* integration and fail by 1E-3 m or more. also compares eph2pos() and
+* the batch ephc2poss() for all ephemerides and fails if the positions differ
+* by 1E-6 m or more.
+*-----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "rtklib.h"
+
+/* replicate ephemerides shifted by whole days -------------------------------*/
+static void repnav(nav_t *nav, int ndays)
+{
+    int n=nav->n,ng=nav->ng;
+
+    for (int d=1;d<ndays;d++) {
+        double dt=d*86400.0;
+        for (int i=0;i<n;i++) {
+            eph_t eph=nav->eph[i];
+            eph.toe=timeadd(eph.toe,dt);
+            eph.toc=timeadd(eph.toc,dt);
+            eph.ttr=timeadd(eph.ttr,dt);
+            eph.toes=time2gpst(eph.toe,&eph.week);
+            if (nav->n>=nav->nmax) {
+                nav->nmax=nav->nmax<=0?1024:nav->nmax*2;
+                nav->eph=(eph_t *)realloc(nav->eph,sizeof(eph_t)*nav->nmax);
+            }
+            nav->eph[nav->n++]=eph;
+        }
+        for (int i=0;i<ng;i++) {
+            geph_t geph=nav->geph[i];
+            geph.toe=timeadd(geph.toe,dt);
+            geph.tof=timeadd(geph.tof,dt);
+            if (nav->ng>=nav->ngmax) {
+                nav->ngmax=nav->ngmax<=0?1024:nav->ngmax*2;
+                nav->geph=(geph_t *)realloc(nav->geph,sizeof(geph_t)*nav->ngmax);
+            }
+            nav->geph[nav->ng++]=geph;
+        }
+    }
+}
+/* compare eph2pos() and ephc2poss(), return max difference (m) -------------*/
+static double cmpephc(const nav_t *nav, int nrep, double *t0, double *t1)
+{
+    const int nt=32;
+    gtime_t *time=(gtime_t *)malloc(sizeof(gtime_t)*nav->n*nt);
+    const ephc_t **ephc=(const ephc_t **)malloc(sizeof(ephc_t *)*nav->n*nt);
+    double *rs0=mat(3,nav->n*nt),*rs1=mat(3,nav->n*nt),*dts=mat(1,nav->n*nt);
+    double var,dmax=0.0;
+    int i,j,k;
+
+    for (i=k=0;i<nav->n;i++) for (j=0;j<nt;j++,k++) {
+        time[k]=timeadd(nav->eph[i].toe,-7200.0+j*450.0);
+        ephc[k]=nav->ephc+i;
+    }
+    uint32_t tick=tickget();
+    for (int r=0;r<nrep;r++) for (k=0;k<nav->n*nt;k++) {
+        eph2pos(time[k],nav->eph+k/nt,rs0+k*3,dts+k,&var);
+    }
+    *t0=(double)(tickget()-tick)/nrep;
+    tick=tickget();
+    for (int r=0;r<nrep;r++) ephc2poss(time,ephc,nav->n*nt,rs1,dts,dts);
+    *t1=(double)(tickget()-tick)/nrep;
+
+    for (k=0;k<nav->n*nt*3;k++) {
+        if (fabs(rs0[k]-rs1[k])>dmax) dmax=fabs(rs0[k]-rs1[k]);
+    }
+    free(time); free(ephc); free(rs0); free(rs1); free(dts);
+    return dmax;
+}
+/* compute satellite positions over the span, return time (ms) ---------------*/
+static double procsat(gtime_t ts, int nep, const obsd_t *obs, int n,
+                      const nav_t *nav, int nrep, double *rs)
+{
+    prcopt_t opt=prcopt_default;
+    double dts[2*MAXOBS],var[MAXOBS];
+    int svh[MAXOBS];
+    uint32_t tick=tickget();
+    obsd_t data[MAXOBS];
+
+    for (int k=0;k<nrep;k++) {
+        for (int i=0;i<nep;i++) {
+            gtime_t time=timeadd(ts,i*30.0);
+            for (int j=0;j<n;j++) {
+                data[j]=obs[j];
+                data[j].time=time;
+            }
+            satposs(time,data,n,nav,&opt,rs+i*6*n,dts,var,svh);
+        }
+    }
+    return (double)(tickget()-tick)/nrep;
+}
+int main(int argc, char **argv)
+{
+    const char *file[16]={"../data/tle/brdc3050.12n","../data/tle/brdc3050.12g"};
+    obsd_t obs[MAXOBS]={0};
+    nav_t nav={0};
+    gtime_t ts={0},te={0};
+    int nfile=0,ndays=7,nrep=1,n=0;
+
+    for (int i=1;i<argc;i++) {
+        if (!strcmp(argv[i],"-d")&&i+1<argc) ndays=atoi(argv[++i]);
+        else if (!strcmp(argv[i],"-r")&&i+1<argc) nrep=atoi(argv[++i]);
+        else if (nfile<16) file[nfile++]=argv[i];
+    }
+    if (nfile==0) nfile=2;
+
+    for (int i=0;i<nfile;i++) {
+        if (!readrnx(file[i],1,"",NULL,&nav,NULL)) {
+            fprintf(stderr,"file read error: %s\n",file[i]);
+            return 1;
+        }
+    }
+    repnav(&nav,ndays);
+    uniqnav(&nav);
+    evalnav(&nav,0);
+
+    /* time span and satellites of the ephemerides */
+    for (int i=0;i<nav.n+nav.ng;i++) {
+        gtime_t toe=i<nav.n?nav.eph[i].toe:nav.geph[i-nav.n].toe;
+        int sat=i<nav.n?nav.eph[i].sat:nav.geph[i-nav.n].sat,j;
+        if (ts.time==0||timediff(toe,ts)<0.0) ts=toe;
+        if (te.time==0||timediff(toe,te)>0.0) te=toe;
+        for (j=0;j<n;j++) if (obs[j].sat==sat) break;
+        if (j==n&&n<MAXOBS) {
+            obs[n].sat=sat;
+            obs[n++].P[0]=2.2E7;
+        }
+    }
+    int nep=(int)(timediff(te,ts)/30.0);
+    if (n<=0||nep<=0) {
+        fprintf(stderr,"no ephemeris\n");
+        return 1;
+    }
+    double *rs0=mat(6*n,nep),*rs1=mat(6*n,nep);
+
+    double t2=procsat(ts,nep,obs,n,&nav,nrep,rs1);
+
+    /* disable the evaluated ephemerides */
+    nav_t nav0=nav;
+    nav0.ephc=NULL;
+    nav0.gephc=NULL;
+    double t1=procsat(ts,nep,obs,n,&nav0,nrep,rs0);
+
+    /* the evaluated ephemerides do not change the satellite positions */
+    if (memcmp(rs0,rs1,sizeof(double)*6*n*nep)) {
+        fprintf(stderr,"satellite positions differ: evaluated ephemerides\n");
+        return 1;
+    }
+
+    /* disable the index to fall back to the linear scan */
+    nav0.ieph.n=nav0.igeph.n=nav0.iseph.n=-1;
+    double t0=procsat(ts,nep,obs,n,&nav0,nrep,rs0);
+
+    /* the index does not change the selected ephemerides */
+    if (memcmp(rs0,rs1,sizeof(double)*6*n*nep)) {
+        fprintf(stderr,"satellite positions differ: ephemeris index\n");
+        return 1;
+    }
+
+    /* glonass orbits by Hermite interpolation */
+    evalnav(&nav,1);
+    double t3=procsat(ts,nep,obs,n,&nav,nrep,rs0),hmax=0.0;
+    for (int i=0;i<nep*n;i++) for (int j=0;j<3;j++) {
+        double d=fabs(rs0[j+i*6]-rs1[j+i*6]);
+        if (d>hmax) hmax=d;
+    }
+    printf("neph=%d ngeph=%d nsat=%d epochs=%d repeat=%d\n",nav.n,nav.ng,n,nep,nrep);
+    printf("%14s %14s %16s %16s %7s\n","linear(ms/ep)","index(ms/ep)","evaluated(ms/ep)",
+           "hermite(ms/ep)","speedup");
+    printf("%14.4f %14.4f %16.4f %16.4f %7.1f\n",t0/nep,t1/nep,t2/nep,t3/nep,
+           t2>0.0?t0/t2:0.0);
+    printf("hermite maxdiff(m)=%.3E\n",hmax);
+    if (hmax>=1E-3) {
+        fprintf(stderr,"hermite interpolation error: maxdiff=%.3E\n",hmax);
+        return 1;
+    }
+
+    double te0,te1,dmax=cmpephc(&nav,nrep,&te0,&te1);
+    printf("%14s %14s %14s\n","eph2pos(ms)","ephc2poss(ms)","maxdiff(m)");
+    printf("%14.2f %14.2f %14.3E\n",te0,te1,dmax);
+    if (dmax>=1E-6) {
+        fprintf(stderr,"evaluated ephemeris error: maxdiff=%.3E\n",dmax);
+        return 1;
+    }
+
+    free(rs0); free(rs1);
+    freenav(&nav,0xFF);
+    return 0;
+}
@@ -0,0 +1,182 @@
+/*------------------------------------------------------------------------------
+* rtklib benchmark : tcp server and ntrip caster fan-out load test
+*
+* usage : b_tcpsvr [-n ncli] [-m nmsg] [-s size] [-p port] [-k nslow] [-q qlen]
+*                  [-qp policy] [-c]
+*
+* opens a tcp server stream (-c: ntrip caster stream with mountpoint BENCH) on
+* the loopback port (default 12101), connects ncli (default 1000) clients to it
+* and writes nmsg (default 200) messages of size (default 512) bytes by
+* strwrite() as str2str does. after each message, all the clients receive it
+* and check the contents. prints the fan-out latency (from strwrite() until the
+* last client received the message), the cpu time of strwrite() per client and
+* the cost of strread() polling the idle clients. the last nslow (default 0)
+* clients never receive, so their messages are queued by the client output
+* queues of length qlen (default 256) and dropped or disconnected by policy
+* (0:drop oldest,1:disconnect). prints the output queue state by strstatx().
+*-----------------------------------------------------------------------------*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "rtklib.h"
+
+/* monotonic/cpu time (us) ---------------------------------------------------*/
+static double timeus(clockid_t clk)
+{
+    struct timespec ts;
+    clock_gettime(clk,&ts);
+    return ts.tv_sec*1E6+ts.tv_nsec*1E-3;
+}
+/* compare doubles -----------------------------------------------------------*/
+static int cmpdbl(const void *p1, const void *p2)
+{
+    double d=*(const double *)p1-*(const double *)p2;
+    return d<0.0?-1:(d>0.0?1:0);
+}
+/* connect client, return socket (-1: error) ---------------------------------*/
+static int concli(stream_t *str, int port, int caster)
+{
+    struct sockaddr_in addr={0};
+    char req[256],rsp[64]="";
+    uint8_t buff[64];
+    int sock,n=0;
+
+    addr.sin_family=AF_INET;
+    addr.sin_port=htons(port);
+    addr.sin_addr.s_addr=htonl(INADDR_LOOPBACK);
+    if ((sock=socket(AF_INET,SOCK_STREAM,0))<0) return -1;
+    if (connect(sock,(struct sockaddr *)&addr,sizeof(addr))<0) {
+        close(sock);
+        return -1;
+    }
+    if (!caster) {
+        strread(str,buff,sizeof(buff)); /* accept */
+        return sock;
+    }
+    /* ntrip request and response */
+    sprintf(req,"GET /BENCH HTTP/1.0\r\nUser-Agent: NTRIP b_tcpsvr\r\n\r\n");
+    if (send(sock,req,strlen(req),0)!=(ssize_t)strlen(req)) {
+        close(sock);
+        return -1;
+    }
+    for (int i=0;i<10000&&!strstr(rsp,"\r\n");i++) {
+        strread(str,buff,sizeof(buff));
+        int m=recv(sock,rsp+n,sizeof(rsp)-1-n,MSG_DONTWAIT);
+        if (m>0) rsp[n+=m]='\0';
+        else if (m==0) break;
+        else usleep(100);
+    }
+    if (!strstr(rsp,"ICY 200 OK")) {
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+int main(int argc, char **argv)
+{
+    stream_t str;
+    struct rlimit rl;
+    char path[256],msg[MAXSTRMSG];
+    int ncli=1000,nmsg=200,size=512,port=12101,caster=0,nslow=0;
+    int opt[8]={10000,10000,1000,32768,30,0,0,0};
+
+    for (int i=1;i<argc;i++) {
+        if (!strcmp(argv[i],"-n")&&i+1<argc) ncli=atoi(argv[++i]);
+        else if (!strcmp(argv[i],"-m")&&i+1<argc) nmsg=atoi(argv[++i]);
+        else if (!strcmp(argv[i],"-s")&&i+1<argc) size=atoi(argv[++i]);
+        else if (!strcmp(argv[i],"-p")&&i+1<argc) port=atoi(argv[++i]);
+        else if (!strcmp(argv[i],"-k")&&i+1<argc) nslow=atoi(argv[++i]);
+        else if (!strcmp(argv[i],"-q")&&i+1<argc) opt[5]=atoi(argv[++i]);
+        else if (!strcmp(argv[i],"-qp")&&i+1<argc) opt[6]=atoi(argv[++i]);
+        else if (!strcmp(argv[i],"-c")) caster=1;
+    }
+    if (ncli<1) ncli=1;
+    if (nslow<0||nslow>=ncli) nslow=0;
+    if (nmsg<1) nmsg=1;
+    if (size<1) size=1;
+    signal(SIGPIPE,SIG_IGN);
+
+    /* raise limit of open files for the clients and accepted sockets */
+    if (!getrlimit(RLIMIT_NOFILE,&rl)&&rl.rlim_cur<rl.rlim_max) {
+        rl.rlim_cur=rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE,&rl);
+    }
+    strinitcom();
+    strsetopt(opt);
+    strinit(&str);
+    if (caster) sprintf(path,":%d/BENCH",port); else sprintf(path,":%d",port);
+    if (!stropen(&str,caster?STR_NTRIPCAS:STR_TCPSVR,STR_MODE_RW,path)) {
+        fprintf(stderr,"stream open error: %s\n",path);
+        return 1;
+    }
+    int *sock=(int *)malloc(sizeof(int)*ncli);
+    uint8_t *data=(uint8_t *)malloc(size),*rbuff=(uint8_t *)malloc(size);
+    double *lat=(double *)malloc(sizeof(double)*nmsg);
+    if (!sock||!data||!rbuff||!lat) return 1;
+
+    /* connect clients */
+    double t0=timeus(CLOCK_MONOTONIC);
+    for (int i=0;i<ncli;i++) {
+        if ((sock[i]=concli(&str,port,caster))<0) {
+            fprintf(stderr,"client connect error: i=%d\n",i);
+            return 1;
+        }
+    }
+    double tcon=timeus(CLOCK_MONOTONIC)-t0;
+    strread(&str,rbuff,size);
+    strstat(&str,msg);
+
+    /* poll idle clients by strread() */
+    int nread=ncli<100?10000:1000000/ncli;
+    t0=timeus(CLOCK_MONOTONIC);
+    for (int i=0;i<nread;i++) strread(&str,rbuff,size);
+    double tread=(timeus(CLOCK_MONOTONIC)-t0)/nread;
+
+    /* fan-out messages */
+    double cpu=0.0;
+    for (int k=0;k<nmsg;k++) {
+        for (int i=0;i<size;i++) data[i]=(uint8_t)(k+i);
+        t0=timeus(CLOCK_MONOTONIC);
+        double c0=timeus(CLOCK_PROCESS_CPUTIME_ID);
+        int ns=strwrite(&str,data,size);
+        cpu+=timeus(CLOCK_PROCESS_CPUTIME_ID)-c0;
+        if (ns<size) {
+            fprintf(stderr,"write error: msg=%d ns=%d\n",k,ns);
+            return 1;
+        }
+        for (int i=0;i<ncli-nslow;i++) {
+            if (recv(sock[i],rbuff,size,MSG_WAITALL)!=size||memcmp(rbuff,data,size)) {
+                fprintf(stderr,"receive error: msg=%d cli=%d\n",k,i);
+                return 1;
+            }
+        }
+        lat[k]=timeus(CLOCK_MONOTONIC)-t0;
+    }
+    qsort(lat,nmsg,sizeof(double),cmpdbl);
+
+    printf("stream=%s clients=%d (%s) msgs=%d size=%d\n",caster?"ntripcas":"tcpsvr",
+           ncli,msg,nmsg,size);
+    printf("%12s %14s %14s %14s %14s %14s\n","connect(ms)","read(us/call)",
+           "fanout50(us)","fanout99(us)","fanoutmax(us)","cpu/cli(us)");
+    printf("%12.1f %14.2f %14.1f %14.1f %14.1f %14.3f\n",tcon*1E-3,tread,
+           lat[nmsg/2],lat[(int)(nmsg*0.99)],lat[nmsg-1],cpu/nmsg/ncli);
+
+    if (nslow>0) {
+        static char statx[65536];
+        strstatx(&str,statx);
+        char *p=strstr(statx,"  ncli"),*q=strstr(statx,"  svr:");
+        if (p&&q) printf("%.*s",(int)(q-p),p);
+    }
+    for (int i=0;i<ncli;i++) close(sock[i]);
+    strclose(&str);
+    free(sock); free(data); free(rbuff); free(lat);
+    return 0;
+}
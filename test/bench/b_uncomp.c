@@ -0,0 +1,130 @@
+/*------------------------------------------------------------------------------
+* rtklib benchmark : uncompression of RINEX/SP3 files
+*
+* usage : b_uncomp [-r nrep] [file ...]
+*
+* reads the compressed files (default the .Z, .gz and compact RINEX test data)
+* nrep (default 20) times uncompressed in process by rtk_uncompbuf() and by the
+* external commands (gzip -d, crx2rnx) to a temporary file as rtk_uncompress()
+* did before. prints the latency per file of the uncompression only and of the
+* uncompression and readrnx() or readsp3(), and fails if the uncompressed data
+* differ. the external path is skipped if the command fails.
+*-----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "rtklib.h"
+
+/* uncompress file by external command ---------------------------------------*/
+static int uncompcmd(const char *file, const char *tmpfile)
+{
+    char cmd[2048];
+    const char *p=strrchr(file,'.');
+
+    if (p&&(!strcmp(p,".Z")||!strcmp(p,".gz")||!strcmp(p,".zip"))) {
+        sprintf(cmd,"gzip -f -d -c \"%s\" > %s",file,tmpfile);
+    }
+    else sprintf(cmd,"crx2rnx < \"%s\" > %s 2>/dev/null",file,tmpfile);
+    return !execcmd(cmd);
+}
+/* read file, return number of obs or ephemeris data -------------------------*/
+static int readfile(const char *file, int sp3)
+{
+    obs_t obs={0};
+    nav_t nav={0};
+    int n;
+
+    if (sp3) {
+        readsp3(file,&nav,0);
+        n=nav.ne;
+        freenav(&nav,0xFF);
+    }
+    else {
+        readrnx(file,1,"",&obs,&nav,NULL);
+        n=obs.n+nav.n+nav.ng;
+        freeobs(&obs);
+        freenav(&nav,0xFF);
+    }
+    return n;
+}
+/* compare file with data ----------------------------------------------------*/
+static int cmpdata(const char *file, const uint8_t *buff, size_t size)
+{
+    FILE *fp=fopen(file,"rb");
+    uint8_t *data=(uint8_t *)malloc(size+1);
+    size_t n=0;
+
+    if (fp&&data) n=fread(data,1,size+1,fp);
+    if (fp) fclose(fp);
+    int stat=data&&n==size&&!memcmp(data,buff,size);
+    free(data);
+    return stat;
+}
+int main(int argc, char **argv)
+{
+    const char *file[16]={
+        "../data/rinex/30400920.05o.Z","../data/rinex/30400920.05n.gz",
+        "../data/rinex/07590920.05d","../data/sp3/esa15253.sp3.Z"
+    };
+    uint8_t *buff;
+    size_t size;
+    int nfile=0,nrep=20;
+
+    for (int i=1;i<argc;i++) {
+        if (!strcmp(argv[i],"-r")&&i+1<argc) nrep=atoi(argv[++i]);
+        else if (nfile<16) file[nfile++]=argv[i];
+    }
+    if (nfile==0) nfile=4;
+    if (nrep<1) nrep=1;
+
+    printf("repeat=%d\n",nrep);
+    printf("%-32s %9s %12s %12s %12s %12s %8s\n","file","size(kB)","uncbuf(ms)",
+           "command(ms)","readbuf(ms)","readcmd(ms)","speedup");
+
+    for (int i=0;i<nfile;i++) {
+        int sp3=strstr(file[i],".sp3")||strstr(file[i],".SP3");
+        const char *tmpfile=sp3?"b_uncomp_tmp.sp3":"b_uncomp_tmp.obs";
+
+        /* in process */
+        uint32_t tick=tickget();
+        for (int r=0;r<nrep;r++) {
+            if (rtk_uncompbuf(file[i],&buff,&size)<=0) {
+                fprintf(stderr,"uncompress error: %s\n",file[i]);
+                return 1;
+            }
+            if (r<nrep-1) free(buff);
+        }
+        double t0=(double)(tickget()-tick)/nrep;
+        tick=tickget();
+        int n0=0;
+        for (int r=0;r<nrep;r++) n0=readfile(file[i],sp3);
+        double t1=(double)(tickget()-tick)/nrep;
+
+        /* external command and temporary file */
+        double t2=-1.0,t3=-1.0;
+        if (uncompcmd(file[i],tmpfile)) {
+            if (!cmpdata(tmpfile,buff,size)) {
+                fprintf(stderr,"uncompressed data differ: %s\n",file[i]);
+                return 1;
+            }
+            tick=tickget();
+            for (int r=0;r<nrep;r++) uncompcmd(file[i],tmpfile);
+            t2=(double)(tickget()-tick)/nrep;
+            tick=tickget();
+            int n1=0;
+            for (int r=0;r<nrep;r++) {
+                uncompcmd(file[i],tmpfile);
+                n1=readfile(tmpfile,sp3);
+            }
+            t3=(double)(tickget()-tick)/nrep;
+            if (n0<=0||n0!=n1) {
+                fprintf(stderr,"read data differ: %s n=%d %d\n",file[i],n0,n1);
+                return 1;
+            }
+        }
+        remove(tmpfile);
+        printf("%-32s %9.1f %12.2f %12.2f %12.2f %12.2f %8.2f\n",file[i],
+               size/1E3,t0,t2,t1,t3,t3>0.0&&t1>0.0?t3/t1:0.0);
+        free(buff);
+    }
+    return 0;
+}
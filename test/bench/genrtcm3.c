@@ -0,0 +1,90 @@
+/*------------------------------------------------------------------------------
+* rtklib benchmark : RTCM 3 messages generated from receiver raw log
+*
+* shared by the RTCM 3 benchmarks (b_rtcm3buf, b_msm7, b_decode) to generate
+* the same MSM and ephemeris test frames from the u-blox raw log.
+*-----------------------------------------------------------------------------*/
+#include "genrtcm3.h"
+
+/* satellite system of MSM message type --------------------------------------*/
+static int msmsys(int type)
+{
+    switch (type/10) {
+        case 107: return SYS_GPS;
+        case 108: return SYS_GLO;
+        case 109: return SYS_GAL;
+        case 110: return SYS_SBS;
+        case 111: return SYS_QZS;
+        case 112: return SYS_BDS;
+        case 113: return SYS_IRN;
+    }
+    return SYS_NONE;
+}
+/* generate RTCM 3 messages from u-blox raw log --------------------------------
+* generate RTCM 3 MSM messages of the obs data and GPS ephemeris messages
+* args   : char   *file     I   u-blox raw log file
+*          int    *types    I   MSM message types (1074,...,1137)
+*          int    ntype     I   number of MSM message types
+*          int    opt       I   options (or of GENRTCM3_???)
+*                                 GENRTCM3_EPH : output GPS ephemeris (1019)
+*                                 GENRTCM3_TURN: output one of types by turns
+*                                                for each obs epoch (otherwise
+*                                                all types for each epoch)
+*          genrtcm3out_t out I  output of generated frame
+*          void   *arg      IO  argument of out
+* return : number of generated frames (0: no data or file read error)
+* notes  : the obs data of an MSM message are filtered by the satellite system
+*          of the message type
+*-----------------------------------------------------------------------------*/
+int genrtcm3(const char *file, const int *types, int ntype, int opt,
+             genrtcm3out_t out, void *arg)
+{
+    FILE *fp;
+    raw_t raw;
+    rtcm_t rtcm;
+    int ret,nframe=0,nepoch=0;
+
+    if (!(fp=fopen(file,"rb"))) return 0;
+    if (!init_raw(&raw,STRFMT_UBX)||!init_rtcm(&rtcm)) {
+        fclose(fp);
+        return 0;
+    }
+    while ((ret=input_rawf(&raw,STRFMT_UBX,fp))>=-1) {
+        if (ret==1&&raw.obs.n>0) {
+            for (int i=0;i<ntype;i++) {
+                int type=(opt&GENRTCM3_TURN)?types[nepoch%ntype]:types[i],n=0;
+                for (int j=0;j<raw.obs.n&&n<MAXOBS;j++) {
+                    const obsd_t *d=raw.obs.data+j;
+                    if (satsyst(d->sat,d->time,NULL)&msmsys(type)) {
+                        rtcm.obs.data[n++]=*d;
+                    }
+                }
+                if (n==0) {
+                    if (opt&GENRTCM3_TURN) break;
+                    continue;
+                }
+                rtcm.obs.n=n;
+                rtcm.time=raw.obs.data[0].time;
+                if (gen_rtcm3(&rtcm,type,0,0)) {
+                    out(rtcm.buff,rtcm.nbyte,type,arg);
+                    nframe++;
+                    if (opt&GENRTCM3_TURN) nepoch++;
+                }
+                if (opt&GENRTCM3_TURN) break;
+            }
+        }
+        else if (ret==2&&(opt&GENRTCM3_EPH)&&satsys(raw.ephsat,NULL)==SYS_GPS) {
+            rtcm.nav.eph[raw.ephsat-1]=raw.nav.eph[raw.ephsat-1];
+            rtcm.ephsat=raw.ephsat;
+            rtcm.ephset=0;
+            if (gen_rtcm3(&rtcm,1019,0,0)) {
+                out(rtcm.buff,rtcm.nbyte,1019,arg);
+                nframe++;
+            }
+        }
+    }
+    fclose(fp);
+    free_raw(&raw);
+    free_rtcm(&rtcm);
+    return nframe;
+}
@@ -0,0 +1,18 @@
+/*------------------------------------------------------------------------------
+* rtklib benchmark : RTCM 3 messages generated from receiver raw log
+*-----------------------------------------------------------------------------*/
+#ifndef GENRTCM3_H
+#define GENRTCM3_H
+#include "rtklib.h"
+
+#define GENRTCM3_EPH    1               /* output GPS ephemeris (1019) */
+#define GENRTCM3_TURN   2               /* output one MSM type by turns */
+
+/* output of generated frame (type: message type) */
+typedef void (*genrtcm3out_t)(const uint8_t *buff, int nbyte, int type,
+                              void *arg);
+
+int genrtcm3(const char *file, const int *types, int ntype, int opt,
+             genrtcm3out_t out, void *arg);
+
+#endif /* GENRTCM3_H */
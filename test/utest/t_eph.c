@@ -0,0 +1,87 @@
+/*------------------------------------------------------------------------------
+* rtklib unit test driver : ephemeris index
+*-----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "../../src/rtklib.h"
+
+/* satellite positions by nav data with index and by linear search */
+static int cmpsatpos(const nav_t *nav, gtime_t ts, gtime_t te, double tint)
+{
+    prcopt_t opt=prcopt_default;
+    nav_t nav0=*nav;
+    gtime_t time;
+    double rs1[6],rs2[6],dts1[2],dts2[2],var1,var2;
+    int sat,svh1,svh2,stat1,stat2,nsel=0;
+
+    /* index not valid */
+    memset(&nav0.ieph ,0,sizeof(ephidx_t));
+    memset(&nav0.igeph,0,sizeof(ephidx_t));
+    memset(&nav0.iseph,0,sizeof(ephidx_t));
+    opt.sateph=EPHOPT_BRDC;
+
+    for (time=ts;tint>0.0?timediff(time,te)<=0.0:timediff(time,te)>=0.0;
+         time=timeadd(time,tint)) {
+        for (sat=1;sat<=MAXSAT;sat++) {
+            stat1=satpos(time,time,sat,&opt,nav  ,rs1,dts1,&var1,&svh1);
+            stat2=satpos(time,time,sat,&opt,&nav0,rs2,dts2,&var2,&svh2);
+            assert(stat1==stat2&&svh1==svh2);
+            if (!stat1) continue;
+            assert(!memcmp(rs1,rs2,sizeof(rs1))&&!memcmp(dts1,dts2,sizeof(dts1)));
+            assert(var1==var2);
+            nsel++;
+        }
+    }
+    return nsel;
+}
+/* indexnav() and seleph()/selgeph() same as linear search */
+void utest1(void)
+{
+    const char *file[]={
+        "../data/rinex/brdc1820.10n","../data/rinex/brdc0910.09g",
+        "../data/rinex/30400920.05n"
+    };
+    nav_t nav={0};
+    gtime_t ts,te;
+    int i,j,n1,n2;
+
+    for (i=0;i<3;i++) {
+        readrnx(file[i],1,"",NULL,&nav,NULL);
+        indexnav(&nav,0x07);
+        assert(nav.n+nav.ng>0);
+
+        /* time span of ephemerides with margin */
+        ts=te=nav.n>0?nav.eph[0].toe:nav.geph[0].toe;
+        for (j=0;j<nav.n;j++) {
+            if (timediff(nav.eph[j].toe,ts)<0.0) ts=nav.eph[j].toe;
+            if (timediff(nav.eph[j].toe,te)>0.0) te=nav.eph[j].toe;
+        }
+        for (j=0;j<nav.ng;j++) {
+            if (timediff(nav.geph[j].toe,ts)<0.0) ts=nav.geph[j].toe;
+            if (timediff(nav.geph[j].toe,te)>0.0) te=nav.geph[j].toe;
+        }
+        ts=timeadd(ts,-7200.0);
+        te=timeadd(te, 7200.0);
+
+        /* forward and backward in time */
+        n1=cmpsatpos(&nav,ts,te,397.0);
+        n2=cmpsatpos(&nav,te,ts,-397.0);
+        printf("file=%s n=%d ng=%d sel=%d %d\n",file[i],nav.n,nav.ng,n1,n2);
+        assert(n1>0&&n2>0);
+
+        /* not valid index after ephemerides added */
+        nav.ieph.n--;
+        nav.igeph.n--;
+        n2=cmpsatpos(&nav,ts,te,397.0);
+        assert(n1==n2);
+        freenav(&nav,0xFF);
+        memset(&nav,0,sizeof(nav));
+    }
+    printf("%s utest1 : OK\n",__FILE__);
+}
+int main(int argc, char **argv)
+{
+    utest1();
+    return 0;
+}
@@ -2,6 +2,7 @@
 * rtklib unit test driver : misc functions
 *-----------------------------------------------------------------------------*/
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
 #include "../../src/rtklib.h"
 
@@ -182,11 +183,134 @@ void utest4(void)
     
     printf("%s utset4 : OK\n",__FILE__);
 }
+/* initbitrd(),rdbitu(),rdbits(),bitrdpos() */
+void utest5(void)
+{
+    static const unsigned lens[]={1,3,8,12,32,0,7,22,31,2,16,30,5,24,9,32,17};
+    uint8_t buff[173];
+    uint32_t seed=12345,vu;
+    int32_t vs;
+    bitrd_t b;
+    unsigned pos,pos0,len;
+    int i,j;
+
+    for (i=0;i<(int)sizeof(buff);i++) {
+        seed=seed*1103515245+12345;
+        buff[i]=(uint8_t)(seed>>16);
+    }
+    /* read sequences of mixed lengths from all bit offsets in a byte */
+    for (pos0=0;pos0<16;pos0++) {
+        initbitrd(&b,buff,sizeof(buff),pos0);
+            assert(bitrdpos(&b)==(int)pos0);
+        pos=pos0;
+        for (i=0;;i++) {
+            len=lens[i%(int)(sizeof(lens)/sizeof(lens[0]))];
+            if (pos+len>sizeof(buff)*8) break;
+            if (i%2) {
+                vu=rdbitu(&b,len);
+                    assert(vu==getbitu(buff,pos,len));
+            }
+            else if (len>0) {
+                vs=rdbits(&b,len);
+                    assert(vs==getbits(buff,pos,len));
+            }
+            pos+=len;
+                assert(bitrdpos(&b)==(int)pos);
+        }
+    }
+    /* bits beyond the data length are read as 0 */
+    initbitrd(&b,buff,4,20);
+    vu=rdbitu(&b,12);
+        assert(vu==getbitu(buff,20,12));
+    for (j=0;j<4;j++) {
+        vu=rdbitu(&b,32);
+            assert(vu==0);
+    }
+    assert(bitrdpos(&b)==32+128);
+
+    printf("%s utset5 : OK\n",__FILE__);
+}
+/* ringinit(),ringpush(),ringpop(),ringwrite(),ringread(),ringcount() */
+void utest6(void)
+{
+    ring_t ring;
+    uint8_t data[64],buff[64];
+    uint32_t v,u;
+    int i,j,n,stat;
+
+    /* size rounded up to power of 2 */
+    stat=ringinit(&ring,5,sizeof(uint32_t));
+        assert(stat==1&&ring.size==8);
+
+    /* empty and full */
+    stat=ringpop(&ring,&u);
+        assert(stat==0&&ringcount(&ring)==0);
+    for (v=0;v<8;v++) {
+        stat=ringpush(&ring,&v);
+            assert(stat==1);
+    }
+    stat=ringpush(&ring,&v);
+        assert(stat==0&&ringcount(&ring)==8);
+    for (v=0;v<8;v++) {
+        stat=ringpop(&ring,&u);
+            assert(stat==1&&u==v);
+    }
+    stat=ringpop(&ring,&u);
+        assert(stat==0&&ringcount(&ring)==0);
+
+    /* wraparound of buffer index and of 32-bit read/write pointers */
+    ring.wp=ring.rp=0xFFFFFFFA;
+    for (i=0,v=0;i<100;i++) {
+        for (j=0;j<=i%8;j++,v++) {
+            stat=ringpush(&ring,&v);
+                assert(stat==1);
+        }
+        assert(ringcount(&ring)==i%8+1);
+        for (j=0;j<=i%8;j++) {
+            stat=ringpop(&ring,&u);
+                assert(stat==1&&u==v-(uint32_t)(i%8+1-j));
+        }
+    }
+    assert(ring.wp<0x1000&&ring.wp==ring.rp);
+    ringfree(&ring);
+
+    /* bulk write/read across the end of buffer */
+    stat=ringinit(&ring,16,1);
+        assert(stat==1&&ring.size==16);
+    for (i=0;i<64;i++) data[i]=(uint8_t)i;
+    for (i=0;i<50;i++) {
+        n=ringwrite(&ring,data,i%13+1);
+            assert(n==i%13+1);
+        n=ringread(&ring,buff,64);
+            assert(n==i%13+1&&!memcmp(buff,data,n));
+    }
+    /* write up to free space and read partially */
+    n=ringwrite(&ring,data,10);
+        assert(n==10);
+    n=ringwrite(&ring,data+10,10);
+        assert(n==6);
+    n=ringwrite(&ring,data,1);
+        assert(n==0);
+    n=ringread(&ring,buff,4);
+        assert(n==4&&!memcmp(buff,data,4));
+    n=ringread(&ring,NULL,4);
+        assert(n==4&&ringcount(&ring)==8);
+    n=ringread(&ring,buff,64);
+        assert(n==8&&!memcmp(buff,data+8,8));
+    n=ringread(&ring,buff,64);
+        assert(n==0);
+    ringfree(&ring);
+    assert(ring.buff==NULL&&ring.size==0);
+
+    printf("%s utset6 : OK\n",__FILE__);
+}
 int main(void)
 {
     utest1();
     utest2();
     utest3();
     utest4();
+    utest5();
+    utest6();
     return 0;
 }
@@ -2,6 +2,7 @@
 * rtklib unit test driver : rinex function
 *-----------------------------------------------------------------------------*/
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
 #include "../../src/rtklib.h"
 
@@ -67,7 +68,7 @@ void utest1(void)
     char file6[]="../data/rinex/30400920.05n";
     obs_t obs={0};
     nav_t nav={0};
-    sta_t sta={""};
+    sta_t sta={0};
     int n,stat;
 
     stat=readrnx(file1,1,"",&obs,&nav,&sta);
@@ -105,7 +106,7 @@ void utest2(void)
     int n;
     obs_t obs={0};
     nav_t nav={0};
-    sta_t sta={""};
+    sta_t sta={0};
 
     ts=epoch2time(ep1);
     te=epoch2time(ep2);
@@ -121,8 +122,8 @@ void utest2(void)
 
     printf("%s utset2 : OK\n",__FILE__);
 }
-static rnxopt_t opt1={{0}};
-static rnxopt_t opt2={{0}};
+static rnxopt_t opt1={0};
+static rnxopt_t opt2={0};
 /*
 static rnxopt_t opt2= {
     {0},{0},0.0,0.0,2.10,SYS_ALL,OBSTYPE_ALL,FREQTYPE_ALL,{{0}},
@@ -208,6 +209,466 @@ void utest6(void)
     }
     printf("%s utest6 : OK\n",__FILE__);
 }
+/* str2fix() conformance to str2num() */
+void utest7(void)
+{
+    const char *file[]={
+        "../data/rinex/07590920.05o","../data/rinex/07590920.05n",
+        "../data/rinex/30400920.05o","../data/rinex/30400920.05n",
+        "../data/rinex/brdc0910.09g","../data/rinex/brdc1820.10n",
+        "../data/rinex/brdc1830.10n"
+    };
+    const char *str[]={
+        "","   ","-","+.","  -0.000","   .5","5.","5.e3","  0.123456789012D+01",
+        "-.123456789012d-05","1.5E","1.5E+","1E-22","1E23","-12345678901234567",
+        "0x1A","inf","nan","0.000000000000000000001","12345678901234.5678",
+        "\t 1.25\n","- 5"," 1.5 E3"
+    };
+    const int width[]={1,3,14,16,19};
+    char buff[1024];
+    double v1,v2;
+    int i,j,k,n=0;
+
+    for (i=0;i<(int)(sizeof(str)/sizeof(*str));i++) for (k=0;k<5;k++) {
+        v1=str2num(str[i],0,width[k]);
+        v2=str2fix(str[i],0,width[k]);
+        assert(!memcmp(&v1,&v2,sizeof(double)));
+    }
+    for (i=0;i<(int)(sizeof(file)/sizeof(*file));i++) {
+        FILE *fp=fopen(file[i],"r");
+        assert(fp);
+        while (fgets(buff,sizeof(buff),fp)) {
+            for (j=0;j<=(int)strlen(buff);j++) for (k=0;k<5;k++,n++) {
+                v1=str2num(buff,j,width[k]);
+                v2=str2fix(buff,j,width[k]);
+                assert(!memcmp(&v1,&v2,sizeof(double)));
+            }
+        }
+        fclose(fp);
+    }
+    printf("fields=%d\n",n);
+    printf("%s utest7 : OK\n",__FILE__);
+}
+/* write RINEX 3 obs of GPS with special records in the body */
+static void writernx3(const char *file, const obs_t *obs, int chtype)
+{
+    const char *label[]={"RINEX VERSION / TYPE","SYS / # / OBS TYPES","END OF HEADER"};
+    FILE *fp=fopen(file,"w");
+    double ep[6];
+    int i,j,k,m,nep=0,ntype=4;
+
+    assert(fp);
+    fprintf(fp,"%9.2f%-11s%-20s%-20s%-20s\n",3.04,"","OBSERVATION DATA","G",label[0]);
+    fprintf(fp,"G  %3d C1C L1C C2W L2W%-38s%-20s\n",4,"",label[1]);
+    fprintf(fp,"%-60s%-20s\n","",label[2]);
+
+    for (i=0;i<obs->n;i=j,nep++) {
+        for (j=i;j<obs->n&&timediff(obs->data[j].time,obs->data[i].time)==0.0;j++) ;
+        time2epoch(obs->data[i].time,ep);
+        if (nep==40) { /* event */
+            fprintf(fp,"> %04.0f %02.0f %02.0f %02.0f %02.0f%11.7f  5  0\n",
+                    ep[0],ep[1],ep[2],ep[3],ep[4],ep[5]-0.5);
+        }
+        if (nep==80) { /* header records */
+            fprintf(fp,">%30s4%3d\n","",chtype?2:1);
+            fprintf(fp,"%-60s%-20s\n","comment in body","COMMENT");
+            if (chtype) {
+                fprintf(fp,"G  %3d C1C L1C L2W%-42s%-20s\n",3,"","SYS / # / OBS TYPES");
+                ntype=3;
+            }
+        }
+        fprintf(fp,"> %04.0f %02.0f %02.0f %02.0f %02.0f%11.7f  0%3d\n",ep[0],ep[1],
+                ep[2],ep[3],ep[4],ep[5],j-i+(nep==120?2:0)); /* truncated */
+        for (k=i;k<j;k++) {
+            const obsd_t *d=obs->data+k;
+            double val[]={d->P[0],d->L[0],d->P[1],d->L[1]};
+            fprintf(fp,"G%02d",d->sat);
+            for (m=0;m<4;m++) {
+                if (ntype==3&&m==2) continue;
+                if (val[m]==0.0) fprintf(fp,"%16s","");
+                else fprintf(fp,"%14.3f%c ",val[m],m%2&&d->LLI[m/2]?'0'+d->LLI[m/2]:' ');
+            }
+            fprintf(fp,"\n");
+        }
+    }
+    fclose(fp);
+}
+/* compare obs data */
+static int cmpobs(const obs_t *obs1, const obs_t *obs2)
+{
+    int i;
+
+    if (obs1->n!=obs2->n) return 0;
+    for (i=0;i<obs1->n;i++) {
+        const obsd_t *d1=obs1->data+i,*d2=obs2->data+i;
+        if (timediff(d1->time,d2->time)!=0.0||d1->sat!=d2->sat||d1->rcv!=d2->rcv||
+            timediff(d1->eventime,d2->eventime)!=0.0||
+            memcmp(d1->LLI,d2->LLI,sizeof(d1->LLI))||
+            memcmp(d1->code,d2->code,sizeof(d1->code))||
+            memcmp(d1->L,d2->L,sizeof(d1->L))||memcmp(d1->P,d2->P,sizeof(d1->P))||
+            memcmp(d1->D,d2->D,sizeof(d1->D))||memcmp(d1->SNR,d2->SNR,sizeof(d1->SNR))) {
+            return 0;
+        }
+    }
+    return 1;
+}
+/* setrnxthread(), readrnx() by chunks in threads */
+void utest8(void)
+{
+    const char *file[]={"t_rinex_utest8a.obs","t_rinex_utest8b.obs"};
+    obs_t obs={0},obs1={0},obs2={0};
+    int i,stat1,stat2;
+
+    readrnx("../data/rinex/07590920.05o",1,"",&obs,NULL,NULL);
+    sortobs(&obs);
+
+    for (i=0;i<2;i++) {
+        writernx3(file[i],&obs,i);
+
+        setrnxthread(1,0);
+        stat1=readrnx(file[i],1,"",&obs1,NULL,NULL);
+        setrnxthread(4,2000);
+        stat2=readrnx(file[i],1,"",&obs2,NULL,NULL);
+        printf("file=%s obs=%d %d\n",file[i],obs1.n,obs2.n);
+        assert(stat1==1&&stat2==1);
+        assert(obs1.n>obs.n/2&&cmpobs(&obs1,&obs2));
+        freeobs(&obs1);
+        freeobs(&obs2);
+        remove(file[i]);
+    }
+    setrnxthread(0,0);
+    freeobs(&obs);
+    printf("%s utest8 : OK\n",__FILE__);
+}
+/* copy file */
+static int copyfile(const char *src, const char *dst)
+{
+    FILE *fp1=fopen(src,"rb"),*fp2=fopen(dst,"wb");
+    char buff[4096];
+    size_t n;
+
+    if (fp1&&fp2) {
+        while ((n=fread(buff,1,sizeof(buff),fp1))>0) fwrite(buff,1,n,fp2);
+    }
+    if (fp1) fclose(fp1);
+    if (fp2) fclose(fp2);
+    return fp1&&fp2;
+}
+/* write unix compress file of maxbits=9 with 256 codes 'a' and two codes 512
+   in 10 bits after the table is full */
+static int writelzw9(const char *file)
+{
+    FILE *fp=fopen(file,"wb");
+    uint8_t buff[3+291]={0x1F,0x9D,0x89};
+    int i,j,code,nbits,pos=0;
+
+    if (!fp) return 0;
+    for (i=0;i<258;i++) {
+        code=i<256?'a':512;
+        nbits=i<256?9:10;
+        for (j=0;j<nbits;j++,pos++) {
+            if ((code>>j)&1) buff[3+pos/8]|=(uint8_t)(1<<(pos%8));
+        }
+    }
+    fwrite(buff,1,sizeof(buff),fp);
+    fclose(fp);
+    return 1;
+}
+/* readrnx(), readsp3(), rtk_uncompbuf() and rtk_uncompress() of compressed files */
+void utest9(void)
+{
+    const char *file[][2]={
+        {"../data/rinex/07590920.05d"  ,"../data/rinex/07590920.05o"},
+        {"../data/rinex/30400920.05o.Z","../data/rinex/30400920.05o"}
+    };
+    obs_t obs1={0},obs2={0};
+    nav_t nav1={0},nav2={0};
+    uint8_t *buff;
+    size_t size;
+    FILE *fp;
+    char uncfile[1024],*data;
+    int i,j,stat1,stat2;
+
+    for (i=0;i<2;i++) {
+        stat1=readrnx(file[i][0],1,"",&obs1,NULL,NULL);
+        stat2=readrnx(file[i][1],1,"",&obs2,NULL,NULL);
+        printf("file=%s obs=%d %d\n",file[i][0],obs1.n,obs2.n);
+        assert(stat1==1&&stat2==1);
+        assert(obs1.n>0&&cmpobs(&obs1,&obs2));
+        freeobs(&obs1);
+        freeobs(&obs2);
+    }
+    stat1=readrnx("../data/rinex/30400920.05n.gz",1,"",NULL,&nav1,NULL);
+    stat2=readrnx("../data/rinex/30400920.05n",1,"",NULL,&nav2,NULL);
+    assert(stat1==1&&stat2==1);
+    assert(nav1.n>0&&nav1.n==nav2.n);
+    for (i=0;i<nav1.n;i++) {
+        const eph_t *e1=nav1.eph+i,*e2=nav2.eph+i;
+        assert(e1->sat==e2->sat&&timediff(e1->toe,e2->toe)==0.0);
+        assert(e1->A==e2->A&&e1->e==e2->e&&e1->f0==e2->f0);
+    }
+    freenav(&nav1,0xFF);
+    freenav(&nav2,0xFF);
+
+    readsp3("../data/sp3/esa15253.sp3.Z",&nav1,0);
+    readsp3("../data/sp3/esa15253.sp3",&nav2,0);
+    printf("file=%s ne=%d %d\n","../data/sp3/esa15253.sp3.Z",nav1.ne,nav2.ne);
+    assert(nav1.ne>0&&nav1.ne==nav2.ne);
+    for (i=0;i<nav1.ne;i++) {
+        assert(timediff(nav1.peph[i].time,nav2.peph[i].time)==0.0);
+        for (j=0;j<MAXSAT;j++) {
+            assert(!memcmp(nav1.peph[i].pos[j],nav2.peph[i].pos[j],sizeof(double)*4));
+        }
+    }
+    freenav(&nav1,0xFF);
+    freenav(&nav2,0xFF);
+
+    /* uncompressed data same as original file */
+    stat1=rtk_uncompbuf(file[1][0],&buff,&size);
+    data=(char *)malloc(size+1);
+    fp=fopen(file[1][1],"rb");
+    assert(stat1==1&&data&&fp);
+    stat2=fread(data,1,size+1,fp)==size&&!memcmp(data,buff,size);
+    assert(stat2);
+    fclose(fp);
+    free(data);
+    free(buff);
+
+    /* not compressed */
+    stat1=rtk_uncompbuf(file[0][1],&buff,&size);
+    assert(stat1==0&&!buff);
+
+    /* codes not wider than maxbits=9 */
+    stat1=writelzw9("t_rinex_utest9.obs.Z");
+    assert(stat1);
+    stat1=rtk_uncompbuf("t_rinex_utest9.obs.Z",&buff,&size);
+    assert(stat1==1&&size==258&&buff[256]==0&&buff[257]==1);
+    for (i=0;i<256;i++) assert(buff[i]=='a');
+    free(buff);
+    remove("t_rinex_utest9.obs.Z");
+
+    /* uncompressed file */
+    copyfile(file[1][0],"t_rinex_utest9.obs.Z");
+    stat1=rtk_uncompress("t_rinex_utest9.obs.Z",uncfile);
+    printf("uncfile=%s\n",uncfile);
+    assert(stat1==1&&!strcmp(uncfile,"t_rinex_utest9.obs"));
+    stat1=readrnx(uncfile,1,"",&obs1,NULL,NULL);
+    stat2=readrnx(file[1][1],1,"",&obs2,NULL,NULL);
+    assert(stat1==1&&stat2==1&&cmpobs(&obs1,&obs2));
+    freeobs(&obs1);
+    freeobs(&obs2);
+    remove(uncfile);
+    remove("t_rinex_utest9.obs.Z");
+
+    printf("%s utest9 : OK\n",__FILE__);
+}
+/* compare files except line ------------------------------------------------*/
+static int cmpfile(const char *file1, const char *file2, int skip)
+{
+    FILE *fp1=fopen(file1,"r"),*fp2=fopen(file2,"r");
+    char buff1[1024],buff2[1024];
+    int i,n1=1,n2=1,stat=fp1&&fp2;
+
+    for (i=0;stat&&n1&&n2;i++) {
+        n1=fgets(buff1,sizeof(buff1),fp1)!=NULL;
+        n2=fgets(buff2,sizeof(buff2),fp2)!=NULL;
+        if (n1!=n2||(n1&&i!=skip&&strcmp(buff1,buff2))) stat=0;
+    }
+    if (fp1) fclose(fp1);
+    if (fp2) fclose(fp2);
+    return stat;
+}
+/* init_crxenc(), outcrxh(), outcrxb() and rtk_gzip() */
+void utest10(void)
+{
+    const char *file1="../data/rinex/07590920.05o",*file2="../data/rinex/07590920.05d";
+    crxenc_t crx;
+    FILE *fp1,*fp2;
+    uint8_t *buff1,*buff2;
+    size_t size1,size2;
+    char buff[1024];
+    int n=0,stat1,stat2,hdr=1;
+
+    /* RINEX 4.02 not supported */
+    stat1=init_crxenc(&crx,stdout,402);
+    assert(!stat1&&!crx.tmp);
+    free_crxenc(&crx);
+
+    /* RINEX 2 text encoded by lines, compact RINEX same as file except date */
+    fp1=fopen(file1,"r");
+    fp2=fopen("t_rinex_utest10.05d","w");
+    assert(fp1&&fp2);
+    stat1=init_crxenc(&crx,fp2,211);
+    assert(stat1&&crx.ver==1);
+    while (fgets(buff,sizeof(buff),fp1)) {
+        fputs(buff,crx.tmp);
+        if (hdr) {
+            if (!strstr(buff,"END OF HEADER")) continue;
+            stat1=outcrxh(&crx);
+            hdr=0;
+        }
+        else if (++n%7==0) stat1=outcrxb(&crx);
+        assert(stat1);
+    }
+    stat1=outcrxb(&crx);
+    assert(stat1);
+    free_crxenc(&crx);
+    fclose(fp1);
+    fclose(fp2);
+    stat1=cmpfile("t_rinex_utest10.05d",file2,1);
+    assert(stat1);
+
+    /* decoded compact RINEX */
+    stat1=rtk_uncompbuf("t_rinex_utest10.05d",&buff1,&size1);
+    stat2=rtk_uncompbuf(file2,&buff2,&size2);
+    assert(stat1==1&&stat2==1&&size1==size2&&!memcmp(buff1,buff2,size1));
+    free(buff2);
+
+    /* gzip compressed */
+    stat1=rtk_gzip("t_rinex_utest10.05d","t_rinex_utest10.05d.gz");
+    stat2=rtk_uncompbuf("t_rinex_utest10.05d.gz",&buff2,&size2);
+    printf("file=%s size=%lu %lu\n",file1,(unsigned long)size1,(unsigned long)size2);
+    assert(stat1&&stat2==1&&size1==size2&&!memcmp(buff1,buff2,size1));
+    free(buff1);
+    free(buff2);
+    remove("t_rinex_utest10.05d");
+    remove("t_rinex_utest10.05d.gz");
+
+    printf("%s utest10: OK\n",__FILE__);
+}
+/* fix2str() conformance to sprintf() */
+void utest11(void)
+{
+    const double val[]={
+        0.0,-0.0,0.5,1.5,2.5,-2.5,0.125,1.0625,0.0078125,0.0078124,-1E-3,
+        9.9999999999995,123.4565,999999999.9995,-999999999.999,
+        9007199254740991.0,9007199254740992.0,1E300,1E-300
+    };
+    char buff[1024],s1[512],s2[512];
+    int i,j,k,n=0;
+
+    for (i=0;i<(int)(sizeof(val)/sizeof(*val));i++) for (k=0;k<=18;k++) {
+        fix2str(s1,sizeof(s1),val[i],k);
+        sprintf(s2,"%.*f",k,val[i]);
+        assert(!strcmp(s1,s2));
+    }
+    FILE *fp=fopen("../data/rinex/07590920.05o","r");
+    assert(fp);
+    while (fgets(buff,sizeof(buff),fp)) {
+        for (j=0;j+14<=(int)strlen(buff);j+=16) {
+            double v=str2num(buff,j,14)/7.0;
+            for (k=0;k<=13;k++,n++) {
+                fix2str(s1,sizeof(s1),v,k);
+                sprintf(s2,"%.*f",k,v);
+                assert(!strcmp(s1,s2));
+            }
+        }
+    }
+    fclose(fp);
+    printf("fields=%d\n",n);
+    printf("%s utest11 : OK\n",__FILE__);
+}
+/* outrnxobsb() to compact RINEX, outcrxb() of text larger than 1 MB */
+void utest12(void)
+{
+    const char *tobs[][4]={{"C1","L1","P2","L2"},{"C1C","L1C","C2P","L2P"}};
+    const int ver[]={211,304};
+    const char *file1="../data/rinex/07590920.05o";
+    char *text,*p,buff[1024];
+    obs_t obs={0},obs1={0},obs2={0};
+    nav_t nav={0};
+    crxenc_t crx;
+    FILE *fp1,*fp2;
+    uint8_t *buff1;
+    size_t size1,n=0,nmax=65536;
+    int i,j,k,stat1,stat2,hdr=1;
+
+    readrnx(file1,1,"",&obs,NULL,NULL);
+    sortobs(&obs);
+
+    /* compact RINEX read back same as RINEX */
+    for (i=0;i<2;i++) {
+        static rnxopt_t opt;
+        memset(&opt,0,sizeof(opt));
+        opt.rnxver=ver[i];
+        opt.navsys=SYS_GPS;
+        opt.nobs[RNX_SYS_GPS]=4;
+        for (j=0;j<4;j++) strcpy(opt.tobs[RNX_SYS_GPS][j],tobs[i][j]);
+        memset(opt.mask[RNX_SYS_GPS],'1',MAXCODE);
+        opt.tstart=obs.data[0].time;
+        opt.tend=obs.data[obs.n-1].time;
+        fp1=fopen("t_rinex_utest12.obs","w");
+        fp2=fopen("t_rinex_utest12.crx","w");
+        assert(fp1&&fp2);
+        stat1=init_crxenc(&crx,fp2,ver[i]);
+        assert(stat1);
+        stat1=outrnxobsh(fp1,&opt,&nav)&&outrnxobsh(crx.tmp,&opt,&nav)&&
+              outcrxh(&crx);
+        assert(stat1);
+        for (j=0;j<obs.n;j=k) {
+            for (k=j;k<obs.n&&timediff(obs.data[k].time,obs.data[j].time)==0.0;k++) ;
+            stat1=outrnxobsb(fp1,&opt,obs.data+j,k-j,0)&&
+                  outrnxobsb(crx.tmp,&opt,obs.data+j,k-j,0)&&outcrxb(&crx);
+            assert(stat1);
+        }
+        free_crxenc(&crx);
+        fclose(fp1);
+        fclose(fp2);
+        stat1=readrnx("t_rinex_utest12.obs",1,"",&obs1,NULL,NULL);
+        stat2=readrnx("t_rinex_utest12.crx",1,"",&obs2,NULL,NULL);
+        printf("ver=%d obs=%d %d %d\n",ver[i],obs.n,obs1.n,obs2.n);
+        assert(stat1==1&&stat2==1);
+        assert(obs1.n==obs.n&&cmpobs(&obs1,&obs2));
+        freeobs(&obs1);
+        freeobs(&obs2);
+        remove("t_rinex_utest12.obs");
+        remove("t_rinex_utest12.crx");
+    }
+    freeobs(&obs);
+
+    /* RINEX text of 20 x body encoded at once, decoded same as text */
+    text=(char *)malloc(nmax);
+    fp1=fopen(file1,"r");
+    fp2=fopen("t_rinex_utest12.05d","w");
+    assert(text&&fp1&&fp2);
+    stat1=init_crxenc(&crx,fp2,211);
+    assert(stat1);
+    while (fgets(buff,sizeof(buff),fp1)) {
+        if (hdr) {
+            fputs(buff,crx.tmp);
+            if (!strstr(buff,"END OF HEADER")) continue;
+            stat1=outcrxh(&crx);
+            assert(stat1);
+            hdr=0;
+            continue;
+        }
+        if (n+strlen(buff)+1>nmax) {
+            p=(char *)realloc(text,nmax*=2);
+            assert(p);
+            text=p;
+        }
+        strcpy(text+n,buff);
+        n+=strlen(buff);
+    }
+    for (i=0;i<20;i++) fwrite(text,1,n,crx.tmp);
+    assert(ftell(crx.tmp)>1048576);
+    stat1=outcrxb(&crx);
+    assert(stat1);
+    free_crxenc(&crx);
+    fclose(fp1);
+    fclose(fp2);
+    stat1=rtk_uncompbuf("t_rinex_utest12.05d",&buff1,&size1);
+    printf("file=%s size=%lu\n",file1,(unsigned long)size1);
+    assert(stat1==1&&size1>20*n);
+    for (i=0;i<20;i++) {
+        assert(!memcmp(buff1+size1-(20-i)*n,text,n));
+    }
+    free(buff1);
+    free(text);
+    remove("t_rinex_utest12.05d");
+
+    printf("%s utest12 : OK\n",__FILE__);
+}
 int main(int argc, char **argv)
 {
     utest1();
@@ -216,5 +677,11 @@ int main(int argc, char **argv)
     utest4();
     utest5();
     utest6();
+    utest7();
+    utest8();
+    utest9();
+    utest10();
+    utest11();
+    utest12();
     return 0;
 }
@@ -0,0 +1,182 @@
+/*------------------------------------------------------------------------------
+* rtklib unit test driver : rtcm functions
+*-----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "../../src/rtklib.h"
+
+#define MAXDATA     1048576
+
+/* read file to buffer */
+static int readdata(const char *file, uint8_t *data, int nmax)
+{
+    FILE *fp=fopen(file,"rb");
+    int n;
+
+    if (!fp) return 0;
+    n=(int)fread(data,1,nmax,fp);
+    fclose(fp);
+    return n;
+}
+/* insert junk bytes (without preamble) between frames */
+static int addjunk(const uint8_t *data, int n, uint8_t *out, int nmax)
+{
+    static const uint8_t junk[]={0x00,0xFF,0x55,0xAA,0x12,0x34,0xD2,0xD4};
+    int i=0,j=0,k,len,nframe=0;
+
+    while (i<n) {
+        if (data[i]==0xD3&&i+3<=n) {
+            len=(((data[i+1]&0x3)<<8)|data[i+2])+6;
+            if (i+len>n||j+len+(int)sizeof(junk)>nmax) break;
+            memcpy(out+j,data+i,len);
+            i+=len; j+=len;
+            for (k=0;k<=nframe%(int)sizeof(junk);k++) out[j++]=junk[k];
+            nframe++;
+        }
+        else if (j<nmax) out[j++]=data[i++];
+        else break;
+    }
+    return j;
+}
+/* next message by input_rtcm3() byte by byte */
+static int nextbyte(rtcm_t *rtcm, const uint8_t *data, int n, int *i)
+{
+    int ret;
+
+    while (*i<n) {
+        if ((ret=input_rtcm3(rtcm,data[(*i)++]))) return ret;
+    }
+    return 0;
+}
+/* next message by input_rtcm3_buf() for data in blocks of bsize */
+static int nextbuf(rtcm_t *rtcm, const uint8_t *data, int n, int bsize, int *i)
+{
+    int ret,m,end;
+
+    while (*i<n) {
+        end=(*i/bsize+1)*bsize;
+        if (end>n) end=n;
+        ret=input_rtcm3_buf(rtcm,data+*i,end-*i,&m);
+        assert(0<=m&&m<=end-*i);
+        assert(ret||m==end-*i);
+        *i+=m;
+        if (ret) return ret;
+    }
+    return 0;
+}
+/* compare decoded messages */
+static int cmpmsg(const rtcm_t *r1, const rtcm_t *r2, int ret)
+{
+    int i;
+
+    if (ret==1) {
+        if (r1->obs.n!=r2->obs.n) return 0;
+        for (i=0;i<r1->obs.n;i++) {
+            const obsd_t *d1=r1->obs.data+i,*d2=r2->obs.data+i;
+            if (timediff(d1->time,d2->time)!=0.0||d1->sat!=d2->sat||
+                memcmp(d1->code,d2->code,sizeof(d1->code))||
+                memcmp(d1->LLI,d2->LLI,sizeof(d1->LLI))||
+                memcmp(d1->L,d2->L,sizeof(d1->L))||memcmp(d1->P,d2->P,sizeof(d1->P))||
+                memcmp(d1->D,d2->D,sizeof(d1->D))||
+                memcmp(d1->SNR,d2->SNR,sizeof(d1->SNR))) {
+                return 0;
+            }
+        }
+    }
+    else if (ret==2) {
+        if (r1->ephsat!=r2->ephsat||r1->ephset!=r2->ephset) return 0;
+    }
+    return timediff(r1->time,r2->time)==0.0&&r1->staid==r2->staid;
+}
+/* decode data by input_rtcm3() and input_rtcm3_buf(), return messages */
+static int cmpdecode(const uint8_t *data, int n, int bsize)
+{
+    rtcm_t *r1=(rtcm_t *)calloc(1,sizeof(rtcm_t));
+    rtcm_t *r2=(rtcm_t *)calloc(1,sizeof(rtcm_t));
+    int i=0,j=0,ret1,ret2,nmsg=0,stat;
+
+    assert(r1&&r2);
+    stat=init_rtcm(r1)&&init_rtcm(r2);
+    assert(stat);
+    for (;;) {
+        ret1=nextbyte(r1,data,n,&i);
+        ret2=nextbuf(r2,data,n,bsize,&j);
+        assert(ret1==ret2);
+        if (!ret1) break;
+        stat=cmpmsg(r1,r2,ret1);
+        assert(stat);
+        nmsg++;
+    }
+    assert(i==n&&j==n);
+    free_rtcm(r1);
+    free_rtcm(r2);
+    free(r1);
+    free(r2);
+    return nmsg;
+}
+/* input_rtcm3_buf() same as input_rtcm3() */
+void utest1(void)
+{
+    const char *file="../data/rcvraw/GMSD7_20121014.rtcm3";
+    const int bsize[]={1,2,3,5,6,7,64,100,1023,4096,MAXDATA};
+    uint8_t *data=(uint8_t *)malloc(MAXDATA),*jdata=(uint8_t *)malloc(MAXDATA);
+    int i,n,nj,nmsg,nmsg0;
+
+    assert(data&&jdata);
+    n=readdata(file,data,MAXDATA);
+    nj=addjunk(data,n,jdata,MAXDATA);
+    assert(n>0&&nj>n);
+
+    /* frames split over blocks */
+    nmsg0=cmpdecode(data,n,MAXDATA);
+    printf("file=%s size=%d msgs=%d\n",file,n,nmsg0);
+    assert(nmsg0>0);
+    for (i=0;i<(int)(sizeof(bsize)/sizeof(*bsize));i++) {
+        nmsg=cmpdecode(data,n,bsize[i]);
+        assert(nmsg==nmsg0);
+    }
+    /* junk bytes between frames */
+    for (i=0;i<(int)(sizeof(bsize)/sizeof(*bsize));i++) {
+        nmsg=cmpdecode(jdata,nj,bsize[i]);
+        assert(nmsg==nmsg0);
+    }
+    free(data);
+    free(jdata);
+    printf("%s utest1 : OK\n",__FILE__);
+}
+/* short station messages with string lengths beyond the frame */
+void utest2(void)
+{
+    const int types[]={1007,1008,1033};
+    rtcm_t *rtcm=(rtcm_t *)calloc(1,sizeof(rtcm_t));
+    uint8_t *data;
+    int i,ret,m,stat;
+
+    assert(rtcm);
+    stat=init_rtcm(rtcm);
+    assert(stat);
+    for (i=0;i<3;i++) {
+        /* frame of 5 bytes message at end of allocated data */
+        data=(uint8_t *)calloc(11,1);
+        assert(data);
+        setbitu(data, 0, 8,0xD3);
+        setbitu(data,14,10,5);
+        setbitu(data,24,12,types[i]);
+        setbitu(data,36,12,1);   /* staid */
+        setbitu(data,48, 8,255); /* number of characters */
+        setbitu(data,64,24,rtk_crc24q(data,8));
+        ret=input_rtcm3_buf(rtcm,data,11,&m);
+        assert(ret==-1&&m==11);
+        free(data);
+    }
+    free_rtcm(rtcm);
+    free(rtcm);
+    printf("%s utest2 : OK\n",__FILE__);
+}
+int main(int argc, char **argv)
+{
+    utest1();
+    utest2();
+    return 0;
+}